@@ -1,7 +1,7 @@
 /***********************************************************************
 ClusterPipe - Base class providing a 1-to-n intra-cluster communication
 pattern using a cluster multiplexer.
-Copyright (c) 2011-2012 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Cluster/ClusterPipe.h>
 
+#include <Threads/Profiler.h>
 #include <Cluster/Multiplexer.h>
 
 namespace Cluster {
@@ -63,6 +64,8 @@ void ClusterPipe::couple(bool newReadCoupled,bool newWriteCoupled)
 
 void ClusterPipe::barrier(void)
 	{
+	Threads::Profiler::Zone zone("Cluster::ClusterPipe::barrier");
+	
 	/* Send any unsent data: */
 	flushPipe();
 	
@@ -72,6 +75,8 @@ void ClusterPipe::barrier(void)
 
 unsigned int ClusterPipe::gather(unsigned int value,GatherOperation::OpCode op)
 	{
+	Threads::Profiler::Zone zone("Cluster::ClusterPipe::gather");
+	
 	/* Send any unsent data: */
 	flushPipe();
 	
@@ -1,7 +1,7 @@
 /***********************************************************************
 ClusterPipe - Base class providing a 1-to-n intra-cluster communication
 pattern using a cluster multiplexer.
-Copyright (c) 2011-2012 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -82,6 +82,10 @@ class ClusterPipe
 		return writeCoupled;
 		}
 	virtual void couple(bool newReadCoupled,bool newWriteCoupled); // Couples or decouples the reading and writing side of the pipe
+	void setBarrierMode(Multiplexer::BarrierMode newBarrierMode) // Sets the way barriers and gather operations are processed on this pipe; must be called on all nodes between the same two barriers
+		{
+		multiplexer->setBarrierMode(pipeId,newBarrierMode);
+		}
 	virtual void barrier(void); // Blocks the calling thread until all nodes in a cluster pipe have reached the same point in the program
 	virtual unsigned int gather(unsigned int value,GatherOperation::OpCode op); // Blocks the calling thread until all nodes in a cluster pipe have exchanged a value; returns final accumulated value
 	};
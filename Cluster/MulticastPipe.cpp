@@ -2,7 +2,7 @@
 MulticastPipe - Class to represent data streams between a single master
 and several slaves, with the bulk of communication from the master to
 all the slaves in parallel.
-Copyright (c) 2005-2024 Oliver Kreylos
+Copyright (c) 2005-2026 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Cluster/MulticastPipe.h>
 
+#include <Threads/Profiler.h>
 #include <Cluster/Packet.h>
 #include <Cluster/Multiplexer.h>
 
@@ -34,6 +35,8 @@ Methods of class MulticastPipe:
 
 size_t MulticastPipe::readData(IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::MulticastPipe::readData");
+	
 	/* Delete the current (completely read) packet: */
 	if(packet!=0)
 		{
@@ -53,6 +56,8 @@ size_t MulticastPipe::readData(IO::File::Byte* buffer,size_t bufferSize)
 
 void MulticastPipe::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::MulticastPipe::writeData");
+	
 	/* Pass the current packet to the multiplexer: */
 	{
 	Packet* sendPacket=packet;
@@ -68,6 +73,8 @@ void MulticastPipe::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 
 size_t MulticastPipe::writeDataUpTo(const IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::MulticastPipe::writeData");
+	
 	/* Pass the current packet to the multiplexer: */
 	{
 	Packet* sendPacket=packet;
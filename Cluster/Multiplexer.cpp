@@ -1,7 +1,7 @@
 /***********************************************************************
 Multiplexer - Class to share several intra-cluster multicast pipes
 across a single UDP socket connection.
-Copyright (c) 2005-2024 Oliver Kreylos
+Copyright (c) 2005-2026 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -53,6 +53,32 @@ inline bool isMulticast(const struct in_addr& netAddress) // Returns true if the
 	return address>=(0xe0<<24)&&address<(0xf0<<24);
 	}
 
+inline unsigned int accumulate(unsigned int value1,unsigned int value2,GatherOperation::OpCode op) // Combines two gather values using the given gather operation
+	{
+	switch(op)
+		{
+		case GatherOperation::AND:
+			return value1&&value2;
+		
+		case GatherOperation::OR:
+			return value1||value2;
+		
+		case GatherOperation::MIN:
+			return value1<=value2?value1:value2;
+		
+		case GatherOperation::MAX:
+			return value1>=value2?value1:value2;
+		
+		case GatherOperation::SUM:
+			return value1+value2;
+		
+		case GatherOperation::PRODUCT:
+			return value1*value2;
+		}
+	
+	return value1;
+	}
+
 }
 
 /***************************************************
@@ -113,17 +139,49 @@ Packet* Multiplexer::PipeState::PacketList::pop_front(void)
 	return result;
 	}
 
+bool Multiplexer::PipeState::PacketList::insert(Packet* packet,unsigned int baseStreamPos)
+	{
+	/* Find the insertion point using stream positions relative to the base to handle wrap-around: */
+	unsigned int packetOffset=packet->streamPos-baseStreamPos;
+	Packet* pred=0;
+	Packet* succ=head;
+	while(succ!=0&&succ->streamPos-baseStreamPos<packetOffset)
+		{
+		pred=succ;
+		succ=succ->succ;
+		}
+	
+	/* Bail out if the packet is already in the list: */
+	if(succ!=0&&succ->streamPos==packet->streamPos)
+		return false;
+	
+	/* Link the packet into the list: */
+	packet->succ=succ;
+	if(pred!=0)
+		pred->succ=packet;
+	else
+		head=packet;
+	if(succ==0)
+		tail=packet;
+	
+	/* Increase number of packets: */
+	++numPackets;
+	
+	return true;
+	}
+
 /***************************************
 Methods of class Multiplexer::PipeState:
 ***************************************/
 
-Multiplexer::PipeState::PipeState(unsigned int nodeIndex,unsigned int numSlaves)
+Multiplexer::PipeState::PipeState(unsigned int nodeIndex,unsigned int numSlaves,Multiplexer::BarrierMode sBarrierMode)
 	:pipeId(0),
-	 streamPos(0),packetLossMode(false),
+	 streamPos(0),lastNackTime(0,0),
 	 headStreamPos(0),
 	 slaveStreamPosOffsets(0),numHeadSlaves(0),
-	 barrierId(0),slaveBarrierIds(0),minSlaveBarrierId(0),
-	 slaveGatherValues(0)
+	 barrierMode(sBarrierMode),
+	 barrierId(0),slaveBarrierIds(new unsigned int[numSlaves]),minSlaveBarrierId(0),
+	 slaveGatherValues(new unsigned int[numSlaves])
 	 #if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 	 ,
 	 numResentPackets(0),numResentBytes(0)
@@ -136,16 +194,13 @@ Multiplexer::PipeState::PipeState(unsigned int nodeIndex,unsigned int numSlaves)
 		for(unsigned int i=0;i<numSlaves;++i)
 			slaveStreamPosOffsets[i]=0;
 		numHeadSlaves=numSlaves;
-		
-		/* Initialize the slave barrier ID array: */
-		slaveBarrierIds=new unsigned int[numSlaves];
-		for(unsigned int i=0;i<numSlaves;++i)
-			slaveBarrierIds[i]=0;
-		
-		/* Initialize the slave gather value array: */
-		slaveGatherValues=new unsigned int[numSlaves];
-		for(unsigned int i=0;i<numSlaves;++i)
-			slaveBarrierIds[i]=0;
+		}
+	
+	/* Initialize the slave barrier ID and gather value arrays: */
+	for(unsigned int i=0;i<numSlaves;++i)
+		{
+		slaveBarrierIds[i]=0;
+		slaveGatherValues[i]=0;
 		}
 	}
 
@@ -183,7 +238,8 @@ struct Message // Structure for protocol messages exchanged between master and s
 		ACKNOWLEDGMENT, // Signal that slave has received some stream packets
 		PACKETLOSS, // Signal that slave lost a stream packet
 		BARRIER, // Barrier message sent from slaves to master
-		GATHER // Message conveying a slave's gather value in a gather operation
+		GATHER, // Message conveying a slave's gather value in a gather operation
+		NACK // Signal that slave is missing one or more ranges of stream data
 		};
 	
 	/* Elements: */
@@ -240,6 +296,20 @@ struct StreamMessage:public PipeMessage
 		}
 	};
 
+struct NackMessage:public StreamMessage
+	{
+	/* Elements: */
+	public:
+	unsigned int numRanges; // Number of missing stream data ranges following the message as pairs of begin and end stream positions; a range with begin==end extends to the end of the stream
+	
+	/* Constructors and destructors: */
+	NackMessage(unsigned int sNodeIndex,unsigned int sPipeId,unsigned int sStreamPos,unsigned int sPacketPos,unsigned int sNumRanges)
+		:StreamMessage(sNodeIndex,NACK,sPipeId,sStreamPos,sPacketPos),
+		 numRanges(sNumRanges)
+		{
+		}
+	};
+
 struct BarrierMessage:public PipeMessage
 	{
 	/* Elements: */
@@ -356,6 +426,221 @@ void Multiplexer::processAcknowledgment(Multiplexer::LockedPipe& pipeState,int s
 		}
 	}
 
+bool Multiplexer::canUseBarrierTree(void) const
+	{
+	return numSlaves<=(Packet::maxRawPacketSize-sizeof(Message)-sizeof(unsigned int))/(2*sizeof(unsigned int));
+	}
+
+void Multiplexer::sendConnectionMessage(int burstSize)
+	{
+	/* Assemble a connection message followed by the slaves' barrier tree socket addresses if they fit: */
+	unsigned int msgBuffer[Packet::maxRawPacketSize/sizeof(unsigned int)];
+	Message* msg=reinterpret_cast<Message*>(msgBuffer);
+	msg->nodeIndex=0;
+	msg->messageId=Message::CONNECTION;
+	size_t msgSize=sizeof(Message);
+	if(canUseBarrierTree())
+		{
+		unsigned int* msgPtr=reinterpret_cast<unsigned int*>(msg+1);
+		*(msgPtr++)=numSlaves;
+		for(unsigned int i=0;i<numSlaves;++i)
+			{
+			*(msgPtr++)=slaveTreeAddresses[i].sin_addr.s_addr;
+			*(msgPtr++)=slaveTreeAddresses[i].sin_port;
+			}
+		msgSize+=(1+2*numSlaves)*sizeof(unsigned int);
+		}
+	
+	/* Send the message to all slaves: */
+	{
+	// SocketMutex::Lock socketLock(socketMutex);
+	for(int i=0;i<burstSize;++i)
+		sendto(socketFd,msgBuffer,msgSize,0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+	}
+	}
+
+void Multiplexer::getChildRange(const Multiplexer::PipeState& pipeState,unsigned int& firstChild,unsigned int& lastChild) const
+	{
+	if(pipeState.barrierMode==TREE)
+		{
+		/* Children of node i in the barrier tree are nodes i*fanIn+1 to i*fanIn+fanIn: */
+		firstChild=nodeIndex*barrierTreeFanIn+1;
+		lastChild=firstChild+barrierTreeFanIn;
+		if(lastChild>numSlaves+1)
+			lastChild=numSlaves+1;
+		if(firstChild>lastChild)
+			firstChild=lastChild;
+		}
+	else if(nodeIndex==0)
+		{
+		/* All slaves report directly to the master: */
+		firstChild=1;
+		lastChild=numSlaves+1;
+		}
+	else
+		{
+		/* Slaves don't have children: */
+		firstChild=lastChild=0;
+		}
+	}
+
+unsigned int Multiplexer::getParentIndex(const Multiplexer::PipeState& pipeState) const
+	{
+	return pipeState.barrierMode==TREE?(nodeIndex-1)/barrierTreeFanIn:0;
+	}
+
+void Multiplexer::updateMinSlaveBarrierId(Multiplexer::PipeState& pipeState) const
+	{
+	/* Find the smallest barrier ID reported by any of this node's children; nodes without children are never waiting for them: */
+	unsigned int firstChild,lastChild;
+	getChildRange(pipeState,firstChild,lastChild);
+	pipeState.minSlaveBarrierId=~0U;
+	for(unsigned int child=firstChild;child<lastChild;++child)
+		if(pipeState.minSlaveBarrierId>pipeState.slaveBarrierIds[child-1])
+			pipeState.minSlaveBarrierId=pipeState.slaveBarrierIds[child-1];
+	}
+
+void Multiplexer::sendToParent(const Multiplexer::PipeState& pipeState,const void* message,size_t messageSize)
+	{
+	/* Send to the master's regular socket or to the parent slave's barrier tree socket: */
+	unsigned int parentIndex=getParentIndex(pipeState);
+	const sockaddr_in* parentAddress=parentIndex==0?otherAddress:&slaveTreeAddresses[parentIndex-1];
+	{
+	// SocketMutex::Lock socketLock(socketMutex);
+	sendto(socketFd,message,messageSize,0,(const sockaddr*)parentAddress,sizeof(struct sockaddr_in));
+	}
+	}
+
+void Multiplexer::processTreeMessage(void)
+	{
+	/* Read the waiting message: */
+	ssize_t numBytesReceived=recv(treeSocketFd,messageBuffer,Packet::maxRawPacketSize,0);
+	if(numBytesReceived<ssize_t(sizeof(BarrierMessage)))
+		return;
+	BarrierMessage* msg=static_cast<BarrierMessage*>(messageBuffer);
+	bool isGather=msg->messageId==Message::GATHER;
+	if(!(msg->messageId==Message::BARRIER&&numBytesReceived==sizeof(BarrierMessage))&&!(isGather&&numBytesReceived==sizeof(GatherMessage)))
+		{
+		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+		std::cerr<<"Node "<<nodeIndex<<": received invalid barrier tree message of size "<<numBytesReceived<<std::endl;
+		#endif
+		return;
+		}
+	
+	/* Get a handle on the state object of the pipe the message is meant for: */
+	LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+	
+	if(msg->nodeIndex&0x80000000U)
+		{
+		/* It's a barrier or gather message from one of this node's children: */
+		unsigned int childIndex=msg->nodeIndex&0x7fffffffU;
+		if(childIndex==0||childIndex>numSlaves)
+			return;
+		
+		if(!pipeState.isValid()||pipeState->barrierId>=msg->barrierId)
+			{
+			/* The child must have missed a completion message; relay another one: */
+			GatherMessage msg2(0,msg->messageId,msg->pipeId,msg->barrierId,pipeState.isValid()?pipeState->masterGatherValue:0);
+			{
+			// SocketMutex::Lock socketLock(socketMutex);
+			sendto(socketFd,&msg2,isGather?sizeof(GatherMessage):sizeof(BarrierMessage),0,(const sockaddr*)&slaveTreeAddresses[childIndex-1],sizeof(struct sockaddr_in));
+			}
+			}
+		else
+			{
+			/* Remember the child's barrier ID and accumulated gather value: */
+			pipeState->slaveBarrierIds[childIndex-1]=msg->barrierId;
+			if(isGather)
+				pipeState->slaveGatherValues[childIndex-1]=static_cast<GatherMessage*>(messageBuffer)->value;
+			
+			/* Wake up the thread waiting on the barrier if all children have arrived: */
+			updateMinSlaveBarrierId(*pipeState);
+			if(pipeState->minSlaveBarrierId>pipeState->barrierId)
+				pipeState->barrierCond.signal();
+			}
+		}
+	else if(pipeState.isValid()&&pipeState->barrierId<msg->barrierId)
+		{
+		/* It's a completion message relayed by this node's parent: */
+		pipeState->barrierId=msg->barrierId;
+		if(isGather)
+			pipeState->masterGatherValue=static_cast<GatherMessage*>(messageBuffer)->value;
+		pipeState->barrierCond.signal();
+		}
+	}
+
+void Multiplexer::pace(size_t numBytes,bool wait)
+	{
+	/* Bail out if rate control is disabled: */
+	if(maxSendRate<=0.0)
+		return;
+	
+	/* Reserve a time slot for the given number of bytes: */
+	Misc::Time sendTime;
+	{
+	Threads::Spinlock::Lock pacingLock(pacingMutex);
+	
+	/* Don't let the pacer accumulate credit while the master is idle: */
+	Misc::Time now=Misc::Time::now();
+	if(nextSendTime<now)
+		nextSendTime=now;
+	sendTime=nextSendTime;
+	nextSendTime.increment(double(numBytes)/maxSendRate);
+	}
+	
+	if(wait)
+		{
+		/* Block until the reserved time slot: */
+		Misc::Time now=Misc::Time::now();
+		if(now<sendTime)
+			Misc::sleep(sendTime-now);
+		}
+	}
+
+void Multiplexer::sendNegativeAcknowledgment(Multiplexer::LockedPipe& pipeState,bool includeTail)
+	{
+	/* Assemble a negative acknowledgment message listing the gaps between the pipe's stream position and all out-of-order packets: */
+	unsigned int msgBuffer[Packet::maxRawPacketSize/sizeof(unsigned int)];
+	NackMessage* msg=reinterpret_cast<NackMessage*>(msgBuffer);
+	unsigned int* ranges=reinterpret_cast<unsigned int*>(msg+1);
+	unsigned int maxNumRanges=(Packet::maxRawPacketSize-sizeof(NackMessage))/(2*sizeof(unsigned int));
+	unsigned int numRanges=0;
+	unsigned int gapBegin=pipeState->streamPos;
+	for(Packet* pPtr=pipeState->outOfOrderList.front();pPtr!=0&&numRanges<maxNumRanges;pPtr=pPtr->succ)
+		{
+		if(pPtr->streamPos!=gapBegin)
+			{
+			ranges[2*numRanges+0]=gapBegin;
+			ranges[2*numRanges+1]=pPtr->streamPos;
+			++numRanges;
+			}
+		gapBegin=pPtr->streamPos+pPtr->packetSize;
+		}
+	if(includeTail&&numRanges<maxNumRanges)
+		{
+		/* Request everything after the last received packet as well: */
+		ranges[2*numRanges+0]=gapBegin;
+		ranges[2*numRanges+1]=gapBegin;
+		++numRanges;
+		}
+	msg->nodeIndex=nodeIndex|0x80000000U;
+	msg->messageId=Message::NACK;
+	msg->pipeId=pipeState->pipeId;
+	msg->streamPos=pipeState->streamPos;
+	msg->packetPos=gapBegin;
+	msg->numRanges=numRanges;
+	
+	/* Send the message to the master: */
+	size_t msgSize=sizeof(NackMessage)+numRanges*2*sizeof(unsigned int);
+	{
+	// SocketMutex::Lock socketLock(socketMutex);
+	for(int i=0;i<slaveMessageBurstSize;++i)
+		sendto(socketFd,msgBuffer,msgSize,0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
+	}
+	
+	pipeState->lastNackTime=Misc::Time::now();
+	}
+
 void* Multiplexer::packetHandlingThreadMaster(void)
 	{
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
@@ -369,15 +654,29 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 	while(numConnectedSlaves<numSlaves)
 		{
 		/* Wait for a connection initialization packet: */
-		ssize_t numBytesReceived=recv(socketFd,messageBuffer,Packet::maxRawPacketSize,0);
-		if(numBytesReceived==sizeof(Message))
+		struct sockaddr_in senderAddress;
+		socklen_t senderAddressLen=sizeof(struct sockaddr_in);
+		ssize_t numBytesReceived=recvfrom(socketFd,messageBuffer,Packet::maxRawPacketSize,0,(struct sockaddr*)&senderAddress,&senderAddressLen);
+		if(numBytesReceived>=ssize_t(sizeof(Message)))
 			{
 			Message* msg=static_cast<Message*>(messageBuffer);
-			if(msg->nodeIndex&0x80000000U) // Check if the message is from a slave
+			if((msg->nodeIndex&0x80000000U)&&msg->messageId==Message::CONNECTION) // Check if the message is a connection request from a slave
 				{
 				unsigned int slaveIndex=(msg->nodeIndex&0x7fffffffU)-1;
-				if(msg->messageId==Message::CONNECTION&&slaveIndex<numSlaves&&!slaveConnecteds[slaveIndex])
+				if(slaveIndex<numSlaves&&numBytesReceived!=ssize_t(sizeof(Message)+sizeof(unsigned int)))
 					{
+					/* The slave uses a different version of the connection protocol; stop waiting for slaves and report the error: */
+					Threads::MutexCond::Lock connectionCondLock(connectionCond);
+					incompatibleNodeIndex=slaveIndex+1;
+					connectionCond.broadcast();
+					break;
+					}
+				if(slaveIndex<numSlaves&&!slaveConnecteds[slaveIndex])
+					{
+					/* Remember the address of the slave's barrier tree socket: */
+					slaveTreeAddresses[slaveIndex]=senderAddress;
+					slaveTreeAddresses[slaveIndex].sin_port=htons((unsigned short)(*reinterpret_cast<unsigned int*>(msg+1)));
+					
 					/* Mark the slave as connected: */
 					slaveConnecteds[slaveIndex]=true;
 					++numConnectedSlaves;
@@ -386,14 +685,12 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 			}
 		}
 	delete[] slaveConnecteds;
+	if(incompatibleNodeIndex!=0)
+		return 0;
+	haveSlaveTreeAddresses=true;
 	
 	/* Send connection message to slaves: */
-	Message msg(0,Message::CONNECTION);
-	{
-	// SocketMutex::Lock socketLock(socketMutex);
-	for(int i=0;i<masterMessageBurstSize;++i)
-		sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-	}
+	sendConnectionMessage(masterMessageBurstSize);
 	
 	/* Signal connection establishment: */
 	{
@@ -420,11 +717,7 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 					case Message::CONNECTION:
 						{
 						/* One slave must have missed the connection establishment packet; send another one: */
-						Message msg(0,Message::CONNECTION);
-						{
-						// SocketMutex::Lock socketLock(socketMutex);
-						sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
-						}
+						sendConnectionMessage(1);
 						break;
 						}
 					
@@ -455,7 +748,7 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 							if(npIt.isFinished())
 								{
 								/* If the new pipe state hasn't been created already, do it here: */
-								newPipeState=new PipeState(nodeIndex,numSlaves);
+								newPipeState=new PipeState(nodeIndex,numSlaves,defaultBarrierMode);
 								
 								/* Add the new pipe state to the new pipe map: */
 								// newPipes[senderId]=newPipeState; // Gives "potentially uninitialized" warning
@@ -637,6 +930,7 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 									// SocketMutex::Lock socketLock(socketMutex);
 									for(;packet!=0;packet=packet->succ)
 										{
+										pace(packet->packetSize+2*sizeof(unsigned int),false);
 										sendto(socketFd,&packet->pipeId,packet->packetSize+2*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
 										#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 										++pipeState->numResentPackets;
@@ -658,6 +952,67 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 						break;
 						}
 					
+					case Message::NACK:
+						{
+						NackMessage* msg=static_cast<NackMessage*>(messageBuffer);
+						if(size_t(numBytesReceived)>=sizeof(NackMessage)&&size_t(numBytesReceived)==sizeof(NackMessage)+msg->numRanges*2*sizeof(unsigned int))
+							{
+							/* Get a handle on the state object of the pipe the packet is meant for: */
+							LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,msg->pipeId);
+							
+							if(pipeState.isValid())
+								{
+								/* Use the stream position reported by the client as positive acknowledgment: */
+								processAcknowledgment(pipeState,msgNodeIndex-1,msg->streamPos);
+								
+								/* Signal a fatal error if the slave's stream position has already been discarded: */
+								unsigned int headStreamPos=pipeState->headStreamPos;
+								if(headStreamPos-msg->streamPos-1U<0x7fffffffU)
+									throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Node %u: Fatal packet loss detected at stream position %u",msgNodeIndex,msg->streamPos);
+								
+								#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER_VERBOSE
+								std::cerr<<"Packet loss of "<<msg->numRanges<<" ranges from "<<msg->streamPos<<" detected by node "<<msgNodeIndex<<", stream pos is "<<pipeState->streamPos<<", buffer starts at "<<headStreamPos<<std::endl;
+								#endif
+								
+								/* Resend only those recently-sent packets that start inside one of the missing ranges, using stream positions relative to the head of the packet list: */
+								const unsigned int* ranges=reinterpret_cast<const unsigned int*>(msg+1);
+								Packet* packet=pipeState->packetList.front();
+								for(unsigned int rangeIndex=0;rangeIndex<msg->numRanges&&packet!=0;++rangeIndex)
+									{
+									unsigned int rangeBegin=ranges[2*rangeIndex+0]-headStreamPos;
+									unsigned int rangeEnd=ranges[2*rangeIndex+1]!=ranges[2*rangeIndex+0]?ranges[2*rangeIndex+1]-headStreamPos:pipeState->streamPos-headStreamPos;
+									
+									/* Skip all packets that start before the range: */
+									while(packet!=0&&packet->streamPos-headStreamPos<rangeBegin)
+										packet=packet->succ;
+									
+									/* Resend all packets that start inside the range: */
+									{
+									// SocketMutex::Lock socketLock(socketMutex);
+									for(;packet!=0&&packet->streamPos-headStreamPos<rangeEnd;packet=packet->succ)
+										{
+										pace(packet->packetSize+2*sizeof(unsigned int),false);
+										sendto(socketFd,&packet->pipeId,packet->packetSize+2*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+										#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+										++pipeState->numResentPackets;
+										pipeState->numResentBytes+=packet->packetSize;
+										#endif
+										}
+									}
+									}
+								}
+							#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+							else
+								std::cerr<<"Node "<<nodeIndex<<": received NACK message for non-existent pipe "<<msg->pipeId<<std::endl;
+							#endif
+							}
+						#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
+						else
+							std::cerr<<"Node "<<nodeIndex<<": received NACK message of wrong size "<<numBytesReceived<<std::endl;
+						#endif
+						break;
+						}
+					
 					case Message::BARRIER:
 						{
 						if(numBytesReceived==sizeof(BarrierMessage))
@@ -684,10 +1039,7 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 									pipeState->slaveBarrierIds[msgNodeIndex-1]=msg->barrierId;
 									
 									/* Check if the current barrier is complete: */
-									pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
-									for(unsigned int i=1;i<numSlaves;++i)
-										if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
-											pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
+									updateMinSlaveBarrierId(*pipeState);
 									if(pipeState->minSlaveBarrierId>pipeState->barrierId)
 										{
 										/* Wake up thread waiting on barrier: */
@@ -739,10 +1091,7 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 									pipeState->slaveGatherValues[msgNodeIndex-1]=msg->value;
 									
 									/* Check if the current gather operation is complete: */
-									pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[0];
-									for(unsigned int i=1;i<numSlaves;++i)
-										if(pipeState->minSlaveBarrierId>pipeState->slaveBarrierIds[i])
-											pipeState->minSlaveBarrierId=pipeState->slaveBarrierIds[i];
+									updateMinSlaveBarrierId(*pipeState);
 									if(pipeState->minSlaveBarrierId>pipeState->barrierId)
 										{
 										/* Wake up thread waiting on barrier: */
@@ -781,15 +1130,25 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 	/* Set the MSB on the nodeIndex to identify a slave-originating message: */
 	unsigned int sendNodeIndex=nodeIndex|0x80000000U;
 	
+	/* Query the port number of the barrier tree socket: */
+	struct sockaddr_in treeSocketAddress;
+	socklen_t treeSocketAddressLen=sizeof(struct sockaddr_in);
+	getsockname(treeSocketFd,(struct sockaddr*)&treeSocketAddress,&treeSocketAddressLen);
+	unsigned int treePortNumber=ntohs(treeSocketAddress.sin_port);
+	
 	/* Keep sending connection initiation packets to the master until connection is established: */
 	while(true)
 		{
-		/* Send connection initiation packet to master: */
-		Message msg(sendNodeIndex,Message::CONNECTION);
+		/* Send connection initiation packet including the port number of the barrier tree socket to master: */
+		unsigned int msgBuffer[(sizeof(Message)+sizeof(unsigned int))/sizeof(unsigned int)];
+		Message* msg=reinterpret_cast<Message*>(msgBuffer);
+		msg->nodeIndex=sendNodeIndex;
+		msg->messageId=Message::CONNECTION;
+		*reinterpret_cast<unsigned int*>(msg+1)=treePortNumber;
 		{
 		// SocketMutex::Lock socketLock(socketMutex);
 		for(int i=0;i<slaveMessageBurstSize;++i)
-			sendto(socketFd,&msg,sizeof(Message),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
+			sendto(socketFd,msgBuffer,sizeof(Message)+sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
 		}
 		
 		/* Wait for a connection packet from the master (but don't wait for too long): */
@@ -801,24 +1160,35 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 			break;
 		}
 	
-	unsigned int sendAckIn=nodeIndex-1;
+	/* Stagger the slaves' positive acknowledgments: */
+	unsigned int sendAckIn=(nodeIndex-1)%(acknowledgmentInterval!=0?acknowledgmentInterval:numSlaves);
 	
 	/* Handle messages from the master: */
 	while(true)
 		{
-		/* Wait for the next packet, and request a ping packet if no data arrives during the timeout: */
+		/* Wait for the next packet while handling barrier tree messages, and request a ping packet if no data arrives during the timeout: */
 		bool havePacket=false;
-		for(int i=0;i<maxPingRequests&&!havePacket;++i)
+		int numPingRequests=0;
+		while(numPingRequests<maxPingRequests&&!havePacket)
 			{
 			/* Wait until the "silence period" is over: */
 			fd_set readFdSet;
 			FD_ZERO(&readFdSet);
 			FD_SET(socketFd,&readFdSet);
+			FD_SET(treeSocketFd,&readFdSet);
 			struct timeval timeout=pingTimeout;
-			if(select(socketFd+1,&readFdSet,0,0,&timeout)>=0&&FD_ISSET(socketFd,&readFdSet))
-				havePacket=true;
+			if(select((socketFd>treeSocketFd?socketFd:treeSocketFd)+1,&readFdSet,0,0,&timeout)>0)
+				{
+				/* Handle a message from another slave: */
+				if(FD_ISSET(treeSocketFd,&readFdSet))
+					processTreeMessage();
+				
+				havePacket=FD_ISSET(socketFd,&readFdSet);
+				}
 			else
 				{
+				++numPingRequests;
+				
 				/* Send a ping request packet: */
 				Message msg(sendNodeIndex,Message::PING);
 				{
@@ -856,6 +1226,22 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 				switch(static_cast<Message*>(messageBuffer)->messageId)
 					{
 					case Message::CONNECTION:
+						{
+						/* Read the slaves' barrier tree socket addresses if they are included: */
+						unsigned int* msgPtr=reinterpret_cast<unsigned int*>(static_cast<Message*>(messageBuffer)+1);
+						if(!haveSlaveTreeAddresses&&numBytesReceived==ssize_t(sizeof(Message)+(1+2*numSlaves)*sizeof(unsigned int))&&msgPtr[0]==numSlaves)
+							{
+							++msgPtr;
+							for(unsigned int i=0;i<numSlaves;++i)
+								{
+								memset(&slaveTreeAddresses[i],0,sizeof(sockaddr_in));
+								slaveTreeAddresses[i].sin_family=AF_INET;
+								slaveTreeAddresses[i].sin_addr.s_addr=*(msgPtr++);
+								slaveTreeAddresses[i].sin_port=(unsigned short)(*(msgPtr++));
+								}
+							haveSlaveTreeAddresses=true;
+							}
+						
 						/* Signal connection establishment: */
 						{
 						Threads::MutexCond::Lock connectionCondLock(connectionCond);
@@ -866,6 +1252,7 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 							}
 						}
 						break;
+						}
 					
 					case Message::PING:
 						/* Just ignore the packet... */
@@ -987,16 +1374,40 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 				
 				if(pipeState.isValid())
 					{
-					/* Check if the received packet is the next expected one: */
-					if(pipeState->streamPos==slaveThreadPacket->streamPos)
+					/* Calculate the packet's offset from the pipe's current stream position; watch for stream position wrap-around: */
+					unsigned int packetOffset=slaveThreadPacket->streamPos-pipeState->streamPos;
+					if(packetOffset==0)
 						{
-						/* Disable packet loss mode: */
-						pipeState->packetLossMode=false;
+						/* Wake up sleeping receivers if the delivery queue is currently empty: */
+						if(pipeState->packetList.empty())
+							pipeState->receiveCond.signal();
+						
+						/* Append the packet to the pipe state's delivery queue: */
+						pipeState->streamPos+=slaveThreadPacket->packetSize;
+						pipeState->packetList.push_back(slaveThreadPacket);
+						unsigned int numDelivered=1;
 						
-						++sendAckIn;
-						if(sendAckIn==numSlaves)
+						/* Deliver all out-of-order packets that have become contiguous, and discard those that have become redundant: */
+						while(!pipeState->outOfOrderList.empty())
+							{
+							unsigned int frontOffset=pipeState->outOfOrderList.front()->streamPos-pipeState->streamPos;
+							if(frontOffset==0)
+								{
+								Packet* packet=pipeState->outOfOrderList.pop_front();
+								pipeState->streamPos+=packet->packetSize;
+								pipeState->packetList.push_back(packet);
+								++numDelivered;
+								}
+							else if(frontOffset>=0x80000000U)
+								deletePacket(pipeState->outOfOrderList.pop_front());
+							else
+								break;
+							}
+						
+						/* Send a positive acknowledgment to the master once per acknowledgment interval: */
+						sendAckIn+=numDelivered;
+						if(sendAckIn>=(acknowledgmentInterval!=0?acknowledgmentInterval:numSlaves))
 							{
-							/* Send positive acknowledgment to the master: */
 							StreamMessage msg(sendNodeIndex,Message::ACKNOWLEDGMENT,slaveThreadPacket->pipeId,pipeState->streamPos,slaveThreadPacket->streamPos);
 							{
 							// SocketMutex::Lock socketLock(socketMutex);
@@ -1005,34 +1416,34 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 							sendAckIn=0;
 							}
 						
-						/* Wake up sleeping receivers if the delivery queue is currently empty: */
-						if(pipeState->packetList.empty())
-							pipeState->receiveCond.signal();
-						
-						/* Append the packet to the pipe state's delivery queue: */
-						pipeState->streamPos+=slaveThreadPacket->packetSize;
-						pipeState->packetList.push_back(slaveThreadPacket);
+						/* Request the data that is still missing if the last request is overdue: */
+						if(!pipeState->outOfOrderList.empty()&&Misc::Time::now()-pipeState->lastNackTime>=nackTimeout)
+							sendNegativeAcknowledgment(pipeState,false);
 						
 						/* Get a new packet: */
 						slaveThreadPacket=newPacket();
 						}
-					else
+					else if(packetOffset<0x80000000U)
 						{
-						/* Check if there is data missing between the packet's stream position and the pipe's stream position; watch for stream position wrap-around: */
-						if(!pipeState->packetLossMode&&slaveThreadPacket->streamPos-pipeState->streamPos<=0x80000000U)
-							{
-							/* At least one packet must have been lost; send negative acknowledgment to the master: */
-							StreamMessage msg(sendNodeIndex,Message::PACKETLOSS,slaveThreadPacket->pipeId,pipeState->streamPos,slaveThreadPacket->streamPos);
+						/* Check whether the packet reveals a new gap behind the last out-of-order packet: */
+						unsigned int tailOffset=0;
+						if(!pipeState->outOfOrderList.empty())
 							{
-							// SocketMutex::Lock socketLock(socketMutex);
-							for(int i=0;i<slaveMessageBurstSize;++i)
-								sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-							}
-
-							/* Enable packet loss mode to prohibit sending further loss messages until the missing packet arrives: */
-							pipeState->packetLossMode=true;
+							Packet* tail=pipeState->outOfOrderList.back();
+							tailOffset=tail->streamPos+tail->packetSize-pipeState->streamPos;
 							}
+						bool newGap=packetOffset>tailOffset;
+						
+						/* Hold on to the packet until the data in front of it arrives: */
+						if(pipeState->outOfOrderList.insert(slaveThreadPacket,pipeState->streamPos))
+							slaveThreadPacket=newPacket();
+						
+						/* Request the missing data immediately for new gaps, or if the last request is overdue: */
+						if(newGap||Misc::Time::now()-pipeState->lastNackTime>=nackTimeout)
+							sendNegativeAcknowledgment(pipeState,false);
 						}
+					
+					/* Otherwise, the packet is a re-sent duplicate of already delivered data and is ignored */
 					}
 				#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 				else
@@ -1053,8 +1464,10 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 	:numSlaves(sNumSlaves),nodeIndex(sNodeIndex),
 	 masterAddress(new sockaddr_in),
 	 otherAddress(new sockaddr_in),
-	 socketFd(0),
-	 connected(false),
+	 socketFd(0),treeSocketFd(-1),
+	 slaveTreeAddresses(new sockaddr_in[sNumSlaves]),haveSlaveTreeAddresses(false),
+	 barrierTreeFanIn(4),defaultBarrierMode(CENTRAL),
+	 connected(false),incompatibleNodeIndex(0),
 	 newPipes(17),
 	 lastPipeId(0),
 	 pipeStateTable(17),
@@ -1066,6 +1479,10 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 	 receiveWaitTimeout(0.25),
 	 barrierWaitTimeout(0.1),
 	 sendBufferSize(20),
+	 acknowledgmentInterval(0),
+	 nackTimeout(0.005),
+	 maxSendRate(0.0),
+	 nextSendTime(0,0),
 	 packetPoolHead(0)
 	{
 	/* Lookup master's IP address: */
@@ -1161,14 +1578,27 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 		otherAddress->sin_family=AF_INET;
 		otherAddress->sin_port=htons(masterPortNumber);
 		otherAddress->sin_addr.s_addr=htonl(masterNetAddress.s_addr);
+		
+		/* Create a UDP socket on an ephemeral port to receive messages from other slaves in the barrier tree: */
+		treeSocketFd=socket(PF_INET,SOCK_DGRAM,0);
+		if(treeSocketFd<0)
+			{
+			close(socketFd);
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Node %u: Unable to create barrier tree socket",nodeIndex);
+			}
+		socketAddress.sin_port=htons(0);
+		if(bind(treeSocketFd,(struct sockaddr*)&socketAddress,sizeof(struct sockaddr_in))==-1)
+			{
+			close(treeSocketFd);
+			close(socketFd);
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Node %u: Unable to bind barrier tree socket",nodeIndex);
+			}
 		}
 	
 	/* Create the packet handling thread: */
+	messageBuffer=new unsigned char[Packet::maxRawPacketSize];
 	if(nodeIndex==0)
-		{
-		messageBuffer=new unsigned char[Packet::maxRawPacketSize];
 		packetHandlingThread.start(this,&Multiplexer::packetHandlingThreadMaster);
-		}
 	else
 		{
 		slaveThreadPacket=newPacket();
@@ -1190,12 +1620,15 @@ Multiplexer::~Multiplexer(void)
 	for(PipeHasher::Iterator psIt=pipeStateTable.begin();psIt!=pipeStateTable.end();++psIt)
 		delete psIt->getDest();
 	
-	/* Close the UDP socket: */
+	/* Close the UDP sockets: */
 	close(socketFd);
+	if(treeSocketFd>=0)
+		close(treeSocketFd);
 	
-	/* Delete address of multicast connection's other end: */
+	/* Delete address of multicast connection's other end and the slaves' barrier tree addresses: */
 	delete masterAddress;
 	delete otherAddress;
+	delete[] slaveTreeAddresses;
 	
 	/* Delete all multicast packets in the packet pool: */
 	while(packetPoolHead!=0)
@@ -1249,15 +1682,44 @@ void Multiplexer::setSendBufferSize(unsigned int newSendBufferSize)
 	sendBufferSize=newSendBufferSize;
 	}
 
+void Multiplexer::setAcknowledgmentInterval(unsigned int newAcknowledgmentInterval)
+	{
+	acknowledgmentInterval=newAcknowledgmentInterval;
+	}
+
+void Multiplexer::setNackTimeout(Misc::Time newNackTimeout)
+	{
+	nackTimeout=newNackTimeout;
+	}
+
+void Multiplexer::setMaxSendRate(double newMaxSendRate)
+	{
+	maxSendRate=newMaxSendRate;
+	}
+
+void Multiplexer::setBarrierTreeFanIn(unsigned int newBarrierTreeFanIn)
+	{
+	barrierTreeFanIn=newBarrierTreeFanIn;
+	if(barrierTreeFanIn<2) // Need at least two
+		barrierTreeFanIn=2;
+	}
+
+void Multiplexer::setDefaultBarrierMode(Multiplexer::BarrierMode newDefaultBarrierMode)
+	{
+	defaultBarrierMode=canUseBarrierTree()?newDefaultBarrierMode:CENTRAL;
+	}
+
 void Multiplexer::waitForConnection(void)
 	{
 	{
 	Threads::MutexCond::Lock connectionCondLock(connectionCond);
-	while(!connected)
+	while(!connected&&incompatibleNodeIndex==0)
 		{
 		/* Sleep until connection is established: */
 		connectionCond.wait(connectionCondLock);
 		}
+	if(incompatibleNodeIndex!=0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Node %u: Slave node %u uses an incompatible cluster protocol version",nodeIndex,incompatibleNodeIndex);
 	}
 	}
 
@@ -1278,7 +1740,7 @@ unsigned int Multiplexer::openPipe(void)
 	if(npIt.isFinished())
 		{
 		/* If the new pipe state hasn't been created already, do it here: */
-		newPipeState=new PipeState(nodeIndex,numSlaves);
+		newPipeState=new PipeState(nodeIndex,numSlaves,defaultBarrierMode);
 		
 		/* Add the new pipe state to the new pipe map: */
 		// newPipes[threadId]=newPipeState; // Gives "potentially uninitialized" warning
@@ -1444,6 +1906,8 @@ void Multiplexer::closePipe(unsigned int pipeId)
 		pipeState->packetList.head=0;
 		pipeState->packetList.tail=0;
 		}
+	while(!pipeState->outOfOrderList.empty())
+		deletePacket(pipeState->outOfOrderList.pop_front());
 	}
 	
 	/* Destroy the pipe state: */
@@ -1480,6 +1944,9 @@ void Multiplexer::sendPacket(unsigned int pipeId,Packet* packet)
 	/* It's safe to unlock the pipe state now: */
 	pipeState.unlock();
 	
+	/* Wait until the packet may be sent under the configured send rate: */
+	pace(packet->packetSize+2*sizeof(unsigned int),true);
+	
 	/* Send the packet across the UDP connection: */
 	{
 	// SocketMutex::Lock socketLock(socketMutex);
@@ -1506,13 +1973,8 @@ Packet* Multiplexer::receivePacket(unsigned int pipeId)
 			if(!pipeState->packetList.empty())
 				break;
 			
-			/* Send a packet loss message to the master, just to be sure: */
-			StreamMessage msg(nodeIndex|0x80000000U,Message::PACKETLOSS,pipeId,pipeState->streamPos,pipeState->streamPos);
-			{
-			// SocketMutex::Lock socketLock(socketMutex);
-			for(int i=0;i<slaveMessageBurstSize;++i)
-				sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-			}
+			/* Request all missing data including any lost at the end of the stream from the master, just to be sure: */
+			sendNegativeAcknowledgment(pipeState,true);
 			}
 		}
 	
@@ -1520,6 +1982,18 @@ Packet* Multiplexer::receivePacket(unsigned int pipeId)
 	return pipeState->packetList.pop_front();
 	}
 
+void Multiplexer::setBarrierMode(unsigned int pipeId,Multiplexer::BarrierMode newBarrierMode)
+	{
+	/* Get a handle on the state object for the given pipe: */
+	LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,pipeId);
+	if(!pipeState.isValid())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Node %u: Pipe already closed",nodeIndex);
+	
+	/* Set the pipe's barrier mode and update its barrier state to reflect the new barrier topology: */
+	pipeState->barrierMode=canUseBarrierTree()?newBarrierMode:CENTRAL;
+	updateMinSlaveBarrierId(*pipeState);
+	}
+
 void Multiplexer::barrier(unsigned int pipeId)
 	{
 	/* Get a handle on the state object for the given pipe: */
@@ -1532,7 +2006,7 @@ void Multiplexer::barrier(unsigned int pipeId)
 	
 	if(nodeIndex==0)
 		{
-		/* Wait until barrier messages from all slaves have been received: */
+		/* Wait until barrier messages from all children have been received: */
 		while(pipeState->minSlaveBarrierId<nextBarrierId)
 			{
 			/* Wait until the next barrier message: */
@@ -1540,7 +2014,7 @@ void Multiplexer::barrier(unsigned int pipeId)
 			}
 		
 		/* Mark the barrier as completed: */
-		pipeState->barrierId=pipeState->minSlaveBarrierId;
+		pipeState->barrierId=nextBarrierId;
 		
 		/* Send barrier completion message to all slaves: */
 		BarrierMessage msg(0,Message::BARRIER,pipeId,nextBarrierId);
@@ -1570,16 +2044,17 @@ void Multiplexer::barrier(unsigned int pipeId)
 		}
 	else
 		{
-		/* Send barrier messages to master until barrier completion message is received: */
+		/* Send barrier messages to the parent node until barrier completion message is received: */
 		Misc::Time waitTimeout=Misc::Time::now();
 		while(pipeState->barrierId<nextBarrierId)
 			{
-			/* Send barrier message to master: */
-			BarrierMessage msg(nodeIndex|0x80000000U,Message::BARRIER,pipeId,nextBarrierId);
-			{
-			// SocketMutex::Lock socketLock(socketMutex);
-			sendto(socketFd,&msg,sizeof(BarrierMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-			}
+			/* Send barrier message to the parent node once all children have reached the barrier: */
+			updateMinSlaveBarrierId(*pipeState);
+			if(pipeState->minSlaveBarrierId>=nextBarrierId)
+				{
+				BarrierMessage msg(nodeIndex|0x80000000U,Message::BARRIER,pipeId,nextBarrierId);
+				sendToParent(*pipeState,&msg,sizeof(BarrierMessage));
+				}
 			
 			/* Wait for arrival of barrier completion message: */
 			waitTimeout+=barrierWaitTimeout;
@@ -1600,7 +2075,7 @@ unsigned int Multiplexer::gather(unsigned int pipeId,unsigned int value,GatherOp
 	
 	if(nodeIndex==0)
 		{
-		/* Wait until gather messages from all slaves have been received: */
+		/* Wait until gather messages from all children have been received: */
 		while(pipeState->minSlaveBarrierId<nextBarrierId)
 			{
 			/* Wait until the next barrier message: */
@@ -1610,42 +2085,12 @@ unsigned int Multiplexer::gather(unsigned int pipeId,unsigned int value,GatherOp
 		/* Mark the gathering operation as completed: */
 		pipeState->barrierId=nextBarrierId;
 		
-		/* Calculate the final gather value: */
+		/* Calculate the final gather value from the values of all children, which are accumulated over their subtrees in tree mode: */
+		unsigned int firstChild,lastChild;
+		getChildRange(*pipeState,firstChild,lastChild);
 		pipeState->masterGatherValue=value;
-		switch(op)
-			{
-			case GatherOperation::AND:
-				for(unsigned int i=0;i<numSlaves;++i)
-					pipeState->masterGatherValue=pipeState->masterGatherValue&&pipeState->slaveGatherValues[i];
-				break;
-			
-			case GatherOperation::OR:
-				for(unsigned int i=0;i<numSlaves;++i)
-					pipeState->masterGatherValue=pipeState->masterGatherValue||pipeState->slaveGatherValues[i];
-				break;
-			
-			case GatherOperation::MIN:
-				for(unsigned int i=0;i<numSlaves;++i)
-					if(pipeState->masterGatherValue>pipeState->slaveGatherValues[i])
-						pipeState->masterGatherValue=pipeState->slaveGatherValues[i];
-				break;
-			
-			case GatherOperation::MAX:
-				for(unsigned int i=0;i<numSlaves;++i)
-					if(pipeState->masterGatherValue<pipeState->slaveGatherValues[i])
-						pipeState->masterGatherValue=pipeState->slaveGatherValues[i];
-				break;
-			
-			case GatherOperation::SUM:
-				for(unsigned int i=0;i<numSlaves;++i)
-					pipeState->masterGatherValue+=pipeState->slaveGatherValues[i];
-				break;
-			
-			case GatherOperation::PRODUCT:
-				for(unsigned int i=0;i<numSlaves;++i)
-					pipeState->masterGatherValue*=pipeState->slaveGatherValues[i];
-				break;
-			}
+		for(unsigned int child=firstChild;child<lastChild;++child)
+			pipeState->masterGatherValue=accumulate(pipeState->masterGatherValue,pipeState->slaveGatherValues[child-1],op);
 		
 		/* Send gather completion message to all slaves: */
 		GatherMessage msg(0,Message::GATHER,pipeId,nextBarrierId,pipeState->masterGatherValue);
@@ -1675,16 +2120,24 @@ unsigned int Multiplexer::gather(unsigned int pipeId,unsigned int value,GatherOp
 		}
 	else
 		{
-		/* Send barrier messages to master until barrier completion message is received: */
+		/* Send gather messages to the parent node until barrier completion message is received: */
 		Misc::Time waitTimeout=Misc::Time::now();
 		while(pipeState->barrierId<nextBarrierId)
 			{
-			/* Send gather message to master: */
-			GatherMessage msg(nodeIndex|0x80000000U,Message::GATHER,pipeId,nextBarrierId,value);
-			{
-			// SocketMutex::Lock socketLock(socketMutex);
-			sendto(socketFd,&msg,sizeof(GatherMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-			}
+			/* Send gather message to the parent node once all children have reached the barrier: */
+			updateMinSlaveBarrierId(*pipeState);
+			if(pipeState->minSlaveBarrierId>=nextBarrierId)
+				{
+				/* Accumulate this node's gather value with those of its children's subtrees: */
+				unsigned int firstChild,lastChild;
+				getChildRange(*pipeState,firstChild,lastChild);
+				unsigned int subtreeValue=value;
+				for(unsigned int child=firstChild;child<lastChild;++child)
+					subtreeValue=accumulate(subtreeValue,pipeState->slaveGatherValues[child-1],op);
+				
+				GatherMessage msg(nodeIndex|0x80000000U,Message::GATHER,pipeId,nextBarrierId,subtreeValue);
+				sendToParent(*pipeState,&msg,sizeof(GatherMessage));
+				}
 			
 			/* Wait for arrival of barrier completion message: */
 			waitTimeout+=barrierWaitTimeout;
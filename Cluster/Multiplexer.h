@@ -1,7 +1,7 @@
 /***********************************************************************
 Multiplexer - Class to share several intra-cluster multicast pipes
 across a single UDP socket connection.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2026 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -43,6 +43,13 @@ namespace Cluster {
 class Multiplexer
 	{
 	/* Embedded classes: */
+	public:
+	enum BarrierMode // Enumerated type for the ways barriers and gather operations are processed on a pipe
+		{
+		CENTRAL, // Master collects barrier and gather messages from all slaves directly
+		TREE // Barrier and gather messages are reduced along a tree of slaves with logarithmic depth rooted at the master
+		};
+	
 	private:
 	struct PipeState // Structure storing the current state of a pipe
 		{
@@ -79,6 +86,7 @@ class Multiplexer
 				}
 			void push_back(Packet* packet); // Pushes the given packet on the back of the list
 			Packet* pop_front(void); // Removes the packet at the front of the list and returns pointer to it
+			bool insert(Packet* packet,unsigned int baseStreamPos); // Inserts the given packet into a list sorted by stream position relative to the given base stream position; returns false if the list already contains a packet of the same stream position
 			};
 		
 		/* Elements: */
@@ -88,15 +96,17 @@ class Multiplexer
 		Threads::Cond receiveCond; // Condition variable receivers wait on when the delivery queue is empty
 		Threads::Cond barrierCond; // Condition variable all nodes wait on while processing a barrier
 		unsigned int streamPos; // Total amount of bytes that has been sent/received on this pipe so far
-		bool packetLossMode; // True if the pipe is currently recovering from lost data
+		Misc::Time lastNackTime; // Time at which the last negative acknowledgment was sent for this pipe (on the slave side)
 		PacketList packetList; // List of packets to be delivered to readers (on the slave side) or recently sent (on the master side)
+		PacketList outOfOrderList; // List of packets received ahead of the current stream position, sorted by stream position (on the slave side)
 		unsigned int headStreamPos; // Stream position currently at the head of the packet list
 		unsigned int* slaveStreamPosOffsets; // Array of stream positions of the slaves relative to beginning of packet list
 		unsigned int numHeadSlaves; // Number of slaves that still have not acknowledged the first packet in the packet list
+		BarrierMode barrierMode; // Way barriers and gather operations are processed on this pipe
 		unsigned int barrierId; // Unique identifier of last completed barrier in pipe
-		unsigned int* slaveBarrierIds; // Array of most recently received barrier messages from the slaves
-		unsigned int minSlaveBarrierId; // Smallest barrier ID currently in the state array
-		unsigned int* slaveGatherValues; // Array of most recently received gather values from the slaves
+		unsigned int* slaveBarrierIds; // Array of most recently received barrier messages from the slaves; on slaves, only entries of the slave's children in the barrier tree are used
+		unsigned int minSlaveBarrierId; // Smallest barrier ID of this node's children in the pipe's barrier topology
+		unsigned int* slaveGatherValues; // Array of most recently received gather values from the slaves, which are accumulated over each slave's subtree in tree mode
 		unsigned int masterGatherValue; // Final value of last completed gather operation in pipe
 		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 		size_t numResentPackets;
@@ -104,7 +114,7 @@ class Multiplexer
 		#endif
 		
 		/* Constructors and destructors: */
-		PipeState(unsigned int nodeIndex,unsigned int numSlaves); // Creates empty pipe state
+		PipeState(unsigned int nodeIndex,unsigned int numSlaves,BarrierMode sBarrierMode); // Creates empty pipe state using the given barrier mode
 		~PipeState(void); // Destroys a pipe state and all buffers in its delivery queue
 		};
 	
@@ -183,7 +193,13 @@ class Multiplexer
 	struct sockaddr_in* otherAddress; // Pointer to socket address of other end of multicast connection
 	SocketMutex socketMutex; // Mutex serializing (write) access to the UDP socket
 	int socketFd; // File descriptor for the UDP socket
+	int treeSocketFd; // File descriptor for a UDP socket on slave nodes to receive barrier and gather messages from other slaves in the barrier tree
+	struct sockaddr_in* slaveTreeAddresses; // Array of socket addresses of all slaves' barrier tree sockets, distributed by the master during connection establishment
+	bool haveSlaveTreeAddresses; // Flag whether the array of barrier tree socket addresses is valid
+	unsigned int barrierTreeFanIn; // Maximum number of children of each node in the barrier tree
+	BarrierMode defaultBarrierMode; // Barrier mode for newly-opened pipes
 	bool connected; // Flag to indicate whether connection between master and all slaves has been established
+	unsigned int incompatibleNodeIndex; // Index of a slave node whose connection message does not match this node's protocol version, or 0 if no incompatible slave has been detected
 	Threads::MutexCond connectionCond; // Condition variable to wait on for connection establishment
 	Threads::Mutex pipeStateTableMutex; // Mutex serializing access to the the pipe state table
 	NewPipeHasher newPipes; // Hash table to map from thread IDs to pipe states not completely opened yet
@@ -199,13 +215,27 @@ class Multiplexer
 	int maxPingRequests; // Maximum number of consecutive ping requests before the slave signals a communication error
 	Misc::Time receiveWaitTimeout; // Timeout between packet loss messages from the slaves
 	Misc::Time barrierWaitTimeout; // Timeout between barrier messages from the slaves
-	unsigned int sendBufferSize; // Maximum number of packets buffered for each pipe
+	unsigned int sendBufferSize; // Maximum number of packets buffered for each pipe, i.e., size of the sliding window of unacknowledged packets
+	unsigned int acknowledgmentInterval; // Number of in-order packets a slave receives between sending positive acknowledgments
+	Misc::Time nackTimeout; // Minimum time between repeated negative acknowledgments for the same pipe
+	double maxSendRate; // Maximum rate at which the master sends stream data in bytes per second, or 0 for unlimited
+	Threads::Spinlock pacingMutex; // Mutex protecting the send pacing state
+	Misc::Time nextSendTime; // Earliest time at which the master may send the next stream packet under the configured send rate
 	Threads::Spinlock packetPoolMutex; // Mutex protecting the free packet pool
 	Packet* packetPoolHead; // Pool of recently deleted packets to minimize number of new/delete calls
 	
 	/* Private methods: */
 	Packet* allocatePacket(void);
 	void processAcknowledgment(LockedPipe& pipeState,int slaveIndex,unsigned int streamPos); // Processes an acknowlegment (positive or implied-positive) from a slave
+	void pace(size_t numBytes,bool wait); // Accounts for sending the given number of bytes under the configured send rate; blocks until the bytes may be sent if wait is true
+	void sendConnectionMessage(int burstSize); // Sends a connection establishment message including the slaves' barrier tree socket addresses from the master to all slaves
+	bool canUseBarrierTree(void) const; // Returns true if the barrier tree socket addresses of all slaves can be distributed in a single connection message
+	void getChildRange(const PipeState& pipeState,unsigned int& firstChild,unsigned int& lastChild) const; // Returns the half-open range of node indices of this node's children in the given pipe's barrier topology
+	unsigned int getParentIndex(const PipeState& pipeState) const; // Returns the node index of this slave node's parent in the given pipe's barrier topology
+	void updateMinSlaveBarrierId(PipeState& pipeState) const; // Recalculates the smallest barrier ID of this node's children in the given pipe's barrier topology
+	void sendToParent(const PipeState& pipeState,const void* message,size_t messageSize); // Sends a barrier or gather message from this slave node to its parent in the given pipe's barrier topology
+	void processTreeMessage(void); // Processes a message received on a slave's barrier tree socket
+	void sendNegativeAcknowledgment(LockedPipe& pipeState,bool includeTail); // Sends a negative acknowledgment listing all missing stream data ranges of the given pipe from a slave to the master; requests all data after the last received packet as well if includeTail is true
 	void* packetHandlingThreadMaster(void); // Packet handling thread method for the master
 	void* packetHandlingThreadSlave(void); // Packet handling thread method for the slaves
 	
@@ -255,8 +285,13 @@ class Multiplexer
 	void setPingTimeout(Misc::Time newPingTimeout,int newMaxPingRequests); // Sets the time after which slaves request a ping packet when no data is received, and the maximum number of requests sent before a connection error is signaled
 	void setReceiveWaitTimeout(Misc::Time newReceiveWaitTimeout); // Sets the timeout when waiting for data packages
 	void setBarrierWaitTimeout(Misc::Time newBarrierWaitTimeout); // Sets the timeout when waiting for barrier messages
-	void setSendBufferSize(unsigned int newSendBufferSize); // Sets the maximum number of packets held in each pipe's send queue
-	void waitForConnection(void); // Waits until all slaves have connected to the master
+	void setSendBufferSize(unsigned int newSendBufferSize); // Sets the maximum number of packets held in each pipe's send queue, i.e., the size of the sliding window of unacknowledged packets
+	void setAcknowledgmentInterval(unsigned int newAcknowledgmentInterval); // Sets the number of in-order packets a slave receives between positive acknowledgments; 0 uses the number of slaves; should be smaller than the master's send buffer size
+	void setNackTimeout(Misc::Time newNackTimeout); // Sets the minimum time between repeated negative acknowledgments for the same pipe
+	void setMaxSendRate(double newMaxSendRate); // Sets the maximum rate at which the master sends stream data in bytes per second; 0 disables rate control
+	void setBarrierTreeFanIn(unsigned int newBarrierTreeFanIn); // Sets the maximum number of children of each node in the barrier tree; must be called on all nodes with the same value before any pipe uses tree mode
+	void setDefaultBarrierMode(BarrierMode newDefaultBarrierMode); // Sets the barrier mode for pipes opened afterwards; must be called on all nodes with the same value
+	void waitForConnection(void); // Waits until all slaves have connected to the master; throws an exception on the master if a slave uses an incompatible protocol version
 	
 	/* Pipe management interface: */
 	unsigned int openPipe(void); // Creates a new multicast pipe and returns its pipe ID
@@ -265,6 +300,7 @@ class Multiplexer
 	/* Pipe communication interface: */
 	void sendPacket(unsigned int pipeId,Packet* packet); // Sends a packet from the master to the slaves
 	Packet* receivePacket(unsigned int pipeId); // Receives a packet from the master
+	void setBarrierMode(unsigned int pipeId,BarrierMode newBarrierMode); // Sets the barrier mode of the given pipe; must be called on all nodes between the same two barriers; falls back to central mode if tree mode is not supported by the cluster size
 	void barrier(unsigned int pipeId); // Waits until all nodes (master + slaves) have reached the same point in the program
 	unsigned int gather(unsigned int pipeId,unsigned int value,GatherOperation::OpCode op); // Exchanges a single value between all nodes (master + slaves); implies a barrier
 	};
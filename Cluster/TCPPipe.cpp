@@ -1,7 +1,7 @@
 /***********************************************************************
 TCPPipe - Pair of classes for high-performance cluster-transparent
 reading/writing from/to TCP sockets.
-Copyright (c) 2011-2024 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the Cluster Abstraction Library (Cluster).
 
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/StdError.h>
 #include <Misc/StringMarshaller.h>
 #include <Misc/FdSet.h>
+#include <Threads/Profiler.h>
 
 namespace Cluster {
 
@@ -112,6 +113,8 @@ Methods of class TCPPipeMaster:
 
 size_t TCPPipeMaster::readData(IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::TCPPipe::readData");
+	
 	/* Read more data from source: */
 	ssize_t readResult;
 	do
@@ -163,6 +166,8 @@ size_t TCPPipeMaster::readData(IO::File::Byte* buffer,size_t bufferSize)
 
 void TCPPipeMaster::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::TCPPipe::writeData");
+	
 	/* Collect error codes: */
 	int errorType=0;
 	int errorCode=0;
@@ -218,6 +223,8 @@ void TCPPipeMaster::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 
 size_t TCPPipeMaster::writeDataUpTo(const IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::TCPPipe::writeData");
+	
 	/* Collect error codes: */
 	int errorType=0;
 	int errorCode=0;
@@ -743,6 +750,8 @@ Methods of class TCPPipeSlave:
 
 size_t TCPPipeSlave::readData(IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::TCPPipe::readData");
+	
 	if(isReadCoupled())
 		{
 		/* Receive a data packet from the master: */
@@ -784,6 +793,8 @@ size_t TCPPipeSlave::readData(IO::File::Byte* buffer,size_t bufferSize)
 
 void TCPPipeSlave::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::TCPPipe::writeData");
+	
 	if(isWriteCoupled())
 		{
 		/* Receive a status packet from the master: */
@@ -801,6 +812,8 @@ void TCPPipeSlave::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 
 size_t TCPPipeSlave::writeDataUpTo(const IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Threads::Profiler::Zone zone("Cluster::TCPPipe::writeData");
+	
 	if(isWriteCoupled())
 		{
 		/* Receive a status packet from the master: */
@@ -1,7 +1,7 @@
 /***********************************************************************
 TCPPipe - Class for high-performance reading/writing from/to connected
 TCP sockets.
-Copyright (c) 2010-2024 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -25,6 +25,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -122,6 +124,52 @@ size_t TCPPipe::writeDataUpTo(const IO::File::Byte* buffer,size_t bufferSize)
 		}
 	}
 
+void TCPPipe::writeDataVectored(const struct iovec* vectors,int numVectors)
+	{
+	while(numVectors>0)
+		{
+		/* Write as many buffers as the operating system allows in one call: */
+		ssize_t writeResult=::writev(fd,vectors,numVectors<IOV_MAX?numVectors:IOV_MAX);
+		if(writeResult>0)
+			{
+			/* Skip all completely written buffers: */
+			size_t writeSize=size_t(writeResult);
+			while(numVectors>0&&writeSize>=vectors->iov_len)
+				{
+				writeSize-=vectors->iov_len;
+				++vectors;
+				--numVectors;
+				}
+			
+			/* Write the remainder of a partially written buffer individually: */
+			if(writeSize>0)
+				{
+				writeData(static_cast<const Byte*>(vectors->iov_base)+writeSize,vectors->iov_len-writeSize);
+				++vectors;
+				--numVectors;
+				}
+			}
+		else if(writeResult==0)
+			{
+			/* Skip empty buffers, or signal that the sink has reached end-of-file: */
+			if(vectors->iov_len!=0)
+				throw WriteError(__PRETTY_FUNCTION__,vectors->iov_len);
+			++vectors;
+			--numVectors;
+			}
+		else if(errno==EPIPE)
+			{
+			/* Other side hung up: */
+			throw Error(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Connection terminated by peer"));
+			}
+		else if(errno!=EAGAIN&&errno!=EWOULDBLOCK&&errno!=EINTR)
+			{
+			/* Unknown error; probably a bad thing: */
+			throw Error(Misc::makeLibcErrMsg(__PRETTY_FUNCTION__,errno,"Cannot write to pipe"));
+			}
+		}
+	}
+
 namespace {
 
 /****************
@@ -1,7 +1,7 @@
 /***********************************************************************
 TCPPipe - Class for high-performance reading/writing from/to connected
 TCP sockets.
-Copyright (c) 2010-2015 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -44,6 +44,7 @@ class TCPPipe:public NetPipe
 	virtual size_t readData(Byte* buffer,size_t bufferSize);
 	virtual void writeData(const Byte* buffer,size_t bufferSize);
 	virtual size_t writeDataUpTo(const Byte* buffer,size_t bufferSize);
+	virtual void writeDataVectored(const struct iovec* vectors,int numVectors);
 	
 	/* Constructors and destructors: */
 	public:
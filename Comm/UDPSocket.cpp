@@ -1,6 +1,6 @@
 /***********************************************************************
 UDPSocket - Wrapper class for UDP sockets ensuring exception safety.
-Copyright (c) 2004-2024 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -113,6 +113,42 @@ UDPSocket::UDPSocket(int localPortId,const IPv4SocketAddress& hostAddress)
 		}
 	}
 
+UDPSocket::UDPSocket(const IPv4SocketAddress& groupAddress,const IPv4Address& interfaceAddress)
+	{
+	/* Create the socket file descriptor: */
+	socketFd=socket(PF_INET,SOCK_DGRAM,0);
+	if(socketFd<0)
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Unable to create socket");
+	
+	/* Allow other sockets on the local host to bind to the same multicast group and port: */
+	int reuseAddr=1;
+	if(setsockopt(socketFd,SOL_SOCKET,SO_REUSEADDR,&reuseAddr,sizeof(int))<0)
+		{
+		int myerrno=errno;
+		close(socketFd);
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,myerrno,"Unable to share socket address");
+		}
+	
+	/* Bind the socket file descriptor to the multicast group address to only receive datagrams sent to the group: */
+	if(bind(socketFd,(const struct sockaddr*)&groupAddress,sizeof(IPv4SocketAddress))==-1)
+		{
+		int myerrno=errno;
+		close(socketFd);
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,myerrno,"Unable to bind socket to multicast group %s on port %d",groupAddress.getAddress().getAddress().c_str(),groupAddress.getPort());
+		}
+	
+	/* Join the multicast group: */
+	try
+		{
+		joinMulticastGroup(groupAddress.getAddress(),interfaceAddress);
+		}
+	catch(...)
+		{
+		close(socketFd);
+		throw;
+		}
+	}
+
 UDPSocket::UDPSocket(const UDPSocket& source)
 	:socketFd(dup(source.socketFd))
 	{
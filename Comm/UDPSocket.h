@@ -1,6 +1,6 @@
 /***********************************************************************
 UDPSocket - Wrapper class for UDP sockets ensuring exception safety.
-Copyright (c) 2004-2018 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -70,6 +70,7 @@ class UDPSocket
 	UDPSocket(int localPortId,int backlog); // Creates an unconnected socket on the local host; if portId is negative, random free port is assigned
 	UDPSocket(int localPortId,const std::string& hostname,int hostPortId); // Creates a socket connected to a remote host; if localPortId is negative, random free port is assigned
 	UDPSocket(int localPortId,const IPv4SocketAddress& hostAddress); // Ditto, using an IP v4 socket address
+	UDPSocket(const IPv4SocketAddress& groupAddress,const IPv4Address& interfaceAddress); // Creates an unconnected socket bound to the given multicast group address and port, which can be shared with other sockets on the local host, and joins the multicast group on the given interface
 	UDPSocket(const UDPSocket& source); // Copy constructor
 	UDPSocket& operator=(const UDPSocket& source); // Assignment operator
 	~UDPSocket(void); // Closes a socket
@@ -1,7 +1,7 @@
 /***********************************************************************
 UNIXPipe - Class for high-performance reading/writing from/to connected
 UNIX domain sockets.
-Copyright (c) 2022 Oliver Kreylos
+Copyright (c) 2022-2026 Oliver Kreylos
 
 This file is part of the Portable Communications Library (Comm).
 
@@ -44,6 +44,7 @@ class UNIXPipe:public Pipe
 	virtual size_t readData(Byte* buffer,size_t bufferSize);
 	virtual void writeData(const Byte* buffer,size_t bufferSize);
 	virtual size_t writeDataUpTo(const Byte* buffer,size_t bufferSize);
+	virtual void writeDataVectored(const struct iovec* vectors,int numVectors);
 	
 	/* Constructors and destructors: */
 	public:
@@ -0,0 +1,27 @@
+/***********************************************************************
+Config - Configuration header file for DBus C++ Wrapper Library.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the DBus C++ Wrapper Library (DBus).
+
+The DBus C++ Wrapper Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The DBus C++ Wrapper Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the DBus C++ Wrapper Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef DBUS_CONFIG_INCLUDED
+#define DBUS_CONFIG_INCLUDED
+
+#define DBUS_CONFIG_HAVE_LIBDBUS 0
+
+#endif
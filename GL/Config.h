@@ -0,0 +1,33 @@
+/***********************************************************************
+Config - Configuration header file for the OpenGL Support Library.
+Copyright (c) 2010-2023 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef GLSUPPORT_CONFIG_INCLUDED
+#define GLSUPPORT_CONFIG_INCLUDED
+
+#define GLSUPPORT_CONFIG_HAVE_GLXGETPROCADDRESS 1
+
+#define GLSUPPORT_CONFIG_USE_TLS 0
+#define GLSUPPORT_CONFIG_HAVE_BUILTIN_TLS 1
+
+#define GLSUPPORT_CONFIG_GL_FONT_DIR "/usr/local/share/Vrui-14.1/GLFonts"
+#define GLSUPPORT_CONFIG_SHADERDIR "/usr/local/share/Vrui-14.1/Shaders/GLSupport"
+
+#endif
@@ -0,0 +1,118 @@
+/***********************************************************************
+BucketKdTree - Class to store k-dimensional points in an implicit kd-tree
+with buckets of points in its leaves, whose coordinates are stored in
+structure-of-arrays layout to evaluate distances using SIMD instructions.
+Version for fixed sets of points optimized for large numbers of nearest
+neighbour queries.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Templatized Geometry Library (TGL).
+
+The Templatized Geometry Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Templatized Geometry Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Templatized Geometry Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef GEOMETRY_BUCKETKDTREE_INCLUDED
+#define GEOMETRY_BUCKETKDTREE_INCLUDED
+
+#include <stddef.h>
+#include <Geometry/Point.h>
+#include <Geometry/ClosePointSet.h>
+
+namespace Geometry {
+
+template <class StoredPointParam>
+class BucketKdTree
+	{
+	/* Embedded classes: */
+	public:
+	typedef StoredPointParam StoredPoint; // Type of points stored in kd-tree (typically with some associated value)
+	typedef typename StoredPoint::Point Point; // Type for positions
+	typedef typename Point::Scalar Scalar; // Scalar type used by points
+	static const int dimension=Point::dimension; // Dimension of points and kd-tree
+	typedef Geometry::ClosePointSet<StoredPoint> ClosePointSet; // Type for nearest neighbours query results
+	
+	private:
+	struct SubTree // Structure describing a sub-kd-tree to be created by a parallel job
+		{
+		/* Elements: */
+		public:
+		int nodeIndex; // Index of the sub-kd-tree's root node
+		int begin,end; // Range of points in the sub-kd-tree
+		};
+	class SubTreeCreator; // Helper class to create sub-kd-trees in parallel
+	
+	/* Elements: */
+	private:
+	int maxBucketSize; // Maximum number of points in a leaf's bucket
+	int numPoints; // Total number of points in kd-tree
+	StoredPoint* points; // Array of points, sorted by leaf
+	Scalar* coords; // Point coordinates in structure-of-arrays layout, with the coordinates of each dimension in a contiguous run of numPoints scalars
+	int numLeaves; // Number of leaves in the kd-tree; always a power of two
+	int* leafBegins; // Array of numLeaves+1 indices of the first point in each leaf's bucket
+	int* splitDimensions; // Split dimensions of the numLeaves-1 interior nodes in heap order
+	Scalar* splitValues; // Split values of the numLeaves-1 interior nodes in heap order
+	
+	/* Private methods: */
+	int splitNode(int nodeIndex,int begin,int end); // Splits the given range of points at the given interior node along its widest dimension; returns the index of the first point in the right child
+	void createTree(int nodeIndex,int begin,int end); // Creates the sub-kd-tree rooted at the given interior node or leaf over the given range of points
+	void collectSubTrees(int nodeIndex,int begin,int end,int numLevels,SubTree*& subTreePtr); // Splits the given number of levels below the given node and collects the resulting sub-kd-trees
+	void createTree(void); // Creates a balanced kd-tree over the current point array
+	template <class ResultParam>
+	void findLeafPoints(int leafIndex,const Scalar query[dimension],ResultParam& result) const; // Enters all points in the given leaf's bucket into the given result collector
+	template <class ResultParam>
+	void findPoints(const Point& queryPosition,ResultParam& result) const; // Enters all points that might be closer than the result collector's current maximum distance into the collector
+	
+	/* Constructors and destructors: */
+	public:
+	BucketKdTree(int sMaxBucketSize =16) // Creates empty kd-tree with the given maximum bucket size
+		:maxBucketSize(sMaxBucketSize),numPoints(0),points(0),coords(0),
+		 numLeaves(0),leafBegins(0),splitDimensions(0),splitValues(0)
+		{
+		}
+	BucketKdTree(int sNumPoints,const StoredPoint sPoints[],int sMaxBucketSize =16); // Creates balanced kd-tree from point array
+	private:
+	BucketKdTree(const BucketKdTree& source); // Prohibit copy constructor
+	BucketKdTree& operator=(const BucketKdTree& source); // Prohibit assignment operator
+	public:
+	~BucketKdTree(void);
+	
+	/* Methods: */
+	int getMaxBucketSize(void) const // Returns the maximum number of points in a leaf's bucket
+		{
+		return maxBucketSize;
+		}
+	int getNumPoints(void) const // Returns the number of points in the tree
+		{
+		return numPoints;
+		}
+	const StoredPoint* accessPoints(void) const // Returns pointer to point array, sorted by leaf, for one-by-one inspection
+		{
+		return points;
+		}
+	void setPoints(int newNumPoints,const StoredPoint newPoints[]); // Creates balanced kd-tree from point array
+	void clear(void); // Removes all points from the tree
+	const StoredPoint& findClosestPoint(const Point& queryPosition) const; // Returns the stored point closest to the query position; tree must not be empty
+	ClosePointSet& findClosestPoints(const Point& queryPosition,ClosePointSet& closestPoints) const; // Returns a set of closest points
+	void findClosestPoints(size_t numQueries,const Point queryPositions[],int numNeighbours,const StoredPoint* neighbours[],Scalar neighbourSqrDists[]) const; // Finds the given number of closest points for each of the given query positions in parallel; stores numNeighbours results per query ordered by increasing distance, padded with null pointers and maximum distances if the tree has fewer points
+	};
+
+}
+
+#if !defined(GEOMETRY_BUCKETKDTREE_IMPLEMENTATION)
+#include <Geometry/BucketKdTree.icpp>
+#endif
+
+#endif
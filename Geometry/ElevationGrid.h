@@ -1,7 +1,9 @@
 /***********************************************************************
 ElevationGrid - Class implementing ray intersection tests with regular
-integer-lattice 2D elevation grids embedded in 3D space.
-Copyright (c) 2017 Oliver Kreylos
+integer-lattice 2D elevation grids embedded in 3D space, optionally
+accelerated by a pyramid of minimum/maximum elevations over blocks of
+grid cells.
+Copyright (c) 2017-2026 Oliver Kreylos
 
 This file is part of the Templatized Geometry Library (TGL).
 
@@ -24,6 +26,9 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_ELEVATIONGRID_INCLUDED
 #define GEOMETRY_ELEVATIONGRID_INCLUDED
 
+#include <stddef.h>
+#include <vector>
+
 /* Forward declarations: */
 namespace Geometry {
 template <class ScalarParam,int dimensionParam>
@@ -44,40 +49,65 @@ class ElevationGrid
 	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors
 	typedef ElevationScalarParam ElevationScalar; // Scalar type of elevations stored in grid
 	
-	/* Elements: */
 	private:
-	Scalar foo;
-	ElevationScalar bar;
+	struct BlockRange // Structure holding the elevation range of a square block of grid cells
+		{
+		/* Elements: */
+		public:
+		ElevationScalar min,max; // Minimum and maximum elevation of all grid vertices touched by the block's cells
+		};
+	
+	struct PyramidLevel // Structure holding the elevation ranges of all blocks of one pyramid level
+		{
+		/* Elements: */
+		public:
+		int size[2]; // Number of blocks in x and y
+		std::vector<BlockRange> blocks; // Array of block ranges in row-major order
+		};
+	
+	/* Elements: */
 	int size[2]; // Width and height of the attached grid storage
 	const ElevationScalar* grid; // Pointer to the base vertex of the attached grid storage
 	Scalar elevationMin,elevationMax; // Range of elevations in the attached grid storage, if known
+	int leafBlockSizeLog; // Binary logarithm of the number of grid cells along each side of a block in the finest pyramid level
+	std::vector<PyramidLevel> pyramid; // Elevation range pyramid from finest to coarsest level, where the coarsest level has a single block; empty if no pyramid was built
 	
 	/* Private methods: */
 	bool restrictInterval(const Point& p0,const Point& p1,Scalar& lambda0,Scalar& lambda1) const; // Restricts the given line interval to the elevation grid's domain; returns false if result interval is empty
+	Scalar intersectCell(const int ci[2],const Point& p0,const Point& p1,Scalar lambda0,Scalar lambda1) const; // Intersects the given ray interval with the bilinear surface patch of the given grid cell; returns intersection parameter or 1 if there is no intersection
+	Scalar intersectCells(const Point& p0,const Point& p1,Scalar lambda0,Scalar lambda1,const int cellMin[2],const int cellMax[2]) const; // Intersects the given ray interval with the grid cells in the given half-open index range by traversing them in ray order
+	Scalar intersectBlock(int level,int bx,int by,const Point& p0,const Point& p1,Scalar lambda0,Scalar lambda1) const; // Intersects the given ray interval with the given block of the given pyramid level by skipping or recursively subdividing it
 	
 	/* Constructors and destructors: */
 	public:
 	ElevationGrid(void) // Creates an elevation grid with no attached grid storage
-		:grid(0)
+		:grid(0),leafBlockSizeLog(0)
 		{
 		}
 	ElevationGrid(const int sSize[2],const ElevationScalar* sGrid) // Creates an elevation grid with the given grid storage attached
-		:grid(0)
+		:grid(0),leafBlockSizeLog(0)
 		{
 		/* Attach the given grid storage: */
 		setGrid(sSize,sGrid);
 		}
 	ElevationGrid(const int sSize[2],const ElevationScalar* sGrid,Scalar sElevationMin,Scalar sElevationMax) // Creates an elevation grid with the given grid storage attached and the given elevation range
-		:grid(0)
+		:grid(0),leafBlockSizeLog(0)
 		{
 		/* Attach the given grid storage with the given elevation range: */
 		setGrid(sSize,sGrid,sElevationMin,sElevationMax);
 		}
 	
 	/* Methods: */
-	void setGrid(const int sSize[2],const ElevationScalar* sGrid); // Attaches the given grid with no known elevation range
+	void setGrid(const int sSize[2],const ElevationScalar* sGrid); // Attaches the given grid with no known elevation range; releases the elevation range pyramid
 	void setGrid(const int sSize[2],const ElevationScalar* sGrid,Scalar sElevationMin,Scalar sElevationMax); // Ditto, with known elevation range
+	void buildPyramid(int leafBlockSize =8); // Builds an elevation range pyramid over the attached grid, whose finest level has blocks of the given number of grid cells along each side, rounded down to a power of two; also sets the grid's exact elevation range
+	void releasePyramid(void); // Releases the elevation range pyramid
+	bool hasPyramid(void) const // Returns true if the elevation grid has an elevation range pyramid
+		{
+		return !pyramid.empty();
+		}
 	Scalar intersectRay(const Point& p0,const Point& p1) const; // Intersects the elevation grid with a ray from the first to the second point; intersection is valid if result in [0, 1)
+	void intersectRays(size_t numRays,const Point p0s[],const Point p1s[],Scalar results[]) const; // Intersects the elevation grid with the given number of rays in parallel and stores each ray's intersection parameter in the result array
 	};
 
 }
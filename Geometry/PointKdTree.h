@@ -1,6 +1,6 @@
 /***********************************************************************
 PointKdTree - Class to store k-dimensional points in a kd-tree.
-Copyright (c) 2003-2010 Oliver Kreylos
+Copyright (c) 2003-2026 Oliver Kreylos
 
 This file is part of the Templatized Geometry Library (TGL).
 
@@ -23,6 +23,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_POINTKDTREE_INCLUDED
 #define GEOMETRY_POINTKDTREE_INCLUDED
 
+#include <stddef.h>
+#include <vector>
 #include <Misc/PoolAllocator.h>
 #include <Geometry/Point.h>
 #include <Geometry/ClosePointSet.h>
@@ -70,7 +72,6 @@ class PointKdTree
 			:point(sPoint),left(sLeft),right(sRight)
 			{
 			}
-		Node(int numPoints,StoredPoint points[],int splitDimension,Scalar heap[]); // Creates sub-kd-tree for array of points; shuffles point array
 		~Node(void) // Destroys node's subtree
 			{
 			delete left;
@@ -87,7 +88,6 @@ class PointKdTree
 			nodeAllocator.free(pointer);
 			}
 		
-		void insertPoint(const StoredPoint& newPoint,int splitDimension); // Inserts a new point below this node
 		TreeStats getTreeStatistics(void) const; // Returns tree statistics
 		template <class TraversalFunctionParam>
 		void traverseTree(TraversalFunctionParam& traversalFunction) const // Traverses subtree in prefix order and calls traversal function for each node
@@ -146,21 +146,43 @@ class PointKdTree
 			}
 		};
 	
+	struct SubTreeJob // Structure describing a sub-kd-tree to be created by a parallel job
+		{
+		/* Elements: */
+		public:
+		int numPoints; // Number of points in the sub-kd-tree
+		StoredPoint* points; // Array of points in the sub-kd-tree
+		int splitDimension; // Split dimension of the sub-kd-tree's root node
+		void** slots; // Array of pre-allocated node slots, one per point
+		Node** link; // Pointer to the link that will point to the sub-kd-tree's root node
+		};
+	
+	class SubTreeCreator; // Helper class to create sub-kd-trees in parallel
+	
 	/* Elements: */
 	Node* root; // Pointer to root node
+	int numNodes; // Number of nodes, i.e., points, in the kd-tree
+	int maxNumNodes; // Maximum number of nodes in the kd-tree since it was last rebuilt entirely
+	
+	/* Private methods: */
+	static Node* createSubTree(int numPoints,StoredPoint points[],int splitDimension,void* slots[]); // Creates a balanced sub-kd-tree for an array of points in pre-allocated node slots; shuffles point array
+	static void collectSubTrees(int numPoints,StoredPoint points[],int splitDimension,void* slots[],int numLevels,Node** link,std::vector<SubTreeJob>& jobs); // Creates the given number of levels of a balanced sub-kd-tree and collects jobs to create the remaining sub-kd-trees
+	static Node* createTree(int numPoints,StoredPoint points[],int splitDimension); // Creates a balanced sub-kd-tree for an array of points using multiple threads; shuffles point array
+	static int countNodes(const Node* node); // Returns the number of nodes in the given sub-kd-tree
+	static void gatherPoints(const Node* node,std::vector<StoredPoint>& points); // Appends all points in the given sub-kd-tree to the given list
+	static Node** findPoint(Node** link,int splitDimension,const Point& position,int& nodeSplitDimension); // Returns the link to a node in the given sub-kd-tree storing a point at the given position, or null; returns the node's split dimension
+	void rebuildSubTree(Node** link,int splitDimension,int subTreeSize); // Replaces the given sub-kd-tree of the given size with a balanced sub-kd-tree
 	
 	/* Constructors and destructors: */
 	public:
 	PointKdTree(void) // Creates an empty kd-tree
-		:root(0)
+		:root(0),numNodes(0),maxNumNodes(0)
 		{
 		}
-	PointKdTree(int numPoints,StoredPoint points[]) // Creates balanced kd-tree from point array; shuffles point array in the process
-		:root(0)
+	PointKdTree(int numPoints,StoredPoint points[]) // Creates balanced kd-tree from point array using multiple threads; shuffles point array in the process
+		:root(0),numNodes(0),maxNumNodes(0)
 		{
-		Scalar* heap=new Scalar[numPoints];
-		root=new Node(numPoints,points,0,heap);
-		delete[] heap;
+		setPoints(numPoints,points);
 		}
 	~PointKdTree(void)
 		{
@@ -168,25 +190,25 @@ class PointKdTree
 		}
 	
 	/* Methods: */
-	void setPoints(int numPoints,StoredPoint points[]) // Creates balanced kd-tree from point array; shuffles point array in the process
+	int getNumPoints(void) const // Returns the number of points in the kd-tree
 		{
-		delete root;
-		Scalar* heap=new Scalar[numPoints];
-		root=new Node(numPoints,points,0,heap);
-		delete[] heap;
+		return numNodes;
 		}
-	void insertPoint(const StoredPoint& newPoint) // Inserts a new point into the kd-tree
+	void setPoints(int numPoints,StoredPoint points[]) // Creates balanced kd-tree from point array using multiple threads; shuffles point array in the process
 		{
-		if(root!=0)
-			root->insertPoint(newPoint,0);
-		else
-			root=new Node(newPoint);
+		delete root;
+		root=createTree(numPoints,points,0);
+		numNodes=numPoints;
+		maxNumNodes=numPoints;
 		}
+	void insertPoint(const StoredPoint& newPoint); // Inserts a new point into the kd-tree; rebalances the smallest unbalanced sub-kd-tree along the insertion path if the tree becomes too deep
+	bool removePoint(const Point& position); // Removes one point at exactly the given position from the kd-tree and rebalances the sub-kd-tree that contained it; returns false if there is no such point
 	TreeStats getTreeStatistics(void) const; // Returns tree statistics
 	template <class TraversalFunctionParam>
 	void traverseTree(TraversalFunctionParam& traversalFunction) const // Traverses tree in prefix order and calls traversal function for each node
 		{
-		root->traverseTree(traversalFunction);
+		if(root!=0)
+			root->traverseTree(traversalFunction);
 		}
 	const StoredPoint& findClosePoint(const Point& queryPosition) const; // Returns a stored point that is close to the query position
 	const StoredPoint& findClosestPoint(const Point& queryPosition) const; // Returns the stored point closest to the query position
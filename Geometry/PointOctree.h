@@ -1,6 +1,6 @@
 /***********************************************************************
 PointOctree - Class to store three--dimensional points in an octree.
-Copyright (c) 2003-2010 Oliver Kreylos
+Copyright (c) 2003-2026 Oliver Kreylos
 
 This file is part of the Templatized Geometry Library (TGL).
 
@@ -23,6 +23,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_POINTOCTREE_INCLUDED
 #define GEOMETRY_POINTOCTREE_INCLUDED
 
+#include <vector>
 #include <Geometry/Vector.h>
 #include <Geometry/Point.h>
 #include <Geometry/ValuedPoint.h>
@@ -74,6 +75,21 @@ class PointOctree
 			}
 		};
 	
+	struct Node;
+	
+	struct InitJob // Structure describing an octree subtree to be created by a parallel job
+		{
+		/* Elements: */
+		public:
+		Node* node; // Root node of the subtree
+		Traversal traversal; // Traversal structure describing the subtree's root
+		int numPoints; // Number of points in the subtree
+		StoredPoint* points; // Subarray of points in the subtree
+		int maxDepth; // Maximum depth of the subtree
+		};
+	
+	class NodeInitializer; // Helper class to create octree subtrees in parallel
+	
 	struct Node
 		{
 		/* Elements: */
@@ -85,6 +101,7 @@ class PointOctree
 		/* Helper methods: */
 		private:
 		static int splitPoints(int direction,Scalar mid,int numPoints,StoredPoint* points); // Splits a point array
+		static void splitOctants(const Point& center,int numPoints,StoredPoint* points,int split[9]); // Splits a point array into the eight octants around the given center; returns subarray boundaries
 		
 		/* Constructors and destructors: */
 		public:
@@ -99,6 +116,7 @@ class PointOctree
 		
 		/* Methods: */
 		void initialize(const Traversal& t,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth); // Creates subtree storing the given subarray of points
+		void initialize(const Traversal& t,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth,int numLevels,std::vector<InitJob>& jobs); // Creates the given number of levels of the subtree storing the given subarray of points, and collects jobs to create the remaining subtrees
 		bool isLeaf(void) const // Checks whether a node is a leaf
 			{
 			return children==0;
@@ -138,18 +156,21 @@ class PointOctree
 	Traversal rootTraversal; // Traversal structure describing the tree's root
 	Node* root; // The root node of the tree
 	
+	/* Private methods: */
+	void createTree(int maxNumPoints,int maxDepth); // Creates the tree's nodes for the current point array using multiple threads
+	
 	/* Constructors and destructors: */
 	public:
 	PointOctree(void) // Dummy constructor
 		:points(0),root(0)
 		{
 		}
-	PointOctree(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth); // Creates an octree of the given size, containing the given points
+	PointOctree(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth); // Creates an octree of the given size, containing the given points, using multiple threads; adopts and shuffles the point array
 	~PointOctree(void);
 	
 	/* Methods: */
 	void clear(void); // Clears the octree
-	void setPoints(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth);
+	void setPoints(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth); // Ditto
 	const StoredPoint& findClosePoint(const Point& p) const // Returns a point "close" to the given point
 		{
 		return *root->findClosePoint(p,rootTraversal);
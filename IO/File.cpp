@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/File.h>
 
 #include <string.h>
+#include <sys/uio.h>
 #if DEBUGGING
 #include <iostream>
 #endif
@@ -42,6 +43,12 @@ File::ReadError::ReadError(const char* source,size_t sNumMissingBytes)
 	{
 	}
 
+File::ReadError::ReadError(const std::string& message)
+	:Error(message),
+	 numMissingBytes(0)
+	{
+	}
+
 /*************************************
 Methods of class File::UngetCharError:
 *************************************/
@@ -140,6 +147,7 @@ void File::setWriteBuffer(size_t newWriteBufferSize,File::Byte* newWriteBuffer,b
 	writeBuffer=newWriteBuffer;
 	writeBufferEnd=writeBuffer+writeBufferSize;
 	writePtr=writeBuffer;
+	writeThroughThreshold=writeBufferSize/2;
 	}
 
 size_t File::readData(File::Byte* buffer,size_t bufferSize)
@@ -160,6 +168,14 @@ size_t File::writeDataUpTo(const File::Byte* buffer,size_t bufferSize)
 	throw WriteError(__PRETTY_FUNCTION__,bufferSize);
 	}
 
+void File::writeDataVectored(const struct iovec* vectors,int numVectors)
+	{
+	/* Write each buffer individually: */
+	for(int i=0;i<numVectors;++i)
+		if(vectors[i].iov_len>0)
+			writeData(static_cast<const Byte*>(vectors[i].iov_base),vectors[i].iov_len);
+	}
+
 void File::bufferedRead(void* buffer,size_t bufferSize)
 	{
 	#if DEBUGGING
@@ -258,31 +274,29 @@ void File::bufferedWrite(const void* buffer,size_t bufferSize)
 	
 	const Byte* bufPtr=static_cast<const Byte*>(buffer);
 	
-	/* Copy the first chunk of data into the write buffer: */
-	size_t copySize=writeBufferEnd-writePtr;
-	memcpy(writePtr,bufPtr,copySize);
-	bufPtr+=copySize;
-	bufferSize-=copySize;
-	
-	/* Write the full write buffer: */
-	writeData(writeBuffer,writeBufferSize);
-	writePtr=writeBuffer;
-	
-	/* Bypass the write buffer if supported and if there is a lot of data left to write: */
-	if(bufferSize<writeBufferSize/2)
+	/* Bypass the write buffer if supported and if the data is large: */
+	if(canWriteThrough&&bufferSize>=writeThroughThreshold)
 		{
-		/* Copy the rest of the data into the write buffer: */
-		memcpy(writePtr,bufPtr,bufferSize);
-		writePtr+=bufferSize;
-		}
-	else if(canWriteThrough)
-		{
-		/* Write the rest of the data directly to the sink: */
-		writeData(bufPtr,bufferSize);
+		if(writePtr!=writeBuffer)
+			{
+			/* Write the write buffer's contents and the data in one go, without copying the data: */
+			struct iovec vectors[2];
+			vectors[0].iov_base=writeBuffer;
+			vectors[0].iov_len=writePtr-writeBuffer;
+			vectors[1].iov_base=const_cast<Byte*>(bufPtr);
+			vectors[1].iov_len=bufferSize;
+			writeDataVectored(vectors,2);
+			writePtr=writeBuffer;
+			}
+		else
+			{
+			/* Write the data directly to the sink: */
+			writeData(bufPtr,bufferSize);
+			}
 		}
 	else
 		{
-		/* Copy the rest of the data into the write buffer in multiple steps: */
+		/* Copy the data into the write buffer in multiple steps: */
 		while(bufferSize>0)
 			{
 			/* Write the write buffer to sink if it is full: */
@@ -307,7 +321,7 @@ void File::bufferedWrite(const void* buffer,size_t bufferSize)
 File::File(void)
 	:readBufferSize(0),readBuffer(0),readDataEnd(0),haveEof(false),readPtr(0),
 	 canReadThrough(true),readMustSwapEndianness(false),
-	 writeBufferSize(0),writeBuffer(0),writeBufferEnd(0),writePtr(0),
+	 writeBufferSize(0),writeBuffer(0),writeBufferEnd(0),writePtr(0),writeThroughThreshold(0),
 	 canWriteThrough(true),writeMustSwapEndianness(false)
 	{
 	#if DEBUGGING
@@ -318,7 +332,7 @@ File::File(void)
 File::File(File::AccessMode sAccessMode)
 	:readBufferSize(0),readBuffer(0),readDataEnd(0),haveEof(false),readPtr(0),
 	 canReadThrough(true),readMustSwapEndianness(false),
-	 writeBufferSize(0),writeBuffer(0),writeBufferEnd(0),writePtr(0),
+	 writeBufferSize(0),writeBuffer(0),writeBufferEnd(0),writePtr(0),writeThroughThreshold(0),
 	 canWriteThrough(true),writeMustSwapEndianness(false)
 	{
 	if(sAccessMode==ReadOnly||sAccessMode==ReadWrite)
@@ -337,6 +351,7 @@ File::File(File::AccessMode sAccessMode)
 		writeBuffer=new Byte[writeBufferSize];
 		writeBufferEnd=writeBuffer+writeBufferSize;
 		writePtr=writeBuffer;
+		writeThroughThreshold=writeBufferSize/2;
 		}
 	#if DEBUGGING
 	std::cout<<"Created File object at "<<this<<std::endl;
@@ -408,6 +423,7 @@ void File::resizeWriteBuffer(size_t newWriteBufferSize)
 	writeBuffer=new Byte[writeBufferSize];
 	writeBufferEnd=writeBuffer+writeBufferSize;
 	writePtr=writeBuffer;
+	writeThroughThreshold=writeBufferSize/2;
 	}
 
 size_t File::readSomeData(void)
@@ -471,6 +487,54 @@ size_t File::writeSomeData(void)
 	return bufferSpace+writeSize;
 	}
 
+void File::writeRawVectored(const struct iovec* vectors,int numVectors)
+	{
+	/* Calculate the total amount of data to write: */
+	size_t totalSize=0;
+	for(int i=0;i<numVectors;++i)
+		totalSize+=vectors[i].iov_len;
+	
+	/* Bypass the write buffer if supported and if the data is large: */
+	if(canWriteThrough&&totalSize>=writeThroughThreshold)
+		{
+		if(writePtr!=writeBuffer)
+			{
+			/* Prepend the write buffer's contents to the list of buffers, using a local list for short lists: */
+			struct iovec localVectors[16];
+			struct iovec* allVectors=numVectors<16?localVectors:new struct iovec[numVectors+1];
+			allVectors[0].iov_base=writeBuffer;
+			allVectors[0].iov_len=writePtr-writeBuffer;
+			memcpy(allVectors+1,vectors,size_t(numVectors)*sizeof(struct iovec));
+			
+			/* Write all data in one go: */
+			try
+				{
+				writeDataVectored(allVectors,numVectors+1);
+				}
+			catch(...)
+				{
+				if(allVectors!=localVectors)
+					delete[] allVectors;
+				throw;
+				}
+			if(allVectors!=localVectors)
+				delete[] allVectors;
+			writePtr=writeBuffer;
+			}
+		else
+			{
+			/* Write the data directly to the sink: */
+			writeDataVectored(vectors,numVectors);
+			}
+		}
+	else
+		{
+		/* Write the buffers individually through the write buffer: */
+		for(int i=0;i<numVectors;++i)
+			writeRaw(vectors[i].iov_base,vectors[i].iov_len);
+		}
+	}
+
 void File::setEndianness(Misc::Endianness newEndianness)
 	{
 	/* Remember whether reading and writing require endianness swaps: */
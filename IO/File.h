@@ -1,7 +1,7 @@
 /***********************************************************************
 File - Base class for high-performance buffered binary read/write access
 to file-like objects.
-Copyright (c) 2010-2024 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -30,6 +30,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/Autopointer.h>
 #include <Threads/RefCounted.h>
 
+/* Forward declarations: */
+struct iovec;
+
 namespace IO {
 
 class File:public Threads::RefCounted
@@ -78,6 +81,7 @@ class File:public Threads::RefCounted
 		/* Constructors and destructors: */
 		public:
 		ReadError(const char* source,size_t sNumMissingBytes);
+		ReadError(const std::string& message); // Creates a read error with the given message for failures other than short reads
 		};
 	
 	class UngetCharError:public Error // Exception class to report errors while putting characters back into the source
@@ -117,6 +121,7 @@ class File:public Threads::RefCounted
 	Byte* writeBuffer; // Pointer to write buffer
 	Byte* writeBufferEnd; // Pointer to end of write buffer
 	Byte* writePtr; // Pointer to next byte available for writing
+	size_t writeThroughThreshold; // Minimum size of a block of data that bypasses the write buffer if the concrete implementation supports out-of-buffer writes
 	protected:
 	bool canWriteThrough; // Flag whether the concrete implementation supports out-of-buffer writes
 	bool writeMustSwapEndianness; // Flag if data has to be endianness-swapped before writing
@@ -166,6 +171,7 @@ class File:public Threads::RefCounted
 	virtual size_t readData(Byte* buffer,size_t bufferSize); // Method to read data into the given buffer; must block until at least one byte is read; returns number of bytes read; zero return value signals end-of-source condition
 	virtual void writeData(const Byte* buffer,size_t bufferSize); // Method to write all data contained in the write buffer to a sink; should throw appropriate exception in case of errors
 	virtual size_t writeDataUpTo(const Byte* buffer,size_t bufferSize); // Method to write data from the beginning of the write buffer to a sink; must block until at least one byte is written; returns number of bytes written
+	virtual void writeDataVectored(const struct iovec* vectors,int numVectors); // Method to write all data contained in the given list of buffers, in order, to a sink; only called if canWriteThrough is true; default implementation calls writeData for each buffer
 	
 	/* Private methods: */
 	private:
@@ -198,6 +204,14 @@ class File:public Threads::RefCounted
 	virtual void resizeWriteBuffer(size_t newWriteBufferSize); // Flushes and resizes the write buffer
 	size_t readSomeData(void); // Reads at least one additional byte of data from the source into the read buffer; returns amount of unread data in the read buffer
 	size_t writeSomeData(void); // Writes at least one byte of data from the write buffer into the destination; returns amount of free space in the write buffer
+	size_t getWriteThroughThreshold(void) const // Returns the minimum size of a block of data that bypasses the write buffer
+		{
+		return writeThroughThreshold;
+		}
+	void setWriteThroughThreshold(size_t newWriteThroughThreshold) // Sets the minimum size of a block of data that bypasses the write buffer; reset to half the write buffer size when the write buffer changes
+		{
+		writeThroughThreshold=newWriteThroughThreshold;
+		}
 	bool canReadImmediately(void) const // Returns true if there is unread data in the read buffer
 		{
 		return readPtr!=readDataEnd;
@@ -359,8 +373,8 @@ class File:public Threads::RefCounted
 		}
 	void writeRaw(const void* buffer,size_t bufferSize) // Writes exactly the given amount of data from the provided buffer; blocks until write complete
 		{
-		/* Check if there is enough room in the write buffer: */
-		if(bufferSize<=size_t(writeBufferEnd-writePtr))
+		/* Check if there is enough room in the write buffer and the data is not large enough to bypass it: */
+		if(bufferSize<=size_t(writeBufferEnd-writePtr)&&bufferSize<writeThroughThreshold)
 			{
 			/* Copy data from the provided buffer: */
 			memcpy(writePtr,buffer,bufferSize);
@@ -374,6 +388,7 @@ class File:public Threads::RefCounted
 			bufferedWrite(buffer,bufferSize);
 			}
 		}
+	void writeRawVectored(const struct iovec* vectors,int numVectors); // Writes exactly the data contained in the given list of buffers, in order; writes large amounts of data together with the write buffer's contents without copying if supported; blocks until write complete
 	void flush(void) // Flushes the write buffer to the data sink
 		{
 		/* Write the entire write buffer if there is any data in it: */
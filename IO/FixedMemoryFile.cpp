@@ -1,7 +1,7 @@
 /***********************************************************************
 FixedMemoryFile - Class to read/write from/to fixed-size memory blocks
 using a File abstraction.
-Copyright (c) 2011-2015 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -30,7 +30,7 @@ Methods of class FixedMemoryFile:
 
 FixedMemoryFile::FixedMemoryFile(size_t sMemSize)
 	:SeekableFile(),
-	 memSize(sMemSize),memBlock(new Byte[memSize])
+	 memSize(sMemSize),memBlock(new Byte[memSize]),ownsMemBlock(true)
 	{
 	/* Re-allocate the buffered file's buffers: */
 	setReadBuffer(memSize,memBlock,false);
@@ -45,7 +45,7 @@ FixedMemoryFile::FixedMemoryFile(size_t sMemSize)
 
 FixedMemoryFile::FixedMemoryFile(Byte* sMemBlock,size_t sMemSize)
 	:SeekableFile(),
-	 memSize(sMemSize),memBlock(sMemBlock)
+	 memSize(sMemSize),memBlock(sMemBlock),ownsMemBlock(true)
 	{
 	/* Re-allocate the buffered file's buffers: */
 	setReadBuffer(memSize,memBlock,false);
@@ -58,14 +58,29 @@ FixedMemoryFile::FixedMemoryFile(Byte* sMemBlock,size_t sMemSize)
 	readPos=memSize;
 	}
 
+FixedMemoryFile::FixedMemoryFile(const void* sMemBlock,size_t sMemSize)
+	:SeekableFile(),
+	 memSize(sMemSize),memBlock(static_cast<Byte*>(const_cast<void*>(sMemBlock))),ownsMemBlock(false)
+	{
+	/* Use the memory block as read buffer, but do not install a write buffer to keep the memory block read-only: */
+	setReadBuffer(memSize,memBlock,false);
+	canReadThrough=false;
+	canWriteThrough=false;
+	
+	/* The memory block already contains the file's data: */
+	appendReadBufferData(memSize);
+	readPos=memSize;
+	}
+
 FixedMemoryFile::~FixedMemoryFile(void)
 	{
 	/* Release the buffered file's buffers: */
 	setReadBuffer(0,0,false);
 	setWriteBuffer(0,0,false);
 	
-	/* Delete the memory block: */
-	delete[] memBlock;
+	/* Delete the memory block if it is owned by the file: */
+	if(ownsMemBlock)
+		delete[] memBlock;
 	}
 
 size_t FixedMemoryFile::resizeReadBuffer(size_t newReadBufferSize)
@@ -1,7 +1,7 @@
 /***********************************************************************
 FixedMemoryFile - Class to read/write from/to fixed-size memory blocks
 using a File abstraction.
-Copyright (c) 2011-2015 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -34,11 +34,13 @@ class FixedMemoryFile:public SeekableFile
 	private:
 	size_t memSize; // Size of file's memory block
 	Byte* memBlock; // Pointer to file's memory block
+	bool ownsMemBlock; // Flag whether the file deletes its memory block on destruction
 	
 	/* Constructors and destructors: */
 	public:
 	FixedMemoryFile(size_t sMemSize); // Creates a memory block of the given size
 	FixedMemoryFile(Byte* sMemBlock,size_t MemSize); // Creates a file interface for the given memory block; adopts memory block
+	FixedMemoryFile(const void* sMemBlock,size_t sMemSize); // Creates a read-only file interface for the given memory block without copying or adopting it; caller must keep memory block valid for the file's lifetime
 	virtual ~FixedMemoryFile(void);
 	
 	/* Methods from File: */
@@ -0,0 +1,845 @@
+/***********************************************************************
+JsonDocument - Class to parse complete JSON files in one go into compact
+in-memory representations, using a vectorized scan to locate structural
+characters, and to access the represented values on demand without
+creating heap-allocated entity trees.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/JsonDocument.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/MemMappedFile.h>
+#include <IO/JsonEntityTypes.h>
+
+namespace IO {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline void classifyBlock(const char* block,Misc::UInt64& quotes,Misc::UInt64& backslashes,Misc::UInt64& operators,Misc::UInt64& whitespace) // Returns bit masks of quotes, backslashes, JSON operators, and whitespace in a 64-character block
+	{
+	quotes=0;
+	backslashes=0;
+	operators=0;
+	whitespace=0;
+	
+	#ifdef __SSE2__
+	
+	/* Classify the block in four 16-character chunks: */
+	for(int i=0;i<4;++i)
+		{
+		__m128i chunk=_mm_loadu_si128(reinterpret_cast<const __m128i*>(block+i*16));
+		
+		/* Match quotes and backslashes: */
+		Misc::UInt64 q=(unsigned int)(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk,_mm_set1_epi8('"'))));
+		Misc::UInt64 b=(unsigned int)(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk,_mm_set1_epi8('\\'))));
+		
+		/* Match operators; braces and brackets only differ in bit 5: */
+		__m128i lower=_mm_or_si128(chunk,_mm_set1_epi8(0x20));
+		__m128i op=_mm_or_si128(_mm_cmpeq_epi8(lower,_mm_set1_epi8('{')),_mm_cmpeq_epi8(lower,_mm_set1_epi8('}')));
+		op=_mm_or_si128(op,_mm_or_si128(_mm_cmpeq_epi8(chunk,_mm_set1_epi8(':')),_mm_cmpeq_epi8(chunk,_mm_set1_epi8(','))));
+		Misc::UInt64 o=(unsigned int)(_mm_movemask_epi8(op));
+		
+		/* Match whitespace: */
+		__m128i ws=_mm_or_si128(_mm_cmpeq_epi8(chunk,_mm_set1_epi8(' ')),_mm_cmpeq_epi8(chunk,_mm_set1_epi8('\t')));
+		ws=_mm_or_si128(ws,_mm_or_si128(_mm_cmpeq_epi8(chunk,_mm_set1_epi8('\n')),_mm_cmpeq_epi8(chunk,_mm_set1_epi8('\r'))));
+		Misc::UInt64 w=(unsigned int)(_mm_movemask_epi8(ws));
+		
+		quotes|=q<<(i*16);
+		backslashes|=b<<(i*16);
+		operators|=o<<(i*16);
+		whitespace|=w<<(i*16);
+		}
+	
+	#else
+	
+	/* Classify the block one character at a time: */
+	for(int i=0;i<64;++i)
+		{
+		Misc::UInt64 bit=Misc::UInt64(1)<<i;
+		switch(block[i])
+			{
+			case '"':
+				quotes|=bit;
+				break;
+			
+			case '\\':
+				backslashes|=bit;
+				break;
+			
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				operators|=bit;
+				break;
+			
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				whitespace|=bit;
+				break;
+			}
+		}
+	
+	#endif
+	}
+
+inline Misc::UInt64 prefixXor(Misc::UInt64 bits) // Returns a bit mask where each bit is the exclusive or of all bits up to and including the same bit in the given mask
+	{
+	bits^=bits<<1;
+	bits^=bits<<2;
+	bits^=bits<<4;
+	bits^=bits<<8;
+	bits^=bits<<16;
+	bits^=bits<<32;
+	return bits;
+	}
+
+inline int countTrailingZeros(Misc::UInt64 bits) // Returns the index of the lowest set bit in the given non-zero mask
+	{
+	return __builtin_ctzll(bits);
+	}
+
+inline bool isTokenEnd(char c) // Returns true if the given character ends a literal or number
+	{
+	switch(c)
+		{
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+		case '{':
+		case '}':
+		case '[':
+		case ']':
+		case ':':
+		case ',':
+		case '"':
+			return true;
+		
+		default:
+			return false;
+		}
+	}
+
+inline bool isDigit(char c)
+	{
+	return c>='0'&&c<='9';
+	}
+
+bool isNumber(const char* begin,const char* end) // Returns true if the given token is a number in the syntax accepted by IO::ValueSource::readNumber
+	{
+	const char* tPtr=begin;
+	
+	/* Skip a sign: */
+	if(tPtr!=end&&(*tPtr=='-'||*tPtr=='+'))
+		++tPtr;
+	
+	/* Skip the integral and fractional number parts: */
+	bool haveDigit=false;
+	for(;tPtr!=end&&isDigit(*tPtr);++tPtr)
+		haveDigit=true;
+	if(tPtr!=end&&*tPtr=='.')
+		for(++tPtr;tPtr!=end&&isDigit(*tPtr);++tPtr)
+			haveDigit=true;
+	if(!haveDigit)
+		return false;
+	
+	/* Skip an exponent: */
+	if(tPtr!=end&&(*tPtr=='e'||*tPtr=='E'))
+		{
+		++tPtr;
+		if(tPtr!=end&&(*tPtr=='-'||*tPtr=='+'))
+			++tPtr;
+		if(tPtr==end||!isDigit(*tPtr))
+			return false;
+		while(tPtr!=end&&isDigit(*tPtr))
+			++tPtr;
+		}
+	
+	return tPtr==end;
+	}
+
+double parseNumber(const char* begin,const char* end) // Parses a number that passed isNumber, using the same arithmetic as IO::ValueSource::readNumber to produce identical results
+	{
+	const char* tPtr=begin;
+	
+	/* Read a plus or minus sign: */
+	bool negate=*tPtr=='-';
+	if(*tPtr=='-'||*tPtr=='+')
+		++tPtr;
+	
+	/* Read an integral number part: */
+	double result=0.0;
+	for(;tPtr!=end&&isDigit(*tPtr);++tPtr)
+		result=result*10.0+double(*tPtr-'0');
+	
+	/* Check for a period: */
+	if(tPtr!=end&&*tPtr=='.')
+		{
+		/* Read a fractional number part: */
+		double fraction=0.0;
+		double fractionBase=1.0;
+		for(++tPtr;tPtr!=end&&isDigit(*tPtr);++tPtr)
+			{
+			fraction=fraction*10.0+double(*tPtr-'0');
+			fractionBase*=10.0;
+			}
+		
+		result+=fraction/fractionBase;
+		}
+	
+	/* Negate the result if a minus sign was read: */
+	if(negate)
+		result=-result;
+	
+	/* Check for an exponent indicator: */
+	if(tPtr!=end&&(*tPtr=='e'||*tPtr=='E'))
+		{
+		++tPtr;
+		
+		/* Read a plus or minus sign: */
+		bool negateExponent=*tPtr=='-';
+		if(*tPtr=='-'||*tPtr=='+')
+			++tPtr;
+		
+		/* Read the exponent: */
+		double exponent=0.0;
+		for(;tPtr!=end&&isDigit(*tPtr);++tPtr)
+			exponent=exponent*10.0+double(*tPtr-'0');
+		
+		/* Multiply the mantissa with the exponent: */
+		result*=pow(10.0,negateExponent?-exponent:exponent);
+		}
+	
+	return result;
+	}
+
+int parseHexDigits(const char*& sPtr,const char* end) // Parses a four-digit hexadecimal character code; returns -1 on error
+	{
+	if(end-sPtr<4)
+		return -1;
+	int result=0;
+	for(int i=0;i<4;++i,++sPtr)
+		{
+		result<<=4;
+		if(*sPtr>='0'&&*sPtr<='9')
+			result+=*sPtr-'0';
+		else if(*sPtr>='A'&&*sPtr<='F')
+			result+=*sPtr-'A'+10;
+		else if(*sPtr>='a'&&*sPtr<='f')
+			result+=*sPtr-'a'+10;
+		else
+			return -1;
+		}
+	return result;
+	}
+
+void appendUtf8(std::string& string,unsigned int c) // Appends the UTF-8 encoding of the given Unicode character to the given string
+	{
+	if(c<0x80U)
+		string.push_back(char(c));
+	else if(c<0x800U)
+		{
+		string.push_back(char(0xc0U|(c>>6)));
+		string.push_back(char(0x80U|(c&0x3fU)));
+		}
+	else if(c<0x10000U)
+		{
+		string.push_back(char(0xe0U|(c>>12)));
+		string.push_back(char(0x80U|((c>>6)&0x3fU)));
+		string.push_back(char(0x80U|(c&0x3fU)));
+		}
+	else
+		{
+		string.push_back(char(0xf0U|(c>>18)));
+		string.push_back(char(0x80U|((c>>12)&0x3fU)));
+		string.push_back(char(0x80U|((c>>6)&0x3fU)));
+		string.push_back(char(0x80U|(c&0x3fU)));
+		}
+	}
+
+std::string decodeString(const char* begin,const char* end) // Decodes the escape sequences in the given quoted string's contents
+	{
+	/* Find the first escape sequence; return the string verbatim if there are none: */
+	const char* escPtr=static_cast<const char*>(memchr(begin,'\\',end-begin));
+	if(escPtr==0)
+		return std::string(begin,end);
+	
+	std::string result(begin,escPtr);
+	result.reserve(end-begin);
+	for(const char* sPtr=escPtr;sPtr!=end;)
+		{
+		if(*sPtr!='\\')
+			{
+			result.push_back(*sPtr);
+			++sPtr;
+			continue;
+			}
+		
+		/* Handle the escape sequence: */
+		if(++sPtr==end)
+			{
+			/* Return a trailing escape character as is: */
+			result.push_back('\\');
+			break;
+			}
+		char c=*(sPtr++);
+		switch(c)
+			{
+			case 'b':
+				result.push_back('\b');
+				break;
+			
+			case 'f':
+				result.push_back('\f');
+				break;
+			
+			case 'n':
+				result.push_back('\n');
+				break;
+			
+			case 'r':
+				result.push_back('\r');
+				break;
+			
+			case 't':
+				result.push_back('\t');
+				break;
+			
+			case 'u':
+				{
+				/* Parse a Unicode character code, combining surrogate pairs: */
+				int code=parseHexDigits(sPtr,end);
+				if(code<0)
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Malformed Unicode escape sequence");
+				unsigned int unicode=code;
+				if(unicode>=0xd800U&&unicode<0xdc00U&&end-sPtr>=6&&sPtr[0]=='\\'&&sPtr[1]=='u')
+					{
+					const char* lowPtr=sPtr+2;
+					int low=parseHexDigits(lowPtr,end);
+					if(low>=0xdc00&&low<0xe000)
+						{
+						unicode=0x10000U+((unicode-0xd800U)<<10)+(unsigned int)(low-0xdc00);
+						sPtr=lowPtr;
+						}
+					}
+				appendUtf8(result,unicode);
+				break;
+				}
+			
+			default:
+				/* Use the escaped character verbatim: */
+				result.push_back(c);
+			}
+		}
+	
+	return result;
+	}
+
+bool stringEquals(const char* begin,const char* end,const char* string) // Returns true if the given quoted string's contents are equal to the given string
+	{
+	/* Compare directly if the quoted string does not contain escape sequences: */
+	size_t length=end-begin;
+	if(memchr(begin,'\\',length)==0)
+		return strncmp(begin,string,length)==0&&string[length]=='\0';
+	
+	return decodeString(begin,end)==string;
+	}
+
+}
+
+/************************************
+Methods of class JsonDocument::Value:
+************************************/
+
+void JsonDocument::Value::throwInvalid(void)
+	{
+	throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid JSON value");
+	}
+
+bool JsonDocument::Value::getBoolean(void) const
+	{
+	const Node& node=getNode();
+	if(node.type!=BOOLEAN)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is not a boolean");
+	
+	/* Check the literal's first character: */
+	return document->text[node.textBegin]=='t';
+	}
+
+double JsonDocument::Value::getNumber(void) const
+	{
+	const Node& node=getNode();
+	if(node.type!=NUMBER)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is not a number");
+	
+	/* Parse the number on demand: */
+	return parseNumber(document->text+node.textBegin,document->text+node.textEnd);
+	}
+
+std::string JsonDocument::Value::getString(void) const
+	{
+	const Node& node=getNode();
+	if(node.type!=STRING)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is not a string");
+	
+	/* Decode the string on demand: */
+	return decodeString(document->text+node.textBegin,document->text+node.textEnd);
+	}
+
+bool JsonDocument::Value::equals(const char* string) const
+	{
+	const Node& node=getNode();
+	return node.type==STRING&&stringEquals(document->text+node.textBegin,document->text+node.textEnd,string);
+	}
+
+size_t JsonDocument::Value::size(void) const
+	{
+	const Node& node=getNode();
+	if(node.type!=ARRAY&&node.type!=OBJECT)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is neither an array nor an object");
+	
+	return node.numChildren;
+	}
+
+JsonDocument::Value JsonDocument::Value::getFirstChild(void) const
+	{
+	const Node& node=getNode();
+	if(node.type!=ARRAY&&node.type!=OBJECT)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is neither an array nor an object");
+	
+	/* The first child, if any, immediately follows its parent: */
+	return node.numChildren>0?Value(document,nodeIndex+1):Value();
+	}
+
+JsonDocument::Value JsonDocument::Value::getNextSibling(void) const
+	{
+	/* The next sibling immediately follows this value's children, unless that is past the end of the parent's children: */
+	const Node& node=getNode();
+	if(node.parent==~0U||node.next>=document->nodes[node.parent].next)
+		return Value();
+	return Value(document,node.next);
+	}
+
+std::string JsonDocument::Value::getName(void) const
+	{
+	const Node& node=getNode();
+	if(node.parent==~0U||document->nodes[node.parent].type!=OBJECT)
+		return std::string();
+	
+	return decodeString(document->text+node.nameBegin,document->text+node.nameEnd);
+	}
+
+bool JsonDocument::Value::hasName(const char* name) const
+	{
+	const Node& node=getNode();
+	return node.parent!=~0U&&document->nodes[node.parent].type==OBJECT&&stringEquals(document->text+node.nameBegin,document->text+node.nameEnd,name);
+	}
+
+JsonDocument::Value JsonDocument::Value::getItem(size_t index) const
+	{
+	const Node& node=getNode();
+	if(node.type!=ARRAY)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is not an array");
+	if(index>=node.numChildren)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Index %u out of bounds",(unsigned int)(index));
+	
+	/* Skip over the preceding items: */
+	unsigned int itemIndex=nodeIndex+1;
+	for(size_t i=0;i<index;++i)
+		itemIndex=document->nodes[itemIndex].next;
+	
+	return Value(document,itemIndex);
+	}
+
+JsonDocument::Value JsonDocument::Value::findProperty(const char* name) const
+	{
+	const Node& node=getNode();
+	if(node.type!=OBJECT)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON value is not an object");
+	
+	/* Check all members; later members override earlier members of the same name, as in JsonObject: */
+	Value result;
+	unsigned int memberIndex=nodeIndex+1;
+	for(unsigned int i=0;i<node.numChildren;++i,memberIndex=document->nodes[memberIndex].next)
+		{
+		const Node& member=document->nodes[memberIndex];
+		if(stringEquals(document->text+member.nameBegin,document->text+member.nameEnd,name))
+			result=Value(document,memberIndex);
+		}
+	
+	return result;
+	}
+
+JsonDocument::Value JsonDocument::Value::getProperty(const char* name) const
+	{
+	Value result=findProperty(name);
+	if(!result.isValid())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON object does not have property %s",name);
+	
+	return result;
+	}
+
+JsonPointer JsonDocument::Value::toEntity(void) const
+	{
+	const Node& node=getNode();
+	switch(node.type)
+		{
+		case NULLVALUE:
+			return 0;
+		
+		case BOOLEAN:
+			return new JsonBoolean(getBoolean());
+		
+		case NUMBER:
+			return new JsonNumber(getNumber());
+		
+		case STRING:
+			return new JsonString(getString());
+		
+		case ARRAY:
+			{
+			/* Convert all array items: */
+			JsonArray* array=new JsonArray;
+			array->getArray().reserve(node.numChildren);
+			for(Value item=getFirstChild();item.isValid();item=item.getNextSibling())
+				array->getArray().push_back(item.toEntity());
+			
+			return array;
+			}
+		
+		case OBJECT:
+			{
+			/* Convert all object members: */
+			JsonObject* object=new JsonObject;
+			for(Value member=getFirstChild();member.isValid();member=member.getNextSibling())
+				object->getMap()[member.getName()]=member.toEntity();
+			
+			return object;
+			}
+		}
+	
+	return 0;
+	}
+
+/*****************************
+Methods of class JsonDocument:
+*****************************/
+
+void JsonDocument::findStructurals(const char* text,size_t textSize,std::vector<unsigned int>& structurals)
+	{
+	const Misc::UInt64 evenBits(0x5555555555555555ULL);
+	
+	/* Process the text in blocks of 64 characters, carrying state from one block to the next: */
+	Misc::UInt64 prevEscaped(0); // 1 if the first character of the next block is escaped
+	Misc::UInt64 prevInString(0); // All ones if the next block starts inside a quoted string
+	Misc::UInt64 prevScalar(0); // 1 if the last character of the previous block was part of a literal or number
+	for(size_t base=0;base<textSize;base+=64)
+		{
+		/* Pad a partial final block with whitespace: */
+		const char* block=text+base;
+		char tail[64];
+		if(textSize-base<64)
+			{
+			memset(tail,' ',64);
+			memcpy(tail,text+base,textSize-base);
+			block=tail;
+			}
+		
+		/* Classify the block's characters: */
+		Misc::UInt64 quotes,backslashes,operators,whitespace;
+		classifyBlock(block,quotes,backslashes,operators,whitespace);
+		
+		/* Find characters escaped by odd-length sequences of backslashes: */
+		backslashes&=~prevEscaped;
+		Misc::UInt64 followsEscape=(backslashes<<1)|prevEscaped;
+		Misc::UInt64 oddSequenceStarts=backslashes&~evenBits&~followsEscape;
+		Misc::UInt64 sequencesStartingOnEvenBits=oddSequenceStarts+backslashes;
+		prevEscaped=sequencesStartingOnEvenBits<oddSequenceStarts?1U:0U;
+		Misc::UInt64 escaped=(evenBits^(sequencesStartingOnEvenBits<<1))&followsEscape;
+		
+		/* Find the ranges of quoted strings, including opening but excluding closing quotes: */
+		quotes&=~escaped;
+		Misc::UInt64 inString=prefixXor(quotes)^prevInString;
+		prevInString=Misc::UInt64(Misc::SInt64(inString)>>63);
+		
+		/* Find the first characters of literals and numbers: */
+		Misc::UInt64 scalars=~(operators|whitespace|quotes|inString);
+		Misc::UInt64 scalarStarts=scalars&~((scalars<<1)|prevScalar);
+		prevScalar=scalars>>63;
+		
+		/* Append the positions of all structural characters to the list: */
+		Misc::UInt64 bits=(operators&~inString)|quotes|scalarStarts;
+		while(bits!=0)
+			{
+			structurals.push_back((unsigned int)(base)+countTrailingZeros(bits));
+			bits&=bits-1;
+			}
+		}
+	
+	/* Check for an unterminated string: */
+	if(prevInString!=0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unterminated string");
+	}
+
+void JsonDocument::parse(void)
+	{
+	/* Check the document's size: */
+	if(textSize>=size_t(~0U))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"JSON document is too large");
+	
+	/* Find all structural characters in the document: */
+	std::vector<unsigned int> structurals;
+	structurals.reserve(textSize/8+16);
+	findStructurals(text,textSize,structurals);
+	unsigned int numStructurals=(unsigned int)(structurals.size());
+	
+	/* Estimate the number of nodes based on the number of structural characters: */
+	nodes.reserve(numStructurals/2+1);
+	
+	/* Parse values iteratively, keeping a stack of open arrays and objects: */
+	std::vector<unsigned int> containerStack;
+	unsigned int si=0;
+	unsigned int nameBegin=0,nameEnd=0;
+	while(true)
+		{
+		/* Parse the next value: */
+		if(si>=numStructurals)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unexpected end of JSON document");
+		unsigned int pos=structurals[si];
+		Node node;
+		node.nameBegin=nameBegin;
+		node.nameEnd=nameEnd;
+		node.parent=containerStack.empty()?~0U:containerStack.back();
+		node.next=(unsigned int)(nodes.size())+1;
+		node.numChildren=0;
+		bool isContainer=false;
+		switch(text[pos])
+			{
+			case '"': // String
+				/* The closing quote is the next structural character: */
+				node.type=STRING;
+				node.textBegin=pos+1;
+				node.textEnd=structurals[si+1];
+				si+=2;
+				break;
+			
+			case '[': // Array
+			case '{': // Object
+				node.type=text[pos]=='['?ARRAY:OBJECT;
+				node.textBegin=pos+1;
+				node.textEnd=pos+1;
+				isContainer=true;
+				++si;
+				break;
+			
+			case ']':
+			case '}':
+			case ':':
+			case ',':
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Illegal token at offset %u",pos);
+			
+			default: // Literal or number
+				{
+				/* Find the end of the token: */
+				unsigned int end=pos;
+				while(end<textSize&&!isTokenEnd(text[end]))
+					++end;
+				size_t length=end-pos;
+				if(length==4&&memcmp(text+pos,"true",4)==0)
+					node.type=BOOLEAN;
+				else if(length==5&&memcmp(text+pos,"false",5)==0)
+					node.type=BOOLEAN;
+				else if(length==4&&memcmp(text+pos,"null",4)==0)
+					node.type=NULLVALUE;
+				else if(isNumber(text+pos,text+end))
+					node.type=NUMBER;
+				else
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Illegal literal at offset %u",pos);
+				node.textBegin=pos;
+				node.textEnd=end;
+				++si;
+				}
+			}
+		
+		/* Store the new value: */
+		unsigned int nodeIndex=(unsigned int)(nodes.size());
+		nodes.push_back(node);
+		if(node.parent!=~0U)
+			++nodes[node.parent].numChildren;
+		
+		if(isContainer)
+			{
+			/* Open the new container: */
+			containerStack.push_back(nodeIndex);
+			
+			/* Continue with the container's first child unless the container is empty: */
+			nameBegin=nameEnd=0;
+			char closer=node.type==ARRAY?']':'}';
+			if(si>=numStructurals||text[structurals[si]]!=closer)
+				{
+				if(node.type==OBJECT)
+					{
+					/* Parse the first member's name and the following colon: */
+					if(si+2>=numStructurals||text[structurals[si]]!='"'||text[structurals[si+2]]!=':')
+						throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Malformed object member at offset %u",si<numStructurals?structurals[si]:(unsigned int)(textSize));
+					nameBegin=structurals[si]+1;
+					nameEnd=structurals[si+1];
+					si+=3;
+					}
+				continue;
+				}
+			}
+		
+		/* Close containers until a comma separates the completed value from its next sibling: */
+		bool done=false;
+		while(true)
+			{
+			/* Check if the root value is complete: */
+			if(containerStack.empty())
+				{
+				if(si!=numStructurals)
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Extra data after root value at offset %u",structurals[si]);
+				done=true;
+				break;
+				}
+			
+			/* Check the character following the completed value: */
+			if(si>=numStructurals)
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unexpected end of JSON document");
+			unsigned int cPos=structurals[si];
+			Node& container=nodes[containerStack.back()];
+			if(text[cPos]==',')
+				{
+				++si;
+				if(container.type==OBJECT)
+					{
+					/* Parse the next member's name and the following colon: */
+					if(si+2>=numStructurals||text[structurals[si]]!='"'||text[structurals[si+2]]!=':')
+						throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Malformed object member at offset %u",si<numStructurals?structurals[si]:(unsigned int)(textSize));
+					nameBegin=structurals[si]+1;
+					nameEnd=structurals[si+1];
+					si+=3;
+					}
+				break;
+				}
+			else if(text[cPos]==(container.type==ARRAY?']':'}'))
+				{
+				/* Close the container: */
+				container.textEnd=cPos;
+				container.next=(unsigned int)(nodes.size());
+				containerStack.pop_back();
+				++si;
+				}
+			else
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Illegal token at offset %u",cPos);
+			}
+		if(done)
+			break;
+		
+		/* Reset the member name for values that are not object members: */
+		if(nodes[containerStack.back()].type==ARRAY)
+			nameBegin=nameEnd=0;
+		}
+	}
+
+JsonDocument::JsonDocument(const char* fileName)
+	:textBuffer(0),text(0),textSize(0)
+	{
+	/* Map the file into memory and parse it in place: */
+	MemMappedFile* file=new MemMappedFile(fileName);
+	mappedFile=file;
+	text=static_cast<const char*>(file->getMemory());
+	textSize=size_t(file->getSize());
+	parse();
+	}
+
+JsonDocument::JsonDocument(File& file)
+	:textBuffer(0),text(0),textSize(0)
+	{
+	try
+		{
+		/* Read the entire file into a growing buffer: */
+		size_t bufferSize=0;
+		void* data;
+		size_t dataSize;
+		while((dataSize=file.readInBuffer(data))!=0)
+			{
+			if(textSize+dataSize>bufferSize)
+				{
+				while(textSize+dataSize>bufferSize)
+					bufferSize=bufferSize!=0?bufferSize*2:65536;
+				char* newTextBuffer=static_cast<char*>(realloc(textBuffer,bufferSize));
+				if(newTextBuffer==0)
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Unable to allocate text buffer");
+				textBuffer=newTextBuffer;
+				}
+			memcpy(textBuffer+textSize,data,dataSize);
+			textSize+=dataSize;
+			}
+		text=textBuffer;
+		
+		parse();
+		}
+	catch(...)
+		{
+		/* Release the text buffer if reading or parsing failed: */
+		free(textBuffer);
+		throw;
+		}
+	}
+
+JsonDocument::JsonDocument(const char* sText,size_t sTextSize)
+	:textBuffer(static_cast<char*>(malloc(sTextSize))),text(textBuffer),textSize(sTextSize)
+	{
+	/* Copy the text and parse it: */
+	memcpy(textBuffer,sText,textSize);
+	try
+		{
+		parse();
+		}
+	catch(...)
+		{
+		free(textBuffer);
+		throw;
+		}
+	}
+
+JsonDocument::~JsonDocument(void)
+	{
+	free(textBuffer);
+	}
+
+}
@@ -0,0 +1,155 @@
+/***********************************************************************
+JsonDocument - Class to parse complete JSON files in one go into compact
+in-memory representations, using a vectorized scan to locate structural
+characters, and to access the represented values on demand without
+creating heap-allocated entity trees.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_JSONDOCUMENT_INCLUDED
+#define IO_JSONDOCUMENT_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <IO/File.h>
+#include <IO/JsonEntity.h>
+
+namespace IO {
+
+class JsonDocument
+	{
+	/* Embedded classes: */
+	public:
+	enum ValueType // Enumerated type for JSON value types
+		{
+		NULLVALUE,BOOLEAN,NUMBER,STRING,ARRAY,OBJECT
+		};
+	
+	private:
+	struct Node // Structure representing a single JSON value in depth-first order
+		{
+		/* Elements: */
+		public:
+		ValueType type; // The value's type
+		unsigned int textBegin,textEnd; // Range of the value's text in the document; excludes quotes for strings; for arrays and objects, range between the brackets
+		unsigned int nameBegin,nameEnd; // Range of the value's name in the document, excluding quotes, if the value is a member of an object
+		unsigned int parent; // Index of the node of the array or object containing the value, or ~0U for the root value
+		unsigned int next; // Index of the node following the value and all its children
+		unsigned int numChildren; // Number of items or members for arrays or objects; zero otherwise
+		};
+	
+	public:
+	class Value // Class for light-weight handles to values in a JSON document; values are decoded on demand
+		{
+		friend class JsonDocument;
+		
+		/* Elements: */
+		private:
+		const JsonDocument* document; // The document containing the value, or null for invalid values
+		unsigned int nodeIndex; // Index of the value's node in the document
+		
+		/* Constructors and destructors: */
+		Value(const JsonDocument* sDocument,unsigned int sNodeIndex)
+			:document(sDocument),nodeIndex(sNodeIndex)
+			{
+			}
+		
+		/* Private methods: */
+		static void throwInvalid(void); // Throws an exception signaling access to an invalid value
+		const Node& getNode(void) const // Returns the value's node; throws exception if the value is invalid
+			{
+			if(document==0)
+				throwInvalid();
+			return document->nodes[nodeIndex];
+			}
+		
+		public:
+		Value(void) // Creates an invalid value; all methods except isValid() throw exceptions when called on invalid values
+			:document(0),nodeIndex(0)
+			{
+			}
+		
+		/* Methods: */
+		bool isValid(void) const // Returns true if the handle refers to a value
+			{
+			return document!=0;
+			}
+		ValueType getType(void) const // Returns the value's type
+			{
+			return getNode().type;
+			}
+		bool isNull(void) const // Returns true if the value is a null value
+			{
+			return getNode().type==NULLVALUE;
+			}
+		bool getBoolean(void) const; // Returns the represented boolean value; throws exception if value is not a boolean
+		double getNumber(void) const; // Parses and returns the represented number; throws exception if value is not a number
+		std::string getString(void) const; // Decodes and returns the represented string; throws exception if value is not a string
+		bool equals(const char* string) const; // Returns true if the value is a string equal to the given string
+		size_t size(void) const; // Returns the number of items in an array or members in an object; throws exception if value is neither
+		Value getFirstChild(void) const; // Returns the first item in an array or member in an object, or an invalid value if the array or object is empty; throws exception if value is neither
+		Value getNextSibling(void) const; // Returns the next item in the same array or member in the same object, or an invalid value if this is the last one
+		std::string getName(void) const; // Decodes and returns the name of an object member; returns empty string for values that are not object members
+		bool hasName(const char* name) const; // Returns true if the value is an object member of the given name
+		Value getItem(size_t index) const; // Returns the array item of the given index; throws exception if value is not an array or index is out of bounds
+		Value findProperty(const char* name) const; // Returns the object member of the given name, or an invalid value if there is no such member; throws exception if value is not an object
+		Value getProperty(const char* name) const; // Returns the object member of the given name; throws exception if value is not an object or there is no such member
+		JsonPointer toEntity(void) const; // Converts the value and all its children into a tree of JSON entities
+		};
+	
+	friend class Value;
+	
+	/* Elements: */
+	private:
+	FilePtr mappedFile; // Memory-mapped file containing the document's text, if opened from a file name
+	char* textBuffer; // Buffer holding the document's text if read from a file
+	const char* text; // Pointer to the document's text
+	size_t textSize; // Size of the document's text
+	std::vector<Node> nodes; // Array of value nodes in depth-first order; the root value is the first node
+	
+	/* Private methods: */
+	static void findStructurals(const char* text,size_t textSize,std::vector<unsigned int>& structurals); // Appends the positions of all structural characters, quotes, and starts of literals in the given text to the given array
+	void parse(void); // Parses the document's text
+	
+	/* Constructors and destructors: */
+	public:
+	JsonDocument(const char* fileName); // Parses the JSON file of the given name by mapping it into memory
+	JsonDocument(File& file); // Parses the entire remaining contents of the given file
+	JsonDocument(const char* sText,size_t sTextSize); // Parses a copy of the given text
+	private:
+	JsonDocument(const JsonDocument& source); // Prohibit copy constructor
+	JsonDocument& operator=(const JsonDocument& source); // Prohibit assignment operator
+	public:
+	~JsonDocument(void);
+	
+	/* Methods: */
+	size_t getNumValues(void) const // Returns the total number of values in the document
+		{
+		return nodes.size();
+		}
+	Value getRoot(void) const // Returns the document's root value
+		{
+		return Value(this,0);
+		}
+	};
+
+}
+
+#endif
@@ -1,7 +1,8 @@
 /***********************************************************************
 ReadAheadFilter - Class to add background read-ahead to other IO::File
-abstractions to improve read throughput.
-Copyright (c) 2011-2018 Oliver Kreylos
+abstractions, or to files read directly from the operating system, to
+improve read throughput.
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -22,55 +23,144 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <IO/ReadAheadFilter.h>
 
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <stdexcept>
 #include <Misc/Utility.h>
+#include <Misc/StdError.h>
 
 namespace IO {
 
+namespace {
+
+/*********
+Constants:
+*********/
+
+enum
+	{
+	DirectIOAlignment=4096 // Alignment of buffer addresses, file offsets, and read sizes required for direct I/O
+	};
+
+}
+
 /********************************
 Methods of class ReadAheadFilter:
 ********************************/
 
 size_t ReadAheadFilter::readData(File::Byte* buffer,size_t bufferSize)
 	{
+	/* Keep returning end-of-file or reporting the read error once the read-ahead thread has handed over the final empty segment: */
+	if(haveReadOnce&&segmentDataSizes[outSegment]==0)
+		{
+		if(!readErrorMessage.empty())
+			throw ReadError(readErrorMessage);
+		return 0;
+		}
+	
 	{
 	Threads::Mutex::Lock bufferLock(bufferMutex);
 	
 	if(haveReadOnce)
 		{
-		/* Release the just-finished buffer half: */
-		--numFullBuffers;
+		/* Release the just-finished segment: */
+		--numFullSegments;
 		bufferCond.signal();
 		}
 	
-	/* Check if the double buffer is empty: */
-	while(numFullBuffers==0)
+	/* Check if the ring buffer is empty: */
+	if(numFullSegments==0)
 		{
 		/* Wait for more data: */
-		bufferCond.wait(bufferMutex);
+		++statistics.numReaderStalls;
+		while(numFullSegments==0)
+			bufferCond.wait(bufferMutex);
 		}
+	
+	/* Read from the next segment: */
+	if(++outSegment==numSegments)
+		outSegment=0;
+	++statistics.numSegmentsRead;
+	statistics.bytesAhead-=segmentDataSizes[outSegment];
 	}
 	
-	/* Read from the next double buffer half: */
-	outBuffer=1-outBuffer;
-	setReadBuffer(bufferSizes[outBuffer],buffers[outBuffer],false);
+	setReadBuffer(segmentDataSizes[outSegment],segmentMemory+outSegment*segmentSize,false);
 	haveReadOnce=true;
 	
-	return bufferSizes[outBuffer];
+	/* Report an error encountered by the read-ahead thread once all data read before the error has been consumed: */
+	if(segmentDataSizes[outSegment]==0&&!readErrorMessage.empty())
+		throw ReadError(readErrorMessage);
+	
+	return segmentDataSizes[outSegment];
 	}
 
-void* ReadAheadFilter::readAheadThreadMethod(void)
+void ReadAheadFilter::init(size_t sSegmentSize,unsigned int sNumSegments)
 	{
-	/* Enable immediate cancellation: */
-	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
-	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
+	/* Initialize the ring buffer layout; direct I/O requires aligned segments: */
+	segmentSize=sSegmentSize;
+	if(fd>=0)
+		segmentSize=(segmentSize+DirectIOAlignment-1)&~size_t(DirectIOAlignment-1);
+	numSegments=Misc::max(sNumSegments,2U);
 	
-	do
+	/* Allocate the ring buffer: */
+	void* memory=0;
+	if(posix_memalign(&memory,DirectIOAlignment,segmentSize*numSegments)!=0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Cannot allocate %u read-ahead segments of %u bytes",numSegments,(unsigned int)(segmentSize));
+	segmentMemory=static_cast<Byte*>(memory);
+	segmentDataSizes=new size_t[numSegments];
+	for(unsigned int i=0;i<numSegments;++i)
+		segmentDataSizes[i]=0;
+	inSegment=outSegment=numSegments-1;
+	
+	/* Reset the statistics: */
+	statistics.numSegmentsRead=0;
+	statistics.numReaderStalls=0;
+	statistics.numReadAheadStalls=0;
+	statistics.bytesAhead=0;
+	
+	/* Start the read-ahead thread: */
+	readAheadThread.start(this,&ReadAheadFilter::readAheadThreadMethod);
+	
+	/* Disable read-through: */
+	canReadThrough=false;
+	}
+
+size_t ReadAheadFilter::fillSegment(File::Byte* segment,std::string& errorMessage)
+	{
+	Byte* bufPtr=segment;
+	size_t bufSize=segmentSize;
+	if(fd>=0)
+		{
+		while(bufSize>0)
+			{
+			/* Read directly from the file descriptor: */
+			ssize_t readResult=::read(fd,bufPtr,bufSize);
+			if(readResult<0)
+				{
+				if(errno==EINTR)
+					continue;
+				
+				/* Keep the data read so far and remember the error: */
+				errorMessage=Misc::makeLibcErrMsg(__PRETTY_FUNCTION__,errno,"Cannot read from file");
+				break;
+				}
+			
+			/* Check for end-of-file: */
+			if(readResult==0)
+				break;
+			
+			bufPtr+=readResult;
+			bufSize-=readResult;
+			
+			/* A direct read that is not a multiple of the alignment can only happen at end-of-file, and must not be followed by another read from the unaligned offset: */
+			if(directIO&&(readResult&(DirectIOAlignment-1))!=0)
+				break;
+			}
+		}
+	else
 		{
-		/* Fill the next double-buffer half: */
-		inBuffer=1-inBuffer;
-		Byte* bufPtr=buffers[inBuffer];
-		size_t bufSize=halfBufferSize;
 		try
 			{
 			while(bufSize>0)
@@ -85,52 +175,105 @@ void* ReadAheadFilter::readAheadThreadMethod(void)
 				bufPtr+=readSize;
 				bufSize-=readSize;
 				}
-			bufferSizes[inBuffer]=halfBufferSize-bufSize;
 			}
-		catch(const std::runtime_error&)
+		catch(const std::runtime_error& err)
 			{
-			/* Ignore the error; reader thread will treat it as end-of-file: */
-			bufferSizes[inBuffer]=0;
+			/* Keep the data read so far and remember the error: */
+			errorMessage=err.what();
 			}
+		}
+	
+	return segmentSize-bufSize;
+	}
+
+void* ReadAheadFilter::readAheadThreadMethod(void)
+	{
+	/* Enable immediate cancellation: */
+	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
+	// Threads::Thread::setCancelType(Threads::Thread::CANCEL_ASYNCHRONOUS);
+	
+	size_t segmentDataSize;
+	std::string errorMessage;
+	do
+		{
+		/* Fill the next segment unless a read error occurred; hand the error to the reader with a final empty segment after the data read before the error: */
+		if(++inSegment==numSegments)
+			inSegment=0;
+		segmentDataSize=errorMessage.empty()?fillSegment(segmentMemory+inSegment*segmentSize,errorMessage):0;
 		
 		{
 		Threads::Mutex::Lock bufferLock(bufferMutex);
 		
-		/* Hand the filled buffer to the reader: */
-		++numFullBuffers;
+		/* Hand the filled segment, or the final empty segment and any error, to the reader: */
+		segmentDataSizes[inSegment]=segmentDataSize;
+		if(segmentDataSize==0)
+			readErrorMessage=errorMessage;
+		statistics.bytesAhead+=segmentDataSize;
+		++numFullSegments;
 		bufferCond.signal();
 		
-		/* Check if the double buffer is full: */
-		while(numFullBuffers==2)
+		/* Check if the ring buffer is full: */
+		if(numFullSegments==numSegments&&segmentDataSize!=0)
 			{
 			/* Wait for room in the buffer: */
-			bufferCond.wait(bufferMutex);
+			++statistics.numReadAheadStalls;
+			while(numFullSegments==numSegments)
+				bufferCond.wait(bufferMutex);
 			}
 		}
 		}
-	while(bufferSizes[inBuffer]!=0);
+	while(segmentDataSize!=0);
 	
 	return 0;
 	}
 
-ReadAheadFilter::ReadAheadFilter(FilePtr sSource)
+ReadAheadFilter::ReadAheadFilter(FilePtr sSource,size_t sSegmentSize,unsigned int sNumSegments)
 	:File(),
-	 source(sSource),
-	 halfBufferSize(Misc::max(source->getReadBufferSize(),size_t(8192))),
-	 inBuffer(1),outBuffer(1),numFullBuffers(0),
+	 source(sSource),fd(-1),directIO(false),
+	 segmentMemory(0),segmentDataSizes(0),
+	 numFullSegments(0),
 	 haveReadOnce(false)
 	{
-	/* Initialize the double buffer halves: */
-	buffers[0]=new Byte[halfBufferSize*2];
-	buffers[1]=buffers[0]+halfBufferSize;
-	for(int i=0;i<2;++i)
-		bufferSizes[i]=0;
+	/* Create the ring buffer and start reading ahead: */
+	init(sSegmentSize!=0?sSegmentSize:Misc::max(source->getReadBufferSize(),size_t(8192)),sNumSegments);
+	}
+
+ReadAheadFilter::ReadAheadFilter(const char* fileName,bool sDirectIO,size_t sSegmentSize,unsigned int sNumSegments)
+	:File(),
+	 fd(-1),directIO(false),
+	 segmentMemory(0),segmentDataSizes(0),
+	 numFullSegments(0),
+	 haveReadOnce(false)
+	{
+	#ifdef O_DIRECT
+	if(sDirectIO)
+		{
+		/* Try opening the file for direct I/O; fall back to regular I/O if the file system does not support it: */
+		fd=open(fileName,O_RDONLY|O_DIRECT);
+		directIO=fd>=0;
+		}
+	if(fd<0)
+	#endif
+		fd=open(fileName,O_RDONLY);
+	if(fd<0)
+		throw OpenError(Misc::makeLibcErrMsg(__PRETTY_FUNCTION__,errno,"Cannot open file %s",fileName));
 	
-	/* Start the read-ahead thread: */
-	readAheadThread.start(this,&ReadAheadFilter::readAheadThreadMethod);
+	#ifdef POSIX_FADV_SEQUENTIAL
+	/* Tell the operating system that the file will be read sequentially: */
+	if(!directIO)
+		posix_fadvise(fd,0,0,POSIX_FADV_SEQUENTIAL);
+	#endif
 	
-	/* Disable read-through: */
-	canReadThrough=false;
+	try
+		{
+		/* Create the ring buffer and start reading ahead: */
+		init(sSegmentSize!=0?sSegmentSize:size_t(1024*1024),sNumSegments);
+		}
+	catch(...)
+		{
+		close(fd);
+		throw;
+		}
 	}
 
 ReadAheadFilter::~ReadAheadFilter(void)
@@ -142,20 +285,40 @@ ReadAheadFilter::~ReadAheadFilter(void)
 	/* Release the file's read buffer: */
 	setReadBuffer(0,0,false);
 	
-	/* Delete the double buffer: */
-	delete[] buffers[0];
+	/* Delete the ring buffer: */
+	free(segmentMemory);
+	delete[] segmentDataSizes;
+	
+	/* Close a directly-read file: */
+	if(fd>=0)
+		close(fd);
+	}
+
+int ReadAheadFilter::getFd(void) const
+	{
+	/* Return the directly-read file's descriptor, or defer to the base class: */
+	if(fd>=0)
+		return fd;
+	else
+		return File::getFd();
 	}
 
 size_t ReadAheadFilter::getReadBufferSize(void) const
 	{
-	/* Return the size of a half buffer: */
-	return halfBufferSize;
+	/* Return the size of a segment: */
+	return segmentSize;
 	}
 
 size_t ReadAheadFilter::resizeReadBuffer(size_t newReadBufferSize)
 	{
 	/* Ignore the request and return the current read buffer size: */
-	return halfBufferSize;
+	return segmentSize;
+	}
+
+ReadAheadFilter::Statistics ReadAheadFilter::getStatistics(void)
+	{
+	Threads::Mutex::Lock bufferLock(bufferMutex);
+	return statistics;
 	}
 
 }
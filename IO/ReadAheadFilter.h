@@ -1,7 +1,8 @@
 /***********************************************************************
 ReadAheadFilter - Class to add background read-ahead to other IO::File
-abstractions to improve read throughput.
-Copyright (c) 2011 Oliver Kreylos
+abstractions, or to files read directly from the operating system, to
+improve read throughput.
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -23,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_READAHEADFILTER_INCLUDED
 #define IO_READAHEADFILTER_INCLUDED
 
+#include <string>
 #include <Threads/Mutex.h>
 #include <Threads/Cond.h>
 #include <Threads/Thread.h>
@@ -32,36 +34,68 @@ namespace IO {
 
 class ReadAheadFilter:public File
 	{
+	/* Embedded classes: */
+	public:
+	struct Statistics // Structure reporting the behavior of the read-ahead ring
+		{
+		/* Elements: */
+		public:
+		size_t numSegmentsRead; // Number of segments handed to the reader so far
+		size_t numReaderStalls; // Number of times the reader had to wait for the read-ahead thread to fill a segment
+		size_t numReadAheadStalls; // Number of times the read-ahead thread had to wait for the reader to release a segment
+		size_t bytesAhead; // Amount of data currently read ahead, but not yet handed to the reader
+		};
+
 	/* Elements: */
 	private:
-	FilePtr source; // The source file
+	FilePtr source; // The source file, or null if reading directly from a file descriptor
+	int fd; // File descriptor from which to read directly, or -1 if reading from a source file
+	bool directIO; // Flag whether the file descriptor was opened for direct I/O bypassing the operating system's page cache
 	Threads::Thread readAheadThread; // The background read-ahead thread
 	Threads::Mutex bufferMutex; // Mutex serializing access to the read-ahead ring buffer
 	Threads::Cond bufferCond; // Condition variable to signal a change in ring buffer state
-	size_t halfBufferSize; // Size of each half of the double buffer
-	Byte* buffers[2]; // Pointers to double buffer halves
-	unsigned int inBuffer; // Index of buffer currently read into
-	unsigned int outBuffer; // Index of buffer currently read from
-	unsigned int numFullBuffers; // Number of filled double buffer halves
-	unsigned int bufferSizes[2]; // Amount of data in the two buffer halves; amount less than full size indicates source was read completely
-	bool haveReadOnce; // Flag true if readData has consumed at least one buffer half
-	
+	size_t segmentSize; // Size of each segment of the ring buffer
+	unsigned int numSegments; // Number of segments in the ring buffer
+	Byte* segmentMemory; // Memory block holding all ring buffer segments, aligned for direct I/O
+	size_t* segmentDataSizes; // Amount of data in each segment; amount less than full size indicates source was read completely
+	unsigned int inSegment; // Index of segment currently read into
+	unsigned int outSegment; // Index of segment currently read from
+	unsigned int numFullSegments; // Number of filled segments, including the one currently read from
+	bool haveReadOnce; // Flag true if readData has consumed at least one segment
+	std::string readErrorMessage; // Message of an error encountered by the read-ahead thread; reported to the reader after the final segment instead of end-of-file
+	Statistics statistics; // Statistics about the read-ahead ring's behavior
+
 	/* Protected methods from IO::File: */
 	protected:
 	virtual size_t readData(Byte* buffer,size_t bufferSize);
-	
+
 	/* Private methods: */
 	private:
+	void init(size_t sSegmentSize,unsigned int sNumSegments); // Creates the ring buffer and starts the read-ahead thread
+	size_t fillSegment(Byte* segment,std::string& errorMessage); // Fills the given segment from the source file or file descriptor; returns the amount of data read, and stores the message of a read error in the given string
 	void* readAheadThreadMethod(void); // The background read-ahead thread's method
-	
+
 	/* Constructors and destructors: */
 	public:
-	ReadAheadFilter(FilePtr sSource);
+	ReadAheadFilter(FilePtr sSource,size_t sSegmentSize =0,unsigned int sNumSegments =2); // Reads ahead from the given source file into a ring of the given number of segments of the given size; segment size defaults to source's read buffer size if zero
+	ReadAheadFilter(const char* fileName,bool sDirectIO,size_t sSegmentSize =0,unsigned int sNumSegments =4); // Reads ahead from the given file directly into a ring of the given number of segments of the given size, optionally bypassing the operating system's page cache if supported; segment size defaults to 1MB if zero
 	virtual ~ReadAheadFilter(void);
-	
+
 	/* Methods from File: */
+	virtual int getFd(void) const;
 	virtual size_t getReadBufferSize(void) const;
 	virtual size_t resizeReadBuffer(size_t newReadBufferSize);
+
+	/* New methods: */
+	unsigned int getNumSegments(void) const // Returns the number of segments in the ring buffer
+		{
+		return numSegments;
+		}
+	bool isDirectIO(void) const // Returns true if the file is read bypassing the operating system's page cache
+		{
+		return directIO;
+		}
+	Statistics getStatistics(void); // Returns a snapshot of the read-ahead ring's statistics
 	};
 
 }
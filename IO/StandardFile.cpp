@@ -1,7 +1,7 @@
 /***********************************************************************
 StandardFile - Class for high-performance reading/writing from/to
 standard operating system files.
-Copyright (c) 2010-2024 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -27,6 +27,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <fcntl.h>
 #include <errno.h>
 #include <unistd.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <Misc/StdError.h>
 
 #ifdef __APPLE__
@@ -142,6 +144,59 @@ size_t StandardFile::writeDataUpTo(const File::Byte* buffer,size_t bufferSize)
 		}
 	}
 
+void StandardFile::writeDataVectored(const struct iovec* vectors,int numVectors)
+	{
+	/* Check if file needs to be repositioned: */
+	if(filePos!=writePos)
+		if(lseek64(fd,writePos,SEEK_SET)<0)
+			throw SeekError(__PRETTY_FUNCTION__,errno,writePos);
+	
+	/* Invalidate the read buffer to prevent reading stale data: */
+	flushReadBuffer();
+	
+	while(numVectors>0)
+		{
+		/* Write as many buffers as the operating system allows in one call: */
+		ssize_t writeResult=::writev(fd,vectors,numVectors<IOV_MAX?numVectors:IOV_MAX);
+		if(writeResult>0)
+			{
+			/* Advance the write pointer: */
+			writePos+=writeResult;
+			filePos=writePos;
+			
+			/* Skip all completely written buffers: */
+			size_t writeSize=size_t(writeResult);
+			while(numVectors>0&&writeSize>=vectors->iov_len)
+				{
+				writeSize-=vectors->iov_len;
+				++vectors;
+				--numVectors;
+				}
+			
+			/* Write the remainder of a partially written buffer individually: */
+			if(writeSize>0)
+				{
+				writeData(static_cast<const Byte*>(vectors->iov_base)+writeSize,vectors->iov_len-writeSize);
+				++vectors;
+				--numVectors;
+				}
+			}
+		else if(writeResult==0)
+			{
+			/* Skip empty buffers, or signal that the sink has reached end-of-file: */
+			if(vectors->iov_len!=0)
+				throw WriteError(__PRETTY_FUNCTION__,vectors->iov_len);
+			++vectors;
+			--numVectors;
+			}
+		else if(errno!=EAGAIN&&errno!=EWOULDBLOCK&&errno!=EINTR)
+			{
+			/* Unknown error; probably a bad thing: */
+			throw Error(Misc::makeLibcErrMsg(__PRETTY_FUNCTION__,errno,"Cannot write to file"));
+			}
+		}
+	}
+
 void StandardFile::openFile(const char* fileName,File::AccessMode accessMode,int flags,int mode)
 	{
 	/* Adjust flags according to access mode: */
@@ -1,6 +1,6 @@
 /***********************************************************************
 XMLSource - Class implementing a low-level XML file processor.
-Copyright (c) 2018-2024 Oliver Kreylos
+Copyright (c) 2018-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -431,6 +431,67 @@ XMLBase64Filter::XMLBase64Filter(XMLSource& sXml)
 	{
 	}
 
+/*******************************************************************
+Helper class to classify bytes while scanning UTF-8 encoded sources:
+*******************************************************************/
+
+class CharClasses
+	{
+	/* Embedded classes: */
+	public:
+	enum ClassFlags // Enumerated type for byte classes
+		{
+		ContentSpecial=0x01, // Bytes needing attention inside character data
+		CDataSpecial=0x02, // Bytes needing attention inside CDATA sections
+		AttributeSpecial=0x04, // Bytes needing attention inside attribute values
+		CommentSpecial=0x08, // Bytes needing attention inside comments
+		PISpecial=0x10, // Bytes needing attention inside processing instructions
+		NameChar=0x20, // ASCII name characters
+		Space=0x40 // Whitespace, including carriage returns
+		};
+	
+	/* Elements: */
+	private:
+	unsigned char classes[256]; // Class bit masks for all byte values
+	
+	/* Constructors and destructors: */
+	public:
+	CharClasses(void)
+		{
+		for(int c=0;c<256;++c)
+			{
+			unsigned char cl=0x0U;
+			
+			/* Non-ASCII bytes must be validated, and carriage returns must be normalized, everywhere: */
+			if(c>=0x80||c==0x0d)
+				cl|=ContentSpecial|CDataSpecial|AttributeSpecial|CommentSpecial|PISpecial;
+			if(c=='<'||c=='&'||c==']')
+				cl|=ContentSpecial;
+			if(c==']')
+				cl|=CDataSpecial;
+			if(c=='<'||c=='&'||c=='\"'||c=='\''||c==0x09||c==0x0a)
+				cl|=AttributeSpecial;
+			if(c=='-')
+				cl|=CommentSpecial;
+			if(c=='?')
+				cl|=PISpecial;
+			if(c<0x80&&isNameChar(c))
+				cl|=NameChar;
+			if(c==0x20||c==0x09||c==0x0a||c==0x0d)
+				cl|=Space;
+			classes[c]=cl;
+			}
+		}
+	
+	/* Methods: */
+	unsigned int operator[](unsigned char c) const // Returns the class bit mask of the given byte
+		{
+		return classes[c];
+		}
+	};
+
+const CharClasses charClasses;
+
 }
 
 /*********************************
@@ -515,6 +576,900 @@ void XMLSource::Processor::endElement(bool selfClosing)
 	/* Nothing to do! */
 	}
 
+void XMLSource::Processor::characterData(const XMLSource::StringView& characterData)
+	{
+	/* Process a copy of the character data: */
+	this->characterData(characterData.str());
+	}
+
+void XMLSource::Processor::comment(const XMLSource::StringView& comment)
+	{
+	/* Process a copy of the comment: */
+	this->comment(comment.str());
+	}
+
+void XMLSource::Processor::processingInstruction(const XMLSource::StringView& target,const XMLSource::StringView& instruction)
+	{
+	/* Process copies of the processing instruction's target and instruction: */
+	processingInstruction(target.str(),instruction.str());
+	}
+
+bool XMLSource::Processor::startElement(const XMLSource::StringView& name)
+	{
+	/* Start processing an element with a copy of the name: */
+	return startElement(name.str());
+	}
+
+void XMLSource::Processor::attribute(const XMLSource::StringView& name,const XMLSource::StringView& value)
+	{
+	/* Process copies of the attribute's name and value: */
+	attribute(name.str(),value.str());
+	}
+
+/*************************************
+Embedded class XMLSource::UTF8Scanner:
+*************************************/
+
+class XMLSource::UTF8Scanner
+	{
+	/* Embedded classes: */
+	private:
+	enum Markup // Enumerated type for the types of syntactic elements that can start at the current position
+		{
+		EndOfFile,CharacterData,Comment,ProcessingInstruction,OpeningTag,ClosingTag
+		};
+	
+	/* Elements: */
+	XMLSource& xmlSource; // The XML source whose file is scanned
+	File& source; // The XML source's file
+	Processor& processor; // The processor receiving the document's structure
+	size_t bufferSize; // Allocated size of the private buffer
+	char* buffer; // Private buffer to hold syntactic elements straddling the boundaries of the source's read buffer
+	const char* wBegin; // Pointer to the first unprocessed character, either in the source's read buffer or in the private buffer
+	const char* wEnd; // Pointer behind the last read character
+	const char* counted; // Pointer behind the last processed character that was counted towards the XML source's file position
+	bool hadCarriageReturn; // Flag if the last processed character was a carriage return
+	std::string decoded[2]; // Buffers to hold strings that had to be decoded
+	
+	/* Private methods: */
+	bool readMore(void) // Appends more data from the source to the current window; returns false at end of file
+		{
+		/* Count the processed characters before they are discarded: */
+		updateFilePos();
+		
+		size_t keepSize=wEnd-wBegin;
+		if(keepSize==0)
+			{
+			/* Scan directly inside the source's read buffer: */
+			void* readBuffer;
+			size_t readSize=source.readInBuffer(readBuffer);
+			wBegin=static_cast<const char*>(readBuffer);
+			wEnd=wBegin+readSize;
+			counted=wBegin;
+			return readSize!=0;
+			}
+		
+		/* Move the unprocessed data to the beginning of the private buffer, growing it if necessary: */
+		size_t newBufferSize=keepSize+source.getReadBufferSize();
+		if(bufferSize<newBufferSize)
+			{
+			if(newBufferSize<bufferSize*2)
+				newBufferSize=bufferSize*2;
+			char* newBuffer=new char[newBufferSize];
+			memcpy(newBuffer,wBegin,keepSize);
+			delete[] buffer;
+			bufferSize=newBufferSize;
+			buffer=newBuffer;
+			}
+		else if(wBegin!=buffer)
+			memmove(buffer,wBegin,keepSize);
+		
+		/* Append more data from the source: */
+		size_t readSize=source.readUpTo(buffer+keepSize,bufferSize-keepSize);
+		wBegin=buffer;
+		wEnd=buffer+keepSize+readSize;
+		counted=wBegin;
+		return readSize!=0;
+		}
+	bool ensure(size_t size) // Ensures that the given number of characters are available in the window; returns false at end of file
+		{
+		while(size_t(wEnd-wBegin)<size)
+			if(!readMore())
+				return false;
+		return true;
+		}
+	int peek(size_t pos) // Returns the byte at the given position in the window, or -1 at end of file
+		{
+		return ensure(pos+1)?int((unsigned char)(wBegin[pos])):-1;
+		}
+	size_t find(size_t pos,unsigned int classMask) // Returns the position of the next byte of the given classes, or the window size at end of file
+		{
+		while(true)
+			{
+			/* Scan the current window: */
+			const unsigned char* wPtr=reinterpret_cast<const unsigned char*>(wBegin)+pos;
+			const unsigned char* wPtrEnd=reinterpret_cast<const unsigned char*>(wEnd);
+			while(wPtr!=wPtrEnd&&(charClasses[*wPtr]&classMask)==0x0U)
+				++wPtr;
+			pos=wPtr-reinterpret_cast<const unsigned char*>(wBegin);
+			
+			/* Stop at a found byte or at end of file: */
+			if(wPtr!=wPtrEnd||!readMore())
+				return pos;
+			}
+		}
+	bool atEnd(size_t pos) const // Returns true if the given position is at the end of the window
+		{
+		return pos==size_t(wEnd-wBegin);
+		}
+	bool match(size_t pos,const char* string,size_t length) // Returns true if the given string starts at the given position
+		{
+		return ensure(pos+length)&&memcmp(wBegin+pos,string,length)==0;
+		}
+	int decodeChar(size_t pos,size_t& length) // Decodes the multi-byte character starting at the given position and returns its length in bytes
+		{
+		/* Decode the first byte: */
+		unsigned char code[4];
+		code[0]=(unsigned char)(wBegin[pos]);
+		unsigned int numContinuationBytes=Misc::UTF8::decodeFirst(code);
+		
+		/* Decode the remaining bytes: */
+		if(!ensure(pos+1+numContinuationBytes))
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated character");
+		for(unsigned int i=1;i<=numContinuationBytes;++i)
+			code[i]=(unsigned char)(wBegin[pos+i]);
+		length=1+numContinuationBytes;
+		return int(Misc::UTF8::decodeRest(code,numContinuationBytes));
+		}
+	size_t skipChar(size_t pos) // Skips the character at the given position, which must have been found by find(); returns position of next character
+		{
+		/* Validate multi-byte characters: */
+		size_t length=1;
+		if((unsigned char)(wBegin[pos])>=0x80U)
+			decodeChar(pos,length);
+		return pos+length;
+		}
+	bool isNameStartAt(size_t pos) // Returns true if a name starts at the given position
+		{
+		int c=peek(pos);
+		if(c>=0x80)
+			{
+			size_t length;
+			c=decodeChar(pos,length);
+			}
+		return isNameStartChar(c);
+		}
+	size_t scanName(size_t pos) // Returns the end position of the name starting at the given position
+		{
+		while(true)
+			{
+			int c=peek(pos);
+			if(c<0)
+				return pos;
+			else if(c<0x80)
+				{
+				if((charClasses[c]&CharClasses::NameChar)==0x0U)
+					return pos;
+				++pos;
+				}
+			else
+				{
+				size_t length;
+				if(!isNameChar(decodeChar(pos,length)))
+					return pos;
+				pos+=length;
+				}
+			}
+		}
+	size_t skipSpace(size_t pos) // Returns the position of the first non-whitespace character at or after the given position
+		{
+		int c;
+		while((c=peek(pos))>=0&&(charClasses[c]&CharClasses::Space)!=0x0U)
+			++pos;
+		return pos;
+		}
+	void updateFilePos(void) // Updates the XML source's file position by counting lines and columns in the processed part of the window
+		{
+		size_t size=wBegin-counted;
+		if(size==0)
+			return;
+		const unsigned char* wPtrBegin=reinterpret_cast<const unsigned char*>(counted);
+		const unsigned char* wPtrEnd=wPtrBegin+size;
+		if(memchr(counted,0x0d,size)==0&&!(hadCarriageReturn&&*wPtrBegin==0x0a))
+			{
+			/* Count line feeds in a simple loop that can be vectorized: */
+			size_t numLineFeeds=0;
+			for(const unsigned char* wPtr=wPtrBegin;wPtr!=wPtrEnd;++wPtr)
+				numLineFeeds+=*wPtr==0x0a?1:0;
+			
+			/* Find the beginning of the last line: */
+			const unsigned char* lineBegin=wPtrBegin;
+			if(numLineFeeds>0)
+				{
+				xmlSource.line+=numLineFeeds;
+				xmlSource.column=1;
+				for(lineBegin=wPtrEnd;lineBegin[-1]!=0x0a;--lineBegin)
+					;
+				}
+			
+			/* Count characters in the last line, skipping UTF-8 continuation bytes: */
+			size_t numChars=0;
+			for(const unsigned char* wPtr=lineBegin;wPtr!=wPtrEnd;++wPtr)
+				numChars+=(*wPtr&0xc0U)!=0x80U?1:0;
+			xmlSource.column+=numChars;
+			hadCarriageReturn=false;
+			}
+		else
+			{
+			/* Count lines and columns the same way as the Unicode decoder, which normalizes line breaks: */
+			for(const unsigned char* wPtr=wPtrBegin;wPtr!=wPtrEnd;++wPtr)
+				{
+				if(*wPtr==0x0a)
+					{
+					if(!hadCarriageReturn)
+						{
+						++xmlSource.line;
+						xmlSource.column=1;
+						}
+					hadCarriageReturn=false;
+					}
+				else if(*wPtr==0x0d)
+					{
+					++xmlSource.line;
+					xmlSource.column=1;
+					hadCarriageReturn=true;
+					}
+				else
+					{
+					/* Don't count UTF-8 continuation bytes: */
+					if((*wPtr&0xc0U)!=0x80U)
+						++xmlSource.column;
+					hadCarriageReturn=false;
+					}
+				}
+			}
+		
+		counted=wBegin;
+		}
+	void consume(size_t size) // Removes the given number of processed characters from the window
+		{
+		wBegin+=size;
+		}
+	template <class ErrorParam>
+	void error(size_t pos,const char* what) // Throws an error of the given type for the character at the given position
+		{
+		/* Consume the erroneous character to update the XML source's file position: */
+		if(pos<size_t(wEnd-wBegin))
+			++pos;
+		consume(pos);
+		updateFilePos();
+		
+		throw ErrorParam(xmlSource,what);
+		}
+	void appendNormalized(size_t begin,size_t end,std::string& string) // Appends the given range of the window to the given string while normalizing line breaks
+		{
+		while(begin<end)
+			{
+			/* Copy characters up to the next carriage return: */
+			const char* crPtr=static_cast<const char*>(memchr(wBegin+begin,0x0d,end-begin));
+			size_t crPos=crPtr!=0?size_t(crPtr-wBegin):end;
+			string.append(wBegin+begin,wBegin+crPos);
+			if(crPos==end)
+				break;
+			
+			/* Replace a carriage return or a CR/LF pair with a line feed: */
+			string.push_back(char(0x0a));
+			begin=crPos+1;
+			if(begin<end&&wBegin[begin]==0x0a)
+				++begin;
+			}
+		}
+	int parseReference(size_t& pos) // Parses the character or entity reference starting at the given position; returns the referenced character and advances the position past the reference
+		{
+		int c=peek(++pos);
+		if(c=='#')
+			{
+			/* Parse a character reference: */
+			int code=0;
+			c=peek(++pos);
+			if(c=='x')
+				{
+				/* Parse a hexadecimal character reference: */
+				while(isHexDigit(c=peek(++pos)))
+					code=code*16+(c<'A'?c-'0':(c<'a'?c-'A':c-'a')+10);
+				}
+			else
+				{
+				/* Parse a decimal character reference: */
+				while(isDigit(c))
+					{
+					code=code*10+c-'0';
+					c=peek(++pos);
+					}
+				}
+			
+			/* Check for terminating semicolon: */
+			if(c!=';')
+				error<SyntaxError>(pos,"Missing ';' in character reference");
+			++pos;
+			
+			/* Check character for validity: */
+			bool codeValid=code==0x9||code==0xa||code==0xd||(code>=0x20&&code<=0xd7ff)||(code>=0xe000&&code<=0xfffd)||(code>=0x10000&&code<=0x10ffff);
+			if(!codeValid)
+				error<WellFormedError>(pos-1,"Illegal character reference");
+			
+			return code;
+			}
+		else if(isNameStartAt(pos))
+			{
+			/* Parse one of the predefined entity references: */
+			static const char* names[5]={"amp;","lt;","gt;","apos;","quot;"};
+			static const char characters[5]={'&','<','>','\'','\"'};
+			for(int i=0;i<5;++i)
+				{
+				size_t length=strlen(names[i]);
+				if(match(pos,names[i],length))
+					{
+					pos+=length;
+					return characters[i];
+					}
+				}
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Entity references not supported");
+			}
+		else
+			error<SyntaxError>(pos,"Malformed reference");
+		
+		return -1; // Never reached; just to make compiler happy
+		}
+	Markup detectMarkup(void) // Detects the type of syntactic element starting at the beginning of the window
+		{
+		int c=peek(0);
+		if(c<0)
+			return EndOfFile;
+		else if(c!='<')
+			return CharacterData;
+		
+		/* Determine the type of markup: */
+		c=peek(1);
+		if(c=='!')
+			{
+			/* Distinguish between comments, CDATA sections, and entity declarations: */
+			if(match(2,"--",2))
+				return Comment;
+			else if(match(2,"[CDATA[",7))
+				return CharacterData;
+			else
+				throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Entitity declarations not supported");
+			}
+		else if(c=='?')
+			{
+			if(!isNameStartAt(2))
+				error<SyntaxError>(2,"Malformed processing instruction");
+			return ProcessingInstruction;
+			}
+		else if(c=='/')
+			{
+			if(!isNameStartAt(2))
+				error<SyntaxError>(2,"Malformed closing tag");
+			return ClosingTag;
+			}
+		else if(!isNameStartAt(1))
+			error<SyntaxError>(1,"Malformed opening tag");
+		
+		return OpeningTag;
+		}
+	size_t scanCData(size_t pos) // Returns the position behind the end of the CDATA section starting at the given position
+		{
+		pos+=9;
+		while(true)
+			{
+			pos=find(pos,CharClasses::CDataSpecial);
+			if(atEnd(pos))
+				error<SyntaxError>(pos,"Unterminated character data at end of file");
+			if(wBegin[pos]==']')
+				{
+				/* Check for the end of the CDATA section: */
+				if(match(pos,"]]>",3))
+					return pos+3;
+				++pos;
+				}
+			else
+				pos=skipChar(pos);
+			}
+		}
+	void decodeCharacterData(size_t end,std::string& string) // Decodes the already-scanned character data ending at the given position into the given string
+		{
+		string.clear();
+		size_t pos=0;
+		while(pos<end)
+			{
+			/* Copy characters up to the next reference or CDATA section: */
+			size_t runEnd=pos;
+			while(runEnd<end&&wBegin[runEnd]!='&'&&wBegin[runEnd]!='<')
+				++runEnd;
+			appendNormalized(pos,runEnd,string);
+			pos=runEnd;
+			
+			if(pos<end)
+				{
+				if(wBegin[pos]=='&')
+					{
+					/* Decode a reference: */
+					Misc::UTF8::encode(parseReference(pos),string);
+					}
+				else
+					{
+					/* Copy the contents of a CDATA section: */
+					size_t cdataEnd=scanCData(pos);
+					appendNormalized(pos+9,cdataEnd-3,string);
+					pos=cdataEnd;
+					}
+				}
+			}
+		}
+	size_t scanAttributeValue(size_t pos,int quote,bool& plain) // Returns the position of the closing quote of the attribute value starting at the given position
+		{
+		while(true)
+			{
+			pos=find(pos,CharClasses::AttributeSpecial);
+			if(atEnd(pos))
+				error<SyntaxError>(pos,"Unterminated attribute value at end of file");
+			int c=(unsigned char)(wBegin[pos]);
+			if(c==quote)
+				return pos;
+			else if(c=='<')
+				error<WellFormedError>(pos,"Illegal '<' in attribute value");
+			else if(c=='&')
+				{
+				/* Validate the reference: */
+				plain=false;
+				if(parseReference(pos)=='<')
+					error<WellFormedError>(pos-1,"Illegal '<' in attribute value");
+				}
+			else if(c==0x09||c==0x0a||c==0x0d)
+				{
+				plain=false;
+				++pos;
+				}
+			else
+				pos=skipChar(pos);
+			}
+		}
+	void decodeAttributeValue(size_t pos,size_t end,std::string& string) // Decodes the already-scanned attribute value in the given range into the given string
+		{
+		string.clear();
+		while(pos<end)
+			{
+			char c=wBegin[pos];
+			if(c=='&')
+				{
+				/* Decode a reference: */
+				int ref=parseReference(pos);
+				if(ref=='<')
+					error<WellFormedError>(pos-1,"Illegal '<' in attribute value");
+				Misc::UTF8::encode(ref,string);
+				}
+			else if(c==0x09||c==0x0a||c==0x0d)
+				{
+				/* Convert the whitespace character or CR/LF pair to an actual space: */
+				string.push_back(' ');
+				++pos;
+				if(c==0x0d&&pos<end&&wBegin[pos]==0x0a)
+					++pos;
+				}
+			else
+				{
+				string.push_back(c);
+				++pos;
+				}
+			}
+		}
+	void processCharacterData(bool report) // Processes character data starting at the beginning of the window
+		{
+		/* Find the end of the character data and check if it needs to be decoded: */
+		bool plain=true;
+		size_t pos=0;
+		while(true)
+			{
+			pos=find(pos,CharClasses::ContentSpecial);
+			if(atEnd(pos))
+				break;
+			char c=wBegin[pos];
+			if(c=='<')
+				{
+				/* Continue through a CDATA section, or stop at any other markup: */
+				if(!match(pos,"<![CDATA[",9))
+					break;
+				plain=false;
+				pos=scanCData(pos);
+				}
+			else if(c=='&')
+				{
+				/* Validate the reference: */
+				plain=false;
+				parseReference(pos);
+				}
+			else if(c==0x0d)
+				{
+				plain=false;
+				++pos;
+				}
+			else if(c==']')
+				{
+				/* Check for a misplaced CDATA section end: */
+				if(match(pos,"]]>",3))
+					error<SyntaxError>(pos,"Illegal ']]>' in character data");
+				++pos;
+				}
+			else
+				pos=skipChar(pos);
+			}
+		
+		/* Decode the character data if necessary: */
+		if(!plain)
+			decodeCharacterData(pos,decoded[0]);
+		StringView characterData=plain?StringView(wBegin,pos):StringView(decoded[0]);
+		
+		/* Check for non-whitespace character data outside the root element: */
+		if(processor.currentSection!=Processor::RootElement)
+			{
+			for(const char* cdPtr=characterData.begin();cdPtr!=characterData.end();++cdPtr)
+				if(!isSpace(*cdPtr))
+					{
+					/* Find the first non-whitespace source character to report the error's position: */
+					size_t errorPos=0;
+					while((charClasses[(unsigned char)(wBegin[errorPos])]&CharClasses::Space)!=0x0U)
+						++errorPos;
+					error<WellFormedError>(errorPos,processor.currentSection==Processor::Prolog?"Non-whitespace character data in XML prolog":"Non-whitespace character data in XML epilog");
+					}
+			}
+		
+		/* Process the character data: */
+		if(report&&(processor.nodeTypeMask&Processor::CharacterData)!=0x0)
+			processor.characterData(characterData);
+		
+		consume(pos);
+		}
+	void processComment(bool report) // Processes a comment starting at the beginning of the window
+		{
+		/* Find the end of the comment: */
+		bool plain=true;
+		size_t pos=4;
+		while(true)
+			{
+			pos=find(pos,CharClasses::CommentSpecial);
+			if(atEnd(pos))
+				error<SyntaxError>(pos,"Unterminated comment at end of file");
+			char c=wBegin[pos];
+			if(c=='-')
+				{
+				/* Check for the end of the comment: */
+				if(peek(pos+1)=='-')
+					{
+					if(peek(pos+2)!='>')
+						error<SyntaxError>(pos+2,"Illegal -- in comment");
+					break;
+					}
+				++pos;
+				}
+			else if(c==0x0d)
+				{
+				plain=false;
+				++pos;
+				}
+			else
+				pos=skipChar(pos);
+			}
+		
+		/* Process the comment: */
+		if(report&&(processor.nodeTypeMask&Processor::Comment)!=0x0)
+			{
+			if(plain)
+				processor.comment(StringView(wBegin+4,pos-4));
+			else
+				{
+				decoded[0].clear();
+				appendNormalized(4,pos,decoded[0]);
+				processor.comment(StringView(decoded[0]));
+				}
+			}
+		
+		consume(pos+3);
+		}
+	void processPI(bool report) // Processes a processing instruction starting at the beginning of the window
+		{
+		/* Find the end of the target and the start of the instruction: */
+		size_t targetEnd=scanName(2);
+		size_t instructionBegin=skipSpace(targetEnd);
+		
+		/* Find the end of the instruction: */
+		bool plain=true;
+		size_t pos=instructionBegin;
+		while(true)
+			{
+			pos=find(pos,CharClasses::PISpecial);
+			if(atEnd(pos))
+				error<SyntaxError>(pos,"Unterminated processing instruction at end of file");
+			char c=wBegin[pos];
+			if(c=='?')
+				{
+				/* Check for the end of the processing instruction: */
+				if(peek(pos+1)=='>')
+					break;
+				++pos;
+				}
+			else if(c==0x0d)
+				{
+				plain=false;
+				++pos;
+				}
+			else
+				pos=skipChar(pos);
+			}
+		
+		/* Process the processing instruction: */
+		if(report&&(processor.nodeTypeMask&Processor::ProcessingInstruction)!=0x0)
+			{
+			if(plain)
+				processor.processingInstruction(StringView(wBegin+2,targetEnd-2),StringView(wBegin+instructionBegin,pos-instructionBegin));
+			else
+				{
+				decoded[0].clear();
+				appendNormalized(instructionBegin,pos,decoded[0]);
+				processor.processingInstruction(StringView(wBegin+2,targetEnd-2),StringView(decoded[0]));
+				}
+			}
+		
+		consume(pos+2);
+		}
+	void processElement(bool report) // Processes an element starting at the beginning of the window
+		{
+		/* Read the element name and start processing the element: */
+		size_t nameEnd=scanName(1);
+		processor.activeElements.push_back(std::string(wBegin+1,wBegin+nameEnd));
+		bool reportElement=report&&(processor.nodeTypeMask&Processor::Element)!=0x0;
+		bool enterElement=true;
+		if(reportElement)
+			enterElement=processor.startElement(StringView(wBegin+1,nameEnd-1));
+		reportElement=reportElement&&enterElement;
+		bool reportAttributes=report&&enterElement&&(processor.nodeTypeMask&Processor::Attribute)!=0x0;
+		
+		/* Process all attribute/value pairs: */
+		size_t pos=nameEnd;
+		bool selfClosing;
+		while(true)
+			{
+			/* Skip whitespace and check for the end of the tag: */
+			size_t attributeBegin=skipSpace(pos);
+			int c=peek(attributeBegin);
+			if(c=='>')
+				{
+				/* This was not a self-closing tag: */
+				selfClosing=false;
+				pos=attributeBegin+1;
+				break;
+				}
+			else if(c=='/')
+				{
+				/* Check if the next character is a '>': */
+				if(peek(attributeBegin+1)!='>')
+					error<SyntaxError>(attributeBegin,"Illegal '/' in tag");
+				
+				/* This was a self-closing tag: */
+				selfClosing=true;
+				pos=attributeBegin+2;
+				break;
+				}
+			else if(attributeBegin==pos||!isNameStartAt(attributeBegin))
+				error<SyntaxError>(attributeBegin,"Malformed tag");
+			
+			/* Read the attribute name: */
+			size_t attributeEnd=scanName(attributeBegin);
+			
+			/* Check for assignment: */
+			pos=skipSpace(attributeEnd);
+			if(peek(pos)!='=')
+				error<SyntaxError>(pos,"Missing '=' in tag attribute");
+			
+			/* Check for quote: */
+			pos=skipSpace(pos+1);
+			int quote=peek(pos);
+			if(!isQuote(quote))
+				error<SyntaxError>(pos,"Missing tag attribute value");
+			
+			/* Find the end of the attribute value: */
+			size_t valueBegin=pos+1;
+			bool plain=true;
+			size_t valueEnd=scanAttributeValue(valueBegin,quote,plain);
+			pos=valueEnd+1;
+			
+			/* Process the attribute: */
+			if(reportAttributes)
+				{
+				if(plain)
+					processor.attribute(StringView(wBegin+attributeBegin,attributeEnd-attributeBegin),StringView(wBegin+valueBegin,valueEnd-valueBegin));
+				else
+					{
+					decodeAttributeValue(valueBegin,valueEnd,decoded[1]);
+					processor.attribute(StringView(wBegin+attributeBegin,attributeEnd-attributeBegin),StringView(decoded[1]));
+					}
+				}
+			}
+		consume(pos);
+		
+		if(!selfClosing)
+			{
+			if(reportElement)
+				processor.enterElement();
+			
+			/* Process the element's content: */
+			bool reportContent=report&&enterElement;
+			while(true)
+				{
+				/* Proceed based on the type of the next syntactic element: */
+				Markup markup=detectMarkup();
+				if(markup==CharacterData)
+					processCharacterData(reportContent);
+				else if(markup==Comment)
+					processComment(reportContent);
+				else if(markup==ProcessingInstruction)
+					processPI(reportContent);
+				else if(markup==OpeningTag)
+					processElement(reportContent);
+				else if(markup==ClosingTag)
+					{
+					/* Read the closing tag: */
+					size_t closingNameEnd=scanName(2);
+					pos=skipSpace(closingNameEnd);
+					if(peek(pos)!='>')
+						error<SyntaxError>(pos,"Malformed tag");
+					
+					/* Check that the closing tag matches this element's name: */
+					if(StringView(wBegin+2,closingNameEnd-2)!=processor.activeElements.back())
+						error<WellFormedError>(pos,"Mismatching closing tag name");
+					consume(pos+1);
+					
+					/* Stop reading content: */
+					break;
+					}
+				else
+					error<WellFormedError>(0,"Unterminated element");
+				}
+			}
+		
+		/* Stop processing the element: */
+		if(reportElement)
+			processor.endElement(selfClosing);
+		processor.activeElements.pop_back();
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	UTF8Scanner(XMLSource& sXmlSource,Processor& sProcessor)
+		:xmlSource(sXmlSource),source(*sXmlSource.source),processor(sProcessor),
+		 bufferSize(0),buffer(0),
+		 wBegin(0),wEnd(0),counted(0),
+		 hadCarriageReturn(false)
+		{
+		/* Reconstruct the markup prefix already consumed by the XML source while detecting the first syntactic element: */
+		std::string prefix;
+		switch(xmlSource.syntaxType)
+			{
+			case XMLSource::Comment:
+				prefix="<!--";
+				break;
+			
+			case ProcessingInstructionTarget:
+				prefix="<?";
+				break;
+			
+			case TagName:
+				prefix=xmlSource.openTag?"<":"</";
+				break;
+			
+			case CData:
+				prefix="<![CDATA[";
+				break;
+			
+			default:
+				;
+			}
+		
+		size_t prefixSize=prefix.size();
+		
+		/* Re-encode the characters already decoded by the XML source: */
+		for(int* cbPtr=xmlSource.cbNext;cbPtr!=xmlSource.cbEnd;++cbPtr)
+			Misc::UTF8::encode(*cbPtr,prefix);
+		if(xmlSource.hadCarriageReturn)
+			{
+			if(xmlSource.cbNext!=xmlSource.cbEnd)
+				{
+				/* Turn the line feed decoded from the last carriage return back into a carriage return to skip a following line feed: */
+				prefix[prefix.size()-1]=char(0x0d);
+				}
+			else
+				{
+				/* Skip a line feed immediately following the already-processed carriage return: */
+				int c=source.getChar();
+				if(c>=0&&c!=0x0a)
+					source.ungetChar(c);
+				}
+			}
+		
+		/* Start the file position at the beginning of the reconstructed prefix: */
+		std::pair<size_t,size_t> filePos=xmlSource.getFilePosition();
+		xmlSource.line=filePos.first;
+		xmlSource.column=filePos.second-prefixSize;
+		xmlSource.cbNext=xmlSource.cbEnd=xmlSource.charBuffer+xmlSource.charBufferSize/2;
+		
+		/* Copy the prefix into the private buffer: */
+		if(!prefix.empty())
+			{
+			bufferSize=prefix.size()+source.getReadBufferSize();
+			buffer=new char[bufferSize];
+			memcpy(buffer,prefix.data(),prefix.size());
+			wBegin=buffer;
+			wEnd=buffer+prefix.size();
+			counted=wBegin;
+			}
+		}
+	private:
+	UTF8Scanner(const UTF8Scanner& source); // Prohibit copy constructor
+	UTF8Scanner& operator=(const UTF8Scanner& source); // Prohibit assignment operator
+	public:
+	~UTF8Scanner(void)
+		{
+		delete[] buffer;
+		}
+	
+	/* Methods: */
+	void process(void) // Processes the entire XML document
+		{
+		/* Process character data, comments, and processing instructions preceding the root element: */
+		Markup markup;
+		processor.currentSection=Processor::Prolog;
+		processor.activeElements.clear();
+		while((markup=detectMarkup())!=OpeningTag&&markup!=ClosingTag)
+			{
+			if(markup==EndOfFile)
+				error<WellFormedError>(0,"No root element in XML document");
+			else if(markup==CharacterData)
+				processCharacterData(true);
+			else if(markup==Comment)
+				processComment(true);
+			else
+				processPI(true);
+			}
+		
+		/* Check if the tag is an opening tag: */
+		if(markup!=OpeningTag)
+			error<WellFormedError>(1,"Missing opening tag for root element");
+		
+		/* Process the root element: */
+		processor.currentSection=Processor::RootElement;
+		processElement(true);
+		
+		/* Process character data, comments, and processing instructions succeeding the root element: */
+		processor.currentSection=Processor::Epilog;
+		processor.activeElements.clear();
+		while((markup=detectMarkup())!=EndOfFile)
+			{
+			if(markup==CharacterData)
+				processCharacterData(true);
+			else if(markup==Comment)
+				processComment(true);
+			else if(markup==ProcessingInstruction)
+				processPI(true);
+			else
+				error<WellFormedError>(1,"Illegal syntactic element in XML epilog");
+			}
+		
+		/* Mark the XML source as completely read: */
+		updateFilePos();
+		xmlSource.syntaxType=XMLSource::EndOfFile;
+		}
+	};
+
 /**************************
 Methods of class XMLSource:
 **************************/
@@ -715,15 +1670,15 @@ int XMLSource::parseReference(void)
 		{
 		/* Put the character back and parse an entity reference name: */
 		ungetChar();
-		if(readAhead(3)&&matchString("amp"))
+		if(readAhead(4)&&matchString("amp;"))
 			return '&';
-		if(readAhead(2)&&matchString("lt"))
+		if(readAhead(3)&&matchString("lt;"))
 			return '<';
-		if(readAhead(2)&&matchString("gt"))
+		if(readAhead(3)&&matchString("gt;"))
 			return '>';
-		if(readAhead(4)&&matchString("apos"))
+		if(readAhead(5)&&matchString("apos;"))
 			return '\'';
-		if(readAhead(4)&&matchString("quot"))
+		if(readAhead(5)&&matchString("quot;"))
 			return '\"';
 		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Entity references not supported");
 		}
@@ -1052,7 +2007,7 @@ void XMLSource::processCharacterData(XMLSource::Processor& processor)
 			int c;
 			while((c=readCharacterData())>=0)
 				Misc::UTF8::encode(c,characterData);
-			processor.characterData(characterData);
+			processor.characterData(StringView(characterData));
 			}
 		else
 			{
@@ -1083,7 +2038,7 @@ void XMLSource::processCharacterData(XMLSource::Processor& processor)
 					throw WellFormedError(*this,errorString);
 				Misc::UTF8::encode(c,characterData);
 				}
-			processor.characterData(characterData);
+			processor.characterData(StringView(characterData));
 			}
 		else
 			{
@@ -1106,7 +2061,7 @@ void XMLSource::processComment(XMLSource::Processor& processor)
 		int c;
 		while((c=readComment())>=0)
 			Misc::UTF8::encode(c,comment);
-		processor.comment(comment);
+		processor.comment(StringView(comment));
 		}
 	else
 		{
@@ -1126,19 +2081,21 @@ void XMLSource::processPI(XMLSource::Processor& processor)
 		int c;
 		while((c=readName())>=0)
 			Misc::UTF8::encode(c,target);
-		while((c=readProcessingInstruction())>=0)
-			Misc::UTF8::encode(c,instruction);
+		if(syntaxType==ProcessingInstructionContent)
+			while((c=readProcessingInstruction())>=0)
+				Misc::UTF8::encode(c,instruction);
 		
 		/* Process the processing instruction: */
-		processor.processingInstruction(target,instruction);
+		processor.processingInstruction(StringView(target),StringView(instruction));
 		}
 	else
 		{
 		/* Skip the processing instruction's target and instruction: */
 		while(readName()>=0)
 			;
-		while(readProcessingInstruction()>=0)
-			;
+		if(syntaxType==ProcessingInstructionContent)
+			while(readProcessingInstruction()>=0)
+				;
 		}
 	}
 
@@ -1156,7 +2113,7 @@ void XMLSource::processElement(XMLSource::Processor& processor)
 	/* Check if the processor is interested in elements: */
 	bool enterElement=true;
 	if((processor.nodeTypeMask&Processor::Element)!=0x0)
-		enterElement=processor.startElement(elementName);
+		enterElement=processor.startElement(StringView(elementName));
 	
 	/* Check if the element should be processed: */
 	if(enterElement)
@@ -1176,7 +2133,7 @@ void XMLSource::processElement(XMLSource::Processor& processor)
 					Misc::UTF8::encode(c,attributeValue);
 				
 				/* Process the attribute: */
-				processor.attribute(attributeName,attributeValue);
+				processor.attribute(StringView(attributeName),StringView(attributeValue));
 				}
 			}
 		else
@@ -1379,6 +2336,10 @@ int XMLSource::readName(void)
 	switch(syntaxType)
 		{
 		case ProcessingInstructionTarget:
+			/* Put the first non-space character back: */
+			if(c>=0)
+				ungetChar();
+			
 			/* Check if this is the processing instruction's end: */
 			if(readAhead(2)&&matchString("?>"))
 				{
@@ -1411,6 +2372,9 @@ int XMLSource::readName(void)
 					throw SyntaxError(*this,"Illegal '/' in tag");
 				else
 					{
+					/* This was a self-closing tag: */
+					selfCloseTag=true;
+					
 					/* Detect the next syntax type: */
 					detectNextSyntaxType();
 					}
@@ -1787,8 +2751,9 @@ void XMLSource::skipElement(const std::string& elementName)
 					;
 				
 				/* Skip the processing instruction content: */
-				while(readProcessingInstruction()>=0)
-					;
+				if(syntaxType==ProcessingInstructionContent)
+					while(readProcessingInstruction()>=0)
+						;
 				}
 			else if(syntaxType==Content||syntaxType==CData)
 				{
@@ -1878,6 +2843,14 @@ bool XMLSource::skipToElement(const char* elementName)
 
 void XMLSource::process(XMLSource::Processor& processor)
 	{
+	/* Scan UTF-8 encoded sources directly without decoding them into Unicode characters: */
+	if(readNextChar==UTF8::read)
+		{
+		UTF8Scanner scanner(*this,processor);
+		scanner.process();
+		return;
+		}
+	
 	/* Read character data, comments, and processing instructions preceding the root element: */
 	processor.currentSection=Processor::Prolog;
 	processor.activeElements.clear();
@@ -1885,7 +2858,7 @@ void XMLSource::process(XMLSource::Processor& processor)
 		{
 		/* Proceed based on the type of the current syntactic element: */
 		if(eof())
-			throw WellFormedError(source,"No root element in XML document");
+			throw WellFormedError(*this,"No root element in XML document");
 		else if(isCharacterData())
 			processCharacterData(processor);
 		else if(isComment())
@@ -1893,12 +2866,12 @@ void XMLSource::process(XMLSource::Processor& processor)
 		else if(isPITarget())
 			processPI(processor);
 		else
-			throw WellFormedError(source,"Illegal syntactic element in XML prolog");
+			throw WellFormedError(*this,"Illegal syntactic element in XML prolog");
 		}
 	
 	/* Check if the tag is an opening tag: */
 	if(!isOpeningTag())
-		throw WellFormedError(source,"Missing opening tag for root element");
+		throw WellFormedError(*this,"Missing opening tag for root element");
 	
 	/* Process the root element: */
 	processor.currentSection=Processor::RootElement;
@@ -1917,7 +2890,7 @@ void XMLSource::process(XMLSource::Processor& processor)
 		else if(isPITarget())
 			processPI(processor);
 		else
-			throw WellFormedError(source,"Illegal syntactic element in XML epilog");
+			throw WellFormedError(*this,"Illegal syntactic element in XML epilog");
 		}
 	}
 
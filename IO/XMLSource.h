@@ -1,6 +1,6 @@
 /***********************************************************************
 XMLSource - Class implementing a low-level XML file processor.
-Copyright (c) 2018-2022 Oliver Kreylos
+Copyright (c) 2018-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -22,6 +22,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_XMLSOURCE_INCLUDED
 #define IO_XMLSOURCE_INCLUDED
 
+#include <stddef.h>
+#include <string.h>
 #include <utility>
 #include <string>
 #include <stdexcept>
@@ -33,6 +35,9 @@ namespace IO {
 class XMLSource
 	{
 	/* Embedded classes: */
+	private:
+	class UTF8Scanner; // Helper class to process UTF-8 encoded XML sources directly from the source file's read buffer
+	
 	public:
 	class Error:public std::runtime_error // Base class for XML processing errors
 		{
@@ -74,9 +79,71 @@ class XMLSource
 			}
 		};
 	
+	class StringView // Class for non-owning references to UTF-8 encoded strings handed to processors; only valid during the processor method call receiving them
+		{
+		/* Elements: */
+		private:
+		const char* first; // Pointer to the first character of the string
+		size_t length; // Length of the string in bytes
+		
+		/* Constructors and destructors: */
+		public:
+		StringView(const char* sFirst,size_t sLength) // Creates a view of the given character range
+			:first(sFirst),length(sLength)
+			{
+			}
+		StringView(const std::string& string) // Creates a view of the given string's contents
+			:first(string.data()),length(string.size())
+			{
+			}
+		
+		/* Methods: */
+		const char* begin(void) const // Returns a pointer to the first character
+			{
+			return first;
+			}
+		const char* end(void) const // Returns a pointer behind the last character
+			{
+			return first+length;
+			}
+		size_t size(void) const // Returns the length of the string in bytes
+			{
+			return length;
+			}
+		bool empty(void) const // Returns true if the string is empty
+			{
+			return length==0;
+			}
+		char operator[](size_t index) const // Returns the character at the given index
+			{
+			return first[index];
+			}
+		std::string str(void) const // Returns a copy of the string
+			{
+			return std::string(first,length);
+			}
+		bool operator==(const char* string) const // Returns true if the string is equal to the given NUL-terminated string
+			{
+			return strncmp(first,string,length)==0&&string[length]=='\0';
+			}
+		bool operator!=(const char* string) const
+			{
+			return !operator==(string);
+			}
+		bool operator==(const std::string& string) const // Returns true if the string is equal to the given string
+			{
+			return length==string.size()&&memcmp(first,string.data(),length)==0;
+			}
+		bool operator!=(const std::string& string) const
+			{
+			return !operator==(string);
+			}
+		};
+	
 	class Processor // Base class for objects that process the structure of an XML file during parsing
 		{
 		friend class XMLSource;
+		friend class UTF8Scanner;
 		
 		/* Embedded classes: */
 		public:
@@ -132,9 +199,18 @@ class XMLSource
 		virtual void attribute(const std::string& name,const std::string& value); // Processes an element attribute
 		virtual void enterElement(void); // Enters an XML element's content after all attribute/value pairs have been processed; is not called for elements with self-closing start tags
 		virtual void endElement(bool selfClosing); // Ends processing the current XML element; flag is true if the element's start tag was self-closing
+		
+		/* Zero-copy versions of the above methods, which receive views of strings that are only decoded when necessary; default implementations copy the strings and call the above methods: */
+		virtual void characterData(const StringView& characterData);
+		virtual void comment(const StringView& comment);
+		virtual void processingInstruction(const StringView& target,const StringView& instruction);
+		virtual bool startElement(const StringView& name);
+		virtual void attribute(const StringView& name,const StringView& value);
 		};
 	
 	private:
+	friend class UTF8Scanner;
+	
 	typedef int (*ReadNextCharFunction)(File& source); // Type for functions reading a single character from an input file; returns -1 at end of file and throws exception on decoding error
 	
 	enum SyntaxType // Enumerated type for states in the syntactic state machine
@@ -333,7 +409,7 @@ class XMLSource
 		{
 		return skipToElement(elementName.c_str());
 		}
-	void process(Processor& processor); // Processes the XML document with the given processor; must be called immediately after construction
+	void process(Processor& processor); // Processes the XML document with the given processor; must be called immediately after construction; scans UTF-8 encoded sources without decoding them into Unicode characters
 	};
 
 }
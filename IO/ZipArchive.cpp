@@ -2,7 +2,7 @@
 ZipArchive - Class to represent ZIP archive files, with functionality to
 traverse contained directory hierarchies and extract files using a File
 interface.
-Copyright (c) 2011-2024 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -31,13 +31,63 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/SizedTypes.h>
 #include <Misc/StdError.h>
 #include <Misc/MessageLogger.h>
+#include <Threads/WorkerPool.h>
 #include <IO/StandardFile.h>
+#include <IO/MemMappedFile.h>
 #include <IO/FixedMemoryFile.h>
 
 namespace IO {
 
 namespace {
 
+/****************
+Helper functions:
+****************/
+
+inline unsigned int getUInt16(const unsigned char* data) // Returns a little-endian 16-bit unsigned integer from the given memory location
+	{
+	return (unsigned int)(data[0])|((unsigned int)(data[1])<<8);
+	}
+
+inline unsigned int getUInt32(const unsigned char* data) // Returns a little-endian 32-bit unsigned integer from the given memory location
+	{
+	return (unsigned int)(data[0])|((unsigned int)(data[1])<<8)|((unsigned int)(data[2])<<16)|((unsigned int)(data[3])<<24);
+	}
+
+inline void checkCompressionMethod(unsigned int compressionMethod,const char* source) // Throws an exception if the given compression method is neither stored (0) nor deflated (8)
+	{
+	if(compressionMethod!=0&&compressionMethod!=8)
+		throw File::OpenError(Misc::makeStdErrMsg(source,"Unsupported compression method %u",compressionMethod));
+	}
+
+int inflateFileData(const Bytef* compressed,size_t compressedSize,Bytef* uncompressed,size_t uncompressedSize) // Decompresses a complete raw deflate stream into a buffer of the exact uncompressed size; returns Z_OK or a zlib error code
+	{
+	/* Create and initialize a zlib decompression object: */
+	z_stream stream;
+	memset(&stream,0,sizeof(z_stream));
+	int result=inflateInit2(&stream,-MAX_WBITS);
+	if(result!=Z_OK)
+		return result;
+	
+	/* Decompress the entire stream in one go: */
+	stream.next_in=const_cast<Bytef*>(compressed);
+	stream.avail_in=uInt(compressedSize);
+	stream.next_out=uncompressed;
+	stream.avail_out=uInt(uncompressedSize);
+	result=inflate(&stream,Z_FINISH);
+	if(result==Z_STREAM_END)
+		result=stream.total_out==uncompressedSize?Z_OK:Z_DATA_ERROR;
+	else if(result==Z_OK)
+		result=Z_BUF_ERROR;
+	
+	/* Clean up the decompressor: */
+	int inflateEndResult=inflateEnd(&stream);
+	if(result==Z_OK)
+		result=inflateEndResult;
+	
+	return result;
+	}
+
 /**************
 Helper classes:
 **************/
@@ -71,6 +121,7 @@ class ZipArchiveStreamingFile:public File
 	/* Constructors and destructors: */
 	public:
 	ZipArchiveStreamingFile(SeekableFilePtr sArchive,unsigned int sCompressionMethod,Offset sNextReadPos,size_t sCompressedSize);
+	ZipArchiveStreamingFile(SeekableFilePtr sArchive,const Bytef* sCompressedData,size_t sCompressedSize); // Decompresses data directly from a memory-mapped archive
 	virtual ~ZipArchiveStreamingFile(void);
 	};
 
@@ -92,8 +143,8 @@ size_t ZipArchiveStreamingFile::readData(File::Byte* buffer,size_t bufferSize)
 		/* Repeat until some output is produced: */
 		do
 			{
-			/* Check if the decompressor needs more input: */
-			if(stream->avail_in==0)
+			/* Check if the decompressor needs more input and the compressed data is not memory-mapped: */
+			if(stream->avail_in==0&&compressedBuffer!=0)
 				{
 				/* Read the next chunk of compressed data from the archive: */
 				size_t compressedReadSize=compressedBufferSize;
@@ -191,12 +242,102 @@ ZipArchiveStreamingFile::ZipArchiveStreamingFile(SeekableFilePtr sArchive,unsign
 		}
 	}
 
+ZipArchiveStreamingFile::ZipArchiveStreamingFile(SeekableFilePtr sArchive,const Bytef* sCompressedData,size_t sCompressedSize)
+	:File(ReadOnly),
+	 archive(sArchive),
+	 nextReadPos(0),compressedSize(0),
+	 compressedBufferSize(0),compressedBuffer(0),
+	 stream(0),eof(false)
+	{
+	/* Create and initialize the zlib decompression object to read all compressed data directly from the memory-mapped archive: */
+	stream=new z_stream;
+	memset(stream,0,sizeof(z_stream));
+	stream->next_in=const_cast<Bytef*>(sCompressedData);
+	stream->avail_in=uInt(sCompressedSize);
+	int inflateInitResult=inflateInit2(stream,-MAX_WBITS);
+	if(inflateInitResult!=Z_OK)
+		{
+		delete stream;
+		throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Cannot initialize decompressor due to zlib error %d",inflateInitResult));
+		}
+	}
+
 ZipArchiveStreamingFile::~ZipArchiveStreamingFile(void)
 	{
 	delete[] compressedBuffer;
 	delete stream;
 	}
 
+/*****************************************************************************
+Class to access uncompressed files inside memory-mapped ZIP archives in place:
+*****************************************************************************/
+
+class ZipArchiveMappedFile:public FixedMemoryFile
+	{
+	/* Elements: */
+	private:
+	SeekableFilePtr archive; // Reference to the memory-mapped ZIP archive, to keep it mapped while the file exists
+	
+	/* Constructors and destructors: */
+	public:
+	ZipArchiveMappedFile(SeekableFilePtr sArchive,const void* sData,size_t sDataSize)
+		:FixedMemoryFile(sData,sDataSize),
+		 archive(sArchive)
+		{
+		}
+	};
+
+/********************************************************************
+Classes to decompress batches of files from ZIP archives in parallel:
+********************************************************************/
+
+struct ZipArchiveBatchEntry // Structure describing a file to be decompressed as part of a batch
+	{
+	/* Elements: */
+	public:
+	bool compressed; // Flag whether the file needs to be decompressed
+	SeekableFile::Offset dataPos; // Position of the file's compressed data in a non-mapped archive
+	const Bytef* compressedData; // Pointer to the file's compressed data
+	size_t compressedSize; // Size of the file's compressed data
+	Bytef* uncompressedData; // Pointer to the memory block receiving the file's uncompressed data
+	size_t uncompressedSize; // Size of the file's uncompressed data
+	int inflateResult; // Result code of decompressing the file
+	
+	/* Constructors and destructors: */
+	ZipArchiveBatchEntry(void)
+		:compressed(false),dataPos(0),
+		 compressedData(0),compressedSize(0),
+		 uncompressedData(0),uncompressedSize(0),
+		 inflateResult(Z_OK)
+		{
+		}
+	};
+
+class ZipArchiveBatchInflater // Functor class to decompress a range of batch entries
+	{
+	/* Elements: */
+	private:
+	std::vector<ZipArchiveBatchEntry>& entries; // The batch entries
+	
+	/* Constructors and destructors: */
+	public:
+	ZipArchiveBatchInflater(std::vector<ZipArchiveBatchEntry>& sEntries)
+		:entries(sEntries)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rangeBegin,size_t rangeEnd)
+		{
+		for(size_t i=rangeBegin;i<rangeEnd;++i)
+			{
+			ZipArchiveBatchEntry& e=entries[i];
+			if(e.compressed)
+				e.inflateResult=inflateFileData(e.compressedData,e.compressedSize,e.uncompressedData,e.uncompressedSize);
+			}
+		}
+	};
+
 }
 
 /**************************************************************************************
@@ -942,10 +1083,65 @@ int ZipArchive::initArchive(void)
 	return 0;
 	}
 
-ZipArchive::ZipArchive(const char* archiveFileName)
-	:archive(new StandardFile(archiveFileName,File::ReadOnly)),
+const unsigned char* ZipArchive::getMappedFileData(const ZipArchive::FileID& fileId,unsigned int& compressionMethod) const
+	{
+	/* Check that the file's header is inside the archive and has the correct signature: */
+	if(fileId.filePos>Offset(mappedArchiveSize)||mappedArchiveSize-size_t(fileId.filePos)<30)
+		throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Truncated file header"));
+	const unsigned char* header=mappedArchive+size_t(fileId.filePos);
+	if(getUInt32(header)!=0x04034b50U)
+		throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Invalid file header signature"));
+	
+	/* Read and check the compression method and skip the file name and extra field: */
+	compressionMethod=getUInt16(header+8);
+	checkCompressionMethod(compressionMethod,__PRETTY_FUNCTION__);
+	size_t dataOffset=size_t(fileId.filePos)+30+getUInt16(header+26)+getUInt16(header+28);
+	
+	/* Check that the file's data is inside the archive: */
+	if(dataOffset>mappedArchiveSize||mappedArchiveSize-dataOffset<fileId.compressedSize)
+		throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Truncated file data"));
+	
+	return mappedArchive+dataOffset;
+	}
+
+unsigned int ZipArchive::readFileHeader(const ZipArchive::FileID& fileId)
+	{
+	/* Read the file's header: */
+	archive->setReadPosAbs(fileId.filePos);
+	if(archive->read<Misc::UInt32>()!=0x04034b50U)
+		throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Invalid file header signature"));
+	
+	/* Read file header information: */
+	archive->skip<Misc::UInt16>(2);
+	unsigned int compressionMethod=archive->read<Misc::UInt16>();
+	checkCompressionMethod(compressionMethod,__PRETTY_FUNCTION__);
+	archive->skip<Misc::UInt16>(2);
+	archive->skip<Misc::UInt32>(3);
+	unsigned short fileNameLength=archive->read<Misc::UInt16>();
+	unsigned short extraFieldLength=archive->read<Misc::UInt16>();
+	
+	/* Skip file name and extra field: */
+	archive->skip<char>(fileNameLength);
+	archive->skip<char>(extraFieldLength);
+	
+	return compressionMethod;
+	}
+
+ZipArchive::ZipArchive(const char* archiveFileName,bool mapArchive)
+	:mappedArchive(0),mappedArchiveSize(0),
 	 root(0)
 	{
+	if(mapArchive)
+		{
+		/* Map the archive file into memory: */
+		MemMappedFile* mappedFile=new MemMappedFile(archiveFileName,File::ReadOnly);
+		archive=mappedFile;
+		mappedArchive=static_cast<const unsigned char*>(mappedFile->getMemory());
+		mappedArchiveSize=size_t(mappedFile->getSize());
+		}
+	else
+		archive=new StandardFile(archiveFileName,File::ReadOnly);
+	
 	/* Initialize the archive and handle errors: */
 	switch(initArchive())
 		{
@@ -962,6 +1158,7 @@ ZipArchive::ZipArchive(const char* archiveFileName)
 
 ZipArchive::ZipArchive(SeekableFilePtr sArchive)
 	:archive(sArchive),
+	 mappedArchive(0),mappedArchiveSize(0),
 	 root(0)
 	{
 	/* Initialize the archive and handle errors: */
@@ -1003,6 +1200,19 @@ ZipArchive::FileID ZipArchive::findFile(const char* fileName) const
 
 FilePtr ZipArchive::openFile(const ZipArchive::FileID& fileId)
 	{
+	if(mappedArchive!=0)
+		{
+		/* Locate the file's data inside the memory-mapped archive: */
+		unsigned int compressionMethod;
+		const unsigned char* data=getMappedFileData(fileId,compressionMethod);
+		
+		/* Return uncompressed data in place, or decompress directly from the memory-mapped archive: */
+		if(compressionMethod==0)
+			return new ZipArchiveMappedFile(archive,data,fileId.compressedSize);
+		else
+			return new ZipArchiveStreamingFile(archive,data,fileId.compressedSize);
+		}
+	
 	/* Read the file's header: */
 	archive->setReadPosAbs(fileId.filePos);
 	if(archive->read<Misc::UInt32>()!=0x04034b50U)
@@ -1011,6 +1221,7 @@ FilePtr ZipArchive::openFile(const ZipArchive::FileID& fileId)
 	/* Read file header information: */
 	archive->skip<Misc::UInt16>(2);
 	unsigned short compressionMethod=archive->read<Misc::UInt16>();
+	checkCompressionMethod(compressionMethod,__PRETTY_FUNCTION__);
 	archive->skip<Misc::UInt16>(2);
 	archive->skip<Misc::UInt32>(1);
 	unsigned int compressedSize=archive->read<Misc::UInt32>();
@@ -1028,6 +1239,28 @@ FilePtr ZipArchive::openFile(const ZipArchive::FileID& fileId)
 
 SeekableFilePtr ZipArchive::openSeekableFile(const ZipArchive::FileID& fileId)
 	{
+	if(mappedArchive!=0)
+		{
+		/* Locate the file's data inside the memory-mapped archive: */
+		unsigned int compressionMethod;
+		const unsigned char* data=getMappedFileData(fileId,compressionMethod);
+		
+		/* Return uncompressed data in place: */
+		if(compressionMethod==0)
+			return new ZipArchiveMappedFile(archive,data,fileId.compressedSize);
+		
+		/* Decompress the data directly from the memory-mapped archive: */
+		FixedMemoryFile* result=new FixedMemoryFile(fileId.uncompressedSize);
+		int inflateResult=inflateFileData(data,fileId.compressedSize,static_cast<Bytef*>(result->getMemory()),fileId.uncompressedSize);
+		if(inflateResult!=Z_OK)
+			{
+			delete result;
+			throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Cannot decompress due to zlib error %d",inflateResult));
+			}
+		
+		return result;
+		}
+	
 	/* Read the file's header: */
 	archive->setReadPosAbs(fileId.filePos);
 	if(archive->read<Misc::UInt32>()!=0x04034b50U)
@@ -1036,6 +1269,7 @@ SeekableFilePtr ZipArchive::openSeekableFile(const ZipArchive::FileID& fileId)
 	/* Read file header information: */
 	archive->skip<Misc::UInt16>(2);
 	unsigned short compressionMethod=archive->read<Misc::UInt16>();
+	checkCompressionMethod(compressionMethod,__PRETTY_FUNCTION__);
 	archive->skip<Misc::UInt16>(2);
 	archive->skip<Misc::UInt32>(1);
 	unsigned int compressedSize=archive->read<Misc::UInt32>();
@@ -1095,6 +1329,88 @@ SeekableFilePtr ZipArchive::openSeekableFile(const ZipArchive::FileID& fileId)
 	return result;
 	}
 
+void ZipArchive::openSeekableFiles(const std::vector<ZipArchive::FileID>& fileIds,std::vector<SeekableFilePtr>& files)
+	{
+	size_t numFiles=fileIds.size();
+	files.clear();
+	files.resize(numFiles);
+	
+	/* Read all files' headers sequentially, create the result files, and locate the compressed data: */
+	std::vector<ZipArchiveBatchEntry> entries(numFiles);
+	size_t totalCompressedSize=0;
+	for(size_t i=0;i<numFiles;++i)
+		{
+		const FileID& fileId=fileIds[i];
+		ZipArchiveBatchEntry& e=entries[i];
+		unsigned int compressionMethod;
+		if(mappedArchive!=0)
+			{
+			/* Locate the file's data inside the memory-mapped archive: */
+			e.compressedData=getMappedFileData(fileId,compressionMethod);
+			
+			/* Return uncompressed data in place: */
+			if(compressionMethod==0)
+				{
+				files[i]=new ZipArchiveMappedFile(archive,e.compressedData,fileId.compressedSize);
+				continue;
+				}
+			}
+		else
+			{
+			/* Read the file's header: */
+			compressionMethod=readFileHeader(fileId);
+			
+			/* Directly read uncompressed data: */
+			if(compressionMethod==0)
+				{
+				FixedMemoryFile* file=new FixedMemoryFile(fileId.compressedSize);
+				files[i]=file;
+				archive->read(static_cast<unsigned char*>(file->getMemory()),fileId.compressedSize);
+				continue;
+				}
+			
+			/* Remember the position of the compressed data: */
+			e.dataPos=archive->getReadPos();
+			totalCompressedSize+=fileId.compressedSize;
+			}
+		
+		/* Create the result file and prepare the file for decompression: */
+		FixedMemoryFile* file=new FixedMemoryFile(fileId.uncompressedSize);
+		files[i]=file;
+		e.compressed=true;
+		e.compressedSize=fileId.compressedSize;
+		e.uncompressedData=static_cast<Bytef*>(file->getMemory());
+		e.uncompressedSize=fileId.uncompressedSize;
+		}
+	
+	/* Read the compressed data of all files from a non-mapped archive into a shared buffer: */
+	std::vector<Bytef> compressedBuffer(totalCompressedSize);
+	if(mappedArchive==0)
+		{
+		Bytef* cbPtr=compressedBuffer.data();
+		for(std::vector<ZipArchiveBatchEntry>::iterator eIt=entries.begin();eIt!=entries.end();++eIt)
+			if(eIt->compressed)
+				{
+				archive->setReadPosAbs(eIt->dataPos);
+				archive->read(cbPtr,eIt->compressedSize);
+				eIt->compressedData=cbPtr;
+				cbPtr+=eIt->compressedSize;
+				}
+		}
+	
+	/* Decompress all compressed files in parallel: */
+	ZipArchiveBatchInflater inflater(entries);
+	Threads::WorkerPool::parallelFor(0,numFiles,0,inflater);
+	
+	/* Check for decompression errors: */
+	for(size_t i=0;i<numFiles;++i)
+		if(entries[i].inflateResult!=Z_OK)
+			{
+			files.clear();
+			throw File::OpenError(Misc::makeStdErrMsg(__PRETTY_FUNCTION__,"Cannot decompress file %u due to zlib error %d",(unsigned int)(i),entries[i].inflateResult));
+			}
+	}
+
 DirectoryPtr ZipArchive::openRootDirectory(void)
 	{
 	/* Return a new directory object: */
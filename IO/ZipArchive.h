@@ -2,7 +2,7 @@
 ZipArchive - Class to represent ZIP archive files, with functionality to
 traverse contained directory hierarchies and extract files using a File
 interface.
-Copyright (c) 2011-2022 Oliver Kreylos
+Copyright (c) 2011-2026 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -195,21 +195,30 @@ class ZipArchive:public Threads::RefCounted
 	/* Elements: */
 	private:
 	SeekableFilePtr archive; // File object to access the ZIP archive
+	const unsigned char* mappedArchive; // Pointer to the ZIP archive's contents if the archive is memory-mapped; null otherwise
+	size_t mappedArchiveSize; // Size of the memory-mapped ZIP archive
 	Directory root; // The ZIP archive's root directory
 	
 	/* Private methods: */
 	int initArchive(void); // Initializes the ZIP archive file structures; returns error code
+	const unsigned char* getMappedFileData(const FileID& fileId,unsigned int& compressionMethod) const; // Returns a pointer to the given file's data inside the memory-mapped archive and the file's compression method; throws exception if the file's header is invalid or the file's compression method is unsupported
+	unsigned int readFileHeader(const FileID& fileId); // Reads the given file's header from the archive file, leaving the archive file positioned at the file's data; returns the file's compression method; throws exception if the compression method is unsupported
 	
 	/* Constructors and destructors: */
 	public:
-	ZipArchive(const char* archiveFileName); // Opens a ZIP archive of the given file name using a standard file abstraction
+	ZipArchive(const char* archiveFileName,bool mapArchive =false); // Opens a ZIP archive of the given file name using a standard file abstraction, or by mapping it into memory if the flag is true
 	ZipArchive(SeekableFilePtr sArchive); // Reads a ZIP archive from an already-opened file
 	~ZipArchive(void); // Closes the ZIP archive
 	
 	/* Methods: */
+	bool isMapped(void) const // Returns true if the ZIP archive is memory-mapped; files in memory-mapped archives can be opened from multiple threads concurrently
+		{
+		return mappedArchive!=0;
+		}
 	FileID findFile(const char* fileName) const; // Returns a file identifier for a file of the given name; throws exception if file does not exist
 	FilePtr openFile(const FileID& fileId); // Returns a file for streaming reading
-	SeekableFilePtr openSeekableFile(const FileID& fileId); // Returns a file for seekable reading
+	SeekableFilePtr openSeekableFile(const FileID& fileId); // Returns a file for seekable reading; uncompressed files in memory-mapped archives are returned as views into the archive without copying
+	void openSeekableFiles(const std::vector<FileID>& fileIds,std::vector<SeekableFilePtr>& files); // Opens all given files for seekable reading and stores them in the given array in the same order, decompressing them in parallel using the worker pool
 	DirectoryPtr openRootDirectory(void); // Returns a directory object representing the root directory
 	DirectoryPtr openDirectory(const char* directoryName); // Returns a directory object representing the given directory name
 	};
@@ -2,7 +2,7 @@
 BaseImage - Generic base class to represent images of arbitrary pixel
 formats. The image coordinate system is such that pixel (0,0) is in the
 lower-left corner.
-Copyright (c) 2016-2024 Oliver Kreylos
+Copyright (c) 2016-2026 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -25,9 +25,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <stddef.h>
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <Misc/SizedTypes.h>
 #include <Misc/StdError.h>
 #include <IO/File.h>
+#include <Threads/WorkerPool.h>
 #include <Math/Math.h>
 #include <GL/Extensions/GLEXTFramebufferObject.h>
 #include <GL/Extensions/GLEXTTextureSRGB.h>
@@ -360,6 +364,89 @@ inline GLushort convertColorScalar<GLushort,GLdouble>(GLdouble value)
 Helper classes and functions for basic image operations:
 *******************************************************/
 
+const size_t minParallelPixels=size_t(1)<<18; // Minimum number of pixels in an image to process its rows in parallel
+
+template <class RowKernelParam>
+inline
+void
+processRows(
+	RowKernelParam& kernel,
+	unsigned int numRows,
+	unsigned int rowWidth)
+	{
+	/* Process large images in strips of rows from the worker pool, and small images from the calling thread: */
+	if(size_t(numRows)*size_t(rowWidth)>=minParallelPixels)
+		Threads::WorkerPool::parallelFor(0,numRows,0,kernel);
+	else
+		kernel(0,numRows);
+	}
+
+template <class SourceScalarParam,class DestScalarParam,class ParameterParam>
+class PixelKernel // Row kernel class applying a pixel conversion function to strips of image rows
+	{
+	/* Embedded classes: */
+	public:
+	typedef void (*PixelFunction)(const SourceScalarParam* sPtr,DestScalarParam* dPtr,size_t numPixels,unsigned int numChannels,ParameterParam parameter); // Type for functions converting a contiguous range of pixels with the given number of source channels
+	
+	/* Elements: */
+	private:
+	PixelFunction function; // The pixel conversion function
+	ParameterParam parameter; // Additional parameter for the pixel conversion function
+	const SourceScalarParam* source; // Pointer to the source image's pixels
+	unsigned int sourceChannels; // Number of channels in the source image
+	DestScalarParam* dest; // Pointer to the destination image's pixels
+	unsigned int destChannels; // Number of channels in the destination image
+	size_t width; // Number of pixels per image row
+	
+	/* Constructors and destructors: */
+	public:
+	PixelKernel(PixelFunction sFunction,ParameterParam sParameter,const BaseImage& sSource,DestScalarParam* sDest,unsigned int sDestChannels)
+		:function(sFunction),parameter(sParameter),
+		 source(static_cast<const SourceScalarParam*>(sSource.getPixels())),sourceChannels(sSource.getNumChannels()),
+		 dest(sDest),destChannels(sDestChannels),
+		 width(sSource.getWidth())
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd)
+		{
+		/* Convert the given range of rows as one contiguous range of pixels: */
+		size_t pixelBegin=rowBegin*width;
+		function(source+pixelBegin*sourceChannels,dest+pixelBegin*destChannels,(rowEnd-rowBegin)*width,sourceChannels,parameter);
+		}
+	};
+
+template <class SourceScalarParam,class DestScalarParam,class ParameterParam>
+inline
+void
+convertPixels(
+	typename PixelKernel<SourceScalarParam,DestScalarParam,ParameterParam>::PixelFunction function,
+	ParameterParam parameter,
+	const BaseImage& source,
+	DestScalarParam* dest,
+	unsigned int destChannels)
+	{
+	/* Apply the pixel conversion function to all image rows: */
+	PixelKernel<SourceScalarParam,DestScalarParam,ParameterParam> kernel(function,parameter,source,dest,destChannels);
+	processRows(kernel,source.getHeight(),source.getWidth());
+	}
+
+template <class SourceScalarParam>
+inline
+void
+toUInt8Pixels(
+	const SourceScalarParam* sPtr,
+	GLubyte* dPtr,
+	size_t numPixels,
+	unsigned int numChannels,
+	int)
+	{
+	/* Convert all samples: */
+	for(size_t i=numPixels*numChannels;i>0;--i,++dPtr,++sPtr)
+		*dPtr=convertColorScalar<GLubyte,SourceScalarParam>(*sPtr);
+	}
+
 template <class SourceScalarParam>
 inline
 void
@@ -368,28 +455,83 @@ toUInt8Typed(
 	BaseImage& dest)
 	{
 	/* Convert all samples from the source image to the destination image: */
-	GLubyte* dPtr=static_cast<GLubyte*>(dest.replacePixels());
-	const SourceScalarParam* sPtr=static_cast<const SourceScalarParam*>(source.getPixels());
-	size_t numSamples=size_t(source.getHeight())*size_t(source.getWidth())*size_t(source.getNumChannels());
-	for(size_t i=numSamples;i>0;--i,++dPtr,++sPtr)
-		*dPtr=convertColorScalar<GLubyte,SourceScalarParam>(*sPtr);
+	convertPixels<SourceScalarParam,GLubyte,int>(toUInt8Pixels<SourceScalarParam>,0,source,static_cast<GLubyte*>(dest.replacePixels()),dest.getNumChannels());
 	}
 
-template <class ScalarParam>
+#ifdef __SSE2__
+
+void toUInt8PixelsUInt16(const GLushort* sPtr,GLubyte* dPtr,size_t numPixels,unsigned int numChannels,int)
+	{
+	/* Convert blocks of 16 samples by keeping their high bytes: */
+	size_t numSamples=numPixels*numChannels;
+	for(;numSamples>=16;numSamples-=16,sPtr+=16,dPtr+=16)
+		{
+		__m128i lo=_mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr)),8);
+		__m128i hi=_mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr+8)),8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),_mm_packus_epi16(lo,hi));
+		}
+	
+	/* Convert the remaining samples: */
+	toUInt8Pixels<GLushort>(sPtr,dPtr,numSamples,1,0);
+	}
+
+void toUInt8PixelsFloat32(const GLfloat* sPtr,GLubyte* dPtr,size_t numPixels,unsigned int numChannels,int)
+	{
+	/* Convert blocks of 16 samples by scaling, clamping to [0, 255], and truncating, which yields the same results as convertColorScalar: */
+	const __m128 scale=_mm_set1_ps(256.0f);
+	const __m128 min=_mm_setzero_ps();
+	const __m128 max=_mm_set1_ps(255.0f);
+	size_t numSamples=numPixels*numChannels;
+	for(;numSamples>=16;numSamples-=16,sPtr+=16,dPtr+=16)
+		{
+		__m128i s[4];
+		for(int i=0;i<4;++i)
+			s[i]=_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(sPtr+i*4),scale),min),max));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),_mm_packus_epi16(_mm_packs_epi32(s[0],s[1]),_mm_packs_epi32(s[2],s[3])));
+		}
+	
+	/* Convert the remaining samples: */
+	toUInt8Pixels<GLfloat>(sPtr,dPtr,numSamples,1,0);
+	}
+
+template <>
 inline
 void
-dropAlphaTyped(
+toUInt8Typed<GLushort>(
 	const BaseImage& source,
 	BaseImage& dest)
 	{
+	convertPixels<GLushort,GLubyte,int>(toUInt8PixelsUInt16,0,source,static_cast<GLubyte*>(dest.replacePixels()),dest.getNumChannels());
+	}
+
+template <>
+inline
+void
+toUInt8Typed<GLfloat>(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	convertPixels<GLfloat,GLubyte,int>(toUInt8PixelsFloat32,0,source,static_cast<GLubyte*>(dest.replacePixels()),dest.getNumChannels());
+	}
+
+#endif
+
+template <class ScalarParam>
+inline
+void
+dropAlphaPixels(
+	const ScalarParam* sPtr,
+	ScalarParam* dPtr,
+	size_t numPixels,
+	unsigned int numChannels,
+	int)
+	{
 	/* Drop the alpha value of all pixels: */
-	unsigned int numChannels=dest.getNumChannels();
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i)
+	unsigned int numColorChannels=numChannels-1;
+	for(size_t i=numPixels;i>0;--i)
 		{
 		/* Copy the non-alpha channels: */
-		for(size_t j=0;j<numChannels;++j)
+		for(unsigned int j=0;j<numColorChannels;++j)
 			*(dPtr++)=*(sPtr++);
 		
 		/* Skip the source's alpha channel: */
@@ -397,6 +539,51 @@ dropAlphaTyped(
 		}
 	}
 
+template <class ScalarParam>
+inline
+void
+dropAlphaTyped(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	/* Drop the alpha value of all pixels: */
+	convertPixels<ScalarParam,ScalarParam,int>(dropAlphaPixels<ScalarParam>,0,source,static_cast<ScalarParam*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#ifdef __SSE2__
+
+void dropAlphaPixelsUInt8(const GLubyte* sPtr,GLubyte* dPtr,size_t numPixels,unsigned int numChannels,int)
+	{
+	if(numChannels==4)
+		{
+		/* Convert blocks of four RGBA pixels by packing the color channels of pairs of pixels into 64-bit lanes and storing the lanes with overlap; stop early enough not to write past the end of the destination range: */
+		const __m128i lowMask=_mm_set_epi32(0x0,0x00ffffff,0x0,0x00ffffff);
+		const __m128i highMask=_mm_set_epi32(0x00ffffff,0x0,0x00ffffff,0x0);
+		for(;numPixels>=5;numPixels-=4,sPtr+=16,dPtr+=12)
+			{
+			__m128i s=_mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr));
+			__m128i d=_mm_or_si128(_mm_and_si128(s,lowMask),_mm_srli_epi64(_mm_and_si128(s,highMask),8));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dPtr),d);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dPtr+6),_mm_unpackhi_epi64(d,d));
+			}
+		}
+	
+	/* Convert the remaining pixels: */
+	dropAlphaPixels<GLubyte>(sPtr,dPtr,numPixels,numChannels,0);
+	}
+
+template <>
+inline
+void
+dropAlphaTyped<GLubyte>(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	convertPixels<GLubyte,GLubyte,int>(dropAlphaPixelsUInt8,0,source,static_cast<GLubyte*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#endif
+
 void dropAlphaImpl(const BaseImage& source,BaseImage& dest)
 	{
 	/* Delegate to a typed version of this function: */
@@ -442,19 +629,18 @@ void dropAlphaImpl(const BaseImage& source,BaseImage& dest)
 template <class ScalarParam>
 inline
 void
-addAlphaTyped(
-	const BaseImage& source,
-	BaseImage& dest,
+addAlphaPixels(
+	const ScalarParam* sPtr,
+	ScalarParam* dPtr,
+	size_t numPixels,
+	unsigned int numChannels,
 	ScalarParam alpha)
 	{
 	/* Add the constant alpha value to all pixels: */
-	unsigned int numChannels=source.getNumChannels();
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i)
+	for(size_t i=numPixels;i>0;--i)
 		{
 		/* Copy the non-alpha channels: */
-		for(size_t j=0;j<numChannels;++j)
+		for(unsigned int j=0;j<numChannels;++j)
 			*(dPtr++)=*(sPtr++);
 		
 		/* Add an alpha value to the destination: */
@@ -462,6 +648,53 @@ addAlphaTyped(
 		}
 	}
 
+template <class ScalarParam>
+inline
+void
+addAlphaTyped(
+	const BaseImage& source,
+	BaseImage& dest,
+	ScalarParam alpha)
+	{
+	/* Add the constant alpha value to all pixels: */
+	convertPixels<ScalarParam,ScalarParam,ScalarParam>(addAlphaPixels<ScalarParam>,alpha,source,static_cast<ScalarParam*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#ifdef __SSE2__
+
+void addAlphaPixelsUInt8(const GLubyte* sPtr,GLubyte* dPtr,size_t numPixels,unsigned int numChannels,GLubyte alpha)
+	{
+	if(numChannels==3)
+		{
+		/* Convert blocks of four RGB pixels by loading pairs of pixels into 64-bit lanes and spreading them out; stop early enough not to read past the end of the source range: */
+		const __m128i lowMask=_mm_set_epi32(0x0,0x00ffffff,0x0,0x00ffffff);
+		const __m128i highMask=_mm_set_epi32(0x00ffffff,0x0,0x00ffffff,0x0);
+		const __m128i alphas=_mm_set1_epi32(int(GLuint(alpha)<<24));
+		for(;numPixels>=5;numPixels-=4,sPtr+=12,dPtr+=16)
+			{
+			__m128i s=_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sPtr)),_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sPtr+6)));
+			__m128i d=_mm_or_si128(_mm_or_si128(_mm_and_si128(s,lowMask),_mm_and_si128(_mm_slli_epi64(s,8),highMask)),alphas);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),d);
+			}
+		}
+	
+	/* Convert the remaining pixels: */
+	addAlphaPixels<GLubyte>(sPtr,dPtr,numPixels,numChannels,alpha);
+	}
+
+template <>
+inline
+void
+addAlphaTyped<GLubyte>(
+	const BaseImage& source,
+	BaseImage& dest,
+	GLubyte alpha)
+	{
+	convertPixels<GLubyte,GLubyte,GLubyte>(addAlphaPixelsUInt8,alpha,source,static_cast<GLubyte*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#endif
+
 void addAlphaImpl(const BaseImage& source,BaseImage& dest,double alpha)
 	{
 	/* Delegate to a typed version of this function: */
@@ -507,17 +740,18 @@ void addAlphaImpl(const BaseImage& source,BaseImage& dest,double alpha)
 template <class ScalarParam,class WeightParam>
 inline
 void
-toGreyTypedInt(
-	const BaseImage& source,
-	BaseImage& dest)
+toGreyPixelsInt(
+	const ScalarParam* sPtr,
+	ScalarParam* dPtr,
+	size_t numPixels,
+	unsigned int numChannels,
+	int)
 	{
 	/* Convert all pixels to luminance and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==4)
+	if(numChannels==4)
 		{
 		/* Convert RGBA to LUMINANCE_ALPHA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=4)
+		for(size_t i=numPixels;i>0;--i,sPtr+=4)
 			{
 			/* Calculate pixel luminance: */
 			*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
@@ -529,7 +763,7 @@ toGreyTypedInt(
 	else
 		{
 		/* Convert RGB to LUMINANCE: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=3)
+		for(size_t i=numPixels;i>0;--i,sPtr+=3)
 			{
 			/* Calculate pixel luminance: */
 			*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
@@ -537,20 +771,82 @@ toGreyTypedInt(
 		}
 	}
 
-template <class ScalarParam>
+template <class ScalarParam,class WeightParam>
 inline
 void
-toGreyTypedFloat(
+toGreyTypedInt(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	/* Convert all pixels to luminance and retain an existing alpha channel: */
+	convertPixels<ScalarParam,ScalarParam,int>(toGreyPixelsInt<ScalarParam,WeightParam>,0,source,static_cast<ScalarParam*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#ifdef __SSE2__
+
+void toGreyPixelsUInt8(const GLubyte* sPtr,GLubyte* dPtr,size_t numPixels,unsigned int numChannels,int)
+	{
+	if(numChannels==4)
+		{
+		/* Convert blocks of eight RGBA pixels using the same integer weights as the generic version: */
+		const __m128i zero=_mm_setzero_si128();
+		const __m128i weights=_mm_set_epi16(0,29,150,77,0,29,150,77);
+		for(;numPixels>=8;numPixels-=8,sPtr+=32,dPtr+=16)
+			{
+			__m128i s0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr));
+			__m128i s1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr+16));
+			
+			/* Calculate the weighted sums of red and green, and of blue, of each pixel: */
+			__m128i m0=_mm_madd_epi16(_mm_unpacklo_epi8(s0,zero),weights);
+			__m128i m1=_mm_madd_epi16(_mm_unpackhi_epi8(s0,zero),weights);
+			__m128i m2=_mm_madd_epi16(_mm_unpacklo_epi8(s1,zero),weights);
+			__m128i m3=_mm_madd_epi16(_mm_unpackhi_epi8(s1,zero),weights);
+			
+			/* Add the partial sums and gather the luminances of the eight pixels: */
+			m0=_mm_add_epi32(m0,_mm_srli_epi64(m0,32));
+			m1=_mm_add_epi32(m1,_mm_srli_epi64(m1,32));
+			m2=_mm_add_epi32(m2,_mm_srli_epi64(m2,32));
+			m3=_mm_add_epi32(m3,_mm_srli_epi64(m3,32));
+			__m128i l0=_mm_srli_epi32(_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(m0),_mm_castsi128_ps(m1),_MM_SHUFFLE(2,0,2,0))),8);
+			__m128i l1=_mm_srli_epi32(_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(m2),_mm_castsi128_ps(m3),_MM_SHUFFLE(2,0,2,0))),8);
+			
+			/* Gather the alpha values of the eight pixels and interleave them with the luminances: */
+			__m128i a=_mm_packs_epi32(_mm_srli_epi32(s0,24),_mm_srli_epi32(s1,24));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),_mm_or_si128(_mm_packs_epi32(l0,l1),_mm_slli_epi16(a,8)));
+			}
+		}
+	
+	/* Convert the remaining pixels: */
+	toGreyPixelsInt<GLubyte,GLushort>(sPtr,dPtr,numPixels,numChannels,0);
+	}
+
+template <>
+inline
+void
+toGreyTypedInt<GLubyte,GLushort>(
 	const BaseImage& source,
 	BaseImage& dest)
 	{
+	convertPixels<GLubyte,GLubyte,int>(toGreyPixelsUInt8,0,source,static_cast<GLubyte*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#endif
+
+template <class ScalarParam>
+inline
+void
+toGreyPixelsFloat(
+	const ScalarParam* sPtr,
+	ScalarParam* dPtr,
+	size_t numPixels,
+	unsigned int numChannels,
+	int)
+	{
 	/* Convert all pixels to luminance and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==4)
+	if(numChannels==4)
 		{
 		/* Convert RGBA to LUMINANCE_ALPHA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=4)
+		for(size_t i=numPixels;i>0;--i,sPtr+=4)
 			{
 			/* Calculate pixel luminance: */
 			*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
@@ -562,7 +858,7 @@ toGreyTypedFloat(
 	else
 		{
 		/* Convert RGB to LUMINANCE: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=3)
+		for(size_t i=numPixels;i>0;--i,sPtr+=3)
 			{
 			/* Calculate pixel luminance: */
 			*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
@@ -570,6 +866,17 @@ toGreyTypedFloat(
 		}
 	}
 
+template <class ScalarParam>
+inline
+void
+toGreyTypedFloat(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	/* Convert all pixels to luminance and retain an existing alpha channel: */
+	convertPixels<ScalarParam,ScalarParam,int>(toGreyPixelsFloat<ScalarParam>,0,source,static_cast<ScalarParam*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
 void toGreyImpl(const BaseImage& source,BaseImage& dest)
 	{
 	/* Delegate to a typed version of this function: */
@@ -615,17 +922,18 @@ void toGreyImpl(const BaseImage& source,BaseImage& dest)
 template <class ScalarParam>
 inline
 void
-toRgbTyped(
-	const BaseImage& source,
-	BaseImage& dest)
+toRgbPixels(
+	const ScalarParam* sPtr,
+	ScalarParam* dPtr,
+	size_t numPixels,
+	unsigned int numChannels,
+	int)
 	{
 	/* Convert all pixels to RGB and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==2)
+	if(numChannels==2)
 		{
 		/* Convert LUMINANCE_ALPHA to RGBA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=2)
+		for(size_t i=numPixels;i>0;--i,sPtr+=2)
 			{
 			/* Copy pixel luminance: */
 			*(dPtr++)=sPtr[0];
@@ -639,7 +947,7 @@ toRgbTyped(
 	else
 		{
 		/* Convert LUMINANCE to RGB: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,++sPtr)
+		for(size_t i=numPixels;i>0;--i,++sPtr)
 			{
 			/* Copy pixel luminance: */
 			*(dPtr++)=sPtr[0];
@@ -649,6 +957,54 @@ toRgbTyped(
 		}
 	}
 
+template <class ScalarParam>
+inline
+void
+toRgbTyped(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	/* Convert all pixels to RGB and retain an existing alpha channel: */
+	convertPixels<ScalarParam,ScalarParam,int>(toRgbPixels<ScalarParam>,0,source,static_cast<ScalarParam*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#ifdef __SSE2__
+
+void toRgbPixelsUInt8(const GLubyte* sPtr,GLubyte* dPtr,size_t numPixels,unsigned int numChannels,int)
+	{
+	if(numChannels==2)
+		{
+		/* Convert blocks of eight LUMINANCE_ALPHA pixels by duplicating each byte and shifting a third copy of the luminance into the blue channel: */
+		const __m128i keepMask=_mm_set1_epi32(int(0xff00ffffU));
+		const __m128i blueMask=_mm_set1_epi32(0x00ff0000);
+		for(;numPixels>=8;numPixels-=8,sPtr+=16,dPtr+=32)
+			{
+			__m128i s=_mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr));
+			__m128i lo=_mm_unpacklo_epi8(s,s);
+			__m128i hi=_mm_unpackhi_epi8(s,s);
+			lo=_mm_or_si128(_mm_and_si128(lo,keepMask),_mm_and_si128(_mm_slli_epi32(lo,16),blueMask));
+			hi=_mm_or_si128(_mm_and_si128(hi,keepMask),_mm_and_si128(_mm_slli_epi32(hi,16),blueMask));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr+16),hi);
+			}
+		}
+	
+	/* Convert the remaining pixels: */
+	toRgbPixels<GLubyte>(sPtr,dPtr,numPixels,numChannels,0);
+	}
+
+template <>
+inline
+void
+toRgbTyped<GLubyte>(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	convertPixels<GLubyte,GLubyte,int>(toRgbPixelsUInt8,0,source,static_cast<GLubyte*>(dest.modifyPixels()),dest.getNumChannels());
+	}
+
+#endif
+
 void toRgbImpl(const BaseImage& source,BaseImage& dest)
 	{
 	/* Delegate to a typed version of this function: */
@@ -691,6 +1047,80 @@ void toRgbImpl(const BaseImage& source,BaseImage& dest)
 		}
 	}
 
+template <class ScalarParam>
+class ShrinkKernel // Row kernel class averaging blocks of 2x2 source pixels for strips of destination image rows
+	{
+	/* Embedded classes: */
+	public:
+	typedef void (*RowFunction)(const ScalarParam* s0Ptr,const ScalarParam* s1Ptr,ScalarParam* dPtr,size_t width,unsigned int numChannels); // Type for functions shrinking a pair of source image rows into a destination image row of the given width
+	
+	/* Elements: */
+	private:
+	RowFunction function; // The row shrinking function
+	const ScalarParam* source; // Pointer to the source image's pixels
+	ScalarParam* dest; // Pointer to the destination image's pixels
+	size_t width; // Number of pixels per destination image row
+	unsigned int numChannels; // Number of channels in both images
+	
+	/* Constructors and destructors: */
+	public:
+	ShrinkKernel(RowFunction sFunction,const BaseImage& sSource,BaseImage& sDest)
+		:function(sFunction),
+		 source(static_cast<const ScalarParam*>(sSource.getPixels())),
+		 dest(static_cast<ScalarParam*>(sDest.modifyPixels())),
+		 width(sDest.getWidth()),numChannels(sDest.getNumChannels())
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd)
+		{
+		/* Shrink the given range of destination rows: */
+		size_t destStride=width*numChannels;
+		size_t sourceStride=destStride*2;
+		const ScalarParam* sRowPtr=source+rowBegin*sourceStride*2;
+		ScalarParam* dRowPtr=dest+rowBegin*destStride;
+		for(size_t y=rowBegin;y<rowEnd;++y,sRowPtr+=sourceStride*2,dRowPtr+=destStride)
+			function(sRowPtr,sRowPtr+sourceStride,dRowPtr,width,numChannels);
+		}
+	};
+
+template <class ScalarParam>
+inline
+void
+shrinkImage(
+	typename ShrinkKernel<ScalarParam>::RowFunction function,
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	/* Apply the row shrinking function to all destination image rows: */
+	ShrinkKernel<ScalarParam> kernel(function,source,dest);
+	processRows(kernel,dest.getHeight(),dest.getWidth());
+	}
+
+template <class ScalarParam,class AccumParam>
+inline
+void
+shrinkRowInt(
+	const ScalarParam* s0Ptr,
+	const ScalarParam* s1Ptr,
+	ScalarParam* dPtr,
+	size_t width,
+	unsigned int nc)
+	{
+	/* Average all blocks of 2x2 pixels in the source rows: */
+	for(size_t x=width;x>0;--x,s0Ptr+=nc,s1Ptr+=nc)
+		{
+		for(unsigned int i=0;i<nc;++i,++s0Ptr,++s1Ptr,++dPtr)
+			{
+			/* Average the current 2x2 pixel block: */
+			AccumParam sum0=AccumParam(s0Ptr[0])+AccumParam(s0Ptr[nc]);
+			AccumParam sum1=AccumParam(s1Ptr[0])+AccumParam(s1Ptr[nc]);
+			*dPtr=ScalarParam((sum0+sum1+2)>>2);
+			}
+		}
+	}
+
 template <class ScalarParam,class AccumParam>
 inline
 void
@@ -699,24 +1129,26 @@ shrinkTypedInt(
 	BaseImage& dest)
 	{
 	/* Average all blocks of 2x2 pixels in the source image: */
-	unsigned int nc=source.getNumChannels();
-	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
-	const ptrdiff_t sStride=source.getSize(0)*nc;
-	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(unsigned int y=0;y<source.getSize(1);y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+	shrinkImage<ScalarParam>(shrinkRowInt<ScalarParam,AccumParam>,source,dest);
+	}
+
+template <class ScalarParam>
+inline
+void
+shrinkRowFloat(
+	const ScalarParam* s0Ptr,
+	const ScalarParam* s1Ptr,
+	ScalarParam* dPtr,
+	size_t width,
+	unsigned int nc)
+	{
+	/* Average all blocks of 2x2 pixels in the source rows: */
+	for(size_t x=width;x>0;--x,s0Ptr+=nc,s1Ptr+=nc)
 		{
-		const ScalarParam* s0Ptr=sRow0Ptr;
-		const ScalarParam* s1Ptr=sRow1Ptr;
-		for(unsigned int x=0;x<source.getSize(0);x+=2,s0Ptr+=nc,s1Ptr+=nc)
+		for(unsigned int i=0;i<nc;++i,++s0Ptr,++s1Ptr,++dPtr)
 			{
-			for(unsigned int i=0;i<source.getNumChannels();++i,++s0Ptr,++s1Ptr,++dPtr)
-				{
-				/* Average the current 2x2 pixel block: */
-				AccumParam sum0=AccumParam(s0Ptr[0])+AccumParam(s0Ptr[nc]);
-				AccumParam sum1=AccumParam(s1Ptr[0])+AccumParam(s1Ptr[nc]);
-				*dPtr=ScalarParam((sum0+sum1+2)>>2);
-				}
+			/* Average the current 2x2 pixel block: */
+			*dPtr=(s0Ptr[0]+s0Ptr[nc]+s1Ptr[0]+s1Ptr[nc])*ScalarParam(0.25);
 			}
 		}
 	}
@@ -729,26 +1161,256 @@ shrinkTypedFloat(
 	BaseImage& dest)
 	{
 	/* Average all blocks of 2x2 pixels in the source image: */
-	unsigned int nc=source.getNumChannels();
-	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
-	const ptrdiff_t sStride=source.getSize(0)*nc;
-	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(unsigned int y=0;y<source.getSize(1);y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+	shrinkImage<ScalarParam>(shrinkRowFloat<ScalarParam>,source,dest);
+	}
+
+#ifdef __SSE2__
+
+template <unsigned int numChannelsParam>
+__m128i addPixelPairs16(__m128i lo,__m128i hi); // Adds horizontally adjacent pixels of the given number of channels in two vectors of 16-bit samples and returns the sums in one vector of 16-bit samples
+
+template <>
+inline
+__m128i
+addPixelPairs16<1>(
+	__m128i lo,
+	__m128i hi)
+	{
+	const __m128i lowMask=_mm_set1_epi32(0x0000ffff);
+	__m128i sumLo=_mm_add_epi32(_mm_and_si128(lo,lowMask),_mm_srli_epi32(lo,16));
+	__m128i sumHi=_mm_add_epi32(_mm_and_si128(hi,lowMask),_mm_srli_epi32(hi,16));
+	return _mm_packs_epi32(sumLo,sumHi);
+	}
+
+template <>
+inline
+__m128i
+addPixelPairs16<2>(
+	__m128i lo,
+	__m128i hi)
+	{
+	__m128 l=_mm_castsi128_ps(lo);
+	__m128 h=_mm_castsi128_ps(hi);
+	return _mm_add_epi16(_mm_castps_si128(_mm_shuffle_ps(l,h,_MM_SHUFFLE(2,0,2,0))),_mm_castps_si128(_mm_shuffle_ps(l,h,_MM_SHUFFLE(3,1,3,1))));
+	}
+
+template <>
+inline
+__m128i
+addPixelPairs16<4>(
+	__m128i lo,
+	__m128i hi)
+	{
+	return _mm_add_epi16(_mm_unpacklo_epi64(lo,hi),_mm_unpackhi_epi64(lo,hi));
+	}
+
+template <unsigned int numChannelsParam>
+void splitPixelPairs32(__m128 lo,__m128 hi,__m128& even,__m128& odd); // Separates even and odd pixels of the given number of channels in two vectors of 32-bit samples
+
+template <>
+inline
+void
+splitPixelPairs32<1>(
+	__m128 lo,
+	__m128 hi,
+	__m128& even,
+	__m128& odd)
+	{
+	even=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(2,0,2,0));
+	odd=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(3,1,3,1));
+	}
+
+template <>
+inline
+void
+splitPixelPairs32<2>(
+	__m128 lo,
+	__m128 hi,
+	__m128& even,
+	__m128& odd)
+	{
+	even=_mm_movelh_ps(lo,hi);
+	odd=_mm_movehl_ps(hi,lo);
+	}
+
+template <>
+inline
+void
+splitPixelPairs32<4>(
+	__m128 lo,
+	__m128 hi,
+	__m128& even,
+	__m128& odd)
+	{
+	even=lo;
+	odd=hi;
+	}
+
+template <unsigned int numChannelsParam>
+inline
+size_t
+shrinkRowUInt8Vector(
+	const GLubyte* s0Ptr,
+	const GLubyte* s1Ptr,
+	GLubyte* dPtr,
+	size_t width)
+	{
+	/* Average blocks of 2x2 pixels producing eight destination samples at a time; returns the number of processed destination pixels: */
+	const __m128i zero=_mm_setzero_si128();
+	const __m128i two=_mm_set1_epi16(2);
+	size_t numBlocks=(width*numChannelsParam)/8;
+	for(size_t i=numBlocks;i>0;--i,s0Ptr+=16,s1Ptr+=16,dPtr+=8)
 		{
-		const ScalarParam* s0Ptr=sRow0Ptr;
-		const ScalarParam* s1Ptr=sRow1Ptr;
-		for(unsigned int x=0;x<source.getSize(0);x+=2,s0Ptr+=nc,s1Ptr+=nc)
-			{
-			for(unsigned int i=0;i<source.getNumChannels();++i,++s0Ptr,++s1Ptr,++dPtr)
-				{
-				/* Average the current 2x2 pixel block: */
-				*dPtr=(s0Ptr[0]+s0Ptr[nc]+s1Ptr[0]+s1Ptr[nc])*ScalarParam(0.25);
-				}
-			}
+		/* Add vertically adjacent samples in 16-bit precision: */
+		__m128i s0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0Ptr));
+		__m128i s1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1Ptr));
+		__m128i lo=_mm_add_epi16(_mm_unpacklo_epi8(s0,zero),_mm_unpacklo_epi8(s1,zero));
+		__m128i hi=_mm_add_epi16(_mm_unpackhi_epi8(s0,zero),_mm_unpackhi_epi8(s1,zero));
+		
+		/* Add horizontally adjacent pixels and round the sums: */
+		__m128i sum=_mm_srli_epi16(_mm_add_epi16(addPixelPairs16<numChannelsParam>(lo,hi),two),2);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dPtr),_mm_packus_epi16(sum,sum));
+		}
+	
+	return (numBlocks*8)/numChannelsParam;
+	}
+
+void shrinkRowUInt8(const GLubyte* s0Ptr,const GLubyte* s1Ptr,GLubyte* dPtr,size_t width,unsigned int nc)
+	{
+	/* Process the bulk of the row with a vectorized function for the number of channels: */
+	size_t x=0;
+	if(nc==1)
+		x=shrinkRowUInt8Vector<1>(s0Ptr,s1Ptr,dPtr,width);
+	else if(nc==2)
+		x=shrinkRowUInt8Vector<2>(s0Ptr,s1Ptr,dPtr,width);
+	else if(nc==4)
+		x=shrinkRowUInt8Vector<4>(s0Ptr,s1Ptr,dPtr,width);
+	
+	/* Process the remaining pixels: */
+	shrinkRowInt<GLubyte,GLushort>(s0Ptr+x*2*nc,s1Ptr+x*2*nc,dPtr+x*nc,width-x,nc);
+	}
+
+template <unsigned int numChannelsParam>
+inline
+size_t
+shrinkRowUInt16Vector(
+	const GLushort* s0Ptr,
+	const GLushort* s1Ptr,
+	GLushort* dPtr,
+	size_t width)
+	{
+	/* Average blocks of 2x2 pixels producing four destination samples at a time; returns the number of processed destination pixels: */
+	const __m128i zero=_mm_setzero_si128();
+	const __m128i two=_mm_set1_epi32(2);
+	const __m128i bias32=_mm_set1_epi32(0x8000);
+	const __m128i bias16=_mm_set1_epi16(-0x8000);
+	size_t numBlocks=(width*numChannelsParam)/4;
+	for(size_t i=numBlocks;i>0;--i,s0Ptr+=8,s1Ptr+=8,dPtr+=4)
+		{
+		/* Add vertically adjacent samples in 32-bit precision: */
+		__m128i s0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0Ptr));
+		__m128i s1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1Ptr));
+		__m128i lo=_mm_add_epi32(_mm_unpacklo_epi16(s0,zero),_mm_unpacklo_epi16(s1,zero));
+		__m128i hi=_mm_add_epi32(_mm_unpackhi_epi16(s0,zero),_mm_unpackhi_epi16(s1,zero));
+		
+		/* Add horizontally adjacent pixels and round the sums: */
+		__m128 even,odd;
+		splitPixelPairs32<numChannelsParam>(_mm_castsi128_ps(lo),_mm_castsi128_ps(hi),even,odd);
+		__m128i sum=_mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_castps_si128(even),_mm_castps_si128(odd)),two),2);
+		
+		/* Pack the unsigned 32-bit results into 16 bits by biasing them around the signed saturation range: */
+		sum=_mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(sum,bias32),zero),bias16);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dPtr),sum);
 		}
+	
+	return (numBlocks*4)/numChannelsParam;
 	}
 
+void shrinkRowUInt16(const GLushort* s0Ptr,const GLushort* s1Ptr,GLushort* dPtr,size_t width,unsigned int nc)
+	{
+	/* Process the bulk of the row with a vectorized function for the number of channels: */
+	size_t x=0;
+	if(nc==1)
+		x=shrinkRowUInt16Vector<1>(s0Ptr,s1Ptr,dPtr,width);
+	else if(nc==2)
+		x=shrinkRowUInt16Vector<2>(s0Ptr,s1Ptr,dPtr,width);
+	else if(nc==4)
+		x=shrinkRowUInt16Vector<4>(s0Ptr,s1Ptr,dPtr,width);
+	
+	/* Process the remaining pixels: */
+	shrinkRowInt<GLushort,GLuint>(s0Ptr+x*2*nc,s1Ptr+x*2*nc,dPtr+x*nc,width-x,nc);
+	}
+
+template <unsigned int numChannelsParam>
+inline
+size_t
+shrinkRowFloat32Vector(
+	const GLfloat* s0Ptr,
+	const GLfloat* s1Ptr,
+	GLfloat* dPtr,
+	size_t width)
+	{
+	/* Average blocks of 2x2 pixels producing four destination samples at a time, adding samples in the same order as the generic version; returns the number of processed destination pixels: */
+	const __m128 quarter=_mm_set1_ps(0.25f);
+	size_t numBlocks=(width*numChannelsParam)/4;
+	for(size_t i=numBlocks;i>0;--i,s0Ptr+=8,s1Ptr+=8,dPtr+=4)
+		{
+		__m128 even0,odd0,even1,odd1;
+		splitPixelPairs32<numChannelsParam>(_mm_loadu_ps(s0Ptr),_mm_loadu_ps(s0Ptr+4),even0,odd0);
+		splitPixelPairs32<numChannelsParam>(_mm_loadu_ps(s1Ptr),_mm_loadu_ps(s1Ptr+4),even1,odd1);
+		_mm_storeu_ps(dPtr,_mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(even0,odd0),even1),odd1),quarter));
+		}
+	
+	return (numBlocks*4)/numChannelsParam;
+	}
+
+void shrinkRowFloat32(const GLfloat* s0Ptr,const GLfloat* s1Ptr,GLfloat* dPtr,size_t width,unsigned int nc)
+	{
+	/* Process the bulk of the row with a vectorized function for the number of channels: */
+	size_t x=0;
+	if(nc==1)
+		x=shrinkRowFloat32Vector<1>(s0Ptr,s1Ptr,dPtr,width);
+	else if(nc==2)
+		x=shrinkRowFloat32Vector<2>(s0Ptr,s1Ptr,dPtr,width);
+	else if(nc==4)
+		x=shrinkRowFloat32Vector<4>(s0Ptr,s1Ptr,dPtr,width);
+	
+	/* Process the remaining pixels: */
+	shrinkRowFloat<GLfloat>(s0Ptr+x*2*nc,s1Ptr+x*2*nc,dPtr+x*nc,width-x,nc);
+	}
+
+template <>
+inline
+void
+shrinkTypedInt<GLubyte,GLushort>(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	shrinkImage<GLubyte>(shrinkRowUInt8,source,dest);
+	}
+
+template <>
+inline
+void
+shrinkTypedInt<GLushort,GLuint>(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	shrinkImage<GLushort>(shrinkRowUInt16,source,dest);
+	}
+
+template <>
+inline
+void
+shrinkTypedFloat<GLfloat>(
+	const BaseImage& source,
+	BaseImage& dest)
+	{
+	shrinkImage<GLfloat>(shrinkRowFloat32,source,dest);
+	}
+
+#endif
+
 }
 
 /**********************************
@@ -2,7 +2,7 @@
 TextureManager - Class to simplify texture management by encapsulating
 loading textures from files, decoding image file formats, and uploading
 decoded images to OpenGL texture objects for rendering.
-Copyright (c) 2021 Oliver Kreylos
+Copyright (c) 2021-2026 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -23,11 +23,225 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Images/TextureManager.h>
 
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/MessageLogger.h>
 #include <IO/OpenFile.h>
+#include <IO/MemMappedFile.h>
+#include <Images/ReadImageFile.h>
  
 namespace Images {
 
+namespace {
+
+/********************************************************
+Helper classes and functions for the decoded image cache:
+********************************************************/
+
+const char cacheMagic[8]={'V','r','u','i','T','e','x','C'}; // Magic identifier for decoded image cache files
+const Misc::UInt32 cacheVersion=0x01020304U; // Cache file format version; also identifies the byte order used to write the file
+const size_t cacheAlignment=16; // Alignment of mipmap level pixel data inside cache files
+
+struct CacheHeader // Header structure of decoded image cache files; the header is followed by the pixel data of all mipmap levels, each aligned to cacheAlignment bytes
+	{
+	/* Elements: */
+	public:
+	char magic[8]; // Magic identifier
+	Misc::UInt32 version; // File format version
+	Misc::UInt32 numLevels; // Number of mipmap levels
+	Misc::UInt64 key; // Content key of the encoded image file
+	Misc::UInt64 encodedSize; // Size of the encoded image file
+	Misc::UInt32 size[2]; // Width and height of the base mipmap level
+	Misc::UInt32 numChannels; // Number of channels per pixel
+	Misc::UInt32 channelSize; // Size of each pixel channel in bytes
+	Misc::UInt32 format; // OpenGL pixel format
+	Misc::UInt32 scalarType; // OpenGL scalar type
+	};
+
+class ContentHasher // Sink class to calculate a 64-bit hash of an encoded image file's contents eight bytes at a time, independent of how the contents are split into blocks
+	{
+	/* Elements: */
+	private:
+	Misc::UInt64 hash; // The current hash value
+	Misc::UInt64 word; // Partial word of data not yet added to the hash value
+	unsigned int wordSize; // Number of bytes in the partial word
+	Misc::UInt64 dataSize; // Total amount of data added to the hash value
+	
+	/* Private methods: */
+	void addWord(Misc::UInt64 newWord) // Adds a full word of data to the hash value
+		{
+		hash=(hash^newWord)*0x9e3779b97f4a7c15ULL;
+		hash^=hash>>29;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	ContentHasher(void)
+		:hash(0xcbf29ce484222325ULL),word(0),wordSize(0),dataSize(0)
+		{
+		}
+	
+	/* Methods: */
+	void writeRaw(const void* data,size_t size) // Adds the given data block to the hash value
+		{
+		const unsigned char* dPtr=static_cast<const unsigned char*>(data);
+		const unsigned char* dEnd=dPtr+size;
+		dataSize+=size;
+		
+		/* Complete a partial word left over from the previous data block: */
+		for(;wordSize!=0&&wordSize<8&&dPtr!=dEnd;++dPtr,++wordSize)
+			word|=Misc::UInt64(*dPtr)<<(wordSize*8);
+		if(wordSize==8)
+			{
+			addWord(word);
+			word=0;
+			wordSize=0;
+			}
+		
+		/* Add all full words: */
+		for(;dEnd-dPtr>=8;dPtr+=8)
+			{
+			Misc::UInt64 newWord;
+			memcpy(&newWord,dPtr,8);
+			addWord(newWord);
+			}
+		
+		/* Start a new partial word with the remaining data: */
+		for(;dPtr!=dEnd;++dPtr,++wordSize)
+			word|=Misc::UInt64(*dPtr)<<(wordSize*8);
+		}
+	Misc::UInt64 getHash(void) // Returns the final hash value
+		{
+		/* Add the last partial word and the total data size: */
+		if(wordSize!=0)
+			addWord(word);
+		addWord(dataSize);
+		return hash;
+		}
+	};
+
+inline size_t alignCacheOffset(size_t offset) // Returns the given offset rounded up to the cache alignment
+	{
+	return (offset+cacheAlignment-1)&~(cacheAlignment-1);
+	}
+
+inline size_t getLevelSize(const CacheHeader& header,unsigned int level) // Returns the size of the pixel data of the given mipmap level
+	{
+	return size_t(header.size[0]>>level)*size_t(header.size[1]>>level)*size_t(header.numChannels)*size_t(header.channelSize);
+	}
+
+bool readCacheFile(const std::string& cacheFileName,Misc::UInt64 key,size_t encodedSize,std::vector<BaseImage>& levels) // Reads all mipmap levels of a decoded image from the given cache file; returns false if the cache file does not exist or does not match
+	{
+	/* Map the cache file into memory: */
+	Misc::Autopointer<IO::MemMappedFile> cacheFile;
+	try
+		{
+		cacheFile=new IO::MemMappedFile(cacheFileName.c_str());
+		}
+	catch(const std::runtime_error&)
+		{
+		return false;
+		}
+	const char* cacheData=static_cast<const char*>(cacheFile->getMemory());
+	size_t cacheSize=size_t(cacheFile->getSize());
+	
+	/* Check the cache file's header: */
+	if(cacheSize<sizeof(CacheHeader))
+		return false;
+	CacheHeader header;
+	memcpy(&header,cacheData,sizeof(CacheHeader));
+	if(memcmp(header.magic,cacheMagic,sizeof(cacheMagic))!=0||header.version!=cacheVersion||header.key!=key||header.encodedSize!=Misc::UInt64(encodedSize))
+		return false;
+	if(header.numLevels==0||header.numLevels>32||(header.size[0]>>(header.numLevels-1))==0||(header.size[1]>>(header.numLevels-1))==0)
+		return false;
+	
+	/* Check the cache file's size: */
+	size_t offset=sizeof(CacheHeader);
+	for(unsigned int level=0;level<header.numLevels;++level)
+		offset=alignCacheOffset(offset)+getLevelSize(header,level);
+	if(offset!=cacheSize)
+		return false;
+	
+	/* Copy all mipmap levels' pixel data out of the cache file: */
+	levels.clear();
+	levels.reserve(header.numLevels);
+	offset=sizeof(CacheHeader);
+	for(unsigned int level=0;level<header.numLevels;++level)
+		{
+		offset=alignCacheOffset(offset);
+		BaseImage image(Size(header.size[0]>>level,header.size[1]>>level),header.numChannels,header.channelSize,GLenum(header.format),GLenum(header.scalarType));
+		size_t levelSize=getLevelSize(header,level);
+		memcpy(image.replacePixels(),cacheData+offset,levelSize);
+		levels.push_back(image);
+		offset+=levelSize;
+		}
+	
+	return true;
+	}
+
+bool writeFully(int fd,const void* data,size_t size) // Writes the given data block to the given file descriptor; returns false on error
+	{
+	const char* dPtr=static_cast<const char*>(data);
+	while(size>0)
+		{
+		ssize_t written=write(fd,dPtr,size);
+		if(written<0&&errno!=EINTR)
+			return false;
+		if(written>0)
+			{
+			dPtr+=written;
+			size-=size_t(written);
+			}
+		}
+	return true;
+	}
+
+void writeCacheFile(const std::string& cacheFileName,Misc::UInt64 key,size_t encodedSize,const std::vector<BaseImage>& levels) // Writes all mipmap levels of a decoded image to the given cache file; silently gives up on errors
+	{
+	/* Create the cache file's header: */
+	CacheHeader header;
+	memset(&header,0,sizeof(CacheHeader));
+	memcpy(header.magic,cacheMagic,sizeof(cacheMagic));
+	header.version=cacheVersion;
+	header.numLevels=Misc::UInt32(levels.size());
+	header.key=key;
+	header.encodedSize=Misc::UInt64(encodedSize);
+	for(int i=0;i<2;++i)
+		header.size[i]=Misc::UInt32(levels[0].getSize(i));
+	header.numChannels=Misc::UInt32(levels[0].getNumChannels());
+	header.channelSize=Misc::UInt32(levels[0].getChannelSize());
+	header.format=Misc::UInt32(levels[0].getFormat());
+	header.scalarType=Misc::UInt32(levels[0].getScalarType());
+	
+	/* Write the cache into a uniquely-named temporary file and then replace any previous cache file atomically: */
+	std::string tempFileName=cacheFileName;
+	tempFileName.append(".XXXXXX");
+	int fd=mkstemp(&tempFileName[0]);
+	if(fd<0)
+		return;
+	bool ok=writeFully(fd,&header,sizeof(CacheHeader));
+	size_t offset=sizeof(CacheHeader);
+	static const char padding[cacheAlignment]={0};
+	for(std::vector<BaseImage>::const_iterator lIt=levels.begin();ok&&lIt!=levels.end();++lIt)
+		{
+		size_t alignedOffset=alignCacheOffset(offset);
+		ok=writeFully(fd,padding,alignedOffset-offset);
+		size_t levelSize=size_t(lIt->getRowStride())*size_t(lIt->getHeight());
+		ok=ok&&writeFully(fd,lIt->getPixels(),levelSize);
+		offset=alignedOffset+levelSize;
+		}
+	ok=close(fd)==0&&ok;
+	if(!ok||rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+		unlink(tempFileName.c_str());
+	}
+
+}
+
 /****************************************
 Methods of class TextureManager::Texture:
 ****************************************/
@@ -62,6 +276,55 @@ void TextureManager::Texture::setFilterModes(GLenum minFilter,GLenum magFilter)
 Methods of class TextureManager:
 *******************************/
 
+void TextureManager::queueLoadRequest(const TextureManager::LoadRequest& request)
+	{
+	/* Insert the request behind all pending requests of the same or higher priority: */
+	std::deque<LoadRequest>::iterator insertIt=loadRequests.end();
+	while(insertIt!=loadRequests.begin()&&(insertIt-1)->priority<request.priority)
+		--insertIt;
+	loadRequests.insert(insertIt,request);
+	}
+
+void TextureManager::decodeImage(const IO::VariableMemoryFile& imageFile,ImageFileFormat imageFileFormat,std::vector<BaseImage>& levels) const
+	{
+	/* Calculate the image's content key from the encoded image data and all settings affecting decoding: */
+	ContentHasher hasher;
+	imageFile.writeToSink(hasher);
+	Misc::UInt32 settings[2];
+	settings[0]=Misc::UInt32(imageFileFormat);
+	settings[1]=BaseImage::getUseGammaCorrection()?1U:0U;
+	hasher.writeRaw(settings,sizeof(settings));
+	Misc::UInt64 key=hasher.getHash();
+	size_t encodedSize=imageFile.getDataSize();
+	
+	/* Check if the decoded image is already in the cache: */
+	std::string cacheFileName;
+	if(!cacheDirectory.empty())
+		{
+		char keyName[32];
+		snprintf(keyName,sizeof(keyName),"/%016llx.texc",(unsigned long long)(key));
+		cacheFileName=cacheDirectory;
+		cacheFileName.append(keyName);
+		if(readCacheFile(cacheFileName,key,encodedSize,levels))
+			return;
+		}
+	
+	/* Decode the image: */
+	levels.clear();
+	levels.push_back(readGenericImageFile(*imageFile.getReader(),imageFileFormat));
+	
+	/* Pre-generate mipmap levels by successively downsampling the image until its size is no longer even: */
+	while(levels.back().getWidth()%2==0&&levels.back().getHeight()%2==0)
+		{
+		BaseImage level=levels.back().shrink();
+		levels.push_back(level);
+		}
+	
+	/* Store the decoded image in the cache: */
+	if(!cacheFileName.empty())
+		writeCacheFile(cacheFileName,key,encodedSize,levels);
+	}
+
 void* TextureManager::loaderThreadMethod(void)
 	{
 	/* Process image data loading requests until shut down: */
@@ -85,6 +348,7 @@ void* TextureManager::loaderThreadMethod(void)
 		}
 		
 		IO::VariableMemoryFilePtr imageFile;
+		std::vector<BaseImage> levels;
 		try
 			{
 			/* Open the image file if a file name was requested: */
@@ -94,20 +358,29 @@ void* TextureManager::loaderThreadMethod(void)
 			/* Load the image file into memory: */
 			imageFile=new IO::VariableMemoryFile;
 			imageFile->readFile(*file);
+			
+			if(decodeImages)
+				{
+				/* Decode the image file and release the encoded image data: */
+				decodeImage(*imageFile,texture->imageFileFormat,levels);
+				imageFile=0;
+				}
 			}
 		catch(const std::runtime_error& err)
 			{
 			/* Print an error message or something: */
 			Misc::formattedUserError("Images::TextureManager: Caught exception %s while loading image data",err.what());
 			
-			/* Destroy the in-memory image file: */
+			/* Destroy the in-memory image file and any decoded image data: */
 			imageFile=0;
+			levels.clear();
 			}
 		
 		/* Update the texture state structure: */
 		{
 		Threads::MutexCond::Lock textureMapLock(textureMapCond);
 		texture->imageFile=imageFile;
+		texture->levels.swap(levels);
 		++numFilesLoaded;
 		textureMapCond.broadcast();
 		}
@@ -116,12 +389,22 @@ void* TextureManager::loaderThreadMethod(void)
 	return 0;
 	}
 
-TextureManager::TextureManager(unsigned int sNumLoaderThreads)
+TextureManager::TextureManager(unsigned int sNumLoaderThreads,const char* sCacheDirectory)
 	:lastHandle(0),textureMap(17),numFilesLoaded(0),
+	 decodeImages(sCacheDirectory!=0),
 	 numLoaderThreads(sNumLoaderThreads),loaderThreads(new Threads::Thread[numLoaderThreads]),
 	 runLoaderThreads(false),
 	 numLoadRequests(0)
 	{
+	/* Create the decoded image cache directory if it does not already exist; disable caching, but not decoding, on failure: */
+	if(sCacheDirectory!=0&&sCacheDirectory[0]!='\0')
+		{
+		if(mkdir(sCacheDirectory,0700)==0||errno==EEXIST)
+			cacheDirectory=sCacheDirectory;
+		else
+			Misc::formattedUserWarning("Images::TextureManager: Unable to create image cache directory %s due to error %s",sCacheDirectory,strerror(errno));
+		}
+	
 	/* Start the image data loader threads: */
 	runLoaderThreads=true;
 	for(unsigned int i=0;i<numLoaderThreads;++i)
@@ -146,7 +429,7 @@ TextureManager::~TextureManager(void)
 	delete[] loaderThreads;
 	}
 
-TextureManager::Handle TextureManager::loadTexture(const char* fileName,GLenum target,GLenum internalFormat,bool locked)
+TextureManager::Handle TextureManager::loadTexture(const char* fileName,GLenum target,GLenum internalFormat,bool locked,int priority)
 	{
 	/* Determine the given image file's image file format: */
 	ImageFileFormat format=getImageFileFormat(fileName);
@@ -173,14 +456,14 @@ TextureManager::Handle TextureManager::loadTexture(const char* fileName,GLenum t
 	{
 	Threads::MutexCond::Lock loadRequestLock(loadRequestCond);
 	++numLoadRequests;
-	loadRequests.push_back(LoadRequest(texture,fileName));
+	queueLoadRequest(LoadRequest(texture,fileName,priority));
 	loadRequestCond.signal();
 	}
 	
 	return lastHandle;
 	}
 
-TextureManager::Handle TextureManager::loadTexture(IO::File& file,ImageFileFormat format,GLenum target,GLenum internalFormat,bool locked)
+TextureManager::Handle TextureManager::loadTexture(IO::File& file,ImageFileFormat format,GLenum target,GLenum internalFormat,bool locked,int priority)
 	{
 	/* Create a new texture structure and store it in the map: */
 	Texture* texture=0;
@@ -204,13 +487,35 @@ TextureManager::Handle TextureManager::loadTexture(IO::File& file,ImageFileForma
 	{
 	Threads::MutexCond::Lock loadRequestLock(loadRequestCond);
 	++numLoadRequests;
-	loadRequests.push_back(LoadRequest(texture,file));
+	queueLoadRequest(LoadRequest(texture,file,priority));
 	loadRequestCond.signal();
 	}
 	
 	return lastHandle;
 	}
 
+bool TextureManager::setPriority(TextureManager::Handle handle,int newPriority)
+	{
+	/* Find the texture's state structure: */
+	Texture* texture=getTexture(handle,false);
+	
+	/* Find the texture's pending load request: */
+	Threads::MutexCond::Lock loadRequestLock(loadRequestCond);
+	for(std::deque<LoadRequest>::iterator lrIt=loadRequests.begin();lrIt!=loadRequests.end();++lrIt)
+		if(lrIt->texture==texture)
+			{
+			/* Re-insert the load request according to its new priority: */
+			LoadRequest request=*lrIt;
+			request.priority=newPriority;
+			loadRequests.erase(lrIt);
+			queueLoadRequest(request);
+			
+			return true;
+			}
+	
+	return false;
+	}
+
 void TextureManager::waitForImageData(void)
 	{
 	/* Block until the number of loaded files matches the number of load requests: */
@@ -2,7 +2,7 @@
 TextureManager - Class to simplify texture management by encapsulating
 loading textures from files, decoding image file formats, and uploading
 decoded images to OpenGL texture objects for rendering.
-Copyright (c) 2021 Oliver Kreylos
+Copyright (c) 2021-2026 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -25,6 +25,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define IMAGES_TEXTUREMANAGER_INCLUDED
 
 #include <deque>
+#include <string>
+#include <vector>
 #include <Misc/StandardHashFunction.h>
 #include <Misc/HashTable.h>
 #include <Threads/MutexCond.h>
@@ -32,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/File.h>
 #include <IO/VariableMemoryFile.h>
 #include <GL/gl.h>
+#include <Images/BaseImage.h>
 #include <Images/ImageFileFormats.h>
 
 namespace Images {
@@ -48,7 +51,8 @@ class TextureManager
 		
 		/* Elements: */
 		private:
-		IO::VariableMemoryFilePtr imageFile; // Pointer to an in-memory file containing the texture's image data
+		IO::VariableMemoryFilePtr imageFile; // Pointer to an in-memory file containing the texture's image data; released once the image has been decoded
+		std::vector<BaseImage> levels; // Decoded texture image followed by its pre-generated mipmap levels if the texture manager decodes images
 		ImageFileFormat imageFileFormat; // Format of the image data contained in the image file
 		GLenum target; // Texture target to which the texture image will be bound
 		GLenum internalFormat; // Internal texture format for the texture image
@@ -63,6 +67,18 @@ class TextureManager
 		/* Methods: */
 		void setWrapModes(GLenum wrapS,GLenum wrapT); // Sets the texture's coordinate wrapping modes
 		void setFilterModes(GLenum minFilter,GLenum magFilter); // Sets the texture's minification and magnification filtering modes
+		const IO::VariableMemoryFilePtr& getImageFile(void) const // Returns the in-memory file containing the texture's encoded image data, or null if the image was decoded or could not be loaded
+			{
+			return imageFile;
+			}
+		unsigned int getNumLevels(void) const // Returns the number of decoded mipmap levels, or zero if the image was not decoded
+			{
+			return (unsigned int)(levels.size());
+			}
+		const BaseImage& getLevel(unsigned int level) const // Returns the decoded image of the given mipmap level
+			{
+			return levels[level];
+			}
 		};
 	
 	private:
@@ -75,14 +91,15 @@ class TextureManager
 		Texture* texture; // Pointer to the texture state structure to be updated
 		IO::FilePtr file; // Pointer to the file from which to load image data
 		std::string fileName; // Name of the file from which to load image data if file pointer is invalid
+		int priority; // Priority of the request; requests of higher priority are processed first
 		
 		/* Constructors and destructors: */
-		LoadRequest(Texture* sTexture,IO::File& sFile) // Creates a load request for the given texture state and already-open image file
-			:texture(sTexture),file(&sFile)
+		LoadRequest(Texture* sTexture,IO::File& sFile,int sPriority) // Creates a load request for the given texture state and already-open image file
+			:texture(sTexture),file(&sFile),priority(sPriority)
 			{
 			}
-		LoadRequest(Texture* sTexture,const char* sFileName) // Creates a load request for the given texture state and an image file of the given name
-			:texture(sTexture),fileName(sFileName)
+		LoadRequest(Texture* sTexture,const char* sFileName,int sPriority) // Creates a load request for the given texture state and an image file of the given name
+			:texture(sTexture),fileName(sFileName),priority(sPriority)
 			{
 			}
 		};
@@ -92,19 +109,23 @@ class TextureManager
 	Threads::MutexCond textureMapCond; // Mutex protecting the CPU-side texture state map and condition variable to signal completion of an image data load request
 	TextureMap textureMap; // Hash table mapping texture handles to CPU-side texture states
 	size_t numFilesLoaded; // Total number of image data files that have been loaded; can be read without locking
+	bool decodeImages; // Flag whether the loader threads decode image data and pre-generate mipmap levels
+	std::string cacheDirectory; // Directory holding decoded and mipmapped images keyed by the contents of their image files; empty if caching is disabled
 	unsigned int numLoaderThreads; // Number of threads to load encoded image data from image files
 	Threads::Thread* loaderThreads; // Array of encoded image data loader threads
 	volatile bool runLoaderThreads; // Flag to keep the image data loader threads running
 	Threads::MutexCond loadRequestCond; // Condition variable to signal a new image data loading request
 	size_t numLoadRequests; // Total number of image data load requests that have been issued; can be read without locking
-	std::deque<LoadRequest> loadRequests; // List of pending image data loading requests
+	std::deque<LoadRequest> loadRequests; // List of pending image data loading requests, in descending order of priority
 	
 	/* Private methods: */
+	void queueLoadRequest(const LoadRequest& request); // Inserts the given request behind all pending requests of the same or higher priority; caller must hold lock on load request list
+	void decodeImage(const IO::VariableMemoryFile& imageFile,ImageFileFormat imageFileFormat,std::vector<BaseImage>& levels) const; // Decodes the given image file into a full set of mipmap levels, using the decoded image cache if enabled
 	void* loaderThreadMethod(void); // Method running an image data loader thread
 	
 	/* Constructors and destructors: */
 	public:
-	TextureManager(unsigned int sNumLoaderThreads); // Creates an empty texture manager with the given number of image data loader threads
+	TextureManager(unsigned int sNumLoaderThreads,const char* sCacheDirectory =0); // Creates an empty texture manager with the given number of image data loader threads; if a cache directory is given, loader threads decode images and pre-generate mipmap levels, and cache the results in that directory
 	~TextureManager(void); // Releases all resources and destroys the texture manager
 	
 	/* Methods: */
@@ -112,8 +133,13 @@ class TextureManager
 		{
 		return textureMapCond;
 		}
-	Handle loadTexture(const char* fileName,GLenum target,GLenum internalFormat,bool locked =false); // Loads an image from the given file name / URL for the given texture target and internal format and returns a texture handle; if locked flag is true, caller already holds lock on texture map
-	Handle loadTexture(IO::File& file,ImageFileFormat format,GLenum target,GLenum internalFormat,bool locked =false); // Loads an image of the given format from the given file for the given texture target and internal format and returns a texture handle; if locked flag is true, caller already holds lock on texture map
+	const std::string& getCacheDirectory(void) const // Returns the directory caching decoded images, or an empty string if caching is disabled
+		{
+		return cacheDirectory;
+		}
+	Handle loadTexture(const char* fileName,GLenum target,GLenum internalFormat,bool locked =false,int priority =0); // Loads an image from the given file name / URL for the given texture target and internal format and returns a texture handle; if locked flag is true, caller already holds lock on texture map; images of higher priority are loaded first
+	Handle loadTexture(IO::File& file,ImageFileFormat format,GLenum target,GLenum internalFormat,bool locked =false,int priority =0); // Loads an image of the given format from the given file for the given texture target and internal format and returns a texture handle; if locked flag is true, caller already holds lock on texture map; images of higher priority are loaded first
+	bool setPriority(Handle handle,int newPriority); // Changes the priority of the given texture's pending load request; returns false if the texture's image data is already being or has been loaded
 	void waitForImageData(void); // Blocks until all texture images have been loaded into CPU-side memory; keeps blocking if additional textures are requested while blocked
 	Texture* getTexture(Handle handle,bool locked) // Returns a pointer to the CPU-side texture of the given handle; if locked flag is true, caller already holds a lock on the texture map
 		{
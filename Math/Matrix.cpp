@@ -1,6 +1,6 @@
 /***********************************************************************
 Matrix - Class to represent double-valued matrices of dynamic sizes.
-Copyright (c) 2000-2017 Oliver Kreylos
+Copyright (c) 2000-2026 Oliver Kreylos
 
 This file is part of the Templatized Math Library (Math).
 
@@ -23,6 +23,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <Math/Math.h>
 #include <Math/Constants.h>
 
@@ -163,6 +166,330 @@ unsigned int gaussFullPivoting(unsigned int numRows,unsigned int numColumns,doub
 	return step;
 	}
 
+/* Return the dot product of two arrays: */
+
+inline double dot(const double* a,const double* b,unsigned int n)
+	{
+	double result=0.0;
+	unsigned int i=0;
+	
+	#ifdef __SSE2__
+	
+	/* Accumulate blocks of four products in two independent registers: */
+	__m128d sum0=_mm_setzero_pd();
+	__m128d sum1=_mm_setzero_pd();
+	for(;i+4<=n;i+=4)
+		{
+		sum0=_mm_add_pd(sum0,_mm_mul_pd(_mm_loadu_pd(a+i),_mm_loadu_pd(b+i)));
+		sum1=_mm_add_pd(sum1,_mm_mul_pd(_mm_loadu_pd(a+i+2),_mm_loadu_pd(b+i+2)));
+		}
+	double sums[2];
+	_mm_storeu_pd(sums,_mm_add_pd(sum0,sum1));
+	result=sums[0]+sums[1];
+	
+	#endif
+	
+	/* Accumulate the remaining products: */
+	for(;i<n;++i)
+		result+=a[i]*b[i];
+	
+	return result;
+	}
+
+/* Add a multiple of one array to another array: */
+
+inline void axpy(double* y,double a,const double* x,unsigned int n)
+	{
+	unsigned int i=0;
+	
+	#ifdef __SSE2__
+	
+	/* Update blocks of two elements: */
+	__m128d av=_mm_set1_pd(a);
+	for(;i+2<=n;i+=2)
+		_mm_storeu_pd(y+i,_mm_add_pd(_mm_loadu_pd(y+i),_mm_mul_pd(av,_mm_loadu_pd(x+i))));
+	
+	#endif
+	
+	/* Update the remaining elements: */
+	for(;i<n;++i)
+		y[i]+=a*x[i];
+	}
+
+/* Rotate two arrays by the plane rotation with the given cosine and sine: */
+
+inline void rotate(double* x,double* y,double c,double s,unsigned int n)
+	{
+	unsigned int i=0;
+	
+	#ifdef __SSE2__
+	
+	/* Rotate blocks of two element pairs: */
+	__m128d cv=_mm_set1_pd(c);
+	__m128d sv=_mm_set1_pd(s);
+	for(;i+2<=n;i+=2)
+		{
+		__m128d xv=_mm_loadu_pd(x+i);
+		__m128d yv=_mm_loadu_pd(y+i);
+		_mm_storeu_pd(x+i,_mm_sub_pd(_mm_mul_pd(cv,xv),_mm_mul_pd(sv,yv)));
+		_mm_storeu_pd(y+i,_mm_add_pd(_mm_mul_pd(sv,xv),_mm_mul_pd(cv,yv)));
+		}
+	
+	#endif
+	
+	/* Rotate the remaining element pairs: */
+	for(;i<n;++i)
+		{
+		double xi=x[i];
+		double yi=y[i];
+		x[i]=c*xi-s*yi;
+		y[i]=s*xi+c*yi;
+		}
+	}
+
+/* Block sizes for matrix multiplication, chosen such that a packed block of the right-hand matrix fits into the L2 cache: */
+
+const unsigned int multiplyBlockInner=128;
+const unsigned int multiplyBlockColumns=256;
+
+/* Multiply a strip of four rows of the left-hand matrix with a packed panel of four columns of the right-hand matrix: */
+
+inline void multiplyTile(unsigned int numInner,const double* const a[4],const double* b,double tile[16])
+	{
+	#ifdef __SSE2__
+	
+	/* Accumulate the 4x4 tile in eight registers: */
+	__m128d c00=_mm_setzero_pd();
+	__m128d c01=_mm_setzero_pd();
+	__m128d c10=_mm_setzero_pd();
+	__m128d c11=_mm_setzero_pd();
+	__m128d c20=_mm_setzero_pd();
+	__m128d c21=_mm_setzero_pd();
+	__m128d c30=_mm_setzero_pd();
+	__m128d c31=_mm_setzero_pd();
+	for(unsigned int k=0;k<numInner;++k,b+=4)
+		{
+		__m128d b0=_mm_loadu_pd(b);
+		__m128d b1=_mm_loadu_pd(b+2);
+		__m128d av;
+		av=_mm_set1_pd(a[0][k]);
+		c00=_mm_add_pd(c00,_mm_mul_pd(av,b0));
+		c01=_mm_add_pd(c01,_mm_mul_pd(av,b1));
+		av=_mm_set1_pd(a[1][k]);
+		c10=_mm_add_pd(c10,_mm_mul_pd(av,b0));
+		c11=_mm_add_pd(c11,_mm_mul_pd(av,b1));
+		av=_mm_set1_pd(a[2][k]);
+		c20=_mm_add_pd(c20,_mm_mul_pd(av,b0));
+		c21=_mm_add_pd(c21,_mm_mul_pd(av,b1));
+		av=_mm_set1_pd(a[3][k]);
+		c30=_mm_add_pd(c30,_mm_mul_pd(av,b0));
+		c31=_mm_add_pd(c31,_mm_mul_pd(av,b1));
+		}
+	_mm_storeu_pd(tile+0,c00);
+	_mm_storeu_pd(tile+2,c01);
+	_mm_storeu_pd(tile+4,c10);
+	_mm_storeu_pd(tile+6,c11);
+	_mm_storeu_pd(tile+8,c20);
+	_mm_storeu_pd(tile+10,c21);
+	_mm_storeu_pd(tile+12,c30);
+	_mm_storeu_pd(tile+14,c31);
+	
+	#else
+	
+	/* Accumulate the 4x4 tile: */
+	for(int i=0;i<16;++i)
+		tile[i]=0.0;
+	for(unsigned int k=0;k<numInner;++k,b+=4)
+		for(int i=0;i<4;++i)
+			{
+			double aik=a[i][k];
+			for(int j=0;j<4;++j)
+				tile[i*4+j]+=aik*b[j];
+			}
+	
+	#endif
+	}
+
+/* Multiply a numRows x numInner matrix with a numInner x numColumns matrix into a numRows x numColumns matrix, all stored in row-major order: */
+
+void multiplyMatrices(unsigned int numRows,unsigned int numInner,unsigned int numColumns,const double* a,const double* b,double* c)
+	{
+	/* Clear the result matrix: */
+	memset(c,0,size_t(numRows)*size_t(numColumns)*sizeof(double));
+	
+	if(size_t(numRows)*size_t(numInner)*size_t(numColumns)<4096)
+		{
+		/* Multiply small matrices by adding multiples of rows of the right-hand matrix to rows of the result matrix: */
+		for(unsigned int i=0;i<numRows;++i,a+=numInner,c+=numColumns)
+			for(unsigned int k=0;k<numInner;++k)
+				axpy(c,a[k],b+k*numColumns,numColumns);
+		
+		return;
+		}
+	
+	/* Multiply large matrices block by block, packing each block of the right-hand matrix into contiguous panels of four columns: */
+	double* packed=new double[multiplyBlockInner*multiplyBlockColumns];
+	for(unsigned int jj=0;jj<numColumns;jj+=multiplyBlockColumns)
+		{
+		unsigned int blockColumns=numColumns-jj<multiplyBlockColumns?numColumns-jj:multiplyBlockColumns;
+		unsigned int numPanels=(blockColumns+3)/4;
+		for(unsigned int kk=0;kk<numInner;kk+=multiplyBlockInner)
+			{
+			unsigned int blockInner=numInner-kk<multiplyBlockInner?numInner-kk:multiplyBlockInner;
+			
+			/* Pack the block of the right-hand matrix, padding the last panel with zeros: */
+			for(unsigned int k=0;k<blockInner;++k)
+				{
+				const double* bRow=b+((kk+k)*numColumns+jj);
+				for(unsigned int j=0;j<numPanels*4;++j)
+					packed[((j/4)*blockInner+k)*4+j%4]=j<blockColumns?bRow[j]:0.0;
+				}
+			
+			/* Multiply all strips of four rows of the left-hand matrix with the packed panels: */
+			for(unsigned int i=0;i<numRows;i+=4)
+				{
+				/* Duplicate the strip's first row if there are fewer than four rows left: */
+				unsigned int stripRows=numRows-i<4?numRows-i:4;
+				const double* aRows[4];
+				for(unsigned int r=0;r<4;++r)
+					aRows[r]=a+((i+(r<stripRows?r:0))*numInner+kk);
+				
+				for(unsigned int p=0;p<numPanels;++p)
+					{
+					/* Multiply the strip with the panel: */
+					double tile[16];
+					multiplyTile(blockInner,aRows,packed+p*blockInner*4,tile);
+					
+					/* Add the valid part of the tile to the result matrix: */
+					unsigned int tileColumns=blockColumns-p*4<4?blockColumns-p*4:4;
+					for(unsigned int r=0;r<stripRows;++r)
+						{
+						double* cPtr=c+((i+r)*numColumns+jj+p*4);
+						for(unsigned int j=0;j<tileColumns;++j)
+							cPtr[j]+=tile[r*4+j];
+						}
+					}
+				}
+			}
+		}
+	delete[] packed;
+	}
+
+/* Multiply the transpose of a numInner x numRows matrix with a numInner x numColumns matrix into a numRows x numColumns matrix, all stored in row-major order: */
+
+void transposeMultiplyMatrices(unsigned int numInner,unsigned int numRows,unsigned int numColumns,const double* a,const double* b,double* c)
+	{
+	/* Clear the result matrix: */
+	memset(c,0,size_t(numRows)*size_t(numColumns)*sizeof(double));
+	
+	/* Accumulate outer products of rows of the two matrices into blocks of result rows small enough to stay in cache: */
+	unsigned int blockRows=numColumns>0?(16384+numColumns-1)/numColumns:numRows;
+	for(unsigned int ii=0;ii<numRows;ii+=blockRows)
+		{
+		unsigned int iEnd=numRows-ii<blockRows?numRows:ii+blockRows;
+		const double* aRow=a;
+		const double* bRow=b;
+		for(unsigned int k=0;k<numInner;++k,aRow+=numRows,bRow+=numColumns)
+			for(unsigned int i=ii;i<iEnd;++i)
+				axpy(c+i*numColumns,aRow[i],bRow,numColumns);
+		}
+	}
+
+/* Reduce a numRows x numColumns matrix to upper-triangular form using Householder reflections; stores the reflection vectors, scaled to a leading one, below the diagonal and their coefficients in the given array; returns the number of reflections: */
+
+unsigned int householderReduction(unsigned int numRows,unsigned int numColumns,double* r,double betas[],double work[])
+	{
+	unsigned int numReflections=numRows-1<numColumns?numRows-1:numColumns;
+	for(unsigned int k=0;k<numReflections;++k)
+		{
+		/* Calculate the squared norm of the column below the diagonal: */
+		double* diagPtr=r+(k*numColumns+k);
+		double x0=*diagPtr;
+		double sigma2=0.0;
+		double* colPtr=diagPtr+numColumns;
+		for(unsigned int i=k+1;i<numRows;++i,colPtr+=numColumns)
+			sigma2+=Math::sqr(*colPtr);
+		
+		/* Skip the reflection if the column is already reduced: */
+		if(sigma2==0.0)
+			{
+			betas[k]=0.0;
+			continue;
+			}
+		
+		/* Calculate the reflection that maps the column to a multiple of the first basis vector, with the sign chosen to avoid cancellation: */
+		double alpha=Math::sqrt(Math::sqr(x0)+sigma2);
+		if(x0>=0.0)
+			alpha=-alpha;
+		double v0=x0-alpha;
+		colPtr=diagPtr+numColumns;
+		for(unsigned int i=k+1;i<numRows;++i,colPtr+=numColumns)
+			*colPtr/=v0;
+		double beta=2.0*Math::sqr(v0)/(Math::sqr(v0)+sigma2);
+		betas[k]=beta;
+		*diagPtr=alpha;
+		
+		/* Apply the reflection to the remaining columns by sweeping over rows: */
+		unsigned int numRest=numColumns-k-1;
+		if(numRest>0)
+			{
+			double* rowPtr=diagPtr+1;
+			for(unsigned int j=0;j<numRest;++j)
+				work[j]=rowPtr[j];
+			colPtr=diagPtr+numColumns;
+			for(unsigned int i=k+1;i<numRows;++i,colPtr+=numColumns)
+				axpy(work,*colPtr,colPtr+1,numRest);
+			axpy(rowPtr,-beta,work,numRest);
+			colPtr=diagPtr+numColumns;
+			for(unsigned int i=k+1;i<numRows;++i,colPtr+=numColumns)
+				axpy(colPtr+1,-beta*(*colPtr),work,numRest);
+			}
+		}
+	
+	return numReflections;
+	}
+
+/* Form the first numQColumns columns of the orthogonal matrix represented by the reflections stored by householderReduction: */
+
+void formHouseholderQ(unsigned int numRows,unsigned int numColumns,const double* r,const double betas[],unsigned int numReflections,unsigned int numQColumns,double* q,double work[])
+	{
+	/* Initialize the matrix to the first columns of the identity matrix: */
+	double* qPtr=q;
+	for(unsigned int i=0;i<numRows;++i)
+		for(unsigned int j=0;j<numQColumns;++j,++qPtr)
+			*qPtr=i==j?1.0:0.0;
+	
+	/* Apply the reflections in reverse order to blocks of columns small enough to stay in cache; columns left of a reflection's index are not affected by it: */
+	unsigned int blockColumns=32768/numRows;
+	if(blockColumns<8)
+		blockColumns=8;
+	for(unsigned int jj=0;jj<numQColumns;jj+=blockColumns)
+		{
+		unsigned int jEnd=numQColumns-jj<blockColumns?numQColumns:jj+blockColumns;
+		for(unsigned int k=numReflections<jEnd?numReflections:jEnd;k>0;--k)
+			{
+			unsigned int kk=k-1;
+			if(betas[kk]==0.0)
+				continue;
+			
+			unsigned int jBegin=kk>jj?kk:jj;
+			unsigned int numRest=jEnd-jBegin;
+			double* rowPtr=q+(kk*numQColumns+jBegin);
+			for(unsigned int j=0;j<numRest;++j)
+				work[j]=rowPtr[j];
+			const double* vPtr=r+((kk+1)*numColumns+kk);
+			double* qRowPtr=rowPtr+numQColumns;
+			for(unsigned int i=kk+1;i<numRows;++i,vPtr+=numColumns,qRowPtr+=numQColumns)
+				axpy(work,*vPtr,qRowPtr,numRest);
+			axpy(rowPtr,-betas[kk],work,numRest);
+			vPtr=r+((kk+1)*numColumns+kk);
+			qRowPtr=rowPtr+numQColumns;
+			for(unsigned int i=kk+1;i<numRows;++i,vPtr+=numColumns,qRowPtr+=numQColumns)
+				axpy(qRowPtr,-betas[kk]*(*vPtr),work,numRest);
+			}
+		}
+	}
+
 }
 
 /***********************
@@ -199,6 +526,32 @@ void Matrix::release(void)
 		}
 	}
 
+double* Matrix::prepareResult(unsigned int resultSize,const double* source1,const double* source2) const
+	{
+	/* Check if the current element array can hold the result: */
+	if(m!=0&&reinterpret_cast<unsigned int*>(m)[-1]==1&&numRows*numColumns==resultSize&&m!=source1&&m!=source2)
+		return m;
+	
+	/* Create a new private element array: */
+	double* result=(new double[resultSize+1])+1;
+	reinterpret_cast<unsigned int*>(result)[-1]=1;
+	return result;
+	}
+
+void Matrix::finishResult(unsigned int resultNumRows,unsigned int resultNumColumns,double* resultM)
+	{
+	if(resultM!=m)
+		{
+		/* Release the old element array and take ownership of the new one: */
+		release();
+		m=resultM;
+		}
+	
+	/* Resize the matrix: */
+	numRows=resultNumRows;
+	numColumns=resultNumColumns;
+	}
+
 Matrix::Matrix(unsigned int sNumRows,unsigned int sNumColumns,double* sElements)
 	:numRows(sNumRows),numColumns(sNumColumns),
 	 m((new double[numRows*numColumns+1])+1)
@@ -513,32 +866,25 @@ Matrix Matrix::inverseFullPivot(void) const
 
 Matrix& Matrix::operator*=(const Matrix& other)
 	{
-	/* Create a new private element array: */
-	double* newM=(new double[numRows*other.numColumns+1])+1;
-	reinterpret_cast<unsigned int*>(newM)[-1]=1;
-	
-	/* Multiply the current and other matrices into the new element array: */
-	size_t numOps=0;
-	double* rPtr=newM;
-	for(unsigned int i=0;i<numRows;++i)
-		for(unsigned int j=0;j<other.numColumns;++j,++rPtr)
-			{
-			const double* mPtr=m+i*numColumns;
-			const double* oPtr=other.m+j;
-			*rPtr=0.0;
-			for(unsigned int k=0;k<numColumns;++k,++mPtr,oPtr+=other.numColumns)
-				{
-				*rPtr+=(*mPtr)*(*oPtr);
-				++numOps;
-				}
-			}
-	
-	/* Release the old element array: */
-	release();
+	return setProduct(*this,other);
+	}
+
+Matrix& Matrix::setProduct(const Matrix& m1,const Matrix& m2)
+	{
+	/* Multiply the two matrices into a private element array that is not shared with either of them: */
+	double* newM=prepareResult(m1.numRows*m2.numColumns,m1.m,m2.m);
+	multiplyMatrices(m1.numRows,m1.numColumns,m2.numColumns,m1.m,m2.m,newM);
+	finishResult(m1.numRows,m2.numColumns,newM);
 	
-	/* Set the new element array: */
-	numColumns=other.numColumns;
-	m=newM;
+	return *this;
+	}
+
+Matrix& Matrix::setTransposeProduct(const Matrix& m1,const Matrix& m2)
+	{
+	/* Multiply the transpose of the first matrix and the second matrix into a private element array that is not shared with either of them: */
+	double* newM=prepareResult(m1.numColumns*m2.numColumns,m1.m,m2.m);
+	transposeMultiplyMatrices(m1.numRows,m1.numColumns,m2.numColumns,m1.m,m2.m,newM);
+	finishResult(m1.numColumns,m2.numColumns,newM);
 	
 	return *this;
 	}
@@ -923,45 +1269,59 @@ Matrix Matrix::choleskyDecomposition(void) const
 	return l;
 	}
 
-std::pair<Matrix,Matrix> Matrix::qrDecomposition(void) const
+void Matrix::qrDecomposition(Matrix& q,Matrix& r,bool economy) const
 	{
-	/* Create the result matrices: */
-	Matrix q(numRows,numRows);
-	Matrix r(numRows,numColumns,0.0);
-	
-	/**********************************************************
-	Decompose the matrix using Gram-Schmidt orthonormalization:
-	**********************************************************/
-	
-	/* Calculate the first basis vector: */
-	Matrix u0=getColumn(0);
-	u0/=u0.mag();
-	q.setColumn(0,u0);
-	r(0,0)=(u0.transpose()*getColumn(0))(0);
-	
-	/* Calculate the rest of the basis vectors: */
-	for(unsigned int col=1;col<numColumns;++col)
+	/* Determine the sizes of the result matrices: */
+	unsigned int numDiag=numRows<numColumns?numRows:numColumns;
+	unsigned int numQColumns=economy?numDiag:numRows;
+	
+	/* Copy this matrix into the element array of the r matrix, or into a temporary array if an economy-size r matrix can not hold it: */
+	double* rM=r.prepareResult(numQColumns*numColumns,m,q.m);
+	double* reduced=numQColumns==numRows?rM:new double[numRows*numColumns];
+	memcpy(reduced,m,numRows*numColumns*sizeof(double));
+	
+	/* Reduce the matrix to upper-triangular form using Householder reflections; the scratch space must hold a row of the reduced matrix or a row of the q matrix: */
+	double* betas=new double[numColumns+(numRows>numColumns?numRows:numColumns)];
+	double* work=betas+numColumns;
+	unsigned int numReflections=householderReduction(numRows,numColumns,reduced,betas,work);
+	
+	/* Accumulate the reflections into the q matrix: */
+	double* qM=q.prepareResult(numRows*numQColumns,m,rM);
+	formHouseholderQ(numRows,numColumns,reduced,betas,numReflections,numQColumns,qM,work);
+	delete[] betas;
+	
+	/* Copy the upper-triangular part of the reduced matrix into the r matrix, clearing the reflection vectors below the diagonal: */
+	for(unsigned int i=0;i<numQColumns;++i)
 		{
-		/* Get the next vector: */
-		Matrix acol=getColumn(col);
-		Matrix ucol=acol;
-		
-		/* Orthogonalize it against all previous basis vectors: */
-		for(unsigned int j=0;j<col;++j)
+		double* rRowPtr=rM+i*numColumns;
+		const double* redRowPtr=reduced+i*numColumns;
+		for(unsigned int j=0;j<numColumns;++j)
+			rRowPtr[j]=j<i?0.0:redRowPtr[j];
+		}
+	if(reduced!=rM)
+		delete[] reduced;
+	
+	/* Make the diagonal of r non-negative by flipping the signs of rows of r and the corresponding columns of q: */
+	for(unsigned int k=0;k<numDiag;++k)
+		if(rM[k*numColumns+k]<0.0)
 			{
-			Matrix ej=q.getColumn(j);
-			double eu=(ej.transpose()*ucol)(0);
-			r(j,col)=eu;
-			ucol-=ej*eu;
+			double* rRowPtr=rM+k*numColumns;
+			for(unsigned int j=k;j<numColumns;++j)
+				rRowPtr[j]=-rRowPtr[j];
+			double* qColPtr=qM+k;
+			for(unsigned int i=0;i<numRows;++i,qColPtr+=numQColumns)
+				*qColPtr=-*qColPtr;
 			}
-		
-		/* Store the next basis vector: */
-		ucol/=ucol.mag();
-		q.setColumn(col,ucol);
-		r(col,col)=(ucol.transpose()*acol)(0);
-		}
 	
-	/* Return the result matrices: */
+	/* Set the result matrices: */
+	r.finishResult(numQColumns,numColumns,rM);
+	q.finishResult(numRows,numQColumns,qM);
+	}
+
+std::pair<Matrix,Matrix> Matrix::qrDecomposition(void) const
+	{
+	Matrix q,r;
+	qrDecomposition(q,r);
 	return std::make_pair(q,r);
 	}
 
@@ -990,7 +1350,7 @@ inline unsigned int findRowPivot(unsigned int i,unsigned int numColumns,const do
 
 std::pair<Matrix,Matrix> Matrix::jacobiIteration(void) const
 	{
-	/* Create the result matrices: */
+	/* Create the result matrices; accumulate the eigenvectors in the rows of the q matrix such that rotations access contiguous memory, and transpose it at the end: */
 	Matrix q(numRows,numRows,1.0);
 	Matrix e(numRows,1);
 	Matrix d=*this;
@@ -1096,14 +1456,7 @@ std::pair<Matrix,Matrix> Matrix::jacobiIteration(void) const
 			}
 		
 		/* Rotate the eigenvector matrix: */
-		double* qRowPtr=q.m;
-		for(unsigned int i=0;i<numRows;++i,qRowPtr+=numRows)
-			{
-			double qik=qRowPtr[k];
-			double qil=qRowPtr[l];
-			qRowPtr[k]=c*qik-s*qil;
-			qRowPtr[l]=s*qik+c*qil;
-			}
+		rotate(q.m+k*numRows,q.m+l*numRows,c,s,numRows);
 		
 		/* Find new row pivots for the changed rows: */
 		rowPivots[k]=findRowPivot(k,numColumns,d.m);
@@ -1111,279 +1464,159 @@ std::pair<Matrix,Matrix> Matrix::jacobiIteration(void) const
 			rowPivots[l]=findRowPivot(l,numColumns,d.m);
 		}
 	
+	/* Transpose the eigenvector matrix to store the eigenvectors in its columns: */
+	for(unsigned int i=1;i<numRows;++i)
+		for(unsigned int j=0;j<i;++j)
+			std::swap(q.m[i*numRows+j],q.m[j*numRows+i]);
+	
 	/* Clean up and return the result matrices: */
 	delete[] rowPivots;
 	delete[] changed;
 	return std::make_pair(q,e);
 	}
 
-SVD Matrix::svd(bool calcU,bool calcV) const
+void Matrix::svd(SVD& result,bool calcU,bool calcV) const
 	{
-	/* Initialize the result: */
-	SVD result;
-	
-	/* Copy this matrix into the U matrix: */
-	result.u=*this;
-	result.u.makePrivate();
-	
-	/* Initialize the sigma matrix: */
-	result.sigma=Matrix(numColumns,1);
+	if(numRows<numColumns)
+		throw Error("Matrix::svd: Matrix has fewer rows than columns");
+	
+	/* Allocate a work array holding the reduced matrix, the transposed columns of its triangular part, the transposed right-singular vectors, the triangular part's left-singular vectors, the columns' reflection coefficients, squared norms, and singular values, and scratch space: */
+	unsigned int n=numColumns;
+	double* r=new double[numRows*n+n*n*(calcV?3:2)+n*3+numRows];
+	double* wt=r+numRows*n;
+	double* vt=wt+n*n;
+	double* ur=vt+(calcV?n*n:0);
+	double* norms=ur+n*n;
+	double* betas=norms+n;
+	double* sigmas=betas+n;
+	double* work=sigmas+n;
 	
 	/*********************************************************************
-	Reduce the matrix to bidiagonal form using Householder's method:
+	Reduce the matrix to upper-triangular form using Householder
+	reflections, such that the rotations below only operate on a square
+	matrix:
 	*********************************************************************/
 	
-	double* e=new double[numColumns];
-	double g=0.0;
-	double x=0.0;
-	double tol=Math::Constants<double>::smallest/Math::Constants<double>::epsilon;
-	for(unsigned int i=0;i<numColumns;++i)
-		{
-		e[i]=g;
-		double s=0.0;
-		for(unsigned int j=i;j<numRows;++j)
-			s+=sqr(result.u(j,i));
-		if(s<tol)
-			g=0.0;
-		else
-			{
-			double f=result.u(i,i);
-			g=copysign(sqrt(s),-f);
-			double h=f*g-s;
-			result.u(i,i)=f-g;
-			for(unsigned int j=i+1;j<numColumns;++j)
-				{
-				s=0.0;
-				for(unsigned int k=i;k<numRows;++k)
-					s+=result.u(k,j)*result.u(k,i);
-				f=s/h;
-				for(unsigned int k=i;k<numRows;++k)
-					result.u(k,j)+=f*result.u(k,i);
-				}
-			}
-		
-		result.sigma(i)=g;
-		s=0.0;
-		for(unsigned int j=i+1;j<numColumns;++j)
-			s+=sqr(result.u(i,j));
-		if(s<tol)
-			g=0.0;
-		else
-			{
-			double f=result.u(i,i+1);
-			g=copysign(sqrt(s),-f);
-			double h=f*g-s;
-			result.u(i,i+1)=f-g;
-			for(unsigned int j=i+1;j<numColumns;++j)
-				e[j]=result.u(i,j)/h;
-			for(unsigned int j=i+1;j<numRows;++j)
-				{
-				s=0.0;
-				for(unsigned int k=i+1;k<numColumns;++k)
-					s+=result.u(j,k)*result.u(i,k);
-				for(unsigned int k=i+1;k<numColumns;++k)
-					result.u(j,k)+=s*e[k];
-				}
-			}
-		
-		x=max(x,abs(result.sigma(i))+abs(e[i]));
-		}
+	memcpy(r,m,numRows*n*sizeof(double));
+	unsigned int numReflections=householderReduction(numRows,n,r,betas,work);
+	
+	/* Store the columns of the triangular matrix in the rows of a work matrix so that rotations access contiguous memory: */
+	for(unsigned int i=0;i<n;++i)
+		for(unsigned int j=0;j<n;++j)
+			wt[i*n+j]=j<=i?r[j*n+i]:0.0;
 	
 	if(calcV)
 		{
-		/*******************************************************************
-		Calculate the matrix of right-singular vectors:
-		*******************************************************************/
-		
-		/* Initialize the right-singular matrix: */
-		result.v=Matrix(numColumns,numColumns);
-		
-		/* Calculate the right-singular vectors: */
-		for(unsigned int l=numColumns;l>0;--l)
-			{
-			unsigned int i=l-1;
-			if(g!=0.0) // On first iteration, this g is the last g computed in the Householder reduction
-				{
-				double h=result.u(i,l)*g;
-				for(unsigned int j=l;j<numColumns;++j)
-					result.v(j,i)=result.u(i,j)/h;
-				for(unsigned int j=l;j<numColumns;++j)
-					{
-					double s=0.0;
-					for(unsigned int k=l;k<numColumns;++k)
-						s+=result.v(k,j)*result.u(i,k);
-					for(unsigned int k=l;k<numColumns;++k)
-						result.v(k,j)+=s*result.v(k,i);
-					}
-				}
-			
-			for(unsigned int j=l;j<numColumns;++j)
-				result.v(i,j)=result.v(j,i)=0.0;
-			result.v(i,i)=1.0;
-			g=e[i];
-			}
+		/* Initialize the transposed right-singular vectors to the identity matrix: */
+		for(unsigned int i=0;i<n;++i)
+			for(unsigned int j=0;j<n;++j)
+				vt[i*n+j]=i==j?1.0:0.0;
 		}
 	
-	if(calcU)
+	/*********************************************************************
+	Orthogonalize the columns of the triangular matrix using one-sided
+	Jacobi rotations until all pairs are orthogonal to working precision:
+	*********************************************************************/
+	
+	double eps=Math::Constants<double>::epsilon;
+	for(unsigned int sweep=0;sweep<64;++sweep)
 		{
-		/*******************************************************************
-		Calculate the matrix of left-singular vectors:
-		*******************************************************************/
+		/* Recalculate the columns' squared norms at the beginning of each sweep to avoid drift: */
+		for(unsigned int i=0;i<n;++i)
+			norms[i]=dot(wt+i*n,wt+i*n,n);
 		
-		for(unsigned int l=numColumns;l>0;--l)
-			{
-			unsigned int i=l-1;
-			g=result.sigma(i);
-			for(unsigned int j=l;j<numColumns;++j)
-				result.u(i,j)=0.0;
-			if(g!=0.0)
+		bool rotated=false;
+		for(unsigned int p=0;p+1<n;++p)
+			for(unsigned int q=p+1;q<n;++q)
 				{
-				double h=result.u(i,i)*g;
-				for(unsigned int j=l;j<numColumns;++j)
-					{
-					double s=0.0;
-					for(unsigned int k=l;k<numRows;++k)
-						s+=result.u(k,j)*result.u(k,i);
-					double f=s/h;
-					for(unsigned int k=l;k<numRows;++k)
-						result.u(k,j)+=f*result.u(k,i);
-					}
+				/* Check if the pair of columns is already orthogonal: */
+				double gamma=dot(wt+p*n,wt+q*n,n);
+				if(Math::abs(gamma)<=eps*Math::sqrt(norms[p]*norms[q]))
+					continue;
 				
-				for(unsigned int j=i;j<numRows;++j)
-					result.u(j,i)/=g;
-				}
-			else
-				{
-				for(unsigned int j=i;j<numRows;++j)
-					result.u(j,i)=0.0;
+				/* Calculate the rotation that orthogonalizes the pair of columns: */
+				double zeta=(norms[q]-norms[p])/(2.0*gamma);
+				double t=1.0/(Math::abs(zeta)+Math::sqrt(1.0+Math::sqr(zeta)));
+				if(zeta<0.0)
+					t=-t;
+				double c=1.0/Math::sqrt(1.0+Math::sqr(t));
+				double s=c*t;
+				
+				/* Rotate the pair of columns and update their squared norms: */
+				rotate(wt+p*n,wt+q*n,c,s,n);
+				norms[p]-=t*gamma;
+				norms[q]+=t*gamma;
+				if(calcV)
+					rotate(vt+p*n,vt+q*n,c,s,n);
+				rotated=true;
 				}
-			
-			result.u(i,i)+=1.0;
-			}
+		
+		if(!rotated)
+			break;
 		}
 	
 	/*********************************************************************
-	Diagonalize the bidiagonal form:
+	Extract the singular values and sort them in descending order:
 	*********************************************************************/
 	
-	double eps=Math::Constants<double>::epsilon*x;
-	for(unsigned int k1=numColumns;k1>0;--k1)
+	unsigned int* order=new unsigned int[n];
+	for(unsigned int i=0;i<n;++i)
 		{
-		unsigned int k=k1-1;
-		unsigned int l,l1;
-		double c,s;
-		double f,g,h,x,y,z;
-		
-		testForSplitting:
-		for(unsigned int l1=k1;l1>0;--l1)
-			{
-			l=l1-1;
-			if(abs(e[l])<=eps)
-				goto testForConvergence;
-			if(abs(result.sigma(l-1))<=eps) // Never executed when l==0, because e[0] is always 0.0
-				goto cancellation;
-			}
-		
-		/* Cancellation of e[l] if l>0: */
-		cancellation:
-		c=0.0;
-		s=1.0;
-		l1=l-1;
-		for(unsigned int i=l;i<=k;++i)
-			{
-			double f=s*e[i];
-			e[i]=c*e[i];
-			if(abs(f)<=eps)
-				goto testForConvergence;
-			g=result.sigma(i);
-			double h=sqrt(f*f+g*g);
-			result.sigma(i)=h;
-			c=g/h;
-			s=-f/h;
-			if(calcU)
-				for(unsigned int j=0;j<numRows;++j)
-					{
-					double y=result.u(j,l1);
-					double z=result.u(j,i);
-					result.u(j,l1)=y*c+z*s;
-					result.u(j,i)=-y*s+z*c;
-					}
-			}
-		
-		testForConvergence:
-		z=result.sigma(k);
-		if(l==k)
-			goto convergence;
-		
-		/* Shift from bottom 2x2 minor: */
-		x=result.sigma(l);
-		y=result.sigma(k-1);
-		g=e[k-1];
-		h=e[k];
-		f=((y-z)*(y+z)+(g-h)*(g+h))/(2.0*h*y);
-		g=sqrt(f*f+1.0);
-		f=((x-z)*(x+z)+h*(y/(f<0.0?f-g:f+g)-h))/x;
+		sigmas[i]=Math::sqrt(dot(wt+i*n,wt+i*n,n));
 		
-		/* Next QR transformation: */
-		c=1.0;
-		s=1.0;
-		for(unsigned int i=l+1;i<=k;++i)
-			{
-			double g=e[i];
-			double y=result.sigma(i);
-			double h=s*g;
-			g=c*g;
-			double z=sqrt(f*f+h*h);
-			e[i-1]=z;
-			c=f/z;
-			s=h/z;
-			f=x*c+g*s;
-			g=-x*s+g*c;
-			h=y*s;
-			y*=c;
-			if(calcV)
-				for(unsigned int j=0;j<numColumns;++j)
-					{
-					double x=result.v(j,i-1);
-					double z=result.v(j,i);
-					result.v(j,i-1)=x*c+z*s;
-					result.v(j,i)=-x*s+z*c;
-					}
-			
-			z=sqrt(f*f+h*h);
-			result.sigma(i-1)=z;
-			c=f/z;
-			s=h/z;
-			f=c*g+s*y;
-			x=-s*g+c*y;
-			if(calcU)
-				for(unsigned int j=0;j<numRows;++j)
-					{
-					double y=result.u(j,i-1);
-					double z=result.u(j,i);
-					result.u(j,i-1)=y*c+z*s;
-					result.u(j,i)=-y*s+z*c;
-					}
-			}
-		
-		e[l]=0.0;
-		e[k]=f;
-		result.sigma(k)=x;
-		goto testForSplitting;
+		/* Insert the column into the sorted order: */
+		unsigned int j;
+		for(j=i;j>0&&sigmas[order[j-1]]<sigmas[i];--j)
+			order[j]=order[j-1];
+		order[j]=i;
+		}
+	
+	double* sigmaM=result.sigma.prepareResult(n,0,0);
+	for(unsigned int i=0;i<n;++i)
+		sigmaM[i]=sigmas[order[i]];
+	result.sigma.finishResult(n,1,sigmaM);
+	
+	if(calcV)
+		{
+		/* Store the sorted right-singular vectors in the columns of the v matrix: */
+		double* vM=result.v.prepareResult(n*n,0,0);
+		for(unsigned int i=0;i<n;++i)
+			for(unsigned int j=0;j<n;++j)
+				vM[i*n+j]=vt[order[j]*n+i];
+		result.v.finishResult(n,n,vM);
+		}
+	
+	if(calcU)
+		{
+		/* Calculate the left-singular vectors of the triangular matrix by normalizing the sorted orthogonal columns; zero columns correspond to zero singular values: */
+		for(unsigned int i=0;i<n;++i)
+			for(unsigned int j=0;j<n;++j)
+				{
+				double sigma=sigmas[order[j]];
+				ur[i*n+j]=sigma!=0.0?wt[order[j]*n+i]/sigma:0.0;
+				}
 		
-		convergence:
-		if(z<0.0)
-			{
-			/* Make result.sigma[k] non-negative: */
-			result.sigma(k)=-z;
-			if(calcV)
-				for(unsigned int j=0;j<numColumns;++j)
-					result.v(j,k)=-result.v(j,k);
-			}
+		/* Multiply the first columns of the orthogonal matrix of the Householder reduction with the triangular matrix' left-singular vectors: */
+		double* q=wt;
+		if(numRows>n)
+			q=new double[numRows*n];
+		formHouseholderQ(numRows,n,r,betas,numReflections,n,q,work);
+		double* uM=result.u.prepareResult(numRows*n,0,0);
+		multiplyMatrices(numRows,n,n,q,ur,uM);
+		result.u.finishResult(numRows,n,uM);
+		if(q!=wt)
+			delete[] q;
 		}
 	
-	/* Clean up and return the result: */
-	delete[] e;
+	/* Clean up: */
+	delete[] order;
+	delete[] r;
+	}
+
+SVD Matrix::svd(bool calcU,bool calcV) const
+	{
+	SVD result;
+	svd(result,calcU,calcV);
 	return result;
 	}
 
@@ -1,6 +1,6 @@
 /***********************************************************************
 Matrix - Class to represent double-valued matrices of dynamic sizes.
-Copyright (c) 2000-2017 Oliver Kreylos
+Copyright (c) 2000-2026 Oliver Kreylos
 
 This file is part of the Templatized Math Library (Math).
 
@@ -62,6 +62,8 @@ class Matrix
 	/* Private methods: */
 	void share(double* newM); // Takes shared ownership of the given element array
 	void release(void); // Releases ownership of the matrix's element array
+	double* prepareResult(unsigned int resultSize,const double* source1,const double* source2) const; // Returns the element array if it is private, holds the given number of elements, and is not one of the given source arrays; otherwise returns a new private element array
+	void finishResult(unsigned int resultNumRows,unsigned int resultNumColumns,double* resultM); // Resizes the matrix and replaces its element array with the given one returned by prepareResult
 	
 	/* Constructors and destructors: */
 	public:
@@ -164,6 +166,8 @@ class Matrix
 	Matrix inverse(void) const; // Ring multiplicative inverse; throws exception if matrix is singular
 	Matrix inverseFullPivot(void) const; // Ring multiplicative inverse calculated using full pivoting; throws exception if matrix is singular
 	Matrix& operator*=(const Matrix& other); // Ring multiplication
+	Matrix& setProduct(const Matrix& m1,const Matrix& m2); // Sets the matrix to the product m1*m2; reuses the element array if it is private and of the same size
+	Matrix& setTransposeProduct(const Matrix& m1,const Matrix& m2); // Sets the matrix to the product m1^T*m2 without forming the transpose of m1; reuses the element array if it is private and of the same size
 	Matrix& operator/=(const Matrix& other); // Ring division; throws exception if other matrix is singular
 	Matrix& divideFullPivot(const Matrix& other); // Ring division calculated using full pivoting; throws exception if other matrix is singular
 	
@@ -179,8 +183,10 @@ class Matrix
 	Matrix kernel(void) const; // Returns a matrix whose column vectors span this matrix' null space
 	std::pair<Matrix,Matrix> solveLinearSystem(const Matrix& coefficients,double zeroFudge =0.0) const; // Returns a pair of matrices defining all solutions to the linear system defined by the matrix and the coefficient column vector. The first matrix contains solution column vectors; the column vectors of the second matrix span the solution space if the system is under-determined; uses zeroFudge to check for null rows in underdetermined case
 	Matrix choleskyDecomposition(void) const; // Returns Cholesky decomposition of this square matrix; assumes that matrix is symmetric and positive definite
+	void qrDecomposition(Matrix& q,Matrix& r,bool economy =false) const; // Calculates the QR decomposition of the matrix using Householder reflections into an orthogonal numRows x numRows matrix q and an upper-triangular numRows x numColumns matrix r with non-negative diagonal, or into a numRows x k matrix q with orthonormal columns and a k x numColumns matrix r, where k=min(numRows, numColumns), if economy is true; reuses the element arrays of q and r if they are private and of the same sizes
 	std::pair<Matrix,Matrix> qrDecomposition(void) const; // Returns (q, r), the QR decomposition of the matrix
 	std::pair<Matrix,Matrix> jacobiIteration(void) const; // Performs Jacobi iteration on a symmetric matrix; returns orthogonal matrix Q of eigenvectors and column vector E of eigenvalues
+	void svd(SVD& result,bool calcU,bool calcV) const; // Performs singular value decomposition on a tall matrix (numRows >= numColumns) into the given result structure, reusing its element arrays if they are private and of the same sizes. Calculates left-singular and right-singular vectors only if respective flags are true
 	SVD svd(bool calcU,bool calcV) const; // Performs singular value decomposition on a tall matrix (numRows >= numColumns). Calculates left-singular and right-singular vectors only if respective flags are true
 	};
 
@@ -189,7 +195,7 @@ struct SVD // Structure to return results of singular value decomposition of an
 	/* Elements: */
 	public:
 	Matrix u; // m x n matrix of left-singular vectors
-	Matrix sigma; // n x 1 matrix of singular values
+	Matrix sigma; // n x 1 matrix of non-negative singular values in descending order
 	Matrix v; // n x n matrix of right-singular vectors
 	};
 
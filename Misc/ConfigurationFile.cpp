@@ -1,7 +1,7 @@
 /***********************************************************************
 ConfigurationFile - Class to handle permanent storage of configuration
 data in human-readable text files.
-Copyright (c) 2002-2024 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -28,7 +28,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <vector>
+#include <Misc/SizedTypes.h>
 #include <Misc/StdError.h>
 #include <Misc/File.h>
 #include <Misc/StandardValueCoders.h>
@@ -65,6 +71,21 @@ ConfigurationFileBase::TagNotFoundError::TagNotFoundError(const char* source,con
 	{
 	}
 
+/*****************************************************
+Methods of class ConfigurationFileBase::Section::Name:
+*****************************************************/
+
+size_t ConfigurationFileBase::Section::Name::hash(const ConfigurationFileBase::Section::Name& source,size_t tableSize)
+	{
+	/* Hash the name's characters the same way as StringHashFunction: */
+	size_t result=0;
+	const char* cEnd=source.chars+source.length;
+	for(const char* cPtr=source.chars;cPtr!=cEnd;++cPtr)
+		result=result*37+size_t(*cPtr);
+	
+	return result%tableSize;
+	}
+
 /***********************************************
 Methods of class ConfigurationFileBase::Section:
 ***********************************************/
@@ -73,6 +94,8 @@ ConfigurationFileBase::Section::Section(ConfigurationFileBase::Section* sParent,
 	:parent(sParent),name(sName),
 	 sibling(0),
 	 firstSubsection(0),lastSubsection(0),
+	 numSubsections(0),subsectionIndex(0),
+	 tagIndex(0),
 	 edited(false)
 	{
 	}
@@ -86,6 +109,10 @@ ConfigurationFileBase::Section::~Section(void)
 		delete firstSubsection;
 		firstSubsection=next;
 		}
+	
+	/* Delete the name indices: */
+	delete subsectionIndex;
+	delete tagIndex;
 	}
 
 void ConfigurationFileBase::Section::clear(void)
@@ -98,31 +125,118 @@ void ConfigurationFileBase::Section::clear(void)
 		firstSubsection=succ;
 		}
 	lastSubsection=0;
+	numSubsections=0;
+	delete subsectionIndex;
+	subsectionIndex=0;
 	
 	/* Remove all tag/value pairs: */
 	values.clear();
+	delete tagIndex;
+	tagIndex=0;
 	
 	/* Mark the section as edited: */
 	edited=true;
 	}
 
+ConfigurationFileBase::Section* ConfigurationFileBase::Section::findSubsection(const char* subsectionName,size_t subsectionNameLength) const
+	{
+	if(subsectionIndex!=0)
+		{
+		/* Look up the subsection in the subsection index: */
+		SubsectionIndex::Iterator ssIt=subsectionIndex->findEntry(Name(subsectionName,subsectionNameLength));
+		return !ssIt.isFinished()?ssIt->getDest():0;
+		}
+	else
+		{
+		/* Search the subsection list: */
+		Section* sPtr;
+		for(sPtr=firstSubsection;sPtr!=0&&(sPtr->name.size()!=subsectionNameLength||memcmp(sPtr->name.data(),subsectionName,subsectionNameLength)!=0);sPtr=sPtr->sibling)
+			;
+		return sPtr;
+		}
+	}
+
+std::list<ConfigurationFileBase::Section::TagValue>::iterator ConfigurationFileBase::Section::findTag(const char* tag,size_t tagLength)
+	{
+	if(tagIndex!=0)
+		{
+		/* Look up the tag in the tag index: */
+		TagIndex::Iterator tIt=tagIndex->findEntry(Name(tag,tagLength));
+		return !tIt.isFinished()?tIt->getDest():values.end();
+		}
+	else
+		{
+		/* Search the tag list: */
+		std::list<TagValue>::iterator tvIt;
+		for(tvIt=values.begin();tvIt!=values.end()&&(tvIt->tag.size()!=tagLength||memcmp(tvIt->tag.data(),tag,tagLength)!=0);++tvIt)
+			;
+		return tvIt;
+		}
+	}
+
+const ConfigurationFileBase::Section::TagValue* ConfigurationFileBase::Section::findTag(const char* tag) const
+	{
+	/* Find the tag using the non-const method, which does not change the section: */
+	Section* self=const_cast<Section*>(this);
+	std::list<TagValue>::iterator tvIt=self->findTag(tag,strlen(tag));
+	return tvIt!=self->values.end()?&*tvIt:0;
+	}
+
+void ConfigurationFileBase::Section::appendSubsection(ConfigurationFileBase::Section* newSubsection)
+	{
+	/* Link the new subsection to the end of the subsection list: */
+	if(lastSubsection!=0)
+		lastSubsection->sibling=newSubsection;
+	else
+		firstSubsection=newSubsection;
+	lastSubsection=newSubsection;
+	++numSubsections;
+	
+	if(subsectionIndex!=0)
+		{
+		/* Index the new subsection by its name: */
+		subsectionIndex->setEntry(SubsectionIndex::Entry(Name(newSubsection->name),newSubsection));
+		}
+	else if(numSubsections>indexThreshold)
+		{
+		/* Index all subsections by their names: */
+		subsectionIndex=new SubsectionIndex(numSubsections*2);
+		for(Section* sPtr=firstSubsection;sPtr!=0;sPtr=sPtr->sibling)
+			subsectionIndex->setEntry(SubsectionIndex::Entry(Name(sPtr->name),sPtr));
+		}
+	}
+
+void ConfigurationFileBase::Section::appendTagValue(const char* newTag,size_t newTagLength,const char* newValue,size_t newValueLength)
+	{
+	/* Append a new tag/value pair to the tag list: */
+	values.push_back(TagValue(newTag,newTagLength,newValue,newValueLength));
+	
+	if(tagIndex!=0)
+		{
+		/* Index the new tag/value pair by its tag name: */
+		std::list<TagValue>::iterator tvIt=values.end();
+		--tvIt;
+		tagIndex->setEntry(TagIndex::Entry(Name(tvIt->tag),tvIt));
+		}
+	else if(values.size()>indexThreshold)
+		{
+		/* Index all tag/value pairs by their tag names: */
+		tagIndex=new TagIndex(values.size()*2);
+		for(std::list<TagValue>::iterator tvIt=values.begin();tvIt!=values.end();++tvIt)
+			tagIndex->setEntry(TagIndex::Entry(Name(tvIt->tag),tvIt));
+		}
+	}
+
 ConfigurationFileBase::Section* ConfigurationFileBase::Section::addSubsection(const std::string& subsectionName)
 	{
 	/* Check if the subsection already exists: */
-	Section* sPtr;
-	for(sPtr=firstSubsection;sPtr!=0;sPtr=sPtr->sibling)
-		if(sPtr->name==subsectionName)
-			break;
+	Section* sPtr=findSubsection(subsectionName.data(),subsectionName.size());
 	
 	if(sPtr==0)
 		{
 		/* Add new subsection: */
 		Section* newSubsection=new Section(this,subsectionName);
-		if(lastSubsection!=0)
-			lastSubsection->sibling=newSubsection;
-		else
-			firstSubsection=newSubsection;
-		lastSubsection=newSubsection;
+		appendSubsection(newSubsection);
 		
 		/* Mark the section as edited: */
 		edited=true;
@@ -136,13 +250,19 @@ ConfigurationFileBase::Section* ConfigurationFileBase::Section::addSubsection(co
 void ConfigurationFileBase::Section::removeSubsection(const std::string& subsectionName)
 	{
 	/* Find a subsection of the given name: */
-	Section* sPred=0;
-	Section* sPtr;
-	for(sPtr=firstSubsection;sPtr!=0&&sPtr->name!=subsectionName;sPred=sPtr,sPtr=sPtr->sibling)
-		;
+	Section* sPtr=findSubsection(subsectionName.data(),subsectionName.size());
 	if(sPtr!=0)
 		{
+		/* Find the subsection's predecessor in the subsection list: */
+		Section* sPred=0;
+		if(sPtr!=firstSubsection)
+			for(sPred=firstSubsection;sPred->sibling!=sPtr;sPred=sPred->sibling)
+				;
+		
 		/* Remove the subsection: */
+		if(subsectionIndex!=0)
+			subsectionIndex->removeEntry(Name(sPtr->name));
+		--numSubsections;
 		if(sPred!=0)
 			sPred->sibling=sPtr->sibling;
 		else
@@ -156,40 +276,44 @@ void ConfigurationFileBase::Section::removeSubsection(const std::string& subsect
 		}
 	}
 
-void ConfigurationFileBase::Section::addTagValue(const std::string& newTag,const std::string& newValue)
+void ConfigurationFileBase::Section::setTagValue(const char* tag,size_t tagLength,const char* newValue,size_t newValueLength)
 	{
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::iterator tvIt;
-	for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=newTag;++tvIt)
-		;
+	/* Find the tag name in the section: */
+	std::list<TagValue>::iterator tvIt=findTag(tag,tagLength);
 	
 	/* Set tag value: */
 	if(tvIt==values.end())
 		{
 		/* Add a new tag/value pair: */
-		values.push_back(TagValue(newTag,newValue));
+		appendTagValue(tag,tagLength,newValue,newValueLength);
 		}
 	else
 		{
 		/* Set new value for existing tag/value pair: */
-		tvIt->value=newValue;
+		tvIt->value.assign(newValue,newValueLength);
 		}
 	
 	/* Mark the section as edited: */
 	edited=true;
 	}
 
+void ConfigurationFileBase::Section::addTagValue(const std::string& newTag,const std::string& newValue)
+	{
+	/* Set the tag value: */
+	setTagValue(newTag.data(),newTag.size(),newValue.data(),newValue.size());
+	}
+
 void ConfigurationFileBase::Section::removeTag(const std::string& tag)
 	{
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::iterator tvIt;
-	for(tvIt=values.begin();tvIt!=values.end()&&tvIt->tag!=tag;++tvIt)
-		;
+	/* Find the tag name in the section: */
+	std::list<TagValue>::iterator tvIt=findTag(tag.data(),tag.size());
 	
 	/* Check if the tag was found: */
 	if(tvIt!=values.end())
 		{
 		/* Remove tag/value pair: */
+		if(tagIndex!=0)
+			tagIndex->removeEntry(Name(tvIt->tag));
 		values.erase(tvIt);
 		}
 	
@@ -329,16 +453,13 @@ const ConfigurationFileBase::Section* ConfigurationFileBase::Section::getSection
 		else
 			{
 			/* Find subsection name in current section: */
-			std::string subsectionName(pathSuffixPtr,nextSlashPtr-pathSuffixPtr);
-			Section* ssPtr;
-			for(ssPtr=sPtr->firstSubsection;ssPtr!=0&&ssPtr->name!=subsectionName;ssPtr=ssPtr->sibling)
-				;
+			Section* ssPtr=sPtr->findSubsection(pathSuffixPtr,nextSlashPtr-pathSuffixPtr);
 			
 			/* Go down in the section hierarchy: */
 			if(ssPtr==0)
 				{
 				/* Can't add new section; must throw exception: */
-				throw SectionNotFoundError(__PRETTY_FUNCTION__,sPtr->getPath().c_str(),subsectionName.c_str());
+				throw SectionNotFoundError(__PRETTY_FUNCTION__,sPtr->getPath().c_str(),std::string(pathSuffixPtr,nextSlashPtr-pathSuffixPtr).c_str());
 				}
 			else
 				sPtr=ssPtr;
@@ -398,7 +519,8 @@ ConfigurationFileBase::Section* ConfigurationFileBase::Section::getSection(const
 		else
 			{
 			/* Go to subsection of given name (create if not already there): */
-			sPtr=sPtr->addSubsection(std::string(pathSuffixPtr,nextSlashPtr-pathSuffixPtr));
+			Section* ssPtr=sPtr->findSubsection(pathSuffixPtr,nextSlashPtr-pathSuffixPtr);
+			sPtr=ssPtr!=0?ssPtr:sPtr->addSubsection(std::string(pathSuffixPtr,nextSlashPtr-pathSuffixPtr));
 			}
 		
 		if(*nextSlashPtr=='\0')
@@ -416,12 +538,8 @@ bool ConfigurationFileBase::Section::hasTag(const char* relativeTagPath) const
 	const char* tagName=0;
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
-	
-	return tvIt!=sPtr->values.end();
+	/* Find the tag name in the section: */
+	return sPtr->findTag(tagName)!=0;
 	}
 
 const std::string* ConfigurationFileBase::Section::findTagValue(const char* relativeTagPath) const
@@ -430,13 +548,11 @@ const std::string* ConfigurationFileBase::Section::findTagValue(const char* rela
 	const char* tagName=0;
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	/* Find the tag name in the section: */
+	const TagValue* tvPtr=sPtr->findTag(tagName);
 	
 	/* Return tag value or null pointer: */
-	return tvIt!=sPtr->values.end()?&(tvIt->value):0;
+	return tvPtr!=0?&(tvPtr->value):0;
 	}
 
 const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath) const
@@ -445,15 +561,13 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 	const char* tagName=0;
 	const Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	/* Find the tag name in the section: */
+	const TagValue* tvPtr=sPtr->findTag(tagName);
 	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tvPtr==0)
 		throw TagNotFoundError(__PRETTY_FUNCTION__,sPtr->getPath().c_str(),tagName);
-	return tvIt->value;
+	return tvPtr->value;
 	}
 
 std::string ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath,const std::string& defaultValue) const
@@ -471,15 +585,13 @@ std::string ConfigurationFileBase::Section::retrieveTagValue(const char* relativ
 		return defaultValue;
 		}
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
-
+	/* Find the tag name in the section: */
+	const TagValue* tvPtr=sPtr->findTag(tagName);
+	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tvPtr==0)
 		throw TagNotFoundError(__PRETTY_FUNCTION__,sPtr->getPath().c_str(),tagName);
-	return tvIt->value;
+	return tvPtr->value;
 	}
 
 const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char* relativeTagPath,const std::string& defaultValue)
@@ -488,16 +600,14 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 	const char* tagName=0;
 	Section* sPtr=getSection(relativeTagPath,&tagName);
 	
-	/* Find the tag name in the section's tag list: */
-	std::list<TagValue>::const_iterator tvIt;
-	for(tvIt=sPtr->values.begin();tvIt!=sPtr->values.end()&&tvIt->tag!=tagName;++tvIt)
-		;
+	/* Find the tag name in the section: */
+	const TagValue* tvPtr=sPtr->findTag(tagName);
 	
 	/* Return tag value: */
-	if(tvIt==sPtr->values.end())
+	if(tvPtr==0)
 		{
 		/* Add a new tag/value pair: */
-		sPtr->values.push_back(TagValue(tagName,defaultValue));
+		sPtr->appendTagValue(tagName,strlen(tagName),defaultValue.data(),defaultValue.size());
 		
 		/* Mark section as edited: */
 		sPtr->edited=true;
@@ -505,7 +615,7 @@ const std::string& ConfigurationFileBase::Section::retrieveTagValue(const char*
 		return defaultValue;
 		}
 	else
-		return tvIt->value;
+		return tvPtr->value;
 	}
 
 void ConfigurationFileBase::Section::storeTagValue(const char* relativeTagPath,const std::string& newValue)
@@ -518,18 +628,313 @@ void ConfigurationFileBase::Section::storeTagValue(const char* relativeTagPath,c
 	sPtr->addTagValue(tagName,newValue);
 	}
 
+namespace {
+
+/*******************************************************************
+Helper classes and functions for compiled configuration file caches:
+*******************************************************************/
+
+enum MergeOpCode // Enumerated type for operations in compiled configuration files
+	{
+	MERGEOP_SECTION, // Enters a subsection of the current section; followed by the subsection name
+	MERGEOP_ENDSECTION, // Returns to the parent of the current section
+	MERGEOP_SETTAG, // Sets a tag value in the current section; followed by the tag name and value
+	MERGEOP_APPENDTAG, // Appends items to a list-valued tag in the current section; followed by the tag name and the items starting with an opening parenthesis
+	MERGEOP_REMOVETAG, // Removes a tag from the current section; followed by the tag name
+	MERGEOP_NUMOPCODES
+	};
+
+const int mergeOpNumStrings[MERGEOP_NUMOPCODES]={1,0,2,2,1}; // Number of strings following each operation code
+
+struct CacheHeader // Structure for headers of compiled configuration file caches
+	{
+	/* Elements: */
+	public:
+	char magic[8]; // Magic identifier
+	UInt32 version; // Version number of the compiled format, also serving as byte order mark
+	UInt32 sourcePathLength; // Length of the absolute path of the source configuration file, which follows the header
+	UInt64 sourceSize; // Size of the source configuration file in bytes
+	SInt64 sourceMTimeSec,sourceMTimeNsec; // Modification time of the source configuration file
+	UInt64 opsSize; // Size of the compiled operation stream, which follows the source file path
+	};
+
+const char cacheMagic[8]={'V','r','u','i','C','f','g','C'};
+const UInt32 cacheVersion=0x01020304U;
+
+inline void writeMergeOp(std::vector<char>& ops,MergeOpCode opCode,int lineNumber) // Appends an operation code and line number to a compiled operation stream
+	{
+	size_t opPos=ops.size();
+	ops.resize(opPos+1+sizeof(UInt32));
+	ops[opPos]=char(opCode);
+	UInt32 ln(lineNumber);
+	memcpy(ops.data()+opPos+1,&ln,sizeof(UInt32));
+	}
+
+inline void writeMergeOpString(std::vector<char>& ops,const char* begin,const char* end) // Appends a string to a compiled operation stream
+	{
+	size_t stringPos=ops.size();
+	UInt32 length(end-begin);
+	ops.resize(stringPos+sizeof(UInt32)+length);
+	memcpy(ops.data()+stringPos,&length,sizeof(UInt32));
+	memcpy(ops.data()+stringPos+sizeof(UInt32),begin,length);
+	}
+
+inline const char* readMergeOpUInt32(const char* opPtr,UInt32& value) // Reads an unaligned 32-bit unsigned integer from a compiled operation stream
+	{
+	memcpy(&value,opPtr,sizeof(UInt32));
+	return opPtr+sizeof(UInt32);
+	}
+
+bool validateMergeOps(const char* opsBegin,const char* opsEnd) // Returns true if the given compiled operation stream is structurally intact
+	{
+	const char* opPtr=opsBegin;
+	while(opPtr!=opsEnd)
+		{
+		/* Check the operation code and skip the line number: */
+		int opCode=(unsigned char)(*opPtr);
+		if(opCode>=MERGEOP_NUMOPCODES||size_t(opsEnd-opPtr)<1+sizeof(UInt32))
+			return false;
+		opPtr+=1+sizeof(UInt32);
+		
+		/* Skip the operation's strings: */
+		for(int i=0;i<mergeOpNumStrings[opCode];++i)
+			{
+			UInt32 length;
+			if(size_t(opsEnd-opPtr)<sizeof(UInt32))
+				return false;
+			opPtr=readMergeOpUInt32(opPtr,length);
+			if(size_t(opsEnd-opPtr)<length)
+				return false;
+			opPtr+=length;
+			}
+		}
+	
+	return true;
+	}
+
+bool getCacheInfo(const std::string& cacheDirectory,const char* fileName,CacheHeader& header,std::string& sourcePath,std::string& cacheFileName) // Fills in the cache header and names for the given source configuration file; returns false if the file can not be cached
+	{
+	/* Query the source file's size and modification time: */
+	struct stat sourceStat;
+	if(stat(fileName,&sourceStat)!=0||!S_ISREG(sourceStat.st_mode))
+		return false;
+	
+	/* Get the source file's absolute path: */
+	char* realPath=realpath(fileName,0);
+	if(realPath==0)
+		return false;
+	sourcePath=realPath;
+	free(realPath);
+	
+	/* Fill in the cache header: */
+	memcpy(header.magic,cacheMagic,sizeof(header.magic));
+	header.version=cacheVersion;
+	header.sourcePathLength=UInt32(sourcePath.size());
+	header.sourceSize=UInt64(sourceStat.st_size);
+	#ifdef __APPLE__
+	header.sourceMTimeSec=SInt64(sourceStat.st_mtimespec.tv_sec);
+	header.sourceMTimeNsec=SInt64(sourceStat.st_mtimespec.tv_nsec);
+	#else
+	header.sourceMTimeSec=SInt64(sourceStat.st_mtim.tv_sec);
+	header.sourceMTimeNsec=SInt64(sourceStat.st_mtim.tv_nsec);
+	#endif
+	header.opsSize=0;
+	
+	/* Name the cache file after a hash of the source file's absolute path: */
+	UInt64 pathHash=0;
+	for(std::string::iterator spIt=sourcePath.begin();spIt!=sourcePath.end();++spIt)
+		pathHash=pathHash*37+UInt64((unsigned char)(*spIt));
+	char cacheName[32];
+	snprintf(cacheName,sizeof(cacheName),"/%016llx.cfgc",(unsigned long long)(pathHash));
+	cacheFileName=cacheDirectory;
+	cacheFileName.append(cacheName);
+	
+	return true;
+	}
+
+class MappedCache // Class to map a compiled configuration file cache into memory if it is current
+	{
+	/* Elements: */
+	private:
+	void* base; // Base address of the mapped cache file, or null
+	size_t size; // Size of the mapped cache file
+	public:
+	bool valid; // Flag if the cache is current and intact
+	const char* opsBegin; // Beginning of the cache's compiled operation stream
+	const char* opsEnd; // End of the cache's compiled operation stream
+	
+	/* Constructors and destructors: */
+	MappedCache(const std::string& cacheFileName,const CacheHeader& header,const std::string& sourcePath)
+		:base(0),size(0),
+		 valid(false),opsBegin(0),opsEnd(0)
+		{
+		/* Map the cache file into memory: */
+		int fd=open(cacheFileName.c_str(),O_RDONLY);
+		if(fd<0)
+			return;
+		struct stat cacheStat;
+		if(fstat(fd,&cacheStat)==0&&size_t(cacheStat.st_size)>=sizeof(CacheHeader))
+			{
+			size=size_t(cacheStat.st_size);
+			base=mmap(0,size,PROT_READ,MAP_PRIVATE,fd,0);
+			if(base==MAP_FAILED)
+				base=0;
+			}
+		close(fd);
+		if(base==0)
+			return;
+		
+		/* Check that the cache was compiled from the current version of the source file: */
+		const char* data=static_cast<const char*>(base);
+		CacheHeader cacheHeader;
+		memcpy(&cacheHeader,data,sizeof(CacheHeader));
+		if(memcmp(cacheHeader.magic,header.magic,sizeof(header.magic))!=0||cacheHeader.version!=header.version)
+			return;
+		if(cacheHeader.sourceSize!=header.sourceSize||cacheHeader.sourceMTimeSec!=header.sourceMTimeSec||cacheHeader.sourceMTimeNsec!=header.sourceMTimeNsec)
+			return;
+		if(cacheHeader.sourcePathLength!=header.sourcePathLength||size-sizeof(CacheHeader)<cacheHeader.sourcePathLength||memcmp(data+sizeof(CacheHeader),sourcePath.data(),sourcePath.size())!=0)
+			return;
+		opsBegin=data+sizeof(CacheHeader)+cacheHeader.sourcePathLength;
+		opsEnd=data+size;
+		valid=cacheHeader.opsSize==UInt64(opsEnd-opsBegin)&&validateMergeOps(opsBegin,opsEnd);
+		}
+	~MappedCache(void)
+		{
+		if(base!=0)
+			munmap(base,size);
+		}
+	};
+
+bool writeFully(int fd,const void* data,size_t size) // Writes the given data block to the given file descriptor; returns false on error
+	{
+	const char* dPtr=static_cast<const char*>(data);
+	while(size>0)
+		{
+		ssize_t written=write(fd,dPtr,size);
+		if(written<0&&errno!=EINTR)
+			return false;
+		if(written>0)
+			{
+			dPtr+=written;
+			size-=size_t(written);
+			}
+		}
+	return true;
+	}
+
+void writeCache(const std::string& cacheFileName,const CacheHeader& header,const std::string& sourcePath,const std::vector<char>& ops) // Writes a compiled configuration file cache; silently gives up on errors
+	{
+	/* Write the cache into a temporary file and then replace the previous cache atomically: */
+	char pidSuffix[32];
+	snprintf(pidSuffix,sizeof(pidSuffix),".%d",int(getpid()));
+	std::string tempFileName=cacheFileName;
+	tempFileName.append(pidSuffix);
+	int fd=open(tempFileName.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0600);
+	if(fd<0)
+		return;
+	CacheHeader cacheHeader=header;
+	cacheHeader.opsSize=UInt64(ops.size());
+	bool ok=writeFully(fd,&cacheHeader,sizeof(CacheHeader));
+	ok=ok&&writeFully(fd,sourcePath.data(),sourcePath.size());
+	ok=ok&&writeFully(fd,ops.data(),ops.size());
+	ok=close(fd)==0&&ok;
+	if(!ok||rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+		unlink(tempFileName.c_str());
+	}
+
+}
+
 /**************************************
 Methods of class ConfigurationFileBase:
 **************************************/
 
+const char* ConfigurationFileBase::applyMergeOp(ConfigurationFileBase::Section*& sectionPtr,const char* opPtr,const char* mergeFileName)
+	{
+	/* Read the operation code and line number: */
+	int opCode=(unsigned char)(*opPtr);
+	UInt32 lineNumber;
+	opPtr=readMergeOpUInt32(opPtr+1,lineNumber);
+	
+	/* Read the operation's strings: */
+	const char* strings[2];
+	UInt32 stringLengths[2];
+	for(int i=0;i<mergeOpNumStrings[opCode];++i)
+		{
+		opPtr=readMergeOpUInt32(opPtr,stringLengths[i]);
+		strings[i]=opPtr;
+		opPtr+=stringLengths[i];
+		}
+	
+	switch(opCode)
+		{
+		case MERGEOP_SECTION:
+			{
+			/* Make the existing or a new subsection of the given name the current section: */
+			Section* ssPtr=sectionPtr->findSubsection(strings[0],stringLengths[0]);
+			sectionPtr=ssPtr!=0?ssPtr:sectionPtr->addSubsection(std::string(strings[0],stringLengths[0]));
+			break;
+			}
+		
+		case MERGEOP_ENDSECTION:
+			/* End the current section: */
+			if(sectionPtr->parent!=0)
+				sectionPtr=sectionPtr->parent;
+			else
+				throw MalformedConfigFileError(__PRETTY_FUNCTION__,"Extra endsection command",lineNumber,mergeFileName);
+			break;
+		
+		case MERGEOP_SETTAG:
+			/* Add a tag/value pair to the current section: */
+			sectionPtr->setTagValue(strings[0],stringLengths[0],strings[1],stringLengths[1]);
+			break;
+		
+		case MERGEOP_APPENDTAG:
+			{
+			/* Get the current tag value, defaulting to an empty list if the tag does not exist yet: */
+			std::string tag(strings[0],stringLengths[0]);
+			std::string currentValue=sectionPtr->retrieveTagValue(tag.c_str(),"()");
+			
+			/* Check that the current tag ends with a closing parenthesis, and the new tag value starts with an opening parenthesis: */
+			if(stringLengths[1]>0&&*strings[1]=='('&&!currentValue.empty()&&*(currentValue.end()-1)==')')
+				{
+				/* Concatenate the current and new tag values: */
+				currentValue.erase(currentValue.end()-1);
+				
+				/* Insert a list item separator if the current value is not the empty list: */
+				if(*(currentValue.end()-1)!='(')
+					currentValue.append(", ");
+				
+				currentValue.append(strings[1]+1,stringLengths[1]-1);
+				
+				/* Store the concatenated tag values: */
+				sectionPtr->addTagValue(tag,currentValue);
+				}
+			else
+				throw MalformedConfigFileError(__PRETTY_FUNCTION__,"+= operator used on non-list",lineNumber,mergeFileName);
+			break;
+			}
+		
+		case MERGEOP_REMOVETAG:
+			/* Remove the tag from the current section: */
+			sectionPtr->removeTag(std::string(strings[0],stringLengths[0]));
+			break;
+		}
+	
+	return opPtr;
+	}
+
+
 ConfigurationFileBase::ConfigurationFileBase(void)
 	:rootSection(new Section(0,std::string("")))
 	{
 	}
 
-ConfigurationFileBase::ConfigurationFileBase(const char* sFileName)
+ConfigurationFileBase::ConfigurationFileBase(const char* sFileName,const char* sCacheDirectory)
 	:rootSection(0)
 	{
+	/* Set the cache directory: */
+	setCacheDirectory(sCacheDirectory);
+	
 	/* Load the configuration file: */
 	load(sFileName);
 	}
@@ -539,6 +944,19 @@ ConfigurationFileBase::~ConfigurationFileBase(void)
 	delete rootSection;
 	}
 
+void ConfigurationFileBase::setCacheDirectory(const char* newCacheDirectory)
+	{
+	/* Disable caching by default: */
+	cacheDirectory.clear();
+	
+	if(newCacheDirectory!=0&&newCacheDirectory[0]!='\0')
+		{
+		/* Create the cache directory if it does not exist yet, and enable caching if it exists afterwards: */
+		if(mkdir(newCacheDirectory,0700)==0||errno==EEXIST)
+			cacheDirectory=newCacheDirectory;
+		}
+	}
+
 void ConfigurationFileBase::load(const char* newFileName)
 	{
 	/* Delete current configuration file contents: */
@@ -559,10 +977,29 @@ void ConfigurationFileBase::load(const char* newFileName)
 
 void ConfigurationFileBase::merge(const char* mergeFileName)
 	{
+	/* Check if the configuration file can be cached: */
+	CacheHeader cacheHeader;
+	std::string sourcePath,cacheFileName;
+	if(!cacheDirectory.empty()&&getCacheInfo(cacheDirectory,mergeFileName,cacheHeader,sourcePath,cacheFileName))
+		{
+		/* Check if there is a current compiled cache of the configuration file: */
+		MappedCache cache(cacheFileName,cacheHeader,sourcePath);
+		if(cache.valid)
+			{
+			/* Apply the configuration file's compiled operations: */
+			Section* sectionPtr=rootSection;
+			for(const char* opPtr=cache.opsBegin;opPtr!=cache.opsEnd;)
+				opPtr=applyMergeOp(sectionPtr,opPtr,mergeFileName);
+			
+			return;
+			}
+		}
+	
 	/* Try opening configuration file: */
 	File file(mergeFileName,"rt");
 	
-	/* Read configuration file contents: */
+	/* Read configuration file contents, compile each line into an operation, and apply the operation: */
+	std::vector<char> ops;
 	Section* sectionPtr=rootSection;
 	int lineNumber=0;
 	while(!file.eof())
@@ -635,6 +1072,11 @@ void ConfigurationFileBase::merge(const char* mergeFileName)
 		if(linePtr==lineEndPtr)
 			continue;
 		
+		/* Only keep the current line's operation if the compiled configuration file will not be cached: */
+		if(cacheFileName.empty())
+			ops.clear();
+		size_t opStart=ops.size();
+		
 		/* Extract first string from line: */
 		const char* decodeEnd;
 		std::string token=ValueCoder<std::string>::decode(linePtr,lineEndPtr,&decodeEnd);
@@ -660,15 +1102,13 @@ void ConfigurationFileBase::merge(const char* mergeFileName)
 			/* Add a new subsection to the current section and make it the current section: */
 			if(sectionName.empty())
 				throw MalformedConfigFileError(__PRETTY_FUNCTION__,"Missing section name after section command",lineNumber,mergeFileName);
-			sectionPtr=sectionPtr->addSubsection(sectionName);
+			writeMergeOp(ops,MERGEOP_SECTION,lineNumber);
+			writeMergeOpString(ops,sectionName.data(),sectionName.data()+sectionName.size());
 			}
 		else if(strcasecmp(token.c_str(),"endsection")==0)
 			{
 			/* End the current section: */
-			if(sectionPtr->parent!=0)
-				sectionPtr=sectionPtr->parent;
-			else
-				throw MalformedConfigFileError(__PRETTY_FUNCTION__,"Extra endsection command",lineNumber,mergeFileName);
+			writeMergeOp(ops,MERGEOP_ENDSECTION,lineNumber);
 			}
 		else if(linePtr!=lineEndPtr)
 			{
@@ -680,40 +1120,35 @@ void ConfigurationFileBase::merge(const char* mergeFileName)
 					;
 				if(linePtr!=lineEndPtr)
 					{
-					/* Get the current tag value, defaulting to an empty list if the tag does not exist yet: */
-					std::string currentValue=sectionPtr->retrieveTagValue(token.c_str(),"()");
-					
-					/* Check that the current tag ends with a closing parenthesis, and the new tag value starts with an opening parenthesis: */
-					if(*linePtr=='('&&*(currentValue.end()-1)==')')
-						{
-						/* Concatenate the current and new tag values: */
-						currentValue.erase(currentValue.end()-1);
-						
-						/* Insert a list item separator if the current value is not the empty list: */
-						if(*(currentValue.end()-1)!='(')
-							currentValue.append(", ");
-						
-						currentValue.append(std::string(linePtr+1,lineEndPtr));
-						
-						/* Store the concatenated tag values: */
-						sectionPtr->addTagValue(token,currentValue);
-						}
-					else
-						throw MalformedConfigFileError(__PRETTY_FUNCTION__,"+= operator used on non-list",lineNumber,mergeFileName);
+					/* Append the new tag value to the current tag value: */
+					writeMergeOp(ops,MERGEOP_APPENDTAG,lineNumber);
+					writeMergeOpString(ops,token.data(),token.data()+token.size());
+					writeMergeOpString(ops,linePtr,lineEndPtr);
 					}
 				}
 			else
 				{
 				/* Add a tag/value pair to the current section: */
-				sectionPtr->addTagValue(token,std::string(linePtr,lineEndPtr));
+				writeMergeOp(ops,MERGEOP_SETTAG,lineNumber);
+				writeMergeOpString(ops,token.data(),token.data()+token.size());
+				writeMergeOpString(ops,linePtr,lineEndPtr);
 				}
 			}
 		else
 			{
 			/* Remove the tag from the current section: */
-			sectionPtr->removeTag(token);
+			writeMergeOp(ops,MERGEOP_REMOVETAG,lineNumber);
+			writeMergeOpString(ops,token.data(),token.data()+token.size());
 			}
+		
+		/* Apply the compiled operation: */
+		if(ops.size()>opStart)
+			applyMergeOp(sectionPtr,ops.data()+opStart,mergeFileName);
 		}
+	
+	/* Cache the compiled configuration file if it was merged without errors: */
+	if(!cacheFileName.empty())
+		writeCache(cacheFileName,cacheHeader,sourcePath,ops);
 	}
 
 void ConfigurationFileBase::mergeCommandline(int& argc,char**& argv)
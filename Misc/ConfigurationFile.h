@@ -1,7 +1,7 @@
 /***********************************************************************
 ConfigurationFile - Class to handle permanent storage of configuration
 data in human-readable text files.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Miscellaneous Support Library (Misc).
 
@@ -24,10 +24,13 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef MISC_CONFIGURATIONFILE_INCLUDED
 #define MISC_CONFIGURATIONFILE_INCLUDED
 
+#include <stddef.h>
+#include <string.h>
 #include <list>
 #include <stdexcept>
 #include <string>
 #include <Misc/ValueCoder.h>
+#include <Misc/HashTable.h>
 
 /* Forward declarations: */
 namespace Misc {
@@ -83,24 +86,70 @@ class ConfigurationFileBase
 				:tag(sTag),value(sValue)
 				{
 				}
+			TagValue(const char* sTag,size_t sTagLength,const char* sValue,size_t sValueLength) // Ditto, from character ranges
+				:tag(sTag,sTagLength),value(sValue,sValueLength)
+				{
+				}
 			};
 		
+		class Name // Class referencing tag or subsection names stored elsewhere, to serve as hash table keys
+			{
+			/* Elements: */
+			public:
+			const char* chars; // Pointer to the name's first character
+			size_t length; // Length of the name
+			
+			/* Constructors and destructors: */
+			Name(const char* sChars,size_t sLength)
+				:chars(sChars),length(sLength)
+				{
+				}
+			Name(const std::string& sName)
+				:chars(sName.data()),length(sName.size())
+				{
+				}
+			
+			/* Methods: */
+			friend bool operator!=(const Name& n1,const Name& n2)
+				{
+				return n1.length!=n2.length||memcmp(n1.chars,n2.chars,n1.length)!=0;
+				}
+			static size_t hash(const Name& source,size_t tableSize); // Hash function for names
+			};
+		
+		typedef HashTable<Name,std::list<TagValue>::iterator,Name> TagIndex; // Hash table mapping tag names to their tag/value pairs
+		typedef HashTable<Name,Section*,Name> SubsectionIndex; // Hash table mapping subsection names to subsections
+		
 		/* Elements: */
+		static const size_t indexThreshold=16; // Number of subsections or tag/value pairs above which a section indexes them by name
 		Section* parent; // Pointer to parent section (null if root section)
 		std::string name; // Section name
 		Section* sibling; // Pointer to next section under common parent
 		Section* firstSubsection; // Pointer to first subsection
 		Section* lastSubsection; // Pointer to last subsection
+		size_t numSubsections; // Number of subsections
+		SubsectionIndex* subsectionIndex; // Index of subsections by name, or null if there are few subsections
 		std::list<TagValue> values; // List of values in this section
+		TagIndex* tagIndex; // Index of tag/value pairs by tag name, or null if there are few tag/value pairs
 		bool edited; // Flag if the section has been changed since the last save
 		
 		/* Constructors and destructors: */
 		Section(Section* sParent,const std::string& sName); // Creates an empty section
 		template <class PipeParam>
 		Section(Section* sParent,PipeParam& pipe); // Reads a section and its subsections from a pipe
+		private:
+		Section(const Section& source); // Prohibit copy constructor
+		Section& operator=(const Section& source); // Prohibit assignment operator
+		public:
 		~Section(void);
 		
 		/* Methods: */
+		Section* findSubsection(const char* subsectionName,size_t subsectionNameLength) const; // Returns the subsection of the given name, or null if the subsection does not exist
+		std::list<TagValue>::iterator findTag(const char* tag,size_t tagLength); // Returns an iterator to the tag/value pair of the given tag name, or the end of the tag list if the tag does not exist
+		const TagValue* findTag(const char* tag) const; // Returns the tag/value pair of the given tag name, or null if the tag does not exist
+		void appendSubsection(Section* newSubsection); // Appends the given new subsection to the section
+		void appendTagValue(const char* newTag,size_t newTagLength,const char* newValue,size_t newValueLength); // Appends a new tag/value pair for a tag that does not yet exist in the section
+		void setTagValue(const char* tag,size_t tagLength,const char* newValue,size_t newValueLength); // Sets the value of the given tag, adding a new tag/value pair if the tag does not exist
 		void clear(void); // Removes all subsections and tag/value pairs from the section
 		Section* addSubsection(const std::string& subsectionName); // Adds a subsection to a section
 		void removeSubsection(const std::string& subsectionName); // Removes the given subsection from the section; does nothing if subsection does not exist
@@ -389,11 +438,16 @@ class ConfigurationFileBase
 	protected:
 	std::string fileName; // File name of configuration file
 	Section* rootSection; // Pointer to root section of configuration file
+	std::string cacheDirectory; // Directory holding compiled binary caches of merged configuration files; caching is disabled if empty
+	
+	/* Private methods: */
+	private:
+	static const char* applyMergeOp(Section*& sectionPtr,const char* opPtr,const char* mergeFileName); // Applies the compiled merge operation at the given position to the given current section; returns pointer to the following operation
 	
 	/* Constructors and destructors: */
 	public:
 	ConfigurationFileBase(void); // Creates an empty unnamed configuration file
-	ConfigurationFileBase(const char* sFileName); // Opens an existing configuration file
+	ConfigurationFileBase(const char* sFileName,const char* sCacheDirectory =0); // Opens an existing configuration file, using compiled caches in the given directory if not null
 	template <class PipeParam>
 	ConfigurationFileBase(PipeParam& pipe); // Reads a configuration file from a pipe
 	private:
@@ -403,6 +457,11 @@ class ConfigurationFileBase
 	~ConfigurationFileBase(void);
 	
 	/* Methods: */
+	const std::string& getCacheDirectory(void) const // Returns the directory holding compiled configuration file caches
+		{
+		return cacheDirectory;
+		}
+	void setCacheDirectory(const char* newCacheDirectory); // Sets the directory in which to keep compiled binary caches of merged configuration files, which will be created if it does not exist; disables caching if null or empty
 	void load(const char* newFileName); // Loads contents of given configuration file
 	void reload(void) // Reloads contents of original configuration file
 		{
@@ -474,8 +533,8 @@ class ConfigurationFile:public ConfigurationFileBase,public ConfigurationFileBas
 		:ConfigurationFileBase::SectionValueCoder(rootSection)
 		{
 		}
-	ConfigurationFile(const char* sFileName) // Reads a configuration file from the given file
-		:ConfigurationFileBase(sFileName),
+	ConfigurationFile(const char* sFileName,const char* sCacheDirectory =0) // Reads a configuration file from the given file, using compiled caches in the given directory if not null
+		:ConfigurationFileBase(sFileName,sCacheDirectory),
 		 ConfigurationFileBase::SectionValueCoder(rootSection)
 		{
 		}
@@ -197,6 +197,14 @@ class RingBuffer
 		{
 		return *head;
 		}
+	const Entry& back(void) const // Returns the last entry; assumes the buffer is not empty
+		{
+		return tail!=buffer?tail[-1]:bufferEnd[-1];
+		}
+	Entry& back(void) // Ditto
+		{
+		return tail!=buffer?tail[-1]:bufferEnd[-1];
+		}
 	RingBuffer& clear(size_t resetBufferSize =0) // Clears the ring buffer; resets buffer to given size if !=0
 		{
 		/* Destroy all entries in place: */
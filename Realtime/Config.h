@@ -0,0 +1,29 @@
+/***********************************************************************
+Config - Configuration header file for Realtime Processing Library.
+Copyright (c) 2010-2014 Oliver Kreylos
+
+This file is part of the Realtime Processing Library (Realtime).
+
+The Realtime Processing Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Realtime Processing Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Realtime Processing Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef REALTIME_CONFIG_INCLUDED
+#define REALTIME_CONFIG_INCLUDED
+
+#define REALTIME_CONFIG_HAVE_POSIX_CLOCKS 1
+#define REALTIME_CONFIG_HAVE_POSIX_TIMERS 1
+
+#endif
@@ -0,0 +1,164 @@
+/***********************************************************************
+SharedStateRing - Class for rings of fixed-size state records in a block
+of POSIX shared memory that are written by a single process and can be
+read concurrently and without locks by any number of other processes,
+using a sequence lock on each slot to detect torn reads.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Realtime Processing Library (Realtime).
+
+The Realtime Processing Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Realtime Processing Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Realtime Processing Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Realtime/SharedStateRing.h>
+
+#include <string.h>
+#include <Misc/StdError.h>
+
+namespace Realtime {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline size_t alignToCacheLine(size_t size) // Rounds the given size up to the next multiple of the cache line size to prevent false sharing between slots
+	{
+	return (size+63)&~size_t(63);
+	}
+
+}
+
+/********************************
+Methods of class SharedStateRing:
+********************************/
+
+size_t SharedStateRing::getSlotSize(size_t stateSize)
+	{
+	return alignToCacheLine(SharedMemory::align(sizeof(SlotHeader))+stateSize);
+	}
+
+SharedStateRing::SharedStateRing(const char* name,unsigned int sNumSlots,size_t sStateSize)
+	:memory(name,alignToCacheLine(sizeof(Header))+size_t(sNumSlots)*getSlotSize(sStateSize)),
+	 header(memory.getValue<Header>(0)),
+	 slots(memory.getValue<char>(alignToCacheLine(sizeof(Header)))),
+	 numSlots(sNumSlots),stateSize(sStateSize),slotSize(getSlotSize(sStateSize)),
+	 writeIndex(0)
+	{
+	/* Check the ring layout: */
+	if(numSlots<2)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Shared state ring needs at least two slots");
+	
+	/* Initialize the ring header; the shared memory block is zero-filled on creation, which marks all slots as empty: */
+	header->numSlots=numSlots;
+	header->stateSize=(unsigned int)(stateSize);
+	header->slotSize=(unsigned int)(slotSize);
+	__atomic_store_n(&header->numStates,0U,__ATOMIC_RELEASE);
+	}
+
+SharedStateRing::SharedStateRing(int fd)
+	:memory(fd,false),
+	 header(memory.getValue<Header>(0)),
+	 slots(memory.getValue<char>(alignToCacheLine(sizeof(Header)))),
+	 numSlots(0),stateSize(0),slotSize(0),
+	 writeIndex(0)
+	{
+	/* Read and check the ring layout: */
+	if(memory.getSize()<alignToCacheLine(sizeof(Header)))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Shared memory block is too small to hold a shared state ring");
+	numSlots=header->numSlots;
+	stateSize=header->stateSize;
+	slotSize=header->slotSize;
+	if(numSlots<2||slotSize!=getSlotSize(stateSize)||memory.getSize()<alignToCacheLine(sizeof(Header))+size_t(numSlots)*slotSize)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Shared memory block does not contain a valid shared state ring");
+	}
+
+void* SharedStateRing::beginWrite(void)
+	{
+	/* Mark the slot receiving the next state as being written: */
+	SlotHeader* slot=getSlot(writeIndex);
+	__atomic_store_n(&slot->sequence,2U*writeIndex+1U,__ATOMIC_RELAXED);
+	
+	/* Prevent the following writes into the state record from being reordered before the sequence number update: */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	
+	return reinterpret_cast<char*>(slot)+SharedMemory::align(sizeof(SlotHeader));
+	}
+
+void SharedStateRing::finishWrite(const TimePointMonotonic& postTime)
+	{
+	/* Set the slot's posting time and mark the slot as completely written: */
+	SlotHeader* slot=getSlot(writeIndex);
+	slot->postTime=postTime;
+	__atomic_store_n(&slot->sequence,2U*writeIndex+2U,__ATOMIC_RELEASE);
+	
+	/* Publish the new state: */
+	++writeIndex;
+	__atomic_store_n(&header->numStates,writeIndex,__ATOMIC_RELEASE);
+	}
+
+void SharedStateRing::post(const void* state,const TimePointMonotonic& postTime)
+	{
+	memcpy(beginWrite(),state,stateSize);
+	finishWrite(postTime);
+	}
+
+unsigned int SharedStateRing::getNumStates(void) const
+	{
+	return __atomic_load_n(&header->numStates,__ATOMIC_ACQUIRE);
+	}
+
+bool SharedStateRing::read(unsigned int stateIndex,void* state,TimePointMonotonic* postTime) const
+	{
+	/* Check if the requested state has been published and not yet been recycled, using wrap-around arithmetic: */
+	unsigned int numStates=__atomic_load_n(&header->numStates,__ATOMIC_ACQUIRE);
+	if(numStates-stateIndex-1U>=numSlots)
+		return false;
+	
+	/* Check that the requested state's slot is not being overwritten: */
+	const SlotHeader* slot=getSlot(stateIndex);
+	unsigned int sequence=2U*stateIndex+2U;
+	if(__atomic_load_n(&slot->sequence,__ATOMIC_ACQUIRE)!=sequence)
+		return false;
+	
+	/* Copy the state record and posting time: */
+	memcpy(state,reinterpret_cast<const char*>(slot)+SharedMemory::align(sizeof(SlotHeader)),stateSize);
+	if(postTime!=0)
+		*postTime=TimePointMonotonic(slot->postTime);
+	
+	/* Check that the slot was not overwritten while it was copied: */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&slot->sequence,__ATOMIC_RELAXED)==sequence;
+	}
+
+bool SharedStateRing::readLatest(void* state,TimePointMonotonic* postTime) const
+	{
+	/* Keep trying until the most recent state could be read without interference: */
+	while(true)
+		{
+		/* Bail out if no states have been published yet: */
+		unsigned int numStates=__atomic_load_n(&header->numStates,__ATOMIC_ACQUIRE);
+		if(numStates==0)
+			return false;
+		
+		/* Try reading the most recent state; with more than one slot, the writer has to lap the entire ring to cause a retry: */
+		if(read(numStates-1U,state,postTime))
+			return true;
+		}
+	}
+
+}
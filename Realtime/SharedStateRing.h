@@ -0,0 +1,106 @@
+/***********************************************************************
+SharedStateRing - Class for rings of fixed-size state records in a block
+of POSIX shared memory that are written by a single process and can be
+read concurrently and without locks by any number of other processes,
+using a sequence lock on each slot to detect torn reads.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Realtime Processing Library (Realtime).
+
+The Realtime Processing Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Realtime Processing Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Realtime Processing Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef REALTIME_SHAREDSTATERING_INCLUDED
+#define REALTIME_SHAREDSTATERING_INCLUDED
+
+#include <stddef.h>
+#include <Realtime/Time.h>
+#include <Realtime/SharedMemory.h>
+
+namespace Realtime {
+
+class SharedStateRing
+	{
+	/* Embedded classes: */
+	private:
+	struct Header // Structure at the beginning of the shared memory block
+		{
+		/* Elements: */
+		public:
+		unsigned int numSlots; // Number of state slots in the ring
+		unsigned int stateSize; // Size of each state record in bytes
+		unsigned int slotSize; // Size of each slot including its slot header, in bytes
+		unsigned int numStates; // Number of states that have been completely written into the ring so far
+		};
+	
+	struct SlotHeader // Structure at the beginning of each slot
+		{
+		/* Elements: */
+		public:
+		unsigned int sequence; // Sequence number; 2*i+1 while state i is being written into the slot, 2*i+2 once it has been written completely
+		timespec postTime; // Monotonic time at which the state in the slot was posted
+		};
+	
+	/* Elements: */
+	private:
+	SharedMemory memory; // The shared memory block containing the ring
+	Header* header; // Pointer to the ring's header
+	char* slots; // Pointer to the first slot
+	unsigned int numSlots; // Number of slots in the ring, cached from the header
+	size_t stateSize; // Size of a state record, cached from the header
+	size_t slotSize; // Size of a slot, cached from the header
+	unsigned int writeIndex; // Index of the next state to be written; only used by writer
+	
+	/* Private methods: */
+	SlotHeader* getSlot(unsigned int stateIndex) const // Returns the slot that holds or will hold the state of the given index
+		{
+		return reinterpret_cast<SlotHeader*>(slots+size_t(stateIndex%numSlots)*slotSize);
+		}
+	static size_t getSlotSize(size_t stateSize); // Returns the size of a slot holding a state record of the given size
+	
+	/* Constructors and destructors: */
+	public:
+	SharedStateRing(const char* name,unsigned int sNumSlots,size_t sStateSize); // Creates a ring of the given number of slots for state records of the given size in a new named shared memory block, for writing
+	SharedStateRing(int fd); // Opens an existing ring in a shared memory block backed by a shared memory object of the given file descriptor, for reading; adopts the file descriptor
+	
+	/* Methods: */
+	int getFd(void) const // Returns the file descriptor of the underlying shared memory object
+		{
+		return memory.getFd();
+		}
+	unsigned int getNumSlots(void) const // Returns the number of states that can be retained in the ring
+		{
+		return numSlots;
+		}
+	size_t getStateSize(void) const // Returns the size of a state record in bytes
+		{
+		return stateSize;
+		}
+	
+	/* Writer interface; must only be used from one thread in one process: */
+	void* beginWrite(void); // Returns a pointer to the memory into which to write the next state record
+	void finishWrite(const TimePointMonotonic& postTime); // Publishes the state record written into the memory returned by the last beginWrite() call with the given posting time
+	void post(const void* state,const TimePointMonotonic& postTime); // Writes and publishes the given state record in one go
+	
+	/* Reader interface: */
+	unsigned int getNumStates(void) const; // Returns the number of states that have been published so far; the most recent state has index getNumStates()-1
+	bool read(unsigned int stateIndex,void* state,TimePointMonotonic* postTime =0) const; // Reads the state of the given index and optionally its posting time; returns false if the state has not been published yet or has already been overwritten
+	bool readLatest(void* state,TimePointMonotonic* postTime =0) const; // Reads the most recently published state and optionally its posting time; returns false if no state has been published yet
+	};
+
+}
+
+#endif
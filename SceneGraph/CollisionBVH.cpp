@@ -0,0 +1,185 @@
+/***********************************************************************
+CollisionBVH - Class for bounding volume hierarchies over sets of
+geometric primitives, to cull primitives before testing them against a
+sliding sphere.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/CollisionBVH.h>
+
+#include <algorithm>
+#include <Math/Math.h>
+#include <SceneGraph/SphereCollisionQuery.h>
+
+namespace SceneGraph {
+
+/***********************************************
+Embedded class CollisionBVH::CentroidComparator:
+***********************************************/
+
+struct CollisionBVH::CentroidComparator
+	{
+	/* Elements: */
+	public:
+	const std::vector<Point>& centroids; // Array of primitive bounding box centroids
+	int axis; // Axis along which to compare centroids
+	
+	/* Constructors and destructors: */
+	CentroidComparator(const std::vector<Point>& sCentroids,int sAxis)
+		:centroids(sCentroids),axis(sAxis)
+		{
+		}
+	
+	/* Methods: */
+	bool operator()(unsigned int p0,unsigned int p1) const
+		{
+		return centroids[p0][axis]<centroids[p1][axis];
+		}
+	};
+
+/*****************************
+Methods of class CollisionBVH:
+*****************************/
+
+unsigned int CollisionBVH::buildNode(const std::vector<Box>& primitiveBoxes,const std::vector<Point>& centroids,unsigned int begin,unsigned int end,Scalar outset)
+	{
+	/* Create a new node and calculate its bounding box and the bounding box of its primitives' centroids: */
+	unsigned int nodeIndex=(unsigned int)(nodes.size());
+	nodes.push_back(Node());
+	Box box=Box::empty;
+	Box centroidBox=Box::empty;
+	for(unsigned int i=begin;i<end;++i)
+		{
+		box.addBox(primitiveBoxes[primitives[i]]);
+		centroidBox.addPoint(centroids[primitives[i]]);
+		}
+	box.extrude(outset);
+	nodes[nodeIndex].box=box;
+	nodes[nodeIndex].primitivesBegin=begin;
+	nodes[nodeIndex].primitivesEnd=end;
+	nodes[nodeIndex].rightChild=0;
+	
+	/* Split the node if it has too many primitives and they can be separated: */
+	if(end-begin>maxLeafSize)
+		{
+		/* Find the longest axis of the centroids' bounding box: */
+		int splitAxis=0;
+		for(int i=1;i<3;++i)
+			if(centroidBox.getSize(splitAxis)<centroidBox.getSize(i))
+				splitAxis=i;
+		if(centroidBox.getSize(splitAxis)>Scalar(0))
+			{
+			/* Split the primitives at the median along the split axis: */
+			unsigned int mid=begin+(end-begin)/2;
+			std::nth_element(primitives.begin()+begin,primitives.begin()+mid,primitives.begin()+end,CentroidComparator(centroids,splitAxis));
+			
+			/* Build the left and right sub-hierarchies: */
+			buildNode(primitiveBoxes,centroids,begin,mid,outset);
+			unsigned int rightChild=buildNode(primitiveBoxes,centroids,mid,end,outset);
+			nodes[nodeIndex].rightChild=rightChild;
+			}
+		}
+	
+	return nodeIndex;
+	}
+
+void CollisionBVH::clear(void)
+	{
+	/* Release all nodes and primitives: */
+	std::vector<Node>().swap(nodes);
+	std::vector<unsigned int>().swap(primitives);
+	}
+
+void CollisionBVH::build(const std::vector<Box>& primitiveBoxes)
+	{
+	/* Clear the current hierarchy: */
+	nodes.clear();
+	primitives.clear();
+	if(primitiveBoxes.empty())
+		return;
+	
+	/* Calculate the primitives' centroids and the bounding box of all primitives: */
+	unsigned int numPrimitives=(unsigned int)(primitiveBoxes.size());
+	std::vector<Point> centroids;
+	centroids.reserve(numPrimitives);
+	Box bbox=Box::empty;
+	primitives.reserve(numPrimitives);
+	for(unsigned int i=0;i<numPrimitives;++i)
+		{
+		centroids.push_back(Geometry::mid(primitiveBoxes[i].min,primitiveBoxes[i].max));
+		bbox.addBox(primitiveBoxes[i]);
+		primitives.push_back(i);
+		}
+	
+	/* Calculate a box outset large enough to absorb rounding errors in box tests, relative to the magnitude of the primitives' coordinates: */
+	Scalar maxCoord(0);
+	for(int i=0;i<3;++i)
+		{
+		maxCoord=Math::max(maxCoord,Math::abs(bbox.min[i]));
+		maxCoord=Math::max(maxCoord,Math::abs(bbox.max[i]));
+		}
+	Scalar outset=maxCoord*Scalar(1.0e-5);
+	
+	/* Build the hierarchy recursively: */
+	nodes.reserve((numPrimitives/maxLeafSize+1)*2);
+	buildNode(primitiveBoxes,centroids,0,numPrimitives,outset);
+	}
+
+unsigned int CollisionBVH::findPrimitives(const SphereCollisionQuery& collisionQuery,unsigned int hitPrimitives[],unsigned int maxNumHitPrimitives) const
+	{
+	unsigned int numHitPrimitives=0;
+	if(nodes.empty())
+		return numHitPrimitives;
+	
+	/* Traverse the hierarchy depth-first using an explicit stack: */
+	unsigned int stack[128];
+	unsigned int stackSize=0;
+	stack[stackSize++]=0;
+	while(stackSize>0)
+		{
+		const Node& node=nodes[stack[--stackSize]];
+		
+		/* Skip the node if the sphere does not hit its bounding box: */
+		if(!collisionQuery.doesHitBox(node.box))
+			continue;
+		
+		if(node.rightChild!=0)
+			{
+			/* Descend into both children: */
+			stack[stackSize++]=node.rightChild;
+			stack[stackSize++]=(unsigned int)(&node-&nodes[0])+1;
+			}
+		else
+			{
+			/* Collect the leaf's primitives if they fit into the result array, but keep counting them if they don't: */
+			unsigned int numLeafPrimitives=node.primitivesEnd-node.primitivesBegin;
+			if(numHitPrimitives+numLeafPrimitives<=maxNumHitPrimitives)
+				std::copy(primitives.begin()+node.primitivesBegin,primitives.begin()+node.primitivesEnd,hitPrimitives+numHitPrimitives);
+			numHitPrimitives+=numLeafPrimitives;
+			}
+		}
+	
+	/* Sort the hit primitives so that callers can test them in their original order: */
+	if(numHitPrimitives<=maxNumHitPrimitives)
+		std::sort(hitPrimitives,hitPrimitives+numHitPrimitives);
+	
+	return numHitPrimitives;
+	}
+
+}
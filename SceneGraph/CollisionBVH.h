@@ -0,0 +1,80 @@
+/***********************************************************************
+CollisionBVH - Class for bounding volume hierarchies over sets of
+geometric primitives, to cull primitives before testing them against a
+sliding sphere.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_COLLISIONBVH_INCLUDED
+#define SCENEGRAPH_COLLISIONBVH_INCLUDED
+
+#include <vector>
+#include <Geometry/Box.h>
+#include <SceneGraph/Geometry.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class SphereCollisionQuery;
+}
+
+namespace SceneGraph {
+
+class CollisionBVH
+	{
+	/* Embedded classes: */
+	private:
+	struct Node // Structure for hierarchy nodes, stored in depth-first order
+		{
+		/* Elements: */
+		public:
+		Box box; // Bounding box of all primitives below the node, slightly outset to guard against rounding in box tests
+		unsigned int primitivesBegin,primitivesEnd; // Range of the node's primitives in the permuted primitive index array
+		unsigned int rightChild; // Index of the node's right child; the left child immediately follows the node; 0 for leaf nodes
+		};
+	
+	struct CentroidComparator; // Functor class to sort primitives by the positions of their bounding box centroids along one axis
+	
+	/* Elements: */
+	public:
+	static const unsigned int maxLeafSize=8; // Maximum number of primitives in a leaf node
+	private:
+	std::vector<Node> nodes; // The hierarchy's nodes; the root node is the first node
+	std::vector<unsigned int> primitives; // Primitive indices, permuted such that each node's primitives are contiguous
+	
+	/* Private methods: */
+	unsigned int buildNode(const std::vector<Box>& primitiveBoxes,const std::vector<Point>& centroids,unsigned int begin,unsigned int end,Scalar outset); // Recursively builds the sub-hierarchy for the given range of primitives; returns index of sub-hierarchy's root node
+	
+	/* Methods: */
+	public:
+	bool empty(void) const // Returns true if the hierarchy contains no primitives
+		{
+		return nodes.empty();
+		}
+	size_t getNumNodes(void) const // Returns the number of nodes in the hierarchy
+		{
+		return nodes.size();
+		}
+	void clear(void); // Removes all primitives from the hierarchy
+	void build(const std::vector<Box>& primitiveBoxes); // Builds the hierarchy for a set of primitives given by their bounding boxes; primitives are identified by their indices in the given array
+	unsigned int findPrimitives(const SphereCollisionQuery& collisionQuery,unsigned int hitPrimitives[],unsigned int maxNumHitPrimitives) const; // Writes the indices of all primitives whose bounding boxes are hit by the given query based on its current collision state into the given caller-owned array of the given size, in ascending order; returns the number of hit primitives, which exceeds the array size and leaves the array's contents undefined if the array was too small
+	};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+/***********************************************************************
+Config - Configuration header file for the Simple Scene Graph Renderer.
+Copyright (c) 2020-2022 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_CONFIG_INCLUDED
+#define SCENEGRAPH_CONFIG_INCLUDED
+
+#define SCENEGRAPH_CONFIG_SHADERDIR "/usr/local/share/Vrui-14.1/Shaders/SceneGraph"
+#define SCENEGRAPH_CONFIG_HAVE_FANCYTEXT 0
+
+#define SCENEGRAPH_CONFIG_FONTDIR "/usr/share/fonts/gnu-free/"
+
+#define SCENEGRAPH_CONFIG_FONT_SANS_PLAIN "FreeSans.ttf"
+#define SCENEGRAPH_CONFIG_FONT_SANS_BOLD "FreeSansBold.ttf"
+#define SCENEGRAPH_CONFIG_FONT_SANS_ITALIC "FreeSansOblique.ttf"
+#define SCENEGRAPH_CONFIG_FONT_SANS_BOLDITALIC "FreeSansBoldOblique.ttf"
+
+#define SCENEGRAPH_CONFIG_FONT_SERIF_PLAIN "FreeSerif.ttf"
+#define SCENEGRAPH_CONFIG_FONT_SERIF_BOLD "FreeSerifBold.ttf"
+#define SCENEGRAPH_CONFIG_FONT_SERIF_ITALIC "FreeSerifItalic.ttf"
+#define SCENEGRAPH_CONFIG_FONT_SERIF_BOLDITALIC "FreeSerifBoldItalic.ttf"
+
+#define SCENEGRAPH_CONFIG_FONT_TYPEWRITER_PLAIN "FreeMono.ttf"
+#define SCENEGRAPH_CONFIG_FONT_TYPEWRITER_BOLD "FreeMonoBold.ttf"
+#define SCENEGRAPH_CONFIG_FONT_TYPEWRITER_ITALIC "FreeMonoOblique.ttf"
+#define SCENEGRAPH_CONFIG_FONT_TYPEWRITER_BOLDITALIC "FreeMonoBoldOblique.ttf"
+
+#endif
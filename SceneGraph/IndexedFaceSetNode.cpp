@@ -1,7 +1,7 @@
 /***********************************************************************
 IndexedFaceSetNode - Class for sets of polygonal faces as renderable
 geometry.
-Copyright (c) 2009-2023 Oliver Kreylos
+Copyright (c) 2009-2026 Oliver Kreylos
 
 This file is part of the Simple Scene Graph Renderer (SceneGraph).
 
@@ -131,296 +131,265 @@ bool pointInFace(const Geometry::PrimaryPlaneProjector<Scalar>& ppp,const Geomet
 	return inside;
 	}
 
-}
-
-void IndexedFaceSetNode::testCollisionSolidCcw(SphereCollisionQuery& collisionQuery) const
+struct SolidCcwFaceTest // Functor class to test a sphere against a single face of a solid face set with counter-clockwise face winding order
 	{
-	/* Retrieve query parameters: */
-	const Point& c0=collisionQuery.getC0();
-	const Vector& c0c1=collisionQuery.getC0c1();
-	Scalar radius=collisionQuery.getRadius();
-	
-	/* Get a handle to the face set's vertex coordinates and vertex indices: */
-	const MFPoint::ValueList& coords=coord.getValue()->point.getValues();
-	const MFInt::ValueList& coordIndices=coordIndex.getValues();
-	
-	/* Test the sphere against all faces: */
-	for(MFInt::ValueList::const_iterator ciIt=coordIndices.begin();ciIt!=coordIndices.end();)
+	/* Methods: */
+	public:
+	static void test(SphereCollisionQuery& collisionQuery,const MFPoint::ValueList& coords,MFInt::ValueList::const_iterator ciIt,MFInt::ValueList::const_iterator faceEnd)
 		{
-		/* Find the end of the current face's vertex list: */
-		MFInt::ValueList::const_iterator faceEnd;
-		for(faceEnd=ciIt;faceEnd!=coordIndices.end()&&*faceEnd>=0;++faceEnd)
-			;
+		/* Retrieve query parameters: */
+		const Point& c0=collisionQuery.getC0();
+		const Vector& c0c1=collisionQuery.getC0c1();
+		Scalar radius=collisionQuery.getRadius();
 		
-		/* Check if the face has at least three vertices: */
-		if(faceEnd-ciIt>=3)
+		/* Calculate the plane equation defined by the first three vertices: */
+		Point center=coords[*ciIt];
+		Vector normal=triangleNormal(center,coords[*(ciIt+1)],coords[*(ciIt+2)]);
+		
+		/* Test the sphere against the face's plane: */
+		Scalar denominator=c0c1*normal;
+		Scalar offset=(c0-center)*normal;
+		if(denominator<Scalar(0)&&offset>=Scalar(0))
 			{
-			/* Calculate the plane equation defined by the first three vertices: */
-			Point center=coords[*ciIt];
-			Vector normal=triangleNormal(center,coords[*(ciIt+1)],coords[*(ciIt+2)]);
-			
-			/* Test the sphere against the face's plane: */
-			Scalar denominator=c0c1*normal;
-			Scalar offset=(c0-center)*normal;
-			if(denominator<Scalar(0)&&offset>=Scalar(0))
+			/* Calculate the intersection of the sphere's path with the face's plane: */
+			Scalar normalSqr=normal.sqr();
+			Scalar normalMag=Math::sqrt(normalSqr);
+			Scalar counter=radius*normalMag-offset;
+			Scalar lambda=counter<Scalar(0)?counter/denominator:Scalar(0); // Take care of the case where the sphere is already penetrating the face
+			if(lambda<collisionQuery.getHitLambda())
 				{
-				/* Calculate the intersection of the sphere's path with the face's plane: */
-				Scalar normalSqr=normal.sqr();
-				Scalar normalMag=Math::sqrt(normalSqr);
-				Scalar counter=radius*normalMag-offset;
-				Scalar lambda=counter<Scalar(0)?counter/denominator:Scalar(0); // Take care of the case where the sphere is already penetrating the face
-				if(lambda<collisionQuery.getHitLambda())
+				/* Calculate the point where the sphere hits the face's plane and project it to 2D: */
+				Point hit3=c0;
+				if(lambda>Scalar(0))
+					hit3.addScaled(c0c1,lambda).subtractScaled(normal,radius/normalMag);
+				else
+					hit3.subtractScaled(normal,offset/normalSqr);
+				Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
+				Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
+				
+				/* Check if the intersection point is inside the face: */
+				bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
+				if(inside)
 					{
-					/* Calculate the point where the sphere hits the face's plane and project it to 2D: */
-					Point hit3=c0;
-					if(lambda>Scalar(0))
-						hit3.addScaled(c0c1,lambda).subtractScaled(normal,radius/normalMag);
-					else
-						hit3.subtractScaled(normal,offset/normalSqr);
-					Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
-					Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
-					
-					/* Check if the intersection point is inside the face: */
-					bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
-					if(inside)
-						{
-						/* This is the actual collision: */
-						collisionQuery.update(lambda,normal);
-						}
-					else
+					/* This is the actual collision: */
+					collisionQuery.update(lambda,normal);
+					}
+				else
+					{
+					/* Test the face's vertices and edges: */
+					MFInt::ValueList::const_iterator it0=faceEnd-2;
+					Geometry::PrimaryPlaneProjector<Scalar>::Point2 v0=ppp.project(coords[*it0]);
+					MFInt::ValueList::const_iterator it1=faceEnd-1;
+					Geometry::PrimaryPlaneProjector<Scalar>::Point2 v1=ppp.project(coords[*it1]);
+					bool testE0=(hit[0]-v0[0])*(v1[1]-v0[1])>(hit[1]-v0[1])*(v1[0]-v0[0]);
+					for(MFInt::ValueList::const_iterator it2=ciIt;it2!=faceEnd;it0=it1,it1=it2,++it2)
 						{
-						/* Test the face's vertices and edges: */
-						MFInt::ValueList::const_iterator it0=faceEnd-2;
-						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v0=ppp.project(coords[*it0]);
-						MFInt::ValueList::const_iterator it1=faceEnd-1;
-						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v1=ppp.project(coords[*it1]);
-						bool testE0=(hit[0]-v0[0])*(v1[1]-v0[1])>(hit[1]-v0[1])*(v1[0]-v0[0]);
-						for(MFInt::ValueList::const_iterator it2=ciIt;it2!=faceEnd;it0=it1,it1=it2,++it2)
+						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v2=ppp.project(coords[*it2]);
+						bool testE1=(hit[0]-v1[0])*(v2[1]-v1[1])>(hit[1]-v1[1])*(v2[0]-v1[0]);
+						
+						/* Test the edge and the vertex if the hit point is outside of it: */
+						if(testE1)
 							{
-							Geometry::PrimaryPlaneProjector<Scalar>::Point2 v2=ppp.project(coords[*it2]);
-							bool testE1=(hit[0]-v1[0])*(v2[1]-v1[1])>(hit[1]-v1[1])*(v2[0]-v1[0]);
-							
-							/* Test the edge and the vertex if the hit point is outside of it: */
-							if(testE1)
-								{
-								collisionQuery.testEdgeAndUpdate(coords[*it1],coords[*it2]);
-								collisionQuery.testVertexAndUpdate(coords[*it1]);
-								}
-							else if(testE0)
-								collisionQuery.testVertexAndUpdate(coords[*it1]);
-							
-							v1=v2;
-							testE0=testE1;
+							collisionQuery.testEdgeAndUpdate(coords[*it1],coords[*it2]);
+							collisionQuery.testVertexAndUpdate(coords[*it1]);
 							}
+						else if(testE0)
+							collisionQuery.testVertexAndUpdate(coords[*it1]);
+						
+						v1=v2;
+						testE0=testE1;
 						}
 					}
 				}
 			}
-		
-		/* Go to the next face: */
-		if(faceEnd!=coordIndices.end())
-			++faceEnd;
-		ciIt=faceEnd;
 		}
-	}
+	};
 
-void IndexedFaceSetNode::testCollisionSolidCw(SphereCollisionQuery& collisionQuery) const
+struct SolidCwFaceTest // Functor class to test a sphere against a single face of a solid face set with clockwise face winding order
 	{
-	/* Retrieve query parameters: */
-	const Point& c0=collisionQuery.getC0();
-	const Vector& c0c1=collisionQuery.getC0c1();
-	Scalar radius=collisionQuery.getRadius();
-	
-	/* Get a handle to the face set's vertex coordinates and vertex indices: */
-	const MFPoint::ValueList& coords=coord.getValue()->point.getValues();
-	const MFInt::ValueList& coordIndices=coordIndex.getValues();
-	
-	/* Test the sphere against all faces: */
-	for(MFInt::ValueList::const_iterator ciIt=coordIndices.begin();ciIt!=coordIndices.end();)
+	/* Methods: */
+	public:
+	static void test(SphereCollisionQuery& collisionQuery,const MFPoint::ValueList& coords,MFInt::ValueList::const_iterator ciIt,MFInt::ValueList::const_iterator faceEnd)
 		{
-		/* Find the end of the current face's vertex list: */
-		MFInt::ValueList::const_iterator faceEnd;
-		for(faceEnd=ciIt;faceEnd!=coordIndices.end()&&*faceEnd>=0;++faceEnd)
-			;
+		/* Retrieve query parameters: */
+		const Point& c0=collisionQuery.getC0();
+		const Vector& c0c1=collisionQuery.getC0c1();
+		Scalar radius=collisionQuery.getRadius();
 		
-		/* Check if the face has at least three vertices: */
-		if(faceEnd-ciIt>=3)
+		/* Calculate the plane equation defined by the first three vertices: */
+		Point center=coords[*ciIt];
+		Vector normal=triangleNormal(center,coords[*(ciIt+2)],coords[*(ciIt+1)]);
+		
+		/* Test the sphere against the face's plane: */
+		Scalar denominator=c0c1*normal;
+		Scalar offset=(c0-center)*normal;
+		if(denominator<Scalar(0)&&offset>=Scalar(0))
 			{
-			/* Calculate the plane equation defined by the first three vertices: */
-			Point center=coords[*ciIt];
-			Vector normal=triangleNormal(center,coords[*(ciIt+2)],coords[*(ciIt+1)]);
-			
-			/* Test the sphere against the face's plane: */
-			Scalar denominator=c0c1*normal;
-			Scalar offset=(c0-center)*normal;
-			if(denominator<Scalar(0)&&offset>=Scalar(0))
+			/* Calculate the intersection of the sphere's path with the face's plane: */
+			Scalar normalSqr=normal.sqr();
+			Scalar normalMag=Math::sqrt(normalSqr);
+			Scalar counter=radius*normalMag-offset;
+			Scalar lambda=counter<Scalar(0)?counter/denominator:Scalar(0); // Take care of the case where the sphere is already penetrating the face
+			if(lambda<collisionQuery.getHitLambda())
 				{
-				/* Calculate the intersection of the sphere's path with the face's plane: */
-				Scalar normalSqr=normal.sqr();
-				Scalar normalMag=Math::sqrt(normalSqr);
-				Scalar counter=radius*normalMag-offset;
-				Scalar lambda=counter<Scalar(0)?counter/denominator:Scalar(0); // Take care of the case where the sphere is already penetrating the face
-				if(lambda<collisionQuery.getHitLambda())
+				/* Calculate the point where the sphere hits the face's plane and project it to 2D: */
+				Point hit3=c0;
+				if(lambda>Scalar(0))
+					hit3.addScaled(c0c1,lambda).subtractScaled(normal,radius/normalMag);
+				else
+					hit3.subtractScaled(normal,offset/normalSqr);
+				Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
+				Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
+				
+				/* Check if the intersection point is inside the face: */
+				bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
+				if(inside)
 					{
-					/* Calculate the point where the sphere hits the face's plane and project it to 2D: */
-					Point hit3=c0;
-					if(lambda>Scalar(0))
-						hit3.addScaled(c0c1,lambda).subtractScaled(normal,radius/normalMag);
-					else
-						hit3.subtractScaled(normal,offset/normalSqr);
-					Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
-					Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
-					
-					/* Check if the intersection point is inside the face: */
-					bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
-					if(inside)
-						{
-						/* This is the actual collision: */
-						collisionQuery.update(lambda,normal);
-						}
-					else
+					/* This is the actual collision: */
+					collisionQuery.update(lambda,normal);
+					}
+				else
+					{
+					/* Test the face's vertices and edges: */
+					MFInt::ValueList::const_iterator it0=faceEnd-2;
+					Geometry::PrimaryPlaneProjector<Scalar>::Point2 v0=ppp.project(coords[*it0]);
+					MFInt::ValueList::const_iterator it1=faceEnd-1;
+					Geometry::PrimaryPlaneProjector<Scalar>::Point2 v1=ppp.project(coords[*it1]);
+					bool testE0=(hit[0]-v0[0])*(v1[1]-v0[1])<(hit[1]-v0[1])*(v1[0]-v0[0]);
+					for(MFInt::ValueList::const_iterator it2=ciIt;it2!=faceEnd;it0=it1,it1=it2,++it2)
 						{
-						/* Test the face's vertices and edges: */
-						MFInt::ValueList::const_iterator it0=faceEnd-2;
-						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v0=ppp.project(coords[*it0]);
-						MFInt::ValueList::const_iterator it1=faceEnd-1;
-						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v1=ppp.project(coords[*it1]);
-						bool testE0=(hit[0]-v0[0])*(v1[1]-v0[1])<(hit[1]-v0[1])*(v1[0]-v0[0]);
-						for(MFInt::ValueList::const_iterator it2=ciIt;it2!=faceEnd;it0=it1,it1=it2,++it2)
+						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v2=ppp.project(coords[*it2]);
+						bool testE1=(hit[0]-v1[0])*(v2[1]-v1[1])<(hit[1]-v1[1])*(v2[0]-v1[0]);
+						
+						/* Test the edge and the vertex if the hit point is outside of it: */
+						if(testE1)
 							{
-							Geometry::PrimaryPlaneProjector<Scalar>::Point2 v2=ppp.project(coords[*it2]);
-							bool testE1=(hit[0]-v1[0])*(v2[1]-v1[1])<(hit[1]-v1[1])*(v2[0]-v1[0]);
-							
-							/* Test the edge and the vertex if the hit point is outside of it: */
-							if(testE1)
-								{
-								collisionQuery.testEdgeAndUpdate(coords[*it1],coords[*it2]);
-								collisionQuery.testVertexAndUpdate(coords[*it1]);
-								}
-							else if(testE0)
-								collisionQuery.testVertexAndUpdate(coords[*it1]);
-							
-							v1=v2;
-							testE0=testE1;
+							collisionQuery.testEdgeAndUpdate(coords[*it1],coords[*it2]);
+							collisionQuery.testVertexAndUpdate(coords[*it1]);
 							}
+						else if(testE0)
+							collisionQuery.testVertexAndUpdate(coords[*it1]);
+						
+						v1=v2;
+						testE0=testE1;
 						}
 					}
 				}
 			}
-		
-		/* Go to the next face: */
-		if(faceEnd!=coordIndices.end())
-			++faceEnd;
-		ciIt=faceEnd;
 		}
-	}
+	};
 
-void IndexedFaceSetNode::testCollisionNonSolid(SphereCollisionQuery& collisionQuery) const
+struct NonSolidFaceTest // Functor class to test a sphere against a single face of a non-solid face set
 	{
-	/* Retrieve query parameters: */
-	const Point& c0=collisionQuery.getC0();
-	const Vector& c0c1=collisionQuery.getC0c1();
-	Scalar radius=collisionQuery.getRadius();
-	
-	/* Get a handle to the face set's vertex coordinates and vertex indices: */
-	const MFPoint::ValueList& coords=coord.getValue()->point.getValues();
-	const MFInt::ValueList& coordIndices=coordIndex.getValues();
-	
-	/* Test the sphere against all faces: */
-	for(MFInt::ValueList::const_iterator ciIt=coordIndices.begin();ciIt!=coordIndices.end();)
+	/* Methods: */
+	public:
+	static void test(SphereCollisionQuery& collisionQuery,const MFPoint::ValueList& coords,MFInt::ValueList::const_iterator ciIt,MFInt::ValueList::const_iterator faceEnd)
 		{
-		/* Find the end of the current face's vertex list: */
-		MFInt::ValueList::const_iterator faceEnd;
-		for(faceEnd=ciIt;faceEnd!=coordIndices.end()&&*faceEnd>=0;++faceEnd)
-			;
+		/* Retrieve query parameters: */
+		const Point& c0=collisionQuery.getC0();
+		const Vector& c0c1=collisionQuery.getC0c1();
+		Scalar radius=collisionQuery.getRadius();
 		
-		/* Check if the face has at least three vertices: */
-		if(faceEnd-ciIt>=3)
+		/* Calculate the plane equation defined by the first three vertices: */
+		Point center=coords[*ciIt];
+		Vector normal=triangleNormal(center,coords[*(ciIt+1)],coords[*(ciIt+2)]);
+		
+		/* Test the sphere against the slab containing the face's plane: */
+		Scalar normalSqr=normal.sqr();
+		Scalar normalMag=Math::sqrt(normalSqr);
+		Scalar offset=(c0-center)*normal;
+		Scalar radiusNormal=radius*normalMag;
+		if(Math::abs(offset)>radiusNormal) // Sphere's starting point is outside the slab
 			{
-			/* Calculate the plane equation defined by the first three vertices: */
-			Point center=coords[*ciIt];
-			Vector normal=triangleNormal(center,coords[*(ciIt+1)],coords[*(ciIt+2)]);
-			
-			/* Test the sphere against the slab containing the face's plane: */
-			Scalar normalSqr=normal.sqr();
-			Scalar normalMag=Math::sqrt(normalSqr);
-			Scalar offset=(c0-center)*normal;
-			Scalar radiusNormal=radius*normalMag;
-			if(Math::abs(offset)>radiusNormal) // Sphere's starting point is outside the slab
-				{
-				Scalar denominator=c0c1*normal;
-				Scalar slabOffset=Math::copysign(radiusNormal,offset);
-				Scalar lambda=(slabOffset-offset)/denominator;
-				if(lambda>=Scalar(0)&&lambda<collisionQuery.getHitLambda())
-					{
-					/* Calculate the point where the sphere hits the face's plane and project it to 2D: */
-					Point hit3=Geometry::addScaled(c0,c0c1,lambda).subtractScaled(normal,Math::copysign(radius,offset)/normalMag);
-					Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
-					Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
-					
-					/* Check if the intersection point is inside the face: */
-					bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
-					if(inside)
-						{
-						/* This is the actual collision: */
-						collisionQuery.update(lambda,offset>Scalar(0)?normal:-normal);
-						}
-					else
-						{
-						/* Test the face's vertices and edges: */
-						MFInt::ValueList::const_iterator it0=faceEnd-2;
-						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v0=ppp.project(coords[*it0]);
-						MFInt::ValueList::const_iterator it1=faceEnd-1;
-						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v1=ppp.project(coords[*it1]);
-						bool testE0=(hit[0]-v0[0])*(v1[1]-v0[1])>(hit[1]-v0[1])*(v1[0]-v0[0]);
-						for(MFInt::ValueList::const_iterator it2=ciIt;it2!=faceEnd;it0=it1,it1=it2,++it2)
-							{
-							Geometry::PrimaryPlaneProjector<Scalar>::Point2 v2=ppp.project(coords[*it2]);
-							bool testE1=(hit[0]-v1[0])*(v2[1]-v1[1])>(hit[1]-v1[1])*(v2[0]-v1[0]);
-							
-							/* Test the edge and the vertex if the hit point is outside of it: */
-							if(testE1)
-								{
-								collisionQuery.testEdgeAndUpdate(coords[*it1],coords[*it2]);
-								collisionQuery.testVertexAndUpdate(coords[*it1]);
-								}
-							else if(testE0)
-								collisionQuery.testVertexAndUpdate(coords[*it1]);
-							
-							v1=v2;
-							testE0=testE1;
-							}
-						}
-					}
-				}
-			else // Sphere's starting point is inside the slab
+			Scalar denominator=c0c1*normal;
+			Scalar slabOffset=Math::copysign(radiusNormal,offset);
+			Scalar lambda=(slabOffset-offset)/denominator;
+			if(lambda>=Scalar(0)&&lambda<collisionQuery.getHitLambda())
 				{
-				/* Check if the sphere's starting point is inside the face: */
-				Point hit3=Geometry::subtractScaled(c0,normal,offset/normalSqr);
+				/* Calculate the point where the sphere hits the face's plane and project it to 2D: */
+				Point hit3=Geometry::addScaled(c0,c0c1,lambda).subtractScaled(normal,Math::copysign(radius,offset)/normalMag);
 				Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
 				Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
+				
+				/* Check if the intersection point is inside the face: */
 				bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
 				if(inside)
 					{
-					/* Check if the sphere is attempting to penetrate deeper into the face: */
-					if(collisionQuery.getHitLambda()>Scalar(0)&&(c0c1*normal)*offset<Scalar(0))
-						{
-						/* Prevent further movement: */
-						collisionQuery.update(Scalar(0),offset>Scalar(0)?normal:-normal);
-						}
+					/* This is the actual collision: */
+					collisionQuery.update(lambda,offset>Scalar(0)?normal:-normal);
 					}
 				else
 					{
 					/* Test the face's vertices and edges: */
-					MFInt::ValueList::const_iterator it0=faceEnd-1;
-					for(MFInt::ValueList::const_iterator it1=ciIt;it1!=faceEnd;it0=it1,++it1)
+					MFInt::ValueList::const_iterator it0=faceEnd-2;
+					Geometry::PrimaryPlaneProjector<Scalar>::Point2 v0=ppp.project(coords[*it0]);
+					MFInt::ValueList::const_iterator it1=faceEnd-1;
+					Geometry::PrimaryPlaneProjector<Scalar>::Point2 v1=ppp.project(coords[*it1]);
+					bool testE0=(hit[0]-v0[0])*(v1[1]-v0[1])>(hit[1]-v0[1])*(v1[0]-v0[0]);
+					for(MFInt::ValueList::const_iterator it2=ciIt;it2!=faceEnd;it0=it1,it1=it2,++it2)
 						{
-						collisionQuery.testVertexAndUpdate(coords[*it1]);
-						collisionQuery.testEdgeAndUpdate(coords[*it0],coords[*it1]);
+						Geometry::PrimaryPlaneProjector<Scalar>::Point2 v2=ppp.project(coords[*it2]);
+						bool testE1=(hit[0]-v1[0])*(v2[1]-v1[1])>(hit[1]-v1[1])*(v2[0]-v1[0]);
+						
+						/* Test the edge and the vertex if the hit point is outside of it: */
+						if(testE1)
+							{
+							collisionQuery.testEdgeAndUpdate(coords[*it1],coords[*it2]);
+							collisionQuery.testVertexAndUpdate(coords[*it1]);
+							}
+						else if(testE0)
+							collisionQuery.testVertexAndUpdate(coords[*it1]);
+						
+						v1=v2;
+						testE0=testE1;
 						}
 					}
 				}
 			}
+		else // Sphere's starting point is inside the slab
+			{
+			/* Check if the sphere's starting point is inside the face: */
+			Point hit3=Geometry::subtractScaled(c0,normal,offset/normalSqr);
+			Geometry::PrimaryPlaneProjector<Scalar> ppp(normal);
+			Geometry::PrimaryPlaneProjector<Scalar>::Point2 hit=ppp.project(hit3);
+			bool inside=pointInFace(ppp,hit,coords,ciIt,faceEnd);
+			if(inside)
+				{
+				/* Check if the sphere is attempting to penetrate deeper into the face: */
+				if(collisionQuery.getHitLambda()>Scalar(0)&&(c0c1*normal)*offset<Scalar(0))
+					{
+					/* Prevent further movement: */
+					collisionQuery.update(Scalar(0),offset>Scalar(0)?normal:-normal);
+					}
+				}
+			else
+				{
+				/* Test the face's vertices and edges: */
+				MFInt::ValueList::const_iterator it0=faceEnd-1;
+				for(MFInt::ValueList::const_iterator it1=ciIt;it1!=faceEnd;it0=it1,++it1)
+					{
+					collisionQuery.testVertexAndUpdate(coords[*it1]);
+					collisionQuery.testEdgeAndUpdate(coords[*it0],coords[*it1]);
+					}
+				}
+			}
+		}
+	};
+
+template <class FaceTestParam>
+inline
+void testAllFaces(SphereCollisionQuery& collisionQuery,const MFPoint::ValueList& coords,const MFInt::ValueList& coordIndices) // Tests the sphere against all valid faces in the given face vertex index array
+	{
+	for(MFInt::ValueList::const_iterator ciIt=coordIndices.begin();ciIt!=coordIndices.end();)
+		{
+		/* Find the end of the current face's vertex list: */
+		MFInt::ValueList::const_iterator faceEnd;
+		for(faceEnd=ciIt;faceEnd!=coordIndices.end()&&*faceEnd>=0;++faceEnd)
+			;
+		
+		/* Check if the face has at least three vertices: */
+		if(faceEnd-ciIt>=3)
+			FaceTestParam::test(collisionQuery,coords,ciIt,faceEnd);
 		
 		/* Go to the next face: */
 		if(faceEnd!=coordIndices.end())
@@ -429,6 +398,24 @@ void IndexedFaceSetNode::testCollisionNonSolid(SphereCollisionQuery& collisionQu
 		}
 	}
 
+template <class FaceTestParam>
+inline
+void testSelectedFaces(SphereCollisionQuery& collisionQuery,const MFPoint::ValueList& coords,const MFInt::ValueList& coordIndices,const std::vector<unsigned int>& faceStarts,const unsigned int* facesBegin,const unsigned int* facesEnd) // Tests the sphere against the given valid faces, identified by their indices in the given array of face start indices
+	{
+	for(const unsigned int* fIt=facesBegin;fIt!=facesEnd;++fIt)
+		{
+		/* Find the end of the face's vertex list: */
+		MFInt::ValueList::const_iterator ciIt=coordIndices.begin()+faceStarts[*fIt];
+		MFInt::ValueList::const_iterator faceEnd;
+		for(faceEnd=ciIt;faceEnd!=coordIndices.end()&&*faceEnd>=0;++faceEnd)
+			;
+		
+		FaceTestParam::test(collisionQuery,coords,ciIt,faceEnd);
+		}
+	}
+
+}
+
 namespace {
 
 /**************
@@ -1627,6 +1614,9 @@ void IndexedFaceSetNode::update(void)
 			}
 		}
 	
+	/* Rebuild the collision hierarchy: */
+	buildCollisionBVH();
+	
 	/* Bump up the indexed face set's version number: */
 	++version;
 	}
@@ -1697,6 +1687,97 @@ Box IndexedFaceSetNode::calcBoundingBox(void) const
 	return bbox;
 	}
 
+void IndexedFaceSetNode::buildCollisionBVH(void)
+	{
+	/* Clear the collision hierarchy if there is no geometry or there are too few faces to benefit from culling: */
+	collisionFaceStarts.clear();
+	if(coord.getValue()==0||numValidFaces<size_t(CollisionBVH::maxLeafSize)*8U)
+		{
+		collisionBVH.clear();
+		return;
+		}
+	
+	/* Get a handle to the face set's vertex coordinates and vertex indices: */
+	const MFPoint::ValueList& coords=coord.getValue()->point.getValues();
+	const MFInt::ValueList& coordIndices=coordIndex.getValues();
+	
+	/* Collect the start indices and bounding boxes of all valid faces: */
+	collisionFaceStarts.reserve(numValidFaces);
+	std::vector<Box> faceBoxes;
+	faceBoxes.reserve(numValidFaces);
+	for(MFInt::ValueList::const_iterator ciIt=coordIndices.begin();ciIt!=coordIndices.end();)
+		{
+		/* Find the end of the current face's vertex list: */
+		MFInt::ValueList::const_iterator faceEnd;
+		for(faceEnd=ciIt;faceEnd!=coordIndices.end()&&*faceEnd>=0;++faceEnd)
+			;
+		
+		/* Check if the face has at least three vertices: */
+		if(faceEnd-ciIt>=3)
+			{
+			collisionFaceStarts.push_back((unsigned int)(ciIt-coordIndices.begin()));
+			Box faceBox=Box::empty;
+			for(MFInt::ValueList::const_iterator fvIt=ciIt;fvIt!=faceEnd;++fvIt)
+				faceBox.addPoint(coords[*fvIt]);
+			
+			/* Non-planar faces are tested inside the plane through their first three vertices, which can extend beyond their vertices; add the points on that plane that project to the remaining vertices: */
+			if(faceEnd-ciIt>3)
+				{
+				const Point& center=coords[*ciIt];
+				Vector normal=triangleNormal(center,coords[*(ciIt+1)],coords[*(ciIt+2)]);
+				int pAxis=Geometry::findParallelAxis(normal);
+				if(normal[pAxis]!=Scalar(0))
+					for(MFInt::ValueList::const_iterator fvIt=ciIt+3;fvIt!=faceEnd;++fvIt)
+						{
+						Point planePoint=coords[*fvIt];
+						planePoint[pAxis]-=((planePoint-center)*normal)/normal[pAxis];
+						faceBox.addPoint(planePoint);
+						}
+				}
+			faceBoxes.push_back(faceBox);
+			}
+		
+		/* Go to the next face: */
+		if(faceEnd!=coordIndices.end())
+			++faceEnd;
+		ciIt=faceEnd;
+		}
+	
+	/* Build the collision hierarchy: */
+	collisionBVH.build(faceBoxes);
+	}
+
+template <class FaceTestParam>
+inline
+void IndexedFaceSetNode::testCollisionFaces(SphereCollisionQuery& collisionQuery) const
+	{
+	/* Get a handle to the face set's vertex coordinates and vertex indices: */
+	const MFPoint::ValueList& coords=coord.getValue()->point.getValues();
+	const MFInt::ValueList& coordIndices=coordIndex.getValues();
+	
+	/* Test all faces directly if there are too few to benefit from culling: */
+	if(collisionBVH.empty())
+		{
+		testAllFaces<FaceTestParam>(collisionQuery,coords,coordIndices);
+		return;
+		}
+	
+	/* Cull faces against the collision hierarchy based on the query's initial collision state into a buffer on the stack: */
+	unsigned int hitFaceBuffer[maxNumStackHitFaces];
+	unsigned int numHitFaces=collisionBVH.findPrimitives(collisionQuery,hitFaceBuffer,maxNumStackHitFaces);
+	
+	/* Test the remaining faces in face set order, which yields the same collision result as testing all faces: */
+	if(numHitFaces<=maxNumStackHitFaces)
+		testSelectedFaces<FaceTestParam>(collisionQuery,coords,coordIndices,collisionFaceStarts,hitFaceBuffer,hitFaceBuffer+numHitFaces);
+	else
+		{
+		/* Cull faces again into a large enough buffer on the heap; this only happens for very long or very large spheres: */
+		std::vector<unsigned int> hitFaces(numHitFaces);
+		collisionBVH.findPrimitives(collisionQuery,&hitFaces[0],numHitFaces);
+		testSelectedFaces<FaceTestParam>(collisionQuery,coords,coordIndices,collisionFaceStarts,&hitFaces[0],&hitFaces[0]+numHitFaces);
+		}
+	}
+
 void IndexedFaceSetNode::testCollision(SphereCollisionQuery& collisionQuery) const
 	{
 	/* Bail out if the sphere does not hit the face set's bounding box: */
@@ -1707,12 +1788,12 @@ void IndexedFaceSetNode::testCollision(SphereCollisionQuery& collisionQuery) con
 	if(solid.getValue())
 		{
 		if(ccw.getValue())
-			testCollisionSolidCcw(collisionQuery);
+			testCollisionFaces<SolidCcwFaceTest>(collisionQuery);
 		else
-			testCollisionSolidCw(collisionQuery);
+			testCollisionFaces<SolidCwFaceTest>(collisionQuery);
 		}
 	else
-		testCollisionNonSolid(collisionQuery);
+		testCollisionFaces<NonSolidFaceTest>(collisionQuery);
 	}
 
 void IndexedFaceSetNode::glRenderAction(int appearanceRequirementMask,GLRenderState& renderState) const
@@ -1,7 +1,7 @@
 /***********************************************************************
 IndexedFaceSetNode - Class for sets of polygonal faces as renderable
 geometry.
-Copyright (c) 2009-2023 Oliver Kreylos
+Copyright (c) 2009-2026 Oliver Kreylos
 
 This file is part of the Simple Scene Graph Renderer (SceneGraph).
 
@@ -23,12 +23,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_INDEXEDFACESETNODE_INCLUDED
 #define SCENEGRAPH_INDEXEDFACESETNODE_INCLUDED
 
+#include <vector>
 #include <Misc/Autopointer.h>
 #include <Geometry/Box.h>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/GeometryNode.h>
+#include <SceneGraph/CollisionBVH.h>
 #include <SceneGraph/ColorNode.h>
 #include <SceneGraph/CoordinateNode.h>
 #include <SceneGraph/NormalNode.h>
@@ -96,11 +98,16 @@ class IndexedFaceSetNode:public GeometryNode,public GLObject
 	size_t totalNumTriangles; // Total number of triangles defined by the indexed face set, assuming trivial triangulation
 	unsigned int version; // Version number of face set
 	
-	/* Private methods: */
+	/* Collision acceleration state, rebuilt by update() so that concurrent collision queries do not modify the node: */
 	private:
-	void testCollisionSolidCcw(SphereCollisionQuery& collisionQuery) const; // Collision test for solid face set with counter-clockwise face winding order
-	void testCollisionSolidCw(SphereCollisionQuery& collisionQuery) const; // Collision test for solid face set with clockwise face winding order
-	void testCollisionNonSolid(SphereCollisionQuery& collisionQuery) const; // Collision test for non-solid face set
+	static const unsigned int maxNumStackHitFaces=1024; // Maximum number of culled faces collected on the stack during a collision query before falling back to a heap buffer
+	std::vector<unsigned int> collisionFaceStarts; // Indices of the first vertices of all valid faces in the coordIndex array, in face order
+	CollisionBVH collisionBVH; // Bounding volume hierarchy over the face set's valid faces; empty if there are too few faces to benefit from culling
+	
+	/* Private methods: */
+	void buildCollisionBVH(void); // Builds the collision hierarchy for the current face set if it has enough faces to benefit from culling
+	template <class FaceTestParam>
+	void testCollisionFaces(SphereCollisionQuery& collisionQuery) const; // Tests the sphere against the face set's valid faces using the given per-face collision test, culling faces using the collision hierarchy if there are enough of them
 	
 	/* Protected methods: */
 	protected:
@@ -29,6 +29,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <Threads/Config.h>
+#if THREADS_CONFIG_HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
 #include <stdexcept>
 #include <Misc/StdError.h>
 #include <Misc/MessageLogger.h>
@@ -152,12 +156,8 @@ class EventDispatcher::IOEventImpl:public EventDispatcher::IOEvent
 		if(removed)
 			return;
 		
-		/* Update the dispatcher's file descriptor sets: */
-		dispatcher.updateFdSets(lIt->fd,lIt->typeMask,0x0);
-		
 		/* Remove the current listener from the list: */
-		*lIt=dispatcher.ioEventListeners.back();
-		dispatcher.ioEventListeners.pop_back();
+		dispatcher.removeIOEventListenerInternal(lIt);
 		
 		/* Continue with the listener that replaced the current one: */
 		nextLIt=lIt;
@@ -176,7 +176,7 @@ class EventDispatcher::IOEventImpl:public EventDispatcher::IOEvent
 	virtual void setEventTypeMask(int newEventTypeMask)
 		{
 		/* Update the dispatcher's file descriptor sets: */
-		dispatcher.updateFdSets(lIt->fd,lIt->typeMask,newEventTypeMask);
+		dispatcher.updateFdSets(lIt->key,lIt->fd,lIt->typeMask,newEventTypeMask);
 		
 		/* Update the current listener: */
 		lIt->typeMask=newEventTypeMask;
@@ -518,8 +518,73 @@ void EventDispatcher::writePipeMessage(const EventDispatcher::PipeMessage& pm,co
 		}
 	}
 
-void EventDispatcher::updateFdSets(int fd,int oldEventMask,int newEventMask)
+#if THREADS_CONFIG_HAVE_EPOLL
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const uint64_t epollPipeKey=~uint64_t(0); // epoll user data identifying the self-pipe; cannot collide with any listener key
+
+inline uint32_t getEpollEvents(int eventTypeMask) // Converts an event type mask to a set of epoll event flags
+	{
+	uint32_t result=0x0U;
+	if(eventTypeMask&EventDispatcher::Read)
+		result|=EPOLLIN|EPOLLRDHUP;
+	if(eventTypeMask&EventDispatcher::Write)
+		result|=EPOLLOUT;
+	if(eventTypeMask&EventDispatcher::Exception)
+		result|=EPOLLPRI;
+	return result;
+	}
+
+inline int getEventTypeMask(uint32_t epollEvents) // Converts a set of epoll event flags to an event type mask as select() would have reported it
+	{
+	int result=0x0;
+	if(epollEvents&(EPOLLIN|EPOLLRDHUP|EPOLLHUP|EPOLLERR)) // select() reports end-of-file and errors as readability
+		result|=EventDispatcher::Read;
+	if(epollEvents&(EPOLLOUT|EPOLLERR))
+		result|=EventDispatcher::Write;
+	if(epollEvents&EPOLLPRI)
+		result|=EventDispatcher::Exception;
+	return result;
+	}
+
+}
+
+#endif
+
+void EventDispatcher::updateFdSets(EventDispatcher::ListenerKey key,int fd,int oldEventMask,int newEventMask)
 	{
+	#if THREADS_CONFIG_HAVE_EPOLL
+	if(backend==EPoll)
+		{
+		/* Update the epoll interest list; file descriptors with empty event masks are not registered: */
+		struct epoll_event event;
+		event.events=getEpollEvents(newEventMask);
+		event.data.u64=key;
+		if(oldEventMask==0x0&&newEventMask!=0x0)
+			{
+			if(epoll_ctl(epollFd,EPOLL_CTL_ADD,fd,&event)<0)
+				throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot watch file descriptor %d",fd);
+			}
+		else if(oldEventMask!=0x0&&newEventMask==0x0)
+			{
+			/* Ignore errors; the file descriptor might already have been closed, which removes it from the interest list automatically: */
+			epoll_ctl(epollFd,EPOLL_CTL_DEL,fd,&event);
+			}
+		else if(oldEventMask!=newEventMask)
+			{
+			if(epoll_ctl(epollFd,EPOLL_CTL_MOD,fd,&event)<0)
+				throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot change watched events on file descriptor %d",fd);
+			}
+		
+		return;
+		}
+	#endif
+	
 	/* Check if the read set needs to be updated: */
 	if((oldEventMask^newEventMask)&Read)
 		{
@@ -587,18 +652,311 @@ void EventDispatcher::updateFdSets(int fd,int oldEventMask,int newEventMask)
 		}
 	}
 
-EventDispatcher::EventDispatcher(void)
+void EventDispatcher::addIOEventListenerInternal(const EventDispatcher::IOEventListener& newListener)
+	{
+	/* Add the new listener to the end of the list: */
+	ioEventListeners.push_back(newListener);
+	
+	try
+		{
+		/* Update the file descriptor sets: */
+		updateFdSets(newListener.key,newListener.fd,0x0,newListener.typeMask);
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Remove the listener again and report the error: */
+		ioEventListeners.pop_back();
+		Misc::sourcedUserError(__PRETTY_FUNCTION__,"Cannot add I/O event listener due to exception %s",err.what());
+		return;
+		}
+	
+	/* Remember the new listener's position in the list: */
+	if(backend==EPoll)
+		ioEventListenerIndices.setEntry(IOEventListenerIndexMap::Entry(newListener.key,ioEventListeners.size()-1));
+	}
+
+void EventDispatcher::removeIOEventListenerInternal(std::vector<EventDispatcher::IOEventListener>::iterator listenerIt)
+	{
+	/* Update the file descriptor sets: */
+	updateFdSets(listenerIt->key,listenerIt->fd,listenerIt->typeMask,0x0);
+	
+	/* Replace the listener with the last listener in the list: */
+	if(backend==EPoll)
+		{
+		ioEventListenerIndices.removeEntry(listenerIt->key);
+		if(listenerIt+1!=ioEventListeners.end())
+			ioEventListenerIndices.setEntry(IOEventListenerIndexMap::Entry(ioEventListeners.back().key,listenerIt-ioEventListeners.begin()));
+		}
+	*listenerIt=ioEventListeners.back();
+	ioEventListeners.pop_back();
+	}
+
+bool EventDispatcher::handlePipeMessages(const EventDispatcher::Time& dispatchTime)
+	{
+	/* Read and handle pipe messages: */
+	size_t numMessages=readPipeMessages();
+	PipeMessage* pmPtr=messages;
+	for(size_t i=0;i<numMessages;++i,++pmPtr)
+		{
+		switch(pmPtr->messageType)
+			{
+			case PipeMessage::INTERRUPT: // Interrupt wait
+				
+				/* Do nothing */
+				
+				break;
+			
+			case PipeMessage::STOP: // Stop dispatching events
+				return false;
+				break;
+			
+			case PipeMessage::ADD_IO_LISTENER: // Add input/output event listener
+				
+				/* Add the new input/output event listener to the list: */
+				addIOEventListenerInternal(IOEventListener(pmPtr->addIOListener.key,pmPtr->addIOListener.fd,pmPtr->addIOListener.typeMask,pmPtr->addIOListener.callback,pmPtr->addIOListener.callbackUserData));
+				
+				break;
+			
+			case PipeMessage::SET_IO_LISTENER_TYPEMASK: // Change the event type mask of an input/output event listener
+				
+				/* Find the input/output event listener with the given key: */
+				for(std::vector<IOEventListener>::iterator elIt=ioEventListeners.begin();elIt!=ioEventListeners.end();++elIt)
+					if(elIt->key==pmPtr->setIOListenerEventTypeMask.key)
+						{
+						/* Update the input/output event listener: */
+						int typeMask=elIt->typeMask;
+						elIt->typeMask=pmPtr->setIOListenerEventTypeMask.newTypeMask;
+						
+						/* Update the file descriptor sets: */
+						updateFdSets(elIt->key,elIt->fd,typeMask,elIt->typeMask);
+						
+						/* Stop looking: */
+						break;
+						}
+				
+				break;
+			
+			case PipeMessage::REMOVE_IO_LISTENER: // Remove input/output event listener
+				
+				/* Find the input/output event listener with the given key: */
+				for(std::vector<IOEventListener>::iterator elIt=ioEventListeners.begin();elIt!=ioEventListeners.end();++elIt)
+					if(elIt->key==pmPtr->removeIOListener)
+						{
+						/* Remove the input/output event listener from the list: */
+						removeIOEventListenerInternal(elIt);
+						
+						/* Stop looking: */
+						break;
+						}
+				
+				break;
+			
+			case PipeMessage::ADD_TIMER_LISTENER: // Add timer event listener
+				{
+				/* Create a new timer event listener in the map: */
+				TimerEventListenerMap::Iterator telIt=timerEventListeners.setAndFindEntry(TimerEventListenerMap::Entry(pmPtr->addTimerListener.key,TimerEventListener(pmPtr->addTimerListener.key,pmPtr->addTimerListener.time,pmPtr->addTimerListener.interval,pmPtr->addTimerListener.callback,pmPtr->addTimerListener.callbackUserData)));
+				telIt->getDest().suspended=pmPtr->addTimerListener.startSuspended;
+				
+				/* Add the just-created timer event listener to the heap if it is not suspended: */
+				if(!telIt->getDest().suspended)
+					timerEventListenerHeap.insert(&telIt->getDest());
+				
+				break;
+				}
+			
+			case PipeMessage::SUSPEND_TIMER_LISTENER: // Suspend timer event listener
+				{
+				/* Find the timer event listener with the given key: */
+				TimerEventListener* tel=&timerEventListeners.getEntry(pmPtr->suspendTimerListener).getDest();
+				
+				/* Remove the timer event listener from the heap if it is not already suspended: */
+				if(!tel->suspended)
+					{
+					for(TimerEventListenerHeap::Iterator elIt=timerEventListenerHeap.begin();elIt!=timerEventListenerHeap.end();++elIt)
+						if(*elIt==tel)
+							{
+							/* Remove the timer event listener from the heap: */
+							timerEventListenerHeap.remove(elIt);
+							
+							/* Stop looking: */
+							break;
+							}
+					}
+				
+				/* Mark the timer event listener as suspended: */
+				tel->suspended=true;
+				
+				break;
+				}
+			
+			case PipeMessage::RESUME_TIMER_LISTENER: // Resume timer event listener
+				{
+				/* Find the timer event listener with the given key: */
+				TimerEventListener* tel=&timerEventListeners.getEntry(pmPtr->resumeTimerListener.key).getDest();
+				
+				/* Update and add the timer event listener to the heap if it is currently suspended: */
+				if(tel->suspended)
+					{
+					tel->time=pmPtr->resumeTimerListener.time;
+					timerEventListenerHeap.insert(tel);
+					}
+				
+				/* Mark the timer event listener as active: */
+				tel->suspended=false;
+				
+				break;
+				}
+			
+			case PipeMessage::REMOVE_TIMER_LISTENER: // Remove timer event listener
+				{
+				/* Find the timer event listener with the given key: */
+				TimerEventListenerMap::Iterator telIt=timerEventListeners.findEntry(pmPtr->removeTimerListener);
+				if(telIt.isFinished())
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Timer event listener key not found in hash table");
+				TimerEventListener* tel=&telIt->getDest();
+				
+				/* Remove the timer event listener from the heap if it is not suspended: */
+				if(!tel->suspended)
+					{
+					for(TimerEventListenerHeap::Iterator elIt=timerEventListenerHeap.begin();elIt!=timerEventListenerHeap.end();++elIt)
+						if(*elIt==tel)
+							{
+							/* Remove the timer event listener from the heap: */
+							timerEventListenerHeap.remove(elIt);
+							
+							/* Stop looking: */
+							break;
+							}
+					}
+				
+				/* Remove the timer event listener from the map: */
+				timerEventListeners.removeEntry(telIt);
+				
+				break;
+				}
+			
+			case PipeMessage::ADD_PROCESS_LISTENER:
+				
+				/* Add the new process listener to the list: */
+				processListeners.push_back(ProcessListener(pmPtr->addProcessListener.key,pmPtr->addProcessListener.callback,pmPtr->addProcessListener.callbackUserData));
+				
+				break;
+			
+			case PipeMessage::REMOVE_PROCESS_LISTENER:
+				
+				/* Find the process listener with the given key: */
+				for(std::vector<ProcessListener>::iterator plIt=processListeners.begin();plIt!=processListeners.end();++plIt)
+					if(plIt->key==pmPtr->removeProcessListener)
+						{
+						/* Remove the process listener from the list: */
+						*plIt=processListeners.back();
+						processListeners.pop_back();
+						
+						/* Stop looking: */
+						break;
+						}
+				
+				break;
+			
+			case PipeMessage::ADD_SIGNAL_LISTENER:
+				
+				/* Add the new signal listener to the map: */
+				signalListeners.setEntry(SignalListenerMap::Entry(pmPtr->addSignalListener.key,SignalListener(pmPtr->addSignalListener.key,pmPtr->addSignalListener.callback,pmPtr->addSignalListener.callbackUserData)));
+				
+				break;
+			
+			case PipeMessage::REMOVE_SIGNAL_LISTENER:
+				
+				/* Remove the signal listener with the given key from the map: */
+				signalListeners.removeEntry(pmPtr->removeSignalListener);
+				
+				break;
+			
+			case PipeMessage::SIGNAL:
+				{
+				/* Find the signal listener with the given key in the map: */
+				SignalListenerMap::Iterator slIt=signalListeners.findEntry(pmPtr->signal.key);
+				if(slIt.isFinished())
+					throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Signal event listener key not found");
+				SignalListener& sl=slIt->getDest();
+				
+				/* Call the signal callback: */
+				SignalEventImpl signalEvent(dispatchTime,*this);
+				try
+					{
+					signalEvent.key=sl.key;
+					signalEvent.userData=sl.callbackUserData;
+					signalEvent.signalData=pmPtr->signal.signalData;
+					signalEvent.lIt=slIt;
+					sl.callback(signalEvent);
+					}
+				catch(const std::runtime_error& err)
+					{
+					// DEBUGGING
+					Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Exception %s in signal callback",err.what());
+					
+					/* Remove the event listener that caused the exception: */
+					signalEvent.removeListener();
+					}
+				
+				break;
+				}
+				
+			default:
+				/* Do nothing: */
+				
+				// DEBUGGING
+				Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Unknown pipe message %d",pmPtr->messageType);
+			}
+		}
+	
+	return true;
+	}
+
+EventDispatcher::EventDispatcher(EventDispatcher::Backend sBackend)
 	:numMessages(4096/sizeof(PipeMessage)),messages(new PipeMessage[numMessages]),messageReadSize(0),
 	 nextKey(0),
 	 timerEventListeners(17),signalListeners(17),
 	 numReadFds(0),numWriteFds(0),numExceptionFds(0),
-	 hadBadFd(false)
+	 hadBadFd(false),
+	 backend(sBackend),epollFd(-1),
+	 ioEventListenerIndices(17),
+	 maxNumEpollEvents(0),epollEvents(0)
 	{
 	/* Create the self-pipe: */
 	pipeFds[1]=pipeFds[0]=-1;
 	if(pipe2(pipeFds,O_NONBLOCK)<0)
 		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot create event pipe");
 	
+	#if THREADS_CONFIG_HAVE_EPOLL
+	if(backend==EPoll)
+		{
+		/* Create the epoll instance: */
+		epollFd=epoll_create1(EPOLL_CLOEXEC);
+		if(epollFd<0)
+			{
+			int error=errno;
+			close(pipeFds[0]);
+			close(pipeFds[1]);
+			delete[] messages;
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,error,"Cannot create epoll instance");
+			}
+		
+		/* Watch the read end of the self-pipe: */
+		struct epoll_event event;
+		event.events=EPOLLIN;
+		event.data.u64=epollPipeKey;
+		epoll_ctl(epollFd,EPOLL_CTL_ADD,pipeFds[0],&event);
+		
+		/* Allocate the ready event array: */
+		maxNumEpollEvents=64;
+		epollEvents=new struct epoll_event[maxNumEpollEvents];
+		}
+	#else
+	/* Fall back to the select backend on systems without epoll: */
+	backend=Select;
+	#endif
+	
 	/* Initialize the three file descriptor sets: */
 	FD_ZERO(&readFds);
 	FD_ZERO(&writeFds);
@@ -616,6 +974,13 @@ EventDispatcher::~EventDispatcher(void)
 	close(pipeFds[0]);
 	close(pipeFds[1]);
 	delete[] messages;
+	
+	#if THREADS_CONFIG_HAVE_EPOLL
+	/* Close the epoll instance: */
+	if(epollFd>=0)
+		close(epollFd);
+	delete[] epollEvents;
+	#endif
 	}
 
 bool EventDispatcher::dispatchNextEvent(bool wait)
@@ -692,360 +1057,213 @@ bool EventDispatcher::dispatchNextEvent(bool wait)
 			}
 		}
 	
-	/* Create lists of watched file descriptors: */
-	fd_set rds,wds,eds;
-	int numRfds,numWfds,numEfds,numFds;
-	if(hadBadFd)
+	#if THREADS_CONFIG_HAVE_EPOLL
+	if(backend==EPoll)
 		{
-		/* Listen only on the self-pipe to recover from EBADF errors: */
-		FD_ZERO(&rds);
-		FD_SET(pipeFds[0],&rds);
-		numRfds=1;
-		numWfds=0;
-		numEfds=0;
-		numFds=pipeFds[0]+1;
+		/* Calculate the time-out for epoll_wait() in milliseconds, rounding up to not wake up before the next timer event: */
+		int timeout=-1;
+		if(!wait)
+			timeout=0;
+		else if(!timerEventListenerHeap.isEmpty())
+			timeout=int(interval.tv_sec*1000L+(interval.tv_usec+999L)/1000L);
 		
-		hadBadFd=false;
-		}
-	else
-		{
-		/* Copy all used file descriptor sets: */
-		if(numReadFds>0)
-			rds=readFds;
-		if(numWriteFds>0)
-			wds=writeFds;
-		if(numExceptionFds>0)
-			eds=exceptionFds;
-		numRfds=numReadFds;
-		numWfds=numWriteFds;
-		numEfds=numExceptionFds;
-		numFds=maxFd+1;
-		}
-	
-	int numSetFds=0;
-	if(!wait)
-		{
-		/* Collect pending events on any watched file descriptor: */
-		interval.tv_usec=interval.tv_sec=0;
-		numSetFds=select(numFds,numRfds>0?&rds:0,numWfds>0?&wds:0,numEfds>0?&eds:0,&interval);
-		}
-	else if(timerEventListenerHeap.isEmpty())
-		{
-		/* Wait forever for the next event on any watched file descriptor: */
-		numSetFds=select(numFds,numRfds>0?&rds:0,numWfds>0?&wds:0,numEfds>0?&eds:0,0);
-		}
-	else
-		{
-		/* Wait for the next event on any watched file descriptor or until the next timer event elapses: */
-		numSetFds=select(numFds,numRfds>0?&rds:0,numWfds>0?&wds:0,numEfds>0?&eds:0,&interval);
-		}
-	
-	/* Update the dispatch time point: */
-	dispatchTime=Time::now();
-	
-	/* Handle all received events: */
-	if(numSetFds>0)
-		{
-		/* Check for a message on the self-pipe: */
-		if(FD_ISSET(pipeFds[0],&rds))
+		/* Wait for ready file descriptors: */
+		int numReadyFds=epoll_wait(epollFd,epollEvents,int(maxNumEpollEvents),timeout);
+		
+		/* Update the dispatch time point: */
+		dispatchTime=Time::now();
+		
+		if(numReadyFds>0)
 			{
-			/* Read and handle pipe messages: */
-			size_t numMessages=readPipeMessages();
-			PipeMessage* pmPtr=messages;
-			for(size_t i=0;i<numMessages;++i,++pmPtr)
+			/* Handle messages on the self-pipe first, in case they remove listeners that are also ready: */
+			for(int i=0;i<numReadyFds;++i)
+				if(epollEvents[i].data.u64==epollPipeKey&&!handlePipeMessages(dispatchTime))
+					return false;
+			
+			/* Handle all input/output events: */
+			IOEventImpl ioEvent(dispatchTime,*this);
+			for(int i=0;i<numReadyFds;++i)
 				{
-				switch(pmPtr->messageType)
+				/* Find the listener that is ready, skipping the self-pipe and listeners that were removed in the meantime: */
+				if(epollEvents[i].data.u64==epollPipeKey)
+					continue;
+				IOEventListenerIndexMap::Iterator lIt=ioEventListenerIndices.findEntry(ListenerKey(epollEvents[i].data.u64));
+				if(lIt.isFinished())
+					continue;
+				ioEvent.lIt=ioEventListeners.begin()+lIt->getDest();
+				
+				/* Limit to events in which the listener is interested: */
+				ioEvent.eventTypeMask=getEventTypeMask(epollEvents[i].events)&ioEvent.lIt->typeMask;
+				
+				/* Call the listener's event callback if any relevant events occurred: */
+				if(ioEvent.eventTypeMask!=0x0)
 					{
-					case PipeMessage::INTERRUPT: // Interrupt wait
-						
-						/* Do nothing */
-						
-						break;
-					
-					case PipeMessage::STOP: // Stop dispatching events
-						return false;
-						break;
-					
-					case PipeMessage::ADD_IO_LISTENER: // Add input/output event listener
-						
-						/* Add the new input/output event listener to the list: */
-						ioEventListeners.push_back(IOEventListener(pmPtr->addIOListener.key,pmPtr->addIOListener.fd,pmPtr->addIOListener.typeMask,pmPtr->addIOListener.callback,pmPtr->addIOListener.callbackUserData));
-						
-						/* Update the file descriptor sets: */
-						updateFdSets(pmPtr->addIOListener.fd,0x0,pmPtr->addIOListener.typeMask);
-						
-						break;
-					
-					case PipeMessage::SET_IO_LISTENER_TYPEMASK: // Change the event type mask of an input/output event listener
-						
-						/* Find the input/output event listener with the given key: */
-						for(std::vector<IOEventListener>::iterator elIt=ioEventListeners.begin();elIt!=ioEventListeners.end();++elIt)
-							if(elIt->key==pmPtr->setIOListenerEventTypeMask.key)
-								{
-								/* Update the input/output event listener: */
-								int typeMask=elIt->typeMask;
-								elIt->typeMask=pmPtr->setIOListenerEventTypeMask.newTypeMask;
-								
-								/* Update the file descriptor sets: */
-								updateFdSets(elIt->fd,typeMask,elIt->typeMask);
-								
-								/* Stop looking: */
-								break;
-								}
-						
-						break;
-					
-					case PipeMessage::REMOVE_IO_LISTENER: // Remove input/output event listener
-						
-						/* Find the input/output event listener with the given key: */
-						for(std::vector<IOEventListener>::iterator elIt=ioEventListeners.begin();elIt!=ioEventListeners.end();++elIt)
-							if(elIt->key==pmPtr->removeIOListener)
-								{
-								/* Remove the input/output event listener from the list: */
-								int fd=elIt->fd;
-								int typeMask=elIt->typeMask;
-								*elIt=ioEventListeners.back();
-								ioEventListeners.pop_back();
-								
-								/* Update the file descriptor sets: */
-								updateFdSets(fd,typeMask,0x0);
-								
-								/* Stop looking: */
-								break;
-								}
-						
-						break;
-					
-					case PipeMessage::ADD_TIMER_LISTENER: // Add timer event listener
-						{
-						/* Create a new timer event listener in the map: */
-						TimerEventListenerMap::Iterator telIt=timerEventListeners.setAndFindEntry(TimerEventListenerMap::Entry(pmPtr->addTimerListener.key,TimerEventListener(pmPtr->addTimerListener.key,pmPtr->addTimerListener.time,pmPtr->addTimerListener.interval,pmPtr->addTimerListener.callback,pmPtr->addTimerListener.callbackUserData)));
-						telIt->getDest().suspended=pmPtr->addTimerListener.startSuspended;
-						
-						/* Add the just-created timer event listener to the heap if it is not suspended: */
-						if(!telIt->getDest().suspended)
-							timerEventListenerHeap.insert(&telIt->getDest());
-						
-						break;
-						}
-					
-					case PipeMessage::SUSPEND_TIMER_LISTENER: // Suspend timer event listener
-						{
-						/* Find the timer event listener with the given key: */
-						TimerEventListener* tel=&timerEventListeners.getEntry(pmPtr->suspendTimerListener).getDest();
-						
-						/* Remove the timer event listener from the heap if it is not already suspended: */
-						if(!tel->suspended)
-							{
-							for(TimerEventListenerHeap::Iterator elIt=timerEventListenerHeap.begin();elIt!=timerEventListenerHeap.end();++elIt)
-								if(*elIt==tel)
-									{
-									/* Remove the timer event listener from the heap: */
-									timerEventListenerHeap.remove(elIt);
-									
-									/* Stop looking: */
-									break;
-									}
-							}
-						
-						/* Mark the timer event listener as suspended: */
-						tel->suspended=true;
-						
-						break;
-						}
-					
-					case PipeMessage::RESUME_TIMER_LISTENER: // Resume timer event listener
+					try
 						{
-						/* Find the timer event listener with the given key: */
-						TimerEventListener* tel=&timerEventListeners.getEntry(pmPtr->resumeTimerListener.key).getDest();
-						
-						/* Update and add the timer event listener to the heap if it is currently suspended: */
-						if(tel->suspended)
-							{
-							tel->time=pmPtr->resumeTimerListener.time;
-							timerEventListenerHeap.insert(tel);
-							}
-						
-						/* Mark the timer event listener as active: */
-						tel->suspended=false;
-						
-						break;
+						ioEvent.key=ioEvent.lIt->key;
+						ioEvent.userData=ioEvent.lIt->callbackUserData;
+						ioEvent.removed=false;
+						ioEvent.lIt->callback(ioEvent);
 						}
-					
-					case PipeMessage::REMOVE_TIMER_LISTENER: // Remove timer event listener
+					catch(const std::runtime_error& err)
 						{
-						/* Find the timer event listener with the given key: */
-						TimerEventListenerMap::Iterator telIt=timerEventListeners.findEntry(pmPtr->removeTimerListener);
-						if(telIt.isFinished())
-							throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Timer event listener key not found in hash table");
-						TimerEventListener* tel=&telIt->getDest();
-						
-						/* Remove the timer event listener from the heap if it is not suspended: */
-						if(!tel->suspended)
-							{
-							for(TimerEventListenerHeap::Iterator elIt=timerEventListenerHeap.begin();elIt!=timerEventListenerHeap.end();++elIt)
-								if(*elIt==tel)
-									{
-									/* Remove the timer event listener from the heap: */
-									timerEventListenerHeap.remove(elIt);
-									
-									/* Stop looking: */
-									break;
-									}
-							}
-						
-						/* Remove the timer event listener from the map: */
-						timerEventListeners.removeEntry(telIt);
-						
-						break;
-						}
-					
-					case PipeMessage::ADD_PROCESS_LISTENER:
-						
-						/* Add the new process listener to the list: */
-						processListeners.push_back(ProcessListener(pmPtr->addProcessListener.key,pmPtr->addProcessListener.callback,pmPtr->addProcessListener.callbackUserData));
-						
-						break;
-					
-					case PipeMessage::REMOVE_PROCESS_LISTENER:
-						
-						/* Find the process listener with the given key: */
-						for(std::vector<ProcessListener>::iterator plIt=processListeners.begin();plIt!=processListeners.end();++plIt)
-							if(plIt->key==pmPtr->removeProcessListener)
-								{
-								/* Remove the process listener from the list: */
-								*plIt=processListeners.back();
-								processListeners.pop_back();
-								
-								/* Stop looking: */
-								break;
-								}
-						
-						break;
-					
-					case PipeMessage::ADD_SIGNAL_LISTENER:
-						
-						/* Add the new signal listener to the map: */
-						signalListeners.setEntry(SignalListenerMap::Entry(pmPtr->addSignalListener.key,SignalListener(pmPtr->addSignalListener.key,pmPtr->addSignalListener.callback,pmPtr->addSignalListener.callbackUserData)));
-						
-						break;
-					
-					case PipeMessage::REMOVE_SIGNAL_LISTENER:
-						
-						/* Remove the signal listener with the given key from the map: */
-						signalListeners.removeEntry(pmPtr->removeSignalListener);
-						
-						break;
-					
-					case PipeMessage::SIGNAL:
-						{
-						/* Find the signal listener with the given key in the map: */
-						SignalListenerMap::Iterator slIt=signalListeners.findEntry(pmPtr->signal.key);
-						if(slIt.isFinished())
-							throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Signal event listener key not found");
-						SignalListener& sl=slIt->getDest();
-						
-						/* Call the signal callback: */
-						SignalEventImpl signalEvent(dispatchTime,*this);
-						try
-							{
-							signalEvent.key=sl.key;
-							signalEvent.userData=sl.callbackUserData;
-							signalEvent.signalData=pmPtr->signal.signalData;
-							signalEvent.lIt=slIt;
-							sl.callback(signalEvent);
-							}
-						catch(const std::runtime_error& err)
-							{
-							// DEBUGGING
-							Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Exception %s in signal callback",err.what());
-							
-							/* Remove the event listener that caused the exception: */
-							signalEvent.removeListener();
-							}
+						// DEBUGGING
+						Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Exception %s in I/O callback",err.what());
 						
-						break;
+						/* Remove the event listener that caused the exception: */
+						ioEvent.removeListener();
 						}
-						
-					default:
-						/* Do nothing: */
-						
-						// DEBUGGING
-						Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Unknown pipe message %d",pmPtr->messageType);
 					}
 				}
 			
-			--numSetFds;
+			/* Grow the ready event array if it was filled completely: */
+			if(size_t(numReadyFds)==maxNumEpollEvents&&maxNumEpollEvents<4096)
+				{
+				delete[] epollEvents;
+				maxNumEpollEvents*=2;
+				epollEvents=new struct epoll_event[maxNumEpollEvents];
+				}
 			}
+		else if(numReadyFds<0&&errno!=EINTR)
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"epoll_wait() failed");
+		}
+	else
+	#endif
+		{
+		/* Create lists of watched file descriptors: */
+		fd_set rds,wds,eds;
+		int numRfds,numWfds,numEfds,numFds;
+		if(hadBadFd)
+			{
+			/* Listen only on the self-pipe to recover from EBADF errors: */
+			FD_ZERO(&rds);
+			FD_SET(pipeFds[0],&rds);
+			numRfds=1;
+			numWfds=0;
+			numEfds=0;
+			numFds=pipeFds[0]+1;
 		
-		/* Handle all input/output events: */
-		IOEventImpl ioEvent(dispatchTime,*this);
-		for(ioEvent.nextLIt=ioEvent.lIt;numSetFds>0&&ioEvent.lIt!=ioEventListeners.end();ioEvent.lIt=ioEvent.nextLIt)
+			hadBadFd=false;
+			}
+		else
 			{
-			/* Prepare to go to the next listener: */
-			++ioEvent.nextLIt;
-			
-			/* Determine all event types on the listener's file descriptor: */
-			int eventTypeMask=0x0;
-			if(numRfds>0&&FD_ISSET(ioEvent.lIt->fd,&rds))
-				{
-				/* Signal a read event: */
-				eventTypeMask|=Read;
-				--numSetFds;
-				}
-			if(numWfds>0&&FD_ISSET(ioEvent.lIt->fd,&wds))
+			/* Copy all used file descriptor sets: */
+			if(numReadFds>0)
+				rds=readFds;
+			if(numWriteFds>0)
+				wds=writeFds;
+			if(numExceptionFds>0)
+				eds=exceptionFds;
+			numRfds=numReadFds;
+			numWfds=numWriteFds;
+			numEfds=numExceptionFds;
+			numFds=maxFd+1;
+			}
+	
+		int numSetFds=0;
+		if(!wait)
+			{
+			/* Collect pending events on any watched file descriptor: */
+			interval.tv_usec=interval.tv_sec=0;
+			numSetFds=select(numFds,numRfds>0?&rds:0,numWfds>0?&wds:0,numEfds>0?&eds:0,&interval);
+			}
+		else if(timerEventListenerHeap.isEmpty())
+			{
+			/* Wait forever for the next event on any watched file descriptor: */
+			numSetFds=select(numFds,numRfds>0?&rds:0,numWfds>0?&wds:0,numEfds>0?&eds:0,0);
+			}
+		else
+			{
+			/* Wait for the next event on any watched file descriptor or until the next timer event elapses: */
+			numSetFds=select(numFds,numRfds>0?&rds:0,numWfds>0?&wds:0,numEfds>0?&eds:0,&interval);
+			}
+	
+		/* Update the dispatch time point: */
+		dispatchTime=Time::now();
+	
+		/* Handle all received events: */
+		if(numSetFds>0)
+			{
+			/* Check for a message on the self-pipe: */
+			if(FD_ISSET(pipeFds[0],&rds))
 				{
-				/* Signal a write event: */
-				eventTypeMask|=Write;
+				/* Read and handle pipe messages: */
+				if(!handlePipeMessages(dispatchTime))
+					return false;
+			
 				--numSetFds;
 				}
-			if(numEfds>0&&FD_ISSET(ioEvent.lIt->fd,&eds))
+		
+			/* Handle all input/output events: */
+			IOEventImpl ioEvent(dispatchTime,*this);
+			for(ioEvent.nextLIt=ioEvent.lIt;numSetFds>0&&ioEvent.lIt!=ioEventListeners.end();ioEvent.lIt=ioEvent.nextLIt)
 				{
-				/* Signal an exception event: */
-				eventTypeMask|=Exception;
-				--numSetFds;
-				}
-			
-			/* Limit to events in which the listener is interested: */
-			ioEvent.eventTypeMask=eventTypeMask&ioEvent.lIt->typeMask;
-			
-			/* Check for spurious events, i.e., events in which the listener was not actually interested: */
-			if(ioEvent.eventTypeMask!=eventTypeMask)
-				Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Spurious event");
+				/* Prepare to go to the next listener: */
+				++ioEvent.nextLIt;
 			
-			/* Call the listener's event callback if any relevant events occurred: */
-			if(ioEvent.eventTypeMask!=0x0)
-				{
-				try
+				/* Determine all event types on the listener's file descriptor: */
+				int eventTypeMask=0x0;
+				if(numRfds>0&&FD_ISSET(ioEvent.lIt->fd,&rds))
 					{
-					ioEvent.key=ioEvent.lIt->key;
-					ioEvent.userData=ioEvent.lIt->callbackUserData;
-					ioEvent.removed=false;
-					ioEvent.lIt->callback(ioEvent);
+					/* Signal a read event: */
+					eventTypeMask|=Read;
+					--numSetFds;
 					}
-				catch(const std::runtime_error& err)
+				if(numWfds>0&&FD_ISSET(ioEvent.lIt->fd,&wds))
 					{
-					// DEBUGGING
-					Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Exception %s in I/O callback",err.what());
+					/* Signal a write event: */
+					eventTypeMask|=Write;
+					--numSetFds;
+					}
+				if(numEfds>0&&FD_ISSET(ioEvent.lIt->fd,&eds))
+					{
+					/* Signal an exception event: */
+					eventTypeMask|=Exception;
+					--numSetFds;
+					}
+			
+				/* Limit to events in which the listener is interested: */
+				ioEvent.eventTypeMask=eventTypeMask&ioEvent.lIt->typeMask;
+			
+				/* Check for spurious events, i.e., events in which the listener was not actually interested: */
+				if(ioEvent.eventTypeMask!=eventTypeMask)
+					Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Spurious event");
+			
+				/* Call the listener's event callback if any relevant events occurred: */
+				if(ioEvent.eventTypeMask!=0x0)
+					{
+					try
+						{
+						ioEvent.key=ioEvent.lIt->key;
+						ioEvent.userData=ioEvent.lIt->callbackUserData;
+						ioEvent.removed=false;
+						ioEvent.lIt->callback(ioEvent);
+						}
+					catch(const std::runtime_error& err)
+						{
+						// DEBUGGING
+						Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Exception %s in I/O callback",err.what());
 					
-					/* Remove the event listener that caused the exception: */
-					ioEvent.removeListener();
+						/* Remove the event listener that caused the exception: */
+						ioEvent.removeListener();
+						}
 					}
 				}
 			}
-		}
-	else if(numSetFds<0&&errno!=EINTR)
-		{
-		if(errno==EBADF)
+		else if(numSetFds<0&&errno!=EINTR)
 			{
-			// DEBUGGING
-			Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Bad file descriptor in select");
+			if(errno==EBADF)
+				{
+				// DEBUGGING
+				Misc::sourcedLogWarning(__PRETTY_FUNCTION__,"Bad file descriptor in select");
 			
-			/* Set error flag; only wait on self-pipe on next iteration to hopefully receive a "remove listener" message for the bad descriptor: */
-			hadBadFd=true;
+				/* Set error flag; only wait on self-pipe on next iteration to hopefully receive a "remove listener" message for the bad descriptor: */
+				hadBadFd=true;
+				}
+			else
+				throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"select() failed");
 			}
-		else
-			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"select() failed");
+	
 		}
 	
 	/* Call all process listeners: */
@@ -1,7 +1,7 @@
 /***********************************************************************
 EventDispatcher - Class to dispatch events from a central listener to
 any number of interested clients.
-Copyright (c) 2016-2023 Oliver Kreylos
+Copyright (c) 2016-2026 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -34,6 +34,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/HashTable.h>
 #include <Threads/Spinlock.h>
 
+/* Forward declarations: */
+struct epoll_event;
+
 namespace Threads {
 
 class EventDispatcher
@@ -42,6 +45,12 @@ class EventDispatcher
 	public:
 	typedef unsigned int ListenerKey; // Type for keys to uniquely identify registered event listeners
 	
+	enum Backend // Enumerated type for operating system mechanisms to wait for input/output events
+		{
+		Select, // Uses select() on descriptor sets; waiting and dispatching take time linear in the largest watched file descriptor
+		EPoll // Uses Linux's epoll interface; waiting and dispatching take time linear in the number of ready file descriptors, but each file descriptor can only be watched by a single listener; falls back to Select on systems without epoll
+		};
+	
 	enum IOEventType // Enumerated type for input/output event types
 		{
 		Read=0x01,Write=0x02,ReadWrite=0x03,Exception=0x04
@@ -278,6 +287,7 @@ class EventDispatcher
 	typedef Misc::HashTable<ListenerKey,TimerEventListener> TimerEventListenerMap; // Hash table mapping listener keys to timer event listeners
 	typedef Misc::PriorityHeap<TimerEventListener*,TimerEventListenerComp> TimerEventListenerHeap; // Type for heap of timer event listeners, ordered by next event time
 	typedef Misc::HashTable<ListenerKey,SignalListener> SignalListenerMap; // Hash table mapping listener keys to signal listeners
+	typedef Misc::HashTable<ListenerKey,size_t> IOEventListenerIndexMap; // Hash table mapping listener keys to indices in the input/output event listener list
 	struct PipeMessage;
 	
 	/* Elements: */
@@ -297,16 +307,24 @@ class EventDispatcher
 	int numReadFds,numWriteFds,numExceptionFds; // Number of file descriptors in the three descriptor sets
 	int maxFd; // Largest file descriptor set in any of the three descriptor sets
 	bool hadBadFd; // Flag if the last invocation of dispatchNextEvent() tripped on a bad file descriptor
+	Backend backend; // Mechanism used to wait for input/output events
+	int epollFd; // File descriptor of the epoll instance if the epoll backend is used
+	IOEventListenerIndexMap ioEventListenerIndices; // Map from input/output event listener keys to their indices in the listener list if the epoll backend is used
+	size_t maxNumEpollEvents; // Maximum number of ready events retrieved by a single epoll_wait() call
+	struct epoll_event* epollEvents; // Array to retrieve ready events from epoll_wait()
 	
 	/* Private methods: */
 	ListenerKey getNextKey(void); // Returns a new listener key
 	size_t readPipeMessages(void); // Reads messages from the self-pipe; returns number of complete messages read
 	void writePipeMessage(const PipeMessage& pm,const char* methodName); // Writes a message to the self-pipe
-	void updateFdSets(int fd,int oldEventMask,int newEventMask); // Updates the three descriptor sets based on the given file descriptor changing its interest mask
+	void updateFdSets(ListenerKey key,int fd,int oldEventMask,int newEventMask); // Updates the three descriptor sets or the epoll interest list based on the given listener's file descriptor changing its interest mask
+	void addIOEventListenerInternal(const IOEventListener& newListener); // Adds the given input/output event listener to the listener list
+	void removeIOEventListenerInternal(std::vector<IOEventListener>::iterator listenerIt); // Removes the input/output event listener at the given position by replacing it with the last listener in the list
+	bool handlePipeMessages(const Time& dispatchTime); // Reads and handles messages from the self-pipe; returns false if the dispatcher was stopped
 	
 	/* Constructors and destructors: */
 	public:
-	EventDispatcher(void); // Creates an event dispatcher
+	EventDispatcher(Backend sBackend =Select); // Creates an event dispatcher using the given mechanism to wait for input/output events
 	private:
 	EventDispatcher(const EventDispatcher& source); // Prohibit copy constructor
 	EventDispatcher& operator=(const EventDispatcher& source); // Prohibit assignment operator
@@ -314,6 +332,10 @@ class EventDispatcher
 	~EventDispatcher(void);
 	
 	/* Methods: */
+	Backend getBackend(void) const // Returns the mechanism used to wait for input/output events
+		{
+		return backend;
+		}
 	bool dispatchNextEvent(bool wait =true); // Waits for the next event if wait flag is true, then dispatches all pending events; returns false if the stop() method was called
 	void dispatchEvents(void); // Waits for and dispatches events until stopped
 	void interrupt(void); // Forces an invocation of dispatchNextEvent() to return with a true value
@@ -1,7 +1,7 @@
 /***********************************************************************
 EventDispatcherThread - Class to run an event dispatcher in its own
 background thread.
-Copyright (c) 2023 Oliver Kreylos
+Copyright (c) 2023-2026 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -36,7 +36,8 @@ void* EventDispatcherThread::threadMethod(void)
 	return 0;
 	}
 
-EventDispatcherThread::EventDispatcherThread(bool startThread)
+EventDispatcherThread::EventDispatcherThread(bool startThread,EventDispatcher::Backend sBackend)
+	:EventDispatcher(sBackend)
 	{
 	/* Start the event dispatcher thread if requested: */
 	if(startThread)
@@ -1,7 +1,7 @@
 /***********************************************************************
 EventDispatcherThread - Class to run an event dispatcher in its own
 background thread.
-Copyright (c) 2023 Oliver Kreylos
+Copyright (c) 2023-2026 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -39,7 +39,7 @@ class EventDispatcherThread:public EventDispatcher
 	
 	/* Constructors and destructors: */
 	public:
-	EventDispatcherThread(bool startThread =true); // Creates an event dispatcher; immediately starts the dispatching thread if given flag is true
+	EventDispatcherThread(bool startThread =true,Backend sBackend =Select); // Creates an event dispatcher using the given mechanism to wait for input/output events; immediately starts the dispatching thread if given flag is true
 	~EventDispatcherThread(void); // Shuts down the event dispatcher and its thread
 	
 	/* Methods: */
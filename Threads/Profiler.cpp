@@ -0,0 +1,359 @@
+/***********************************************************************
+Profiler - Class to record the begin and end times of nested code zones
+in per-thread ring buffers with negligible overhead while disabled, and
+to merge the recorded zones of all threads into a trace file in Chrome
+trace event format for inspection in chrome://tracing or Perfetto.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Threads/Profiler.h>
+
+#include <pthread.h>
+#include <time.h>
+#include <stdio.h>
+#include <algorithm>
+#include <Misc/StdError.h>
+#include <Threads/Config.h>
+#include <Threads/Mutex.h>
+
+namespace Threads {
+
+/*********************************************
+Declaration of struct Profiler::ThreadBuffer:
+*********************************************/
+
+struct Profiler::ThreadBuffer
+	{
+	/* Elements: */
+	public:
+	ThreadBuffer* succ; // Pointer to the next thread buffer in the list of all thread buffers
+	unsigned int threadId; // Profiler-assigned ID of the thread owning this buffer
+	bool owned; // Flag whether the buffer is currently owned by a live thread; released buffers are reused by new threads
+	std::string threadName; // Name of the owning thread; protected by the collector mutex
+	size_t bufferMask; // Number of zones in the ring buffer minus one; the size is always a power of two
+	Event* events; // The ring buffer, allocated when the owning thread records its first zone
+	Misc::UInt64 head; // Total number of zones written into the ring buffer; written only by the owning thread
+	Misc::UInt64 tail; // Total number of zones collected from or lost in the ring buffer; accessed only by collectors
+	unsigned int depth; // Current zone nesting depth of the owning thread
+	
+	/* Constructors and destructors: */
+	ThreadBuffer(unsigned int sThreadId)
+		:succ(0),threadId(sThreadId),owned(true),
+		 bufferMask(0),events(0),head(0),tail(0),
+		 depth(0)
+		{
+		}
+	};
+
+namespace {
+
+/****************
+Helper variables:
+****************/
+
+pthread_once_t threadBufferKeyOnce=PTHREAD_ONCE_INIT; // Guard to create the thread buffer key exactly once
+pthread_key_t threadBufferKey; // Key associating a thread buffer with its owning thread, to release the buffer when the thread terminates
+#if THREADS_CONFIG_HAVE_BUILTIN_TLS
+__thread Profiler::ThreadBuffer* currentThreadBuffer=0; // Cached pointer to the calling thread's buffer
+#endif
+Profiler::ThreadBuffer* firstThreadBuffer=0; // Head of the lock-free list of all thread buffers ever created
+unsigned int numThreadBuffers=0; // Number of thread buffers ever created, to assign thread IDs
+size_t threadBufferSize=65536; // Ring buffer size for threads recording their first zone
+Mutex collectorMutex; // Mutex serializing collectors, and protecting thread names
+
+/****************
+Helper functions:
+****************/
+
+void releaseThreadBuffer(void* threadBuffer)
+	{
+	/* Mark the thread buffer as released so that a new thread can claim it; its recorded zones remain until collected: */
+	__atomic_store_n(&static_cast<Profiler::ThreadBuffer*>(threadBuffer)->owned,false,__ATOMIC_RELEASE);
+	}
+
+void createThreadBufferKey(void)
+	{
+	pthread_key_create(&threadBufferKey,releaseThreadBuffer);
+	}
+
+Profiler::ThreadBuffer* getThreadBuffer(void)
+	{
+	/* Check if the calling thread already owns a buffer: */
+	#if THREADS_CONFIG_HAVE_BUILTIN_TLS
+	if(currentThreadBuffer!=0)
+		return currentThreadBuffer;
+	pthread_once(&threadBufferKeyOnce,createThreadBufferKey);
+	Profiler::ThreadBuffer* tb=0;
+	#else
+	pthread_once(&threadBufferKeyOnce,createThreadBufferKey);
+	Profiler::ThreadBuffer* tb=static_cast<Profiler::ThreadBuffer*>(pthread_getspecific(threadBufferKey));
+	if(tb!=0)
+		return tb;
+	#endif
+	
+	/* Try claiming a buffer released by a terminated thread: */
+	for(tb=__atomic_load_n(&firstThreadBuffer,__ATOMIC_ACQUIRE);tb!=0;tb=tb->succ)
+		{
+		bool expected=false;
+		if(__atomic_compare_exchange_n(&tb->owned,&expected,true,false,__ATOMIC_ACQ_REL,__ATOMIC_RELAXED))
+			break;
+		}
+	
+	if(tb!=0)
+		{
+		/* Reset the claimed buffer's per-thread state: */
+		tb->depth=0;
+		Mutex::Lock collectorLock(collectorMutex);
+		tb->threadName.clear();
+		}
+	else
+		{
+		/* Create a new buffer and prepend it to the list of all buffers: */
+		tb=new Profiler::ThreadBuffer(__atomic_add_fetch(&numThreadBuffers,1U,__ATOMIC_RELAXED));
+		Profiler::ThreadBuffer* first=__atomic_load_n(&firstThreadBuffer,__ATOMIC_RELAXED);
+		do
+			{
+			tb->succ=first;
+			}
+		while(!__atomic_compare_exchange_n(&firstThreadBuffer,&first,tb,true,__ATOMIC_RELEASE,__ATOMIC_RELAXED));
+		}
+	
+	/* Associate the buffer with the calling thread: */
+	pthread_setspecific(threadBufferKey,tb);
+	#if THREADS_CONFIG_HAVE_BUILTIN_TLS
+	currentThreadBuffer=tb;
+	#endif
+	
+	return tb;
+	}
+
+bool eventOrder(const Profiler::Event& e1,const Profiler::Event& e2) // Orders zones by entry time, and outer before inner zones
+	{
+	return e1.begin<e2.begin||(e1.begin==e2.begin&&e1.depth<e2.depth);
+	}
+
+void writeJsonString(FILE* file,const char* string) // Writes a string as a quoted JSON string
+	{
+	fputc('\"',file);
+	for(const char* sPtr=string;*sPtr!='\0';++sPtr)
+		{
+		if(*sPtr=='\"'||*sPtr=='\\')
+			{
+			fputc('\\',file);
+			fputc(*sPtr,file);
+			}
+		else if((unsigned char)(*sPtr)<0x20U)
+			fprintf(file,"\\u%04x",(unsigned int)(*sPtr));
+		else
+			fputc(*sPtr,file);
+		}
+	fputc('\"',file);
+	}
+
+}
+
+/*********************************
+Static elements of class Profiler:
+*********************************/
+
+bool Profiler::enabled=false;
+
+/*************************
+Methods of class Profiler:
+*************************/
+
+Profiler::Time Profiler::enterZone(void)
+	{
+	/* Increase the calling thread's nesting depth: */
+	++getThreadBuffer()->depth;
+	
+	return now();
+	}
+
+void Profiler::leaveZone(const char* name,Profiler::Time begin)
+	{
+	Time end=now();
+	ThreadBuffer* tb=getThreadBuffer();
+	
+	/* Allocate the ring buffer on the first recorded zone: */
+	if(tb->events==0)
+		{
+		size_t bufferSize=__atomic_load_n(&threadBufferSize,__ATOMIC_RELAXED);
+		tb->events=new Event[bufferSize];
+		tb->bufferMask=bufferSize-1;
+		}
+	
+	/* Write the zone into the next ring buffer slot: */
+	if(tb->depth>0)
+		--tb->depth;
+	Misc::UInt64 head=tb->head;
+	Event& event=tb->events[head&tb->bufferMask];
+	event.name=name;
+	event.begin=begin;
+	event.end=end;
+	event.depth=tb->depth;
+	
+	/* Publish the zone to collectors: */
+	__atomic_store_n(&tb->head,head+1,__ATOMIC_RELEASE);
+	}
+
+void Profiler::setEnabled(bool newEnabled)
+	{
+	__atomic_store_n(&enabled,newEnabled,__ATOMIC_RELAXED);
+	}
+
+void Profiler::setBufferSize(size_t newBufferSize)
+	{
+	/* Round the buffer size up to the next power of two: */
+	size_t bufferSize=1;
+	while(bufferSize<newBufferSize)
+		bufferSize<<=1;
+	__atomic_store_n(&threadBufferSize,bufferSize,__ATOMIC_RELAXED);
+	}
+
+void Profiler::setThreadName(const char* newThreadName)
+	{
+	ThreadBuffer* tb=getThreadBuffer();
+	Mutex::Lock collectorLock(collectorMutex);
+	tb->threadName=newThreadName;
+	}
+
+Profiler::Time Profiler::now(void)
+	{
+	/* Query the monotonic clock: */
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return Time(now.tv_sec)*Time(1000000000)+Time(now.tv_nsec);
+	}
+
+void Profiler::collect(std::vector<Profiler::ThreadEvents>& threads)
+	{
+	Mutex::Lock collectorLock(collectorMutex);
+	
+	for(ThreadBuffer* tb=__atomic_load_n(&firstThreadBuffer,__ATOMIC_ACQUIRE);tb!=0;tb=tb->succ)
+		{
+		/* Get the number of zones published by the buffer's owner: */
+		Misc::UInt64 head=__atomic_load_n(&tb->head,__ATOMIC_ACQUIRE);
+		if(head==tb->tail)
+			continue;
+		
+		/* Copy all zones that have not yet been overwritten: */
+		Misc::UInt64 bufferSize=tb->bufferMask+1;
+		Misc::UInt64 first=head>bufferSize?head-bufferSize:0;
+		if(first<tb->tail)
+			first=tb->tail;
+		threads.push_back(ThreadEvents());
+		ThreadEvents& te=threads.back();
+		te.threadId=tb->threadId;
+		te.threadName=tb->threadName;
+		te.events.reserve(head-first);
+		for(Misc::UInt64 i=first;i<head;++i)
+			te.events.push_back(tb->events[i&tb->bufferMask]);
+		
+		/* Discard all copied zones that the owner might have overwritten while they were being copied: */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		Misc::UInt64 newHead=__atomic_load_n(&tb->head,__ATOMIC_RELAXED);
+		Misc::UInt64 firstValid=newHead+1>bufferSize?newHead+1-bufferSize:0;
+		size_t numOverwritten=0;
+		if(firstValid>first)
+			{
+			numOverwritten=size_t(std::min(firstValid,head)-first);
+			te.events.erase(te.events.begin(),te.events.begin()+numOverwritten);
+			}
+		te.numLostEvents=size_t(first-tb->tail)+numOverwritten;
+		tb->tail=head;
+		
+		/* Sort the zones by entry time: */
+		std::sort(te.events.begin(),te.events.end(),eventOrder);
+		}
+	}
+
+void Profiler::writeChromeTrace(const std::vector<Profiler::ThreadEvents>& threads,const char* traceFileName,unsigned int processId,const char* processName)
+	{
+	/* Open the trace file: */
+	FILE* file=fopen(traceFileName,"w");
+	if(file==0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Cannot create trace file %s",traceFileName);
+	
+	fprintf(file,"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	bool first=true;
+	
+	/* Write the process name: */
+	if(processName!=0)
+		{
+		fprintf(file,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":",processId);
+		writeJsonString(file,processName);
+		fprintf(file,"}}");
+		first=false;
+		}
+	
+	/* Write the names of all named threads: */
+	for(std::vector<ThreadEvents>::const_iterator tIt=threads.begin();tIt!=threads.end();++tIt)
+		if(!tIt->threadName.empty())
+			{
+			/* Skip the thread if it already appeared earlier in the list: */
+			std::vector<ThreadEvents>::const_iterator t2It;
+			for(t2It=threads.begin();t2It!=tIt&&(t2It->threadId!=tIt->threadId||t2It->threadName!=tIt->threadName);++t2It)
+				;
+			if(t2It!=tIt)
+				continue;
+			
+			fprintf(file,"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",first?"":",\n",processId,tIt->threadId);
+			writeJsonString(file,tIt->threadName.c_str());
+			fprintf(file,"}}");
+			first=false;
+			}
+	
+	/* Write all zones as complete events with time stamps in microseconds: */
+	for(std::vector<ThreadEvents>::const_iterator tIt=threads.begin();tIt!=threads.end();++tIt)
+		{
+		for(std::vector<Event>::const_iterator eIt=tIt->events.begin();eIt!=tIt->events.end();++eIt)
+			{
+			fprintf(file,"%s{\"name\":",first?"":",\n");
+			writeJsonString(file,eIt->name);
+			fprintf(file,",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",processId,tIt->threadId,double(eIt->begin)*1.0e-3,double(eIt->end-eIt->begin)*1.0e-3);
+			first=false;
+			}
+		
+		/* Mark the point where zones were lost: */
+		if(tIt->numLostEvents>0)
+			{
+			double ts=tIt->events.empty()?0.0:double(tIt->events.front().begin)*1.0e-3;
+			fprintf(file,"%s{\"name\":\"%u zones lost\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}",first?"":",\n",(unsigned int)(tIt->numLostEvents),processId,tIt->threadId,ts);
+			first=false;
+			}
+		}
+	
+	fprintf(file,"\n]}\n");
+	
+	/* Close the trace file and check for errors: */
+	bool writeError=ferror(file)!=0;
+	if(fclose(file)!=0||writeError)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Error while writing trace file %s",traceFileName);
+	}
+
+void Profiler::writeChromeTrace(const char* traceFileName,unsigned int processId,const char* processName)
+	{
+	/* Collect all recorded zones and write them: */
+	std::vector<ThreadEvents> threads;
+	collect(threads);
+	writeChromeTrace(threads,traceFileName,processId,processName);
+	}
+
+}
@@ -0,0 +1,113 @@
+/***********************************************************************
+Profiler - Class to record the begin and end times of nested code zones
+in per-thread ring buffers with negligible overhead while disabled, and
+to merge the recorded zones of all threads into a trace file in Chrome
+trace event format for inspection in chrome://tracing or Perfetto.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_PROFILER_INCLUDED
+#define THREADS_PROFILER_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <Misc/SizedTypes.h>
+
+namespace Threads {
+
+class Profiler
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::UInt64 Time; // Type for time stamps in nanoseconds on the monotonic clock
+	
+	struct Event // Structure describing a completed zone
+		{
+		/* Elements: */
+		public:
+		const char* name; // Name of the zone; must point to a string with static storage duration
+		Time begin,end; // Times at which the zone was entered and left
+		unsigned int depth; // Nesting depth of the zone in its thread, with zero for outermost zones
+		};
+	
+	struct ThreadEvents // Structure holding the zones recorded by a single thread
+		{
+		/* Elements: */
+		public:
+		unsigned int threadId; // Profiler-assigned ID of the recording thread
+		std::string threadName; // Name of the recording thread, or empty if the thread was never named
+		std::vector<Event> events; // Completed zones in the order in which they were left
+		size_t numLostEvents; // Number of zones that were overwritten in the thread's ring buffer before they could be collected
+		};
+	
+	class Zone // Class to record a zone spanning the lifetime of a zone object
+		{
+		/* Elements: */
+		private:
+		const char* name; // Name of the zone
+		Time begin; // Time at which the zone was entered, or zero if the profiler was disabled at the time
+		
+		/* Constructors and destructors: */
+		public:
+		Zone(const char* sName) // Enters a zone of the given name, which must have static storage duration
+			:name(sName),begin(0)
+			{
+			if(__atomic_load_n(&enabled,__ATOMIC_RELAXED))
+				begin=enterZone();
+			}
+		private:
+		Zone(const Zone& source); // Prohibit copy constructor
+		Zone& operator=(const Zone& source); // Prohibit assignment operator
+		public:
+		~Zone(void) // Leaves the zone
+			{
+			if(begin!=0)
+				leaveZone(name,begin);
+			}
+		};
+	
+	struct ThreadBuffer; // Structure holding the ring buffer of a single thread; opaque to clients
+	
+	/* Elements: */
+	private:
+	static bool enabled; // Flag whether new zones are recorded
+	
+	/* Private methods: */
+	static Time enterZone(void); // Enters a zone in the calling thread; returns entry time
+	static void leaveZone(const char* name,Time begin); // Leaves the innermost zone of the calling thread and records it
+	
+	/* Methods: */
+	public:
+	static bool isEnabled(void) // Returns true if new zones are being recorded
+		{
+		return __atomic_load_n(&enabled,__ATOMIC_RELAXED);
+		}
+	static void setEnabled(bool newEnabled); // Enables or disables recording of new zones; zones that are already entered are still recorded when left
+	static void setBufferSize(size_t newBufferSize); // Sets the number of zones held by the ring buffers of threads that record their first zone after the call
+	static void setThreadName(const char* newThreadName); // Sets the name under which the calling thread's zones appear in traces
+	static Time now(void); // Returns the current time in the profiler's time base
+	static void collect(std::vector<ThreadEvents>& threads); // Removes all zones recorded since the last collection from all threads' ring buffers and appends them to the given list; never blocks recording threads
+	static void writeChromeTrace(const std::vector<ThreadEvents>& threads,const char* traceFileName,unsigned int processId =0,const char* processName =0); // Writes the given collected zones to a trace file in Chrome trace event format
+	static void writeChromeTrace(const char* traceFileName,unsigned int processId =0,const char* processName =0); // Collects all recorded zones and writes them to a trace file in Chrome trace event format
+	};
+
+}
+
+#endif
@@ -28,6 +28,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <unistd.h>
 #include <poll.h>
 #include <signal.h>
+#include <Threads/Config.h>
+#if THREADS_CONFIG_HAVE_EPOLL
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
 #include <Misc/StdError.h>
 #include <Misc/MessageLogger.h>
 #include <Threads/Mutex.h>
@@ -290,6 +295,18 @@ struct RunLoop::ActiveIOWatcher
 	IOWatcher* watcher; // Pointer to the I/O watcher object
 	};
 
+/*********************************************
+Declaration of struct RunLoop::ReadyIOWatcher:
+*********************************************/
+
+struct RunLoop::ReadyIOWatcher
+	{
+	/* Elements: */
+	public:
+	IOWatcher* watcher; // Pointer to the I/O watcher object, or null if the I/O watcher was disabled after it became ready
+	unsigned int eventMask; // Bit mask of events that occurred on the I/O watcher's file descriptor
+	};
+
 /*******************************
 Methods of class RunLoop::Timer:
 *******************************/
@@ -508,8 +525,74 @@ inline unsigned int getPollRequestEvents(const struct pollfd& pollFd) // Retriev
 	#endif
 	}
 
+#if THREADS_CONFIG_HAVE_EPOLL
+
+inline uint32_t getEpollRequestEvents(unsigned int eventMask) // Returns an epoll event set for the given event mask
+	{
+	/* Compile-time check if the event mask bits exposed at the interface match the EPOLL* constants defined in sys/epoll.h: */
+	#if EPOLLIN==0x1&&EPOLLPRI==0x2&&EPOLLOUT==0x4
+	
+	/* Use the event mask directly: */
+	return eventMask&(RunLoop::IOWatcher::Read|RunLoop::IOWatcher::Exception|RunLoop::IOWatcher::Write);
+	
+	#else
+	
+	/* Assemble the epoll event set bit-by-bit: */
+	uint32_t result=0x0U;
+	if(eventMask&RunLoop::IOWatcher::Read)
+		result|=EPOLLIN;
+	if(eventMask&RunLoop::IOWatcher::Exception)
+		result|=EPOLLPRI;
+	if(eventMask&RunLoop::IOWatcher::Write)
+		result|=EPOLLOUT;
+	return result;
+	
+	#endif
+	}
+
+inline unsigned int getEpollEvents(uint32_t epollEvents) // Retrieves an event mask from the given epoll event set
+	{
+	/* Assemble the event mask bit-by-bit; epoll never reports invalid file descriptors, as closing a file descriptor removes it from the interest list: */
+	unsigned int result=0x0U;
+	if((epollEvents&EPOLLIN)!=0x0)
+		result|=RunLoop::IOWatcher::Read;
+	if((epollEvents&EPOLLPRI)!=0x0)
+		result|=RunLoop::IOWatcher::Exception;
+	if((epollEvents&EPOLLOUT)!=0x0)
+		result|=RunLoop::IOWatcher::Write;
+	if((epollEvents&EPOLLERR)!=0x0)
+		result|=RunLoop::IOWatcher::Error;
+	if((epollEvents&EPOLLHUP)!=0x0)
+		result|=RunLoop::IOWatcher::HangUp;
+	return result;
+	}
+
+#endif
+
 }
 
+#if THREADS_CONFIG_HAVE_EPOLL
+
+void RunLoop::updateEpollInterest(RunLoop::IOWatcher* ioWatcher,int operation,unsigned int eventMask)
+	{
+	/* Update the epoll interest list: */
+	struct epoll_event event;
+	event.events=getEpollRequestEvents(eventMask);
+	event.data.ptr=ioWatcher;
+	if(epoll_ctl(epollFd,operation,ioWatcher->fd,&event)<0&&operation!=EPOLL_CTL_DEL) // Removal fails if the file descriptor was already closed, which removes it from the interest list automatically
+		throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot watch file descriptor %d",ioWatcher->fd);
+	}
+
+#endif
+
+void RunLoop::forgetReadyIOWatcher(RunLoop::IOWatcher* ioWatcher)
+	{
+	/* Invalidate all not-yet handled entries for the given I/O watcher in the ready list: */
+	for(size_t i=0;i<readyIOWatchers.size();++i)
+		if(readyIOWatchers[i].watcher==ioWatcher)
+			readyIOWatchers[i].watcher=0;
+	}
+
 /***********************************
 Internal interface for I/O watchers:
 ***********************************/
@@ -524,6 +607,10 @@ void RunLoop::setIOWatcherEventMask(RunLoop::IOWatcher* ioWatcher,unsigned int n
 			{
 			/* Update the I/O watcher's poll request: */
 			setPollRequestEvents(pollFds[ioWatcher->activeIndex+1],newEventMask);
+	#if THREADS_CONFIG_HAVE_EPOLL
+			if(backend==EPoll)
+				updateEpollInterest(ioWatcher,EPOLL_CTL_MOD,newEventMask);
+	#endif
 			}
 		
 		/* Update the I/O watcher's event mask: */
@@ -547,6 +634,12 @@ void RunLoop::enableIOWatcher(RunLoop::IOWatcher* ioWatcher)
 		/* Check that the I/O watcher is not already enabled: */
 		if(!ioWatcher->enabled)
 			{
+			/* Add the I/O watcher's file descriptor to the epoll interest list first, in case that fails: */
+	#if THREADS_CONFIG_HAVE_EPOLL
+			if(backend==EPoll)
+				updateEpollInterest(ioWatcher,EPOLL_CTL_ADD,ioWatcher->eventMask);
+	#endif
+			
 			/* Append an entry for the I/O watcher to the end of the active lists: */
 			ActiveIOWatcher newIOWatcher;
 			newIOWatcher.watcher=ioWatcher;
@@ -593,10 +686,10 @@ void RunLoop::disableIOWatcher(RunLoop::IOWatcher* ioWatcher,bool willDestroy)
 			missing events for the watcher that is currently the last entry.
 			*****************************************************************/
 			
-			/* Check if the run loop is currently handling I/O watchers and the to-be-disabled one is in the list not after the currently-handled one: */
+			/* Check if the run loop is currently handling I/O watchers via poll() and the to-be-disabled one is in the list not after the currently-handled one: */
 			unsigned int aiowi=ioWatcher->activeIndex; // List index of the to-be-disabled I/O watcher
 			unsigned int hiowi=handledIOWatcherIndex; // List index of the currently handled I/O watcher
-			if(handlingIOWatchers&&aiowi<=hiowi)
+			if(backend==Poll&&handlingIOWatchers&&aiowi<=hiowi)
 				{
 				/* Move the currently-handled I/O watcher to the place of the to-be-deleted one: */
 				activeIOWatchers[aiowi]=activeIOWatchers[hiowi];
@@ -638,6 +731,15 @@ void RunLoop::disableIOWatcher(RunLoop::IOWatcher* ioWatcher,bool willDestroy)
 				}
 			#endif
 			
+			/* Remove the I/O watcher from the epoll interest list and from the list of ready I/O watchers: */
+	#if THREADS_CONFIG_HAVE_EPOLL
+			if(backend==EPoll)
+				{
+				updateEpollInterest(ioWatcher,EPOLL_CTL_DEL,0x0);
+				forgetReadyIOWatcher(ioWatcher);
+				}
+	#endif
+			
 			/* Mark the I/O watcher as disabled: */
 			ioWatcher->enabled=false;
 			}
@@ -1446,6 +1548,10 @@ bool RunLoop::handlePipeMessages(void)
 					{
 					/* Update the I/O watcher's poll request: */
 					setPollRequestEvents(pollFds[ioWatcher->activeIndex+1],newEventMask);
+	#if THREADS_CONFIG_HAVE_EPOLL
+					if(backend==EPoll)
+						updateEpollInterest(ioWatcher,EPOLL_CTL_MOD,newEventMask);
+	#endif
 					}
 				
 				/* Update the I/O watcher's event mask: */
@@ -1462,6 +1568,12 @@ bool RunLoop::handlePipeMessages(void)
 				/* Check that the I/O watcher is not already enabled: */
 				if(!ioWatcher->enabled)
 					{
+					/* Add the I/O watcher's file descriptor to the epoll interest list first, in case that fails: */
+	#if THREADS_CONFIG_HAVE_EPOLL
+					if(backend==EPoll)
+						updateEpollInterest(ioWatcher,EPOLL_CTL_ADD,ioWatcher->eventMask);
+	#endif
+					
 					/* Append an entry for the I/O watcher to the end of the active lists: */
 					ActiveIOWatcher newIOWatcher;
 					newIOWatcher.watcher=ioWatcher;
@@ -1501,6 +1613,15 @@ bool RunLoop::handlePipeMessages(void)
 					activeIOWatchers[aiowi].watcher->activeIndex=aiowi;
 					--numActiveIOWatchers;
 					
+					/* Remove the I/O watcher from the epoll interest list and from the list of ready I/O watchers: */
+	#if THREADS_CONFIG_HAVE_EPOLL
+					if(backend==EPoll)
+						{
+						updateEpollInterest(ioWatcher,EPOLL_CTL_DEL,0x0);
+						forgetReadyIOWatcher(ioWatcher);
+						}
+	#endif
+					
 					/* Mark the I/O watcher as disabled: */
 					ioWatcher->enabled=false;
 					}
@@ -1855,11 +1976,13 @@ bool RunLoop::handlePipeMessages(void)
 	return true;
 	}
 
-RunLoop::RunLoop(void)
+RunLoop::RunLoop(RunLoop::Backend sBackend)
 	:threadId(Threads::Thread::getSelfId()),
 	 pipeClosed(false),
 	 messageBuffer(new PipeMessage[messageBufferSize]),
 	 numActiveIOWatchers(0),
+	 backend(sBackend),epollFd(-1),timerFd(-1),timerFdArmed(false),
+	 epollEvents(0),
 	 numSpinningProcessFunctions(0),
 	 shutdownRequested(false),
 	 handlingIOWatchers(false),
@@ -1875,6 +1998,40 @@ RunLoop::RunLoop(void)
 	pollFd.fd=pipeFds[0];
 	pollFd.events=POLLIN;
 	pollFds.push_back(pollFd);
+	
+	#if THREADS_CONFIG_HAVE_EPOLL
+	if(backend==EPoll)
+		{
+		/* Create the epoll instance and the timer file descriptor: */
+		epollFd=epoll_create1(EPOLL_CLOEXEC);
+		if(epollFd>=0)
+			timerFd=timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK|TFD_CLOEXEC);
+		if(epollFd<0||timerFd<0)
+			{
+			int error=errno;
+			if(epollFd>=0)
+				close(epollFd);
+			close(pipeFds[0]);
+			close(pipeFds[1]);
+			delete[] messageBuffer;
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,error,"Cannot create epoll instance");
+			}
+		
+		/* Watch the self-pipe's read end and the timer file descriptor, identified by null and the timer file descriptor's address, respectively: */
+		struct epoll_event event;
+		event.events=EPOLLIN;
+		event.data.ptr=0;
+		epoll_ctl(epollFd,EPOLL_CTL_ADD,pipeFds[0],&event);
+		event.data.ptr=&timerFd;
+		epoll_ctl(epollFd,EPOLL_CTL_ADD,timerFd,&event);
+		
+		/* Allocate the ready event array: */
+		epollEvents=new struct epoll_event[maxNumEpollEvents];
+		}
+	#else
+	/* Fall back to the poll backend on systems without epoll: */
+	backend=Poll;
+	#endif
 	}
 
 RunLoop::~RunLoop(void)
@@ -1914,6 +2071,16 @@ RunLoop::~RunLoop(void)
 	
 	/* Release the message buffer: */
 	delete[] messageBuffer;
+	
+	#if THREADS_CONFIG_HAVE_EPOLL
+	/* Close the epoll instance and the timer file descriptor: */
+	if(backend==EPoll)
+		{
+		close(timerFd);
+		close(epollFd);
+		delete[] epollEvents;
+		}
+	#endif
 	}
 
 RunLoop::IOWatcher* RunLoop::createIOWatcher(int fd,unsigned int eventMask,bool enabled,RunLoop::IOWatcher::EventHandler& eventHandler)
@@ -2096,85 +2263,168 @@ bool RunLoop::dispatchNextEvents(void)
 	if(shutdownRequested)
 		return false;
 	
-	#if 1 // On Linux, we have ppoll()
-	
-	/* Calculate a time-out for the poll() call: */
-	Interval pollTimeout(0,0); // In case we don't want to block, only poll
-	Interval* pt=0; // Assume that we'll block forever
-	if(numSpinningProcessFunctions>0)
-		{
-		/* Don't block for I/O events; only poll: */
-		pt=&pollTimeout;
-		}
-	else if(!activeTimers.empty())
-		{
-		/* Calculate the interval from now to the next timer to elapse: */
-		lastDispatchTime.set(); // We can't re-use the previous lastDispatchTime sample because time has passed in timer event handling
-		if(activeTimers[0].timeout>lastDispatchTime)
-			pollTimeout=activeTimers[0].timeout-lastDispatchTime;
-		pt=&pollTimeout;
-		}
-	
-	/* Block until an I/O event occurs or the time-out expires: */
-	int pollResult=ppoll(pollFds.data(),numActiveIOWatchers+1,pt,0); // Account for the extra watcher for the self-pipe's read end
-	
-	#else
-	
-	/* Calculate a time-out for the poll() call: */
-	int pollTimeout=-1; // Assume that we'll block forever
-	if(dontBlock||numSpinningProcessFunctions>0)
+	#if THREADS_CONFIG_HAVE_EPOLL
+	if(backend==EPoll)
 		{
-		/* Don't block for I/O events; only poll: */
-		pollTimeout=0;
+		/* Calculate a time-out for the epoll_wait() call: */
+		int epollTimeout=-1; // Assume that we'll block forever, or until the timer file descriptor elapses
+		if(numSpinningProcessFunctions>0)
+			{
+			/* Don't block for I/O events; only poll: */
+			epollTimeout=0;
+			}
+		else if(!activeTimers.empty())
+			{
+			/* Arm the timer file descriptor for the first active timer if it isn't already: */
+			if(!timerFdArmed||timerFdTimeout<activeTimers[0].timeout||activeTimers[0].timeout<timerFdTimeout)
+				{
+				struct itimerspec timerSpec;
+				timerSpec.it_interval.tv_sec=0;
+				timerSpec.it_interval.tv_nsec=0;
+				timerSpec.it_value=activeTimers[0].timeout;
+				if(timerfd_settime(timerFd,TFD_TIMER_ABSTIME,&timerSpec,0)<0)
+					throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot arm timer");
+				timerFdArmed=true;
+				timerFdTimeout=activeTimers[0].timeout;
+				}
+			}
+		
+		/* Block until an I/O event occurs or the timer file descriptor elapses: */
+		int numEvents=epoll_wait(epollFd,epollEvents,maxNumEpollEvents,epollTimeout);
+		if(numEvents<0&&errno!=EINTR)
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot wait for I/O events");
+		
+		/* Sample the current time: */
+		lastDispatchTime.set();
+		
+		/* Collect all ready I/O watchers, and check for messages on the self-pipe and an elapsed timer file descriptor: */
+		bool havePipeMessages=false;
+		for(int i=0;i<numEvents;++i)
+			{
+			if(epollEvents[i].data.ptr==0)
+				havePipeMessages=true;
+			else if(epollEvents[i].data.ptr==&timerFd)
+				{
+				/* Acknowledge the timer expiration; the elapsed timers will be handled on the next dispatch: */
+				uint64_t numExpirations;
+				if(read(timerFd,&numExpirations,sizeof(numExpirations))>0)
+					timerFdArmed=false;
+				}
+			else
+				{
+				ReadyIOWatcher riow;
+				riow.watcher=static_cast<IOWatcher*>(epollEvents[i].data.ptr);
+				riow.eventMask=getEpollEvents(epollEvents[i].events);
+				readyIOWatchers.push_back(riow);
+				}
+			}
+		
+		/* Handle messages on the self-pipe, which might disable some of the ready I/O watchers: */
+		if(havePipeMessages)
+			handlePipeMessages();
+		
+		/* Handle all ready I/O watchers: */
+		handlingIOWatchers=true;
+		IOWatcher::Event event(lastDispatchTime);
+		for(unsigned int i=0;i<readyIOWatchers.size();++i)
+			if(readyIOWatchers[i].watcher!=0)
+				{
+				/* Set the I/O watcher who is to receive this event: */
+				event.ioWatcher=readyIOWatchers[i].watcher;
+				
+				/* Set the bit mask of events that actually occurred and mask out events in which the I/O watcher is not interested: */
+				event.eventMask=readyIOWatchers[i].eventMask&(event.ioWatcher->eventMask|IOWatcher::ProblemMask); // Can't mask out "problem" indicators
+				
+				/* Call the I/O watcher's event handler: */
+				if(event.eventMask!=0x0)
+					(*event.ioWatcher->eventHandler)(event);
+				}
+		handlingIOWatchers=false;
+		readyIOWatchers.clear();
 		}
-	else if(!activeTimers.empty())
+	else
+	#endif
 		{
-		/* Calculate the interval from now to the next timer to elapse: */
-		lastDispatchTime.set(); // We can't re-use the previous lastTispatchTime sample because time has passed in timer event handling
-		if(activeTimers[0].timeout>lastDispatchTime)
+	#if 1 // On Linux, we have ppoll()
+		
+		/* Calculate a time-out for the poll() call: */
+		Interval pollTimeout(0,0); // In case we don't want to block, only poll
+		Interval* pt=0; // Assume that we'll block forever
+		if(numSpinningProcessFunctions>0)
 			{
-			Realtime::TimeVector timeout=activeTimers[0].timeout-lastDispatchTime;
-			pollTimeout=int(timeout.tv_sec*1000L+(timeout.tv_nsec+999999L)/1000000L); // poll() takes timeouts in ms, which is a tad unfortunate
+			/* Don't block for I/O events; only poll: */
+			pt=&pollTimeout;
 			}
-		else
+		else if(!activeTimers.empty())
+			{
+			/* Calculate the interval from now to the next timer to elapse: */
+			lastDispatchTime.set(); // We can't re-use the previous lastDispatchTime sample because time has passed in timer event handling
+			if(activeTimers[0].timeout>lastDispatchTime)
+				pollTimeout=activeTimers[0].timeout-lastDispatchTime;
+			pt=&pollTimeout;
+			}
+		
+		/* Block until an I/O event occurs or the time-out expires: */
+		int pollResult=ppoll(pollFds.data(),numActiveIOWatchers+1,pt,0); // Account for the extra watcher for the self-pipe's read end
+		
+	#else
+		
+		/* Calculate a time-out for the poll() call: */
+		int pollTimeout=-1; // Assume that we'll block forever
+		if(dontBlock||numSpinningProcessFunctions>0)
 			{
 			/* Don't block for I/O events; only poll: */
 			pollTimeout=0;
 			}
-		}
-	
-	/* Block until an I/O event occurs or the time-out expires: */
-	int pollResult=poll(pollFds.data(),numActiveIOWatchers+1,pollTimeout); // Account for the extra watcher for the self-pipe's read end
-	
-	/* Reset the no-block flag: */
-	dontBlock=false;
-	
-	#endif
-	
-	/* Sample the current time: */
-	lastDispatchTime.set();
-	
-	/* Handle messages on the self-pipe: */
-	if((pollFds[0].revents&POLLIN)!=0x0)
-		handlePipeMessages();
-	
-	/* Handle all active I/O watchers: */
-	handlingIOWatchers=true;
-	IOWatcher::Event event(lastDispatchTime);
-	for(handledIOWatcherIndex=0;handledIOWatcherIndex<numActiveIOWatchers;++handledIOWatcherIndex)
-		if(pollFds[handledIOWatcherIndex+1].revents!=0x0)
+		else if(!activeTimers.empty())
 			{
-			/* Set the I/O watcher who is to receive this event: */
-			event.ioWatcher=activeIOWatchers[handledIOWatcherIndex].watcher;
+			/* Calculate the interval from now to the next timer to elapse: */
+			lastDispatchTime.set(); // We can't re-use the previous lastTispatchTime sample because time has passed in timer event handling
+			if(activeTimers[0].timeout>lastDispatchTime)
+				{
+				Realtime::TimeVector timeout=activeTimers[0].timeout-lastDispatchTime;
+				pollTimeout=int(timeout.tv_sec*1000L+(timeout.tv_nsec+999999L)/1000000L); // poll() takes timeouts in ms, which is a tad unfortunate
+				}
+			else
+				{
+				/* Don't block for I/O events; only poll: */
+				pollTimeout=0;
+				}
+			}
+		
+		/* Block until an I/O event occurs or the time-out expires: */
+		int pollResult=poll(pollFds.data(),numActiveIOWatchers+1,pollTimeout); // Account for the extra watcher for the self-pipe's read end
+		
+		/* Reset the no-block flag: */
+		dontBlock=false;
+		
+	#endif
+		
+		/* Sample the current time: */
+		lastDispatchTime.set();
+		
+		/* Handle messages on the self-pipe: */
+		if((pollFds[0].revents&POLLIN)!=0x0)
+			handlePipeMessages();
+		
+		/* Handle all active I/O watchers: */
+		handlingIOWatchers=true;
+		IOWatcher::Event event(lastDispatchTime);
+		for(handledIOWatcherIndex=0;handledIOWatcherIndex<numActiveIOWatchers;++handledIOWatcherIndex)
+			if(pollFds[handledIOWatcherIndex+1].revents!=0x0)
+				{
+				/* Set the I/O watcher who is to receive this event: */
+				event.ioWatcher=activeIOWatchers[handledIOWatcherIndex].watcher;
 			
-			/* Set the bit mask of events that actually occurred and mask out events in which the I/O watcher is not interested: */
-			event.eventMask=getPollRequestEvents(pollFds[handledIOWatcherIndex+1]);
-			event.eventMask&=event.ioWatcher->eventMask|IOWatcher::ProblemMask; // Can't mask out "problem" indicators
+				/* Set the bit mask of events that actually occurred and mask out events in which the I/O watcher is not interested: */
+				event.eventMask=getPollRequestEvents(pollFds[handledIOWatcherIndex+1]);
+				event.eventMask&=event.ioWatcher->eventMask|IOWatcher::ProblemMask; // Can't mask out "problem" indicators
 			
-			/* Call the I/O watcher's event handler: */
-			(*event.ioWatcher->eventHandler)(event);
-			}
-	handlingIOWatchers=false;
+				/* Call the I/O watcher's event handler: */
+				(*event.ioWatcher->eventHandler)(event);
+				}
+		handlingIOWatchers=false;
+		}
 	
 	/* Handle all active process functions: */
 	handlingProcessFunctions=true;
@@ -2201,6 +2451,15 @@ void RunLoop::run(void)
 		
 		/* Re-enable the self-pipe's poll request: */
 		pollFds[0].fd=pipeFds[0];
+		#if THREADS_CONFIG_HAVE_EPOLL
+		if(backend==EPoll)
+			{
+			struct epoll_event event;
+			event.events=EPOLLIN;
+			event.data.ptr=0;
+			epoll_ctl(epollFd,EPOLL_CTL_ADD,pipeFds[0],&event);
+			}
+		#endif
 		
 		/* Mark the self-pipe as open: */
 		pipeClosed=false;
@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 /* Forward declarations: */
 struct pollfd;
+struct epoll_event;
 namespace Threads {
 template <class ParameterParam>
 class FunctionCall;
@@ -47,6 +48,12 @@ class RunLoop
 	typedef Realtime::TimePointMonotonic Time; // Type for absolute time points
 	typedef Realtime::TimeVector Interval; // Type for time intervals
 	
+	enum Backend // Enumerated type for operating system mechanisms to wait for I/O events
+		{
+		Poll, // Uses ppoll() on an array of all active I/O watchers; waiting and dispatching take time linear in the number of active I/O watchers
+		EPoll // Uses Linux's epoll and timerfd interfaces; waiting and dispatching take time linear in the number of ready I/O watchers, but each file descriptor can only be watched by a single active I/O watcher, and regular files cannot be watched; falls back to Poll on systems without epoll
+		};
+	
 	class IOWatcher:public RefCounted // Class to watch for I/O events on file descriptors
 		{
 		friend class RunLoop;
@@ -597,6 +604,8 @@ class RunLoop
 	struct ActiveIOWatcher; // Structure keeping track of currently active I/O watchers
 	typedef Misc::DynamicArray<ActiveIOWatcher> ActiveIOWatcherList; // Type for lists of active I/O watchers
 	typedef Misc::DynamicArray<struct pollfd> PollFdList; // Type for lists of polling request structures
+	struct ReadyIOWatcher; // Structure for I/O watchers that received events from epoll
+	typedef Misc::DynamicArray<ReadyIOWatcher> ReadyIOWatcherList; // Type for lists of ready I/O watchers
 	struct ActiveTimer; // Structure keeping track of currently active timers
 	struct RegisteredSignalHandler; // Structure keeping track of registered OS signal handlers
 	struct ActiveProcessFunction; // Structure keeping track of currently active process functions
@@ -613,6 +622,14 @@ class RunLoop
 	unsigned int numActiveIOWatchers; // Number of active I/O watchers
 	ActiveIOWatcherList activeIOWatchers; // List of currently active I/O watchers
 	PollFdList pollFds; // List of polling request structures paralleling the list of active I/O watchers, with an extra entry at the beginning for the self-pipe's read end
+	Backend backend; // Mechanism used to wait for I/O events
+	int epollFd; // File descriptor of the epoll instance if the epoll backend is used
+	int timerFd; // File descriptor of a timer elapsing at the time-out of the first active timer if the epoll backend is used
+	bool timerFdArmed; // Flag whether the timer file descriptor is currently armed
+	Time timerFdTimeout; // Time point at which the timer file descriptor is armed to elapse
+	static const int maxNumEpollEvents=256; // Maximum number of events retrieved by a single epoll_wait() call
+	struct epoll_event* epollEvents; // Array to retrieve ready events from epoll_wait()
+	ReadyIOWatcherList readyIOWatchers; // List of I/O watchers that received events in the current dispatch if the epoll backend is used
 	Misc::DynamicArray<ActiveTimer> activeTimers; // Priority heap of active timers sorted by next time-out; unfortunately, we can't use Misc::PriorityHeap due to the additional bookkeeping we require
 	Threads::Mutex signalHandlersMutex; // Mutex protecting the global table of registered signal handlers
 	static const int maxSignal=64; // Largest signum of any OS signal
@@ -628,6 +645,8 @@ class RunLoop
 	
 	/* Private methods: */
 	bool writePipeMessage(const PipeMessage& pm,const char* methodName,RefCounted* messageObject =0); // Writes a message to the self-pipe; adds a reference to the given object if the write succeeds; returns false if the self-pipe was closed during run loop shutdown, throws exception on other errors
+	void updateEpollInterest(IOWatcher* ioWatcher,int operation,unsigned int eventMask); // Adds, modifies, or removes the given I/O watcher's file descriptor to/from the epoll interest list
+	void forgetReadyIOWatcher(IOWatcher* ioWatcher); // Removes the given I/O watcher from the list of ready I/O watchers after it was disabled
 	
 	/* Internal interface for I/O watchers: */
 	void setIOWatcherEventMask(IOWatcher* ioWatcher,unsigned int newEventMask); // Sets bit mask of I/O events in which the given I/O watcher is interested
@@ -668,9 +687,15 @@ class RunLoop
 	
 	/* Constructors and destructors: */
 	public:
-	RunLoop(void); // Creates a run loop associated with the calling thread
+	RunLoop(Backend sBackend =Poll); // Creates a run loop associated with the calling thread, using the given mechanism to wait for I/O events
 	~RunLoop(void);
 	
+	/* Methods: */
+	Backend getBackend(void) const // Returns the mechanism used to wait for I/O events
+		{
+		return backend;
+		}
+	
 	/* Methods to create events handlers: */
 	IOWatcher* createIOWatcher(int fd,unsigned int eventMask,bool enabled,IOWatcher::EventHandler& eventHandler); // Creates an I/O watcher
 	Timer* createTimer(const Time& timeout,Timer::EventHandler& eventHandler); // Creates an enabled one-shot timer that will automatically be disabled when the timer elapses
@@ -40,7 +40,8 @@ void* RunLoopThread::threadMethod(void)
 	return 0;
 	}
 
-RunLoopThread::RunLoopThread(void)
+RunLoopThread::RunLoopThread(RunLoop::Backend sBackend)
+	:RunLoop(sBackend)
 	{
 	/* Start the background thread: */
 	thread.start(this,&RunLoopThread::threadMethod);
@@ -39,7 +39,7 @@ class RunLoopThread:public RunLoop
 	
 	/* Constructors and destructors: */
 	public:
-	RunLoopThread(void); // Creates a run loop running in a new background thread
+	RunLoopThread(Backend sBackend =Poll); // Creates a run loop running in a new background thread, using the given mechanism to wait for I/O events
 	~RunLoopThread(void); // Shuts down the run loop and terminates its background thread
 	};
 
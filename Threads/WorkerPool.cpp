@@ -1,7 +1,9 @@
 /***********************************************************************
 WorkerPool - Class to represent a set of worker pools that
-asynchronously execute submitted one-off jobs.
-Copyright (c) 2022-2024 Oliver Kreylos
+asynchronously execute submitted one-off jobs, groups of dependent jobs,
+and parallel loops over index ranges, using per-worker job queues with
+work stealing.
+Copyright (c) 2022-2026 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -22,14 +24,32 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Threads/WorkerPool.h>
 
+#include <string>
 #include <stdexcept>
 #include <Misc/Autopointer.h>
-#include <Threads/FunctionCalls.h>
+#include <Misc/StdError.h>
 #include <Misc/MessageLogger.h>
+#include <Threads/Config.h>
+#include <Threads/FunctionCalls.h>
 #include <Threads/Thread.h>
 
 namespace Threads {
 
+namespace {
+
+/****************
+Helper variables:
+****************/
+
+/* Index of the worker pool thread executing the current thread plus one, or zero if the current thread is not a worker: */
+#if THREADS_CONFIG_HAVE_BUILTIN_TLS
+__thread size_t currentWorkerIndex=0;
+#else
+size_t currentWorkerIndex=0; // Without thread-local storage, all threads are treated as non-workers
+#endif
+
+}
+
 /********************************************
 Declaration of struct WorkerPool::Submission:
 ********************************************/
@@ -42,27 +62,129 @@ struct WorkerPool::Submission
 	Misc::Autopointer<JobCompleteCallback> completeCallback; // Callback to call from worker thread when job is finished
 	EventDispatcher* dispatcher; // Event dispatcher to which to send a signal when job is finished
 	EventDispatcher::ListenerKey signalKey; // Listener key of signal to send when job is finished
+	JobGroup* group; // Job group to notify when the job is finished
+	bool rangeHelper; // Flag whether the job helps process a parallel loop; such jobs never keep the pool from shutting down
 	
 	/* Constructors and destructors: */
 	Submission(void) // Dummy constructor
-		:dispatcher(0),signalKey(0)
+		:dispatcher(0),signalKey(0),group(0),rangeHelper(false)
 		{
 		}
-	Submission(JobFunction& sJob) // Creates a submission for a job without a completion callback
+	Submission(JobFunction& sJob,JobGroup* sGroup =0) // Creates a submission for a job without a completion callback
 		:job(&sJob),
-		 dispatcher(0),signalKey(0)
+		 dispatcher(0),signalKey(0),group(sGroup),rangeHelper(false)
 		{
 		}
 	Submission(JobFunction& sJob,JobCompleteCallback& sCompleteCallback) // Creates a submission for a job with a completion callback
 		:job(&sJob),
 		 completeCallback(&sCompleteCallback),
-		 dispatcher(0),signalKey(0)
+		 dispatcher(0),signalKey(0),group(0),rangeHelper(false)
 		{
 		}
 	Submission(JobFunction& sJob,EventDispatcher& sDispatcher,EventDispatcher::ListenerKey sSignalKey) // Creates a submission for a job with a completion signal on the given event dispatcher
 		:job(&sJob),
-		 dispatcher(&sDispatcher),signalKey(sSignalKey)
+		 dispatcher(&sDispatcher),signalKey(sSignalKey),group(0),rangeHelper(false)
+		{
+		}
+	};
+
+/****************************************************
+Declaration of struct WorkerPool::DeferredSubmission:
+****************************************************/
+
+struct WorkerPool::DeferredSubmission
+	{
+	/* Elements: */
+	public:
+	DeferredSubmission* succ; // Pointer to the next deferred submission in the same job group
+	Submission submission; // The deferred submission
+	
+	/* Constructors and destructors: */
+	DeferredSubmission(const Submission& sSubmission)
+		:succ(0),submission(sSubmission)
+		{
+		}
+	};
+
+/*********************************************
+Declaration of struct WorkerPool::WorkerQueue:
+*********************************************/
+
+struct WorkerPool::WorkerQueue
+	{
+	/* Elements: */
+	public:
+	Threads::Spinlock queueLock; // Lock protecting the queue
+	SubmissionQueue queue; // Queue of pending jobs; the owning worker takes jobs from the back, other threads steal from the front
+	
+	/* Constructors and destructors: */
+	WorkerQueue(void)
+		:queue(16)
+		{
+		}
+	};
+
+/******************************************
+Declaration of struct WorkerPool::RangeJob:
+******************************************/
+
+struct WorkerPool::RangeJob:public JobFunction
+	{
+	/* Elements: */
+	public:
+	RangeFunction& function; // Function to call on each chunk
+	size_t begin,end; // The full index range
+	size_t grainSize; // Size of each chunk
+	size_t numChunks; // Total number of chunks
+	Threads::Atomic<size_t> nextChunk; // Index of the next chunk to be claimed
+	Threads::MutexCond completionCond; // Condition variable protecting the completion state and signalling completion of all chunks
+	size_t numUnfinishedChunks; // Number of chunks that have not yet been processed
+	std::string errorMessage; // Error message of the first chunk that terminated with an exception
+	
+	/* Constructors and destructors: */
+	RangeJob(RangeFunction& sFunction,size_t sBegin,size_t sEnd,size_t sGrainSize)
+		:function(sFunction),begin(sBegin),end(sEnd),grainSize(sGrainSize),
+		 numChunks((end-begin+grainSize-1)/grainSize),
+		 nextChunk(0),
+		 numUnfinishedChunks(numChunks)
+		{
+		}
+	
+	/* Methods from class JobFunction: */
+	virtual void operator()(int)
+		{
+		processChunks();
+		}
+	
+	/* New methods: */
+	void processChunks(void) // Processes chunks until all chunks have been claimed
 		{
+		/* Claim chunks until there are none left: */
+		size_t chunkIndex;
+		while((chunkIndex=nextChunk.postAdd(1))<numChunks)
+			{
+			/* Process the chunk: */
+			size_t chunkBegin=begin+chunkIndex*grainSize;
+			size_t chunkEnd=chunkBegin+grainSize;
+			if(chunkEnd>end)
+				chunkEnd=end;
+			std::string chunkError;
+			try
+				{
+				function(chunkBegin,chunkEnd);
+				}
+			catch(const std::exception& err)
+				{
+				chunkError=err.what();
+				}
+			
+			/* Mark the chunk as finished: */
+			MutexCond::Lock completionLock(completionCond);
+			if(!chunkError.empty()&&errorMessage.empty())
+				errorMessage=chunkError;
+			if(--numUnfinishedChunks==0)
+				completionCond.broadcast();
+			}
 		}
 	};
 
@@ -72,111 +194,282 @@ Static elements of class WorkerPool:
 
 WorkerPool WorkerPool::theWorkerPool(8);
 
+/*************************************
+Methods of class WorkerPool::JobGroup:
+*************************************/
+
+WorkerPool::JobGroup::JobGroup(void)
+	:numPendingJobs(0),
+	 deferredHead(0),deferredTail(0)
+	{
+	}
+
+WorkerPool::JobGroup::~JobGroup(void)
+	{
+	/* Wait until no more jobs refer to this group: */
+	wait();
+	}
+
+void WorkerPool::JobGroup::wait(void)
+	{
+	if(currentWorkerIndex!=0)
+		{
+		/* Keep the worker thread busy while waiting to prevent deadlock: */
+		theWorkerPool.helpUntilComplete(currentWorkerIndex-1,*this);
+		}
+	else
+		{
+		/* Block until the last job in the group finishes: */
+		MutexCond::Lock completionLock(completionCond);
+		while(numPendingJobs.get()!=0)
+			completionCond.wait(completionLock);
+		}
+	}
+
 /***************************
 Methods of class WorkerPool:
 ***************************/
 
-void* WorkerPool::workerThreadMethod(void)
+void* WorkerPool::workerThreadMethod(size_t workerIndex)
 	{
 	/* Enable asynchronous cancellation for this thread: */
 	Thread::setCancelState(Thread::CANCEL_ENABLE);
 	Thread::setCancelType(Thread::CANCEL_ASYNCHRONOUS);
 	
+	/* Remember which worker this thread is: */
+	currentWorkerIndex=workerIndex+1;
+	
 	/* Keep waiting for and executing jobs until the pool shuts down: */
 	while(keepRunning)
 		{
-		/* Wait for the next job: */
+		/* Grab the next job from this worker's own queue or from another worker's queue: */
 		Submission submission;
-		{
-		MutexCond::Lock submissionCondLock(submissionCond);
-		
-		/* Wait while the submission queue is empty: */
-		++numIdleWorkers;
-		while(keepRunning&&submissionQueue.empty())
-			submissionCond.wait(submissionCondLock);
-		--numIdleWorkers;
-		
-		/* Bail out if shutting down: */
-		if(!keepRunning)
-			break;
-		
-		/* Grab the next job submission from the queue: */
-		submission=submissionQueue.front();
-		submissionQueue.pop_front();
-		}
-		
-		try
+		if(grabJob(workerIndex,submission))
 			{
-			/* Execute the next job: */
-			(*submission.job)(0);
-			
-			/* Only emit callbacks or signals if the worker pool is not shutting down: */
-			bool signalCompletion;
+			/* Execute the job: */
+			executeJob(submission);
+			}
+		else
 			{
 			MutexCond::Lock submissionCondLock(submissionCond);
-			signalCompletion=keepRunning;
-			}
 			
-			if(signalCompletion)
+			/* Wait while all queues are empty: */
+			numIdleWorkers.preAdd(1);
+			while(keepRunning&&numQueuedJobs.get()==0)
+				submissionCond.wait(submissionCondLock);
+			numIdleWorkers.preSub(1);
+			}
+		}
+	
+	return 0;
+	}
+
+bool WorkerPool::grabJob(size_t workerIndex,WorkerPool::Submission& submission)
+	{
+	/* Bail out early if there are no queued jobs anywhere: */
+	if(numQueuedJobs.get()==0)
+		return false;
+	
+	/* Take the most recently submitted job from the worker's own queue to benefit from cache locality: */
+	{
+	WorkerQueue& wq=workerQueues[workerIndex];
+	Spinlock::Lock queueLock(wq.queueLock);
+	if(!wq.queue.empty())
+		{
+		submission=wq.queue.back();
+		wq.queue.pop_back();
+		numQueuedJobs.preSub(1);
+		return true;
+		}
+	}
+	
+	/* Steal the oldest job from one of the other workers' queues: */
+	size_t numWorkers=numActiveWorkers;
+	for(size_t i=1;i<numWorkers;++i)
+		{
+		WorkerQueue& wq=workerQueues[(workerIndex+i)%numWorkers];
+		Spinlock::Lock queueLock(wq.queueLock);
+		if(!wq.queue.empty())
+			{
+			submission=wq.queue.front();
+			wq.queue.pop_front();
+			numQueuedJobs.preSub(1);
+			return true;
+			}
+		}
+	
+	return false;
+	}
+
+void WorkerPool::executeJob(WorkerPool::Submission& submission)
+	{
+	/* Count this worker as busy unless the job is a parallel loop helper, which finishes on its own: */
+	if(!submission.rangeHelper)
+		numBusyWorkers.preAdd(1);
+	
+	try
+		{
+		/* Execute the job: */
+		(*submission.job)(0);
+		
+		/* Only emit callbacks or signals if the worker pool is not shutting down: */
+		if(keepRunning)
+			{
+			/* Tell someone that the job has finished: */
+			if(submission.dispatcher!=0)
 				{
-				/* Tell someone that the job has finished: */
-				if(submission.dispatcher!=0)
-					{
-					/* Add an additional reference to the job object and send a signal to the dispatcher: */
-					submission.job->ref();
-					submission.dispatcher->signal(submission.signalKey,submission.job.getPointer());
-					}
-				else if(submission.completeCallback!=0)
-					{
-					/* Call the completion callback: */
-					(*submission.completeCallback)(submission.job.getPointer());
-					}
+				/* Add an additional reference to the job object and send a signal to the dispatcher: */
+				submission.job->ref();
+				submission.dispatcher->signal(submission.signalKey,submission.job.getPointer());
+				}
+			else if(submission.completeCallback!=0)
+				{
+				/* Call the completion callback: */
+				(*submission.completeCallback)(submission.job.getPointer());
 				}
 			}
-		catch(const std::runtime_error& err)
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Do something useful... */
+		Misc::formattedUserError("Threads::WorkerPool: Job terminated with exception %s",err.what());
+		}
+	if(!submission.rangeHelper)
+		numBusyWorkers.preSub(1);
+	
+	/* Notify the job's group that the job has finished, even if it failed: */
+	if(submission.group!=0)
+		finishGroupJob(*submission.group);
+	}
+
+void WorkerPool::finishGroupJob(WorkerPool::JobGroup& group)
+	{
+	/* Decrement the group's pending job counter: */
+	DeferredSubmission* deferred=0;
+	{
+	MutexCond::Lock completionLock(group.completionCond);
+	if(group.numPendingJobs.preSub(1)!=0)
+		return;
+	
+	/* Take the group's list of deferred submissions and wake up all threads waiting on the group: */
+	deferred=group.deferredHead;
+	group.deferredHead=group.deferredTail=0;
+	group.completionCond.broadcast();
+	}
+	
+	/* The group might have been destroyed at this point; wake up any worker threads waiting on groups while idle: */
+	if(numWaitingHelpers.get()!=0)
+		{
+		MutexCond::Lock submissionCondLock(submissionCond);
+		submissionCond.broadcast();
+		}
+	
+	/* Submit all deferred jobs: */
+	while(deferred!=0)
+		{
+		DeferredSubmission* succ=deferred->succ;
+		submitJob(deferred->submission);
+		delete deferred;
+		deferred=succ;
+		}
+	}
+
+void WorkerPool::helpUntilComplete(size_t workerIndex,WorkerPool::JobGroup& group)
+	{
+	while(group.numPendingJobs.get()!=0)
+		{
+		/* Execute another pending job if there is one: */
+		Submission submission;
+		if(grabJob(workerIndex,submission))
+			executeJob(submission);
+		else
 			{
-			/* Do something useful... */
-			Misc::formattedUserError("Threads::WorkerPool: Job terminated with exception %s",err.what());
+			MutexCond::Lock submissionCondLock(submissionCond);
+			
+			/* Wait while all queues are empty and the group is not yet complete: */
+			numWaitingHelpers.preAdd(1);
+			numIdleWorkers.preAdd(1);
+			while(keepRunning&&numQueuedJobs.get()==0&&group.numPendingJobs.get()!=0)
+				submissionCond.wait(submissionCondLock);
+			numIdleWorkers.preSub(1);
+			numWaitingHelpers.preSub(1);
+			
+			/* Bail out if shutting down: */
+			if(!keepRunning)
+				break;
 			}
 		}
 	
-	return 0;
+	/* Synchronize with the thread that finished the group's last job: */
+	MutexCond::Lock completionLock(group.completionCond);
 	}
 
 void WorkerPool::submitJob(const WorkerPool::Submission& submission)
 	{
-	MutexCond::Lock submissionCondLock(submissionCond);
-	
-	/* Remember if the submission queue was empty: */
-	bool empty=submissionQueue.empty();
+	/* Spin up a new worker thread if there are no idle workers and there is room left in the worker pool: */
+	if(numIdleWorkers.get()==0&&numActiveWorkers<maxNumWorkers)
+		{
+		MutexCond::Lock submissionCondLock(submissionCond);
+		if(numActiveWorkers<maxNumWorkers&&keepRunning)
+			{
+			/* Start the next worker thread: */
+			workers[numActiveWorkers].start(this,&WorkerPool::workerThreadMethod,size_t(numActiveWorkers));
+			++numActiveWorkers;
+			}
+		}
 	
-	/* Post the given submission structure to the submission queue: */
-	submissionQueue.push_back(submission);
+	/* Post the given submission structure to the submitting worker's own queue, or to the next queue in round-robin order: */
+	size_t queueIndex=0;
+	if(currentWorkerIndex!=0)
+		queueIndex=currentWorkerIndex-1;
+	else if(numActiveWorkers>1)
+		queueIndex=nextSubmissionQueue.postAdd(1)%numActiveWorkers;
+	{
+	WorkerQueue& wq=workerQueues[queueIndex];
+	Spinlock::Lock queueLock(wq.queueLock);
+	wq.queue.push_back(submission);
+	}
 	
-	/* Spin up a new worker thread if there are no idle workers and there is room left in the worker pool: */
-	if(numActiveWorkers<maxNumWorkers&&numIdleWorkers==0)
+	/* Wake up an idle worker thread if there is one: */
+	numQueuedJobs.preAdd(1);
+	if(numIdleWorkers.get()!=0)
+		{
+		MutexCond::Lock submissionCondLock(submissionCond);
+		if(numWaitingHelpers.get()!=0)
+			submissionCond.broadcast();
+		else
+			submissionCond.signal();
+		}
+	}
+
+void WorkerPool::submitJob(WorkerPool::JobGroup& prerequisites,const WorkerPool::Submission& submission)
+	{
+	{
+	MutexCond::Lock completionLock(prerequisites.completionCond);
+	if(prerequisites.numPendingJobs.get()!=0)
 		{
-		/* Allocate the worker thread array if it hasn't been done yet: */
-		if(workers==0)
-			workers=new Thread[maxNumWorkers];
+		/* Append the submission to the prerequisite group's list of deferred submissions: */
+		DeferredSubmission* ds=new DeferredSubmission(submission);
+		if(prerequisites.deferredTail!=0)
+			prerequisites.deferredTail->succ=ds;
+		else
+			prerequisites.deferredHead=ds;
+		prerequisites.deferredTail=ds;
 		
-		/* Start the next worker thread: */
-		workers[numActiveWorkers].start(this,&WorkerPool::workerThreadMethod);
-		++numActiveWorkers;
+		return;
 		}
+	}
 	
-	/* Wake up a worker thread if the submission queue was empty: */
-	if(empty)
-		submissionCond.signal();
+	/* The prerequisite group is already complete; submit the job immediately: */
+	submitJob(submission);
 	}
 
 void WorkerPool::doShutdown(void)
 	{
 	/* Signal all active workers that the pool is being shut down: */
-	size_t numActiveJobs=0;
 	{
 	MutexCond::Lock submissionCondLock(submissionCond);
-	numActiveJobs=numActiveWorkers-numIdleWorkers;
+	size_t numActiveJobs=numBusyWorkers.get();
 	keepRunning=false;
 	submissionCond.broadcast();
 	
@@ -193,13 +486,55 @@ void WorkerPool::doShutdown(void)
 	for(size_t i=0;i<numActiveWorkers;++i)
 		workers[i].join();
 	numActiveWorkers=0;
-	numIdleWorkers=0;
+	}
+
+void WorkerPool::runRangeFunction(size_t begin,size_t end,size_t grainSize,WorkerPool::RangeFunction& function)
+	{
+	/* Bail out if the range is empty: */
+	if(end<=begin)
+		return;
+	
+	/* Calculate a default chunk size if none was given: */
+	if(grainSize==0)
+		grainSize=getDefaultGrainSize(end-begin);
+	
+	/* Process the range directly if it is a single chunk or the pool has been shut down: */
+	if(end-begin<=grainSize||!theWorkerPool.keepRunning)
+		{
+		for(size_t chunkBegin=begin;chunkBegin<end;chunkBegin+=grainSize)
+			function(chunkBegin,end-chunkBegin>grainSize?chunkBegin+grainSize:end);
+		return;
+		}
+	
+	/* Create a range job and submit it to enough workers to process all chunks, keeping one chunk for the calling thread: */
+	Misc::Autopointer<RangeJob> job(new RangeJob(function,begin,end,grainSize));
+	Submission helper(*job);
+	helper.rangeHelper=true;
+	size_t numHelpers=job->numChunks-1;
+	if(numHelpers>theWorkerPool.maxNumWorkers)
+		numHelpers=theWorkerPool.maxNumWorkers;
+	for(size_t i=0;i<numHelpers;++i)
+		theWorkerPool.submitJob(helper);
+	
+	/* Process chunks from the calling thread until all chunks are claimed: */
+	job->processChunks();
+	
+	/* Wait until all chunks claimed by worker threads are finished; helper jobs that did not claim any chunks no longer access the range function: */
+	{
+	MutexCond::Lock completionLock(job->completionCond);
+	while(job->numUnfinishedChunks!=0)
+		job->completionCond.wait(completionLock);
+	}
+	
+	/* Forward any exception that occurred during processing: */
+	if(!job->errorMessage.empty())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Parallel loop terminated with exception %s",job->errorMessage.c_str());
 	}
 
 WorkerPool::WorkerPool(size_t sMaxNumWorkers)
-	:maxNumWorkers(sMaxNumWorkers),workers(0),
-	 numActiveWorkers(0),numIdleWorkers(0),
-	 submissionQueue(16),
+	:maxNumWorkers(sMaxNumWorkers),
+	 workers(new Thread[maxNumWorkers]),workerQueues(new WorkerQueue[maxNumWorkers]),
+	 numActiveWorkers(0),numIdleWorkers(0),numBusyWorkers(0),numQueuedJobs(0),numWaitingHelpers(0),nextSubmissionQueue(0),
 	 keepRunning(true)
 	{
 	}
@@ -211,6 +546,7 @@ WorkerPool::~WorkerPool(void)
 	
 	/* Clean up: */
 	delete[] workers;
+	delete[] workerQueues;
 	}
 
 void WorkerPool::shutdown(void)
@@ -237,4 +573,32 @@ void WorkerPool::submitJob(WorkerPool::JobFunction& job,EventDispatcher& dispatc
 	theWorkerPool.submitJob(Submission(job,dispatcher,signalKey));
 	}
 
+void WorkerPool::submitJob(WorkerPool::JobFunction& job,WorkerPool::JobGroup& group)
+	{
+	/* Add the job to the group and submit it: */
+	group.numPendingJobs.preAdd(1);
+	theWorkerPool.submitJob(Submission(job,&group));
+	}
+
+void WorkerPool::submitJob(WorkerPool::JobGroup& prerequisites,WorkerPool::JobFunction& job)
+	{
+	/* Submit the job once the prerequisites are complete: */
+	theWorkerPool.submitJob(prerequisites,Submission(job));
+	}
+
+void WorkerPool::submitJob(WorkerPool::JobGroup& prerequisites,WorkerPool::JobFunction& job,WorkerPool::JobGroup& group)
+	{
+	/* Add the job to the group and submit it once the prerequisites are complete: */
+	group.numPendingJobs.preAdd(1);
+	theWorkerPool.submitJob(prerequisites,Submission(job,&group));
+	}
+
+size_t WorkerPool::getDefaultGrainSize(size_t rangeSize)
+	{
+	/* Split the range into four chunks per worker thread plus the calling thread to balance load: */
+	size_t numChunks=(theWorkerPool.maxNumWorkers+1)*4;
+	size_t grainSize=(rangeSize+numChunks-1)/numChunks;
+	return grainSize>0?grainSize:1;
+	}
+
 }
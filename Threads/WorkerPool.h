@@ -1,7 +1,9 @@
 /***********************************************************************
 WorkerPool - Class to represent a set of worker pools that
-asynchronously execute submitted one-off jobs.
-Copyright (c) 2022-2024 Oliver Kreylos
+asynchronously execute submitted one-off jobs, groups of dependent jobs,
+and parallel loops over index ranges, using per-worker job queues with
+work stealing.
+Copyright (c) 2022-2026 Oliver Kreylos
 
 This file is part of the Portable Threading Library (Threads).
 
@@ -24,7 +26,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define THREADS_WORKERPOOL_INCLUDED
 
 #include <stddef.h>
+#include <vector>
 #include <Misc/RingBuffer.h>
+#include <Threads/Atomic.h>
+#include <Threads/Spinlock.h>
 #include <Threads/MutexCond.h>
 #include <Threads/EventDispatcher.h>
 
@@ -46,23 +51,125 @@ class WorkerPool
 	
 	private:
 	struct Submission; // Structure holding a pending submitted job
+	struct DeferredSubmission; // Structure holding a job submission waiting for a job group to complete
 	typedef Misc::RingBuffer<Submission> SubmissionQueue; // Type for queues of pending job submissions
+	struct WorkerQueue; // Structure holding the job queue of a single worker thread
+	
+	public:
+	class JobGroup // Class to join on a group of submitted jobs, and to defer submission of dependent jobs until the group is complete
+		{
+		friend class WorkerPool;
+		
+		/* Elements: */
+		private:
+		Threads::MutexCond completionCond; // Condition variable protecting the group's state and signalling group completion
+		Threads::Atomic<size_t> numPendingJobs; // Number of jobs in the group that have been submitted or deferred, but not yet finished
+		DeferredSubmission* deferredHead; // Head of list of job submissions waiting for this group to complete
+		DeferredSubmission* deferredTail; // Tail of list of job submissions waiting for this group to complete
+		
+		/* Constructors and destructors: */
+		public:
+		JobGroup(void); // Creates an empty job group
+		private:
+		JobGroup(const JobGroup& source); // Prohibit copy constructor
+		JobGroup& operator=(const JobGroup& source); // Prohibit assignment operator
+		public:
+		~JobGroup(void); // Waits until all jobs in the group have finished and destroys the group
+		
+		/* Methods: */
+		bool isComplete(void) const // Returns true if all jobs in the group have finished
+			{
+			return numPendingJobs.get()==0;
+			}
+		void wait(void); // Blocks until all jobs in the group have finished; when called from a worker thread, executes other pending jobs while waiting
+		};
+	
+	class RangeFunction // Abstract base class for functions processing a sub-range of an index range from several threads in parallel
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~RangeFunction(void)
+			{
+			}
+		
+		/* Methods: */
+		virtual void operator()(size_t rangeBegin,size_t rangeEnd) =0; // Processes the half-open index range [rangeBegin, rangeEnd)
+		};
+	
+	private:
+	template <class FunctorParam>
+	class RangeFunctorAdapter:public RangeFunction // Adapter to call a generic functor on sub-ranges
+		{
+		/* Elements: */
+		private:
+		FunctorParam& functor; // Functor taking a half-open index range
+		
+		/* Constructors and destructors: */
+		public:
+		RangeFunctorAdapter(FunctorParam& sFunctor)
+			:functor(sFunctor)
+			{
+			}
+		
+		/* Methods from class RangeFunction: */
+		virtual void operator()(size_t rangeBegin,size_t rangeEnd)
+			{
+			functor(rangeBegin,rangeEnd);
+			}
+		};
+	
+	template <class ValueParam,class ReducerParam>
+	class RangeReducerAdapter:public RangeFunction // Adapter to reduce sub-ranges into an array of per-chunk partial results
+		{
+		/* Elements: */
+		private:
+		ReducerParam& reducer; // Reducer functor
+		size_t begin; // Beginning of the full index range
+		size_t grainSize; // Size of each chunk
+		std::vector<ValueParam>& partials; // Array of per-chunk partial results
+		
+		/* Constructors and destructors: */
+		public:
+		RangeReducerAdapter(ReducerParam& sReducer,size_t sBegin,size_t sGrainSize,std::vector<ValueParam>& sPartials)
+			:reducer(sReducer),begin(sBegin),grainSize(sGrainSize),partials(sPartials)
+			{
+			}
+		
+		/* Methods from class RangeFunction: */
+		virtual void operator()(size_t rangeBegin,size_t rangeEnd)
+			{
+			ValueParam& partial=partials[(rangeBegin-begin)/grainSize];
+			partial=reducer(rangeBegin,rangeEnd,partial);
+			}
+		};
+	
+	struct RangeJob; // Structure representing a parallel loop over an index range
 	
 	/* Elements: */
 	private:
 	static WorkerPool theWorkerPool; // Static worker pool
 	size_t maxNumWorkers; // Maximum number of active worker threads
 	Thread* workers; // Array of worker threads
-	size_t numActiveWorkers; // Number of currently active worker threads
-	size_t numIdleWorkers; // Number of threads currently waiting for new job submissions
-	Threads::MutexCond submissionCond; // Condition variable protecting the job submission queue and signalling the arrival of new jobs
-	SubmissionQueue submissionQueue; // Dynamically growing ring buffer holding pending submitted jobs
+	WorkerQueue* workerQueues; // Array of per-worker job queues
+	volatile size_t numActiveWorkers; // Number of currently active worker threads
+	Threads::Atomic<size_t> numIdleWorkers; // Number of threads currently waiting for new job submissions
+	Threads::Atomic<size_t> numBusyWorkers; // Number of threads currently executing jobs other than parallel loop helpers
+	Threads::Atomic<size_t> numQueuedJobs; // Total number of jobs in all worker queues
+	Threads::Atomic<size_t> numWaitingHelpers; // Number of worker threads waiting on job groups while idle
+	Threads::Atomic<size_t> nextSubmissionQueue; // Round-robin counter to distribute jobs submitted from outside the pool
+	Threads::MutexCond submissionCond; // Condition variable serializing worker thread creation and signalling the arrival of new jobs to idle workers
 	volatile bool keepRunning; // Flag to request the worker threads to shut down on pool destruction
 	
 	/* Private methods: */
-	void* workerThreadMethod(void); // Method executing a worker thread
+	void* workerThreadMethod(size_t workerIndex); // Method executing a worker thread
+	bool grabJob(size_t workerIndex,Submission& submission); // Removes a job from the given worker's queue, or steals one from another worker's queue; returns false if all queues are empty
+	void executeJob(Submission& submission); // Executes the given job and signals its completion
+	void finishGroupJob(JobGroup& group); // Notifies the given job group that one of its jobs finished
+	void helpUntilComplete(size_t workerIndex,JobGroup& group); // Executes pending jobs from the given worker thread until the given job group is complete
 	void submitJob(const Submission& submission); // Submits the given job submission structure
+	void submitJob(JobGroup& prerequisites,const Submission& submission); // Submits the given job submission structure once the given job group is complete
 	void doShutdown(void); // Shuts down the worker pool
+	static void runRangeFunction(size_t begin,size_t end,size_t grainSize,RangeFunction& function); // Calls the given range function on chunks of the given index range in parallel
 	
 	/* Constructors and destructors: */
 	private:
@@ -71,10 +178,44 @@ class WorkerPool
 	
 	/* Methods: */
 	public:
+	static size_t getMaxNumWorkers(void) // Returns the maximum number of worker threads in the pool
+		{
+		return theWorkerPool.maxNumWorkers;
+		}
 	static void shutdown(void); // Shuts down the worker pool and blocks until all currently active jobs finish; no completion callbacks or signals will be emitted, and function objects will be destroyed
 	static void submitJob(JobFunction& job); // Executes the given job function asynchronously from a worker pool thread
 	static void submitJob(JobFunction& job,JobCompleteCallback& completeCallback); // Executes the given job function asynchronously from a worker pool thread; calls given callback from worker thread when job is finished
 	static void submitJob(JobFunction& job,EventDispatcher& dispatcher,EventDispatcher::ListenerKey signalKey); // Ditto, but raises a signal for the given listener key on the given event dispatcher with a plain pointer to the job function as signal data; the pointer will have an extra reference, the signal handler must unref() the object
+	static void submitJob(JobFunction& job,JobGroup& group); // Executes the given job function asynchronously from a worker pool thread as part of the given job group
+	static void submitJob(JobGroup& prerequisites,JobFunction& job); // Executes the given job function asynchronously from a worker pool thread after all jobs in the given prerequisite group have finished
+	static void submitJob(JobGroup& prerequisites,JobFunction& job,JobGroup& group); // Ditto, as part of the given job group; the prerequisite group must not be the same as the job's group
+	template <class FunctorParam>
+	static void parallelFor(size_t begin,size_t end,size_t grainSize,FunctorParam& functor) // Calls functor(rangeBegin,rangeEnd) on chunks of at most grainSize indices (automatic if zero) covering [begin, end) from the calling thread and worker threads in parallel; returns when all chunks are processed
+		{
+		RangeFunctorAdapter<FunctorParam> adapter(functor);
+		runRangeFunction(begin,end,grainSize,adapter);
+		}
+	template <class ValueParam,class ReducerParam,class CombinerParam>
+	static ValueParam parallelReduce(size_t begin,size_t end,size_t grainSize,const ValueParam& identity,ReducerParam& reducer,CombinerParam& combiner) // Reduces [begin, end) in parallel, where reducer(rangeBegin,rangeEnd,value) folds a chunk into the given value, and combiner(value1,value2) combines partial results; the result does not depend on thread scheduling
+		{
+		/* Determine the chunk size to assign one partial result to each chunk: */
+		if(end<=begin)
+			return identity;
+		if(grainSize==0)
+			grainSize=getDefaultGrainSize(end-begin);
+		std::vector<ValueParam> partials((end-begin+grainSize-1)/grainSize,identity);
+		
+		/* Reduce all chunks in parallel: */
+		RangeReducerAdapter<ValueParam,ReducerParam> adapter(reducer,begin,grainSize,partials);
+		runRangeFunction(begin,end,grainSize,adapter);
+		
+		/* Combine the partial results in chunk order: */
+		ValueParam result=partials[0];
+		for(typename std::vector<ValueParam>::iterator pIt=partials.begin()+1;pIt!=partials.end();++pIt)
+			result=combiner(result,*pIt);
+		return result;
+		}
+	static size_t getDefaultGrainSize(size_t rangeSize); // Returns a chunk size to evenly distribute an index range of the given size across the worker pool
 	};
 
 }
@@ -0,0 +1,30 @@
+/***********************************************************************
+Config - Configuration header file for USB Support Library.
+Copyright (c) 2011-2016 Oliver Kreylos
+
+This file is part of the USB Support Library (USB).
+
+The USB Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The USB Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the USB Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef USB_CONFIG_INCLUDED
+#define USB_CONFIG_INCLUDED
+
+#define USB_CONFIG_HAVE_LIBUSB1 0
+#define USB_CONFIG_HAVE_TOPOLOGY_CALLS 0
+#define USB_CONFIG_HAVE_STRERROR 0
+#define USB_CONFIG_HAVE_SET_OPTION 0
+
+#endif
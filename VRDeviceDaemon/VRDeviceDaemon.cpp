@@ -199,7 +199,7 @@ int main(int argc,char* argv[])
 		Misc::ConfigurationFile* configFile=0;
 		try
 			{
-			configFile=new Misc::ConfigurationFile(configFileName.c_str());
+			configFile=new Misc::ConfigurationFile(configFileName.c_str(),getenv("VRUI_CONFIGCACHEDIR"));
 			}
 		catch(const std::runtime_error& err)
 			{
@@ -2,7 +2,7 @@
 VRDeviceManager - Class to gather position, button and valuator data
 from one or several VR devices and associate them with logical input
 devices.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
 
@@ -32,8 +32,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/CompoundValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <Realtime/Time.h>
-#include <Realtime/SharedMemory.h>
-#include <Threads/Config.h>
+#include <Realtime/SharedStateRing.h>
 #include <Threads/EventDispatcher.h>
 #include <Vrui/Internal/VRDeviceDescriptor.h>
 #include <Vrui/Internal/HMDConfiguration.h>
@@ -43,25 +42,67 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <VRDeviceDaemon/VRCalibrator.h>
 #include <VRDeviceDaemon/Config.h>
 
+/******************************************
+Methods of class VRDeviceManager::IndexSet:
+******************************************/
+
+void VRDeviceManager::IndexSet::setSize(int newSize)
+	{
+	/* Re-allocate the bit set and clear it: */
+	bits.clear();
+	bits.resize((newSize+31)>>5,0x0U);
+	ranges.clear();
+	numIndices=0;
+	}
+
+void VRDeviceManager::IndexSet::clear(void)
+	{
+	/* Reset only those bits that are set by walking the range list: */
+	for(IndexRangeList::iterator rIt=ranges.begin();rIt!=ranges.end();++rIt)
+		for(int index=rIt->first;index<rIt->last;++index)
+			bits[index>>5]&=~(0x1U<<(index&0x1f));
+	ranges.clear();
+	numIndices=0;
+	}
+
 /********************************
 Methods of class VRDeviceManager:
 ********************************/
 
 void VRDeviceManager::postStateUpdate(void)
 	{
-	/* Write the given data into the buffer half not currently used by readers: */
-	unsigned int* counter=stateMemory->getValue<unsigned int>(0);
-	#if THREADS_CONFIG_HAVE_BUILTIN_ATOMICS
-	unsigned int nextHalf=(~__atomic_load_n(counter,__ATOMIC_ACQUIRE))&0x1U;
-	#endif
-	size_t headerSize=sizeof(ptrdiff_t);
-	size_t stateSize=state.getStateSize();
-	state.write(stateMemory->getValue<char>(0)+headerSize+nextHalf*stateSize);
+	/* Post the current device state into the next slot of the shared state ring: */
+	stateMemory->post(state.getStateMemory(),Realtime::TimePointMonotonic());
+	}
+
+void VRDeviceManager::flushUpdates(bool complete)
+	{
+	/* Send the batch of pending updates to the streamer: */
+	pendingUpdates.complete=complete;
+	streamer->updateCompleted(pendingUpdates);
 	
-	/* Increment the counter to invalidate previous data and flip the readable buffer half: */
-	#if THREADS_CONFIG_HAVE_BUILTIN_ATOMICS
-	__atomic_add_fetch(counter,1,__ATOMIC_RELEASE);
-	#endif
+	/* Start a new batch: */
+	pendingUpdates.clear();
+	
+	/* Start a new round of tracker reports if the device state has been updated completely: */
+	if(complete)
+		reportedTrackers.clear();
+	}
+
+void VRDeviceManager::trackerReported(int trackerIndex)
+	{
+	/* Send the current batch as an incremental update if the tracker already reported in it, to bound latency if trackers report at different rates: */
+	if(pendingUpdates.trackers.contains(trackerIndex))
+		flushUpdates(false);
+	
+	/* Add the tracker to the batch and to the current round, and check if all trackers have now reported: */
+	pendingUpdates.trackers.add(trackerIndex);
+	reportedTrackers.add(trackerIndex);
+	if(reportedTrackers.getNumIndices()==int(trackerNames.size()))
+		{
+		/* Notify streamer that device state has completed update: */
+		flushUpdates(true);
+		}
 	}
 
 VRDeviceManager::VRDeviceManager(Threads::EventDispatcher& sDispatcher,Misc::ConfigurationFile& configFile)
@@ -71,7 +112,7 @@ VRDeviceManager::VRDeviceManager(Threads::EventDispatcher& sDispatcher,Misc::Con
 	 numDevices(0),
 	 devices(0),trackerIndexBases(0),buttonIndexBases(0),valuatorIndexBases(0),
 	 stateMemory(0),
-	 fullTrackerReportMask(0x0),trackerReportMask(0x0),streamer(0)
+	 streamer(0)
 	{
 	/* Allocate device and base index arrays: */
 	typedef std::vector<std::string> StringList;
@@ -144,6 +185,12 @@ VRDeviceManager::VRDeviceManager(Threads::EventDispatcher& sDispatcher,Misc::Con
 	/* Set server state's layout: */
 	state.setLayout(trackerNames.size(),buttonNames.size(),valuatorNames.size());
 	
+	/* Initialize the batch of pending updates and the set of reported trackers: */
+	pendingUpdates.trackers.setSize(trackerNames.size());
+	reportedTrackers.setSize(trackerNames.size());
+	immediateUpdates.buttons.setSize(buttonNames.size());
+	immediateUpdates.valuators.setSize(valuatorNames.size());
+	
 	/* Read names of all virtual devices: */
 	StringList virtualDeviceNames=configFile.retrieveValue<StringList>("./virtualDeviceNames",StringList());
 	
@@ -215,9 +262,6 @@ int VRDeviceManager::addTracker(const char* name)
 	else
 		trackerNames.push_back(name);
 	
-	/* Update the tracker report mask: */
-	fullTrackerReportMask=(0x1U<<(result+1))-1U;
-	
 	return result;
 	}
 
@@ -330,19 +374,8 @@ void VRDeviceManager::disableTracker(int trackerIndex)
 	/* Check if update notifications are requested: */
 	if(streamer!=0)
 		{
-		/* Notify streamer of single tracker update: */
-		streamer->trackerUpdated(trackerIndex);
-		
-		/* Update tracker report mask: */
-		trackerReportMask|=1<<trackerIndex;
-		if(trackerReportMask==fullTrackerReportMask)
-			{
-			/* Notify streamer that device state has completed update: */
-			streamer->updateCompleted();
-			
-			/* Reset the tracker report mask: */
-			trackerReportMask=0x0;
-			}
+		/* Add the tracker to the batch of pending updates: */
+		trackerReported(trackerIndex);
 		}
 	}
 
@@ -360,19 +393,8 @@ void VRDeviceManager::setTrackerState(int trackerIndex,const Vrui::VRDeviceState
 	/* Check if update notifications are requested: */
 	if(streamer!=0)
 		{
-		/* Notify streamer of single tracker update: */
-		streamer->trackerUpdated(trackerIndex);
-		
-		/* Update tracker report mask: */
-		trackerReportMask|=1<<trackerIndex;
-		if(trackerReportMask==fullTrackerReportMask)
-			{
-			/* Notify streamer that device state has completed update: */
-			streamer->updateCompleted();
-			
-			/* Reset the tracker report mask: */
-			trackerReportMask=0x0;
-			}
+		/* Add the tracker to the batch of pending updates: */
+		trackerReported(trackerIndex);
 		}
 	}
 
@@ -388,8 +410,10 @@ void VRDeviceManager::setButtonState(int buttonIndex,Vrui::VRDeviceState::Button
 	/* Check if update notifications are requested: */
 	if(streamer!=0)
 		{
-		/* Notify streamer of single button update: */
-		streamer->buttonUpdated(buttonIndex);
+		/* Send the button to the streamer right away, even if trackers are in the middle of reporting: */
+		immediateUpdates.buttons.add(buttonIndex);
+		streamer->updateCompleted(immediateUpdates);
+		immediateUpdates.clear();
 		}
 	}
 
@@ -405,8 +429,10 @@ void VRDeviceManager::setValuatorState(int valuatorIndex,Vrui::VRDeviceState::Va
 	/* Check if update notifications are requested: */
 	if(streamer!=0)
 		{
-		/* Notify streamer of single valuator update: */
-		streamer->valuatorUpdated(valuatorIndex);
+		/* Send the valuator to the streamer right away, even if trackers are in the middle of reporting: */
+		immediateUpdates.valuators.add(valuatorIndex);
+		streamer->updateCompleted(immediateUpdates);
+		immediateUpdates.clear();
 		}
 	}
 
@@ -415,13 +441,10 @@ void VRDeviceManager::updateState(void)
 	Threads::Mutex::Lock stateLock(stateMutex);
 	
 	/* Check if update notifications are requested and an update is necessary: */
-	if(streamer!=0&&(trackerReportMask!=0x0||fullTrackerReportMask==0x0))
+	if(streamer!=0&&(!reportedTrackers.empty()||trackerNames.empty()))
 		{
 		/* Notify streamer that device state has completed update: */
-		streamer->updateCompleted();
-		
-		/* Reset the tracker report mask: */
-		trackerReportMask=0x0;
+		flushUpdates(true);
 		}
 	}
 
@@ -461,18 +484,13 @@ int VRDeviceManager::addBaseStation(const std::string& serialNumber)
 	return result;
 	}
 
-int VRDeviceManager::useSharedMemory(const char* sharedMemoryName)
+int VRDeviceManager::useSharedMemory(const char* sharedMemoryName,unsigned int historySize)
 	{
-	/* Calculate the memory size required to hold a double buffer of device states: */
-	size_t headerSize=sizeof(ptrdiff_t);
-	size_t stateSize=state.getStateSize();
-	
-	/* Create a shared memory segment of sufficient size: */
-	stateMemory=new Realtime::SharedMemory(sharedMemoryName,headerSize+2*stateSize);
+	/* Create a shared state ring holding the given number of device states: */
+	stateMemory=new Realtime::SharedStateRing(sharedMemoryName,historySize,state.getStateSize());
 	
-	/* Initialize the device state double buffer with the current device state: */
-	*stateMemory->getValue<unsigned int>(0)=0;
-	state.write(stateMemory->getValue<char>(0)+headerSize+0*stateSize);
+	/* Initialize the shared state ring with the current device state: */
+	postStateUpdate();
 	
 	/* Return the shared memory segment's file descriptor: */
 	return stateMemory->getFd();
@@ -506,8 +524,11 @@ void VRDeviceManager::setStreamer(VRStreamer* newStreamer)
 	Threads::Mutex::Lock batteryStateLock(batteryStateMutex);
 	Threads::Mutex::Lock hmdConfigurationLock(hmdConfigurationMutex);
 	
-	/* Set the streamer object: */
+	/* Set the streamer object and start a new batch of pending updates: */
 	streamer=newStreamer;
+	pendingUpdates.clear();
+	reportedTrackers.clear();
+	immediateUpdates.clear();
 	}
 
 void VRDeviceManager::start(void)
@@ -2,7 +2,7 @@
 VRDeviceManager - Class to gather position, button and valuator data
 from one or several VR devices and associate them with logical input
 devices.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
 
@@ -26,6 +26,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define VRDEVICEMANAGER_INCLUDED
 
 #include <string>
+#include <vector>
 #include <Realtime/Time.h>
 #include <Threads/Mutex.h>
 #include <Vrui/Types.h>
@@ -40,7 +41,7 @@ namespace Misc {
 class ConfigurationFile;
 }
 namespace Realtime {
-class SharedMemory;
+class SharedStateRing;
 }
 namespace Threads {
 class EventDispatcher;
@@ -79,6 +80,106 @@ class VRDeviceManager
 	
 	typedef VRFactoryManager<VRCalibrator> CalibratorFactoryManager;
 	
+	struct IndexRange // Structure for half-open ranges of tracker, button, or valuator indices
+		{
+		/* Elements: */
+		public:
+		int first; // First index in the range
+		int last; // Index one behind the last index in the range
+		};
+	
+	typedef std::vector<IndexRange> IndexRangeList; // Type for lists of index ranges
+	
+	class IndexSet // Class for sets of tracker, button, or valuator indices of arbitrary size
+		{
+		/* Elements: */
+		private:
+		std::vector<unsigned int> bits; // Bit set containing a 1-bit for each index in the set
+		IndexRangeList ranges; // List of index ranges in the order in which indices were added
+		int numIndices; // Number of indices in the set
+		
+		/* Constructors and destructors: */
+		public:
+		IndexSet(void) // Creates an empty index set for an empty index space
+			:numIndices(0)
+			{
+			}
+		
+		/* Methods: */
+		void setSize(int newSize); // Sets the size of the index space; clears the set
+		bool empty(void) const // Returns true if the set contains no indices
+			{
+			return numIndices==0;
+			}
+		int getNumIndices(void) const // Returns the number of indices in the set
+			{
+			return numIndices;
+			}
+		bool contains(int index) const // Returns true if the given index is in the set
+			{
+			return (bits[index>>5]&(0x1U<<(index&0x1f)))!=0x0U;
+			}
+		const IndexRangeList& getRanges(void) const // Returns the list of index ranges covering the set
+			{
+			return ranges;
+			}
+		bool add(int index) // Adds the given index to the set; returns true if the index was not already in the set
+			{
+			/* Check if the index is already in the set: */
+			unsigned int& word=bits[index>>5];
+			unsigned int bit=0x1U<<(index&0x1f);
+			if(word&bit)
+				return false;
+			
+			/* Add the index to the bit set: */
+			word|=bit;
+			++numIndices;
+			
+			/* Extend the last index range if the index is adjacent, or start a new range: */
+			if(!ranges.empty()&&ranges.back().last==index)
+				++ranges.back().last;
+			else
+				{
+				IndexRange newRange;
+				newRange.first=index;
+				newRange.last=index+1;
+				ranges.push_back(newRange);
+				}
+			
+			return true;
+			}
+		void clear(void); // Removes all indices from the set
+		};
+	
+	struct UpdateBatch // Structure describing a batch of device state updates delivered to a VR streamer
+		{
+		/* Elements: */
+		public:
+		IndexSet trackers; // Set of trackers that have been updated
+		IndexSet buttons; // Set of buttons that have been updated
+		IndexSet valuators; // Set of valuators that have been updated
+		bool complete; // Flag whether all trackers have reported since the last complete update
+		
+		/* Constructors and destructors: */
+		UpdateBatch(void)
+			:complete(false)
+			{
+			}
+		
+		/* Methods: */
+		bool empty(void) const // Returns true if the batch does not contain any updates
+			{
+			return trackers.empty()&&buttons.empty()&&valuators.empty();
+			}
+		void clear(void) // Resets the batch
+			{
+			trackers.clear();
+			buttons.clear();
+			valuators.clear();
+			complete=false;
+			}
+		};
+	
 	class VRStreamer // Abstract base class for objects receiving device state updates
 		{
 		/* Elements: */
@@ -109,11 +210,8 @@ class VRDeviceManager
 		
 		/* Methods: */
 		
-		/* Individual state component update notification methods; device state mutex will be locked during calls: */
-		virtual void trackerUpdated(int trackerIndex) =0; // Notifies the VR streamer that a single tracker has been updated
-		virtual void buttonUpdated(int buttonIndex) =0; // Notifies the VR streamer that a single button has been updated
-		virtual void valuatorUpdated(int valuatorIndex) =0; // Notifies the VR streamer that a single valuator has been updated
-		virtual void updateCompleted(void) =0; // Notifies the VR streamer that the device state has been updated completely
+		/* State update notification method; device state mutex will be locked during calls: */
+		virtual void updateCompleted(const UpdateBatch& batch) =0; // Notifies the VR streamer that the given batch of state components has been updated; batch's complete flag is set if the device state has been updated completely
 		
 		/* Additional update notification methods: */
 		virtual void batteryStateUpdated(unsigned int deviceIndex) =0; // Notifies the VR streamer that a battery state has been updated; battery state mutex will be locked during call
@@ -146,7 +244,7 @@ class VRDeviceManager
 	std::vector<std::string> valuatorNames; // List of valuator names
 	Threads::Mutex stateMutex; // Mutex serializing access to all state elements
 	Vrui::VRDeviceState state; // Current state of all managed devices
-	Realtime::SharedMemory* stateMemory; // Pointer to an optional shared memory segment from which clients can directly read device states
+	Realtime::SharedStateRing* stateMemory; // Pointer to an optional ring of recent device states in shared memory from which clients can directly read device states
 	std::vector<Vrui::VRDeviceDescriptor*> virtualDevices; // List of virtual devices combining selected trackers, buttons, and valuators
 	std::vector<bool> deviceConnecteds; // List of flags if each virtual device is currently connected
 	Threads::Mutex batteryStateMutex; // Mutex serializing access to the list of virtual device battery states
@@ -157,12 +255,15 @@ class VRDeviceManager
 	std::vector<Feature> hapticFeatures; // List of haptic feedback devices
 	Threads::Mutex baseStationMutex; // Mutex serializing access to the list of tracking base stations
 	std::vector<Vrui::VRBaseStation> baseStations; // List of tracking base stations
-	unsigned int fullTrackerReportMask; // Bitmask containing 1-bits for all used logical tracker indices
-	unsigned int trackerReportMask; // Bitmask of logical tracker indices that have reported state
+	UpdateBatch pendingUpdates; // Batch of tracker updates that have not yet been sent to the VR streamer; buttons and valuators are sent via immediateUpdates
+	IndexSet reportedTrackers; // Set of logical tracker indices that have reported state since the last complete update
+	UpdateBatch immediateUpdates; // Batch of button or valuator updates that are sent to the VR streamer right away, without waiting for trackers to finish reporting
 	VRStreamer* streamer; // Pointer to VR streamer receiving state update notifications
 	
 	/* Private methods: */
 	void postStateUpdate(void); // Posts an updated device state to the shared memory block
+	void flushUpdates(bool complete); // Sends the batch of pending updates to the VR streamer and starts a new batch, and a new round of tracker reports if the update is complete; must be called with state mutex locked
+	void trackerReported(int trackerIndex); // Adds the given tracker to the batch of pending updates and sends the batch early if the tracker already is in it, or as a complete update if all trackers have reported; must be called with state mutex locked
 	
 	/* Constructors and destructors: */
 	public:
@@ -238,7 +339,7 @@ class VRDeviceManager
 		}
 	
 	/* Methods to communicate with device server: */
-	int useSharedMemory(const char* sharedMemoryName); // Instructs the device manager to move its device state into a shared memory segment; returns a file handle for the shared memory segment
+	int useSharedMemory(const char* sharedMemoryName,unsigned int historySize); // Instructs the device manager to post its device state into a ring retaining the given number of most recent states in a shared memory segment; returns a file handle for the shared memory segment
 	int getNumVirtualDevices(void) const // Returns the number of managed virtual input devices
 		{
 		return int(virtualDevices.size());
@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceServer - Class encapsulating the VR device protocol's server
 side.
-Copyright (c) 2002-2025 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
 
@@ -26,6 +26,9 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
 #include <stdexcept>
 #include <Misc/SizedTypes.h>
 #include <Misc/PrintInteger.h>
@@ -37,6 +40,9 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <IO/ValueSource.h>
 #include <IO/JsonEntityTypes.h>
 #include <IO/OStream.h>
+#include <Comm/IPv4Address.h>
+#include <Comm/IPv4SocketAddress.h>
+#include <Comm/UDPSocket.h>
 #include <Comm/TCPPipe.h>
 #include <Comm/UNIXPipe.h>
 #include <Comm/ListeningTCPSocket.h>
@@ -63,6 +69,23 @@ enum State
 	START,CONNECTED,ACTIVE,STREAMING
 	};
 
+/****************
+Helper functions:
+****************/
+
+inline void markUpdates(const VRDeviceManager::IndexSet& indices,bool* updateFlags,std::vector<int>& updatedIndices)
+	{
+	/* Add all indices in the given set that have not been updated yet to the given list: */
+	const VRDeviceManager::IndexRangeList& ranges=indices.getRanges();
+	for(VRDeviceManager::IndexRangeList::const_iterator rIt=ranges.begin();rIt!=ranges.end();++rIt)
+		for(int index=rIt->first;index<rIt->last;++index)
+			if(!updateFlags[index])
+				{
+				updateFlags[index]=true;
+				updatedIndices.push_back(index);
+				}
+	}
+
 }
 
 /********************************************
@@ -73,7 +96,7 @@ VRDeviceServer::ClientState::ClientState(VRDeviceServer* sServer,Comm::PipePtr s
 	:server(sServer),
 	 pipe(sPipe),
 	 state(START),protocolVersion(Vrui::VRDeviceProtocol::protocolVersionNumber),clientExpectsTimeStamps(true),
-	 active(false),streaming(false)
+	 active(false),streaming(false),multicast(false),frameCoder(0)
 	{
 	#ifdef VERBOSE
 	Comm::TCPPipe* tcpPipe=dynamic_cast<Comm::TCPPipe*>(pipe.getPointer());
@@ -93,6 +116,11 @@ VRDeviceServer::ClientState::ClientState(VRDeviceServer* sServer,Comm::PipePtr s
 	#endif
 	}
 
+VRDeviceServer::ClientState::~ClientState(void)
+	{
+	delete frameCoder;
+	}
+
 /*******************************
 Methods of class VRDeviceServer:
 *******************************/
@@ -509,7 +537,11 @@ void VRDeviceServer::disconnectClient(VRDeviceServer::ClientState* client,bool r
 	
 	/* Check if the client is still streaming or active: */
 	if(client->streaming)
+		{
 		--numStreamingClients;
+		if(client->multicast)
+			--numMulticastClients;
+		}
 	if(client->active)
 		{
 		/* Decrease the number of active clients and go to inactive state if the number reaches zero: */
@@ -636,12 +668,25 @@ void VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::IOEvent& ev
 				
 				/* Check if the client is connected via a UNIX socket and can use shared memory: */
 				Comm::UNIXPipe* unixPipePtr=dynamic_cast<Comm::UNIXPipe*>(client->pipe.getPointer());
-				if(unixPipePtr!=0&&client->protocolVersion>=12)
+				if(unixPipePtr!=0&&client->protocolVersion>=14U)
 					{
 					/* Send the file descriptor to access device state memory to the client: */
 					unixPipePtr->writeFd(thisPtr->deviceStateMemoryFd);
 					}
 				
+				/* Check if the client knows about multicast streaming: */
+				if(client->protocolVersion>=16U)
+					{
+					/* Send the multicast group's address and port and the server's stream identifier if the server has a multicast group: */
+					client->pipe->write(Misc::UInt8(thisPtr->multicastSocket!=0?1U:0U));
+					if(thisPtr->multicastSocket!=0)
+						{
+						client->pipe->write(thisPtr->multicastGroupAddress);
+						client->pipe->write(Misc::UInt16(thisPtr->multicastPort));
+						client->pipe->write(thisPtr->multicastStreamId);
+						}
+					}
+				
 				/* Finish the reply message: */
 				client->pipe->flush();
 				
@@ -719,11 +764,46 @@ void VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::IOEvent& ev
 				printf(" done\n");
 				#endif
 				}
-			else if(message==STARTSTREAM_REQUEST)
+			else if(message==STARTSTREAM_REQUEST||message==STARTFRAMESTREAM_REQUEST||message==STARTMULTICASTSTREAM_REQUEST)
 				{
 				if(client->state!=ACTIVE)
 					throw std::runtime_error("STARTSTREAM_REQUEST outside ACTIVE state");
 				
+				client->multicast=false;
+				if(message==STARTMULTICASTSTREAM_REQUEST)
+					{
+					if(client->protocolVersion<16U||thisPtr->multicastSocket==0)
+						throw std::runtime_error("STARTMULTICASTSTREAM_REQUEST not supported by server");
+					
+					/* Tell the client the sequence number of the first multicast state update it needs to apply after the following full state: */
+					client->pipe->write(MessageIdType(MULTICASTSTREAM_REPLY));
+					client->pipe->write(thisPtr->multicastSequence);
+					
+					/* Receive state updates from the multicast group: */
+					client->multicast=true;
+					++thisPtr->numMulticastClients;
+					}
+				else if(message==STARTFRAMESTREAM_REQUEST)
+					{
+					if(client->protocolVersion<15U)
+						throw std::runtime_error("STARTFRAMESTREAM_REQUEST not supported by negotiated protocol version");
+					
+					/* Create a frame coder for the client, or reset its existing frame coder for the new stream: */
+					if(client->frameCoder==0)
+						{
+						Threads::Mutex::Lock stateLock(thisPtr->stateMutex);
+						client->frameCoder=new Vrui::VRDeviceProtocol::FrameCoder(thisPtr->state);
+						}
+					else
+						client->frameCoder->reset();
+					}
+				else
+					{
+					/* Send individual updates to the client: */
+					delete client->frameCoder;
+					client->frameCoder=0;
+					}
+				
 				#if VRDEVICEDAEMON_DEBUG_PROTOCOL
 				printf("Sending packet reply..."); fflush(stdout);
 				#endif
@@ -762,6 +842,8 @@ void VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::IOEvent& ev
 				
 				/* Decrease the number of streaming clients: */
 				--thisPtr->numStreamingClients;
+				if(client->multicast)
+					--thisPtr->numMulticastClients;
 				
 				/* Go to active state: */
 				client->streaming=false;
@@ -875,41 +957,50 @@ void VRDeviceServer::disconnectClientOnError(VRDeviceServer::ClientStateList::it
 
 bool VRDeviceServer::writeStateUpdates(VRDeviceServer::ClientStateList::iterator csIt)
 	{
-	/* Bail out if the client is not streaming or does not understand incremental state updates: */
+	/* Bail out if the client is not streaming, receives state updates from the multicast group, or does not understand incremental state updates: */
 	ClientState& client=*csIt;
-	if(!client.streaming||client.protocolVersion<7U)
+	if(!client.streaming||client.multicast||client.protocolVersion<7U)
 		return true;
 	
 	/* Send state updates to client: */
 	try
 		{
-		/* Send tracker state updates: */
-		for(std::vector<int>::iterator utIt=updatedTrackers.begin();utIt!=updatedTrackers.end();++utIt)
-			{
-			/* Send tracker update message: */
-			client.pipe->write(MessageIdType(TRACKER_UPDATE));
-			client.pipe->write(Misc::UInt16(*utIt));
-			Misc::Marshaller<Vrui::VRDeviceState::TrackerState>::write(state.getTrackerState(*utIt),*client.pipe);
-			client.pipe->write(state.getTrackerTimeStamp(*utIt));
-			client.pipe->write(Misc::UInt8(state.getTrackerValid(*utIt)?1U:0U));
-			}
-		
-		/* Send button updates: */
-		for(std::vector<int>::iterator ubIt=updatedButtons.begin();ubIt!=updatedButtons.end();++ubIt)
+		if(client.frameCoder!=0)
 			{
-			/* Send button update message: */
-			client.pipe->write(MessageIdType(BUTTON_UPDATE));
-			client.pipe->write(Misc::UInt16(*ubIt));
-			client.pipe->write(Misc::UInt8(state.getButtonState(*ubIt)?1U:0U));
+			/* Send all updates in a single frame: */
+			client.pipe->write(MessageIdType(FRAME_UPDATE));
+			client.frameCoder->writeFrame(state,updatedTrackers,updatedButtons,updatedValuators,*client.pipe);
 			}
-		
-		/* Send valuator updates: */
-		for(std::vector<int>::iterator uvIt=updatedValuators.begin();uvIt!=updatedValuators.end();++uvIt)
+		else
 			{
-			/* Send valuator update message: */
-			client.pipe->write(MessageIdType(VALUATOR_UPDATE));
-			client.pipe->write(Misc::UInt16(*uvIt));
-			client.pipe->write(state.getValuatorState(*uvIt));
+			/* Send tracker state updates: */
+			for(std::vector<int>::iterator utIt=updatedTrackers.begin();utIt!=updatedTrackers.end();++utIt)
+				{
+				/* Send tracker update message: */
+				client.pipe->write(MessageIdType(TRACKER_UPDATE));
+				client.pipe->write(Misc::UInt16(*utIt));
+				Misc::Marshaller<Vrui::VRDeviceState::TrackerState>::write(state.getTrackerState(*utIt),*client.pipe);
+				client.pipe->write(state.getTrackerTimeStamp(*utIt));
+				client.pipe->write(Misc::UInt8(state.getTrackerValid(*utIt)?1U:0U));
+				}
+			
+			/* Send button updates: */
+			for(std::vector<int>::iterator ubIt=updatedButtons.begin();ubIt!=updatedButtons.end();++ubIt)
+				{
+				/* Send button update message: */
+				client.pipe->write(MessageIdType(BUTTON_UPDATE));
+				client.pipe->write(Misc::UInt16(*ubIt));
+				client.pipe->write(Misc::UInt8(state.getButtonState(*ubIt)?1U:0U));
+				}
+			
+			/* Send valuator updates: */
+			for(std::vector<int>::iterator uvIt=updatedValuators.begin();uvIt!=updatedValuators.end();++uvIt)
+				{
+				/* Send valuator update message: */
+				client.pipe->write(MessageIdType(VALUATOR_UPDATE));
+				client.pipe->write(Misc::UInt16(*uvIt));
+				client.pipe->write(state.getValuatorState(*uvIt));
+				}
 			}
 		
 		/* Finish the message set: */
@@ -925,6 +1016,34 @@ bool VRDeviceServer::writeStateUpdates(VRDeviceServer::ClientStateList::iterator
 	return true;
 	}
 
+void VRDeviceServer::writeMulticastUpdate(void)
+	{
+	/* Assemble a datagram containing the stream identifier, the update's sequence number, and the complete device state: */
+	Misc::UInt32 header[2];
+	header[0]=htonl(multicastStreamId);
+	header[1]=htonl(multicastSequence);
+	memcpy(multicastBuffer,header,sizeof(header));
+	
+	/* Encode the device state as a self-contained frame so that clients can apply each datagram on its own, even after losing previous ones: */
+	multicastCoder->reset();
+	size_t frameSize=multicastCoder->encodeFrame(state,allTrackers,allButtons,allValuators,multicastBuffer+sizeof(header));
+	
+	try
+		{
+		/* Send the datagram to all multicast streaming clients at once: */
+		multicastSocket->sendMessage(multicastBuffer,sizeof(header)+frameSize);
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Clients will detect the lost update from the gap in sequence numbers; print an error message and carry on: */
+		fprintf(stderr,"VRDeviceServer: Unable to send multicast state update due to exception %s\n",err.what());
+		fflush(stderr);
+		}
+	
+	/* Advance the sequence number even if sending failed: */
+	++multicastSequence;
+	}
+
 bool VRDeviceServer::writeServerState(VRDeviceServer::ClientStateList::iterator csIt)
 	{
 	/* Bail out if the client is not streaming or understands incremental state updates: */
@@ -1013,7 +1132,8 @@ VRDeviceServer::VRDeviceServer(Threads::EventDispatcher& sDispatcher,VRDeviceMan
 	 dispatcher(sDispatcher),
 	 environmentDefinitionUpdatedSignalKey(0),
 	 tcpListeningSocketKey(0),unixListeningSocketKey(0),deviceStateMemoryFd(-1),httpListeningSocketKey(0),
-	 numActiveClients(0),numStreamingClients(0),
+	 multicastSocket(0),multicastGroupAddress(0U),multicastPort(0U),multicastStreamId(0U),multicastSequence(0U),multicastCoder(0),multicastBuffer(0),
+	 numActiveClients(0),numStreamingClients(0),numMulticastClients(0),
 	 suspendTime(0,0),suspendTimerKey(0),
 	 haveUpdates(false),trackerUpdateFlags(0),buttonUpdateFlags(0),valuatorUpdateFlags(0),
 	 managerTrackerStateVersion(0U),streamingTrackerStateVersion(0U),
@@ -1077,7 +1197,7 @@ VRDeviceServer::VRDeviceServer(Threads::EventDispatcher& sDispatcher,VRDeviceMan
 		unixListeningSocketKey=dispatcher.addIOEventListener(unixListeningSocket->getFd(),Threads::EventDispatcher::Read,newUnixConnectionCallback,this);
 		
 		/* Tell the device manager to use a shared memory block for device states: */
-		deviceStateMemoryFd=deviceManager->useSharedMemory(configFile.retrieveString("deviceStateMemoryName","/VRDeviceManagerDeviceState.shmem").c_str());
+		deviceStateMemoryFd=deviceManager->useSharedMemory(configFile.retrieveString("deviceStateMemoryName","/VRDeviceManagerDeviceState.shmem").c_str(),configFile.retrieveValue<unsigned int>("deviceStateHistorySize",16U));
 		}
 	
 	/* Check if the server should listen for HTTP requests and commands on a TCP socket: */
@@ -1088,6 +1208,25 @@ VRDeviceServer::VRDeviceServer(Threads::EventDispatcher& sDispatcher,VRDeviceMan
 		httpListeningSocketKey=dispatcher.addIOEventListener(httpListeningSocket->getFd(),Threads::EventDispatcher::Read,newHttpConnectionCallback,this);
 		}
 	
+	/* Check if the server should send state updates to streaming clients via a UDP multicast group: */
+	if(configFile.hasTag("./multicastGroup"))
+		{
+		/* Create a UDP socket connected to the multicast group: */
+		Comm::IPv4Address groupAddress(configFile.retrieveString("./multicastGroup").c_str());
+		multicastGroupAddress=groupAddress.getAddressUInt();
+		multicastPort=configFile.retrieveValue<unsigned int>("./multicastPort",8556U);
+		multicastSocket=new Comm::UDPSocket(-1,Comm::IPv4SocketAddress(multicastPort,groupAddress));
+		
+		/* Configure the multicast socket; enable loopback to serve clients on the server's host: */
+		multicastSocket->setMulticastLoopback(true);
+		multicastSocket->setMulticastTTL(configFile.retrieveValue<unsigned int>("./multicastTTL",1U));
+		if(configFile.hasTag("./multicastInterface"))
+			multicastSocket->setMulticastInterface(Comm::IPv4Address(configFile.retrieveString("./multicastInterface").c_str()));
+		
+		/* Pick a stream identifier that is unlikely to be used by other servers sending to the same group: */
+		multicastStreamId=(Misc::UInt32(getpid())<<16)^Misc::UInt32(time(0));
+		}
+	
 	/* Create a timer event listener to suspend VR devices after a certain period of inactivity: */
 	suspendTime=Threads::EventDispatcher::Time(configFile.retrieveValue<int>("suspendTimeout",0),0);
 	if(suspendTime.tv_sec!=0)
@@ -1112,6 +1251,24 @@ VRDeviceServer::VRDeviceServer(Threads::EventDispatcher& sDispatcher,VRDeviceMan
 	valuatorUpdateFlags=new bool[state.getNumValuators()];
 	for(int i=0;i<state.getNumValuators();++i)
 		valuatorUpdateFlags[i]=false;
+	
+	if(multicastSocket!=0)
+		{
+		/* Create the multicast frame coder and the lists of all device state components: */
+		multicastCoder=new Vrui::VRDeviceProtocol::FrameCoder(state);
+		for(int i=0;i<state.getNumTrackers();++i)
+			allTrackers.push_back(i);
+		for(int i=0;i<state.getNumButtons();++i)
+			allButtons.push_back(i);
+		for(int i=0;i<state.getNumValuators();++i)
+			allValuators.push_back(i);
+		
+		/* Check that complete device states fit into a single datagram: */
+		size_t maxDatagramSize=2*sizeof(Misc::UInt32)+multicastCoder->getMaxFrameSize();
+		if(maxDatagramSize>65507)
+			throw std::runtime_error("VRDeviceServer: Device state is too large for multicast state updates");
+		multicastBuffer=new Misc::UInt8[maxDatagramSize];
+		}
 	}
 	
 	/* Initialize the array of battery state version numbers: */
@@ -1146,50 +1303,29 @@ VRDeviceServer::~VRDeviceServer(void)
 	delete[] trackerUpdateFlags;
 	delete[] buttonUpdateFlags;
 	delete[] valuatorUpdateFlags;
+	delete multicastSocket;
+	delete multicastCoder;
+	delete[] multicastBuffer;
 	delete[] batteryStateVersions;
 	delete[] hmdConfigurationVersions;
 	}
 
-void VRDeviceServer::trackerUpdated(int trackerIndex)
-	{
-	/* Remember the updated tracker's index and wake up the run loop: */
-	haveUpdates=true;
-	if(!trackerUpdateFlags[trackerIndex])
-		{
-		trackerUpdateFlags[trackerIndex]=true;
-		updatedTrackers.push_back(trackerIndex);
-		}
-	dispatcher.interrupt();
-	}
-
-void VRDeviceServer::buttonUpdated(int buttonIndex)
-	{
-	/* Remember the updated button's index and wake up the run loop: */
-	haveUpdates=true;
-	if(!buttonUpdateFlags[buttonIndex])
-		{
-		buttonUpdateFlags[buttonIndex]=true;
-		updatedButtons.push_back(buttonIndex);
-		}
-	dispatcher.interrupt();
-	}
-
-void VRDeviceServer::valuatorUpdated(int valuatorIndex)
+void VRDeviceServer::updateCompleted(const VRDeviceManager::UpdateBatch& batch)
 	{
-	/* Remember the updated valuator's index and wake up the run loop: */
-	haveUpdates=true;
-	if(!valuatorUpdateFlags[valuatorIndex])
+	/* Remember the updated trackers', buttons', and valuators' indices: */
+	if(!batch.empty())
 		{
-		valuatorUpdateFlags[valuatorIndex]=true;
-		updatedValuators.push_back(valuatorIndex);
+		haveUpdates=true;
+		markUpdates(batch.trackers,trackerUpdateFlags,updatedTrackers);
+		markUpdates(batch.buttons,buttonUpdateFlags,updatedButtons);
+		markUpdates(batch.valuators,valuatorUpdateFlags,updatedValuators);
 		}
-	dispatcher.interrupt();
-	}
-
-void VRDeviceServer::updateCompleted(void)
-	{
-	/* Update the version number of the device manager's tracking state and wake up the run loop: */
-	++managerTrackerStateVersion;
+	
+	/* Update the version number of the device manager's tracking state if the update is complete: */
+	if(batch.complete)
+		++managerTrackerStateVersion;
+	
+	/* Wake up the run loop once for the entire batch: */
 	dispatcher.interrupt();
 	}
 
@@ -1217,6 +1353,8 @@ void VRDeviceServer::run(void)
 		printf("VRDeviceServer: Listening for incoming connections on UNIX domain socket %s\n",static_cast<Comm::ListeningUNIXSocket*>(unixListeningSocket.getPointer())->getAddress().c_str());
 	if(httpListeningSocket!=0)
 		printf("VRDeviceServer: Listening for HTTP requests on TCP port %d\n",static_cast<Comm::ListeningTCPSocket*>(httpListeningSocket.getPointer())->getPortId());
+	if(multicastSocket!=0)
+		printf("VRDeviceServer: Sending multicast state updates to group %s on port %u\n",Comm::IPv4Address(multicastGroupAddress).getAddress().c_str(),multicastPort);
 	fflush(stdout);
 	#endif
 	
@@ -1238,6 +1376,10 @@ void VRDeviceServer::run(void)
 					if(!writeStateUpdates(csIt))
 						--csIt;
 				
+				/* Send the updated state once to all clients streaming from the multicast group: */
+				if(numMulticastClients>0)
+					writeMulticastUpdate();
+				
 				/* Reset the incremental update arrays: */
 				haveUpdates=false;
 				
@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceServer - Class encapsulating the VR device protocol's server
 side.
-Copyright (c) 2002-2025 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
 
@@ -23,6 +23,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <string>
 #include <vector>
+#include <Misc/SizedTypes.h>
 #include <Misc/SimpleObjectSet.h>
 #include <Threads/EventDispatcher.h>
 #include <Comm/ListeningSocket.h>
@@ -38,6 +39,9 @@ class ConfigurationFile;
 namespace IO {
 class JsonObject;
 }
+namespace Comm {
+class UDPSocket;
+}
 namespace Vrui {
 class BatteryState;
 class HMDConfiguration;
@@ -63,9 +67,12 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer,public Vrui::VRDevicePro
 		bool clientExpectsValidFlags; // Flag whether the connected client expects to receive tracker valid flags
 		bool active; // Flag whether the client is currently active
 		bool streaming; // Flag whether client is currently in streaming mode
+		bool multicast; // Flag whether the client receives state updates from the server's multicast group while in streaming mode
+		Vrui::VRDeviceProtocol::FrameCoder* frameCoder; // Coder to send incremental updates as frames if the client requested a frame stream; null otherwise
 		
 		/* Constructors and destructors: */
 		ClientState(VRDeviceServer* sServer,Comm::PipePtr sPipe); // Connects to a VR client over the given pipe
+		~ClientState(void);
 		};
 	
 	typedef Misc::SimpleObjectSet<ClientState> ClientStateList; // Data type for sets of states of connected clients
@@ -114,10 +121,19 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer,public Vrui::VRDevicePro
 	int deviceStateMemoryFd; // File descriptor to access the device manager's shared-memory device state
 	Comm::ListeningSocketPtr httpListeningSocket; // Optional TCP socket on which the server accepts requests and commands in HTML format
 	Threads::EventDispatcher::ListenerKey httpListeningSocketKey; // Key for IO events on the listening HTTP socket
+	Comm::UDPSocket* multicastSocket; // Optional UDP socket connected to a multicast group to which state updates are sent once for all multicast streaming clients
+	Misc::UInt32 multicastGroupAddress; // IPv4 address of the multicast group in host byte order
+	unsigned int multicastPort; // Port number of the multicast group
+	Misc::UInt32 multicastStreamId; // Identifier of this server's multicast stream to distinguish it from other streams sent to the same group
+	Misc::UInt32 multicastSequence; // Sequence number of the next multicast state update
+	Vrui::VRDeviceProtocol::FrameCoder* multicastCoder; // Coder to encode self-contained multicast state updates
+	std::vector<int> allTrackers,allButtons,allValuators; // Lists of all tracker, button, and valuator indices, sent in each multicast state update
+	Misc::UInt8* multicastBuffer; // Buffer to assemble multicast state update datagrams
 	
 	ClientStateList clientStates; // List of currently connected clients
 	unsigned int numActiveClients; // Number of clients that are currently active
 	unsigned int numStreamingClients; // Number of clients that are currently streaming
+	unsigned int numMulticastClients; // Number of streaming clients that receive state updates from the multicast group
 	Threads::EventDispatcher::Time suspendTime; // Inactivity interval after which VR devices will be suspended
 	Threads::EventDispatcher::ListenerKey suspendTimerKey; // Key for timer to suspend VR devices a certain time after the last client deactivated
 	
@@ -152,6 +168,7 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer,public Vrui::VRDevicePro
 	static void clientMessageCallback(Threads::EventDispatcher::IOEvent& event); // Callback called when a message from a client arrives
 	void disconnectClientOnError(ClientStateList::iterator csIt,const std::runtime_error& err); // Forcefully disconnects a client after a communication error
 	bool writeStateUpdates(ClientStateList::iterator csIt); // Writes changes in the device manager's device state to the given client; returns false on error
+	void writeMulticastUpdate(void); // Sends the device manager's current (locked) state to the multicast group
 	bool writeServerState(ClientStateList::iterator csIt); // Writes the device manager's current (locked) state to the given client; returns false on error
 	bool writeBatteryState(ClientStateList::iterator csIt,unsigned int deviceIndex); // Writes the device manager's given battery state to the given client; returns false on error
 	bool writeHmdConfiguration(ClientStateList::iterator csIt,HMDConfigurationVersions& hmdConfigurationVersions); // Writes the given HMD configuration to the given client; returns false on error
@@ -162,10 +179,7 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer,public Vrui::VRDevicePro
 	virtual ~VRDeviceServer(void);
 	
 	/* Methods from VRDeviceManager::VRStreamer: */
-	virtual void trackerUpdated(int trackerIndex);
-	virtual void buttonUpdated(int buttonIndex);
-	virtual void valuatorUpdated(int valuatorIndex);
-	virtual void updateCompleted(void);
+	virtual void updateCompleted(const VRDeviceManager::UpdateBatch& batch);
 	virtual void batteryStateUpdated(unsigned int deviceIndex);
 	virtual void hmdConfigurationUpdated(const Vrui::HMDConfiguration* hmdConfiguration);
 	
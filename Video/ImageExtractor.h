@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageExtractor - Abstract base class for processors that can extract
 image data in a variety of formats from raw video streams.
-Copyright (c) 2009-2024 Oliver Kreylos
+Copyright (c) 2009-2026 Oliver Kreylos
 
 This file is part of the Basic Video Library (Video).
 
@@ -38,12 +38,13 @@ class ImageExtractor
 	/* Elements: */
 	protected:
 	Size size; // Size of video frames extracted by this extractor
+	bool parallel; // Flag whether to extract the rows of large video frames in parallel using the worker pool
 	
 	/* Constructors and destructors: */
 	public:
 	static ImageExtractor* createExtractor(const VideoDataFormat& format); // Returns a new-allocated image extractor for the given video data format
 	ImageExtractor(const Size& sSize) // Creates an image extractor for the given frame size
-		:size(sSize)
+		:size(sSize),parallel(false)
 		{
 		}
 	virtual ~ImageExtractor(void)
@@ -55,6 +56,14 @@ class ImageExtractor
 		{
 		return size;
 		}
+	bool isParallel(void) const // Returns true if the extractor processes large video frames in parallel
+		{
+		return parallel;
+		}
+	void setParallel(bool newParallel) // Sets whether the extractor processes the rows of large video frames in parallel using the worker pool; this reduces latency at the cost of occupying worker threads
+		{
+		parallel=newParallel;
+		}
 	virtual void extractGrey(const FrameBuffer* frame,void* image) =0; // Extracts an 8-bit greyscale image from the given video buffer; image buffer must hold 1 byte per pixel
 	virtual void extractRGB(const FrameBuffer* frame,void* image) =0; // Extracts an 8-bit RGB image from the given video buffer; image buffer must hold 3 bytes per pixel
 	virtual void extractYpCbCr(const FrameBuffer* frame,void* image) =0; // Extracts an 8-bit Y'CbCr image from the given video buffer; image buffer must hold 3 bytes per pixel
@@ -0,0 +1,272 @@
+/***********************************************************************
+ExtractorKernels - Helper functions shared by image extractors to
+convert runs of video pixels using vector instructions where available,
+and to process the rows of large video frames in parallel.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Basic Video Library (Video).
+
+The Basic Video Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The Basic Video Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Basic Video Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VIDEO_EXTRACTORKERNELS_INCLUDED
+#define VIDEO_EXTRACTORKERNELS_INCLUDED
+
+#include <stddef.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <Threads/WorkerPool.h>
+
+namespace Video {
+
+const size_t minParallelPixels=size_t(1)<<19; // Minimum number of pixels in a video frame to process its rows in parallel
+
+template <class RowFunctorParam>
+inline
+void
+processRows(
+	RowFunctorParam& functor,
+	unsigned int numRows,
+	size_t numPixels,
+	bool parallel)
+	{
+	/* Process large frames in strips of rows from the worker pool if requested, and all other frames from the calling thread: */
+	if(parallel&&numPixels>=minParallelPixels)
+		Threads::WorkerPool::parallelFor(0,numRows,0,functor);
+	else
+		functor(0,numRows);
+	}
+
+#ifdef __SSE2__
+
+inline void storeRgbx4(__m128i rgbx,unsigned char* rgb) // Stores four pixels given as 32-bit RGBX values as packed RGB pixels; overwrites the two bytes following the last pixel
+	{
+	/* Pack the color components of each pair of pixels into a 64-bit lane and store the lanes with overlap: */
+	const __m128i lowMask=_mm_set_epi32(0x0,0x00ffffff,0x0,0x00ffffff);
+	const __m128i highMask=_mm_set_epi32(0x00ffffff,0x0,0x00ffffff,0x0);
+	__m128i packed=_mm_or_si128(_mm_and_si128(rgbx,lowMask),_mm_srli_epi64(_mm_and_si128(rgbx,highMask),8));
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(rgb),packed);
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(rgb+6),_mm_unpackhi_epi64(packed,packed));
+	}
+
+inline void storeRgb8(__m128i r,__m128i g,__m128i b,unsigned char* rgb) // Interleaves the low eight bytes of the given component vectors and stores them as packed RGB pixels; overwrites the two bytes following the last pixel
+	{
+	__m128i rg=_mm_unpacklo_epi8(r,g);
+	__m128i bx=_mm_unpacklo_epi8(b,_mm_setzero_si128());
+	storeRgbx4(_mm_unpacklo_epi16(rg,bx),rgb);
+	storeRgbx4(_mm_unpackhi_epi16(rg,bx),rgb+12);
+	}
+
+inline __m128i fixed16ToUInt8(__m128i lo,__m128i hi) // Rounds and clamps two vectors of 32-bit fixed-point values in the same way as clampFixed16, and returns the results in the low eight bytes
+	{
+	const __m128i round=_mm_set1_epi32(32768);
+	lo=_mm_srai_epi32(_mm_add_epi32(lo,round),16);
+	hi=_mm_srai_epi32(_mm_add_epi32(hi,round),16);
+	__m128i result=_mm_packs_epi32(lo,hi);
+	return _mm_packus_epi16(result,result);
+	}
+
+inline void ypcbcrToRgb8(__m128i yp,__m128i cb,__m128i cr,unsigned char* rgb) // Converts eight Y'CbCr pixels given as 16-bit components to RGB with the same results as ypcbcrToRgb, and stores them as packed RGB pixels; overwrites the two bytes following the last pixel
+	{
+	/* Remove the components' offsets: */
+	yp=_mm_sub_epi16(yp,_mm_set1_epi16(16));
+	cb=_mm_sub_epi16(cb,_mm_set1_epi16(128));
+	cr=_mm_sub_epi16(cr,_mm_set1_epi16(128));
+	
+	/*********************************************************************
+	Split the 17-bit conversion weights into multiples of 65536 and 16-bit
+	remainders, and calculate the remainder terms from interleaved pairs
+	of components using multiply-add instructions:
+	*********************************************************************/
+	
+	const __m128i highMask=_mm_set1_epi32(int(0xffff0000U));
+	const __m128i rWeights=_mm_set_epi16(-26475,10773,-26475,10773,-26475,10773,-26475,10773); // y*76309+cr*104597=y*65536+cr*131072+y*10773-cr*26475
+	const __m128i gWeights0=_mm_set_epi16(12257,10773,12257,10773,12257,10773,12257,10773); // y*76309-cb*25675-cr*53279=y*65536-cr*65536+y*10773+cr*12257-cb*25675
+	const __m128i gWeights1=_mm_set_epi16(-25675,0,-25675,0,-25675,0,-25675,0);
+	const __m128i bWeights=_mm_set_epi16(1130,10773,1130,10773,1130,10773,1130,10773); // y*76309+cb*132202=y*65536+cb*131072+y*10773+cb*1130
+	__m128i r[2],g[2],b[2];
+	for(int i=0;i<2;++i)
+		{
+		/* Interleave Y' with Cr and with Cb: */
+		__m128i ypcr=i==0?_mm_unpacklo_epi16(yp,cr):_mm_unpackhi_epi16(yp,cr);
+		__m128i ypcb=i==0?_mm_unpacklo_epi16(yp,cb):_mm_unpackhi_epi16(yp,cb);
+		
+		/* Calculate the multiples of 65536: */
+		__m128i yp16=_mm_slli_epi32(ypcr,16);
+		__m128i cr16=_mm_and_si128(ypcr,highMask);
+		__m128i cb16=_mm_and_si128(ypcb,highMask);
+		
+		/* Calculate the fixed-point color components: */
+		r[i]=_mm_add_epi32(_mm_add_epi32(yp16,_mm_add_epi32(cr16,cr16)),_mm_madd_epi16(ypcr,rWeights));
+		g[i]=_mm_add_epi32(_mm_sub_epi32(yp16,cr16),_mm_add_epi32(_mm_madd_epi16(ypcr,gWeights0),_mm_madd_epi16(ypcb,gWeights1)));
+		b[i]=_mm_add_epi32(_mm_add_epi32(yp16,_mm_add_epi32(cb16,cb16)),_mm_madd_epi16(ypcb,bWeights));
+		}
+	
+	/* Convert the color components to 8 bits and store the pixels: */
+	storeRgb8(fixed16ToUInt8(r[0],r[1]),fixed16ToUInt8(g[0],g[1]),fixed16ToUInt8(b[0],b[1]),rgb);
+	}
+
+template <int ypShiftParam>
+inline
+void
+unpackYpCbCr422(
+	__m128i pixels,
+	__m128i& yp,
+	__m128i& cb,
+	__m128i& cr)
+	{
+	/* Separate the Y' components from the interleaved Cb and Cr components: */
+	const __m128i lowMask16=_mm_set1_epi16(0x00ff);
+	yp=_mm_and_si128(_mm_srli_epi16(pixels,ypShiftParam),lowMask16);
+	__m128i cbcr=_mm_and_si128(_mm_srli_epi16(pixels,8-ypShiftParam),lowMask16);
+	
+	/* Duplicate the Cb and Cr components shared by each pair of pixels: */
+	const __m128i lowMask32=_mm_set1_epi32(0x0000ffff);
+	cb=_mm_and_si128(cbcr,lowMask32);
+	cb=_mm_or_si128(cb,_mm_slli_epi32(cb,16));
+	cr=_mm_srli_epi32(cbcr,16);
+	cr=_mm_or_si128(cr,_mm_slli_epi32(cr,16));
+	}
+
+#endif
+
+template <int ypShiftParam>
+inline
+unsigned int
+convertYpCbCr422ToRgb(
+	const unsigned char* pixels,
+	unsigned char* rgb,
+	unsigned int width)
+	{
+	/* Convert runs of eight Y'CbCr 4:2:2 pixels whose Y' components are at the given bit offset in each 16-bit word, and leave at least one pixel for the caller; returns the number of converted pixels: */
+	unsigned int x=0;
+	#ifdef __SSE2__
+	for(;x+8<width;x+=8,pixels+=16,rgb+=24)
+		{
+		__m128i yp,cb,cr;
+		unpackYpCbCr422<ypShiftParam>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)),yp,cb,cr);
+		ypcbcrToRgb8(yp,cb,cr,rgb);
+		}
+	#endif
+	return x;
+	}
+
+template <int ypShiftParam,int chromaShiftParam>
+inline
+unsigned int
+splitYpCbCr422(
+	const unsigned char* pixels,
+	unsigned char* yp,
+	unsigned char* chroma,
+	unsigned int width)
+	{
+	/* Split runs of 16 Y'CbCr 4:2:2 pixels into Y' components and the chroma components at the given bit offset in each 32-bit word; returns the number of processed pixels: */
+	unsigned int x=0;
+	#ifdef __SSE2__
+	const __m128i lowMask16=_mm_set1_epi16(0x00ff);
+	const __m128i lowMask32=_mm_set1_epi32(0x000000ff);
+	for(;x+16<=width;x+=16,pixels+=32,yp+=16,chroma+=8)
+		{
+		__m128i p0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+		__m128i p1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels+16));
+		__m128i yp0=_mm_and_si128(_mm_srli_epi16(p0,ypShiftParam),lowMask16);
+		__m128i yp1=_mm_and_si128(_mm_srli_epi16(p1,ypShiftParam),lowMask16);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(yp),_mm_packus_epi16(yp0,yp1));
+		__m128i c0=_mm_and_si128(_mm_srli_epi32(p0,chromaShiftParam),lowMask32);
+		__m128i c1=_mm_and_si128(_mm_srli_epi32(p1,chromaShiftParam),lowMask32);
+		__m128i c=_mm_packs_epi32(c0,c1);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(chroma),_mm_packus_epi16(c,c));
+		}
+	#endif
+	return x;
+	}
+
+inline unsigned int convertYpCbCr420ToRgb(const unsigned char* yp0,const unsigned char* yp1,const unsigned char* cb,const unsigned char* cr,unsigned char* rgb0,unsigned char* rgb1,unsigned int width) // Converts runs of 2x8 Y'CbCr 4:2:0 pixels from two rows sharing chroma components, and leaves at least one pixel pair for the caller; returns the number of converted pixels per row
+	{
+	unsigned int x=0;
+	#ifdef __SSE2__
+	const __m128i zero=_mm_setzero_si128();
+	for(;x+8<width;x+=8,yp0+=8,yp1+=8,cb+=4,cr+=4,rgb0+=24,rgb1+=24)
+		{
+		/* Load and duplicate four Cb and Cr components: */
+		int cbBits,crBits;
+		memcpy(&cbBits,cb,sizeof(int));
+		memcpy(&crBits,cr,sizeof(int));
+		__m128i cbs=_mm_unpacklo_epi8(_mm_cvtsi32_si128(cbBits),zero);
+		__m128i crs=_mm_unpacklo_epi8(_mm_cvtsi32_si128(crBits),zero);
+		cbs=_mm_unpacklo_epi16(cbs,cbs);
+		crs=_mm_unpacklo_epi16(crs,crs);
+		
+		/* Convert eight pixels from each row: */
+		ypcbcrToRgb8(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(yp0)),zero),cbs,crs,rgb0);
+		ypcbcrToRgb8(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(yp1)),zero),cbs,crs,rgb1);
+		}
+	#endif
+	return x;
+	}
+
+inline unsigned int demosaicBayerRow(const unsigned char* raw,ptrdiff_t stride,unsigned char* rgb,unsigned int width,int ownChannel,bool nonGreenOdd) // Demosaics runs of 16 interior pixels of an interior row of a Bayer-filtered frame starting at pixel 1, where own channel is the non-green channel sampled in the row, and leaves at least one pixel for the caller; returns the index of the first unconverted pixel
+	{
+	unsigned int x=1;
+	#ifdef __SSE2__
+	const __m128i zero=_mm_setzero_si128();
+	const __m128i two=_mm_set1_epi16(2);
+	const __m128i nonGreen=_mm_set1_epi16(nonGreenOdd?0x00ff:int(0xff00));
+	for(;x+16<width;x+=16,rgb+=48)
+		{
+		/* Load the pixel's neighborhoods: */
+		const unsigned char* rPtr=raw+x;
+		__m128i c=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr));
+		__m128i l=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr-1));
+		__m128i r=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr+1));
+		__m128i u=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr-stride));
+		__m128i ul=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr-stride-1));
+		__m128i ur=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr-stride+1));
+		__m128i d=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr+stride));
+		__m128i dl=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr+stride-1));
+		__m128i dr=_mm_loadu_si128(reinterpret_cast<const __m128i*>(rPtr+stride+1));
+		
+		/* Calculate horizontal and vertical two-pixel averages: */
+		__m128i h2=_mm_avg_epu8(l,r);
+		__m128i v2=_mm_avg_epu8(u,d);
+		
+		/* Calculate cross-shaped and diagonal four-pixel averages: */
+		__m128i x4Lo=_mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(u,zero),_mm_unpacklo_epi8(l,zero)),_mm_add_epi16(_mm_unpacklo_epi8(r,zero),_mm_unpacklo_epi8(d,zero)));
+		__m128i x4Hi=_mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(u,zero),_mm_unpackhi_epi8(l,zero)),_mm_add_epi16(_mm_unpackhi_epi8(r,zero),_mm_unpackhi_epi8(d,zero)));
+		__m128i x4=_mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(x4Lo,two),2),_mm_srli_epi16(_mm_add_epi16(x4Hi,two),2));
+		__m128i d4Lo=_mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(ul,zero),_mm_unpacklo_epi8(ur,zero)),_mm_add_epi16(_mm_unpacklo_epi8(dl,zero),_mm_unpacklo_epi8(dr,zero)));
+		__m128i d4Hi=_mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(ul,zero),_mm_unpackhi_epi8(ur,zero)),_mm_add_epi16(_mm_unpackhi_epi8(dl,zero),_mm_unpackhi_epi8(dr,zero)));
+		__m128i d4=_mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(d4Lo,two),2),_mm_srli_epi16(_mm_add_epi16(d4Hi,two),2));
+		
+		/* Select the channel values for non-green and green pixels: */
+		__m128i own=_mm_or_si128(_mm_and_si128(nonGreen,c),_mm_andnot_si128(nonGreen,h2));
+		__m128i green=_mm_or_si128(_mm_and_si128(nonGreen,x4),_mm_andnot_si128(nonGreen,c));
+		__m128i other=_mm_or_si128(_mm_and_si128(nonGreen,d4),_mm_andnot_si128(nonGreen,v2));
+		
+		/* Store the pixels: */
+		__m128i red=ownChannel==0?own:other;
+		__m128i blue=ownChannel==0?other:own;
+		storeRgb8(red,green,blue,rgb);
+		storeRgb8(_mm_srli_si128(red,8),_mm_srli_si128(green,8),_mm_srli_si128(blue,8),rgb+24);
+		}
+	#endif
+	return x;
+	}
+
+}
+
+#endif
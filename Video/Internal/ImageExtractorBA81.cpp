@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageExtractorBA81 - Class to extract images from raw video frames
 encoded using an eight-bit Bayer pattern.
-Copyright (c) 2010-2022 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Basic Video Library (Video).
 
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/SizedTypes.h>
 #include <Video/FrameBuffer.h>
 #include <Video/Colorspaces.h>
+#include <Video/Internal/ExtractorKernels.h>
 
 namespace Video {
 
@@ -54,6 +55,195 @@ inline unsigned char rgbToGrey(unsigned char r,unsigned char g,unsigned char b)
 	return (unsigned char)(((unsigned int)r*306U+(unsigned int)g*601U+(unsigned int)b*117U+512U)>>10);
 	}
 
+template <int ownChannelParam>
+inline
+void
+convertNonGreenPixel(
+	const unsigned char* rPtr,
+	int stride,
+	unsigned char* cPtr)
+	{
+	/* Convert a central pixel of the row's own non-green channel: */
+	cPtr[ownChannelParam]=rPtr[0];
+	cPtr[1]=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
+	cPtr[2-ownChannelParam]=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
+	}
+
+template <int ownChannelParam>
+inline
+void
+convertGreenPixel(
+	const unsigned char* rPtr,
+	int stride,
+	unsigned char* cPtr)
+	{
+	/* Convert a central green pixel: */
+	cPtr[ownChannelParam]=avg(rPtr[-1],rPtr[1]);
+	cPtr[1]=rPtr[0];
+	cPtr[2-ownChannelParam]=avg(rPtr[-stride],rPtr[stride]);
+	}
+
+template <int ownChannelParam,bool nonGreenOddParam>
+inline
+void
+convertCentralRow(
+	const unsigned char* rRowPtr,
+	int stride,
+	unsigned char* cRowPtr,
+	unsigned int width)
+	{
+	/*********************************************************************
+	Convert a central row whose own non-green channel (red or blue) is at
+	index ownChannelParam in RGB, and whose non-green pixels are at odd or
+	even pixel indices:
+	*********************************************************************/
+	
+	/* Convert the row's first pixel: */
+	const unsigned char* rPtr=rRowPtr;
+	unsigned char* cPtr=cRowPtr;
+	if(nonGreenOddParam)
+		{
+		cPtr[ownChannelParam]=rPtr[1];
+		cPtr[1]=rPtr[0];
+		cPtr[2-ownChannelParam]=avg(rPtr[-stride],rPtr[stride]);
+		}
+	else
+		{
+		cPtr[ownChannelParam]=rPtr[0];
+		cPtr[1]=avg(rPtr[-stride],rPtr[1],rPtr[stride]);
+		cPtr[2-ownChannelParam]=avg(rPtr[-stride+1],rPtr[stride+1]);
+		}
+	
+	/* Convert runs of central pixels using vector instructions: */
+	unsigned int x=demosaicBayerRow(rRowPtr,stride,cRowPtr+3,width,ownChannelParam,nonGreenOddParam);
+	rPtr=rRowPtr+x;
+	cPtr=cRowPtr+x*3;
+	
+	/* Convert the remaining central pixels: */
+	for(;x<width-1;x+=2,rPtr+=2,cPtr+=2*3)
+		{
+		if(nonGreenOddParam)
+			{
+			convertNonGreenPixel<ownChannelParam>(rPtr,stride,cPtr);
+			convertGreenPixel<ownChannelParam>(rPtr+1,stride,cPtr+3);
+			}
+		else
+			{
+			convertGreenPixel<ownChannelParam>(rPtr,stride,cPtr);
+			convertNonGreenPixel<ownChannelParam>(rPtr+1,stride,cPtr+3);
+			}
+		}
+	
+	/* Convert the row's last pixel: */
+	if(nonGreenOddParam)
+		{
+		cPtr[ownChannelParam]=rPtr[0];
+		cPtr[1]=avg(rPtr[-stride],rPtr[-1],rPtr[stride]);
+		cPtr[2-ownChannelParam]=avg(rPtr[-stride-1],rPtr[stride-1]);
+		}
+	else
+		{
+		cPtr[ownChannelParam]=rPtr[-1];
+		cPtr[1]=rPtr[0];
+		cPtr[2-ownChannelParam]=avg(rPtr[-stride],rPtr[stride]);
+		}
+	}
+
+/**************
+Helper classes:
+**************/
+
+template <int oddRowOwnChannelParam>
+class CentralRowConverter // Functor class to convert ranges of central rows of a Bayer-filtered frame to RGB
+	{
+	/* Elements: */
+	private:
+	const unsigned char* rRowPtr; // Pointer to the frame's first central (odd) row
+	int stride; // Row stride of the frame
+	unsigned char* cRowPtr; // Pointer to the RGB image row receiving the frame's first central row
+	
+	/* Constructors and destructors: */
+	public:
+	CentralRowConverter(const unsigned char* sRRowPtr,int sStride,unsigned char* sCRowPtr)
+		:rRowPtr(sRRowPtr),stride(sStride),cRowPtr(sCRowPtr)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd)
+		{
+		for(size_t row=rowBegin;row<rowEnd;++row)
+			{
+			/* Odd rows have non-green pixels at odd indices; even rows at even indices: */
+			const unsigned char* rPtr=rRowPtr+row*stride;
+			unsigned char* cPtr=cRowPtr-row*stride*3;
+			if(row%2==0)
+				convertCentralRow<oddRowOwnChannelParam,true>(rPtr,stride,cPtr,stride);
+			else
+				convertCentralRow<2-oddRowOwnChannelParam,false>(rPtr,stride,cPtr,stride);
+			}
+		}
+	};
+
+class YpCbCr420BlockConverter // Functor class to convert ranges of rows of 2x2 pixel blocks from RGB to Y'CbCr 4:2:0
+	{
+	/* Elements: */
+	private:
+	const unsigned char* fRowPtr; // Pointer to the RGB image row corresponding to the frame's first row
+	unsigned int width; // Image width in pixels
+	unsigned char* yp; // Pointer to the first row of the Y' plane
+	unsigned int ypStride; // Row stride of the Y' plane
+	unsigned char* cb; // Pointer to the first row of the Cb plane
+	unsigned int cbStride; // Row stride of the Cb plane
+	unsigned char* cr; // Pointer to the first row of the Cr plane
+	unsigned int crStride; // Row stride of the Cr plane
+	
+	/* Constructors and destructors: */
+	public:
+	YpCbCr420BlockConverter(const unsigned char* sFRowPtr,unsigned int sWidth,void* sYp,unsigned int sYpStride,void* sCb,unsigned int sCbStride,void* sCr,unsigned int sCrStride)
+		:fRowPtr(sFRowPtr),width(sWidth),
+		 yp(static_cast<unsigned char*>(sYp)),ypStride(sYpStride),
+		 cb(static_cast<unsigned char*>(sCb)),cbStride(sCbStride),
+		 cr(static_cast<unsigned char*>(sCr)),crStride(sCrStride)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowPairBegin,size_t rowPairEnd)
+		{
+		for(size_t rowPair=rowPairBegin;rowPair<rowPairEnd;++rowPair)
+			{
+			const unsigned char* fPtr=fRowPtr-rowPair*width*3*2;
+			unsigned char* ypPtr=yp+rowPair*ypStride*2;
+			unsigned char* cbPtr=cb+rowPair*cbStride;
+			unsigned char* crPtr=cr+rowPair*crStride;
+			for(unsigned int x=0;x<width;x+=2)
+				{
+				/* Convert the 2x2 pixel block to Y'CbCr: */
+				unsigned char ypcbcr[4][3];
+				Video::rgbToYpcbcr(fPtr,ypcbcr[0]);
+				Video::rgbToYpcbcr(fPtr+3,ypcbcr[1]);
+				Video::rgbToYpcbcr(fPtr-width*3,ypcbcr[2]);
+				Video::rgbToYpcbcr(fPtr-width*3+3,ypcbcr[3]);
+				
+				/* Subsample and store the Y'CbCr components: */
+				ypPtr[0]=ypcbcr[0][0];
+				ypPtr[1]=ypcbcr[1][0];
+				ypPtr[ypStride]=ypcbcr[2][0];
+				ypPtr[ypStride+1]=ypcbcr[3][0];
+				*cbPtr=(unsigned char)((int(ypcbcr[0][1])+int(ypcbcr[1][1])+int(ypcbcr[2][1])+int(ypcbcr[3][1])+2)>>2);
+				*crPtr=(unsigned char)((int(ypcbcr[0][2])+int(ypcbcr[1][2])+int(ypcbcr[2][2])+int(ypcbcr[3][2])+2)>>2);
+				
+				/* Go to the next pixel: */
+				fPtr+=3*2;
+				ypPtr+=2;
+				++cbPtr;
+				++crPtr;
+				}
+			}
+		}
+	};
+
 }
 
 /***********************************
@@ -337,79 +527,11 @@ void ImageExtractorBA81::extractRGBFromBGGR(const FrameBuffer* frame,void* image
 	rRowPtr+=stride;
 	cRowPtr-=stride*3;
 	
-	/* Convert the central rows: */
-	for(unsigned int y=1;y<size[1]-1;y+=2)
-		{
-		/* Convert the odd row: */
-		rPtr=rRowPtr;
-		cPtr=cRowPtr;
-		
-		/* Convert the odd row's first (G) pixel: */
-		*(cPtr++)=rPtr[1];
-		*(cPtr++)=rPtr[0];
-		*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-		++rPtr;
-		
-		/* Convert the odd row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (R) pixel: */
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			++rPtr;
-			
-			/* Convert the even (G) pixel: */
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			++rPtr;
-			}
-		
-		/* Convert the odd row's last (R) pixel: */
-		*(cPtr++)=rPtr[0];
-		*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[stride]);
-		*(cPtr++)=avg(rPtr[-stride-1],rPtr[stride-1]);
-		++rPtr;
-		
-		rRowPtr+=stride;
-		cRowPtr-=stride*3;
-		
-		/* Convert the even row: */
-		rPtr=rRowPtr;
-		cPtr=cRowPtr;
-		
-		/* Convert the even row's first (B) pixel: */
-		*(cPtr++)=avg(rPtr[-stride+1],rPtr[stride+1]);
-		*(cPtr++)=avg(rPtr[-stride],rPtr[1],rPtr[stride]);
-		*(cPtr++)=rPtr[0];
-		++rPtr;
-		
-		/* Convert the even row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (G) pixel: */
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			++rPtr;
-			
-			/* Convert the even (B) pixel: */
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			++rPtr;
-			}
-		
-		/* Convert the even row's last (G) pixel: */
-		*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-		*(cPtr++)=rPtr[0];
-		*(cPtr++)=rPtr[-1];
-		++rPtr;
-		
-		rRowPtr+=stride;
-		cRowPtr-=stride*3;
-		}
+	/* Convert the central rows, whose odd rows contain red pixels: */
+	CentralRowConverter<0> centralRowConverter(rRowPtr,stride,cRowPtr);
+	processRows(centralRowConverter,size[1]-2,size.volume(),parallel);
+	rRowPtr+=(size[1]-2)*stride;
+	cRowPtr-=(size[1]-2)*stride*3;
 	
 	/* Convert the last row: */
 	rPtr=rRowPtr;
@@ -486,79 +608,11 @@ void ImageExtractorBA81::extractRGBFromRGGB(const FrameBuffer* frame,void* image
 	rRowPtr+=stride;
 	cRowPtr-=stride*3;
 	
-	/* Convert the central rows: */
-	for(unsigned int y=1;y<size[1]-1;y+=2)
-		{
-		/* Convert the odd row: */
-		rPtr=rRowPtr;
-		cPtr=cRowPtr;
-		
-		/* Convert the odd row's first (G) pixel: */
-		*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-		*(cPtr++)=rPtr[0];
-		*(cPtr++)=rPtr[1];
-		++rPtr;
-		
-		/* Convert the odd row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (B) pixel: */
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			++rPtr;
-			
-			/* Convert the even (G) pixel: */
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			++rPtr;
-			}
-		
-		/* Convert the odd row's last (B) pixel: */
-		*(cPtr++)=avg(rPtr[-stride-1],rPtr[stride-1]);
-		*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[stride]);
-		*(cPtr++)=rPtr[0];
-		++rPtr;
-		
-		rRowPtr+=stride;
-		cRowPtr-=stride*3;
-		
-		/* Convert the even row: */
-		rPtr=rRowPtr;
-		cPtr=cRowPtr;
-		
-		/* Convert the even row's first (R) pixel: */
-		*(cPtr++)=rPtr[0];
-		*(cPtr++)=avg(rPtr[-stride],rPtr[1],rPtr[stride]);
-		*(cPtr++)=avg(rPtr[-stride+1],rPtr[stride+1]);
-		++rPtr;
-		
-		/* Convert the even row's central pixels: */
-		for(unsigned x=1;x<size[0]-1;x+=2)
-			{
-			/* Convert the odd (G) pixel: */
-			*(cPtr++)=avg(rPtr[-1],rPtr[1]);
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-			++rPtr;
-			
-			/* Convert the even (R) pixel: */
-			*(cPtr++)=rPtr[0];
-			*(cPtr++)=avg(rPtr[-stride],rPtr[-1],rPtr[1],rPtr[stride]);
-			*(cPtr++)=avg(rPtr[-stride-1],rPtr[-stride+1],rPtr[stride-1],rPtr[stride+1]);
-			++rPtr;
-			}
-		
-		/* Convert the even row's last (G) pixel: */
-		*(cPtr++)=rPtr[-1];
-		*(cPtr++)=rPtr[0];
-		*(cPtr++)=avg(rPtr[-stride],rPtr[stride]);
-		++rPtr;
-		
-		rRowPtr+=stride;
-		cRowPtr-=stride*3;
-		}
+	/* Convert the central rows, whose odd rows contain blue pixels: */
+	CentralRowConverter<2> centralRowConverter(rRowPtr,stride,cRowPtr);
+	processRows(centralRowConverter,size[1]-2,size.volume(),parallel);
+	rRowPtr+=(size[1]-2)*stride;
+	cRowPtr-=(size[1]-2)*stride*3;
 	
 	/* Convert the last row: */
 	rPtr=rRowPtr;
@@ -681,46 +735,8 @@ void ImageExtractorBA81::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 		}
 	
 	/* Process temporary pixels in 2x2 blocks: */
-	const unsigned char* fRowPtr=tempImage+(size[1]-1)*size[0]*3;
-	unsigned char* ypRowPtr=static_cast<unsigned char*>(yp);
-	unsigned char* cbRowPtr=static_cast<unsigned char*>(cb);
-	unsigned char* crRowPtr=static_cast<unsigned char*>(cr);
-	for(unsigned int y=0;y<size[1];y+=2)
-		{
-		const unsigned char* fPtr=fRowPtr;
-		unsigned char* ypPtr=ypRowPtr;
-		unsigned char* cbPtr=cbRowPtr;
-		unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Convert the 2x2 pixel block to Y'CbCr: */
-			unsigned char ypcbcr[4][3];
-			Video::rgbToYpcbcr(fPtr,ypcbcr[0]);
-			Video::rgbToYpcbcr(fPtr+3,ypcbcr[1]);
-			Video::rgbToYpcbcr(fPtr-size[0]*3,ypcbcr[2]);
-			Video::rgbToYpcbcr(fPtr-size[0]*3+3,ypcbcr[3]);
-			
-			/* Subsample and store the Y'CbCr components: */
-			ypPtr[0]=ypcbcr[0][0];
-			ypPtr[1]=ypcbcr[1][0];
-			ypPtr[ypStride]=ypcbcr[2][0];
-			ypPtr[ypStride+1]=ypcbcr[3][0];
-			*cbPtr=(unsigned char)((int(ypcbcr[0][1])+int(ypcbcr[1][1])+int(ypcbcr[2][1])+int(ypcbcr[3][1])+2)>>2);
-			*crPtr=(unsigned char)((int(ypcbcr[0][2])+int(ypcbcr[1][2])+int(ypcbcr[2][2])+int(ypcbcr[3][2])+2)>>2);
-			
-			/* Go to the next pixel: */
-			fPtr+=3*2;
-			ypPtr+=2;
-			++cbPtr;
-			++crPtr;
-			}
-		
-		/* Go to the next pixel row: */
-		fRowPtr-=size[0]*3*2;
-		ypRowPtr+=ypStride*2;
-		cbRowPtr+=cbStride;
-		crRowPtr+=crStride;
-		}
+	YpCbCr420BlockConverter blockConverter(tempImage+(size[1]-1)*size[0]*3,size[0],yp,ypStride,cb,cbStride,cr,crStride);
+	processRows(blockConverter,size[1]/2,size.volume(),parallel);
 	
 	/* Delete the temporary RGB image: */
 	delete[] tempImage;
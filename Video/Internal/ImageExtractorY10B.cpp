@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageExtractorY10B - Class to extract images from raw video frames
 encoded 10-bit byte-packed greyscale format.
-Copyright (c) 2013-2022 Oliver Kreylos
+Copyright (c) 2013-2026 Oliver Kreylos
 
 This file is part of the Basic Video Library (Video).
 
@@ -25,9 +25,93 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <Video/FrameBuffer.h>
 #include <Video/Colorspaces.h>
+#include <Video/Internal/ExtractorKernels.h>
 
 namespace Video {
 
+namespace {
+
+/**************************************************************
+Helper classes to unpack ranges of rows from Y10B video frames:
+**************************************************************/
+
+class RGBRowExtractor // Functor class to convert ranges of frame rows to RGB
+	{
+	/* Elements: */
+	private:
+	const unsigned char* frame; // Pointer to the frame's first row
+	unsigned char* image; // Pointer to the RGB image row receiving the frame's first row
+	unsigned int width; // Frame width in pixels
+	const unsigned char* rgbYs; // Table mapping 10-bit Y' values to 8-bit Y values
+	
+	/* Constructors and destructors: */
+	public:
+	RGBRowExtractor(const unsigned char* sFrame,unsigned char* sImage,unsigned int sWidth,const unsigned char* sRgbYs)
+		:frame(sFrame),image(sImage),width(sWidth),rgbYs(sRgbYs)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd)
+		{
+		for(size_t y=rowBegin;y<rowEnd;++y)
+			{
+			const unsigned char* rPtr=frame+y*((width*5)/4);
+			unsigned char* rgbPtr=image-y*width*3;
+			for(unsigned int x=0;x<width;x+=4,rPtr+=5)
+				{
+				/* Extract the pixel values from a run of four pixels: */
+				unsigned int yps[4];
+				yps[0]=((unsigned int)rPtr[0]<<2)|((unsigned int)rPtr[1]>>6);
+				yps[1]=(((unsigned int)rPtr[1]&0x3fU)<<4)|((unsigned int)rPtr[2]>>4);
+				yps[2]=(((unsigned int)rPtr[2]&0x0fU)<<6)|((unsigned int)rPtr[3]>>2);
+				yps[3]=(((unsigned int)rPtr[3]&0x03U)<<8)|(unsigned int)rPtr[4];
+				
+				/* Convert the four pixel values from Y' to Y via the lookup table: */
+				for(int i=0;i<4;++i,rgbPtr+=3)
+					rgbPtr[2]=rgbPtr[1]=rgbPtr[0]=rgbYs[yps[i]];
+				}
+			}
+		}
+	};
+
+class YpRowExtractor // Functor class to unpack ranges of frame rows into a Y' plane
+	{
+	/* Elements: */
+	private:
+	const unsigned char* frame; // Pointer to the frame's first row
+	unsigned int width; // Frame width in pixels
+	unsigned char* yp; // Pointer to the first row of the Y' plane
+	unsigned int ypStride; // Row stride of the Y' plane
+	
+	/* Constructors and destructors: */
+	public:
+	YpRowExtractor(const unsigned char* sFrame,unsigned int sWidth,void* sYp,unsigned int sYpStride)
+		:frame(sFrame),width(sWidth),yp(static_cast<unsigned char*>(sYp)),ypStride(sYpStride)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd)
+		{
+		for(size_t y=rowBegin;y<rowEnd;++y)
+			{
+			const unsigned char* rPtr=frame+y*((width*5)/4);
+			unsigned char* ypPtr=yp+y*ypStride;
+			for(unsigned int x=0;x<width;x+=4,rPtr+=5,ypPtr+=4)
+				{
+				/* Extract the pixel values from a run of four pixels: */
+				ypPtr[0]=(unsigned char)(((((unsigned int)rPtr[0]<<2)|((unsigned int)rPtr[1]>>6))+2U)>>2);
+				ypPtr[1]=(unsigned char)((((((unsigned int)rPtr[1]&0x3fU)<<4)|((unsigned int)rPtr[2]>>4))+2U)>>2);
+				ypPtr[2]=(unsigned char)((((((unsigned int)rPtr[2]&0x0fU)<<6)|((unsigned int)rPtr[3]>>2))+2U)>>2);
+				ypPtr[3]=(unsigned char)((((((unsigned int)rPtr[3]&0x03U)<<8)|(unsigned int)rPtr[4])+2U)>>2);
+				}
+			}
+		}
+	};
+
+}
+
 /***********************************
 Methods of class ImageExtractorY10B:
 ***********************************/
@@ -35,6 +119,16 @@ Methods of class ImageExtractorY10B:
 ImageExtractorY10B::ImageExtractorY10B(const Size& sSize)
 	:ImageExtractor(sSize)
 	{
+	/* Initialize the Y' to Y conversion table for RGB extraction: */
+	for(unsigned int yp=0;yp<1024U;++yp)
+		{
+		if(yp<=64U)
+			rgbYs[yp]=0U;
+		else if(yp>=944U)
+			rgbYs[yp]=255U;
+		else
+			rgbYs[yp]=(unsigned char)(((yp-62U)*256U)/880U);
+		}
 	}
 
 void ImageExtractorY10B::extractGrey(const FrameBuffer* frame,void* image)
@@ -74,38 +168,8 @@ void ImageExtractorY10B::extractGrey(const FrameBuffer* frame,void* image)
 void ImageExtractorY10B::extractRGB(const FrameBuffer* frame,void* image)
 	{
 	/* Unpack pixel bits and convert the frame's Y' channel to Y and then to RGB: */
-	const unsigned char* rRowPtr=frame->start;
-	unsigned char* rgbRowPtr=static_cast<unsigned char*>(image);
-	rgbRowPtr+=(size[1]-1)*size[0]*3;
-	for(unsigned int y=0;y<size[1];++y,rRowPtr+=(size[0]*5)/4,rgbRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* rgbPtr=rgbRowPtr;
-		for(unsigned int x=0;x<size[0];x+=4,rPtr+=5)
-			{
-			/* Extract the pixel values from a run of four pixels: */
-			unsigned int yps[4];
-			yps[0]=((unsigned int)rPtr[0]<<2)|((unsigned int)rPtr[1]>>6);
-			yps[1]=(((unsigned int)rPtr[1]&0x3fU)<<4)|((unsigned int)rPtr[2]>>4);
-			yps[2]=(((unsigned int)rPtr[2]&0x0fU)<<6)|((unsigned int)rPtr[3]>>2);
-			yps[3]=(((unsigned int)rPtr[3]&0x03U)<<8)|(unsigned int)rPtr[4];
-			
-			/* Convert the four pixel values from Y' to Y: */
-			for(int i=0;i<4;++i)
-				{
-				/* Convert from Y' to Y: */
-				unsigned char y;
-				if(yps[i]<=64U)
-					y=0U;
-				else if(yps[i]>=944U)
-					y=255U;
-				else
-					y=(unsigned char)(((yps[i]-62U)*256U)/880U);
-				for(int j=0;j<3;++j,++rgbPtr)
-					*rgbPtr=y;
-				}
-			}
-		}
+	RGBRowExtractor rowExtractor(frame->start,static_cast<unsigned char*>(image)+(size[1]-1)*size[0]*3,size[0],rgbYs);
+	processRows(rowExtractor,size[1],size.volume(),parallel);
 	}
 
 void ImageExtractorY10B::extractYpCbCr(const FrameBuffer* frame,void* image)
@@ -140,21 +204,8 @@ void ImageExtractorY10B::extractYpCbCr(const FrameBuffer* frame,void* image)
 void ImageExtractorY10B::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
 	{
 	/* Unpack pixel bits and copy the frame's Y' channel into the Y' plane: */
-	const unsigned char* rRowPtr=frame->start;
-	unsigned char* ypRowPtr=static_cast<unsigned char*>(yp);
-	for(unsigned int y=0;y<size[1];++y,rRowPtr+=(size[0]*5)/4,ypRowPtr+=ypStride)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* ypPtr=ypRowPtr;
-		for(unsigned int x=0;x<size[0];x+=4,rPtr+=5,ypPtr+=4)
-			{
-			/* Extract the pixel values from a run of four pixels: */
-			ypPtr[0]=(unsigned char)(((((unsigned int)rPtr[0]<<2)|((unsigned int)rPtr[1]>>6))+2U)>>2);
-			ypPtr[1]=(unsigned char)((((((unsigned int)rPtr[1]&0x3fU)<<4)|((unsigned int)rPtr[2]>>4))+2U)>>2);
-			ypPtr[2]=(unsigned char)((((((unsigned int)rPtr[2]&0x0fU)<<6)|((unsigned int)rPtr[3]>>2))+2U)>>2);
-			ypPtr[3]=(unsigned char)((((((unsigned int)rPtr[3]&0x03U)<<8)|(unsigned int)rPtr[4])+2U)>>2);
-			}
-		}
+	YpRowExtractor rowExtractor(frame->start,size[0],yp,ypStride);
+	processRows(rowExtractor,size[1],size.volume(),parallel);
 	
 	/* Reset the Cb and Cr planes to zero: */
 	unsigned char* cbRowPtr=static_cast<unsigned char*>(cb);
@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageExtractorY10B - Class to extract images from raw video frames
 encoded 10-bit byte-packed greyscale format.
-Copyright (c) 2013-2022 Oliver Kreylos
+Copyright (c) 2013-2026 Oliver Kreylos
 
 This file is part of the Basic Video Library (Video).
 
@@ -29,6 +29,10 @@ namespace Video {
 
 class ImageExtractorY10B:public ImageExtractor
 	{
+	/* Elements: */
+	private:
+	unsigned char rgbYs[1024]; // Table mapping 10-bit Y' values to 8-bit Y values for RGB extraction
+	
 	/* Constructors and destructors: */
 	public:
 	ImageExtractorY10B(const Size& sSize); // Constructs an extractor for the given frame size
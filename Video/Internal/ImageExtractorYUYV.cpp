@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageExtractorYUYV - Class to extract images from raw video frames
 encoded in YpCbCr 4:2:2 format.
-Copyright (c) 2010-2022 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Basic Video Library (Video).
 
@@ -24,9 +24,131 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Video/FrameBuffer.h>
 #include <Video/Colorspaces.h>
+#include <Video/Internal/ExtractorKernels.h>
 
 namespace Video {
 
+namespace {
+
+/***************************************************************
+Helper classes to extract ranges of rows from YUYV video frames:
+***************************************************************/
+
+class RGBRowExtractor // Functor class to convert ranges of frame rows to RGB
+	{
+	/* Elements: */
+	private:
+	const unsigned char* frame; // Pointer to the frame's first row
+	unsigned char* image; // Pointer to the RGB image row receiving the frame's first row
+	unsigned int width; // Frame width in pixels
+	
+	/* Constructors and destructors: */
+	public:
+	RGBRowExtractor(const unsigned char* sFrame,unsigned char* sImage,unsigned int sWidth)
+		:frame(sFrame),image(sImage),width(sWidth)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd)
+		{
+		for(size_t y=rowBegin;y<rowEnd;++y)
+			{
+			/* Convert runs of pixels using vector instructions: */
+			const unsigned char* rPtr=frame+y*width*2;
+			unsigned char* cPtr=image-y*width*3;
+			unsigned int x=convertYpCbCr422ToRgb<0>(rPtr,cPtr,width);
+			rPtr+=x*2;
+			cPtr+=x*3;
+			
+			/* Convert the remaining pixels: */
+			for(;x<width;x+=2,cPtr+=2*3,rPtr+=4)
+				{
+				/* Convert first pixel: */
+				unsigned char ypcbcr[3];
+				ypcbcr[0]=rPtr[0];
+				ypcbcr[1]=rPtr[1];
+				ypcbcr[2]=rPtr[3];
+				Video::ypcbcrToRgb(ypcbcr,cPtr);
+				
+				/* Convert second pixel: */
+				ypcbcr[0]=rPtr[2];
+				Video::ypcbcrToRgb(ypcbcr,cPtr+3);
+				}
+			}
+		}
+	};
+
+class YpCbCr420RowExtractor // Functor class to convert ranges of pairs of frame rows to Y'CbCr 4:2:0
+	{
+	/* Elements: */
+	private:
+	const unsigned char* frame; // Pointer to the frame's first row
+	unsigned int width; // Frame width in pixels
+	unsigned char* yp; // Pointer to the first row of the Y' plane
+	unsigned int ypStride; // Row stride of the Y' plane
+	unsigned char* cb; // Pointer to the first row of the Cb plane
+	unsigned int cbStride; // Row stride of the Cb plane
+	unsigned char* cr; // Pointer to the first row of the Cr plane
+	unsigned int crStride; // Row stride of the Cr plane
+	
+	/* Constructors and destructors: */
+	public:
+	YpCbCr420RowExtractor(const unsigned char* sFrame,unsigned int sWidth,void* sYp,unsigned int sYpStride,void* sCb,unsigned int sCbStride,void* sCr,unsigned int sCrStride)
+		:frame(sFrame),width(sWidth),
+		 yp(static_cast<unsigned char*>(sYp)),ypStride(sYpStride),
+		 cb(static_cast<unsigned char*>(sCb)),cbStride(sCbStride),
+		 cr(static_cast<unsigned char*>(sCr)),crStride(sCrStride)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowPairBegin,size_t rowPairEnd)
+		{
+		for(size_t rowPair=rowPairBegin;rowPair<rowPairEnd;++rowPair)
+			{
+			/* Process an even row by keeping its Cb values: */
+			const unsigned char* framePtr=frame+rowPair*2*width*2;
+			unsigned char* ypPtr=yp+rowPair*2*ypStride;
+			unsigned char* cbPtr=cb+rowPair*cbStride;
+			unsigned int x=splitYpCbCr422<0,8>(framePtr,ypPtr,cbPtr,width);
+			framePtr+=x*2;
+			ypPtr+=x;
+			cbPtr+=x/2;
+			for(;x<width;x+=2)
+				{
+				/* Get Yp and Cb from even pixel: */
+				*(ypPtr++)=*(framePtr++);
+				*(cbPtr++)=*(framePtr++);
+				
+				/* Get Yp from odd pixel: */
+				*(ypPtr++)=*(framePtr++);
+				++framePtr;
+				}
+			
+			/* Process an odd row by keeping its Cr values: */
+			ypPtr=yp+(rowPair*2+1)*ypStride;
+			unsigned char* crPtr=cr+rowPair*crStride;
+			x=splitYpCbCr422<0,24>(framePtr,ypPtr,crPtr,width);
+			framePtr+=x*2;
+			ypPtr+=x;
+			crPtr+=x/2;
+			for(;x<width;x+=2)
+				{
+				/* Get Yp from even pixel: */
+				*(ypPtr++)=*(framePtr++);
+				++framePtr;
+				
+				/* Get Yp and Cr from odd pixel: */
+				*(ypPtr++)=*(framePtr++);
+				*(crPtr++)=*(framePtr++);
+				}
+			}
+		}
+	};
+
+}
+
 /***********************************
 Methods of class ImageExtractorYUYV:
 ***********************************/
@@ -61,28 +183,9 @@ void ImageExtractorYUYV::extractGrey(const FrameBuffer* frame,void* image)
 
 void ImageExtractorYUYV::extractRGB(const FrameBuffer* frame,void* image)
 	{
-	/* Convert the frame from Y'CbCr to RGB: */
-	const unsigned char* rRowPtr=frame->start;
-	unsigned char* cRowPtr=static_cast<unsigned char*>(image);
-	cRowPtr+=(size[1]-1)*size[0]*3;
-	for(unsigned int y=0;y<size[1];++y,rRowPtr+=size[0]*2,cRowPtr-=size[0]*3)
-		{
-		const unsigned char* rPtr=rRowPtr;
-		unsigned char* cPtr=cRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2,cPtr+=2*3,rPtr+=4)
-			{
-			/* Convert first pixel: */
-			unsigned char ypcbcr[3];
-			ypcbcr[0]=rPtr[0];
-			ypcbcr[1]=rPtr[1];
-			ypcbcr[2]=rPtr[3];
-			Video::ypcbcrToRgb(ypcbcr,cPtr);
-			
-			/* Convert second pixel: */
-			ypcbcr[0]=rPtr[2];
-			Video::ypcbcrToRgb(ypcbcr,cPtr+3);
-			}
-		}
+	/* Convert the frame from Y'CbCr to RGB, starting at the last image row: */
+	RGBRowExtractor rowExtractor(frame->start,static_cast<unsigned char*>(image)+(size[1]-1)*size[0]*3,size[0]);
+	processRows(rowExtractor,size[1],size.volume(),parallel);
 	}
 
 void ImageExtractorYUYV::extractYpCbCr(const FrameBuffer* frame,void* image)
@@ -113,44 +216,8 @@ void ImageExtractorYUYV::extractYpCbCr(const FrameBuffer* frame,void* image)
 void ImageExtractorYUYV::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsigned int ypStride,void* cb,unsigned int cbStride,void* cr,unsigned int crStride)
 	{
 	/* Process all blocks of two pixel rows: */
-	const unsigned char* framePtr=frame->start;
-	unsigned char* ypRowPtr=static_cast<unsigned char*>(yp);
-	unsigned char* cbRowPtr=static_cast<unsigned char*>(cb);
-	unsigned char* crRowPtr=static_cast<unsigned char*>(cr);
-	for(unsigned int y=0;y<size[1];y+=2)
-		{
-		/* Process an even row by keeping its Cb values: */
-		unsigned char* ypPtr=ypRowPtr;
-		unsigned char* cbPtr=cbRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Get Yp and Cb from even pixel: */
-			*(ypPtr++)=*(framePtr++);
-			*(cbPtr++)=*(framePtr++);
-			
-			/* Get Yp from odd pixel: */
-			*(ypPtr++)=*(framePtr++);
-			++framePtr;
-			}
-		ypRowPtr+=ypStride;
-		cbRowPtr+=cbStride;
-		
-		/* Process an odd row by keeping its Cr values: */
-		ypPtr=ypRowPtr;
-		unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Get Yp from even pixel: */
-			*(ypPtr++)=*(framePtr++);
-			++framePtr;
-			
-			/* Get Yp and Cr from odd pixel: */
-			*(ypPtr++)=*(framePtr++);
-			*(crPtr++)=*(framePtr++);
-			}
-		ypRowPtr+=ypStride;
-		crRowPtr+=crStride;
-		}
+	YpCbCr420RowExtractor rowExtractor(frame->start,size[0],yp,ypStride,cb,cbStride,cr,crStride);
+	processRows(rowExtractor,size[1]/2,size.volume(),parallel);
 	}
 
 }
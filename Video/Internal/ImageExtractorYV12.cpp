@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageExtractorYV12 - Class to extract images from raw video frames
 encoded in YpCbCr 4:2:0 format.
-Copyright (c) 2013-2022 Oliver Kreylos
+Copyright (c) 2013-2026 Oliver Kreylos
 
 This file is part of the Basic Video Library (Video).
 
@@ -25,9 +25,84 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <Video/FrameBuffer.h>
 #include <Video/Colorspaces.h>
+#include <Video/Internal/ExtractorKernels.h>
 
 namespace Video {
 
+namespace {
+
+/****************************************************************
+Helper class to convert ranges of pairs of YV12 video frame rows:
+****************************************************************/
+
+class RGBRowPairExtractor // Functor class to convert ranges of pairs of frame rows to RGB
+	{
+	/* Elements: */
+	private:
+	const unsigned char* planes[3]; // Pointers to the first rows of the frame's Y', Cb, and Cr planes
+	ptrdiff_t strides[3]; // Row strides of the frame's Y', Cb, and Cr planes
+	unsigned char* image; // Pointer to the RGB image row receiving the frame's first row
+	unsigned int width; // Frame width in pixels
+	
+	/* Constructors and destructors: */
+	public:
+	RGBRowPairExtractor(const unsigned char* const sPlanes[3],const ptrdiff_t sStrides[3],unsigned char* sImage,unsigned int sWidth)
+		:image(sImage),width(sWidth)
+		{
+		for(int i=0;i<3;++i)
+			{
+			planes[i]=sPlanes[i];
+			strides[i]=sStrides[i];
+			}
+		}
+	
+	/* Methods: */
+	void operator()(size_t rowPairBegin,size_t rowPairEnd)
+		{
+		for(size_t rowPair=rowPairBegin;rowPair<rowPairEnd;++rowPair)
+			{
+			/* Convert runs of 2x8 pixels using vector instructions: */
+			unsigned char* resultPtr=image-rowPair*2*width*3;
+			const unsigned char* ypPtr=planes[0]+rowPair*2*strides[0];
+			const unsigned char* cbPtr=planes[1]+rowPair*strides[1];
+			const unsigned char* crPtr=planes[2]+rowPair*strides[2];
+			unsigned int x=convertYpCbCr420ToRgb(ypPtr,ypPtr+strides[0],cbPtr,crPtr,resultPtr,resultPtr-width*3,width);
+			resultPtr+=x*3;
+			ypPtr+=x;
+			cbPtr+=x/2;
+			crPtr+=x/2;
+			
+			/* Convert the remaining 2x2 blocks: */
+			for(;x<width;x+=2)
+				{
+				/* Convert the four pixels in the 2x2 block from Y'CbCr to RGB: */
+				unsigned char ypcbcr[3];
+				ypcbcr[0]=ypPtr[0];
+				ypcbcr[1]=*cbPtr;
+				ypcbcr[2]=*crPtr;
+				ypcbcrToRgb(ypcbcr,resultPtr);
+				
+				ypcbcr[0]=ypPtr[1];
+				ypcbcrToRgb(ypcbcr,resultPtr+3);
+				
+				ypcbcr[0]=ypPtr[strides[0]];
+				ypcbcrToRgb(ypcbcr,resultPtr-width*3);
+				
+				ypcbcr[0]=ypPtr[strides[0]+1];
+				ypcbcrToRgb(ypcbcr,resultPtr-width*3+3);
+				
+				/* Go to the next pixel: */
+				resultPtr+=2*3;
+				ypPtr+=2;
+				++cbPtr;
+				++crPtr;
+				}
+			}
+		}
+	};
+
+}
+
 /***********************************
 Methods of class ImageExtractorYV12:
 ***********************************/
@@ -70,47 +145,15 @@ void ImageExtractorYV12::extractGrey(const FrameBuffer* frame,void* image)
 void ImageExtractorYV12::extractRGB(const FrameBuffer* frame,void* image)
 	{
 	/* Convert the frame from Y'CbCr 4:2:0 to RGB by processing blocks of 2x2 pixels: */
-	unsigned char* resultRowPtr=static_cast<unsigned char*>(image)+(size[1]-1)*size[0]*3;
-	const unsigned char* ypRowPtr=frame->start+planes[0].offset;
-	const unsigned char* cbRowPtr=frame->start+planes[1].offset;
-	const unsigned char* crRowPtr=frame->start+planes[2].offset;
-	for(unsigned int y=0;y<size[1];y+=2)
+	const unsigned char* planeRowPtrs[3];
+	ptrdiff_t planeStrides[3];
+	for(int i=0;i<3;++i)
 		{
-		unsigned char* resultPtr=resultRowPtr;
-		const unsigned char* ypPtr=ypRowPtr;
-		const unsigned char* cbPtr=cbRowPtr;
-		const unsigned char* crPtr=crRowPtr;
-		for(unsigned int x=0;x<size[0];x+=2)
-			{
-			/* Convert the four pixels in the 2x2 block from Y'CbCr to RGB: */
-			unsigned char ypcbcr[3];
-			ypcbcr[0]=ypPtr[0];
-			ypcbcr[1]=*cbPtr;
-			ypcbcr[2]=*crPtr;
-			ypcbcrToRgb(ypcbcr,resultPtr);
-			
-			ypcbcr[0]=ypPtr[1];
-			ypcbcrToRgb(ypcbcr,resultPtr+3);
-			
-			ypcbcr[0]=ypPtr[planes[0].stride];
-			ypcbcrToRgb(ypcbcr,resultPtr-size[0]*3);
-			
-			ypcbcr[0]=ypPtr[planes[0].stride+1];
-			ypcbcrToRgb(ypcbcr,resultPtr-size[0]*3+3);
-			
-			/* Go to the next pixel: */
-			resultPtr+=2*3;
-			ypPtr+=2;
-			++cbPtr;
-			++crPtr;
-			}
-
-		/* Go to the next row: */
-		resultRowPtr-=2*size[0]*3;
-		ypRowPtr+=2*planes[0].stride;
-		cbRowPtr+=planes[1].stride;
-		crRowPtr+=planes[2].stride;
+		planeRowPtrs[i]=frame->start+planes[i].offset;
+		planeStrides[i]=planes[i].stride;
 		}
+	RGBRowPairExtractor rowPairExtractor(planeRowPtrs,planeStrides,static_cast<unsigned char*>(image)+(size[1]-1)*size[0]*3,size[0]);
+	processRows(rowPairExtractor,size[1]/2,size.volume(),parallel);
 	}
 
 void ImageExtractorYV12::extractYpCbCr(const FrameBuffer* frame,void* image)
@@ -160,7 +203,7 @@ void ImageExtractorYV12::extractYpCbCr(const FrameBuffer* frame,void* image)
 			++cbPtr;
 			++crPtr;
 			}
-
+		
 		/* Go to the next row: */
 		resultRowPtr-=2*size[0]*3;
 		ypRowPtr+=2*planes[0].stride;
@@ -181,13 +224,13 @@ void ImageExtractorYV12::extractYpCbCr420(const FrameBuffer* frame,void* yp,unsi
 		ypRowPtr+=ypStride;
 		}
 	
-	/* Copy the Cb and Cr planes directly: */
+	/* Copy the Cb and Cr planes, which have half as many rows as the Y' plane, directly: */
 	for(int cbcr=0;cbcr<2;++cbcr)
 		{
 		const unsigned char* cbcrSrcRowPtr=frame->start+planes[cbcr+1].offset;
 		unsigned char* cbcrRowPtr=static_cast<unsigned char*>(cbcr==1?cr:cb);
 		unsigned int cbcrStride=cbcr==1?crStride:cbStride;
-		for(unsigned int y=0;y<size[1];++y)
+		for(unsigned int y=0;y<size[1]/2;++y)
 			{
 			memcpy(cbcrRowPtr,cbcrSrcRowPtr,size[0]/2);
 			cbcrSrcRowPtr+=planes[cbcr+1].stride;
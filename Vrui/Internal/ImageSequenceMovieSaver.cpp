@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageSequenceMovieSaver - Helper class to save movies as sequences of
 image files in formats supported by the Images library.
-Copyright (c) 2010-2024 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -43,13 +43,16 @@ void ImageSequenceMovieSaver::frameWritingThreadMethod(void)
 	{
 	/* Save frames until shut down: */
 	unsigned int frameIndex=0;
-	while(!done)
+	while(true)
 		{
-		/* Add the most recent frame to the captured frame queue: */
+		/* Add the most recent frame to the captured frame queue unless the movie saver is shutting down: */
 		{
 		Threads::MutexCond::Lock captureLock(captureCond);
+		if(done)
+			break;
 		frames.lockNewValue();
 		capturedFrames.push_back(frames.getLockedValue());
+		frameQueued(capturedFrames.size());
 		captureCond.signal();
 		}
 		
@@ -66,11 +69,11 @@ void ImageSequenceMovieSaver::frameWritingThreadMethod(void)
 
 void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 	{
-	unsigned int frameIndex=0;
 	while(true)
 		{
-		/* Wait for the next frame: */
+		/* Wait for the next frame and assign it the next frame index: */
 		FrameBuffer frame;
+		unsigned int frameIndex;
 		{
 		Threads::MutexCond::Lock captureLock(captureCond);
 		while(!done&&capturedFrames.empty())
@@ -79,6 +82,9 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 			break;
 		frame=capturedFrames.front();
 		capturedFrames.pop_front();
+		frameDequeued(capturedFrames.size());
+		frameIndex=nextFrameIndex;
+		++nextFrameIndex;
 		
 		/* Print a progress report if movie saver is already shut down: */
 		if(done)
@@ -91,10 +97,12 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 			}
 		}
 		
+		/* Convert the frame to RGB if it was read back as RGBA: */
+		frame.convertToRGB();
+		
 		/* Write the next frame image file: */
 		char frameName[1024];
 		snprintf(frameName,sizeof(frameName),frameNameTemplate.c_str(),frameIndex);
-		++frameIndex;
 		
 		Images::writeImageFile(frame.getFrameSize()[0],frame.getFrameSize()[1],frame.getBuffer(),frameName);
 		}
@@ -105,14 +113,21 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 ImageSequenceMovieSaver::ImageSequenceMovieSaver(const Misc::ConfigurationFileSection& configFileSection)
 	:MovieSaver(configFileSection),
 	 frameNameTemplate(baseDirectory->getPath(configFileSection.retrieveString("./movieFrameNameTemplate").c_str())),
+	 nextFrameIndex(0),
+	 numFrameSavingThreads(configFileSection.retrieveValue<unsigned int>("./movieNumWriterThreads",2U)),
+	 frameSavingThreads(0),
 	 done(false)
 	{
 	/* Check if the frame name template has the correct format: */
 	if(!Misc::isValidTemplate(frameNameTemplate,'u',1024))
 		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Movie frame name template \"%s\" does not have exactly one %%u conversion",frameNameTemplate.c_str());
 	
-	/* Start the image writing thread: */
-	frameSavingThread.start(this,&ImageSequenceMovieSaver::frameSavingThreadMethod);
+	/* Start the image writing threads; image files are independent and can be written in parallel: */
+	if(numFrameSavingThreads<1U)
+		numFrameSavingThreads=1U;
+	frameSavingThreads=new Threads::Thread[numFrameSavingThreads];
+	for(unsigned int i=0;i<numFrameSavingThreads;++i)
+		frameSavingThreads[i].start(this,&ImageSequenceMovieSaver::frameSavingThreadMethod);
 	}
 
 ImageSequenceMovieSaver::~ImageSequenceMovieSaver(void)
@@ -121,11 +136,22 @@ ImageSequenceMovieSaver::~ImageSequenceMovieSaver(void)
 	stopSound();
 	
 	/* Signal the frame capturing and saving threads to shut down: */
+	{
+	Threads::MutexCond::Lock captureLock(captureCond);
 	done=true;
-	captureCond.signal();
+	captureCond.broadcast();
+	}
+	
+	/* Wait until the frame writing thread notices the shutdown and terminates, so that it does not outlive the frame queue: */
+	if(!frameWritingThread.isJoined())
+		frameWritingThread.join();
+	
+	/* Wait until the frame saving threads have saved all frames and terminate: */
+	for(unsigned int i=0;i<numFrameSavingThreads;++i)
+		frameSavingThreads[i].join();
+	delete[] frameSavingThreads;
 	
-	/* Wait until the frame saving thread has saved all frames and terminates: */
-	frameSavingThread.join();
+	logStatistics("ImageSequenceMovieSaver");
 	}
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageSequenceMovieSaver - Helper class to save movies as sequences of
 image files in formats supported by the Images library.
-Copyright (c) 2010-2015 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -39,7 +39,9 @@ class ImageSequenceMovieSaver:public MovieSaver
 	std::string frameNameTemplate; // Template for creating image file names; must contain exactly one %d placeholder
 	Threads::MutexCond captureCond; // Condition variable to signal that a new frame has been captured and added to the queue
 	std::deque<FrameBuffer> capturedFrames; // Queue of frame buffers selected for writing
-	Threads::Thread frameSavingThread; // Thread to write captured frames to disk; in separate thread to avoid latency issues
+	unsigned int nextFrameIndex; // Index of the next frame to be taken from the queue
+	unsigned int numFrameSavingThreads; // Number of threads writing captured frames to disk in parallel
+	Threads::Thread* frameSavingThreads; // Threads to write captured frames to disk; in separate threads to avoid latency issues
 	volatile bool done; // Flag whether all frames have been captured
 	
 	/* Protected methods from MovieSaver: */
@@ -1,7 +1,7 @@
 /***********************************************************************
 InputDeviceAdapterPlayback - Class to read input device states from a
 pre-recorded file for playback and/or movie generation.
-Copyright (c) 2004-2025 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -28,6 +28,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/PrintfTemplateTests.h>
 #include <Misc/StdError.h>
 #include <Misc/Endianness.h>
@@ -52,18 +53,69 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/TextEventDispatcher.h>
 #include <Vrui/InputGraphManager.h>
 #include <Vrui/Internal/MouseCursorFaker.h>
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
 #include <Vrui/VRWindow.h>
 #include <Vrui/Internal/Vrui.h>
 #include <Vrui/Internal/Config.h>
 
 namespace Vrui {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline double getWallClockTime(void)
+	{
+	Misc::Time rt=Misc::Time::now();
+	return double(rt.tv_sec)+double(rt.tv_nsec)/1000000000.0;
+	}
+
+}
+
 /*******************************************
 Methods of class InputDeviceAdapterPlayback:
 *******************************************/
 
+IO::File& InputDeviceAdapterPlayback::getFrameFile(void)
+	{
+	/* Read from the current chunk in indexed files, and directly from the file otherwise: */
+	if(chunkReader!=0)
+		return chunkReader->getFrameFile();
+	else
+		return *inputDeviceDataFile;
+	}
+
+bool InputDeviceAdapterPlayback::readTimeStamp(double& newTimeStamp)
+	{
+	if(chunkReader!=0)
+		{
+		/* Advance to the next frame in the chunk stream: */
+		if(!chunkReader->nextFrame())
+			return false;
+		newTimeStamp=chunkReader->getFrameFile().read<double>();
+		return true;
+		}
+	else
+		{
+		try
+			{
+			newTimeStamp=inputDeviceDataFile->read<double>();
+			return true;
+			}
+		catch(const IO::File::ReadError&)
+			{
+			/* At end of file: */
+			return false;
+			}
+		}
+	}
+
 void InputDeviceAdapterPlayback::readDeviceStates(void)
 	{
+	IO::File& file=getFrameFile();
+	
 	/* Update all input devices: */
 	for(int deviceIndex=0;deviceIndex<numInputDevices;++deviceIndex)
 		{
@@ -71,7 +123,7 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 		InputDevice* device=inputDevices[deviceIndex];
 		
 		/* Data file version 5 and later contain per-device valid flags: */
-		bool deviceValid=fileVersion>=5?inputDeviceDataFile->read<unsigned char>()!=0U:true;
+		bool deviceValid=fileVersion>=5?file.read<unsigned char>()!=0U:true;
 		
 		if(deviceValid)
 			{
@@ -83,16 +135,16 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 					{
 					/* Read device ray data: */
 					Vector deviceRayDir;
-					inputDeviceDataFile->read(deviceRayDir.getComponents(),3);
-					Scalar deviceRayStart=inputDeviceDataFile->read<Scalar>();
+					file.read(deviceRayDir.getComponents(),3);
+					Scalar deviceRayStart=file.read<Scalar>();
 					device->setDeviceRay(deviceRayDir,deviceRayStart);
 					}
 				
 				/* Read 6-DOF tracker state: */
 				TrackerState::Vector translation;
-				inputDeviceDataFile->read(translation.getComponents(),3);
+				file.read(translation.getComponents(),3);
 				Scalar quat[4];
-				inputDeviceDataFile->read(quat,4);
+				file.read(quat,4);
 				TrackerState::Rotation rotation(quat);
 				if(applyPreTransform)
 					{
@@ -106,8 +158,8 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 					{
 					/* Read velocity data: */
 					Vector linearVelocity,angularVelocity;
-					inputDeviceDataFile->read(linearVelocity.getComponents(),3);
-					inputDeviceDataFile->read(angularVelocity.getComponents(),3);
+					file.read(linearVelocity.getComponents(),3);
+					file.read(angularVelocity.getComponents(),3);
 					
 					/* Set full device tracking state: */
 					device->setTrackingState(TrackerState(translation,rotation),linearVelocity,angularVelocity);
@@ -129,7 +181,7 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 					{
 					if(numBits==0)
 						{
-						buttonBits=inputDeviceDataFile->read<unsigned char>();
+						buttonBits=file.read<unsigned char>();
 						numBits=8;
 						}
 					device->setButtonState(i,(buttonBits&0x80U)!=0x00U);
@@ -142,7 +194,7 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 				/* Read button data as sequence of 32-bit integers (oh my!): */
 				for(int i=0;i<device->getNumButtons();++i)
 					{
-					int buttonState=inputDeviceDataFile->read<int>();
+					int buttonState=file.read<int>();
 					device->setButtonState(i,buttonState);
 					}
 				}
@@ -150,7 +202,7 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 			/* Update valuator states: */
 			for(int i=0;i<device->getNumValuators();++i)
 				{
-				double valuatorState=inputDeviceDataFile->read<double>();
+				double valuatorState=file.read<double>();
 				device->setValuator(i,valuatorState);
 				}
 			}
@@ -170,15 +222,90 @@ void InputDeviceAdapterPlayback::readDeviceStates(void)
 	if(fileVersion>=4)
 		{
 		/* Read and enqueue all text and text control events: */
-		inputDeviceManager->getTextEventDispatcher()->readEventQueues(*inputDeviceDataFile);
+		inputDeviceManager->getTextEventDispatcher()->readEventQueues(file);
+		}
+	}
+
+void InputDeviceAdapterPlayback::skipDeviceStates(bool keepTextEvents)
+	{
+	IO::File& file=getFrameFile();
+	
+	/* Skip the states of all valid input devices: */
+	for(int deviceIndex=0;deviceIndex<numInputDevices;++deviceIndex)
+		{
+		bool deviceValid=fileVersion>=5?file.read<unsigned char>()!=0U:true;
+		if(deviceValid)
+			file.skip<Misc::UInt8>(deviceStateSizes[deviceIndex]);
+		}
+	
+	if(fileVersion>=4)
+		{
+		/* Enqueue or skip all text and text control events: */
+		if(keepTextEvents)
+			inputDeviceManager->getTextEventDispatcher()->readEventQueues(file);
+		else
+			TextEventDispatcher::skipEventQueues(file);
+		}
+	}
+
+void InputDeviceAdapterPlayback::skipToTime(double newTimeStamp,bool keepTextEvents)
+	{
+	/* Skip frames until the next frame is at or after the given time stamp: */
+	while(!done&&nextTimeStamp<newTimeStamp)
+		{
+		timeStamp=nextTimeStamp;
+		skipDeviceStates(keepTextEvents);
+		if(!readTimeStamp(nextTimeStamp))
+			reachedEnd();
+		}
+	}
+
+void InputDeviceAdapterPlayback::jumpToTime(double newTimeStamp)
+	{
+	if(chunkReader!=0&&chunkReader->isSeekable())
+		{
+		/* Bail out if the file does not contain any frames: */
+		if(chunkReader->getNumChunks()==0)
+			{
+			if(!done)
+				reachedEnd();
+			return;
+			}
+		
+		/* Load the last chunk starting at or before the new time stamp: */
+		chunkReader->loadChunk(chunkReader->findChunk(newTimeStamp));
+		done=false;
+		if(!readTimeStamp(nextTimeStamp))
+			reachedEnd();
+		}
+	else if(done||newTimeStamp<nextTimeStamp)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Input device data file does not support seeking backwards");
+	
+	/* Skip all frames before the new time stamp, discarding their text events: */
+	skipToTime(newTimeStamp,false);
+	}
+
+void InputDeviceAdapterPlayback::reachedEnd(void)
+	{
+	done=true;
+	nextTimeStamp=Math::Constants<double>::max;
+	
+	if(quitWhenDone)
+		{
+		/* Request exiting the program: */
+		shutdown();
 		}
 	}
 
 InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInputDeviceManager,const Misc::ConfigurationFileSection& configFileSection)
 	:InputDeviceAdapter(sInputDeviceManager),
+	 chunkReader(0),
 	 applyPreTransform(false),
+	 deviceStateSizes(0),
 	 mouseCursorFaker(0),
 	 synchronizePlayback(configFileSection.retrieveValue("./synchronizePlayback",false)),
+	 playbackSpeed(configFileSection.retrieveValue("./playbackSpeed",1.0)),
+	 dropFrames(configFileSection.retrieveValue("./dropFrames",playbackSpeed>1.0)),
 	 quitWhenDone(configFileSection.retrieveValue("./quitWhenDone",false)),
 	 soundPlayer(0),
 	 saveMovie(configFileSection.retrieveValue("./saveMovie",false)),
@@ -193,12 +320,15 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 	/* Open the common base directory: */
 	IO::DirectoryPtr baseDirectory=IO::openDirectory(configFileSection.retrieveString("./baseDirectory",".").c_str());
 	
+	if(playbackSpeed<=0.0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid playback speed %f",playbackSpeed);
+	
 	/* Open the input device data file: */
 	inputDeviceDataFile=baseDirectory->openFile(configFileSection.retrieveString("./inputDeviceDataFileName").c_str());
 	
 	/* Read file header: */
 	inputDeviceDataFile->setEndianness(Misc::LittleEndian);
-	static const char* fileHeader="Vrui Input Device Data File v7.0\n";
+	static const char* fileHeader="Vrui Input Device Data File v8.0\n";
 	char header[34];
 	inputDeviceDataFile->read(header,34);
 	header[33]='\0';
@@ -241,6 +371,11 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 		/* File version with environment definition: */
 		fileVersion=7;
 		}
+	else if(strcmp(header+29,"8.0\n")==0)
+		{
+		/* File version with indexed and optionally compressed chunks: */
+		fileVersion=8;
+		}
 	else
 		{
 		header[32]='\0';
@@ -261,6 +396,7 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 	numInputDevices=inputDeviceDataFile->read<int>();
 	inputDevices=new InputDevice*[numInputDevices];
 	deviceFeatureBaseIndices=new int[numInputDevices];
+	deviceStateSizes=new size_t[numInputDevices];
 	validFlags=new bool[numInputDevices];
 	
 	/* Initialize devices: */
@@ -333,10 +469,32 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 				}
 			}
 		
+		/* Calculate the size of the device's per-frame state to skip frames: */
+		deviceStateSizes[i]=0;
+		if(trackType!=InputDevice::TRACK_NONE)
+			{
+			/* Device ray, translation, rotation quaternion, and linear and angular velocities: */
+			if(fileVersion>=3)
+				deviceStateSizes[i]+=(3+1+3+4+3+3)*sizeof(Scalar);
+			else
+				deviceStateSizes[i]+=(3+4)*sizeof(Scalar);
+			}
+		if(fileVersion>=3)
+			deviceStateSizes[i]+=(numButtons+7)/8;
+		else
+			deviceStateSizes[i]+=numButtons*sizeof(int);
+		deviceStateSizes[i]+=numValuators*sizeof(double);
+		
 		/* Initialize the device as valid: */
 		validFlags[i]=true;
 		}
 	
+	if(fileVersion>=8)
+		{
+		/* Read the chunk index following the file header if the file is seekable, or prepare to read chunks in order otherwise: */
+		chunkReader=new InputDeviceDataChunkReader(inputDeviceDataFile);
+		}
+	
 	/* Check if the user wants to pre-transform stored device data: */
 	if(configFileSection.hasTag("./preTransform"))
 		{
@@ -362,26 +520,33 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 		}
 	
 	/* Read the initial application time stamp: */
-	try
-		{
-		timeStamp=inputDeviceDataFile->read<double>();
-		synchronize(timeStamp);
-		}
-	catch(const IO::File::ReadError&)
+	bool startAtBeginning=true;
+	if(readTimeStamp(nextTimeStamp))
 		{
-		done=true;
-		nextTimeStamp=Math::Constants<double>::max;
+		/* Check if the user wants to start playback later in the recording: */
+		if(configFileSection.hasTag("./startTime"))
+			{
+			jumpToTime(configFileSection.retrieveValue<double>("./startTime"));
+			startAtBeginning=false;
+			}
 		
-		if(quitWhenDone)
+		if(!done)
 			{
-			/* Request exiting the program: */
-			shutdown();
+			timeStamp=nextTimeStamp;
+			synchronize(timeStamp);
 			}
 		}
+	else
+		reachedEnd();
 	
 	/* Check if the user wants to play back a commentary sound track: */
 	std::string soundFileName=configFileSection.retrieveString("./soundFileName","");
-	if(!soundFileName.empty())
+	if(!soundFileName.empty()&&!startAtBeginning)
+		{
+		/* Print a message, but carry on: */
+		Misc::formattedConsoleWarning("InputDeviceAdapterPlayback: Disabling sound playback because playback does not start at the beginning of the recording");
+		}
+	else if(!soundFileName.empty())
 		{
 		try
 			{
@@ -421,9 +586,11 @@ InputDeviceAdapterPlayback::InputDeviceAdapterPlayback(InputDeviceManager* sInpu
 
 InputDeviceAdapterPlayback::~InputDeviceAdapterPlayback(void)
 	{
+	delete chunkReader;
 	delete mouseCursorFaker;
 	delete soundPlayer;
 	delete[] deviceFeatureBaseIndices;
+	delete[] deviceStateSizes;
 	delete[] validFlags;
 	}
 
@@ -473,10 +640,8 @@ void InputDeviceAdapterPlayback::prepareMainLoop(void)
 	{
 	if(synchronizePlayback)
 		{
-		/* Calculate the offset between the saved timestamps and the system's wall clock time: */
-		Misc::Time rt=Misc::Time::now();
-		double realTime=double(rt.tv_sec)+double(rt.tv_nsec)/1000000000.0;
-		timeStampOffset=nextTimeStamp-realTime;
+		/* Calculate the offset between the saved timestamps and the system's scaled wall clock time: */
+		timeStampOffset=nextTimeStamp-getWallClockTime()*playbackSpeed;
 		}
 	
 	/* Start the sound player, if there is one: */
@@ -503,14 +668,21 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 	if(done)
 		return;
 	
-	timeStamp=nextTimeStamp;
-	
 	if(synchronizePlayback)
 		{
-		/* Check if there is positive drift between the system's offset wall clock time and the next time stamp: */
-		Misc::Time rt=Misc::Time::now();
-		double realTime=double(rt.tv_sec)+double(rt.tv_nsec)/1000000000.0;
-		double delta=nextTimeStamp-(realTime+timeStampOffset);
+		/* Calculate the current playback position in the recording's time sequence: */
+		double playbackTime=getWallClockTime()*playbackSpeed+timeStampOffset;
+		
+		if(dropFrames&&nextTimeStamp<playbackTime)
+			{
+			/* Skip frames to catch up with the recording, but keep their text events: */
+			skipToTime(playbackTime,true);
+			if(done)
+				return;
+			}
+		
+		/* Check if there is positive drift between the playback position and the next time stamp: */
+		double delta=(nextTimeStamp-playbackTime)/playbackSpeed;
 		if(delta>0.0)
 			{
 			/* Block to correct the drift: */
@@ -518,29 +690,20 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 			}
 		}
 	
+	timeStamp=nextTimeStamp;
+	
 	/* Read new device states: */
 	readDeviceStates();
 	
 	/* Read time stamp of next data frame: */
-	try
+	if(readTimeStamp(nextTimeStamp))
 		{
-		nextTimeStamp=inputDeviceDataFile->read<double>();
-		
 		/* Request a synchronized update for the next frame: */
 		synchronize(nextTimeStamp,false);
 		requestUpdate();
 		}
-	catch(const IO::File::ReadError&)
-		{
-		done=true;
-		nextTimeStamp=Math::Constants<double>::max;
-		
-		if(quitWhenDone)
-			{
-			/* Request exiting the program: */
-			shutdown();
-			}
-		}
+	else
+		reachedEnd();
 	
 	if(movieWindow!=0)
 		{
@@ -594,4 +757,37 @@ void InputDeviceAdapterPlayback::updateInputDevices(void)
 		}
 	}
 
+bool InputDeviceAdapterPlayback::canSeekBackwards(void) const
+	{
+	return chunkReader!=0&&chunkReader->isSeekable();
+	}
+
+void InputDeviceAdapterPlayback::seek(double newTimeStamp)
+	{
+	/* Position the input device data file at the new time stamp: */
+	jumpToTime(newTimeStamp);
+	if(done)
+		return;
+	
+	/* Restart synchronized playback and movie frame timing at the new position: */
+	if(synchronizePlayback)
+		timeStampOffset=nextTimeStamp-getWallClockTime()*playbackSpeed;
+	nextMovieFrameTime=nextTimeStamp+movieFrameTimeInterval*0.5;
+	
+	/* Request a synchronized update for the next frame: */
+	synchronize(nextTimeStamp,false);
+	requestUpdate();
+	}
+
+void InputDeviceAdapterPlayback::setPlaybackSpeed(double newPlaybackSpeed)
+	{
+	if(newPlaybackSpeed<=0.0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid playback speed %f",newPlaybackSpeed);
+	
+	/* Adjust the time stamp offset such that the current playback position does not change: */
+	if(synchronizePlayback)
+		timeStampOffset+=getWallClockTime()*(playbackSpeed-newPlaybackSpeed);
+	playbackSpeed=newPlaybackSpeed;
+	}
+
 }
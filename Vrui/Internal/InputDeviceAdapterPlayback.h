@@ -1,7 +1,7 @@
 /***********************************************************************
 InputDeviceAdapterPlayback - Class to read input device states from a
 pre-recorded file for playback and/or movie generation.
-Copyright (c) 2004-2025 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INTERNAL_INPUTDEVICEADAPTERPLAYBACK_INCLUDED
 #define VRUI_INTERNAL_INPUTDEVICEADAPTERPLAYBACK_INCLUDED
 
+#include <stddef.h>
 #include <string>
 #include <vector>
 #include <IO/File.h>
@@ -44,6 +45,7 @@ class SoundPlayer;
 namespace Vrui {
 class MouseCursorFaker;
 class VRWindow;
+class InputDeviceDataChunkReader;
 }
 
 namespace Vrui {
@@ -54,12 +56,16 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 	private:
 	IO::FilePtr inputDeviceDataFile; // File containing the input device data
 	unsigned int fileVersion; // Version of the input device data file
+	InputDeviceDataChunkReader* chunkReader; // Reader for chunks of input device data in file version 8 and later; null for older versions
 	bool applyPreTransform; // Flag whether to transform input device data read from the file
 	OGTransform preTransform; // Upright transformation to apply to input device data read from the file
 	int* deviceFeatureBaseIndices; // Array of base indices in feature name array for each input device
 	std::vector<std::string> deviceFeatureNames; // Array of input device feature names
+	size_t* deviceStateSizes; // Array of sizes of the per-frame states of valid input devices in the input device data file, to skip frames
 	MouseCursorFaker* mouseCursorFaker; // Pointer to object used to render a fake mouse cursor
 	bool synchronizePlayback; // Flag whether to force the Vrui mainloop to run at the speed of the recording; by default, mainloop runs as fast as it can
+	double playbackSpeed; // Ratio of recording time to wall clock time during synchronized playback
+	bool dropFrames; // Flag whether to skip frames during synchronized playback if the mainloop falls behind the recording
 	bool quitWhenDone; // Flag whether to quit the Vrui application when all saved data has been played back
 	Sound::SoundPlayer* soundPlayer; // Pointer to a sound player object used to play back synchronized commentary tracks
 	bool saveMovie; // Flag whether to create a movie by writing screenshots at regular intervals
@@ -70,7 +76,7 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 	int movieFrameStart; // Number of movie frames to skip at the beginning of playback. First frame will always be written with index 0
 	int movieFrameOffset; // Index to assign to the first saved movie frame (after initial frames have been skipped)
 	double timeStamp; // Current time stamp of input device data
-	double timeStampOffset; // Offset from system's wall clock time to input data's time stamp sequence
+	double timeStampOffset; // Offset from system's wall clock time, scaled by the playback speed, to input data's time stamp sequence
 	double nextTimeStamp; // Time stamp of next frame of input device data
 	bool* validFlags; // Array of valid flags for all loaded input devices
 	double nextMovieFrameTime; // Time at which to save the next movie frame
@@ -78,7 +84,13 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 	bool done; // Flag if input file is at end
 	
 	/* Private methods: */
+	IO::File& getFrameFile(void); // Returns the file from which to read the current frame of input device data
+	bool readTimeStamp(double& newTimeStamp); // Reads the time stamp of the next frame of input device data; returns false at the end of the input device data file
 	void readDeviceStates(void); // Reads a set of input device states from the input device data file
+	void skipDeviceStates(bool keepTextEvents); // Skips a set of input device states in the input device data file; enqueues the skipped frame's text events if flag is true
+	void skipToTime(double newTimeStamp,bool keepTextEvents); // Skips all frames whose time stamps are before the given time stamp
+	void jumpToTime(double newTimeStamp); // Positions the input device data file at the first frame at or after the given time stamp, using the chunk index if available
+	void reachedEnd(void); // Handles reaching the end of the input device data file
 	
 	/* Constructors and destructors: */
 	public:
@@ -104,6 +116,13 @@ class InputDeviceAdapterPlayback:public InputDeviceAdapter
 		{
 		return nextTimeStamp;
 		}
+	bool canSeekBackwards(void) const; // Returns true if the input device data file is indexed and supports seeking to arbitrary time stamps
+	void seek(double newTimeStamp); // Continues playback at the first data frame at or after the given time stamp; throws exception when seeking backwards in a file without index
+	double getPlaybackSpeed(void) const // Returns the current playback speed
+		{
+		return playbackSpeed;
+		}
+	void setPlaybackSpeed(double newPlaybackSpeed); // Sets the ratio of recording time to wall clock time during synchronized playback
 	};
 
 }
@@ -0,0 +1,267 @@
+/***********************************************************************
+InputDeviceDataChunkReader - Class to read frames of input device data
+from an indexed sequence of optionally compressed chunks written by
+InputDeviceDataChunkWriter, and to seek to arbitrary time stamps.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
+
+#include <string.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/StdError.h>
+#include <IO/MemoryReader.h>
+#include <IO/GzipFilter.h>
+
+namespace Vrui {
+
+namespace {
+
+/*********************************
+Layout constants of chunk streams:
+*********************************/
+
+const IO::SeekableFile::Offset chunkHeaderSize=4+4+8+1+4+4; // Size of a frame chunk header
+const IO::SeekableFile::Offset indexEntrySize=8+8+4; // Size of an entry in the chunk index
+const IO::SeekableFile::Offset trailerSize=8+4; // Size of the trailer following the chunk index
+
+}
+
+/*******************************************
+Methods of class InputDeviceDataChunkReader:
+*******************************************/
+
+bool InputDeviceDataChunkReader::readStoredIndex(IO::SeekableFile::Offset streamStart)
+	{
+	/* Check if the file is large enough to contain an index: */
+	IO::SeekableFile::Offset fileSize=seekableFile->getSize();
+	if(fileSize<streamStart+8+trailerSize)
+		return false;
+	
+	/* Read the trailer: */
+	seekableFile->setReadPosAbs(fileSize-trailerSize);
+	IO::SeekableFile::Offset indexPos=streamStart+IO::SeekableFile::Offset(seekableFile->read<Misc::UInt64>());
+	char tag[4];
+	seekableFile->read(tag,4);
+	if(memcmp(tag,"IEND",4)!=0||indexPos<streamStart||indexPos>fileSize-trailerSize-8)
+		return false;
+	
+	/* Read the index chunk's header: */
+	seekableFile->setReadPosAbs(indexPos);
+	seekableFile->read(tag,4);
+	if(memcmp(tag,"INDX",4)!=0)
+		return false;
+	IO::SeekableFile::Offset numChunks=seekableFile->read<Misc::UInt32>();
+	if(indexPos+8+numChunks*indexEntrySize+trailerSize!=fileSize)
+		return false;
+	
+	/* Read the chunk index: */
+	chunks.reserve(numChunks);
+	unsigned int numFrames=0;
+	for(IO::SeekableFile::Offset i=0;i<numChunks;++i)
+		{
+		ChunkInfo ci;
+		ci.offset=streamStart+IO::SeekableFile::Offset(seekableFile->read<Misc::UInt64>());
+		ci.firstTimeStamp=seekableFile->read<double>();
+		ci.numFrames=seekableFile->read<Misc::UInt32>();
+		ci.firstFrameIndex=numFrames;
+		numFrames+=ci.numFrames;
+		chunks.push_back(ci);
+		}
+	
+	return true;
+	}
+
+void InputDeviceDataChunkReader::scanChunks(IO::SeekableFile::Offset streamStart)
+	{
+	chunks.clear();
+	
+	/* Read frame chunk headers until the index, the end of the file, or a truncated chunk: */
+	IO::SeekableFile::Offset fileSize=seekableFile->getSize();
+	IO::SeekableFile::Offset chunkPos=streamStart;
+	unsigned int numFrames=0;
+	while(chunkPos+chunkHeaderSize<=fileSize)
+		{
+		/* Read the chunk header: */
+		seekableFile->setReadPosAbs(chunkPos);
+		char tag[4];
+		seekableFile->read(tag,4);
+		if(memcmp(tag,"FRMS",4)!=0)
+			break;
+		ChunkInfo ci;
+		ci.offset=chunkPos;
+		ci.numFrames=seekableFile->read<Misc::UInt32>();
+		ci.firstTimeStamp=seekableFile->read<double>();
+		seekableFile->skip<Misc::UInt8>(1);
+		seekableFile->skip<Misc::UInt32>(1);
+		IO::SeekableFile::Offset storedSize=seekableFile->read<Misc::UInt32>();
+		if(chunkPos+chunkHeaderSize+storedSize>fileSize)
+			break;
+		
+		/* Add the chunk to the index: */
+		ci.firstFrameIndex=numFrames;
+		numFrames+=ci.numFrames;
+		chunks.push_back(ci);
+		
+		/* Go to the next chunk: */
+		chunkPos+=chunkHeaderSize+storedSize;
+		}
+	}
+
+void InputDeviceDataChunkReader::readChunkData(unsigned int chunkIndex,unsigned int numFrames)
+	{
+	/* Read the rest of the chunk header: */
+	file->skip<double>(1);
+	unsigned int compression=file->read<Misc::UInt8>();
+	size_t dataSize=file->read<Misc::UInt32>();
+	size_t storedSize=file->read<Misc::UInt32>();
+	
+	/* Read the chunk's frame data: */
+	if(frameData.size()<dataSize)
+		frameData.resize(dataSize);
+	if(compression==0)
+		{
+		if(storedSize!=dataSize)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Chunk %u is corrupted",chunkIndex);
+		file->read(&frameData[0],dataSize);
+		}
+	else if(compression==1)
+		{
+		/* Read the compressed frame data and decompress it: */
+		if(storedData.size()<storedSize)
+			storedData.resize(storedSize);
+		file->read(&storedData[0],storedSize);
+		IO::FilePtr decompressor=new IO::GzipFilter(new IO::MemoryReader(&storedData[0],storedSize));
+		decompressor->read(&frameData[0],dataSize);
+		}
+	else
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Chunk %u has unsupported compression method %u",chunkIndex,compression);
+	
+	/* Create a reader for the chunk's frame data: */
+	frameFile=new IO::MemoryReader(&frameData[0],dataSize);
+	frameFile->setEndianness(Misc::LittleEndian);
+	nextChunk=size_t(chunkIndex)+1;
+	numFramesLeft=numFrames;
+	}
+
+bool InputDeviceDataChunkReader::readNextChunk(void)
+	{
+	/* Release the reader for the current chunk's frame data: */
+	frameFile=0;
+	numFramesLeft=0;
+	
+	try
+		{
+		/* Read the next chunk header; the chunk stream ends at the chunk index or the end of the file: */
+		char tag[4];
+		file->read(tag,4);
+		if(memcmp(tag,"FRMS",4)!=0)
+			return false;
+		unsigned int numFrames=file->read<Misc::UInt32>();
+		readChunkData((unsigned int)(nextChunk),numFrames);
+		}
+	catch(const IO::File::ReadError&)
+		{
+		/* Treat a chunk truncated by an interrupted recording as the end of the chunk stream: */
+		frameFile=0;
+		numFramesLeft=0;
+		return false;
+		}
+	
+	return true;
+	}
+
+InputDeviceDataChunkReader::InputDeviceDataChunkReader(IO::FilePtr sFile)
+	:file(sFile),seekableFile(file),
+	 haveStoredIndex(false),
+	 nextChunk(0),numFramesLeft(0)
+	{
+	/* Read the chunk index, or reconstruct it if the file does not have one; non-seekable files, such as compressed files, are read in order instead: */
+	if(seekableFile!=0)
+		{
+		IO::SeekableFile::Offset streamStart=seekableFile->getReadPos();
+		haveStoredIndex=readStoredIndex(streamStart);
+		if(!haveStoredIndex)
+			scanChunks(streamStart);
+		}
+	}
+
+InputDeviceDataChunkReader::~InputDeviceDataChunkReader(void)
+	{
+	}
+
+size_t InputDeviceDataChunkReader::findChunk(double timeStamp) const
+	{
+	/* Binary search for the last chunk starting at or before the given time stamp: */
+	size_t l=0;
+	size_t r=chunks.size();
+	while(r-l>1)
+		{
+		size_t m=(l+r)>>1;
+		if(chunks[m].firstTimeStamp<=timeStamp)
+			l=m;
+		else
+			r=m;
+		}
+	
+	return l;
+	}
+
+void InputDeviceDataChunkReader::loadChunk(size_t chunkIndex)
+	{
+	/* Release the reader for the current chunk's frame data: */
+	frameFile=0;
+	numFramesLeft=0;
+	
+	/* Read the chunk header: */
+	if(seekableFile==0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"File does not support seeking");
+	const ChunkInfo& ci=chunks[chunkIndex];
+	seekableFile->setReadPosAbs(ci.offset);
+	char tag[4];
+	file->read(tag,4);
+	if(memcmp(tag,"FRMS",4)!=0)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Chunk %u is corrupted",(unsigned int)(chunkIndex));
+	file->skip<Misc::UInt32>(1);
+	
+	/* Read the chunk's frame data: */
+	readChunkData((unsigned int)(chunkIndex),ci.numFrames);
+	}
+
+bool InputDeviceDataChunkReader::nextFrame(void)
+	{
+	/* Load the next non-empty chunk if the current chunk is exhausted: */
+	while(numFramesLeft==0)
+		{
+		if(seekableFile!=0)
+			{
+			if(nextChunk>=chunks.size())
+				return false;
+			loadChunk(nextChunk);
+			}
+		else if(!readNextChunk())
+			return false;
+		}
+	
+	--numFramesLeft;
+	return true;
+	}
+
+}
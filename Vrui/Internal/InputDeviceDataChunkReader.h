@@ -0,0 +1,109 @@
+/***********************************************************************
+InputDeviceDataChunkReader - Class to read frames of input device data
+from an indexed sequence of optionally compressed chunks written by
+InputDeviceDataChunkWriter, and to seek to arbitrary time stamps.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_INPUTDEVICEDATACHUNKREADER_INCLUDED
+#define VRUI_INTERNAL_INPUTDEVICEDATACHUNKREADER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+
+namespace Vrui {
+
+class InputDeviceDataChunkReader
+	{
+	/* Embedded classes: */
+	public:
+	struct ChunkInfo // Structure describing a frame chunk
+		{
+		/* Elements: */
+		public:
+		IO::SeekableFile::Offset offset; // Absolute position of the chunk's header in the file
+		double firstTimeStamp; // Time stamp of the chunk's first frame
+		unsigned int numFrames; // Number of frames in the chunk
+		unsigned int firstFrameIndex; // Index of the chunk's first frame in the entire stream
+		};
+	
+	/* Elements: */
+	private:
+	IO::FilePtr file; // File from which chunks are read
+	IO::SeekableFilePtr seekableFile; // The same file if it supports seeking; null if chunks can only be read sequentially
+	std::vector<ChunkInfo> chunks; // Index of all frame chunks in the file; empty if the file does not support seeking
+	bool haveStoredIndex; // Flag whether the index was read from the file, or reconstructed by scanning the file
+	std::vector<Misc::UInt8> storedData; // Buffer holding the stored data of the current chunk if it is compressed
+	std::vector<Misc::UInt8> frameData; // Buffer holding the uncompressed frame data of the current chunk
+	IO::FilePtr frameFile; // File to read frame data from the current chunk
+	size_t nextChunk; // Index of the chunk to load when the current chunk is exhausted
+	unsigned int numFramesLeft; // Number of unread frames in the current chunk
+	
+	/* Private methods: */
+	bool readStoredIndex(IO::SeekableFile::Offset streamStart); // Reads the chunk index from the end of the file; returns false if the file has no valid index
+	void scanChunks(IO::SeekableFile::Offset streamStart); // Reconstructs the chunk index by reading all frame chunk headers
+	void readChunkData(unsigned int chunkIndex,unsigned int numFrames); // Reads the data of the chunk whose header tag and frame count have already been read from the file
+	bool readNextChunk(void); // Reads the chunk at the current read position of a non-seekable file; returns false at the end of the chunk stream
+	
+	/* Constructors and destructors: */
+	public:
+	InputDeviceDataChunkReader(IO::FilePtr sFile); // Reads the chunk index of the chunk stream starting at the current read position of the given file if the file is seekable; otherwise, prepares to read the chunks in order
+	private:
+	InputDeviceDataChunkReader(const InputDeviceDataChunkReader& source); // Prohibit copy constructor
+	InputDeviceDataChunkReader& operator=(const InputDeviceDataChunkReader& source); // Prohibit assignment operator
+	public:
+	~InputDeviceDataChunkReader(void);
+	
+	/* Methods: */
+	bool isSeekable(void) const // Returns true if the file supports seeking and the chunk index is available
+		{
+		return seekableFile!=0;
+		}
+	bool hasStoredIndex(void) const // Returns true if the chunk index was read from the file
+		{
+		return haveStoredIndex;
+		}
+	size_t getNumChunks(void) const // Returns the number of frame chunks in the file; returns zero if the file does not support seeking
+		{
+		return chunks.size();
+		}
+	const ChunkInfo& getChunk(size_t chunkIndex) const // Returns the description of the given frame chunk
+		{
+		return chunks[chunkIndex];
+		}
+	unsigned int getNumFrames(void) const // Returns the total number of frames in the file
+		{
+		return chunks.empty()?0:chunks.back().firstFrameIndex+chunks.back().numFrames;
+		}
+	size_t findChunk(double timeStamp) const; // Returns the index of the last chunk starting at or before the given time stamp, or the first chunk
+	void loadChunk(size_t chunkIndex); // Loads the given chunk from a seekable file; the next frame read will be the chunk's first frame
+	bool nextFrame(void); // Prepares reading the next frame, loading the next chunk if necessary; returns false if all frames have been read
+	IO::File& getFrameFile(void) // Returns the file from which to read the current frame's data, starting with its time stamp
+		{
+		return *frameFile;
+		}
+	};
+
+}
+
+#endif
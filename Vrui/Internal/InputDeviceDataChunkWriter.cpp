@@ -0,0 +1,159 @@
+/***********************************************************************
+InputDeviceDataChunkWriter - Class to write frames of input device data
+into an indexed sequence of optionally compressed chunks, to allow
+seeking inside recorded input device data files.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
+
+#include <stdexcept>
+#include <Misc/StdError.h>
+#include <Misc/MessageLogger.h>
+#include <IO/GzipFilter.h>
+
+namespace Vrui {
+
+/*******************************************
+Methods of class InputDeviceDataChunkWriter:
+*******************************************/
+
+void InputDeviceDataChunkWriter::writeChunk(void)
+	{
+	/* Bail out if the current chunk is empty: */
+	if(numChunkFrames==0)
+		return;
+	
+	/* Add the chunk to the index: */
+	IndexEntry ie;
+	ie.offset=streamSize;
+	ie.firstTimeStamp=chunkFirstTimeStamp;
+	ie.numFrames=numChunkFrames;
+	index.push_back(ie);
+	
+	/* Compress the chunk's frame data if requested: */
+	size_t dataSize=chunkData->getDataSize();
+	IO::VariableMemoryFile* storedData=chunkData.getPointer();
+	if(compress)
+		{
+		compressedData->clear();
+		IO::FilePtr compressor=new IO::GzipFilter(compressedData);
+		chunkData->writeToSink(*compressor);
+		compressor=0; // Destroying the filter flushes the compressor
+		storedData=compressedData.getPointer();
+		}
+	size_t storedSize=storedData->getDataSize();
+	
+	/* Write the chunk header: */
+	file->write("FRMS",4);
+	file->write(Misc::UInt32(numChunkFrames));
+	file->write(chunkFirstTimeStamp);
+	file->write(Misc::UInt8(compress?1:0));
+	file->write(Misc::UInt32(dataSize));
+	file->write(Misc::UInt32(storedSize));
+	
+	/* Write the chunk's frame data: */
+	storedData->writeToSink(*file);
+	streamSize+=4+4+8+1+4+4+storedSize;
+	
+	/* Start a new chunk: */
+	chunkData->clear();
+	numChunkFrames=0;
+	}
+
+InputDeviceDataChunkWriter::InputDeviceDataChunkWriter(IO::FilePtr sFile,unsigned int sMaxChunkFrames,double sMaxChunkDuration,bool sCompress)
+	:file(sFile),
+	 maxChunkFrames(sMaxChunkFrames>0?sMaxChunkFrames:1),maxChunkDuration(sMaxChunkDuration),compress(sCompress),
+	 chunkData(new IO::VariableMemoryFile),compressedData(compress?new IO::VariableMemoryFile:0),
+	 numChunkFrames(0),chunkFirstTimeStamp(0.0),lastTimeStamp(0.0),
+	 streamSize(0),
+	 closed(false)
+	{
+	/* Write frame data in the same byte order as the file: */
+	chunkData->setEndianness(Misc::LittleEndian);
+	}
+
+InputDeviceDataChunkWriter::~InputDeviceDataChunkWriter(void)
+	{
+	if(!closed)
+		{
+		try
+			{
+			close();
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Print a message, but carry on: */
+			Misc::formattedConsoleWarning("Vrui::InputDeviceDataChunkWriter: Unable to write chunk index due to exception %s",err.what());
+			}
+		}
+	}
+
+IO::File& InputDeviceDataChunkWriter::startFrame(double timeStamp)
+	{
+	if(closed)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Chunk stream is already closed");
+	
+	/* Remember the first time stamp of a new chunk: */
+	if(numChunkFrames==0)
+		chunkFirstTimeStamp=timeStamp;
+	lastTimeStamp=timeStamp;
+	
+	/* Write the frame's time stamp: */
+	chunkData->write(timeStamp);
+	
+	return *chunkData;
+	}
+
+void InputDeviceDataChunkWriter::finishFrame(void)
+	{
+	/* Write the current chunk if it is full: */
+	++numChunkFrames;
+	if(numChunkFrames>=maxChunkFrames||lastTimeStamp-chunkFirstTimeStamp>=maxChunkDuration)
+		writeChunk();
+	}
+
+void InputDeviceDataChunkWriter::close(void)
+	{
+	if(closed)
+		return;
+	closed=true;
+	
+	/* Write the last partial chunk: */
+	writeChunk();
+	
+	/* Write the chunk index: */
+	Misc::UInt64 indexOffset=streamSize;
+	file->write("INDX",4);
+	file->write(Misc::UInt32(index.size()));
+	for(std::vector<IndexEntry>::iterator iIt=index.begin();iIt!=index.end();++iIt)
+		{
+		file->write(iIt->offset);
+		file->write(iIt->firstTimeStamp);
+		file->write(iIt->numFrames);
+		}
+	
+	/* Write the trailer: */
+	file->write(indexOffset);
+	file->write("IEND",4);
+	file->flush();
+	}
+
+}
@@ -0,0 +1,112 @@
+/***********************************************************************
+InputDeviceDataChunkWriter - Class to write frames of input device data
+into an indexed sequence of optionally compressed chunks, to allow
+seeking inside recorded input device data files.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+/***********************************************************************
+Layout of a chunk stream (all values are little-endian):
+
+Frame chunk:
+  char[4]  "FRMS"
+  UInt32   Number of frames in the chunk
+  Float64  Time stamp of the chunk's first frame
+  UInt8    Compression method (0: none, 1: gzip)
+  UInt32   Size of the uncompressed frame data
+  UInt32   Size of the stored frame data following the chunk header
+  Byte[]   Stored frame data
+
+Index chunk (follows the last frame chunk):
+  char[4]  "INDX"
+  UInt32   Number of frame chunks
+  For each frame chunk:
+    UInt64  Offset of the frame chunk from the beginning of the stream
+    Float64 Time stamp of the frame chunk's first frame
+    UInt32  Number of frames in the frame chunk
+
+Trailer:
+  UInt64   Offset of the index chunk from the beginning of the stream
+  char[4]  "IEND"
+
+Each frame stores the complete state of all input devices, meaning that
+each chunk can be decoded independently of all preceding chunks. If a
+recording is interrupted before the index is written, the index can be
+reconstructed by scanning the frame chunk headers.
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_INPUTDEVICEDATACHUNKWRITER_INCLUDED
+#define VRUI_INTERNAL_INPUTDEVICEDATACHUNKWRITER_INCLUDED
+
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <IO/VariableMemoryFile.h>
+
+namespace Vrui {
+
+class InputDeviceDataChunkWriter
+	{
+	/* Embedded classes: */
+	private:
+	struct IndexEntry // Structure describing a written frame chunk
+		{
+		/* Elements: */
+		public:
+		Misc::UInt64 offset; // Offset of the chunk's header from the beginning of the chunk stream
+		double firstTimeStamp; // Time stamp of the chunk's first frame
+		Misc::UInt32 numFrames; // Number of frames in the chunk
+		};
+	
+	/* Elements: */
+	IO::FilePtr file; // File to which chunks are written
+	unsigned int maxChunkFrames; // Maximum number of frames in a chunk
+	double maxChunkDuration; // Maximum time span covered by a chunk
+	bool compress; // Flag whether to compress chunk data
+	IO::VariableMemoryFilePtr chunkData; // Buffer collecting the uncompressed frame data of the current chunk
+	IO::VariableMemoryFilePtr compressedData; // Buffer holding the compressed frame data of the current chunk
+	unsigned int numChunkFrames; // Number of frames in the current chunk
+	double chunkFirstTimeStamp; // Time stamp of the current chunk's first frame
+	double lastTimeStamp; // Time stamp of the most recently started frame
+	Misc::UInt64 streamSize; // Number of bytes written to the chunk stream so far
+	std::vector<IndexEntry> index; // Index of all chunks written so far
+	bool closed; // Flag whether the chunk stream has been closed
+	
+	/* Private methods: */
+	void writeChunk(void); // Writes the current chunk to the file
+	
+	/* Constructors and destructors: */
+	public:
+	InputDeviceDataChunkWriter(IO::FilePtr sFile,unsigned int sMaxChunkFrames,double sMaxChunkDuration,bool sCompress); // Creates a chunk stream at the current write position of the given file
+	private:
+	InputDeviceDataChunkWriter(const InputDeviceDataChunkWriter& source); // Prohibit copy constructor
+	InputDeviceDataChunkWriter& operator=(const InputDeviceDataChunkWriter& source); // Prohibit assignment operator
+	public:
+	~InputDeviceDataChunkWriter(void); // Closes the chunk stream if it has not been closed yet
+	
+	/* Methods: */
+	IO::File& startFrame(double timeStamp); // Starts a new frame with the given time stamp; returns file to which to write the rest of the frame's data
+	void finishFrame(void); // Finishes the current frame; writes the current chunk if it is full
+	void close(void); // Writes the current chunk, the chunk index, and the trailer
+	};
+
+}
+
+#endif
@@ -1,7 +1,7 @@
 /***********************************************************************
 InputDeviceDataSaver - Class to save input device data to a file for
 later playback.
-Copyright (c) 2004-2025 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -44,6 +44,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/InputDeviceFeature.h>
 #include <Vrui/InputDeviceManager.h>
 #include <Vrui/TextEventDispatcher.h>
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
 #ifdef VRUI_INPUTDEVICEDATASAVER_USE_KINECT
 #include <Vrui/Internal/KinectRecorder.h>
 #endif
@@ -66,7 +67,8 @@ void InputDeviceDataSaver::inputDeviceStateChangeCallback(InputGraphManager::Inp
 	}
 
 InputDeviceDataSaver::InputDeviceDataSaver(const Misc::ConfigurationFileSection& configFileSection,InputDeviceManager& inputDeviceManager,TextEventDispatcher* sTextEventDispatcher,unsigned int randomSeed)
-	:numInputDevices(inputDeviceManager.getNumInputDevices()),
+	:chunkWriter(0),
+	 numInputDevices(inputDeviceManager.getNumInputDevices()),
 	 inputDevices(new InputDevice*[numInputDevices]),validFlags(new bool[numInputDevices]),
 	 textEventDispatcher(sTextEventDispatcher),
 	 soundRecorder(0)
@@ -82,7 +84,7 @@ InputDeviceDataSaver::InputDeviceDataSaver(const Misc::ConfigurationFileSection&
 	
 	/* Write a file identification header: */
 	inputDeviceDataFile->setEndianness(Misc::LittleEndian);
-	static const char* fileHeader="Vrui Input Device Data File v7.0\n";
+	static const char* fileHeader="Vrui Input Device Data File v8.0\n";
 	inputDeviceDataFile->write(fileHeader,34);
 	
 	/* Save the random number seed: */
@@ -122,6 +124,12 @@ InputDeviceDataSaver::InputDeviceDataSaver(const Misc::ConfigurationFileSection&
 		validFlags[i]=true;
 		}
 	
+	/* Save all following frames as a stream of indexed chunks: */
+	unsigned int maxChunkFrames=configFileSection.retrieveValue<unsigned int>("./maxChunkFrames",1024);
+	double maxChunkDuration=configFileSection.retrieveValue<double>("./maxChunkDuration",1.0);
+	bool compressChunks=configFileSection.retrieveValue<bool>("./compressChunks",false);
+	chunkWriter=new InputDeviceDataChunkWriter(inputDeviceDataFile,maxChunkFrames,maxChunkDuration,compressChunks);
+	
 	/* Register a callback with the input graph manager: */
 	getInputGraphManager()->getInputDeviceStateChangeCallbacks().add(this,&InputDeviceDataSaver::inputDeviceStateChangeCallback);
 	
@@ -166,6 +174,9 @@ InputDeviceDataSaver::~InputDeviceDataSaver(void)
 	/* Log the total recording time as a convenience: */
 	Misc::formattedLogNote("Vrui::InputDeviceDataSaver: Total recording time: %fs",getApplicationTime());
 	
+	/* Write the last chunk of input device data and the chunk index: */
+	delete chunkWriter;
+	
 	/* Shut down recording: */
 	delete[] inputDevices;
 	delete[] validFlags;
@@ -196,8 +207,8 @@ void InputDeviceDataSaver::prepareMainLoop(void)
 
 void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 	{
-	/* Write current time stamp: */
-	inputDeviceDataFile->write(currentTimeStamp);
+	/* Start a new frame with the current time stamp: */
+	IO::File& frame=chunkWriter->startFrame(currentTimeStamp);
 	
 	/* Write state of all input devices: */
 	for(int i=0;i<numInputDevices;++i)
@@ -206,18 +217,18 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 		if(validFlags[i])
 			{
 			/* Write valid flag: */
-			inputDeviceDataFile->write<unsigned char>(1);
+			frame.write<unsigned char>(1);
 			
 			/* Write input device's tracker state: */
 			if(inputDevices[i]->getTrackType()!=InputDevice::TRACK_NONE)
 				{
-				inputDeviceDataFile->write(inputDevices[i]->getDeviceRayDirection().getComponents(),3);
-				inputDeviceDataFile->write(inputDevices[i]->getDeviceRayStart());
+				frame.write(inputDevices[i]->getDeviceRayDirection().getComponents(),3);
+				frame.write(inputDevices[i]->getDeviceRayStart());
 				const TrackerState& t=inputDevices[i]->getTransformation();
-				inputDeviceDataFile->write(t.getTranslation().getComponents(),3);
-				inputDeviceDataFile->write(t.getRotation().getQuaternion(),4);
-				inputDeviceDataFile->write(inputDevices[i]->getLinearVelocity().getComponents(),3);
-				inputDeviceDataFile->write(inputDevices[i]->getAngularVelocity().getComponents(),3);
+				frame.write(t.getTranslation().getComponents(),3);
+				frame.write(t.getRotation().getQuaternion(),4);
+				frame.write(inputDevices[i]->getLinearVelocity().getComponents(),3);
+				frame.write(inputDevices[i]->getAngularVelocity().getComponents(),3);
 				}
 			
 			/* Write input device's button states: */
@@ -230,7 +241,7 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 					buttonBits|=0x01U;
 				if(++numBits==8)
 					{
-					inputDeviceDataFile->write(buttonBits);
+					frame.write(buttonBits);
 					buttonBits=0x00U;
 					numBits=0;
 					}
@@ -238,26 +249,29 @@ void InputDeviceDataSaver::saveCurrentState(double currentTimeStamp)
 			if(numBits!=0)
 				{
 				buttonBits<<=8-numBits;
-				inputDeviceDataFile->write(buttonBits);
+				frame.write(buttonBits);
 				}
 			
 			/* Write input device's valuator states: */
 			for(int j=0;j<inputDevices[i]->getNumValuators();++j)
 				{
 				double valuatorState=inputDevices[i]->getValuator(j);
-				inputDeviceDataFile->write(valuatorState);
+				frame.write(valuatorState);
 				}
 			}
 		else
 			{
 			/* Write valid flag: */
-			inputDeviceDataFile->write<unsigned char>(0);
+			frame.write<unsigned char>(0);
 			}
 		
 		}
 	
 	/* Write all enqueued text and text control events: */
-	textEventDispatcher->writeEventQueues(*inputDeviceDataFile);
+	textEventDispatcher->writeEventQueues(frame);
+	
+	/* Finish the frame: */
+	chunkWriter->finishFrame();
 	}
 
 }
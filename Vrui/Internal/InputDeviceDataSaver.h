@@ -1,7 +1,7 @@
 /***********************************************************************
 InputDeviceDataSaver - Class to save input device data to a file for
 later playback.
-Copyright (c) 2004-2018 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -39,6 +39,7 @@ namespace Vrui {
 class InputDevice;
 class InputDeviceManager;
 class TextEventDispatcher;
+class InputDeviceDataChunkWriter;
 #ifdef VRUI_INPUTDEVICEDATASAVER_USE_KINECT
 class KinectRecorder;
 #endif
@@ -51,6 +52,7 @@ class InputDeviceDataSaver
 	/* Elements: */
 	private:
 	IO::FilePtr inputDeviceDataFile; // File input device data is saved to
+	InputDeviceDataChunkWriter* chunkWriter; // Writer to save frames of input device data as indexed chunks
 	int numInputDevices; // Number of saved (physical) input devices
 	InputDevice** inputDevices; // Array of pointers to saved input devices
 	bool* validFlags; // Array of flags indicating whether a saved input device is enabled
@@ -1,7 +1,7 @@
 /***********************************************************************
 MovieSaver - Helper class to save movies, as sequences of frames or
 already encoded into a video container format, from VR windows.
-Copyright (c) 2010-2022 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -25,6 +25,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Video/Config.h>
 
+#include <string.h>
 #include <Misc/MessageLogger.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
@@ -32,6 +33,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <IO/OpenFile.h>
 #include <Sound/SoundDataFormat.h>
 #include <Sound/SoundRecorder.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/Extensions/GLARBPixelBufferObject.h>
 #include <Vrui/Internal/ImageSequenceMovieSaver.h>
 #if VIDEO_CONFIG_HAVE_THEORA
 #include <Vrui/Internal/TheoraMovieSaver.h>
@@ -39,17 +42,32 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Vrui {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+unsigned char* allocateImageData(size_t imageDataSize) // Allocates a reference-counted image data buffer of the given size
+	{
+	unsigned int* allocBuffer=new unsigned int[1+(imageDataSize+sizeof(unsigned int)-1)/sizeof(unsigned int)];
+	allocBuffer[0]=1;
+	return reinterpret_cast<unsigned char*>(allocBuffer+1);
+	}
+
+}
+
 /****************************************
 Methods of class MovieSaver::FrameBuffer:
 ****************************************/
 
 MovieSaver::FrameBuffer::FrameBuffer(void)
-	:frameSize(0,0),buffer(0)
+	:frameSize(0,0),numChannels(3),buffer(0)
 	{
 	}
 
 MovieSaver::FrameBuffer::FrameBuffer(const MovieSaver::FrameBuffer& source)
-	:frameSize(source.frameSize),buffer(source.buffer)
+	:frameSize(source.frameSize),numChannels(source.numChannels),buffer(source.buffer)
 	{
 	/* Reference the source image data: */
 	ref();
@@ -64,6 +82,7 @@ MovieSaver::FrameBuffer& MovieSaver::FrameBuffer::operator=(const MovieSaver::Fr
 		
 		/* Update the frame size and reference the source image data: */
 		frameSize=source.frameSize;
+		numChannels=source.numChannels;
 		buffer=source.buffer;
 		ref();
 		}
@@ -77,18 +96,17 @@ MovieSaver::FrameBuffer::~FrameBuffer(void)
 	unref();
 	}
 
-void MovieSaver::FrameBuffer::setFrameSize(const ISize& newFrameSize)
+void MovieSaver::FrameBuffer::setFrameSize(const ISize& newFrameSize,int newNumChannels)
 	{
-	if(frameSize!=newFrameSize)
+	if(frameSize!=newFrameSize||numChannels!=newNumChannels)
 		{
 		/* Release the current image data: */
 		unref();
 		
 		/* Update the frame size and allocate new image data: */
 		frameSize=newFrameSize;
-		unsigned int* allocBuffer=new unsigned int[(frameSize.volume()*3+sizeof(unsigned int)-1)/sizeof(unsigned int)];
-		allocBuffer[0]=1;
-		buffer=reinterpret_cast<unsigned char*>(allocBuffer+1);
+		numChannels=newNumChannels;
+		buffer=allocateImageData(frameSize.volume()*numChannels);
 		}
 	}
 
@@ -103,10 +121,30 @@ void MovieSaver::FrameBuffer::prepareWrite(void)
 			unref();
 			
 			/* Allocate new image data: */
-			unsigned int* allocBuffer=new unsigned int[(frameSize.volume()*3+sizeof(unsigned int)-1)/sizeof(unsigned int)];
-			allocBuffer[0]=1;
-			buffer=reinterpret_cast<unsigned char*>(allocBuffer+1);
+			buffer=allocateImageData(frameSize.volume()*numChannels);
+			}
+		}
+	}
+
+void MovieSaver::FrameBuffer::convertToRGB(void)
+	{
+	if(buffer!=0&&numChannels==4)
+		{
+		/* Drop the alpha channel while copying the image data into a new buffer: */
+		unsigned char* rgbBuffer=allocateImageData(frameSize.volume()*3);
+		const unsigned char* sPtr=buffer;
+		unsigned char* dPtr=rgbBuffer;
+		for(size_t i=frameSize.volume();i>0;--i,sPtr+=4,dPtr+=3)
+			{
+			dPtr[0]=sPtr[0];
+			dPtr[1]=sPtr[1];
+			dPtr[2]=sPtr[2];
 			}
+		
+		/* Replace the current image data: */
+		unref();
+		numChannels=3;
+		buffer=rgbBuffer;
 		}
 	}
 
@@ -121,6 +159,84 @@ void* MovieSaver::frameWritingThreadWrapper(void)
 	return 0;
 	}
 
+void MovieSaver::initReadback(void)
+	{
+	/* Read back asynchronously if requested and the current OpenGL context supports pixel buffer objects and fences: */
+	asyncReadback=readbackDepth>0U&&GLARBPixelBufferObject::isSupported()&&GLARBSync::isSupported();
+	if(asyncReadback)
+		{
+		/* Initialize the required extensions: */
+		GLARBPixelBufferObject::initExtension();
+		GLARBSync::initExtension();
+		
+		/* Create the ring of readback slots: */
+		readbackSlots=new ReadbackSlot[readbackDepth];
+		for(unsigned int i=0;i<readbackDepth;++i)
+			{
+			glGenBuffersARB(1,&readbackSlots[i].bufferId);
+			readbackSlots[i].frameSize=ISize(0,0);
+			readbackSlots[i].fence=0;
+			}
+		nextReadbackSlot=0;
+		}
+	
+	readbackInitialized=true;
+	}
+
+void MovieSaver::retrieveReadbacks(bool waitForOldest)
+	{
+	/*********************************************************************
+	Find the most recent completed readback. Readbacks complete in the
+	order in which they were issued, so the search can stop at the first
+	pending readback:
+	*********************************************************************/
+	
+	unsigned int numRetrieved=0;
+	for(unsigned int i=0;i<readbackDepth;++i)
+		{
+		ReadbackSlot& slot=readbackSlots[(nextReadbackSlot+i)%readbackDepth];
+		if(slot.fence==0)
+			continue;
+		
+		/* Check if the readback is complete, and wait for the oldest one if requested: */
+		bool wait=waitForOldest&&numRetrieved==0;
+		GLenum result=glClientWaitSync(slot.fence,wait?GL_SYNC_FLUSH_COMMANDS_BIT:0x0,wait?~GLuint64(0):GLuint64(0));
+		if(result!=GL_ALREADY_SIGNALED&&result!=GL_CONDITION_SATISFIED)
+			break;
+		++numRetrieved;
+		}
+	
+	/* Release all completed readbacks, and post only the most recent one as older ones would be replaced immediately: */
+	unsigned int slotIndex=nextReadbackSlot;
+	for(;numRetrieved>0;slotIndex=(slotIndex+1)%readbackDepth)
+		{
+		ReadbackSlot& slot=readbackSlots[slotIndex];
+		if(slot.fence==0)
+			continue;
+		glDeleteSync(slot.fence);
+		slot.fence=0;
+		if(--numRetrieved==0)
+			{
+			/* Copy the pixel buffer's contents into a new frame: */
+			FrameBuffer& frame=startNewFrame();
+			frame.setFrameSize(slot.frameSize,4);
+			frame.prepareWrite();
+			glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,slot.bufferId);
+			const void* pixels=glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB,GL_READ_ONLY_ARB);
+			if(pixels!=0)
+				{
+				memcpy(frame.getBuffer(),pixels,slot.frameSize.volume()*4);
+				glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+				}
+			glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,0);
+			
+			/* Post the new frame: */
+			if(pixels!=0)
+				postNewFrame();
+			}
+		}
+	}
+
 int MovieSaver::waitForNextFrame(void)
 	{
 	/* Check for skipped frames: */
@@ -137,9 +253,37 @@ int MovieSaver::waitForNextFrame(void)
 	Misc::sleep(nextFrameTime-t);
 	nextFrameTime+=frameInterval;
 	
+	if(numSkippedFrames>0)
+		{
+		/* Count the skipped frames as dropped: */
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numDroppedFrames+=numSkippedFrames;
+		}
+	
 	return numSkippedFrames;
 	}
 
+void MovieSaver::frameQueued(size_t newQueueDepth)
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	++statistics.numCapturedFrames;
+	statistics.queueDepth=newQueueDepth;
+	if(statistics.maxQueueDepth<newQueueDepth)
+		statistics.maxQueueDepth=newQueueDepth;
+	}
+
+void MovieSaver::frameDequeued(size_t newQueueDepth)
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	statistics.queueDepth=newQueueDepth;
+	}
+
+void MovieSaver::logStatistics(const char* saverName) const
+	{
+	Statistics stats=getStatistics();
+	Misc::formattedLogNote("%s: Captured %u frames, dropped %u frames, maximum queue depth %u frames",saverName,stats.numCapturedFrames,stats.numDroppedFrames,(unsigned int)(stats.maxQueueDepth));
+	}
+
 void MovieSaver::stopSound(void)
 	{
 	/* Delete the sound recorder: */
@@ -152,8 +296,17 @@ MovieSaver::MovieSaver(const Misc::ConfigurationFileSection& configFileSection)
 	 frameRate(configFileSection.retrieveValue("./movieFrameRate",30.0)),
 	 frameInterval(1.0/frameRate),
 	 soundRecorder(0),
-	 firstFrame(true)
+	 firstFrame(true),
+	 readbackDepth(configFileSection.retrieveValue<unsigned int>("./movieReadbackDepth",3U)),
+	 readbackInitialized(false),asyncReadback(false),
+	 readbackSlots(0),nextReadbackSlot(0)
 	{
+	/* Initialize the capture statistics: */
+	statistics.numCapturedFrames=0;
+	statistics.numDroppedFrames=0;
+	statistics.queueDepth=0;
+	statistics.maxQueueDepth=0;
+	
 	/* Check if the user wants to record a commentary track: */
 	std::string soundFileName=configFileSection.retrieveString("./movieSoundFileName","");
 	if(!soundFileName.empty())
@@ -190,6 +343,9 @@ MovieSaver::~MovieSaver(void)
 		frameWritingThread.cancel();
 		frameWritingThread.join();
 		}
+	
+	/* Delete the readback slots if their OpenGL state was not released: */
+	delete[] readbackSlots;
 	}
 
 MovieSaver* MovieSaver::createMovieSaver(const Misc::ConfigurationFileSection& configFileSection)
@@ -237,4 +393,76 @@ void MovieSaver::postNewFrame(void)
 		}
 	}
 
+void MovieSaver::captureFrame(const ISize& frameSize)
+	{
+	/* Initialize readback state on the first call: */
+	if(!readbackInitialized)
+		initReadback();
+	
+	glPixelStorei(GL_PACK_ALIGNMENT,1);
+	glPixelStorei(GL_PACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_PACK_ROW_LENGTH,0);
+	glPixelStorei(GL_PACK_SKIP_ROWS,0);
+	
+	if(asyncReadback)
+		{
+		/* Post the most recent completed readback: */
+		retrieveReadbacks(false);
+		
+		/* Wait for the oldest readback if all slots are pending: */
+		ReadbackSlot& slot=readbackSlots[nextReadbackSlot];
+		if(slot.fence!=0)
+			retrieveReadbacks(true);
+		
+		/* Start reading the frame into the slot's pixel buffer in the framebuffer's native RGBA format: */
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,slot.bufferId);
+		if(slot.frameSize!=frameSize)
+			{
+			glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB,frameSize.volume()*4,0,GL_STREAM_READ_ARB);
+			slot.frameSize=frameSize;
+			}
+		glReadPixels(0,0,frameSize[0],frameSize[1],GL_RGBA,GL_UNSIGNED_BYTE,0);
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,0);
+		slot.fence=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0x0);
+		nextReadbackSlot=(nextReadbackSlot+1)%readbackDepth;
+		}
+	else
+		{
+		/* Read the frame directly into a new frame buffer: */
+		FrameBuffer& frame=startNewFrame();
+		frame.setFrameSize(frameSize);
+		frame.prepareWrite();
+		glReadPixels(0,0,frameSize[0],frameSize[1],GL_RGB,GL_UNSIGNED_BYTE,frame.getBuffer());
+		
+		/* Post the new frame: */
+		postNewFrame();
+		}
+	}
+
+void MovieSaver::releaseGLState(void)
+	{
+	if(asyncReadback)
+		{
+		/* Retrieve all pending readbacks: */
+		while(readbackSlots[(nextReadbackSlot+readbackDepth-1)%readbackDepth].fence!=0)
+			retrieveReadbacks(true);
+		
+		/* Delete the pixel buffers and the readback slots: */
+		for(unsigned int i=0;i<readbackDepth;++i)
+			glDeleteBuffersARB(1,&readbackSlots[i].bufferId);
+		delete[] readbackSlots;
+		readbackSlots=0;
+		asyncReadback=false;
+		}
+	
+	/* Re-initialize readback state if another frame is captured: */
+	readbackInitialized=false;
+	}
+
+MovieSaver::Statistics MovieSaver::getStatistics(void) const
+	{
+	Threads::Mutex::Lock statisticsLock(statisticsMutex);
+	return statistics;
+	}
+
 }
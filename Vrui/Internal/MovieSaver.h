@@ -1,7 +1,7 @@
 /***********************************************************************
 MovieSaver - Helper class to save movies, as sequences of frames or
 already encoded into a video container format, from VR windows.
-Copyright (c) 2010-2022 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -24,12 +24,16 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INTERNAL_MOVIESAVER_INCLUDED
 #define VRUI_INTERNAL_MOVIESAVER_INCLUDED
 
+#include <stddef.h>
 #include <string>
 #include <Misc/Size.h>
 #include <Misc/Time.h>
 #include <IO/Directory.h>
+#include <Threads/Mutex.h>
 #include <Threads/Thread.h>
 #include <Threads/TripleBuffer.h>
+#include <GL/gl.h>
+#include <GL/Extensions/GLARBSync.h>
 #include <Vrui/Vrui.h>
 
 /* Forward declarations: */
@@ -51,6 +55,7 @@ class MovieSaver
 		/* Elements: */
 		private:
 		ISize frameSize; // The frame's width and height
+		int numChannels; // Number of color channels per pixel; 3 for RGB or 4 for RGBA
 		unsigned char* buffer; // Pointer to the frame's image data
 		
 		/* Private methods: */
@@ -73,12 +78,17 @@ class MovieSaver
 		~FrameBuffer(void); // Destroys the frame buffer
 		
 		/* Methods: */
-		void setFrameSize(const ISize& newFrameSize); // Changes the frame's size
+		void setFrameSize(const ISize& newFrameSize,int newNumChannels =3); // Changes the frame's size and number of color channels
 		void prepareWrite(void); // Prepares for writing into the frame buffer by ensuring that the image data are not shared by another frame buffer
+		void convertToRGB(void); // Converts the frame's image data to RGB if they are RGBA, without affecting other frame buffers sharing the same image data
 		const ISize& getFrameSize(void) const // Returns the frame's size
 			{
 			return frameSize;
 			}
+		int getNumChannels(void) const // Returns the number of color channels per pixel
+			{
+			return numChannels;
+			}
 		const unsigned char* getBuffer(void) const // Returns the buffer for reading
 			{
 			return buffer;
@@ -89,6 +99,26 @@ class MovieSaver
 			}
 		};
 	
+	struct Statistics // Structure reporting the state of a movie saver's capture pipeline
+		{
+		/* Elements: */
+		public:
+		unsigned int numCapturedFrames; // Number of frames that were queued for writing
+		unsigned int numDroppedFrames; // Number of frames that were skipped because the frame writing thread fell behind
+		size_t queueDepth; // Current number of frames queued for writing
+		size_t maxQueueDepth; // Maximum number of frames that were queued for writing at any time
+		};
+	
+	private:
+	struct ReadbackSlot // Structure for a pixel buffer receiving an asynchronous frame readback
+		{
+		/* Elements: */
+		public:
+		GLuint bufferId; // ID of the pixel buffer object
+		ISize frameSize; // Size of the frame for which the pixel buffer's storage was allocated
+		GLsync fence; // Fence to signal completion of the readback, or null if the slot is idle
+		};
+	
 	/* Elements: */
 	protected:
 	IO::DirectoryPtr baseDirectory; // Base directory where recorded data is saved
@@ -99,13 +129,26 @@ class MovieSaver
 	Sound::SoundRecorder* soundRecorder; // Pointer to a sound recorder if sound recording was started
 	Misc::Time nextFrameTime; // Time point at which the next frame needs to be written
 	bool firstFrame; // Flag to indicate the first saved frame
+	private:
+	unsigned int readbackDepth; // Number of frames that can be read back asynchronously at the same time; 0 disables asynchronous readback
+	bool readbackInitialized; // Flag whether the readback state has been initialized in the capturing OpenGL context
+	bool asyncReadback; // Flag whether frames are read back asynchronously via pixel buffer objects
+	ReadbackSlot* readbackSlots; // Ring of pixel buffers for asynchronous readback
+	unsigned int nextReadbackSlot; // Index of the ring slot to receive the next readback; also the oldest pending readback if the ring is full
+	mutable Threads::Mutex statisticsMutex; // Mutex serializing access to the capture statistics
+	Statistics statistics; // Current capture statistics
 	
 	/* Private methods: */
 	void* frameWritingThreadWrapper(void);
+	void initReadback(void); // Initializes readback state in the current OpenGL context
+	void retrieveReadbacks(bool waitForOldest); // Posts the most recent completed readback and releases all older ones; waits for the oldest pending readback if flag is true
 	
 	/* Protected methods: */
 	protected:
-	int waitForNextFrame(void); // Suspends the caller until the next frame is due to be written; skips frames if caller lags; returns number of skipped frames
+	int waitForNextFrame(void); // Suspends the caller until the next frame is due to be written; skips frames if caller lags; returns number of skipped frames and counts them as dropped
+	void frameQueued(size_t newQueueDepth); // Updates statistics after a frame has been queued for writing, given the new depth of the queue
+	void frameDequeued(size_t newQueueDepth); // Updates statistics after a frame has been removed from the queue for writing, given the new depth of the queue
+	void logStatistics(const char* saverName) const; // Writes final capture statistics to the log
 	virtual void frameWritingThreadMethod(void) =0; // Runs in background and writes movie frames at fixed intervals
 	void stopSound(void); // Immediately stops recording sound
 	
@@ -121,6 +164,9 @@ class MovieSaver
 		return frames.startNewValue();
 		}
 	void postNewFrame(void); // Signals that the new frame has been received
+	void captureFrame(const ISize& frameSize); // Reads the current OpenGL context's read buffer into a new frame, asynchronously if supported; must be called from the context's thread
+	void releaseGLState(void); // Retrieves all pending readbacks and releases readback state; must be called before the capturing OpenGL context is destroyed
+	Statistics getStatistics(void) const; // Returns the current capture statistics
 	};
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 TheoraMovieSaver - Helper class to save movies as Theora video streams
 packed into an Ogg container.
-Copyright (c) 2010-2024 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -43,13 +43,16 @@ void TheoraMovieSaver::frameWritingThreadMethod(void)
 	{
 	/* Save frames until shut down: */
 	unsigned int frameIndex=0;
-	while(!done)
+	while(true)
 		{
-		/* Add the most recent frame to the captured frame queue: */
+		/* Add the most recent frame to the captured frame queue unless the movie saver is shutting down: */
 		{
 		Threads::MutexCond::Lock captureLock(captureCond);
+		if(done)
+			break;
 		frames.lockNewValue();
 		capturedFrames.push_back(frames.getLockedValue());
+		frameQueued(capturedFrames.size());
 		captureCond.signal();
 		}
 		
@@ -63,26 +66,93 @@ void TheoraMovieSaver::frameWritingThreadMethod(void)
 		}
 	}
 
+void* TheoraMovieSaver::frameConversionThreadMethod(void)
+	{
+	/* Convert frames until shut down: */
+	while(true)
+		{
+		/* Wait for the next frame: */
+		FrameBuffer frame;
+		{
+		Threads::MutexCond::Lock captureLock(captureCond);
+		while(!done&&capturedFrames.empty())
+			captureCond.wait(captureLock);
+		if(capturedFrames.empty()) // Bail out if there will be no more frames
+			break;
+		frame=capturedFrames.front();
+		capturedFrames.pop_front();
+		frameDequeued(capturedFrames.size());
+		
+		/* Print a progress report if movie saver is already shut down: */
+		if(done)
+			{
+			std::cout<<"\rTheoraMovieSaver: "<<capturedFrames.size()+1<<" movie frames left to encode ";
+			if(capturedFrames.empty())
+				std::cout<<std::endl;
+			else
+				std::cout<<std::flush;
+			}
+		}
+		
+		/* Check if the frame is a different size than previous frames: */
+		if(frame.getFrameSize()!=frameSize)
+			{
+			/* Theora cannot handle changing frame sizes; bail out with an error: */
+			std::cerr<<"TheoraMovieSaver: Terminating due to changed frame size"<<std::endl;
+			break;
+			}
+		
+		/* Convert the frame to RGB if it was read back as RGBA: */
+		frame.convertToRGB();
+		
+		/* Wait for a free slot in the ring of converted frames: */
+		unsigned int slotIndex;
+		{
+		Threads::MutexCond::Lock conversionLock(conversionCond);
+		while(numConverted==numConvertedFrames)
+			conversionCond.wait(conversionLock);
+		slotIndex=(convertedFramesHead+numConverted)%numConvertedFrames;
+		}
+		
+		/* Convert the new raw RGB frame to Y'CbCr 4:2:0: */
+		Video::TheoraFrame& theoraFrame=convertedFrames[slotIndex];
+		Video::FrameBuffer tempFrame;
+		tempFrame.start=frame.getBuffer();
+		imageExtractor->extractYpCbCr420(&tempFrame,theoraFrame.planes[0].data,theoraFrame.planes[0].stride,theoraFrame.planes[1].data,theoraFrame.planes[1].stride,theoraFrame.planes[2].data,theoraFrame.planes[2].stride);
+		
+		/* Pass the converted frame to the encoder: */
+		{
+		Threads::MutexCond::Lock conversionLock(conversionCond);
+		++numConverted;
+		conversionCond.signal();
+		}
+		}
+	
+	/* Signal the encoder that there will be no more converted frames: */
+	{
+	Threads::MutexCond::Lock conversionLock(conversionCond);
+	conversionDone=true;
+	conversionCond.signal();
+	}
+	
+	return 0;
+	}
+
 void* TheoraMovieSaver::frameSavingThreadMethod(void)
 	{
-	/* Wait for the first frame: */
-	FrameBuffer frame;
+	/* Wait for the first frame and remember its size: */
 	{
 	Threads::MutexCond::Lock captureLock(captureCond);
 	while(!done&&capturedFrames.empty())
 		captureCond.wait(captureLock);
 	if(capturedFrames.empty()) // Bail out if there will be no more frames
 		return 0;
-	frame=capturedFrames.front();
-	capturedFrames.pop_front();
+	frameSize=capturedFrames.front().getFrameSize();
 	}
 	
-	/* Remember the first frame's size: */
-	ISize imageSize=frame.getFrameSize();
-	
 	/* Create the Theora info structure: */
 	Video::TheoraInfo theoraInfo;
-	theoraInfo.setImageSize(imageSize);
+	theoraInfo.setImageSize(frameSize);
 	theoraInfo.colorspace=TH_CS_UNSPECIFIED;
 	theoraInfo.pixel_fmt=TH_PF_420;
 	theoraInfo.target_bitrate=theoraBitrate;
@@ -100,10 +170,11 @@ void* TheoraMovieSaver::frameSavingThreadMethod(void)
 		}
 	
 	/* Create the image extractor: */
-	imageExtractor=new Video::ImageExtractorRGB8(imageSize);
+	imageExtractor=new Video::ImageExtractorRGB8(frameSize);
 	
-	/* Create the Theora frame buffer: */
-	theoraFrame.init420(theoraInfo);
+	/* Create the ring of Theora frame buffers: */
+	for(unsigned int i=0;i<numConvertedFrames;++i)
+		convertedFrames[i].init420(theoraInfo);
 	
 	/*************************************************
 	Write the Theora stream headers to the Ogg stream:
@@ -138,46 +209,36 @@ void* TheoraMovieSaver::frameSavingThreadMethod(void)
 	while(oggStream.flush(page))
 		page.write(*movieFile);
 	
-	/* Encode and save frames until shut down: */
+	/*********************************************************************
+	Theora predicts frames from their predecessors, meaning frames have to
+	be encoded in order. Convert frames in a separate thread instead to
+	overlap conversion of the next frames with encoding the current one:
+	*********************************************************************/
+	
+	frameConversionThread.start(this,&TheoraMovieSaver::frameConversionThreadMethod);
+	
+	/* Encode and save frames until the conversion thread shuts down: */
 	while(true)
 		{
-		/* Wait for the next frame: */
-		FrameBuffer frame;
+		/* Wait for the next converted frame: */
 		{
-		Threads::MutexCond::Lock captureLock(captureCond);
-		while(!done&&capturedFrames.empty())
-			captureCond.wait(captureLock);
-		if(capturedFrames.empty()) // Bail out if there will be no more frames
+		Threads::MutexCond::Lock conversionLock(conversionCond);
+		while(!conversionDone&&numConverted==0)
+			conversionCond.wait(conversionLock);
+		if(numConverted==0) // Bail out if there will be no more frames
 			break;
-		frame=capturedFrames.front();
-		capturedFrames.pop_front();
-		
-		/* Print a progress report if movie saver is already shut down: */
-		if(done)
-			{
-			std::cout<<"\rTheoraMovieSaver: "<<capturedFrames.size()+1<<" movie frames left to encode ";
-			if(capturedFrames.empty())
-				std::cout<<std::endl;
-			else
-				std::cout<<std::flush;
-			}
 		}
 		
-		/* Check if the frame is a different size than previous frames: */
-		if(frame.getFrameSize()!=imageSize)
-			{
-			/* Theora cannot handle changing frame sizes; bail out with an error: */
-			std::cerr<<"TheoraMovieSaver: Terminating due to changed frame size"<<std::endl;
-			return 0;
-			}
+		/* Feed the oldest converted Y'CbCr 4:2:0 frame to the Theora encoder: */
+		theoraEncoder.encodeFrame(convertedFrames[convertedFramesHead]);
 		
-		/* Convert the new raw RGB frame to Y'CbCr 4:2:0: */
-		Video::FrameBuffer tempFrame;
-		tempFrame.start=frame.getBuffer();
-		imageExtractor->extractYpCbCr420(&tempFrame,theoraFrame.planes[0].data,theoraFrame.planes[0].stride,theoraFrame.planes[1].data,theoraFrame.planes[1].stride,theoraFrame.planes[2].data,theoraFrame.planes[2].stride);
-		
-		/* Feed the last converted Y'CbCr 4:2:0 frame to the Theora encoder: */
-		theoraEncoder.encodeFrame(theoraFrame);
+		/* Release the converted frame: */
+		{
+		Threads::MutexCond::Lock conversionLock(conversionCond);
+		convertedFramesHead=(convertedFramesHead+1)%numConvertedFrames;
+		--numConverted;
+		conversionCond.signal();
+		}
 		
 		/* Write all encoded Theora packets to the movie file: */
 		Video::TheoraPacket packet;
@@ -193,6 +254,9 @@ void* TheoraMovieSaver::frameSavingThreadMethod(void)
 			}
 		}
 	
+	/* Wait for the conversion thread to terminate: */
+	frameConversionThread.join();
+	
 	return 0;
 	}
 
@@ -202,7 +266,9 @@ TheoraMovieSaver::TheoraMovieSaver(const Misc::ConfigurationFileSection& configF
 	 oggStream(1),
 	 theoraBitrate(0),theoraQuality(32),theoraGopSize(32),
 	 done(false),
-	 imageExtractor(0)
+	 frameSize(0,0),
+	 imageExtractor(0),
+	 convertedFramesHead(0),numConverted(0),conversionDone(false)
 	{
 	movieFile->setEndianness(Misc::LittleEndian);
 	
@@ -233,9 +299,16 @@ TheoraMovieSaver::~TheoraMovieSaver(void)
 	/* Stop sound recording at this moment: */
 	stopSound();
 	
-	/* Signal the frame capturing and saving threads to shut down: */
+	/* Signal the frame capturing, conversion, and saving threads to shut down: */
+	{
+	Threads::MutexCond::Lock captureLock(captureCond);
 	done=true;
-	captureCond.signal();
+	captureCond.broadcast();
+	}
+	
+	/* Wait until the frame writing thread notices the shutdown and terminates, so that it does not outlive the frame queue: */
+	if(!frameWritingThread.isJoined())
+		frameWritingThread.join();
 	
 	/* Wait until the frame saving thread has saved all frames and terminates: */
 	frameSavingThread.join();
@@ -247,6 +320,8 @@ TheoraMovieSaver::~TheoraMovieSaver(void)
 	
 	/* Delete the image extractor: */
 	delete imageExtractor;
+	
+	logStatistics("TheoraMovieSaver");
 	}
 
 }
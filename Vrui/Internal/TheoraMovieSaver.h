@@ -1,7 +1,7 @@
 /***********************************************************************
 TheoraMovieSaver - Helper class to save movies as Theora video streams
 packed into an Ogg container.
-Copyright (c) 2010-2015 Oliver Kreylos
+Copyright (c) 2010-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -52,11 +52,18 @@ class TheoraMovieSaver:public MovieSaver
 	int theoraFrameRate; // Integer frame rate
 	Threads::MutexCond captureCond; // Condition variable to signal that a new frame has been captured and added to the queue
 	std::deque<FrameBuffer> capturedFrames; // Queue of frame buffers selected for writing
-	Threads::Thread frameSavingThread; // Thread to write captured frames to disk; in separate thread to avoid latency issues
+	Threads::Thread frameSavingThread; // Thread to encode converted frames and write them to disk; in separate thread to avoid latency issues
+	Threads::Thread frameConversionThread; // Thread to convert captured frames to Y'CbCr 4:2:0 while the previous frames are being encoded
 	volatile bool done; // Flag whether all frames have been captured
+	ISize frameSize; // Size of all frames in the movie
 	Video::ImageExtractor* imageExtractor; // Extractor to convert RGB images to Y'CbCr 4:2:0 images
 	Video::TheoraEncoder theoraEncoder; // Theora encoder object
-	Video::TheoraFrame theoraFrame; // Frame buffer for frames in Y'CbCr 4:2:0 pixel format
+	static const unsigned int numConvertedFrames=4; // Number of frames in the ring of converted frames
+	Video::TheoraFrame convertedFrames[numConvertedFrames]; // Ring of frames in Y'CbCr 4:2:0 pixel format waiting to be encoded
+	Threads::MutexCond conversionCond; // Condition variable to signal that a frame has been converted or encoded
+	unsigned int convertedFramesHead; // Index of the oldest converted frame in the ring
+	unsigned int numConverted; // Number of converted frames in the ring
+	bool conversionDone; // Flag whether the conversion thread has converted its last frame
 	
 	/* Protected methods from MovieSaver: */
 	protected:
@@ -64,7 +71,8 @@ class TheoraMovieSaver:public MovieSaver
 	
 	/* Private methods: */
 	private:
-	void* frameSavingThreadMethod(void); // Thread method to compress captured frames into the movie file
+	void* frameConversionThreadMethod(void); // Thread method to convert captured frames to Y'CbCr 4:2:0
+	void* frameSavingThreadMethod(void); // Thread method to compress converted frames into the movie file
 	
 	/* Constructors and destructors: */
 	public:
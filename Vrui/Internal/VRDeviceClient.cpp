@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceClient - Class encapsulating the VR device protocol's client
 side.
-Copyright (c) 2002-2024 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -27,14 +27,18 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/VRDeviceClient.h>
 
 #include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
 #include <Misc/SizedTypes.h>
 #include <Misc/StdError.h>
 #include <Misc/Time.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
 #include <Realtime/Time.h>
-#include <Realtime/SharedMemory.h>
-#include <Threads/Config.h>
+#include <Realtime/SharedStateRing.h>
+#include <Comm/IPv4Address.h>
+#include <Comm/IPv4SocketAddress.h>
+#include <Comm/UDPSocket.h>
 #include <Comm/UNIXPipe.h>
 #include <Comm/TCPPipe.h>
 #include <Vrui/EnvironmentDefinition.h>
@@ -194,10 +198,37 @@ void VRDeviceClient::readConnectReply(void)
 	
 	/* Check if the server supports shared-memory access to its device states: */
 	Comm::UNIXPipe* unixPipe=dynamic_cast<Comm::UNIXPipe*>(pipe.getPointer());
-	if(unixPipe!=0&&serverProtocolVersionNumber>=12U)
+	if(unixPipe!=0&&serverProtocolVersionNumber>=14U)
 		{
 		/* Read the file descriptor of the server's shared-memory block: */
-		stateMemory=new Realtime::SharedMemory(unixPipe->readFd(),false);
+		stateMemory=new Realtime::SharedStateRing(unixPipe->readFd());
+		}
+	
+	/* Receive compact frame updates in streaming mode if enabled, the server supports them, and the client is not connected via a UNIX socket: */
+	if(useFrameUpdates&&unixPipe==0&&serverProtocolVersionNumber>=15U)
+		frameCoder=new VRDeviceProtocol::FrameCoder(state);
+	
+	/* Check if the server sends state updates to a multicast group: */
+	if(serverProtocolVersionNumber>=16U)
+		{
+		serverHasMulticast=pipe->read<Misc::UInt8>()!=0U;
+		if(serverHasMulticast)
+			{
+			/* Read the multicast group's address and port and the server's stream identifier: */
+			multicastGroupAddress=pipe->read<Misc::UInt32>();
+			multicastPort=pipe->read<Misc::UInt16>();
+			multicastStreamId=pipe->read<Misc::UInt32>();
+			
+			/* Multicast state updates are encoded as frames; only receive them if frames are supported over this connection: */
+			if(frameCoder!=0)
+				{
+				/* Allocate a datagram buffer with one extra byte to detect oversized datagrams: */
+				multicastBufferSize=2*sizeof(Misc::UInt32)+frameCoder->getMaxFrameSize()+1;
+				multicastBuffer=new Misc::UInt8[multicastBufferSize];
+				}
+			else
+				serverHasMulticast=false;
+			}
 		}
 	}
 
@@ -218,6 +249,10 @@ bool VRDeviceClient::handlePipeMessage(void)
 			{
 			Threads::Mutex::Lock stateLock(stateMutex);
 			state.read(*pipe,serverHasTimeStamps,serverHasValidFlags);
+			
+			/* Reset the frame coder, as the server does the same before sending the packet reply that starts a new stream: */
+			if(frameCoder!=0)
+				frameCoder->reset();
 			if(!serverHasTimeStamps)
 				{
 				/* Set all tracker time stamps to the current local time: */
@@ -287,6 +322,37 @@ bool VRDeviceClient::handlePipeMessage(void)
 				(*packetNotificationCallback)(this);
 			}
 			}
+		else if(message==FRAME_UPDATE)
+			{
+			if(frameCoder==0)
+				throw std::runtime_error("Unexpected frame update");
+			
+			/* Read a frame update packet: */
+			{
+			Threads::Mutex::Lock stateLock(stateMutex);
+			frameCoder->readFrame(*pipe,state,local?0:timeStampDelta);
+			
+			#if DEBUG_PROTOCOL
+			std::cout<<"Received FRAME_UPDATE"<<std::endl;
+			#endif
+			}
+			
+			/* Signal packet reception: */
+			packetSignalCond.broadcast();
+			
+			/* Invoke packet notification callback: */
+			{
+			Threads::Mutex::Lock callbacksLock(callbacksMutex);
+			if(packetNotificationCallback!=0)
+				(*packetNotificationCallback)(this);
+			}
+			}
+		else if(message==MULTICASTSTREAM_REPLY)
+			{
+			/* Read the sequence number of the first multicast state update following the next packet reply: */
+			nextMulticastSequence=pipe->read<Misc::UInt32>();
+			multicastSynced=true;
+			}
 		else if(message==BUTTON_UPDATE)
 			{
 			/* Read a button update packet: */
@@ -484,6 +550,57 @@ void VRDeviceClient::pipeCallback(Threads::EventDispatcher::IOEvent& event)
 	static_cast<VRDeviceClient*>(event.getUserData())->handlePipeMessage();
 	}
 
+void VRDeviceClient::multicastCallback(Threads::EventDispatcher::IOEvent& event)
+	{
+	VRDeviceClient* thisPtr=static_cast<VRDeviceClient*>(event.getUserData());
+	
+	try
+		{
+		/* Receive the next datagram: */
+		size_t datagramSize=thisPtr->multicastSocket->receiveMessage(thisPtr->multicastBuffer,thisPtr->multicastBufferSize);
+		
+		/* Ignore malformed datagrams and datagrams sent by other servers to the same multicast group: */
+		Misc::UInt32 header[2];
+		if(datagramSize<sizeof(header)||datagramSize>=thisPtr->multicastBufferSize)
+			return;
+		memcpy(header,thisPtr->multicastBuffer,sizeof(header));
+		if(ntohl(header[0])!=thisPtr->multicastStreamId)
+			return;
+		
+		/* Ignore state updates until the stream's starting sequence number is known, and ignore outdated or duplicated state updates: */
+		Misc::UInt32 sequence=ntohl(header[1]);
+		if(!thisPtr->multicastSynced||Misc::SInt32(sequence-thisPtr->nextMulticastSequence)<0)
+			return;
+		
+		/* Count the state updates that were skipped since the last received one: */
+		thisPtr->numLostMulticastUpdates+=sequence-thisPtr->nextMulticastSequence;
+		thisPtr->nextMulticastSequence=sequence+1U;
+		
+		/* Apply the self-contained state update: */
+		{
+		Threads::Mutex::Lock stateLock(thisPtr->stateMutex);
+		thisPtr->frameCoder->reset();
+		thisPtr->frameCoder->decodeFrame(thisPtr->multicastBuffer+sizeof(header),datagramSize-sizeof(header),thisPtr->state,thisPtr->local?0:thisPtr->timeStampDelta);
+		}
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Treat the state update as lost; the next one will replace the entire device state: */
+		++thisPtr->numLostMulticastUpdates;
+		return;
+		}
+	
+	/* Signal packet reception: */
+	thisPtr->packetSignalCond.broadcast();
+	
+	/* Invoke packet notification callback: */
+	{
+	Threads::Mutex::Lock callbacksLock(thisPtr->callbacksMutex);
+	if(thisPtr->packetNotificationCallback!=0)
+		(*thisPtr->packetNotificationCallback)(thisPtr);
+	}
+	}
+
 void VRDeviceClient::initClient(void)
 	{
 	/* Determine whether client and server are running on the same host: */
@@ -513,7 +630,11 @@ VRDeviceClient::VRDeviceClient(Threads::EventDispatcher& sDispatcher,const char*
 	:dispatcher(sDispatcher),
 	 pipe(new Comm::TCPPipe(deviceServerHostName,deviceServerPort)),pipeEventKey(0),
 	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),serverHasValidFlags(false),
-	 stateMemory(0),batteryStates(0),batteryStateUpdatedCallback(0),
+	 stateMemory(0),useFrameUpdates(true),frameCoder(0),
+	 useMulticast(true),serverHasMulticast(false),multicastGroupAddress(0U),multicastPort(0U),multicastStreamId(0U),
+	 multicastSocket(0),multicastEventKey(0),multicastBuffer(0),multicastBufferSize(0),
+	 multicastSynced(false),nextMulticastSequence(0U),numLostMulticastUpdates(0),
+	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
 	 numPowerFeatures(0),numHapticFeatures(0),
 	 getBaseStationsRequest(0),getEnvironmentDefinitionRequest(0),
@@ -528,7 +649,11 @@ VRDeviceClient::VRDeviceClient(Threads::EventDispatcher& sDispatcher,const char*
 	:dispatcher(sDispatcher),
 	 pipe(new Comm::UNIXPipe(deviceServerSocketName,deviceServerSocketAbstract)),pipeEventKey(0),
 	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),serverHasValidFlags(false),
-	 stateMemory(0),batteryStates(0),batteryStateUpdatedCallback(0),
+	 stateMemory(0),useFrameUpdates(true),frameCoder(0),
+	 useMulticast(true),serverHasMulticast(false),multicastGroupAddress(0U),multicastPort(0U),multicastStreamId(0U),
+	 multicastSocket(0),multicastEventKey(0),multicastBuffer(0),multicastBufferSize(0),
+	 multicastSynced(false),nextMulticastSequence(0U),numLostMulticastUpdates(0),
+	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
 	 numPowerFeatures(0),numHapticFeatures(0),
 	 getBaseStationsRequest(0),getEnvironmentDefinitionRequest(0),
@@ -567,7 +692,11 @@ VRDeviceClient::VRDeviceClient(Threads::EventDispatcher& sDispatcher,const Misc:
 	:dispatcher(sDispatcher),
 	 pipe(openServerPipe(configFileSection)),pipeEventKey(0),
 	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),serverHasValidFlags(false),
-	 stateMemory(0),batteryStates(0),batteryStateUpdatedCallback(0),
+	 stateMemory(0),useFrameUpdates(configFileSection.retrieveValue<bool>("./useFrameUpdates",true)),frameCoder(0),
+	 useMulticast(configFileSection.retrieveValue<bool>("./useMulticast",true)),serverHasMulticast(false),multicastGroupAddress(0U),multicastPort(0U),multicastStreamId(0U),
+	 multicastSocket(0),multicastEventKey(0),multicastBuffer(0),multicastBufferSize(0),
+	 multicastSynced(false),nextMulticastSequence(0U),numLostMulticastUpdates(0),
+	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
 	 numPowerFeatures(0),numHapticFeatures(0),
 	 getBaseStationsRequest(0),getEnvironmentDefinitionRequest(0),
@@ -612,8 +741,11 @@ VRDeviceClient::~VRDeviceClient(void)
 	delete[] batteryStates;
 	delete[] hmdConfigurations;
 	
-	/* Release the server's shared memory segment: */
+	/* Release the server's shared memory segment, the frame coder, and the multicast socket: */
 	delete stateMemory;
+	delete frameCoder;
+	delete multicastSocket;
+	delete[] multicastBuffer;
 	
 	#if TRACK_LATENCY
 	std::cout<<"Tracker update latency range: ["<<trackerLatencyMin<<", "<<trackerLatencyMax<<"]"<<std::endl;
@@ -900,10 +1032,40 @@ void VRDeviceClient::startStream(VRDeviceClient::Callback* newPacketNotification
 			}
 		}
 		
+		/* Check if state updates should be received from the server's multicast group: */
+		bool multicast=false;
+		if(useMulticast&&serverHasMulticast)
+			{
+			try
+				{
+				/* Join the multicast group before requesting the stream so that no state updates are missed: */
+				Comm::IPv4Address groupAddress(multicastGroupAddress);
+				if(multicastSocket==0)
+					multicastSocket=new Comm::UDPSocket(Comm::IPv4SocketAddress(multicastPort,groupAddress),Comm::IPv4Address());
+				else
+					multicastSocket->joinMulticastGroup(groupAddress,Comm::IPv4Address());
+				
+				/* Wait for the starting sequence number before applying state updates: */
+				multicastSynced=false;
+				numLostMulticastUpdates=0;
+				
+				/* Register multicast socket events with the event dispatcher: */
+				multicastEventKey=dispatcher.addIOEventListener(multicastSocket->getFd(),Threads::EventDispatcher::Read,&VRDeviceClient::multicastCallback,this);
+				multicast=true;
+				}
+			catch(const std::runtime_error& err)
+				{
+				/* Fall back to receiving state updates over the server connection: */
+				std::cerr<<"VRDeviceClient: Unable to join server's multicast group due to exception "<<err.what()<<std::endl;
+				delete multicastSocket;
+				multicastSocket=0;
+				}
+			}
+		
 		/* Send start streaming message and wait for first state packet to arrive: */
 		{
 		Threads::MutexCond::Lock packetSignalLock(packetSignalCond);
-		pipe->write(MessageIdType(STARTSTREAM_REQUEST));
+		pipe->write(MessageIdType(multicast?STARTMULTICASTSTREAM_REQUEST:(frameCoder!=0?STARTFRAMESTREAM_REQUEST:STARTSTREAM_REQUEST)));
 		pipe->flush();
 		// packetSignalCond.wait(packetSignalLock);
 		streaming=true;
@@ -929,6 +1091,21 @@ void VRDeviceClient::stopStream(void)
 			pipe->flush();
 			}
 		
+		if(multicastEventKey!=0)
+			{
+			/* Unregister multicast socket events with the event dispatcher and leave the multicast group: */
+			dispatcher.removeIOEventListener(multicastEventKey);
+			multicastEventKey=0;
+			try
+				{
+				multicastSocket->leaveMulticastGroup(Comm::IPv4Address(multicastGroupAddress),Comm::IPv4Address());
+				}
+			catch(const std::runtime_error& err)
+				{
+				/* Ignore the error; the socket will leave the group when it is closed */
+				}
+			}
+		
 		/* Delete the callback functions: */
 		{
 		Threads::Mutex::Lock callbacksLock(callbacksMutex);
@@ -942,30 +1119,27 @@ void VRDeviceClient::stopStream(void)
 
 void VRDeviceClient::updateDeviceStates(void)
 	{
-	/* Keep reading from the shared memory segment until successful: */
-	unsigned int* counter=stateMemory->getValue<unsigned int>(0);
-	char* bufferHalves=stateMemory->getValue<char>(sizeof(ptrdiff_t));
-	size_t stateSize=state.getStateSize();
-	unsigned int counter0,counter1;
-	do
-		{
-		/* Read the counter to determine which buffer half contains readable data: */
-		#if THREADS_CONFIG_HAVE_BUILTIN_ATOMICS
-		counter0=__atomic_load_n(counter,__ATOMIC_ACQUIRE);
-		#endif
-		
-		/* Read device states from the readable buffer half: */
-		{
-		Threads::Mutex::Lock stateLock(stateMutex);
-		state.read(bufferHalves+(counter0&0x1U)*stateSize);
-		}
-		
-		/* Read the counter again to detect changes during the read: */
-		#if THREADS_CONFIG_HAVE_BUILTIN_ATOMICS
-		counter1=__atomic_load_n(counter,__ATOMIC_ACQUIRE);
-		#endif
-		}
-	while(counter0!=counter1);
+	/* Read the most recent device states from the shared state ring, which retries internally until it gets a consistent state: */
+	Threads::Mutex::Lock stateLock(stateMutex);
+	stateMemory->readLatest(state.getStateMemory());
+	}
+
+unsigned int VRDeviceClient::getStateHistorySize(void) const
+	{
+	return stateMemory->getNumSlots();
+	}
+
+bool VRDeviceClient::readPastDeviceStates(unsigned int age,VRDeviceState& pastState,TimePoint* postTime) const
+	{
+	/* Check that the given device state object has the server's layout: */
+	if(pastState.getStateSize()!=stateMemory->getStateSize())
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Device state object does not match server's device state layout");
+	
+	/* Read the requested past device states; the read fails if they have been overwritten in the meantime: */
+	unsigned int numStates=stateMemory->getNumStates();
+	if(age>=numStates)
+		return false;
+	return stateMemory->read(numStates-1U-age,pastState.getStateMemory(),postTime);
 	}
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceClient - Class encapsulating the VR device protocol's client
 side.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -27,11 +27,13 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <utility>
 #include <vector>
 #include <stdexcept>
+#include <Misc/SizedTypes.h>
 #include <Misc/FunctionCalls.h>
 #include <Threads/Mutex.h>
 #include <Threads/MutexCond.h>
 #include <Threads/EventDispatcher.h>
 #include <Comm/Pipe.h>
+#include <Vrui/Types.h>
 #include <Vrui/Internal/VRDeviceState.h>
 #include <Vrui/Internal/BatteryState.h>
 #include <Vrui/Internal/VRDeviceProtocol.h>
@@ -41,7 +43,10 @@ namespace Misc {
 class ConfigurationFileSection;
 }
 namespace Realtime {
-class SharedMemory;
+class SharedStateRing;
+}
+namespace Comm {
+class UDPSocket;
 }
 namespace Vrui {
 class EnvironmentDefinition;
@@ -86,9 +91,23 @@ class VRDeviceClient:public VRDeviceProtocol
 	bool serverHasTimeStamps; // Flag whether the connected device server sends tracker state time stamps
 	bool serverHasValidFlags; // Flag whether the connected device server sends tracker valid flags
 	std::vector<VRDeviceDescriptor*> virtualDevices; // List of virtual input devices managed by the server
-	Realtime::SharedMemory* stateMemory; // Optional shared memory segment from which to read the server's device state
+	Realtime::SharedStateRing* stateMemory; // Optional ring of recent device states in shared memory from which to read the server's device state
 	mutable Threads::Mutex stateMutex; // Mutex to serialize access to current state
 	VRDeviceState state; // Shadow of server's current state
+	bool useFrameUpdates; // Flag whether to request lossy quantized and delta-encoded frame updates instead of full-precision state updates in streaming mode; also required to receive multicast state updates
+	VRDeviceProtocol::FrameCoder* frameCoder; // Coder to decode quantized and delta-encoded frame updates in streaming mode if frame updates are enabled, the server supports them, and the connection is not local; null otherwise
+	bool useMulticast; // Flag whether to receive state updates from the server's multicast group in streaming mode if the server has one
+	bool serverHasMulticast; // Flag whether the server sends state updates to a multicast group
+	Misc::UInt32 multicastGroupAddress; // IPv4 address of the server's multicast group in host byte order
+	unsigned int multicastPort; // Port number of the server's multicast group
+	Misc::UInt32 multicastStreamId; // Identifier of the server's multicast stream
+	Comm::UDPSocket* multicastSocket; // UDP socket joined to the server's multicast group while streaming from it; null otherwise
+	Threads::EventDispatcher::ListenerKey multicastEventKey; // Key for events on the multicast socket
+	Misc::UInt8* multicastBuffer; // Buffer to receive multicast state update datagrams
+	size_t multicastBufferSize; // Size of the multicast datagram buffer
+	bool multicastSynced; // Flag whether the sequence number of the next expected multicast state update is known
+	Misc::UInt32 nextMulticastSequence; // Sequence number of the next expected multicast state update
+	unsigned int numLostMulticastUpdates; // Number of multicast state updates that were lost in transmission since streaming started
 	mutable Threads::Mutex batteryStatesMutex; // Mutex to serialize access to the battery state array
 	BatteryState* batteryStates; // Array of virtual device battery states maintained by the server
 	Threads::Mutex callbacksMutex; // Mutex protecting all callback elements
@@ -116,6 +135,7 @@ class VRDeviceClient:public VRDeviceProtocol
 	void readConnectReply(void); // Reads the server's initial connect reply message
 	bool handlePipeMessage(void); // Method called when data can be read from the server connection; returns false if the connection was closed
 	static void pipeCallback(Threads::EventDispatcher::IOEvent& event); // Wrapper method called when data can be read from the server connection
+	static void multicastCallback(Threads::EventDispatcher::IOEvent& event); // Method called when a datagram can be read from the server's multicast group
 	void initClient(void); // Initializes communication between device server and client
 	
 	/* Constructors and destructors: */
@@ -134,6 +154,18 @@ class VRDeviceClient:public VRDeviceProtocol
 		{
 		return stateMemory!=0;
 		}
+	bool hasMulticast(void) const // Returns true if the server sends state updates to a multicast group
+		{
+		return serverHasMulticast;
+		}
+	void setUseMulticast(bool newUseMulticast) // Sets whether to receive state updates from the server's multicast group in the next streaming mode; ignored if the server does not have one
+		{
+		useMulticast=newUseMulticast;
+		}
+	unsigned int getNumLostMulticastUpdates(void) const // Returns the number of multicast state updates lost in transmission since streaming mode started
+		{
+		return numLostMulticastUpdates;
+		}
 	int getNumVirtualDevices(void) const // Returns the number of managed virtual input devices
 		{
 		return int(virtualDevices.size());
@@ -201,6 +233,8 @@ class VRDeviceClient:public VRDeviceProtocol
 	void startStream(Callback* newPacketNotificationCallback,ErrorCallback* newErrorCallback =0); // Installs given callback functions (device client adopts function objects) and starts streaming mode
 	void stopStream(void); // Stops streaming mode
 	void updateDeviceStates(void); // Updates device states from the server's shared memory segment; assumes that shared memory is supported
+	unsigned int getStateHistorySize(void) const; // Returns the number of most recent device states retained in the server's shared memory segment; assumes that shared memory is supported
+	bool readPastDeviceStates(unsigned int age,VRDeviceState& pastState,TimePoint* postTime =0) const; // Reads the device states that were posted the given number of updates before the most recent ones into the given device state object of the server's layout, and optionally their posting time; returns false if those states are no longer available; assumes that shared memory is supported
 	};
 
 }
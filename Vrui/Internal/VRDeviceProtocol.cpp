@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceProtocol - Class defining the client-server protocol between a
 Vrui application and a VR device server.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -23,12 +23,299 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Internal/VRDeviceProtocol.h>
 
+#include <string.h>
+#include <Misc/StdError.h>
+#include <IO/File.h>
+#include <Math/Math.h>
+
 namespace Vrui {
 
+namespace {
+
+/************************************************
+Helper functions to encode and decode frame data:
+************************************************/
+
+inline Misc::UInt8* writeUnsigned(Misc::UInt8* bufPtr,Misc::UInt32 value) // Writes an unsigned integer as a variable-length sequence of 7-bit groups
+	{
+	while(value>=0x80U)
+		{
+		*(bufPtr++)=Misc::UInt8(value|0x80U);
+		value>>=7;
+		}
+	*(bufPtr++)=Misc::UInt8(value);
+	return bufPtr;
+	}
+
+inline Misc::UInt8* writeSigned(Misc::UInt8* bufPtr,Misc::SInt32 value) // Writes a signed integer in zig-zag encoding so that small magnitudes result in short sequences
+	{
+	return writeUnsigned(bufPtr,(Misc::UInt32(value)<<1)^Misc::UInt32(value>>31));
+	}
+
+inline Misc::UInt32 readUnsigned(const Misc::UInt8*& bufPtr,const Misc::UInt8* bufEnd) // Reads a variable-length unsigned integer
+	{
+	Misc::UInt32 result=0U;
+	for(int shift=0;shift<35;shift+=7)
+		{
+		if(bufPtr==bufEnd)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated frame update");
+		Misc::UInt32 byte=*(bufPtr++);
+		result|=(byte&0x7fU)<<shift;
+		if((byte&0x80U)==0x0U)
+			return result;
+		}
+	throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Malformed frame update");
+	}
+
+inline Misc::SInt32 readSigned(const Misc::UInt8*& bufPtr,const Misc::UInt8* bufEnd) // Reads a zig-zag encoded signed integer
+	{
+	Misc::UInt32 value=readUnsigned(bufPtr,bufEnd);
+	return Misc::SInt32((value>>1)^(~(value&0x1U)+1U));
+	}
+
+/* Quantized values are clamped to +-1e9 to keep their deltas within 32 bits. This limits the representable range of each quantity to +-1e9/scale, i.e., tracker positions to +-1e9/65536, about +-15258 physical units (15 km if units are meters), linear velocities to +-976562 units/s, and angular velocities to +-244140 radians/s; tracker states outside that range arrive clamped at the client: */
+
+inline Misc::SInt32 quantize(float value,float scale) // Quantizes the given value with the given scale factor, clamping to a safe range
+	{
+	float q=Math::floor(value*scale+0.5f);
+	if(q<-1.0e9f)
+		q=-1.0e9f;
+	else if(q>1.0e9f)
+		q=1.0e9f;
+	return Misc::SInt32(q);
+	}
+
+inline int readIndex(const Misc::UInt8*& bufPtr,const Misc::UInt8* bufEnd,int& nextIndex,int numIndices) // Reads a delta-encoded index and checks it against the given index range
+	{
+	int index=nextIndex+int(readSigned(bufPtr,bufEnd));
+	if(index<0||index>=numIndices)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid index in frame update");
+	nextIndex=index+1;
+	return index;
+	}
+
+}
+
+/*****************************************************
+Static elements of class VRDeviceProtocol::FrameCoder:
+*****************************************************/
+
+const float VRDeviceProtocol::FrameCoder::positionScale=65536.0f;
+const float VRDeviceProtocol::FrameCoder::orientationScale=65536.0f;
+const float VRDeviceProtocol::FrameCoder::linearVelocityScale=1024.0f;
+const float VRDeviceProtocol::FrameCoder::angularVelocityScale=4096.0f;
+const float VRDeviceProtocol::FrameCoder::valuatorScale=32767.0f;
+
+/*********************************************
+Methods of class VRDeviceProtocol::FrameCoder:
+*********************************************/
+
+VRDeviceProtocol::FrameCoder::FrameCoder(const VRDeviceState& state)
+	:numTrackers(state.getNumTrackers()),numButtons(state.getNumButtons()),numValuators(state.getNumValuators()),
+	 trackerBaselines(new TrackerBaseline[numTrackers]),
+	 bufferSize(0),buffer(0)
+	{
+	/* Calculate the maximum size of a frame, with at most five bytes per encoded integer: */
+	bufferSize=3*5; // Number of trackers, buttons, and valuators
+	bufferSize+=size_t(numTrackers)*(5+1+5+numTrackerValues*5); // Index, valid flag, time stamp, quantized values
+	bufferSize+=size_t(numButtons)*5+(numButtons+7)/8; // Indices and packed button states
+	bufferSize+=size_t(numValuators)*(5+5); // Indices and quantized values
+	buffer=new Misc::UInt8[bufferSize];
+	
+	/* Initialize the tracker baselines: */
+	reset();
+	}
+
+VRDeviceProtocol::FrameCoder::~FrameCoder(void)
+	{
+	delete[] trackerBaselines;
+	delete[] buffer;
+	}
+
+void VRDeviceProtocol::FrameCoder::reset(void)
+	{
+	memset(trackerBaselines,0,size_t(numTrackers)*sizeof(TrackerBaseline));
+	}
+
+size_t VRDeviceProtocol::FrameCoder::encodeFrame(const VRDeviceState& state,const std::vector<int>& trackerIndices,const std::vector<int>& buttonIndices,const std::vector<int>& valuatorIndices,Misc::UInt8* frame)
+	{
+	/* Check the update lists against the device state's layout to guarantee that the frame fits into the buffer: */
+	if(trackerIndices.size()>size_t(numTrackers)||buttonIndices.size()>size_t(numButtons)||valuatorIndices.size()>size_t(numValuators))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Update lists do not match device state layout");
+	
+	Misc::UInt8* bufPtr=frame;
+	
+	/* Encode tracker states as deltas against the most recently sent states: */
+	bufPtr=writeUnsigned(bufPtr,Misc::UInt32(trackerIndices.size()));
+	int nextIndex=0;
+	for(std::vector<int>::const_iterator tiIt=trackerIndices.begin();tiIt!=trackerIndices.end();++tiIt)
+		{
+		int index=*tiIt;
+		bufPtr=writeSigned(bufPtr,Misc::SInt32(index-nextIndex));
+		nextIndex=index+1;
+		*(bufPtr++)=state.getTrackerValid(index)?1U:0U;
+		
+		/* Encode the time stamp delta using wrap-around arithmetic: */
+		TrackerBaseline& tb=trackerBaselines[index];
+		VRDeviceState::TimeStamp ts=state.getTrackerTimeStamp(index);
+		bufPtr=writeSigned(bufPtr,Misc::SInt32(Misc::UInt32(ts)-Misc::UInt32(tb.timeStamp)));
+		tb.timeStamp=ts;
+		
+		/* Quantize the tracker state: */
+		const VRDeviceState::TrackerState& trackerState=state.getTrackerState(index);
+		Misc::SInt32 values[numTrackerValues];
+		const VRDeviceState::TrackerState::PositionOrientation::Vector& t=trackerState.positionOrientation.getTranslation();
+		for(int i=0;i<3;++i)
+			values[i]=quantize(t[i],positionScale);
+		
+		/* Flip the orientation quaternion into the same hemisphere as the previous one to keep deltas small: */
+		const float* q=trackerState.positionOrientation.getRotation().getQuaternion();
+		float qs=1.0f;
+		if(float(tb.values[3])*q[0]+float(tb.values[4])*q[1]+float(tb.values[5])*q[2]+float(tb.values[6])*q[3]<0.0f)
+			qs=-1.0f;
+		for(int i=0;i<4;++i)
+			values[3+i]=quantize(qs*q[i],orientationScale);
+		for(int i=0;i<3;++i)
+			values[7+i]=quantize(trackerState.linearVelocity[i],linearVelocityScale);
+		for(int i=0;i<3;++i)
+			values[10+i]=quantize(trackerState.angularVelocity[i],angularVelocityScale);
+		
+		/* Write the quantized values as deltas against the baseline and update the baseline: */
+		for(int i=0;i<numTrackerValues;++i)
+			{
+			bufPtr=writeSigned(bufPtr,values[i]-tb.values[i]);
+			tb.values[i]=values[i];
+			}
+		}
+	
+	/* Encode button indices followed by packed button states: */
+	bufPtr=writeUnsigned(bufPtr,Misc::UInt32(buttonIndices.size()));
+	nextIndex=0;
+	for(std::vector<int>::const_iterator biIt=buttonIndices.begin();biIt!=buttonIndices.end();++biIt)
+		{
+		bufPtr=writeSigned(bufPtr,Misc::SInt32(*biIt-nextIndex));
+		nextIndex=*biIt+1;
+		}
+	Misc::UInt8 bits=0x0U;
+	int numBits=0;
+	for(std::vector<int>::const_iterator biIt=buttonIndices.begin();biIt!=buttonIndices.end();++biIt)
+		{
+		if(state.getButtonState(*biIt))
+			bits|=Misc::UInt8(0x1U<<numBits);
+		if(++numBits==8)
+			{
+			*(bufPtr++)=bits;
+			bits=0x0U;
+			numBits=0;
+			}
+		}
+	if(numBits!=0)
+		*(bufPtr++)=bits;
+	
+	/* Encode valuator indices and quantized states: */
+	bufPtr=writeUnsigned(bufPtr,Misc::UInt32(valuatorIndices.size()));
+	nextIndex=0;
+	for(std::vector<int>::const_iterator viIt=valuatorIndices.begin();viIt!=valuatorIndices.end();++viIt)
+		{
+		bufPtr=writeSigned(bufPtr,Misc::SInt32(*viIt-nextIndex));
+		nextIndex=*viIt+1;
+		bufPtr=writeSigned(bufPtr,quantize(state.getValuatorState(*viIt),valuatorScale));
+		}
+	
+	return size_t(bufPtr-frame);
+	}
+
+void VRDeviceProtocol::FrameCoder::writeFrame(const VRDeviceState& state,const std::vector<int>& trackerIndices,const std::vector<int>& buttonIndices,const std::vector<int>& valuatorIndices,IO::File& sink)
+	{
+	/* Encode the frame into the buffer: */
+	size_t frameSize=encodeFrame(state,trackerIndices,buttonIndices,valuatorIndices,buffer);
+	
+	/* Write the frame size followed by the frame: */
+	sink.write(Misc::UInt32(frameSize));
+	sink.write(buffer,frameSize);
+	}
+
+void VRDeviceProtocol::FrameCoder::decodeFrame(const Misc::UInt8* frame,size_t frameSize,VRDeviceState& state,VRDeviceState::TimeStamp timeStampOffset)
+	{
+	const Misc::UInt8* bufPtr=frame;
+	const Misc::UInt8* bufEnd=frame+frameSize;
+	
+	/* Decode tracker states: */
+	unsigned int numTrackerUpdates=readUnsigned(bufPtr,bufEnd);
+	int nextIndex=0;
+	for(unsigned int i=0;i<numTrackerUpdates;++i)
+		{
+		int index=readIndex(bufPtr,bufEnd,nextIndex,numTrackers);
+		if(bufPtr==bufEnd)
+			throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated frame update");
+		state.setTrackerValid(index,*(bufPtr++)!=0U);
+		
+		/* Update the tracker's baseline from the transmitted deltas: */
+		TrackerBaseline& tb=trackerBaselines[index];
+		tb.timeStamp=VRDeviceState::TimeStamp(Misc::UInt32(tb.timeStamp)+Misc::UInt32(readSigned(bufPtr,bufEnd)));
+		for(int j=0;j<numTrackerValues;++j)
+			tb.values[j]+=readSigned(bufPtr,bufEnd);
+		
+		/* Reconstruct the tracker state from the updated baseline: */
+		VRDeviceState::TrackerState ts;
+		VRDeviceState::TrackerState::PositionOrientation::Vector t;
+		for(int j=0;j<3;++j)
+			t[j]=float(tb.values[j])/positionScale;
+		float q[4];
+		for(int j=0;j<4;++j)
+			q[j]=float(tb.values[3+j])/orientationScale;
+		ts.positionOrientation=VRDeviceState::TrackerState::PositionOrientation(t,VRDeviceState::TrackerState::PositionOrientation::Rotation::fromQuaternion(q));
+		for(int j=0;j<3;++j)
+			ts.linearVelocity[j]=float(tb.values[7+j])/linearVelocityScale;
+		for(int j=0;j<3;++j)
+			ts.angularVelocity[j]=float(tb.values[10+j])/angularVelocityScale;
+		state.setTrackerState(index,ts);
+		state.setTrackerTimeStamp(index,tb.timeStamp+timeStampOffset);
+		}
+	
+	/* Decode button indices and packed button states: */
+	unsigned int numButtonUpdates=readUnsigned(bufPtr,bufEnd);
+	if(numButtonUpdates>(unsigned int)(numButtons))
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Invalid number of buttons in frame update");
+	const Misc::UInt8* bitsPtr=bufPtr;
+	for(unsigned int i=0;i<numButtonUpdates;++i)
+		readSigned(bitsPtr,bufEnd);
+	if(size_t(bufEnd-bitsPtr)<(numButtonUpdates+7)/8)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Truncated frame update");
+	nextIndex=0;
+	for(unsigned int i=0;i<numButtonUpdates;++i)
+		{
+		int index=readIndex(bufPtr,bufEnd,nextIndex,numButtons);
+		state.setButtonState(index,(bitsPtr[i>>3]&(0x1U<<(i&0x7U)))!=0x0U);
+		}
+	bufPtr=bitsPtr+(numButtonUpdates+7)/8;
+	
+	/* Decode valuator indices and quantized states: */
+	unsigned int numValuatorUpdates=readUnsigned(bufPtr,bufEnd);
+	nextIndex=0;
+	for(unsigned int i=0;i<numValuatorUpdates;++i)
+		{
+		int index=readIndex(bufPtr,bufEnd,nextIndex,numValuators);
+		state.setValuatorState(index,float(readSigned(bufPtr,bufEnd))/valuatorScale);
+		}
+	}
+
+void VRDeviceProtocol::FrameCoder::readFrame(IO::File& source,VRDeviceState& state,VRDeviceState::TimeStamp timeStampOffset)
+	{
+	/* Read the frame into the buffer: */
+	size_t frameSize=source.read<Misc::UInt32>();
+	if(frameSize>bufferSize)
+		throw Misc::makeStdErr(__PRETTY_FUNCTION__,"Frame update of %u bytes exceeds maximum size",(unsigned int)(frameSize));
+	source.read(buffer,frameSize);
+	
+	/* Decode the frame: */
+	decodeFrame(buffer,frameSize,state,timeStampOffset);
+	}
+
 /*****************************************
 Static elements of class VRDeviceProtocol:
 *****************************************/
 
-const Misc::UInt32 VRDeviceProtocol::protocolVersionNumber=13U;
+const Misc::UInt32 VRDeviceProtocol::protocolVersionNumber=16U;
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceProtocol - Class defining the client-server protocol between a
 Vrui application and a VR device server.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -24,7 +24,15 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INTERNAL_VRDEVICEPROTOCOL_INCLUDED
 #define VRUI_INTERNAL_VRDEVICEPROTOCOL_INCLUDED
 
+#include <stddef.h>
+#include <vector>
 #include <Misc/SizedTypes.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+/* Forward declarations: */
+namespace IO {
+class File;
+}
 
 namespace Vrui {
 
@@ -59,7 +67,59 @@ class VRDeviceProtocol
 		ENVIRONMENTDEFINITION_REQUEST, // Requests the definition of the environment in physical space
 		ENVIRONMENTDEFINITION_REPLY, // Sends the definition of the environment in physical space
 		ENVIRONMENTDEFINITION_UPDATE_REQUEST, // Requests that the server updates its physical environment definition, sent by RoomSetup utility
-		ENVIRONMENTDEFINITION_UPDATE_NOTIFICATION // Notifies connected clients that the server's environment definition was changed
+		ENVIRONMENTDEFINITION_UPDATE_NOTIFICATION, // Notifies connected clients that the server's environment definition was changed
+		STARTFRAMESTREAM_REQUEST, // Requests entering stream mode with incremental updates packed into quantized and delta-encoded frame updates
+		FRAME_UPDATE, // Sends new states for a set of trackers, buttons, and valuators as a quantized and delta-encoded frame
+		STARTMULTICASTSTREAM_REQUEST, // Requests entering stream mode with state updates sent to the server's UDP multicast group instead of over the client's connection
+		MULTICASTSTREAM_REPLY // Sends the sequence number of the first multicast state update following the next packet reply
+		};
+	
+	class FrameCoder // Class to encode or decode sets of device state updates as quantized and delta-encoded frames
+		{
+		/* Embedded classes: */
+		private:
+		static const int numTrackerValues=13; // Number of quantized values per tracker state: position, orientation quaternion, linear and angular velocity
+		
+		struct TrackerBaseline // Structure holding the most recently transmitted state of a tracker, against which the next state is delta-encoded
+			{
+			/* Elements: */
+			public:
+			VRDeviceState::TimeStamp timeStamp; // Tracker's time stamp
+			Misc::SInt32 values[numTrackerValues]; // Tracker's quantized position, orientation, linear velocity, and angular velocity
+			};
+		
+		/* Elements: */
+		public:
+		static const float positionScale; // Scale factor to quantize tracker positions; quantized values are clamped to +-1e9, limiting positions to about +-15258 units
+		static const float orientationScale; // Scale factor to quantize tracker orientation quaternion components
+		static const float linearVelocityScale; // Scale factor to quantize tracker linear velocities
+		static const float angularVelocityScale; // Scale factor to quantize tracker angular velocities
+		static const float valuatorScale; // Scale factor to quantize valuator states
+		private:
+		int numTrackers,numButtons,numValuators; // Layout of the encoded device state
+		TrackerBaseline* trackerBaselines; // Array of most recently transmitted tracker states
+		size_t bufferSize; // Size of the frame buffer in bytes
+		Misc::UInt8* buffer; // Buffer to assemble or disassemble frames
+		
+		/* Constructors and destructors: */
+		public:
+		FrameCoder(const VRDeviceState& state); // Creates a frame coder for the given device state's layout
+		private:
+		FrameCoder(const FrameCoder& source); // Prohibit copy constructor
+		FrameCoder& operator=(const FrameCoder& source); // Prohibit assignment operator
+		public:
+		~FrameCoder(void);
+		
+		/* Methods: */
+		size_t getMaxFrameSize(void) const // Returns the maximum size of an encoded frame in bytes
+			{
+			return bufferSize;
+			}
+		void reset(void); // Resets the coder's tracker baselines; must be called on both sides of a connection at the start of a stream
+		size_t encodeFrame(const VRDeviceState& state,const std::vector<int>& trackerIndices,const std::vector<int>& buttonIndices,const std::vector<int>& valuatorIndices,Misc::UInt8* frame); // Encodes a frame containing the given trackers, buttons, and valuators from the given device state into the given buffer of at least getMaxFrameSize() bytes; returns the frame's size
+		void decodeFrame(const Misc::UInt8* frame,size_t frameSize,VRDeviceState& state,VRDeviceState::TimeStamp timeStampOffset); // Decodes a frame of the given size and applies it to the given device state; adds given offset to received tracker time stamps
+		void writeFrame(const VRDeviceState& state,const std::vector<int>& trackerIndices,const std::vector<int>& buttonIndices,const std::vector<int>& valuatorIndices,IO::File& sink); // Writes a frame containing the given trackers, buttons, and valuators from the given device state to the given sink
+		void readFrame(IO::File& source,VRDeviceState& state,VRDeviceState::TimeStamp timeStampOffset); // Reads a frame from the given source and applies it to the given device state; adds given offset to received tracker time stamps
 		};
 	
 	/* Elements: */
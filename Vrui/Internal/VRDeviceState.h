@@ -1,7 +1,7 @@
 /***********************************************************************
 VRDeviceState - Class to represent the current state of a single or
 multiple VR devices.
-Copyright (c) 2002-2023 Oliver Kreylos
+Copyright (c) 2002-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -186,6 +186,14 @@ class VRDeviceState
 		{
 		return stateSize;
 		}
+	const void* getStateMemory(void) const // Returns the memory block holding all device state components
+		{
+		return trackerStates;
+		}
+	void* getStateMemory(void) // Ditto
+		{
+		return trackerStates;
+		}
 	void read(const void* sourceMemory) // Reads device state from a shared memory segment
 		{
 		/* Read the entire memory block containing the device state in one go: */
@@ -1,7 +1,7 @@
 /***********************************************************************
 Environment-independent part of Vrui virtual reality development
 toolkit.
-Copyright (c) 2000-2025 Oliver Kreylos
+Copyright (c) 2000-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -46,6 +46,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/TimerEventScheduler.h>
 #include <Threads/FunctionCalls.h>
 #include <Threads/WorkerPool.h>
+#include <Threads/Profiler.h>
 #include <IO/File.h>
 #include <IO/Directory.h>
 #include <IO/OpenFile.h>
@@ -640,6 +641,7 @@ VruiState::VruiState(Cluster::Multiplexer* sMultiplexer,Cluster::MulticastPipe*
 	 synchFrameTime(0.0),synchWait(false),
 	 numRecentFrameTimes(0),recentFrameTimes(0),nextFrameTimeIndex(0),sortedFrameTimes(0),
 	 animationFrameInterval(1.0/125.0),
+	 saveProfile(false),
 	 activeNavigationTool(0),
 	 updateContinuously(false),synced(false)
 	{
@@ -766,6 +768,9 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	commandDispatcher.addCommandCallback("loadInputGraph",&VruiState::loadInputGraphCommandCallback,this,"<input graph file name>","Loads an input graph file");
 	commandDispatcher.addCommandCallback("saveScreenshot",&VruiState::saveScreenshotCommandCallback,this,"<screenshot file name> [<window index>]","Saves a screenshot from the window of the given index to an image file of the given name");
 	commandDispatcher.addCommandCallback("quit",&VruiState::quitCommandCallback,this,0,"Exits from the application");
+	commandDispatcher.addCommandCallback("startProfiling",&VruiState::startProfilingCommandCallback,this,0,"Starts recording profiling zones");
+	commandDispatcher.addCommandCallback("stopProfiling",&VruiState::stopProfilingCommandCallback,this,0,"Stops recording profiling zones");
+	commandDispatcher.addCommandCallback("saveProfile",&VruiState::saveProfileCommandCallback,this,"[<trace file name>]","Writes all profiling zones recorded since the last save to a trace file in Chrome trace event format");
 	
 	/* Check whether the screen saver should be inhibited: */
 	if(configFileSection.retrieveValue("inhibitScreenSaver",false))
@@ -778,6 +783,18 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 		multiplexer->setPingTimeout(configFileSection.retrieveValue("multipipePingTimeout",10.0),configFileSection.retrieveValue<int>("multipipePingRetries",3));
 		multiplexer->setReceiveWaitTimeout(configFileSection.retrieveValue("multipipeReceiveWaitTimeout",0.01));
 		multiplexer->setBarrierWaitTimeout(configFileSection.retrieveValue("multipipeBarrierWaitTimeout",0.01));
+		multiplexer->setNackTimeout(configFileSection.retrieveValue("multipipeNackTimeout",0.005));
+		multiplexer->setAcknowledgmentInterval(configFileSection.retrieveValue<unsigned int>("multipipeAcknowledgmentInterval",0));
+		multiplexer->setMaxSendRate(configFileSection.retrieveValue("multipipeMaxSendRate",0.0));
+		
+		/* Set the multiplexer's barrier mode for the main pipe and all pipes opened later: */
+		multiplexer->setBarrierTreeFanIn(configFileSection.retrieveValue<unsigned int>("multipipeBarrierTreeFanIn",4));
+		if(configFileSection.retrieveValue("multipipeTreeBarriers",false))
+			{
+			multiplexer->setDefaultBarrierMode(Cluster::Multiplexer::TREE);
+			if(pipe!=0)
+				pipe->setBarrierMode(Cluster::Multiplexer::TREE);
+			}
 		}
 	
 	/* Initialize random number and time management, but don't distribute it in a cluster yet because input device adapters may change it: */
@@ -1203,6 +1220,16 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	
 	/* Initialize the suggested animation frame interval: */
 	configFileSection.updateValue("./animationFrameInterval",animationFrameInterval);
+	
+	/* Initialize the frame profiler: */
+	Threads::Profiler::setBufferSize(configFileSection.retrieveValue<unsigned int>("./profileBufferSize",65536U));
+	profileFileName=configFileSection.retrieveString("./profileFileName","VruiProfile.json");
+	if(configFileSection.retrieveValue<bool>("./profileFrames",false))
+		{
+		/* Start recording profiling zones, and write them to the trace file on shutdown: */
+		Threads::Profiler::setEnabled(true);
+		saveProfile=true;
+		}
 	}
 
 void VruiState::createSystemMenu(void)
@@ -1617,6 +1644,8 @@ void VruiState::prepareMainLoop(void)
 
 void VruiState::update(void)
 	{
+	Threads::Profiler::Zone updateZone("Vrui::update");
+	
 	/*********************************************************************
 	Update the application time and all related state:
 	*********************************************************************/
@@ -1698,6 +1727,8 @@ void VruiState::update(void)
 	Update input device state and distribute all shared state:
 	*********************************************************************/
 	
+	{
+	Threads::Profiler::Zone inputDevicesZone("Vrui::updateInputDevices");
 	int navBroadcastMask=navigationTransformationChangedMask;
 	if(master)
 		{
@@ -1795,6 +1826,7 @@ void VruiState::update(void)
 		
 		pipe->flush();
 		}
+	}
 	
 	#if SAVESHAREDVRUISTATE
 	/* Save shared state to a local file for post-mortem analysis purposes: */
@@ -1831,11 +1863,12 @@ void VruiState::update(void)
 		messageDialogs.removeSmallest();
 		}
 	
-	/* Update the input graph: */
+	/* Update the input graph and the tool manager: */
+	{
+	Threads::Profiler::Zone toolsZone("Vrui::updateTools");
 	inputGraphManager->update();
-	
-	/* Update the tool manager: */
 	toolManager->update();
+	}
 	
 	/* Check if a new input graph needs to be loaded: */
 	if(loadInputGraph)
@@ -1901,18 +1934,25 @@ void VruiState::update(void)
 		listeners[i].update();
 	
 	/* Call the scene graph root's action method: */
+	{
+	Threads::Profiler::Zone sceneGraphZone("Vrui::sceneGraphAct");
 	const SceneGraph::ActState& sceneGraphActState=sceneGraphManager->act(mainViewer->getHeadPosition(),getUpDirection(),lastFrame,lastFrame+animationFrameInterval);
 	
 	/* Schedule another frame if any scene graph node requested one: */
 	if(sceneGraphActState.requireFrame())
 		scheduleUpdate(sceneGraphActState.getNextTime());
+	}
 	
 	/* Call frame functions of all loaded vislets: */
 	if(visletManager!=0)
+		{
+		Threads::Profiler::Zone visletsZone("Vrui::visletFrame");
 		visletManager->frame();
+		}
 	
 	/* Call all additional frame callbacks: */
 	{
+	Threads::Profiler::Zone frameCallbacksZone("Vrui::frameCallbacks");
 	Threads::Mutex::Lock frameCallbacksLock(frameCallbacksMutex);
 	for(std::vector<FrameCallbackSlot>::iterator fcIt=frameCallbacks.begin();fcIt!=frameCallbacks.end();++fcIt)
 		{
@@ -1928,7 +1968,10 @@ void VruiState::update(void)
 	}
 	
 	/* Call frame function: */
+	{
+	Threads::Profiler::Zone applicationZone("Vrui::applicationFrame");
 	frameFunction(frameFunctionData);
+	}
 	
 	/* Finish any pending messages on the main pipe, in case an application didn't clean up: */
 	if(multiplexer!=0)
@@ -1937,6 +1980,8 @@ void VruiState::update(void)
 
 void VruiState::display(DisplayState* displayState,GLContextData& contextData) const
 	{
+	Threads::Profiler::Zone displayZone("Vrui::display");
+	
 	/* Initialize lighting state through the display state's light tracker: */
 	GLLightTracker* lt=contextData.getLightTracker();
 	lt->setLightingEnabled(true);
@@ -2093,6 +2138,35 @@ void VruiState::finishMainLoop(void)
 	
 	/* Deregister the popup callback: */
 	widgetManager->getWidgetPopCallbacks().remove(this,&VruiState::widgetPopCallback);
+	
+	/* Write all recorded profiling zones to the trace file if requested: */
+	if(saveProfile)
+		{
+		try
+			{
+			writeProfile(profileFileName.c_str());
+			}
+		catch(const std::runtime_error& err)
+			{
+			Misc::formattedUserError("Vrui: Unable to write profiling trace due to exception %s",err.what());
+			}
+		}
+	}
+
+void VruiState::writeProfile(const char* traceFileName) const
+	{
+	if(multiplexer!=0)
+		{
+		/* Insert the node index before the trace file name's extension to keep cluster nodes from overwriting each other's traces: */
+		unsigned int nodeIndex=multiplexer->getNodeIndex();
+		const char* extension=Misc::getExtension(traceFileName);
+		std::string nodeTraceFileName(traceFileName,extension);
+		nodeTraceFileName.append(Misc::stringPrintf("-%u",nodeIndex));
+		nodeTraceFileName.append(extension);
+		Threads::Profiler::writeChromeTrace(nodeTraceFileName.c_str(),nodeIndex,Misc::stringPrintf("Vrui node %u",nodeIndex).c_str());
+		}
+	else
+		Threads::Profiler::writeChromeTrace(traceFileName,0,"Vrui");
 	}
 
 void VruiState::showMessageCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData)
@@ -2209,6 +2283,41 @@ void VruiState::quitCommandCallback(const char* argumentBegin,const char* argume
 	shutdown();
 	}
 
+void VruiState::startProfilingCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData)
+	{
+	VruiState* thisPtr=static_cast<VruiState*>(userData);
+	
+	/* Start recording profiling zones, and write them to the trace file on shutdown: */
+	Threads::Profiler::setEnabled(true);
+	thisPtr->saveProfile=true;
+	}
+
+void VruiState::stopProfilingCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData)
+	{
+	/* Stop recording profiling zones; already recorded zones are kept: */
+	Threads::Profiler::setEnabled(false);
+	}
+
+void VruiState::saveProfileCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData)
+	{
+	VruiState* thisPtr=static_cast<VruiState*>(userData);
+	
+	/* Use the configured trace file name if no file name was given: */
+	std::string traceFileName(argumentBegin,argumentEnd);
+	if(traceFileName.empty())
+		traceFileName=thisPtr->profileFileName;
+	try
+		{
+		/* Write all profiling zones recorded since the last save: */
+		thisPtr->writeProfile(traceFileName.c_str());
+		}
+	catch(const std::runtime_error& err)
+		{
+		/* Print an error message: */
+		std::cout<<"saveProfile: Unable to save trace file "<<traceFileName<<" due to exception "<<err.what()<<std::endl;
+		}
+	}
+
 void VruiState::dialogsMenuCallback(GLMotif::Button::SelectCallbackData* cbData,GLMotif::PopupWindow* const& dialog)
 	{
 	/* Check if the dialog is visible or hidden: */
@@ -1,6 +1,6 @@
 /***********************************************************************
 Environment-dependent part of Vrui virtual reality development toolkit.
-Copyright (c) 2000-2025 Oliver Kreylos
+Copyright (c) 2000-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -54,6 +54,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Threads/Thread.h>
 #include <Threads/Mutex.h>
 #include <Threads/Barrier.h>
+#include <Threads/Profiler.h>
 #include <Cluster/Multiplexer.h>
 #include <Cluster/MulticastPipe.h>
 #include <Cluster/ThreadSynchronizer.h>
@@ -446,7 +447,7 @@ void vruiOpenConfigurationFile(const char* userConfigDir,const char* appPath,con
 		systemConfigFileName.append(configFileName);
 		if(vruiVerbose&&vruiMaster)
 			std::cout<<"Vrui: Reading system-wide configuration file "<<systemConfigFileName<<std::endl;
-		vruiConfigFile=new Misc::ConfigurationFile(systemConfigFileName.c_str());
+		vruiConfigFile=new Misc::ConfigurationFile(systemConfigFileName.c_str(),getenv("VRUI_CONFIGCACHEDIR"));
 		}
 	catch(const std::runtime_error& err)
 		{
@@ -706,6 +707,8 @@ bool vruiCreateWindowGroup(const VruiWindowGroupCreator& group,const std::string
 
 void vruiDrawWindowGroup(VruiWindowGroup& windowGroup)
 	{
+	Threads::Profiler::Zone zone("Vrui::drawWindowGroup");
+	
 	/* Initialize the group's display state object: */
 	windowGroup.displayState->maxViewportSize=windowGroup.maxViewportSize;
 	windowGroup.displayState->maxFrameSize=windowGroup.maxFrameSize;
@@ -724,11 +727,15 @@ void vruiDrawWindowGroup(VruiWindowGroup& windowGroup)
 	}
 	
 	/* Draw the first window: */
+	{
+	Threads::Profiler::Zone windowZone("Vrui::drawWindow");
 	wIt->window->draw();
+	}
 	
 	/* Draw all remaining windows: */
 	for(++wIt;wIt!=windowGroup.windows.end();++wIt)
 		{
+		Threads::Profiler::Zone windowZone("Vrui::drawWindow");
 		wIt->window->makeCurrent();
 		wIt->window->draw();
 		}
@@ -737,6 +744,32 @@ void vruiDrawWindowGroup(VruiWindowGroup& windowGroup)
 	glFlush();
 	}
 
+void vruiWaitComplete(VRWindow* window)
+	{
+	Threads::Profiler::Zone zone("Vrui::waitComplete");
+	
+	/* Wait until the window is done rendering: */
+	window->makeCurrent();
+	window->waitComplete();
+	}
+
+void vruiPresent(VRWindow* window)
+	{
+	Threads::Profiler::Zone zone("Vrui::present");
+	
+	/* Present the window's rendering results: */
+	window->makeCurrent();
+	window->present();
+	}
+
+void vruiWaitRenderingBarrier(void)
+	{
+	Threads::Profiler::Zone zone("Vrui::renderingBarrier");
+	
+	/* Wait until all rendering threads and the main thread reach the barrier: */
+	vruiRenderingBarrier.synchronize();
+	}
+
 void* vruiRenderingThreadFunction(int windowGroupIndex)
 	{
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
@@ -745,6 +778,11 @@ void* vruiRenderingThreadFunction(int windowGroupIndex)
 	if(vruiVerbose)
 		std::cout<<"Vrui: Started rendering thread for window group "<<windowGroupIndex<<std::endl;
 	
+	/* Name the rendering thread for profiling: */
+	char threadName[64];
+	snprintf(threadName,sizeof(threadName),"Vrui rendering thread %d",windowGroupIndex);
+	Threads::Profiler::setThreadName(threadName);
+	
 	int numBarriers=0;
 	try
 		{
@@ -757,7 +795,7 @@ void* vruiRenderingThreadFunction(int windowGroupIndex)
 		while(true)
 			{
 			/* Wait for the start of the rendering cycle: */
-			vruiRenderingBarrier.synchronize();
+			vruiWaitRenderingBarrier();
 			
 			/* Check for shutdown: */
 			if(vruiStopRenderingThreads)
@@ -770,31 +808,25 @@ void* vruiRenderingThreadFunction(int windowGroupIndex)
 			
 			/* Wait until all windows are done rendering: */
 			for(std::vector<VruiWindowGroup::Window>::iterator wIt=windowGroup.windows.begin();wIt!=windowGroup.windows.end();++wIt)
-				{
-				wIt->window->makeCurrent();
-				wIt->window->waitComplete();
-				}
+				vruiWaitComplete(wIt->window);
 			
 			/* Wait until all other threads are done rendering: */
-			vruiRenderingBarrier.synchronize();
+			vruiWaitRenderingBarrier();
 			
 			if(vruiState->multiplexer)
 				{
 				/* Wait until all other nodes are done rendering: */
-				vruiRenderingBarrier.synchronize();
+				vruiWaitRenderingBarrier();
 				}
 			
 			numBarriers=1;
 			
 			/* Present all windows' rendering results: */
 			for(std::vector<VruiWindowGroup::Window>::iterator wIt=windowGroup.windows.begin();wIt!=windowGroup.windows.end();++wIt)
-				{
-				wIt->window->makeCurrent();
-				wIt->window->present();
-				}
+				vruiPresent(wIt->window);
 			
 			/* Wait until all threads are done presenting rendering results: */
-			vruiRenderingBarrier.synchronize();
+			vruiWaitRenderingBarrier();
 			}
 		}
 	catch(const std::runtime_error& err)
@@ -2028,6 +2060,7 @@ void vruiInnerLoopMultiWindow(void)
 		if(firstFrame||vruiState->updateContinuously)
 			{
 			/* Check for and handle events without blocking: */
+			Threads::Profiler::Zone eventsZone("Vrui::handleEvents");
 			vruiHandleAllEvents(false);
 			}
 		else
@@ -2052,6 +2085,9 @@ void vruiInnerLoopMultiWindow(void)
 			break;
 			}
 		
+		/* Record the rest of the frame, from updating to presenting: */
+		Threads::Profiler::Zone frameZone("Vrui::frame");
+		
 		/* Update the Vrui state: */
 		vruiState->update();
 		
@@ -2061,7 +2097,10 @@ void vruiInnerLoopMultiWindow(void)
 		#if ALSUPPORT_CONFIG_HAVE_OPENAL
 		/* Update all sound contexts: */
 		for(int i=0;i<vruiNumSoundContexts;++i)
+			{
+			Threads::Profiler::Zone soundZone("Vrui::drawSound");
 			vruiSoundContexts[i]->draw();
+			}
 		#endif
 		
 		#if VRUI_INSTRUMENT_MAINLOOP
@@ -2076,10 +2115,10 @@ void vruiInnerLoopMultiWindow(void)
 			if(vruiRenderInParallel)
 				{
 				/* Start the rendering cycle by synchronizing with the render threads: */
-				vruiRenderingBarrier.synchronize();
+				vruiWaitRenderingBarrier();
 				
 				/* Wait until all threads are done rendering: */
-				vruiRenderingBarrier.synchronize();
+				vruiWaitRenderingBarrier();
 				
 				if(vruiState->multiplexer!=0)
 					{
@@ -2091,11 +2130,11 @@ void vruiInnerLoopMultiWindow(void)
 					#endif
 					
 					/* Notify the render threads to swap buffers: */
-					vruiRenderingBarrier.synchronize();
+					vruiWaitRenderingBarrier();
 					}
 				
 				/* Wait until all threads are done swapping buffers: */
-				vruiRenderingBarrier.synchronize();
+				vruiWaitRenderingBarrier();
 				
 				#if VRUI_INSTRUMENT_MAINLOOP
 				vruiPrintTime(true);
@@ -2110,10 +2149,7 @@ void vruiInnerLoopMultiWindow(void)
 				/* Wait for all windows in all window groups to finish rendering: */
 				for(int i=0;i<vruiNumWindowGroups;++i)
 					for(std::vector<VruiWindowGroup::Window>::iterator wgIt=vruiWindowGroups[i].windows.begin();wgIt!=vruiWindowGroups[i].windows.end();++wgIt)
-						{
-						wgIt->window->makeCurrent();
-						wgIt->window->waitComplete();
-						}
+						vruiWaitComplete(wgIt->window);
 				
 				/* Wait until all other nodes in a cluster are finished rendering: */
 				if(vruiState->multiplexer!=0)
@@ -2126,10 +2162,7 @@ void vruiInnerLoopMultiWindow(void)
 				/* Present the rendering results of all windows in all window groups at once: */
 				for(int i=0;i<vruiNumWindowGroups;++i)
 					for(std::vector<VruiWindowGroup::Window>::iterator wgIt=vruiWindowGroups[i].windows.begin();wgIt!=vruiWindowGroups[i].windows.end();++wgIt)
-						{
-						wgIt->window->makeCurrent();
-						wgIt->window->present();
-						}
+						vruiPresent(wgIt->window);
 				
 				#if VRUI_INSTRUMENT_MAINLOOP
 				vruiPrintTime(true);
@@ -2143,10 +2176,7 @@ void vruiInnerLoopMultiWindow(void)
 			
 			/* Wait for all windows to finish rendering: */
 			for(int i=0;i<vruiNumWindows;++i)
-				{
-				vruiWindows[i]->makeCurrent();
-				vruiWindows[i]->waitComplete();
-				}
+				vruiWaitComplete(vruiWindows[i]);
 			
 			/* Wait until all other nodes in a cluster are finished rendering: */
 			if(vruiState->multiplexer!=0)
@@ -2158,10 +2188,7 @@ void vruiInnerLoopMultiWindow(void)
 			
 			/* Present the rendering results of all windows at once: */
 			for(int i=0;i<vruiNumWindows;++i)
-				{
-				vruiWindows[i]->makeCurrent();
-				vruiWindows[i]->present();
-				}
+				vruiPresent(vruiWindows[i]);
 			
 			#if VRUI_INSTRUMENT_MAINLOOP
 			vruiPrintTime(true);
@@ -2219,6 +2246,7 @@ void vruiInnerLoopSingleWindow(void)
 		if(firstFrame||vruiState->updateContinuously)
 			{
 			/* Check for and handle events without blocking: */
+			Threads::Profiler::Zone eventsZone("Vrui::handleEvents");
 			vruiHandleAllEvents(false);
 			}
 		else
@@ -2243,6 +2271,9 @@ void vruiInnerLoopSingleWindow(void)
 			break;
 			}
 		
+		/* Record the rest of the frame, from updating to presenting: */
+		Threads::Profiler::Zone frameZone("Vrui::frame");
+		
 		/* Update the Vrui state: */
 		vruiState->update();
 		
@@ -2252,7 +2283,10 @@ void vruiInnerLoopSingleWindow(void)
 		#if ALSUPPORT_CONFIG_HAVE_OPENAL
 		/* Update all sound contexts: */
 		for(int i=0;i<vruiNumSoundContexts;++i)
+			{
+			Threads::Profiler::Zone soundZone("Vrui::drawSound");
 			vruiSoundContexts[i]->draw();
+			}
 		#endif
 		
 		#if VRUI_INSTRUMENT_MAINLOOP
@@ -2266,7 +2300,10 @@ void vruiInnerLoopSingleWindow(void)
 		vruiDrawWindowGroup(vruiWindowGroups[0]);
 		
 		/* Wait for the only window to finish rendering: */
+		{
+		Threads::Profiler::Zone waitZone("Vrui::waitComplete");
 		vruiWindows[0]->waitComplete();
+		}
 		
 		/* Wait until all other nodes in a cluster are finished rendering: */
 		if(vruiState->multiplexer!=0)
@@ -2277,7 +2314,10 @@ void vruiInnerLoopSingleWindow(void)
 		#endif
 		
 		/* Present the rendering results of the only window: */
+		{
+		Threads::Profiler::Zone presentZone("Vrui::present");
 		vruiWindows[0]->present();
+		}
 		
 		#if VRUI_INSTRUMENT_MAINLOOP
 		vruiPrintTime(true);
@@ -2303,6 +2343,9 @@ void mainLoop(void)
 		return;
 		}
 	
+	/* Name the main thread for profiling: */
+	Threads::Profiler::setThreadName("Vrui main thread");
+	
 	/* Start the display subsystem: */
 	startDisplay();
 	
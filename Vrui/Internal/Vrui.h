@@ -1,7 +1,7 @@
 /***********************************************************************
 Internal kernel interface of the Vrui virtual reality development
 toolkit.
-Copyright (c) 2000-2025 Oliver Kreylos
+Copyright (c) 2000-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -362,6 +362,8 @@ struct VruiState
 	double* sortedFrameTimes; // Helper array to calculate median of frame times
 	double currentFrameTime; // Current frame time average
 	double animationFrameInterval; // Suggested frame interval to be used for animations
+	std::string profileFileName; // Name of the trace file to which recorded profiling zones are written on shutdown
+	bool saveProfile; // Flag whether recorded profiling zones are written to the trace file on shutdown
 	Threads::Mutex frameCallbacksMutex; // Mutex protecting the list of extra frame callbacks
 	std::vector<FrameCallbackSlot> frameCallbacks; // List of extra frame callbacks
 	Misc::CallbackList preRenderingCallbacks; // List of callbacks called for each window group before anything is rendered
@@ -414,6 +416,9 @@ struct VruiState
 	/* De-initialization methods: */
 	void finishMainLoop(void); // Performs first steps of shutdown after mainloop finishes
 	
+	/* Profiling methods: */
+	void writeProfile(const char* traceFileName) const; // Writes all profiling zones recorded since the last call to a trace file of the given base name
+	
 	/* Pipe command callback methods: */
 	static void listCommandsCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
 	static void showMessageCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
@@ -423,6 +428,9 @@ struct VruiState
 	static void loadInputGraphCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
 	static void saveScreenshotCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
 	static void quitCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
+	static void startProfilingCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
+	static void stopProfilingCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
+	static void saveProfileCommandCallback(const char* argumentBegin,const char* argumentEnd,void* userData);
 	
 	/* System menu callback methods: */
 	void dialogsMenuCallback(GLMotif::Button::SelectCallbackData* cbData,GLMotif::PopupWindow* const& dialog);
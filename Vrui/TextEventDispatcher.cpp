@@ -1,7 +1,7 @@
 /***********************************************************************
 TextEventDispatcher - Class to centralize management and serialization
 of GLMotif text and text control events.
-Copyright (c) 2014-2020 Oliver Kreylos
+Copyright (c) 2014-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -112,6 +112,26 @@ void TextEventDispatcher::readEventQueues(IO::File& file)
 	nextEventOrdinal=newNextEventOrdinal;
 	}
 
+void TextEventDispatcher::skipEventQueues(IO::File& file)
+	{
+	/* Skip all saved text events: */
+	unsigned int numTextEvents=(unsigned int)(Misc::readVarInt32(file));
+	for(unsigned int i=0;i<numTextEvents;++i)
+		{
+		Misc::readVarInt32(file);
+		unsigned int stringLen=(unsigned int)(Misc::readVarInt32(file));
+		file.skip<char>(stringLen);
+		}
+	
+	/* Skip all saved text control events: */
+	unsigned int numTextControlEvents=(unsigned int)(Misc::readVarInt32(file));
+	for(unsigned int i=0;i<numTextControlEvents;++i)
+		{
+		Misc::readVarInt32(file);
+		file.skip<Misc::UInt8>(2);
+		}
+	}
+
 void TextEventDispatcher::dispatchEvents(GLMotif::WidgetManager& widgetManager)
 	{
 	/* Merge the queues of text and text control events by ordinal number: */
@@ -1,7 +1,7 @@
 /***********************************************************************
 TextEventDispatcher - Class to centralize management and serialization
 of GLMotif text and text control events.
-Copyright (c) 2014 Oliver Kreylos
+Copyright (c) 2014-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -135,6 +135,7 @@ class TextEventDispatcher
 		}
 	void writeEventQueues(IO::File& file) const; // Writes the current event queues to the given file
 	void readEventQueues(IO::File& file); // Enqueues all events previously written to the given file
+	static void skipEventQueues(IO::File& file); // Skips all events previously written to the given file without enqueueing them
 	void dispatchEvents(GLMotif::WidgetManager& widgetManager); // Dispatches all enqueued events to the given GLMotif widget manager and re-initializes the queues
 	};
 
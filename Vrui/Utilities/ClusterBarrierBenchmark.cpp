@@ -0,0 +1,358 @@
+/***********************************************************************
+ClusterBarrierBenchmark - Loopback harness measuring the latency of
+central and tree barriers on Cluster::Multiplexer pipes for clusters of
+4 to 128 slave processes on the local host, and checking that the
+master rejects slaves using an incompatible connection protocol.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Threads/Thread.h>
+#include <Cluster/Packet.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+
+namespace {
+
+/*********************************************************************
+Helper class to forward datagrams sent by the master to the slaves'
+individual ports on the local host, as all slaves cannot bind the same
+port:
+*********************************************************************/
+
+class FanoutRelay
+	{
+	/* Elements: */
+	private:
+	int socketFd; // UDP socket receiving the master's datagrams
+	std::vector<sockaddr_in> slaveAddresses; // Addresses of the slaves' communication sockets
+	Threads::Thread thread; // The relay thread
+	
+	/* Private methods: */
+	void* threadMethod(void)
+		{
+		Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
+		Threads::Thread::setCancelType(Threads::Thread::CANCEL_DEFERRED);
+		
+		char buffer[Cluster::Packet::maxRawPacketSize];
+		while(true)
+			{
+			ssize_t numBytesReceived=recv(socketFd,buffer,sizeof(buffer),0);
+			if(numBytesReceived<0)
+				continue;
+			for(std::vector<sockaddr_in>::iterator saIt=slaveAddresses.begin();saIt!=slaveAddresses.end();++saIt)
+				sendto(socketFd,buffer,numBytesReceived,0,(const sockaddr*)&*saIt,sizeof(sockaddr_in));
+			}
+		
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FanoutRelay(int relayPort,int slaveBasePort,unsigned int numSlaves)
+		:socketFd(socket(PF_INET,SOCK_DGRAM,0))
+		{
+		if(socketFd<0)
+			throw std::runtime_error("FanoutRelay: Unable to create socket");
+		
+		/* Bind the socket to the relay port on the loopback interface: */
+		sockaddr_in socketAddress;
+		memset(&socketAddress,0,sizeof(sockaddr_in));
+		socketAddress.sin_family=AF_INET;
+		socketAddress.sin_port=htons(relayPort);
+		socketAddress.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+		if(bind(socketFd,(struct sockaddr*)&socketAddress,sizeof(sockaddr_in))==-1)
+			{
+			close(socketFd);
+			throw std::runtime_error("FanoutRelay: Unable to bind socket");
+			}
+		
+		/* Increase the send buffer size to hold one round of messages to all slaves: */
+		int sendBufferSize=int(numSlaves)*4096;
+		setsockopt(socketFd,SOL_SOCKET,SO_SNDBUF,&sendBufferSize,sizeof(int));
+		
+		/* Store the slaves' addresses: */
+		for(unsigned int i=0;i<numSlaves;++i)
+			{
+			socketAddress.sin_port=htons(slaveBasePort+i);
+			slaveAddresses.push_back(socketAddress);
+			}
+		
+		thread.start(this,&FanoutRelay::threadMethod);
+		}
+	~FanoutRelay(void)
+		{
+		thread.cancel();
+		thread.join();
+		close(socketFd);
+		}
+	};
+
+/* Benchmark parameters shared by the master and all slaves: */
+struct Parameters
+	{
+	/* Elements: */
+	public:
+	unsigned int numSlaves; // Number of slave processes
+	int masterPort; // Port of the master's communication socket
+	int relayPort; // Port of the fan-out relay
+	int slaveBasePort; // Port of the first slave's communication socket
+	unsigned int numBarriers; // Number of barriers to time in each barrier mode
+	};
+
+/* Creates and configures a multiplexer for the given node with the same settings Vrui uses by default: */
+Cluster::Multiplexer* createMultiplexer(const Parameters& p,unsigned int nodeIndex)
+	{
+	int slavePort=nodeIndex==0?p.relayPort:p.slaveBasePort+int(nodeIndex)-1;
+	Cluster::Multiplexer* multiplexer=new Cluster::Multiplexer(p.numSlaves,nodeIndex,"127.0.0.1",p.masterPort,"127.0.0.1",slavePort);
+	multiplexer->setConnectionWaitTimeout(0.1);
+	multiplexer->setPingTimeout(10.0,3);
+	multiplexer->setReceiveWaitTimeout(0.01);
+	multiplexer->setBarrierWaitTimeout(0.01);
+	multiplexer->setNackTimeout(0.005);
+	multiplexer->setBarrierTreeFanIn(4);
+	return multiplexer;
+	}
+
+/* Runs the timed barriers in both barrier modes on the given pipe; returns the sorted barrier latencies of both modes on the master: */
+void runBarriers(Cluster::MulticastPipe& pipe,unsigned int numBarriers,std::vector<double> latencies[2])
+	{
+	for(int mode=0;mode<2;++mode)
+		{
+		/* Switch the barrier mode between two barriers on all nodes: */
+		pipe.barrier();
+		pipe.setBarrierMode(mode==0?Cluster::Multiplexer::CENTRAL:Cluster::Multiplexer::TREE);
+		pipe.barrier();
+		
+		for(unsigned int i=0;i<numBarriers;++i)
+			{
+			Realtime::TimePointMonotonic start;
+			pipe.barrier();
+			latencies[mode].push_back(double(start.setAndDiff()));
+			}
+		std::sort(latencies[mode].begin(),latencies[mode].end());
+		}
+	}
+
+/* Runs the master node and the given number of slaves and prints barrier latencies; returns false if any slave failed: */
+bool runSession(const Parameters& p)
+	{
+	/* Fork the slave processes: */
+	std::vector<pid_t> slaves;
+	for(unsigned int nodeIndex=1;nodeIndex<=p.numSlaves;++nodeIndex)
+		{
+		pid_t pid=fork();
+		if(pid==0)
+			{
+			bool ok=false;
+			try
+				{
+				Cluster::Multiplexer* multiplexer=createMultiplexer(p,nodeIndex);
+				multiplexer->waitForConnection();
+				{
+				Cluster::MulticastPipe pipe(multiplexer);
+				std::vector<double> latencies[2];
+				runBarriers(pipe,p.numBarriers,latencies);
+				pipe.barrier();
+				}
+				delete multiplexer;
+				ok=true;
+				}
+			catch(const std::runtime_error& err)
+				{
+				fprintf(stderr,"Slave %u: Terminated due to exception %s\n",nodeIndex,err.what());
+				}
+			_exit(ok?0:1);
+			}
+		else if(pid>0)
+			slaves.push_back(pid);
+		else
+			throw std::runtime_error("Unable to fork slave process");
+		}
+	
+	bool ok=true;
+	{
+	/* Create the relay and the master's multiplexer and pipe: */
+	FanoutRelay relay(p.relayPort,p.slaveBasePort,p.numSlaves);
+	Cluster::Multiplexer* multiplexer=createMultiplexer(p,0);
+	multiplexer->waitForConnection();
+	{
+	Cluster::MulticastPipe pipe(multiplexer);
+	std::vector<double> latencies[2];
+	runBarriers(pipe,p.numBarriers,latencies);
+	pipe.barrier();
+	
+	/* Print the median and 99th percentile latencies of both barrier modes: */
+	std::cout<<std::setw(7)<<p.numSlaves;
+	for(int mode=0;mode<2;++mode)
+		{
+		const std::vector<double>& l=latencies[mode];
+		std::cout<<std::setw(12)<<l[l.size()/2]*1.0e6<<std::setw(12)<<l[(l.size()*99)/100]*1.0e6;
+		}
+	std::cout<<std::endl;
+	}
+	
+	/* Collect the slaves' results before shutting down the master, which might still have to answer retransmitted barrier messages: */
+	for(std::vector<pid_t>::iterator sIt=slaves.begin();sIt!=slaves.end();++sIt)
+		{
+		int status;
+		if(waitpid(*sIt,&status,0)!=*sIt||!WIFEXITED(status)||WEXITSTATUS(status)!=0)
+			ok=false;
+		}
+	delete multiplexer;
+	}
+	
+	return ok;
+	}
+
+/* Returns true if a master rejects a slave sending a connection message of an older protocol version instead of waiting for it forever: */
+bool checkVersionMismatch(const Parameters& p)
+	{
+	/* Fork a process impersonating an old slave that sends connection messages without a barrier tree port number: */
+	pid_t pid=fork();
+	if(pid==0)
+		{
+		int fd=socket(PF_INET,SOCK_DGRAM,0);
+		sockaddr_in masterAddress;
+		memset(&masterAddress,0,sizeof(sockaddr_in));
+		masterAddress.sin_family=AF_INET;
+		masterAddress.sin_port=htons(p.masterPort);
+		masterAddress.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+		unsigned int msg[2]={1U|0x80000000U,0U}; // Node index of first slave and CONNECTION message ID
+		for(int i=0;i<100;++i)
+			{
+			sendto(fd,msg,sizeof(msg),0,(const sockaddr*)&masterAddress,sizeof(sockaddr_in));
+			usleep(100000);
+			}
+		_exit(0);
+		}
+	else if(pid<0)
+		throw std::runtime_error("Unable to fork slave process");
+	
+	bool rejected=false;
+	Parameters p1=p;
+	p1.numSlaves=1;
+	Cluster::Multiplexer* multiplexer=createMultiplexer(p1,0);
+	try
+		{
+		multiplexer->waitForConnection();
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cout<<"Master rejected old slave: "<<err.what()<<std::endl;
+		rejected=true;
+		}
+	delete multiplexer;
+	
+	kill(pid,SIGTERM);
+	waitpid(pid,0,0);
+	return rejected;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Parameters p;
+	p.masterPort=26200;
+	p.relayPort=26201;
+	p.slaveBasePort=26210;
+	p.numBarriers=200;
+	unsigned int minSlaves=4;
+	unsigned int maxSlaves=128;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"minSlaves")==0&&i+1<argc)
+				minSlaves=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"maxSlaves")==0&&i+1<argc)
+				maxSlaves=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"barriers")==0&&i+1<argc)
+				p.numBarriers=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"port")==0&&i+1<argc)
+				{
+				p.masterPort=atoi(argv[++i]);
+				p.relayPort=p.masterPort+1;
+				p.slaveBasePort=p.masterPort+10;
+				}
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(minSlaves<1)
+		minSlaves=1;
+	if(p.numBarriers<1)
+		p.numBarriers=1;
+	
+	bool passed=true;
+	try
+		{
+		/* Check that the master detects slaves using an incompatible protocol version: */
+		if(!checkVersionMismatch(p))
+			{
+			std::cout<<"Master did not reject a slave using an incompatible protocol version"<<std::endl;
+			passed=false;
+			}
+		
+		/* Measure barrier latencies for increasing cluster sizes: */
+		std::cout<<"Barrier latency over loopback in us, "<<p.numBarriers<<" barriers per mode"<<std::endl;
+		std::cout<<std::setw(7)<<"Slaves"<<std::setw(24)<<"Central median/99%"<<std::setw(24)<<"Tree median/99%"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		for(unsigned int numSlaves=minSlaves;numSlaves<=maxSlaves;numSlaves*=2)
+			{
+			p.numSlaves=numSlaves;
+			if(!runSession(p))
+				{
+				std::cout<<"At least one of "<<numSlaves<<" slaves terminated abnormally"<<std::endl;
+				passed=false;
+				}
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	if(passed)
+		std::cout<<"PASSED"<<std::endl;
+	else
+		std::cout<<"FAILED"<<std::endl;
+	return passed?0:1;
+	}
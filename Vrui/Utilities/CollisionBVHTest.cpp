@@ -0,0 +1,389 @@
+/***********************************************************************
+CollisionBVHTest - Utility to verify that sphere collision queries
+against large indexed face sets, which cull faces using a bounding
+volume hierarchy, return bit-for-bit the same results as testing all
+faces, also when run from several threads concurrently, and to compare
+the performance of both methods.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Threads/Thread.h>
+#include <SceneGraph/Geometry.h>
+#include <SceneGraph/CollisionBVH.h>
+#include <SceneGraph/SphereCollisionQuery.h>
+#include <SceneGraph/CoordinateNode.h>
+#include <SceneGraph/IndexedFaceSetNode.h>
+
+namespace {
+
+/* Returns a uniformly distributed random number in the given range: */
+inline SceneGraph::Scalar random(SceneGraph::Scalar min,SceneGraph::Scalar max)
+	{
+	return min+(max-min)*SceneGraph::Scalar(rand())/SceneGraph::Scalar(RAND_MAX);
+	}
+
+/* Creates a jittered height field of the given size, made of randomly split or unsplit quads and some invalid faces: */
+void createGrid(int gridSize,SceneGraph::MFPoint::ValueList& points,SceneGraph::MFInt::ValueList& coordIndices)
+	{
+	for(int y=0;y<=gridSize;++y)
+		for(int x=0;x<=gridSize;++x)
+			points.push_back(SceneGraph::Point(SceneGraph::Scalar(x)+random(-0.3f,0.3f),SceneGraph::Scalar(y)+random(-0.3f,0.3f),random(-0.5f,0.5f)));
+	for(int y=0;y<gridSize;++y)
+		for(int x=0;x<gridSize;++x)
+			{
+			int v0=y*(gridSize+1)+x;
+			int v1=v0+1;
+			int v2=v1+gridSize+1;
+			int v3=v0+gridSize+1;
+			switch(rand()%8)
+				{
+				case 0: // Unsplit quad
+					coordIndices.push_back(v0);
+					coordIndices.push_back(v1);
+					coordIndices.push_back(v2);
+					coordIndices.push_back(v3);
+					coordIndices.push_back(-1);
+					break;
+				
+				case 1: // Invalid face followed by an unsplit quad
+					coordIndices.push_back(v0);
+					coordIndices.push_back(v1);
+					coordIndices.push_back(-1);
+					coordIndices.push_back(v0);
+					coordIndices.push_back(v1);
+					coordIndices.push_back(v2);
+					coordIndices.push_back(v3);
+					coordIndices.push_back(-1);
+					break;
+				
+				default: // Two triangles
+					coordIndices.push_back(v0);
+					coordIndices.push_back(v1);
+					coordIndices.push_back(v2);
+					coordIndices.push_back(-1);
+					coordIndices.push_back(v0);
+					coordIndices.push_back(v2);
+					coordIndices.push_back(v3);
+					coordIndices.push_back(-1);
+				}
+			}
+	}
+
+/* Creates a soup of small random triangles and pentagons filling a cube of the given size: */
+void createSoup(int numFaces,SceneGraph::Scalar size,SceneGraph::MFPoint::ValueList& points,SceneGraph::MFInt::ValueList& coordIndices)
+	{
+	for(int i=0;i<numFaces;++i)
+		{
+		SceneGraph::Point center(random(0,size),random(0,size),random(0,size));
+		int numVertices=rand()%4==0?5:3;
+		for(int j=0;j<numVertices;++j)
+			{
+			coordIndices.push_back(int(points.size()));
+			points.push_back(center+SceneGraph::Vector(random(-0.5f,0.5f),random(-0.5f,0.5f),random(-0.5f,0.5f)));
+			}
+		coordIndices.push_back(-1);
+		}
+	}
+
+/* Appends two guard points far outside the given point set's bounding box: */
+void addGuardPoints(SceneGraph::MFPoint::ValueList& points)
+	{
+	SceneGraph::Box box=SceneGraph::Box::empty;
+	for(SceneGraph::MFPoint::ValueList::iterator pIt=points.begin();pIt!=points.end();++pIt)
+		box.addPoint(*pIt);
+	SceneGraph::Vector size=box.max-box.min;
+	points.push_back(box.min-size);
+	points.push_back(box.max+size);
+	}
+
+/* Creates a face set with the given geometry and mode: */
+SceneGraph::IndexedFaceSetNodePointer createFaceSet(SceneGraph::CoordinateNode* coord,const SceneGraph::MFInt::ValueList& coordIndices,bool solid,bool ccw)
+	{
+	SceneGraph::IndexedFaceSetNodePointer faceSet=new SceneGraph::IndexedFaceSetNode;
+	faceSet->coord.setValue(coord);
+	faceSet->coordIndex.getValues()=coordIndices;
+	
+	/* Add an invalid face between the guard points to extend the face set's bounding box, such that whole face sets are never culled and only the per-face results are compared: */
+	int numPoints=int(coord->point.getValues().size());
+	faceSet->coordIndex.appendValue(numPoints-2);
+	faceSet->coordIndex.appendValue(numPoints-1);
+	faceSet->coordIndex.appendValue(-1);
+	faceSet->solid.setValue(solid);
+	faceSet->ccw.setValue(ccw);
+	faceSet->update();
+	return faceSet;
+	}
+
+/* Splits the given face set into chunks of faces too small to use a collision hierarchy: */
+void createChunks(SceneGraph::CoordinateNode* coord,const SceneGraph::MFInt::ValueList& coordIndices,bool solid,bool ccw,std::vector<SceneGraph::IndexedFaceSetNodePointer>& chunks)
+	{
+	unsigned int maxChunkSize=SceneGraph::CollisionBVH::maxLeafSize*4;
+	SceneGraph::MFInt::ValueList chunkIndices;
+	unsigned int chunkSize=0;
+	for(SceneGraph::MFInt::ValueList::const_iterator ciIt=coordIndices.begin();ciIt!=coordIndices.end();++ciIt)
+		{
+		chunkIndices.push_back(*ciIt);
+		if(*ciIt<0&&++chunkSize==maxChunkSize)
+			{
+			chunks.push_back(createFaceSet(coord,chunkIndices,solid,ccw));
+			chunkIndices.clear();
+			chunkSize=0;
+			}
+		}
+	if(!chunkIndices.empty())
+		chunks.push_back(createFaceSet(coord,chunkIndices,solid,ccw));
+	}
+
+/* Structure holding a query and its result: */
+struct Query
+	{
+	/* Elements: */
+	public:
+	SceneGraph::Point c0; // Initial sphere center
+	SceneGraph::Vector c0c1; // Sphere movement vector
+	SceneGraph::Scalar radius; // Sphere radius
+	SceneGraph::Scalar hitLambda; // Resulting hit parameter
+	SceneGraph::Vector hitNormal; // Resulting hit normal
+	
+	/* Methods: */
+	void setResult(const SceneGraph::SphereCollisionQuery& query)
+		{
+		hitLambda=query.getHitLambda();
+		hitNormal=query.isHit()?query.getHitNormal():SceneGraph::Vector::zero;
+		}
+	bool equals(const Query& other) const // Returns true if the other query has bit-for-bit the same result
+		{
+		return memcmp(&hitLambda,&other.hitLambda,sizeof(SceneGraph::Scalar))==0&&memcmp(hitNormal.getComponents(),other.hitNormal.getComponents(),3*sizeof(SceneGraph::Scalar))==0;
+		}
+	};
+
+/* Runs the given queries against the given face set and stores the results: */
+void runQueries(const SceneGraph::IndexedFaceSetNode& faceSet,std::vector<Query>& queries)
+	{
+	for(std::vector<Query>::iterator qIt=queries.begin();qIt!=queries.end();++qIt)
+		{
+		SceneGraph::SphereCollisionQuery query(qIt->c0,qIt->c0c1,qIt->radius);
+		faceSet.testCollision(query);
+		qIt->setResult(query);
+		}
+	}
+
+/* Runs the given queries against the given sequence of face sets and stores the results: */
+void runQueries(const std::vector<SceneGraph::IndexedFaceSetNodePointer>& chunks,std::vector<Query>& queries)
+	{
+	for(std::vector<Query>::iterator qIt=queries.begin();qIt!=queries.end();++qIt)
+		{
+		SceneGraph::SphereCollisionQuery query(qIt->c0,qIt->c0c1,qIt->radius);
+		for(std::vector<SceneGraph::IndexedFaceSetNodePointer>::const_iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+			(*cIt)->testCollision(query);
+		qIt->setResult(query);
+		}
+	}
+
+/***********************************************************
+Helper class to run queries against a face set in a thread:
+***********************************************************/
+
+class QueryThread
+	{
+	/* Elements: */
+	private:
+	const SceneGraph::IndexedFaceSetNode& faceSet; // Face set to query
+	std::vector<Query> queries; // The thread's private copy of the queries
+	Threads::Thread thread; // The query thread
+	
+	/* Private methods: */
+	void* threadMethod(void)
+		{
+		runQueries(faceSet,queries);
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	QueryThread(const SceneGraph::IndexedFaceSetNode& sFaceSet,const std::vector<Query>& sQueries)
+		:faceSet(sFaceSet),queries(sQueries)
+		{
+		thread.start(this,&QueryThread::threadMethod);
+		}
+	
+	/* Methods: */
+	const std::vector<Query>& join(void) // Waits for the thread to finish and returns the query results
+		{
+		thread.join();
+		return queries;
+		}
+	};
+
+/* Returns the number of queries whose results differ between the two given arrays: */
+unsigned int countMismatches(const std::vector<Query>& queries0,const std::vector<Query>& queries1)
+	{
+	unsigned int result=0;
+	for(size_t i=0;i<queries0.size();++i)
+		if(!queries0[i].equals(queries1[i]))
+			++result;
+	return result;
+	}
+
+/* Tests the given geometry in all three face set modes; returns true if all results match: */
+bool testMesh(const char* meshName,SceneGraph::CoordinateNode* coord,const SceneGraph::MFInt::ValueList& coordIndices,std::vector<Query>& queries,unsigned int numThreads)
+	{
+	bool passed=true;
+	static const char* modeNames[3]={"solid ccw","solid cw","non-solid"};
+	for(int mode=0;mode<3;++mode)
+		{
+		bool solid=mode<2;
+		bool ccw=mode!=1;
+		
+		/* Create the face set and the brute-force chunks: */
+		SceneGraph::IndexedFaceSetNodePointer faceSet=createFaceSet(coord,coordIndices,solid,ccw);
+		std::vector<SceneGraph::IndexedFaceSetNodePointer> chunks;
+		createChunks(coord,coordIndices,solid,ccw,chunks);
+		
+		/* Run the queries both ways: */
+		std::vector<Query> bruteForce=queries;
+		Realtime::TimePointMonotonic start;
+		runQueries(chunks,bruteForce);
+		double bruteForceTime(start.setAndDiff());
+		std::vector<Query> culled=queries;
+		runQueries(*faceSet,culled);
+		double culledTime(start.setAndDiff());
+		
+		unsigned int numHits=0;
+		for(std::vector<Query>::iterator qIt=bruteForce.begin();qIt!=bruteForce.end();++qIt)
+			if(qIt->hitLambda<SceneGraph::Scalar(1))
+				++numHits;
+		unsigned int numMismatches=countMismatches(bruteForce,culled);
+		
+		/* Run the queries concurrently from several threads: */
+		std::vector<QueryThread*> threads;
+		for(unsigned int i=0;i<numThreads;++i)
+			threads.push_back(new QueryThread(*faceSet,queries));
+		unsigned int numThreadMismatches=0;
+		for(std::vector<QueryThread*>::iterator tIt=threads.begin();tIt!=threads.end();++tIt)
+			{
+			numThreadMismatches+=countMismatches(bruteForce,(*tIt)->join());
+			delete *tIt;
+			}
+		
+		std::cout<<std::setw(6)<<meshName<<std::setw(11)<<modeNames[mode]<<std::setw(10)<<numHits;
+		std::cout<<std::setw(14)<<double(queries.size())/bruteForceTime<<std::setw(14)<<double(queries.size())/culledTime;
+		std::cout<<std::setw(10)<<numMismatches<<std::setw(10)<<numThreadMismatches<<std::endl;
+		if(numMismatches!=0||numThreadMismatches!=0)
+			passed=false;
+		}
+	
+	return passed;
+	}
+
+/* Creates random queries around the given box, with movement lengths and radii relative to the given scale: */
+void createQueries(const SceneGraph::Box& box,SceneGraph::Scalar scale,unsigned int numQueries,std::vector<Query>& queries)
+	{
+	queries.clear();
+	for(unsigned int i=0;i<numQueries;++i)
+		{
+		Query q;
+		for(int j=0;j<3;++j)
+			q.c0[j]=random(box.min[j]-scale,box.max[j]+scale);
+		for(int j=0;j<3;++j)
+			q.c0c1[j]=random(-scale,scale);
+		q.radius=random(0.01f,0.2f)*scale;
+		queries.push_back(q);
+		}
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int gridSize=300;
+	int numSoupFaces=100000;
+	unsigned int numQueries=5000;
+	unsigned int numThreads=4;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"grid")==0&&i+1<argc)
+				gridSize=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"soup")==0&&i+1<argc)
+				numSoupFaces=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"queries")==0&&i+1<argc)
+				numQueries=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				numThreads=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	
+	bool passed=true;
+	try
+		{
+		std::cout<<"Comparing "<<numQueries<<" sphere collision queries between testing all faces and culling with a collision hierarchy"<<std::endl;
+		std::cout<<std::setw(6)<<"Mesh"<<std::setw(11)<<"Mode"<<std::setw(10)<<"Hits"<<std::setw(14)<<"All faces/s"<<std::setw(14)<<"Culled/s"<<std::setw(10)<<"Diffs"<<std::setw(10)<<"Thr diffs"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(0);
+		
+		/* Test a jittered height field with queries mostly moving across or into the surface: */
+		{
+		SceneGraph::CoordinateNodePointer coord=new SceneGraph::CoordinateNode;
+		SceneGraph::MFInt::ValueList coordIndices;
+		createGrid(gridSize,coord->point.getValues(),coordIndices);
+		SceneGraph::Box box=coord->calcBoundingBox();
+		addGuardPoints(coord->point.getValues());
+		std::vector<Query> queries;
+		createQueries(box,2.0f,numQueries,queries);
+		passed=testMesh("Grid",coord.getPointer(),coordIndices,queries,numThreads)&&passed;
+		}
+		
+		/* Test a soup of small faces: */
+		{
+		SceneGraph::CoordinateNodePointer coord=new SceneGraph::CoordinateNode;
+		SceneGraph::MFInt::ValueList coordIndices;
+		createSoup(numSoupFaces,100.0f,coord->point.getValues(),coordIndices);
+		SceneGraph::Box box=coord->calcBoundingBox();
+		addGuardPoints(coord->point.getValues());
+		std::vector<Query> queries;
+		createQueries(box,5.0f,numQueries,queries);
+		passed=testMesh("Soup",coord.getPointer(),coordIndices,queries,numThreads)&&passed;
+		}
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Test failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	if(passed)
+		std::cout<<"PASSED: Culled queries match testing all faces"<<std::endl;
+	else
+		std::cout<<"FAILED: Culled queries differ from testing all faces"<<std::endl;
+	return passed?0:1;
+	}
@@ -0,0 +1,248 @@
+/***********************************************************************
+ConfigurationBenchmark - Utility to measure the time to load, merge,
+and query a large layered configuration file as during Vrui start-up,
+with and without compiled configuration file caches, and to check that
+all methods produce the same merged configuration.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
+
+namespace {
+
+/* Writes a synthetic base configuration file with the given number of sections: */
+void writeBaseFile(const char* fileName,unsigned int numSections)
+	{
+	std::ofstream file(fileName);
+	file<<"section Vrui"<<std::endl;
+	for(unsigned int s=0;s<numSections;++s)
+		{
+		file<<"\tsection Section"<<s<<std::endl;
+		for(unsigned int t=0;t<16;++t)
+			file<<"\t\ttag"<<t<<" "<<(s*16+t)*0.5<<std::endl;
+		file<<"\t\tlist (first"<<s<<", second"<<s<<", \"third item\")"<<std::endl;
+		file<<"\t\tname \"Section number "<<s<<"\""<<std::endl;
+		file<<"\t\t"<<std::endl;
+		file<<"\t\tsection Details"<<std::endl;
+		for(unsigned int t=0;t<24;++t)
+			file<<"\t\t\tdetail"<<t<<" ("<<s<<", "<<t<<", "<<s+t<<") # Comment"<<std::endl;
+		file<<"\t\tendsection"<<std::endl;
+		file<<"\tendsection"<<std::endl;
+		file<<std::endl;
+		}
+	file<<"endsection"<<std::endl;
+	}
+
+/* Writes a synthetic overlay configuration file changing, extending, and removing values in every fourth section: */
+void writeOverlayFile(const char* fileName,unsigned int numSections)
+	{
+	std::ofstream file(fileName);
+	file<<"section Vrui"<<std::endl;
+	for(unsigned int s=0;s<numSections;s+=4)
+		{
+		file<<"\tsection Section"<<s<<std::endl;
+		file<<"\t\ttag3 "<<s*3<<std::endl;
+		file<<"\t\tlist += (fourth"<<s<<")"<<std::endl;
+		file<<"\t\ttag7"<<std::endl;
+		file<<"\t\tsection Details"<<std::endl;
+		file<<"\t\t\tdetail5 (overridden)"<<std::endl;
+		file<<"\t\tendsection"<<std::endl;
+		file<<"\t\tsection Extra"<<std::endl;
+		file<<"\t\t\tenabled true"<<std::endl;
+		file<<"\t\tendsection"<<std::endl;
+		file<<"\tendsection"<<std::endl;
+		}
+	file<<"endsection"<<std::endl;
+	}
+
+/* Removes all files from the given directory: */
+void clearDirectory(const std::string& dirName)
+	{
+	DIR* dir=opendir(dirName.c_str());
+	if(dir==0)
+		return;
+	struct dirent* entry;
+	while((entry=readdir(dir))!=0)
+		if(entry->d_name[0]!='.')
+			unlink((dirName+"/"+entry->d_name).c_str());
+	closedir(dir);
+	}
+
+/* Reads the entire contents of the given file: */
+std::string readFile(const std::string& fileName)
+	{
+	std::ifstream file(fileName.c_str());
+	std::ostringstream contents;
+	contents<<file.rdbuf();
+	return contents.str();
+	}
+
+/* Loads and merges the given configuration files and queries all synthetic tags; saves the merged configuration to the given file if the file name is not null: */
+size_t startUp(const std::vector<std::string>& fileNames,const char* cacheDirectory,unsigned int numSections,const char* saveFileName)
+	{
+	Misc::ConfigurationFile config(fileNames[0].c_str(),cacheDirectory);
+	for(size_t i=1;i<fileNames.size();++i)
+		config.merge(fileNames[i].c_str());
+	
+	/* Query the configuration like an application reading its settings: */
+	size_t result=0;
+	for(unsigned int s=0;s<numSections;++s)
+		{
+		char sectionName[64];
+		snprintf(sectionName,sizeof(sectionName),"/Vrui/Section%u",s);
+		Misc::ConfigurationFileSection section=config.getSection(sectionName);
+		for(unsigned int t=0;t<16;++t)
+			{
+			char tagName[16];
+			snprintf(tagName,sizeof(tagName),"tag%u",t);
+			result+=section.retrieveString(tagName,std::string()).size();
+			}
+		result+=section.retrieveString("list").size();
+		Misc::ConfigurationFileSection details=section.getSection("Details");
+		for(unsigned int t=0;t<24;++t)
+			{
+			char tagName[16];
+			snprintf(tagName,sizeof(tagName),"detail%u",t);
+			result+=details.retrieveString(tagName).size();
+			}
+		}
+	
+	if(saveFileName!=0)
+		config.saveAs(saveFileName);
+	
+	return result;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<std::string> fileNames;
+	unsigned int numSections=4000;
+	unsigned int numRuns=5;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"sections")==0&&i+1<argc)
+				numSections=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"runs")==0&&i+1<argc)
+				numRuns=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			fileNames.push_back(argv[i]);
+		}
+	if(numRuns<1)
+		numRuns=1;
+	
+	try
+		{
+		/* Create a temporary directory for generated files and caches: */
+		char tempDirName[]="/tmp/ConfigurationBenchmarkXXXXXX";
+		if(mkdtemp(tempDirName)==0)
+			throw std::runtime_error("Unable to create temporary directory");
+		std::string tempDir=tempDirName;
+		std::string cacheDir=tempDir+"/Cache";
+		
+		/* Generate a base configuration file and an overlay if no files were given: */
+		bool synthetic=fileNames.empty();
+		if(synthetic)
+			{
+			fileNames.push_back(tempDir+"/Base.cfg");
+			writeBaseFile(fileNames.back().c_str(),numSections);
+			fileNames.push_back(tempDir+"/Overlay.cfg");
+			writeOverlayFile(fileNames.back().c_str(),numSections);
+			}
+		else
+			numSections=0;
+		size_t totalSize=0;
+		for(std::vector<std::string>::iterator fnIt=fileNames.begin();fnIt!=fileNames.end();++fnIt)
+			totalSize+=readFile(*fnIt).size();
+		std::cout<<"Loading "<<fileNames.size()<<" configuration files ("<<totalSize<<" bytes) and querying "<<numSections*41<<" tags, best of "<<numRuns<<" runs:"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(2);
+		
+		/* Start up with each method: */
+		static const char* methodNames[]={"Without cache","Cache cold","Cache warm"};
+		std::string saved[3];
+		size_t results[3];
+		bool passed=true;
+		for(int method=0;method<3;++method)
+			{
+			double bestTime=0.0;
+			for(unsigned int run=0;run<numRuns;++run)
+				{
+				/* Start each cold run with an empty cache directory: */
+				if(method==1)
+					clearDirectory(cacheDir);
+				
+				Realtime::TimePointMonotonic start;
+				results[method]=startUp(fileNames,method>0?cacheDir.c_str():0,numSections,0);
+				double elapsed(start.setAndDiff());
+				if(run==0||bestTime>elapsed)
+					bestTime=elapsed;
+				}
+			std::cout<<"  "<<std::setw(16)<<std::left<<methodNames[method]<<std::right<<std::setw(10)<<bestTime*1000.0<<" ms"<<std::endl;
+			
+			/* Save the merged configuration for comparison: */
+			std::string saveFileName=tempDir+"/Saved.cfg";
+			startUp(fileNames,method>0?cacheDir.c_str():0,numSections,saveFileName.c_str());
+			saved[method]=readFile(saveFileName);
+			unlink(saveFileName.c_str());
+			if(saved[method]!=saved[0]||results[method]!=results[0])
+				{
+				std::cout<<"  FAILED: "<<methodNames[method]<<" produced a different merged configuration"<<std::endl;
+				passed=false;
+				}
+			}
+		
+		/* Clean up: */
+		clearDirectory(cacheDir);
+		rmdir(cacheDir.c_str());
+		clearDirectory(tempDir);
+		rmdir(tempDir.c_str());
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,167 @@
+/***********************************************************************
+ElevationGridBenchmark - Utility to measure the time to intersect rays
+with a large synthetic elevation grid cell by cell and through an
+elevation range pyramid, and to check that both methods find the same
+intersections on the grid's bilinear surface.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Geometry/Point.h>
+#include <Geometry/ElevationGrid.h>
+
+namespace {
+
+typedef Geometry::ElevationGrid<double,float> ElevationGrid;
+typedef ElevationGrid::Point Point;
+
+/* Returns the elevation of the given grid's bilinear surface at the given position: */
+double surfaceElevation(const int size[2],const float* grid,double x,double y)
+	{
+	int cx=std::max(std::min(int(floor(x)),size[0]-2),0);
+	int cy=std::max(std::min(int(floor(y)),size[1]-2),0);
+	double u=x-double(cx);
+	double v=y-double(cy);
+	const float* c=grid+(size_t(cy)*size_t(size[0])+size_t(cx));
+	double e0=double(c[0])*(1.0-u)+double(c[1])*u;
+	double e1=double(c[size[0]])*(1.0-u)+double(c[size[0]+1])*u;
+	return e0*(1.0-v)+e1*v;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int gridSize=16384;
+	unsigned int numRays=20000;
+	int leafBlockSize=8;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				gridSize=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"rays")==0&&i+1<argc)
+				numRays=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"blockSize")==0&&i+1<argc)
+				leafBlockSize=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(gridSize<2)
+		gridSize=2;
+	if(numRays<1)
+		numRays=1;
+	
+	try
+		{
+		/* Create a synthetic terrain of rolling hills with smaller ridges: */
+		int size[2]={gridSize,gridSize};
+		std::vector<float> grid(size_t(gridSize)*size_t(gridSize));
+		float* gPtr=&grid[0];
+		for(int y=0;y<gridSize;++y)
+			for(int x=0;x<gridSize;++x,++gPtr)
+				*gPtr=float(50.0*sin(double(x)*0.01)*cos(double(y)*0.013)+10.0*sin(double(x)*0.1+double(y)*0.07));
+		ElevationGrid elevationGrid(size,&grid[0]);
+		
+		/* Create random rays descending from above the terrain into or below it: */
+		std::vector<Point> p0s,p1s;
+		srand(1);
+		for(unsigned int i=0;i<numRays;++i)
+			{
+			p0s.push_back(Point(rand()%gridSize,rand()%gridSize,80.0));
+			p1s.push_back(Point(rand()%gridSize,rand()%gridSize,-80.0+double(rand()%100)));
+			}
+		
+		std::cout<<"Intersecting "<<numRays<<" rays with a "<<gridSize<<"x"<<gridSize<<" elevation grid"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(3);
+		
+		/* Intersect the rays cell by cell: */
+		std::vector<double> ddaResults(numRays);
+		Realtime::TimePointMonotonic ddaStart;
+		for(unsigned int i=0;i<numRays;++i)
+			ddaResults[i]=elevationGrid.intersectRay(p0s[i],p1s[i]);
+		double ddaTime(ddaStart.setAndDiff());
+		std::cout<<"  Cell traversal      "<<std::setw(10)<<ddaTime<<" s"<<std::endl;
+		
+		/* Build the elevation range pyramid: */
+		Realtime::TimePointMonotonic buildStart;
+		elevationGrid.buildPyramid(leafBlockSize);
+		double buildTime(buildStart.setAndDiff());
+		std::cout<<"  Pyramid build       "<<std::setw(10)<<buildTime<<" s"<<std::endl;
+		
+		/* Intersect the rays through the pyramid, one at a time and as a parallel batch: */
+		std::vector<double> pyramidResults(numRays);
+		Realtime::TimePointMonotonic pyramidStart;
+		for(unsigned int i=0;i<numRays;++i)
+			pyramidResults[i]=elevationGrid.intersectRay(p0s[i],p1s[i]);
+		double pyramidTime(pyramidStart.setAndDiff());
+		std::cout<<"  Pyramid traversal   "<<std::setw(10)<<pyramidTime<<" s ("<<std::setprecision(1)<<ddaTime/pyramidTime<<"x)"<<std::setprecision(3)<<std::endl;
+		
+		std::vector<double> batchResults(numRays);
+		Realtime::TimePointMonotonic batchStart;
+		elevationGrid.intersectRays(numRays,&p0s[0],&p1s[0],&batchResults[0]);
+		double batchTime(batchStart.setAndDiff());
+		std::cout<<"  Parallel batch      "<<std::setw(10)<<batchTime<<" s ("<<std::setprecision(1)<<ddaTime/batchTime<<"x)"<<std::setprecision(3)<<std::endl;
+		
+		/* Check that all methods agree and that intersections lie on the bilinear surface: */
+		unsigned int numHits=0;
+		unsigned int numMismatches=0;
+		double maxSurfaceError=0.0;
+		for(unsigned int i=0;i<numRays;++i)
+			{
+			if(fabs(pyramidResults[i]-ddaResults[i])>1.0e-9||batchResults[i]!=pyramidResults[i])
+				++numMismatches;
+			if(pyramidResults[i]<1.0)
+				{
+				++numHits;
+				Point p=Geometry::affineCombination(p0s[i],p1s[i],pyramidResults[i]);
+				double error=fabs(p[2]-surfaceElevation(size,&grid[0],p[0],p[1]));
+				if(maxSurfaceError<error)
+					maxSurfaceError=error;
+				}
+			}
+		std::cout<<"  "<<numHits<<" hits, "<<numMismatches<<" mismatches, maximum distance from surface "<<std::scientific<<std::setprecision(2)<<maxSurfaceError<<std::endl;
+		bool passed=numMismatches==0&&maxSurfaceError<1.0e-6;
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
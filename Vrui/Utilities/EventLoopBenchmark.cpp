@@ -0,0 +1,289 @@
+/***********************************************************************
+EventLoopBenchmark - Utility to measure the wakeup latency of
+Threads::RunLoop and Threads::EventDispatcher with their poll/select and
+epoll backends against the number of watched file descriptors.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/StdError.h>
+#include <Realtime/Time.h>
+#include <Threads/Config.h>
+#include <Threads/FunctionCalls.h>
+#include <Threads/RunLoop.h>
+#include <Threads/EventDispatcher.h>
+
+namespace {
+
+/**************************************************
+Set of pipes watched by the event loop under test:
+**************************************************/
+
+class PipeSet
+	{
+	/* Embedded classes: */
+	public:
+	struct Pipe // Structure representing a watched pipe
+		{
+		/* Elements: */
+		public:
+		PipeSet* pipeSet; // Pointer back to the pipe set
+		int fds[2]; // Read and write ends of the pipe
+		};
+	
+	/* Elements: */
+	private:
+	std::vector<Pipe> pipes; // List of pipes
+	Realtime::TimePointMonotonic wakeupTime; // Time point at which the most recent event was handled
+	unsigned int numWakeups; // Number of events handled so far
+	
+	/* Constructors and destructors: */
+	public:
+	PipeSet(unsigned int numPipes)
+		:pipes(numPipes),numWakeups(0)
+		{
+		for(std::vector<Pipe>::iterator pIt=pipes.begin();pIt!=pipes.end();++pIt)
+			{
+			pIt->pipeSet=this;
+			if(pipe(pIt->fds)<0)
+				throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot create pipe %u",(unsigned int)(pIt-pipes.begin()));
+			}
+		}
+	~PipeSet(void)
+		{
+		for(std::vector<Pipe>::iterator pIt=pipes.begin();pIt!=pipes.end();++pIt)
+			{
+			close(pIt->fds[0]);
+			close(pIt->fds[1]);
+			}
+		}
+	
+	/* Methods: */
+	size_t getNumPipes(void) const
+		{
+		return pipes.size();
+		}
+	Pipe& getPipe(size_t index)
+		{
+		return pipes[index];
+		}
+	void trigger(size_t index) // Writes a byte into the pipe of the given index
+		{
+		char byte=0;
+		if(write(pipes[index].fds[1],&byte,1)!=1)
+			throw Misc::makeLibcErr(__PRETTY_FUNCTION__,errno,"Cannot write to pipe");
+		}
+	void wakeup(int fd) // Handles a wakeup on the given read end
+		{
+		char byte;
+		if(read(fd,&byte,1)==1)
+			{
+			wakeupTime.set();
+			++numWakeups;
+			}
+		}
+	const Realtime::TimePointMonotonic& getWakeupTime(void) const
+		{
+		return wakeupTime;
+		}
+	unsigned int getNumWakeups(void) const
+		{
+		return numWakeups;
+		}
+	
+	/* Event handlers: */
+	void runLoopEventHandler(Threads::RunLoop::IOWatcher::Event& event)
+		{
+		wakeup(event.getFd());
+		}
+	static void eventDispatcherCallback(Threads::EventDispatcher::IOEvent& event)
+		{
+		Pipe* pipe=static_cast<Pipe*>(event.getUserData());
+		pipe->pipeSet->wakeup(pipe->fds[0]);
+		}
+	};
+
+/******************************************
+Accumulator for wakeup latency statistics:
+******************************************/
+
+class LatencyStats
+	{
+	/* Elements: */
+	private:
+	unsigned int numSamples; // Number of accumulated latency samples
+	double sum; // Sum of all latency samples in seconds
+	double max; // Maximum latency sample in seconds
+	
+	/* Constructors and destructors: */
+	public:
+	LatencyStats(void)
+		:numSamples(0),sum(0.0),max(0.0)
+		{
+		}
+	
+	/* Methods: */
+	void add(double latency)
+		{
+		++numSamples;
+		sum+=latency;
+		if(max<latency)
+			max=latency;
+		}
+	double getMean(void) const
+		{
+		return numSamples>0?sum/double(numSamples):0.0;
+		}
+	double getMax(void) const
+		{
+		return max;
+		}
+	};
+
+LatencyStats measureRunLoop(Threads::RunLoop::Backend backend,PipeSet& pipes,unsigned int numWakeups)
+	{
+	/* Create a run loop watching the read ends of all pipes: */
+	Threads::RunLoop runLoop(backend);
+	Threads::RunLoop::IOWatcher::EventHandler* eventHandler=Threads::createFunctionCall(&pipes,&PipeSet::runLoopEventHandler);
+	std::vector<Threads::RunLoop::IOWatcherPtr> watchers;
+	for(size_t i=0;i<pipes.getNumPipes();++i)
+		watchers.push_back(runLoop.createIOWatcher(pipes.getPipe(i).fds[0],Threads::RunLoop::IOWatcher::Read,true,*eventHandler));
+	
+	/* Wake up the run loop from random pipes: */
+	LatencyStats result;
+	for(unsigned int i=0;i<numWakeups;++i)
+		{
+		unsigned int wakeupsBefore=pipes.getNumWakeups();
+		Realtime::TimePointMonotonic triggerTime;
+		pipes.trigger(size_t(rand())%pipes.getNumPipes());
+		while(pipes.getNumWakeups()==wakeupsBefore)
+			runLoop.dispatchNextEvents();
+		result.add(double(pipes.getWakeupTime()-triggerTime));
+		}
+	
+	return result;
+	}
+
+LatencyStats measureEventDispatcher(Threads::EventDispatcher::Backend backend,PipeSet& pipes,unsigned int numWakeups)
+	{
+	/* Create an event dispatcher listening on the read ends of all pipes, draining its command pipe periodically: */
+	Threads::EventDispatcher dispatcher(backend);
+	for(size_t i=0;i<pipes.getNumPipes();++i)
+		{
+		dispatcher.addIOEventListener(pipes.getPipe(i).fds[0],Threads::EventDispatcher::Read,&PipeSet::eventDispatcherCallback,&pipes.getPipe(i));
+		if(i%64==63)
+			dispatcher.dispatchNextEvent(false);
+		}
+	
+	/* Wake up the event dispatcher from random pipes: */
+	LatencyStats result;
+	for(unsigned int i=0;i<numWakeups;++i)
+		{
+		unsigned int wakeupsBefore=pipes.getNumWakeups();
+		Realtime::TimePointMonotonic triggerTime;
+		pipes.trigger(size_t(rand())%pipes.getNumPipes());
+		while(pipes.getNumWakeups()==wakeupsBefore)
+			dispatcher.dispatchNextEvent();
+		result.add(double(pipes.getWakeupTime()-triggerTime));
+		}
+	
+	return result;
+	}
+
+void printStats(const char* name,const LatencyStats& stats)
+	{
+	std::cout<<std::setw(16)<<stats.getMean()*1.0e6<<std::setw(12)<<stats.getMax()*1.0e6<<" ("<<name<<')';
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int maxNumPipes=4096;
+	unsigned int numWakeups=10000;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"maxPipes")==0&&i+1<argc)
+				maxNumPipes=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"wakeups")==0&&i+1<argc)
+				numWakeups=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Raise the file descriptor limit as far as allowed and limit the number of pipes accordingly: */
+	struct rlimit fdLimit;
+	if(getrlimit(RLIMIT_NOFILE,&fdLimit)==0)
+		{
+		fdLimit.rlim_cur=fdLimit.rlim_max;
+		setrlimit(RLIMIT_NOFILE,&fdLimit);
+		getrlimit(RLIMIT_NOFILE,&fdLimit);
+		if(fdLimit.rlim_cur!=RLIM_INFINITY&&maxNumPipes*2+64>fdLimit.rlim_cur)
+			{
+			maxNumPipes=(unsigned int)((fdLimit.rlim_cur-64)/2);
+			std::cout<<"Limiting number of pipes to "<<maxNumPipes<<" due to the file descriptor limit"<<std::endl;
+			}
+		}
+	
+	/* The select() backend can not watch file descriptors beyond FD_SETSIZE: */
+	unsigned int maxNumSelectPipes=(FD_SETSIZE-64)/2;
+	
+	std::cout<<"Mean and maximum wakeup latency in microseconds over "<<numWakeups<<" wakeups"<<std::endl;
+	#if !THREADS_CONFIG_HAVE_EPOLL
+	std::cout<<"The epoll backends are not available on this system"<<std::endl;
+	#endif
+	std::cout<<std::fixed<<std::setprecision(2);
+	for(unsigned int numPipes=16;numPipes<=maxNumPipes;numPipes*=4)
+		{
+		PipeSet pipes(numPipes);
+		std::cout<<std::setw(6)<<numPipes<<" descriptors:"<<std::endl;
+		printStats("RunLoop, poll",measureRunLoop(Threads::RunLoop::Poll,pipes,numWakeups));
+		std::cout<<std::endl;
+		#if THREADS_CONFIG_HAVE_EPOLL
+		printStats("RunLoop, epoll",measureRunLoop(Threads::RunLoop::EPoll,pipes,numWakeups));
+		std::cout<<std::endl;
+		#endif
+		if(numPipes<=maxNumSelectPipes)
+			{
+			printStats("EventDispatcher, select",measureEventDispatcher(Threads::EventDispatcher::Select,pipes,numWakeups));
+			std::cout<<std::endl;
+			}
+		#if THREADS_CONFIG_HAVE_EPOLL
+		printStats("EventDispatcher, epoll",measureEventDispatcher(Threads::EventDispatcher::EPoll,pipes,numWakeups));
+		std::cout<<std::endl;
+		#endif
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,207 @@
+/***********************************************************************
+FileWriteBenchmark - Utility to validate and measure the throughput of
+buffered, write-through, and vectored writes in IO::File for block
+sizes from 64 bytes to 64 megabytes.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Realtime/Time.h>
+#include <IO/File.h>
+#include <IO/StandardFile.h>
+
+namespace {
+
+enum WriteMode // Enumerated type for methods to write a header followed by a block of data
+	{
+	COPY, // Copy all data through the write buffer
+	WRITETHROUGH, // Write the header through the buffer and let large blocks bypass it
+	VECTORED // Write header and block with a single vectored write
+	};
+
+const char* modeNames[]={"copy","write-through","vectored"};
+
+/* Writes the given header and block of data to the given file using the given method: */
+inline void writeBlock(IO::File& file,WriteMode mode,const Misc::UInt32 header[4],const Misc::UInt8* block,size_t blockSize)
+	{
+	if(mode==VECTORED)
+		{
+		struct iovec vectors[2];
+		vectors[0].iov_base=const_cast<Misc::UInt32*>(header);
+		vectors[0].iov_len=4*sizeof(Misc::UInt32);
+		vectors[1].iov_base=const_cast<Misc::UInt8*>(block);
+		vectors[1].iov_len=blockSize;
+		file.writeRawVectored(vectors,2);
+		}
+	else
+		{
+		file.writeRaw(header,4*sizeof(Misc::UInt32));
+		file.writeRaw(block,blockSize);
+		}
+	}
+
+/* Prepares the given newly-opened file for writes using the given method: */
+void setMode(IO::File& file,WriteMode mode)
+	{
+	/* Prevent any data from bypassing the write buffer in copy mode; other modes use the default write-through threshold: */
+	if(mode==COPY)
+		file.setWriteThroughThreshold(~size_t(0));
+	}
+
+/* Writes a random sequence of headers and blocks to a temporary file using the given method and compares the file's contents against the written data; returns true if they match: */
+bool validate(WriteMode mode,const std::vector<Misc::UInt8>& data,unsigned int numBlocks)
+	{
+	char fileName[]="/tmp/FileWriteBenchmarkXXXXXX";
+	int fd=mkstemp(fileName);
+	if(fd<0)
+		throw std::runtime_error("Unable to create temporary file");
+	
+	/* Write blocks of random sizes and offsets, from empty to larger than the write buffer, and record the expected file contents: */
+	std::vector<Misc::UInt8> expected;
+	{
+	IO::StandardFile file(fd,IO::File::WriteOnly);
+	setMode(file,mode);
+	size_t maxBlockSize=file.getWriteBufferSize()*4;
+	for(unsigned int i=0;i<numBlocks;++i)
+		{
+		size_t blockSize=size_t(rand())%(rand()%8==0?maxBlockSize:256);
+		size_t offset=size_t(rand())%(data.size()-blockSize);
+		Misc::UInt32 header[4]={i,Misc::UInt32(blockSize),Misc::UInt32(offset),0xdeadbeefU};
+		writeBlock(file,mode,header,&data[offset],blockSize);
+		const Misc::UInt8* hPtr=reinterpret_cast<const Misc::UInt8*>(header);
+		expected.insert(expected.end(),hPtr,hPtr+sizeof(header));
+		expected.insert(expected.end(),data.begin()+offset,data.begin()+offset+blockSize);
+		}
+	}
+	
+	/* Read the file back and compare: */
+	IO::StandardFile file(fileName);
+	std::vector<Misc::UInt8> actual(expected.size()+1);
+	size_t readSize=file.readUpTo(&actual[0],actual.size());
+	while(readSize<actual.size())
+		{
+		size_t thisRead=file.readUpTo(&actual[readSize],actual.size()-readSize);
+		if(thisRead==0)
+			break;
+		readSize+=thisRead;
+		}
+	unlink(fileName);
+	
+	return readSize==expected.size()&&memcmp(&actual[0],&expected[0],expected.size())==0;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* sinkName="/dev/null";
+	size_t minBlockSize=64;
+	size_t maxBlockSize=64*1024*1024;
+	size_t totalSize=256*1024*1024;
+	unsigned int numValidationBlocks=20000;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"sink")==0&&i+1<argc)
+				sinkName=argv[++i];
+			else if(strcasecmp(argv[i]+1,"minSize")==0&&i+1<argc)
+				minBlockSize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"maxSize")==0&&i+1<argc)
+				maxBlockSize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"total")==0&&i+1<argc)
+				totalSize=size_t(atol(argv[++i]))*1024*1024;
+			else if(strcasecmp(argv[i]+1,"blocks")==0&&i+1<argc)
+				numValidationBlocks=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(minBlockSize<1)
+		minBlockSize=1;
+	
+	/* Create a block of random data: */
+	std::vector<Misc::UInt8> data(maxBlockSize>1024*1024?maxBlockSize:1024*1024);
+	for(std::vector<Misc::UInt8>::iterator dIt=data.begin();dIt!=data.end();++dIt)
+		*dIt=Misc::UInt8(rand());
+	
+	try
+		{
+		/* Validate all write methods: */
+		bool passed=true;
+		for(int mode=0;mode<3;++mode)
+			{
+			bool ok=validate(WriteMode(mode),data,numValidationBlocks);
+			std::cout<<"Validating "<<modeNames[mode]<<" writes: "<<(ok?"passed":"FAILED")<<std::endl;
+			passed=passed&&ok;
+			}
+		if(!passed)
+			return 1;
+		
+		/* Measure the throughput of all write methods: */
+		std::cout<<"Throughput writing a 16-byte header and a block of data to "<<sinkName<<" in MB/s"<<std::endl;
+		std::cout<<std::setw(10)<<"Block size";
+		for(int mode=0;mode<3;++mode)
+			std::cout<<std::setw(16)<<modeNames[mode];
+		std::cout<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		for(size_t blockSize=minBlockSize;blockSize<=maxBlockSize;blockSize*=4)
+			{
+			std::cout<<std::setw(10)<<blockSize;
+			size_t numBlocks=totalSize/blockSize;
+			if(numBlocks<4)
+				numBlocks=4;
+			for(int mode=0;mode<3;++mode)
+				{
+				IO::StandardFile sink(sinkName,IO::File::WriteOnly);
+				setMode(sink,WriteMode(mode));
+				Misc::UInt32 header[4]={0U,Misc::UInt32(blockSize),0U,0U};
+				Realtime::TimePointMonotonic start;
+				for(size_t i=0;i<numBlocks;++i)
+					{
+					header[0]=Misc::UInt32(i);
+					writeBlock(sink,WriteMode(mode),header,&data[0],blockSize);
+					}
+				sink.flush();
+				double elapsed(start.setAndDiff());
+				std::cout<<std::setw(16)<<double(numBlocks*(blockSize+sizeof(header)))/(elapsed*1024.0*1024.0);
+				}
+			std::cout<<std::endl;
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
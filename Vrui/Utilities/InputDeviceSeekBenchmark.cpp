@@ -0,0 +1,286 @@
+/***********************************************************************
+InputDeviceSeekBenchmark - Utility to measure the time to load the chunk
+index of a long synthetic input device data recording and to seek to
+random time stamps in it, and to check sequential playback of gzip-
+compressed recordings that do not support seeking.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Realtime/Time.h>
+#include <Vrui/Internal/InputDeviceDataChunkWriter.h>
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
+
+namespace {
+
+/***********************************************
+Layout of the synthetic recording's frame data:
+***********************************************/
+
+struct Recording
+	{
+	/* Elements: */
+	public:
+	double frameRate; // Number of frames per second
+	unsigned int numFrames; // Total number of frames
+	unsigned int numDevices; // Number of recorded input devices
+	size_t deviceStateSize; // Size of each device's state in a frame
+	
+	/* Constructors and destructors: */
+	Recording(double sFrameRate,unsigned int sNumFrames,unsigned int sNumDevices)
+		:frameRate(sFrameRate),numFrames(sNumFrames),numDevices(sNumDevices),
+		 deviceStateSize(1+7*8+6*8+4*4+2*8) // Valid flag, position and orientation, velocities, buttons, valuators
+		{
+		}
+	
+	/* Methods: */
+	double getTimeStamp(unsigned int frameIndex) const // Returns the time stamp of the given frame
+		{
+		return double(frameIndex)/frameRate;
+		}
+	unsigned int findFrame(double timeStamp) const // Returns the index of the first frame at or after the given time stamp
+		{
+		unsigned int result=(unsigned int)(timeStamp*frameRate);
+		while(result>0&&getTimeStamp(result-1)>=timeStamp)
+			--result;
+		while(result<numFrames&&getTimeStamp(result)<timeStamp)
+			++result;
+		return result;
+		}
+	};
+
+/* Writes a synthetic recording to the given file: */
+void writeRecording(const Recording& recording,IO::FilePtr file,bool compressChunks)
+	{
+	file->setEndianness(Misc::LittleEndian);
+	Vrui::InputDeviceDataChunkWriter writer(file,1024,1.0,compressChunks);
+	for(unsigned int frameIndex=0;frameIndex<recording.numFrames;++frameIndex)
+		{
+		IO::File& frame=writer.startFrame(recording.getTimeStamp(frameIndex));
+		frame.write(Misc::UInt32(frameIndex));
+		for(unsigned int device=0;device<recording.numDevices;++device)
+			{
+			/* Write a slowly moving device state: */
+			frame.write(Misc::UInt8(1));
+			double t=recording.getTimeStamp(frameIndex)+double(device);
+			double state[7+6];
+			for(int i=0;i<7+6;++i)
+				state[i]=double(i)*0.1+double(int(t*8.0)%97)*0.01;
+			frame.write(state,7+6);
+			Misc::UInt32 buttons[4]={frameIndex%2,(frameIndex/90)%2,0,device};
+			frame.write(buttons,4);
+			double valuators[2]={0.5,-0.5};
+			frame.write(valuators,2);
+			}
+		writer.finishFrame();
+		}
+	writer.close();
+	}
+
+/* Reads the next frame from the given chunk reader and returns its time stamp and frame index; returns false at the end of the recording: */
+bool readFrame(Vrui::InputDeviceDataChunkReader& reader,double& timeStamp,unsigned int& frameIndex)
+	{
+	if(!reader.nextFrame())
+		return false;
+	IO::File& frame=reader.getFrameFile();
+	timeStamp=frame.read<double>();
+	frameIndex=frame.read<Misc::UInt32>();
+	return true;
+	}
+
+/* Skips the device states of the current frame: */
+void skipDeviceStates(const Recording& recording,Vrui::InputDeviceDataChunkReader& reader)
+	{
+	reader.getFrameFile().skip<Misc::UInt8>(recording.deviceStateSize*recording.numDevices);
+	}
+
+/* Returns the size of the given file in bytes: */
+off_t getFileSize(const char* fileName)
+	{
+	struct stat fileStats;
+	if(stat(fileName,&fileStats)!=0)
+		return 0;
+	return fileStats.st_size;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	double durationHours=3.0;
+	double frameRate=90.0;
+	unsigned int numDevices=3;
+	unsigned int numSeeks=1000;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"hours")==0&&i+1<argc)
+				durationHours=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"rate")==0&&i+1<argc)
+				frameRate=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"devices")==0&&i+1<argc)
+				numDevices=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"seeks")==0&&i+1<argc)
+				numSeeks=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(frameRate<=0.0)
+		frameRate=90.0;
+	Recording recording(frameRate,(unsigned int)(durationHours*3600.0*frameRate),numDevices);
+	if(recording.numFrames<1)
+		recording.numFrames=1;
+	if(numSeeks<1)
+		numSeeks=1;
+	
+	try
+		{
+		/* Create a temporary directory for the recordings: */
+		char tempDirName[]="/tmp/InputDeviceSeekBenchmarkXXXXXX";
+		if(mkdtemp(tempDirName)==0)
+			throw std::runtime_error("Unable to create temporary directory");
+		std::string tempDir=tempDirName;
+		
+		std::cout<<"Recording "<<recording.numFrames<<" frames ("<<durationHours<<" h at "<<frameRate<<" Hz) of "<<numDevices<<" devices"<<std::endl;
+		std::cout<<std::fixed;
+		bool passed=true;
+		
+		/* Benchmark seeking in recordings with uncompressed and compressed chunks: */
+		for(int compressChunks=0;compressChunks<2;++compressChunks)
+			{
+			/* Write the recording: */
+			std::string fileName=tempDir+(compressChunks?"/Compressed.dat":"/Uncompressed.dat");
+			Realtime::TimePointMonotonic writeStart;
+			writeRecording(recording,IO::openFile(fileName.c_str(),IO::File::WriteOnly),compressChunks!=0);
+			double writeTime(writeStart.setAndDiff());
+			std::cout<<(compressChunks?"Compressed chunks":"Uncompressed chunks")<<": "<<getFileSize(fileName.c_str())/1000000<<" MB, written in "<<std::setprecision(2)<<writeTime<<" s"<<std::endl;
+			
+			/* Load the chunk index: */
+			IO::FilePtr file=IO::openFile(fileName.c_str());
+			file->setEndianness(Misc::LittleEndian);
+			Realtime::TimePointMonotonic indexStart;
+			Vrui::InputDeviceDataChunkReader reader(file);
+			double indexTime(indexStart.setAndDiff());
+			std::cout<<"  Index load: "<<std::setprecision(3)<<indexTime*1000.0<<" ms, "<<reader.getNumChunks()<<" chunks"<<std::endl;
+			if(!reader.isSeekable()||!reader.hasStoredIndex()||reader.getNumFrames()!=recording.numFrames)
+				{
+				std::cout<<"  FAILED: chunk index does not match the recording"<<std::endl;
+				passed=false;
+				continue;
+				}
+			
+			/* Seek to random time stamps like InputDeviceAdapterPlayback: */
+			double totalTime=0.0;
+			double worstTime=0.0;
+			unsigned int numMismatches=0;
+			srand(compressChunks+1);
+			for(unsigned int seek=0;seek<numSeeks;++seek)
+				{
+				double targetTime=double(rand())/double(RAND_MAX)*recording.getTimeStamp(recording.numFrames-1);
+				Realtime::TimePointMonotonic seekStart;
+				
+				/* Load the last chunk starting at or before the target time stamp and skip frames before it: */
+				reader.loadChunk(reader.findChunk(targetTime));
+				double timeStamp;
+				unsigned int frameIndex;
+				bool found;
+				while((found=readFrame(reader,timeStamp,frameIndex))&&timeStamp<targetTime)
+					skipDeviceStates(recording,reader);
+				double seekTime(seekStart.setAndDiff());
+				totalTime+=seekTime;
+				if(worstTime<seekTime)
+					worstTime=seekTime;
+				
+				/* Check that the seek arrived at the first frame at or after the target time stamp: */
+				unsigned int expectedFrameIndex=recording.findFrame(targetTime);
+				if(!found||frameIndex!=expectedFrameIndex||timeStamp!=recording.getTimeStamp(expectedFrameIndex))
+					++numMismatches;
+				}
+			std::cout<<"  "<<numSeeks<<" random seeks: mean "<<std::setprecision(4)<<totalTime*1000.0/double(numSeeks)<<" ms, worst "<<worstTime*1000.0<<" ms, "<<numMismatches<<" wrong frames"<<std::endl;
+			if(numMismatches!=0)
+				passed=false;
+			
+			unlink(fileName.c_str());
+			}
+		
+		/* Check that gzip-compressed recordings are played back sequentially without scanning the file first: */
+		{
+		std::string fileName=tempDir+"/Recording.dat.gz";
+		writeRecording(recording,IO::openFile(fileName.c_str(),IO::File::WriteOnly),false);
+		std::cout<<"Gzip-compressed file: "<<getFileSize(fileName.c_str())/1000000<<" MB"<<std::endl;
+		
+		Realtime::TimePointMonotonic openStart;
+		IO::FilePtr file=IO::openFile(fileName.c_str());
+		file->setEndianness(Misc::LittleEndian);
+		Vrui::InputDeviceDataChunkReader reader(file);
+		double openTime(openStart.setAndDiff());
+		
+		/* Read all frames in order: */
+		unsigned int numFrames=0;
+		unsigned int numMismatches=0;
+		double timeStamp;
+		unsigned int frameIndex;
+		while(readFrame(reader,timeStamp,frameIndex))
+			{
+			if(frameIndex!=numFrames||timeStamp!=recording.getTimeStamp(numFrames))
+				++numMismatches;
+			skipDeviceStates(recording,reader);
+			++numFrames;
+			}
+		double readTime(openStart.setAndDiff());
+		std::cout<<"  Open: "<<std::setprecision(3)<<openTime*1000.0<<" ms, sequential playback of "<<numFrames<<" frames: "<<std::setprecision(2)<<readTime<<" s"<<std::endl;
+		if(reader.isSeekable()||numFrames!=recording.numFrames||numMismatches!=0)
+			{
+			std::cout<<"  FAILED: sequential playback does not match the recording"<<std::endl;
+			passed=false;
+			}
+		
+		unlink(fileName.c_str());
+		}
+		
+		rmdir(tempDir.c_str());
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,419 @@
+/***********************************************************************
+JsonBenchmark - Utility to compare the parsing throughput of
+IO::JsonDocument against the entity-based IO::JsonSource parser on a
+large generated JSON file, and to check that both parsers agree.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <IO/File.h>
+#include <IO/StandardFile.h>
+#include <IO/JsonEntityTypes.h>
+#include <IO/JsonSource.h>
+#include <IO/JsonDocument.h>
+
+namespace {
+
+/************************************************************
+Summary of a parsed JSON value used to compare both parsers:
+************************************************************/
+
+struct Summary
+	{
+	/* Elements: */
+	public:
+	size_t numValues; // Total number of values
+	size_t numNulls; // Number of null values
+	size_t numTrues; // Number of true boolean values
+	double numberSum; // Sum of all numbers
+	size_t numStringChars; // Total length of all decoded strings
+	size_t numNameChars; // Total length of all decoded object member names
+	
+	/* Constructors and destructors: */
+	Summary(void)
+		:numValues(0),numNulls(0),numTrues(0),numberSum(0.0),numStringChars(0),numNameChars(0)
+		{
+		}
+	
+	/* Methods: */
+	bool operator==(const Summary& other) const
+		{
+		return numValues==other.numValues&&numNulls==other.numNulls&&numTrues==other.numTrues&&numberSum==other.numberSum&&numStringChars==other.numStringChars&&numNameChars==other.numNameChars;
+		}
+	};
+
+/* Appends a random string of the given maximum length: */
+void appendString(std::string& json,int maxLength)
+	{
+	static const char chars[]="abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+	json.push_back('"');
+	int length=rand()%maxLength+1;
+	for(int i=0;i<length;++i)
+		json.push_back(chars[rand()%(sizeof(chars)-1)]);
+	json.push_back('"');
+	}
+
+/* Appends a random record object containing all value types: */
+void appendRecord(std::string& json,unsigned int index)
+	{
+	char buffer[64];
+	snprintf(buffer,sizeof(buffer),"{\"id\": %u, \"name\": ",index);
+	json.append(buffer);
+	appendString(json,24);
+	snprintf(buffer,sizeof(buffer),", \"value\": %.6g, \"active\": %s, \"parent\": ",double(rand())/double(RAND_MAX)*2000.0-1000.0,rand()%2==0?"true":"false");
+	json.append(buffer);
+	if(rand()%4==0)
+		json.append("null");
+	else
+		{
+		snprintf(buffer,sizeof(buffer),"%d",rand()%100000);
+		json.append(buffer);
+		}
+	json.append(", \"position\": [");
+	for(int i=0;i<3;++i)
+		{
+		snprintf(buffer,sizeof(buffer),i>0?", %.8e":"%.8e",double(rand())/double(RAND_MAX)-0.5);
+		json.append(buffer);
+		}
+	json.append("], \"tags\": [");
+	int numTags=rand()%4+1;
+	for(int i=0;i<numTags;++i)
+		{
+		if(i>0)
+			json.append(", ");
+		appendString(json,8);
+		}
+	json.append("]}");
+	}
+
+/* Writes a JSON file of approximately the given size: */
+void writeDocument(const char* fileName,size_t fileSize)
+	{
+	IO::StandardFile file(fileName,IO::File::WriteOnly);
+	std::string json="{\"format\": \"JsonBenchmark\", \"version\": 1, \"records\": [\n";
+	size_t size=0;
+	for(unsigned int index=0;size+json.size()<fileSize;++index)
+		{
+		if(index>0)
+			json.append(",\n");
+		appendRecord(json,index);
+		
+		/* Flush the accumulated text occasionally: */
+		if(json.size()>=65536)
+			{
+			file.writeRaw(json.data(),json.size());
+			size+=json.size();
+			json.clear();
+			}
+		}
+	json.append("\n]}\n");
+	file.writeRaw(json.data(),json.size());
+	}
+
+/* Summarizes a value parsed by JsonDocument: */
+void summarize(const IO::JsonDocument::Value& value,Summary& summary)
+	{
+	++summary.numValues;
+	switch(value.getType())
+		{
+		case IO::JsonDocument::NULLVALUE:
+			++summary.numNulls;
+			break;
+		
+		case IO::JsonDocument::BOOLEAN:
+			if(value.getBoolean())
+				++summary.numTrues;
+			break;
+		
+		case IO::JsonDocument::NUMBER:
+			summary.numberSum+=value.getNumber();
+			break;
+		
+		case IO::JsonDocument::STRING:
+			summary.numStringChars+=value.getString().size();
+			break;
+		
+		case IO::JsonDocument::ARRAY:
+			for(IO::JsonDocument::Value child=value.getFirstChild();child.isValid();child=child.getNextSibling())
+				summarize(child,summary);
+			break;
+		
+		case IO::JsonDocument::OBJECT:
+			for(IO::JsonDocument::Value child=value.getFirstChild();child.isValid();child=child.getNextSibling())
+				{
+				summary.numNameChars+=child.getName().size();
+				summarize(child,summary);
+				}
+			break;
+		}
+	}
+
+/* Summarizes an entity parsed by JsonSource: */
+void summarize(IO::JsonPointer entity,Summary& summary)
+	{
+	++summary.numValues;
+	if(entity==0)
+		{
+		++summary.numNulls;
+		return;
+		}
+	switch(entity->getType())
+		{
+		case IO::JsonEntity::BOOLEAN:
+			if(IO::getBoolean(entity))
+				++summary.numTrues;
+			break;
+		
+		case IO::JsonEntity::NUMBER:
+			summary.numberSum+=IO::getNumber(entity);
+			break;
+		
+		case IO::JsonEntity::STRING:
+			summary.numStringChars+=IO::getString(entity).size();
+			break;
+		
+		case IO::JsonEntity::ARRAY:
+			{
+			const IO::JsonArray::Array& array=IO::getArray(entity);
+			for(IO::JsonArray::Array::const_iterator aIt=array.begin();aIt!=array.end();++aIt)
+				summarize(*aIt,summary);
+			break;
+			}
+		
+		case IO::JsonEntity::OBJECT:
+			{
+			/* Summarize members in document order to keep the number sums identical: */
+			static const char* memberNames[]={"format","version","records","id","name","value","active","parent","position","tags"};
+			const IO::JsonObject::Map& map=IO::getObject(entity);
+			for(int i=0;i<10;++i)
+				{
+				IO::JsonObject::Map::ConstIterator mIt=map.findEntry(memberNames[i]);
+				if(!mIt.isFinished())
+					{
+					summary.numNameChars+=mIt->getSource().size();
+					summarize(mIt->getDest(),summary);
+					}
+				}
+			break;
+			}
+		}
+	}
+
+/***************************************************
+Source file producing JSON text and failing midway:
+***************************************************/
+
+class FailingSource:public IO::File
+	{
+	/* Elements: */
+	private:
+	size_t failOffset; // Position in the stream at which reading fails
+	size_t offset; // Current position in the stream
+	
+	/* Protected methods from IO::File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize)
+		{
+		if(offset>=failOffset)
+			throw Error("FailingSource: Simulated read failure");
+		size_t readSize=bufferSize;
+		if(readSize>failOffset-offset)
+			readSize=failOffset-offset;
+		for(size_t i=0;i<readSize;++i)
+			buffer[i]=offset+i==0?'[':(offset+i)%2==1?'1':',';
+		offset+=readSize;
+		return readSize;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FailingSource(size_t sFailOffset)
+		:IO::File(ReadOnly),
+		 failOffset(sFailOffset),offset(0)
+		{
+		}
+	};
+
+/* Returns true if a read error while loading a JSON document is reported to the caller: */
+bool checkReadFailure(size_t failOffset)
+	{
+	FailingSource file(failOffset);
+	try
+		{
+		IO::JsonDocument document(file);
+		return false;
+		}
+	catch(const std::runtime_error& err)
+		{
+		return true;
+		}
+	}
+
+/* Returns true if accessing an invalid JSON value throws an exception: */
+bool checkInvalidValue(void)
+	{
+	IO::JsonDocument::Value invalid;
+	try
+		{
+		invalid.getType();
+		return false;
+		}
+	catch(const std::runtime_error& err)
+		{
+		}
+	try
+		{
+		invalid.isNull();
+		return false;
+		}
+	catch(const std::runtime_error& err)
+		{
+		}
+	return !invalid.isValid();
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::string fileName;
+	size_t fileSize=64;
+	unsigned int numRuns=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				fileSize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"runs")==0&&i+1<argc)
+				numRuns=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			fileName=argv[i];
+		}
+	if(numRuns<1)
+		numRuns=1;
+	
+	try
+		{
+		bool passed=checkInvalidValue();
+		std::cout<<"Checking access to invalid values: "<<(passed?"passed":"FAILED")<<std::endl;
+		bool readOk=checkReadFailure(0)&&checkReadFailure(1000)&&checkReadFailure(200000);
+		std::cout<<"Checking read errors while loading documents: "<<(readOk?"passed":"FAILED")<<std::endl;
+		passed=passed&&readOk;
+		
+		/* Create a test file if none was given: */
+		bool temporary=fileName.empty();
+		if(temporary)
+			{
+			char tempName[]="/tmp/JsonBenchmarkXXXXXX";
+			int fd=mkstemp(tempName);
+			if(fd<0)
+				throw std::runtime_error("Unable to create temporary file");
+			close(fd);
+			fileName=tempName;
+			writeDocument(fileName.c_str(),fileSize*1024*1024);
+			}
+		size_t numBytes=IO::StandardFile(fileName.c_str()).getSize();
+		std::cout<<"Parsing "<<fileName<<" ("<<numBytes<<" bytes) "<<numRuns<<" times per parser:"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		
+		/* Parse the file with each method and keep the best time: */
+		static const char* methodNames[]={"JsonSource","JsonDocument from file","JsonDocument memory-mapped"};
+		Summary summaries[3];
+		double sourceRate=0.0;
+		for(int method=0;method<3;++method)
+			{
+			double bestTime=0.0;
+			size_t numValues=0;
+			for(unsigned int run=0;run<numRuns;++run)
+				{
+				Summary summary;
+				Realtime::TimePointMonotonic start;
+				if(method==0)
+					{
+					IO::JsonSource source(new IO::StandardFile(fileName.c_str()));
+					IO::JsonPointer root=source.parseEntity();
+					double elapsed(start.setAndDiff());
+					if(run==0||bestTime>elapsed)
+						bestTime=elapsed;
+					summarize(root,summary);
+					}
+				else
+					{
+					IO::JsonDocument* document;
+					if(method==1)
+						{
+						IO::StandardFile file(fileName.c_str());
+						document=new IO::JsonDocument(file);
+						}
+					else
+						document=new IO::JsonDocument(fileName.c_str());
+					double elapsed(start.setAndDiff());
+					if(run==0||bestTime>elapsed)
+						bestTime=elapsed;
+					numValues=document->getNumValues();
+					summarize(document->getRoot(),summary);
+					delete document;
+					}
+				summaries[method]=summary;
+				}
+			double rate=double(numBytes)/(bestTime*1024.0*1024.0);
+			if(method==0)
+				sourceRate=rate;
+			std::cout<<"  "<<std::setw(28)<<std::left<<methodNames[method]<<std::right<<std::setw(10)<<rate<<" MB/s";
+			if(method>0)
+				std::cout<<", "<<std::setprecision(2)<<rate/sourceRate<<"x JsonSource"<<std::setprecision(1);
+			std::cout<<std::endl;
+			
+			/* Compare the parse results against JsonSource: */
+			if(!(summaries[method]==summaries[0])||(method>0&&numValues!=summaries[method].numValues))
+				{
+				std::cout<<"  FAILED: "<<methodNames[method]<<" disagrees with JsonSource"<<std::endl;
+				passed=false;
+				}
+			}
+		std::cout<<"  "<<summaries[0].numValues<<" values, "<<summaries[0].numNulls<<" nulls, "<<summaries[0].numStringChars<<" string characters"<<std::endl;
+		
+		if(temporary)
+			unlink(fileName.c_str());
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
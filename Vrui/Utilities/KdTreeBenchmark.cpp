@@ -0,0 +1,178 @@
+/***********************************************************************
+KdTreeBenchmark - Utility to compare build and nearest-neighbour query
+times of Geometry::BucketKdTree against Geometry::ArrayKdTree on random
+point sets, and to check that both trees return the same neighbours.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Geometry/Point.h>
+#include <Geometry/ValuedPoint.h>
+#include <Geometry/ClosePointSet.h>
+#include <Geometry/ArrayKdTree.h>
+#include <Geometry/BucketKdTree.h>
+
+namespace {
+
+typedef Geometry::Point<float,3> Point;
+typedef Geometry::ValuedPoint<Point,unsigned int> StoredPoint;
+typedef Geometry::ArrayKdTree<StoredPoint> ArrayTree;
+typedef Geometry::BucketKdTree<StoredPoint> BucketTree;
+typedef Geometry::ClosePointSet<StoredPoint> ClosePointSet;
+
+/* Returns a random point in the cube [0, 100)^3: */
+Point randomPoint(void)
+	{
+	Point result;
+	for(int i=0;i<3;++i)
+		result[i]=float(rand())/float(RAND_MAX)*100.0f;
+	return result;
+	}
+
+/* Runs all queries for one tree size; returns false if the trees returned different neighbours: */
+bool benchmark(unsigned int numPoints,unsigned int numQueries)
+	{
+	/* Create the random point set and query positions: */
+	std::vector<StoredPoint> points;
+	points.reserve(numPoints);
+	for(unsigned int i=0;i<numPoints;++i)
+		points.push_back(StoredPoint(randomPoint(),i));
+	std::vector<Point> queries;
+	queries.reserve(numQueries);
+	for(unsigned int i=0;i<numQueries;++i)
+		queries.push_back(randomPoint());
+	
+	/* Build both trees: */
+	Realtime::TimePointMonotonic arrayBuildStart;
+	ArrayTree arrayTree(int(numPoints),&points[0]);
+	double arrayBuildTime(arrayBuildStart.setAndDiff());
+	Realtime::TimePointMonotonic bucketBuildStart;
+	BucketTree bucketTree(int(numPoints),&points[0]);
+	double bucketBuildTime(bucketBuildStart.setAndDiff());
+	std::cout<<std::setw(8)<<numPoints<<" points: build "<<std::setprecision(3)<<arrayBuildTime<<" s array, "<<bucketBuildTime<<" s bucket"<<std::endl;
+	
+	bool passed=true;
+	static const int ks[3]={1,8,32};
+	for(int ki=0;ki<3;++ki)
+		{
+		int k=ks[ki];
+		ClosePointSet arrayResult(k),bucketResult(k);
+		
+		/* Time single queries on both trees: */
+		Realtime::TimePointMonotonic arrayStart;
+		for(unsigned int i=0;i<numQueries;++i)
+			arrayTree.findClosestPoints(queries[i],arrayResult);
+		double arrayTime(arrayStart.setAndDiff());
+		Realtime::TimePointMonotonic bucketStart;
+		for(unsigned int i=0;i<numQueries;++i)
+			bucketTree.findClosestPoints(queries[i],bucketResult);
+		double bucketTime(bucketStart.setAndDiff());
+		
+		/* Time a parallel batch of queries on the bucket tree: */
+		std::vector<const StoredPoint*> batchNeighbours(size_t(numQueries)*size_t(k));
+		std::vector<float> batchSqrDists(size_t(numQueries)*size_t(k));
+		Realtime::TimePointMonotonic batchStart;
+		bucketTree.findClosestPoints(numQueries,&queries[0],k,&batchNeighbours[0],&batchSqrDists[0]);
+		double batchTime(batchStart.setAndDiff());
+		
+		/* Compare the results of all query methods: */
+		unsigned int numMismatches=0;
+		for(unsigned int i=0;i<numQueries;++i)
+			{
+			arrayTree.findClosestPoints(queries[i],arrayResult);
+			bucketTree.findClosestPoints(queries[i],bucketResult);
+			bool match=arrayResult.getNumPoints()==bucketResult.getNumPoints();
+			for(int j=0;match&&j<int(bucketResult.getNumPoints());++j)
+				{
+				size_t batchIndex=size_t(i)*size_t(k)+size_t(j);
+				match=arrayResult.getSqrDist(j)==bucketResult.getSqrDist(j)&&batchSqrDists[batchIndex]==bucketResult.getSqrDist(j)&&batchNeighbours[batchIndex]==&bucketResult.getPoint(j);
+				}
+			if(match&&k==1)
+				match=&bucketTree.findClosestPoint(queries[i])==&bucketResult.getPoint(0);
+			if(!match)
+				++numMismatches;
+			}
+		std::cout<<"  k="<<std::setw(2)<<k<<": "<<numQueries<<" queries "<<std::setprecision(3)<<arrayTime<<" s array, "<<bucketTime<<" s bucket ("<<std::setprecision(2)<<arrayTime/bucketTime<<"x), "<<std::setprecision(3)<<batchTime<<" s parallel batch, "<<numMismatches<<" mismatches"<<std::endl;
+		if(numMismatches!=0)
+			passed=false;
+		}
+	
+	return passed;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<unsigned int> pointCounts;
+	unsigned int numQueries=200000;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"points")==0&&i+1<argc)
+				pointCounts.push_back(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"queries")==0&&i+1<argc)
+				numQueries=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(pointCounts.empty())
+		{
+		/* Use the default set of tree sizes: */
+		pointCounts.push_back(10000);
+		pointCounts.push_back(100000);
+		pointCounts.push_back(1000000);
+		pointCounts.push_back(4000000);
+		}
+	if(numQueries<1)
+		numQueries=1;
+	
+	try
+		{
+		std::cout<<std::fixed;
+		bool passed=true;
+		srand(1);
+		for(std::vector<unsigned int>::iterator pcIt=pointCounts.begin();pcIt!=pointCounts.end();++pcIt)
+			if(*pcIt>0&&!benchmark(*pcIt,numQueries))
+				passed=false;
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
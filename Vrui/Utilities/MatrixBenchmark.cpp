@@ -0,0 +1,284 @@
+/***********************************************************************
+MatrixBenchmark - Utility to measure the throughput of Math::Matrix
+multiplication, QR decomposition, singular value decomposition, and
+Jacobi iteration, and to check their results against naive reference
+products and against the decompositions' defining properties.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Math/Matrix.h>
+
+namespace {
+
+/* Returns a matrix of the given size with random elements in [-0.5, 0.5]: */
+Math::Matrix randomMatrix(unsigned int numRows,unsigned int numColumns)
+	{
+	Math::Matrix result(numRows,numColumns);
+	for(unsigned int i=0;i<numRows;++i)
+		for(unsigned int j=0;j<numColumns;++j)
+			result(i,j)=double(rand())/double(RAND_MAX)-0.5;
+	return result;
+	}
+
+/* Returns the product of the two given matrices computed by the textbook triple loop: */
+Math::Matrix naiveProduct(const Math::Matrix& m1,const Math::Matrix& m2)
+	{
+	Math::Matrix result(m1.getNumRows(),m2.getNumColumns());
+	for(unsigned int i=0;i<m1.getNumRows();++i)
+		for(unsigned int j=0;j<m2.getNumColumns();++j)
+			{
+			double sum=0.0;
+			for(unsigned int k=0;k<m1.getNumColumns();++k)
+				sum+=m1(i,k)*m2(k,j);
+			result(i,j)=sum;
+			}
+	return result;
+	}
+
+/* Returns the largest absolute difference between corresponding elements of two matrices of the same size: */
+double maxDiff(const Math::Matrix& m1,const Math::Matrix& m2)
+	{
+	if(m1.getNumRows()!=m2.getNumRows()||m1.getNumColumns()!=m2.getNumColumns())
+		return HUGE_VAL;
+	double result=0.0;
+	for(unsigned int i=0;i<m1.getNumRows();++i)
+		for(unsigned int j=0;j<m1.getNumColumns();++j)
+			result=std::max(result,fabs(m1(i,j)-m2(i,j)));
+	return result;
+	}
+
+/* Returns the largest deviation of the given matrix' columns from an orthonormal set: */
+double orthogonalityError(const Math::Matrix& m)
+	{
+	Math::Matrix mtm;
+	mtm.setTransposeProduct(m,m);
+	return maxDiff(mtm,Math::Matrix(m.getNumColumns(),m.getNumColumns(),1.0));
+	}
+
+/* Returns the number of repetitions to spend roughly the given number of floating-point operations: */
+int getNumReps(double totalFlops,double flopsPerRep)
+	{
+	return std::max(1,int(totalFlops/flopsPerRep));
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	double flopBudget=2.0e8;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"flops")==0&&i+1<argc)
+				flopBudget=atof(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	
+	try
+		{
+		std::cout<<std::fixed;
+		bool passed=true;
+		srand(1);
+		
+		/* Compare square matrix products against the naive triple loop: */
+		std::cout<<"Multiplication n x n (GFLOP/s):"<<std::endl;
+		static const unsigned int productSizes[]={50,100,200,300,500};
+		for(int si=0;si<5;++si)
+			{
+			unsigned int n=productSizes[si];
+			Math::Matrix a=randomMatrix(n,n);
+			Math::Matrix b=randomMatrix(n,n);
+			double flops=2.0*double(n)*double(n)*double(n);
+			int numReps=getNumReps(flopBudget,flops);
+			
+			Realtime::TimePointMonotonic naiveStart;
+			Math::Matrix naive;
+			for(int rep=0;rep<numReps;++rep)
+				naive=naiveProduct(a,b);
+			double naiveTime(naiveStart.setAndDiff());
+			
+			Realtime::TimePointMonotonic blockedStart;
+			Math::Matrix blocked;
+			for(int rep=0;rep<numReps;++rep)
+				blocked.setProduct(a,b);
+			double blockedTime(blockedStart.setAndDiff());
+			
+			double error=maxDiff(blocked,naive);
+			std::cout<<"  "<<std::setw(4)<<n<<": naive "<<std::setprecision(2)<<std::setw(6)<<flops*double(numReps)*1.0e-9/naiveTime<<", Matrix "<<std::setw(6)<<flops*double(numReps)*1.0e-9/blockedTime<<" ("<<naiveTime/blockedTime<<"x), max difference "<<std::scientific<<error<<std::fixed<<std::endl;
+			if(error>1.0e-10)
+				passed=false;
+			}
+		
+		/* Check odd-sized products through all product entry points: */
+		double productError=0.0;
+		for(unsigned int r=1;r<40;r+=3)
+			for(unsigned int k=1;k<300;k+=37)
+				for(unsigned int c=1;c<280;c+=41)
+					{
+					Math::Matrix a=randomMatrix(r,k);
+					Math::Matrix b=randomMatrix(k,c);
+					Math::Matrix naive=naiveProduct(a,b);
+					productError=std::max(productError,maxDiff(a*b,naive));
+					Math::Matrix transposeProduct;
+					transposeProduct.setTransposeProduct(a.transpose(),b);
+					productError=std::max(productError,maxDiff(transposeProduct,naive));
+					a*=b;
+					productError=std::max(productError,maxDiff(a,naive));
+					}
+		std::cout<<"  Odd-sized products: max difference "<<std::scientific<<std::setprecision(2)<<productError<<std::fixed<<std::endl;
+		if(productError>1.0e-10)
+			passed=false;
+		
+		/* Measure thin and full QR decompositions and check their properties: */
+		std::cout<<"QR decomposition m x n (thin GFLOP/s at 4mn^2-4n^3/3 flops, full seconds):"<<std::endl;
+		static const unsigned int qrSizes[][2]={{100,50},{300,100},{500,200},{1000,100},{400,400},{50,120}};
+		for(int si=0;si<6;++si)
+			{
+			unsigned int m=qrSizes[si][0];
+			unsigned int n=qrSizes[si][1];
+			Math::Matrix a=randomMatrix(m,n);
+			unsigned int k=std::min(m,n);
+			double flops=std::max(4.0*double(m)*double(k)*double(k)-4.0*double(k)*double(k)*double(k)/3.0,1.0);
+			int numReps=getNumReps(flopBudget/4.0,flops);
+			
+			Realtime::TimePointMonotonic thinStart;
+			Math::Matrix thinQ,thinR;
+			for(int rep=0;rep<numReps;++rep)
+				a.qrDecomposition(thinQ,thinR,true);
+			double thinTime(thinStart.setAndDiff());
+			
+			Realtime::TimePointMonotonic fullStart;
+			Math::Matrix fullQ,fullR;
+			for(int rep=0;rep<numReps;++rep)
+				a.qrDecomposition(fullQ,fullR);
+			double fullTime=double(fullStart.setAndDiff())/double(numReps);
+			
+			/* Check reconstruction, orthogonality, and the shape of r: */
+			double error=std::max(maxDiff(naiveProduct(thinQ,thinR),a),maxDiff(naiveProduct(fullQ,fullR),a));
+			error=std::max(error,std::max(orthogonalityError(thinQ),orthogonalityError(fullQ)));
+			bool rShaped=fullQ.getNumRows()==m&&fullQ.getNumColumns()==m&&thinQ.getNumColumns()==k&&thinR.getNumRows()==k;
+			for(unsigned int i=0;i<fullR.getNumRows();++i)
+				for(unsigned int j=0;j<fullR.getNumColumns()&&j<=i;++j)
+					if(j<i?fullR(i,j)!=0.0:fullR(i,j)<0.0)
+						rShaped=false;
+			std::cout<<"  "<<std::setw(4)<<m<<"x"<<std::setw(4)<<std::left<<n<<std::right<<": thin "<<std::setprecision(2)<<std::setw(6)<<flops*double(numReps)*1.0e-9/thinTime<<", full "<<std::setprecision(4)<<fullTime<<" s, max error "<<std::scientific<<std::setprecision(2)<<error<<std::fixed<<(rShaped?"":", r is not upper triangular with non-negative diagonal")<<std::endl;
+			if(error>1.0e-12||!rShaped)
+				passed=false;
+			}
+		
+		/* Measure singular value decompositions and check their properties: */
+		std::cout<<"Singular value decomposition m x n with u and v (seconds):"<<std::endl;
+		static const unsigned int svdSizes[][2]={{50,50},{200,100},{300,300},{1000,100},{2000,200}};
+		for(int si=0;si<5;++si)
+			{
+			unsigned int m=svdSizes[si][0];
+			unsigned int n=svdSizes[si][1];
+			Math::Matrix a=randomMatrix(m,n);
+			int numReps=getNumReps(flopBudget/10.0,4.0*double(m)*double(n)*double(n));
+			
+			Realtime::TimePointMonotonic svdStart;
+			Math::SVD svd;
+			for(int rep=0;rep<numReps;++rep)
+				a.svd(svd,true,true);
+			double svdTime=double(svdStart.setAndDiff())/double(numReps);
+			
+			/* Check reconstruction, orthogonality, and ordering of the singular values: */
+			Math::Matrix us=svd.u;
+			bool sigmaOrdered=true;
+			for(unsigned int j=0;j<n;++j)
+				{
+				us.scaleColumn(j,svd.sigma(j));
+				if(svd.sigma(j)<0.0||(j>0&&svd.sigma(j)>svd.sigma(j-1)))
+					sigmaOrdered=false;
+				}
+			double error=maxDiff(naiveProduct(us,svd.v.transpose()),a);
+			error=std::max(error,std::max(orthogonalityError(svd.u),orthogonalityError(svd.v)));
+			std::cout<<"  "<<std::setw(4)<<m<<"x"<<std::setw(4)<<std::left<<n<<std::right<<": "<<std::setprecision(4)<<svdTime<<" s, max error "<<std::scientific<<std::setprecision(2)<<error<<std::fixed<<(sigmaOrdered?"":", singular values not in descending order")<<std::endl;
+			if(error>1.0e-11||!sigmaOrdered)
+				passed=false;
+			}
+		
+		/* Measure Jacobi iteration on symmetric matrices and check the eigenpairs: */
+		std::cout<<"Jacobi iteration on symmetric n x n (seconds):"<<std::endl;
+		static const unsigned int jacobiSizes[]={20,60,150};
+		for(int si=0;si<3;++si)
+			{
+			unsigned int n=jacobiSizes[si];
+			Math::Matrix b=randomMatrix(n,n);
+			Math::Matrix a;
+			a.setTransposeProduct(b,b);
+			int numReps=getNumReps(flopBudget/100.0,double(n)*double(n)*double(n));
+			
+			Realtime::TimePointMonotonic jacobiStart;
+			std::pair<Math::Matrix,Math::Matrix> qe;
+			for(int rep=0;rep<numReps;++rep)
+				qe=a.jacobiIteration();
+			double jacobiTime=double(jacobiStart.setAndDiff())/double(numReps);
+			
+			/* Check that the columns of q are orthonormal eigenvectors, relative to the largest eigenvalue: */
+			Math::Matrix qe2=qe.first;
+			double maxEigenvalue=0.0;
+			for(unsigned int j=0;j<n;++j)
+				{
+				qe2.scaleColumn(j,qe.second(j));
+				maxEigenvalue=std::max(maxEigenvalue,fabs(qe.second(j)));
+				}
+			double error=std::max(maxDiff(naiveProduct(a,qe.first),qe2)/maxEigenvalue,orthogonalityError(qe.first));
+			
+			/* Check that the eigenvalues of the positive semi-definite matrix match its singular values: */
+			std::vector<double> eigenvalues;
+			for(unsigned int j=0;j<n;++j)
+				eigenvalues.push_back(qe.second(j));
+			std::sort(eigenvalues.begin(),eigenvalues.end());
+			Math::SVD svd=a.svd(false,false);
+			for(unsigned int j=0;j<n;++j)
+				error=std::max(error,fabs(eigenvalues[n-1-j]-svd.sigma(j))/maxEigenvalue);
+			std::cout<<"  "<<std::setw(4)<<n<<": "<<std::setprecision(4)<<jacobiTime<<" s, max relative error "<<std::scientific<<std::setprecision(2)<<error<<std::fixed<<std::endl;
+			if(error>1.0e-9)
+				passed=false;
+			}
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
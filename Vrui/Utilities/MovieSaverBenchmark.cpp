@@ -0,0 +1,233 @@
+/***********************************************************************
+MovieSaverBenchmark - Utility to measure the render-thread cost and the
+shutdown drain time of the image sequence movie saver's capture
+pipeline, and to check that every captured frame is written to disk
+intact and in order.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/ConfigurationFile.h>
+#include <Misc/StandardValueCoders.h>
+#include <Realtime/Time.h>
+#include <Images/BaseImage.h>
+#include <Images/ReadImageFile.h>
+#include <Vrui/Internal/ImageSequenceMovieSaver.h>
+
+namespace {
+
+/* Fills the given RGBA frame with a uniform color encoding the given frame serial number: */
+void fillFrame(Vrui::MovieSaver::FrameBuffer& frame,unsigned int serial)
+	{
+	unsigned char* bPtr=frame.getBuffer();
+	size_t numPixels=size_t(frame.getFrameSize()[0])*size_t(frame.getFrameSize()[1]);
+	for(size_t i=0;i<numPixels;++i,bPtr+=4)
+		{
+		bPtr[0]=(unsigned char)(serial&0xffU);
+		bPtr[1]=(unsigned char)((serial>>8)&0xffU);
+		bPtr[2]=0x80U;
+		bPtr[3]=0xffU;
+		}
+	}
+
+/* Checks the frame image files written by one run; returns the number of missing, damaged, or out-of-order frames: */
+unsigned int checkFrames(const char* movieDirectory,unsigned int numFrames,const Vrui::ISize& frameSize)
+	{
+	unsigned int numBadFrames=0;
+	int lastSerial=-1;
+	for(unsigned int frameIndex=0;frameIndex<numFrames;++frameIndex)
+		{
+		char frameName[1024];
+		snprintf(frameName,sizeof(frameName),"%s/Frame%06u.ppm",movieDirectory,frameIndex);
+		try
+			{
+			/* Check that the frame has the correct size and format and a uniform color: */
+			Images::BaseImage image=Images::readGenericImageFile(frameName);
+			bool good=image.getWidth()==frameSize[0]&&image.getHeight()==frameSize[1]&&image.getNumChannels()==3U&&image.getChannelSize()==1U;
+			const unsigned char* pPtr=static_cast<const unsigned char*>(image.getPixels());
+			size_t numPixels=size_t(frameSize[0])*size_t(frameSize[1]);
+			for(size_t i=1;good&&i<numPixels;++i)
+				good=pPtr[i*3+0]==pPtr[0]&&pPtr[i*3+1]==pPtr[1]&&pPtr[i*3+2]==pPtr[2];
+			
+			/* Check that frames were written in the order in which they were rendered: */
+			int serial=int(pPtr[0])|(int(pPtr[1])<<8);
+			if(good&&pPtr[2]==0x80U&&serial>=lastSerial)
+				lastSerial=serial;
+			else
+				++numBadFrames;
+			}
+		catch(const std::runtime_error&)
+			{
+			/* The frame is missing or unreadable: */
+			++numBadFrames;
+			}
+		unlink(frameName);
+		}
+	
+	/* Check that no frames were written beyond the captured ones: */
+	char frameName[1024];
+	snprintf(frameName,sizeof(frameName),"%s/Frame%06u.ppm",movieDirectory,numFrames);
+	if(unlink(frameName)==0)
+		++numBadFrames;
+	
+	return numBadFrames;
+	}
+
+/* Records a movie with the given number of writer threads; returns false if the written frames do not match the captured ones: */
+bool benchmark(const Vrui::ISize& frameSize,double renderRate,double frameRate,double duration,unsigned int numWriterThreads)
+	{
+	/* Create a temporary directory to receive the movie frames: */
+	char movieDirectory[]="/tmp/MovieSaverBenchmarkXXXXXX";
+	if(mkdtemp(movieDirectory)==0)
+		throw std::runtime_error("Unable to create temporary movie directory");
+	
+	/* Configure an image sequence movie saver: */
+	Misc::ConfigurationFile configFile;
+	Misc::ConfigurationFileSection section=configFile.getCurrentSection();
+	section.storeString("./movieBaseDirectory",movieDirectory);
+	section.storeString("./movieFrameNameTemplate","Frame%06u.ppm");
+	section.storeValue("./movieFrameRate",frameRate);
+	section.storeValue("./movieNumWriterThreads",numWriterThreads);
+	Vrui::MovieSaver* movieSaver=new Vrui::ImageSequenceMovieSaver(section);
+	
+	/* Render frames at the given rate and measure the time spent handing them to the movie saver: */
+	unsigned int numRendered=(unsigned int)(duration*renderRate+0.5);
+	double postTime=0.0;
+	Realtime::TimePointMonotonic renderStart;
+	for(unsigned int serial=0;serial<numRendered;++serial)
+		{
+		/* Create a frame as a readback would: */
+		Vrui::MovieSaver::FrameBuffer& frame=movieSaver->startNewFrame();
+		frame.setFrameSize(frameSize,4);
+		frame.prepareWrite();
+		fillFrame(frame,serial);
+		
+		/* Post the frame: */
+		Realtime::TimePointMonotonic postStart;
+		movieSaver->postNewFrame();
+		postTime+=double(postStart.setAndDiff());
+		
+		/* Wait for the next render frame: */
+		double sleepTime=double(serial+1)/renderRate-double(Realtime::TimePointMonotonic()-renderStart);
+		if(sleepTime>0.0)
+			usleep((unsigned int)(sleepTime*1.0e6));
+		}
+	double renderTime(renderStart.setAndDiff());
+	Vrui::MovieSaver::Statistics stats=movieSaver->getStatistics();
+	
+	/* Shut down the movie saver and measure the time to drain its queue: */
+	Realtime::TimePointMonotonic drainStart;
+	delete movieSaver;
+	double drainTime(drainStart.setAndDiff());
+	
+	/* Check the frame image files; captures after taking the statistics are still written: */
+	unsigned int numFrames=stats.numCapturedFrames;
+	while(true)
+		{
+		char frameName[1024];
+		snprintf(frameName,sizeof(frameName),"%s/Frame%06u.ppm",movieDirectory,numFrames);
+		if(access(frameName,F_OK)!=0)
+			break;
+		++numFrames;
+		}
+	unsigned int numBadFrames=checkFrames(movieDirectory,numFrames,frameSize);
+	rmdir(movieDirectory);
+	
+	std::cout<<"  "<<numWriterThreads<<" writer thread(s): "<<std::setprecision(3)<<renderTime<<" s rendering, "<<stats.numCapturedFrames<<" captured, "<<stats.numDroppedFrames<<" dropped, maximum queue depth "<<stats.maxQueueDepth<<", post "<<postTime*1.0e3/double(numRendered)<<" ms/frame, drain "<<drainTime<<" s, "<<numFrames<<" written, "<<numBadFrames<<" bad"<<std::endl;
+	
+	/* Expect at least the captured frames and at most one more per frame interval spent shutting down: */
+	unsigned int maxNumFrames=stats.numCapturedFrames+(unsigned int)(drainTime*frameRate)+1U;
+	return numBadFrames==0&&numFrames>=stats.numCapturedFrames&&numFrames<=maxNumFrames;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Vrui::ISize frameSize(1280,720);
+	double renderRate=90.0;
+	double frameRate=30.0;
+	double duration=2.0;
+	std::vector<unsigned int> writerThreadCounts;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+2<argc)
+				{
+				frameSize[0]=atoi(argv[++i]);
+				frameSize[1]=atoi(argv[++i]);
+				}
+			else if(strcasecmp(argv[i]+1,"renderRate")==0&&i+1<argc)
+				renderRate=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"frameRate")==0&&i+1<argc)
+				frameRate=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"duration")==0&&i+1<argc)
+				duration=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				writerThreadCounts.push_back(atoi(argv[++i]));
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(writerThreadCounts.empty())
+		{
+		/* Use the default set of writer thread counts: */
+		writerThreadCounts.push_back(1);
+		writerThreadCounts.push_back(2);
+		writerThreadCounts.push_back(4);
+		}
+	if(frameSize[0]<1||frameSize[1]<1||renderRate<=0.0||frameRate<=0.0||duration<=0.0)
+		{
+		std::cerr<<"Invalid frame size, rates, or duration"<<std::endl;
+		return 1;
+		}
+	
+	try
+		{
+		std::cout<<std::fixed<<std::setprecision(1);
+		std::cout<<"Recording "<<frameSize[0]<<"x"<<frameSize[1]<<" RGBA frames rendered at "<<renderRate<<" Hz into a "<<frameRate<<" Hz image sequence"<<std::endl;
+		bool passed=true;
+		for(std::vector<unsigned int>::iterator wtcIt=writerThreadCounts.begin();wtcIt!=writerThreadCounts.end();++wtcIt)
+			if(!benchmark(frameSize,renderRate,frameRate,duration,*wtcIt))
+				passed=false;
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
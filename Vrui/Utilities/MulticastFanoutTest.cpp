@@ -0,0 +1,308 @@
+/***********************************************************************
+MulticastFanoutTest - Loopback test running a VR device server with a
+multicast group and many streaming device clients in one process, to
+verify that all clients receive state updates from the multicast group
+and to compare the cost of multicast and per-client TCP fan-out.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/FunctionCalls.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/CompoundValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
+#include <Threads/Thread.h>
+#include <Threads/EventDispatcher.h>
+#include <Comm/Pipe.h>
+#include <Vrui/Internal/VRDeviceClient.h>
+
+#include <VRDeviceDaemon/Config.h>
+#include <VRDeviceDaemon/VRDeviceManager.h>
+#include <VRDeviceDaemon/VRDeviceServer.h>
+
+namespace {
+
+/*************************************************************
+Helper class to run an event dispatcher in a separate thread:
+*************************************************************/
+
+class DispatcherThread
+	{
+	/* Elements: */
+	private:
+	Threads::EventDispatcher& dispatcher; // The event dispatcher
+	VRDeviceServer* server; // Device server whose main loop to run, or null to dispatch events directly
+	Threads::Thread thread; // The thread running the dispatcher
+	
+	/* Private methods: */
+	void* threadMethod(void)
+		{
+		if(server!=0)
+			server->run();
+		else
+			dispatcher.dispatchEvents();
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	DispatcherThread(Threads::EventDispatcher& sDispatcher,VRDeviceServer* sServer)
+		:dispatcher(sDispatcher),server(sServer)
+		{
+		thread.start(this,&DispatcherThread::threadMethod);
+		}
+	~DispatcherThread(void)
+		{
+		dispatcher.stop();
+		thread.join();
+		}
+	};
+
+/*********************************************
+Streaming device client counting its packets:
+*********************************************/
+
+class CountingClient
+	{
+	/* Elements: */
+	private:
+	Vrui::VRDeviceClient client; // The device client
+	unsigned int numPackets; // Number of state updates received in streaming mode
+	
+	/* Private methods: */
+	void packetNotificationCallback(Vrui::VRDeviceClient* client)
+		{
+		++numPackets;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	CountingClient(Threads::EventDispatcher& dispatcher,const char* hostName,int port,bool useMulticast)
+		:client(dispatcher,hostName,port),numPackets(0)
+		{
+		client.setUseMulticast(useMulticast);
+		}
+	
+	/* Methods: */
+	bool hasMulticast(void) const
+		{
+		return client.hasMulticast();
+		}
+	void start(void)
+		{
+		client.activate();
+		client.startStream(Misc::createFunctionCall(this,&CountingClient::packetNotificationCallback));
+		}
+	void stop(void)
+		{
+		client.stopStream();
+		client.deactivate();
+		}
+	unsigned int getNumPackets(void) const
+		{
+		return numPackets;
+		}
+	unsigned int getNumLostUpdates(void) const
+		{
+		return client.getNumLostMulticastUpdates();
+		}
+	};
+
+double getCpuTime(void) // Returns the user and system CPU time consumed by the process so far in seconds
+	{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return double(usage.ru_utime.tv_sec+usage.ru_stime.tv_sec)+double(usage.ru_utime.tv_usec+usage.ru_stime.tv_usec)*1.0e-6;
+	}
+
+/* Runs all clients in streaming mode for the given time and prints statistics; returns false if any client fell short: */
+bool runClients(const char* hostName,int port,unsigned int numClients,bool useMulticast,int updateRate,double runTime)
+	{
+	/* Run all clients from a shared event dispatcher in a background thread: */
+	Threads::EventDispatcher clientDispatcher;
+	DispatcherThread* clientThread=new DispatcherThread(clientDispatcher,0);
+	
+	/* Connect all clients and start streaming: */
+	std::vector<CountingClient*> clients;
+	for(unsigned int i=0;i<numClients;++i)
+		clients.push_back(new CountingClient(clientDispatcher,hostName,port,useMulticast));
+	if(useMulticast&&!clients.front()->hasMulticast())
+		{
+		std::cout<<"Device server does not advertise a multicast group"<<std::endl;
+		delete clientThread;
+		for(std::vector<CountingClient*>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+			delete *cIt;
+		return false;
+		}
+	for(std::vector<CountingClient*>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		(*cIt)->start();
+	
+	/* Let the clients receive updates: */
+	double cpuStart=getCpuTime();
+	Realtime::TimePointMonotonic start;
+	usleep((unsigned int)(runTime*1.0e6+0.5));
+	double elapsed(start.setAndDiff());
+	double cpuTime=getCpuTime()-cpuStart;
+	
+	/* Stop streaming and collect statistics: */
+	unsigned int minPackets=~0U,maxPackets=0U,totalPackets=0U,totalLost=0U;
+	for(std::vector<CountingClient*>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		{
+		(*cIt)->stop();
+		unsigned int numPackets=(*cIt)->getNumPackets();
+		if(minPackets>numPackets)
+			minPackets=numPackets;
+		if(maxPackets<numPackets)
+			maxPackets=numPackets;
+		totalPackets+=numPackets;
+		totalLost+=(*cIt)->getNumLostUpdates();
+		}
+	
+	/* Stop the event dispatcher before destroying the clients, so that no more events can be delivered to them: */
+	delete clientThread;
+	for(std::vector<CountingClient*>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		delete *cIt;
+	
+	std::cout<<(useMulticast?"Multicast":"TCP")<<" fan-out to "<<numClients<<" clients:"<<std::endl;
+	std::cout<<"  Updates per client: min "<<double(minPackets)/elapsed<<"/s, max "<<double(maxPackets)/elapsed<<"/s, total "<<double(totalPackets)/elapsed<<"/s"<<std::endl;
+	if(useMulticast)
+		std::cout<<"  Lost multicast updates: "<<totalLost<<" ("<<double(totalLost)*100.0/double(totalPackets+totalLost)<<"%)"<<std::endl;
+	std::cout<<"  Process CPU time: "<<cpuTime*100.0/elapsed<<"% of one core, "<<cpuTime*1.0e6/(elapsed*double(updateRate))<<" us per device state update, including all clients"<<std::endl;
+	
+	/* Every client must have received at least half of the server's updates: */
+	return double(minPackets)>=0.5*double(updateRate)*elapsed;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numClients=32;
+	int numTrackers=3;
+	int updateRate=90;
+	double runTime=5.0;
+	int serverPort=8555;
+	std::string multicastGroup="239.255.85.55";
+	int multicastPort=8556;
+	std::string deviceDirectory=VRDEVICEDAEMON_CONFIG_VRDEVICESDIR;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"clients")==0&&i+1<argc)
+				numClients=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"trackers")==0&&i+1<argc)
+				numTrackers=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"rate")==0&&i+1<argc)
+				updateRate=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"time")==0&&i+1<argc)
+				runTime=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"port")==0&&i+1<argc)
+				serverPort=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"group")==0&&i+1<argc)
+				multicastGroup=argv[++i];
+			else if(strcasecmp(argv[i]+1,"groupPort")==0&&i+1<argc)
+				multicastPort=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"deviceDirectory")==0&&i+1<argc)
+				deviceDirectory=argv[++i];
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(numClients<1)
+		numClients=1;
+	if(updateRate<1)
+		updateRate=1;
+	
+	/* Create an empty environment definition file, as the device server requires one: */
+	char environmentFileName[]="/tmp/MulticastFanoutTestXXXXXX.cfg";
+	int environmentFd=mkstemps(environmentFileName,4);
+	if(environmentFd<0)
+		{
+		std::cerr<<"Unable to create temporary environment definition file"<<std::endl;
+		return 1;
+		}
+	close(environmentFd);
+	
+	/* Create a device server configuration with a single dummy device, listening on TCP and sending to a multicast group: */
+	Misc::ConfigurationFile configFile;
+	configFile.setCurrentSection("/DeviceManager");
+	configFile.storeString("./deviceDirectory",deviceDirectory);
+	std::vector<std::string> deviceNames;
+	deviceNames.push_back("FanoutDevice");
+	configFile.storeValue("./deviceNames",deviceNames);
+	configFile.setCurrentSection("FanoutDevice");
+	configFile.storeString("./deviceType","DummyDevice");
+	configFile.storeValue("./numTrackers",numTrackers);
+	configFile.storeValue("./numButtons",4);
+	configFile.storeValue("./numValuators",2);
+	configFile.storeValue("./sleepTime",1000000/updateRate);
+	configFile.setCurrentSection("/DeviceServer");
+	configFile.storeString("./environmentDefinition",environmentFileName);
+	configFile.storeValue("./serverPort",serverPort);
+	configFile.storeString("./multicastGroup",multicastGroup);
+	configFile.storeValue("./multicastPort",multicastPort);
+	
+	bool passed=true;
+	try
+		{
+		/* Create the device manager and server and run the server in a background thread: */
+		Comm::ignorePipeSignals();
+		Threads::EventDispatcher serverDispatcher;
+		configFile.setCurrentSection("/DeviceManager");
+		VRDeviceManager deviceManager(serverDispatcher,configFile);
+		configFile.setCurrentSection("/DeviceServer");
+		VRDeviceServer server(serverDispatcher,&deviceManager,configFile);
+		DispatcherThread serverThread(serverDispatcher,&server);
+		
+		std::cout<<std::fixed<<std::setprecision(2);
+		std::cout<<"Streaming "<<numTrackers<<" trackers at "<<updateRate<<" Hz via multicast group "<<multicastGroup<<':'<<multicastPort<<" for "<<runTime<<" s per test"<<std::endl;
+		if(!runClients("localhost",serverPort,numClients,true,updateRate,runTime))
+			passed=false;
+		if(!runClients("localhost",serverPort,numClients,false,updateRate,runTime))
+			passed=false;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Test failed due to exception "<<err.what()<<std::endl;
+		passed=false;
+		}
+	unlink(environmentFileName);
+	
+	if(passed)
+		std::cout<<"PASSED: All clients received state updates"<<std::endl;
+	else
+		std::cout<<"FAILED: At least one client did not receive enough state updates"<<std::endl;
+	return passed?0:1;
+	}
@@ -0,0 +1,383 @@
+/***********************************************************************
+MulticastPipeBenchmark - Loopback harness running a cluster master and
+several slave processes on the local host to measure the throughput and
+barrier latency of a Cluster::MulticastPipe under simulated packet
+loss, and to verify that all slaves receive the exact stream data.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Realtime/Time.h>
+#include <Threads/Thread.h>
+#include <Cluster/Packet.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+
+namespace {
+
+/*********************************************************************
+Helper class to forward datagrams sent by the master to the slaves'
+individual ports on the local host, dropping each datagram for each
+slave independently with a given probability:
+*********************************************************************/
+
+class LossyRelay
+	{
+	/* Elements: */
+	private:
+	int socketFd; // UDP socket receiving the master's datagrams
+	std::vector<sockaddr_in> slaveAddresses; // Addresses of the slaves' communication sockets
+	double lossRate; // Probability of dropping a datagram for each slave
+	Misc::UInt32 randomState; // State of the random number generator deciding which datagrams to drop
+	unsigned int numForwarded; // Number of datagrams forwarded to slaves
+	unsigned int numDropped; // Number of datagrams dropped
+	Threads::Thread thread; // The relay thread
+	
+	/* Private methods: */
+	double random(void) // Returns a uniformly distributed random number in [0, 1)
+		{
+		randomState=randomState*1664525U+1013904223U;
+		return double(randomState>>8)/double(1U<<24);
+		}
+	void* threadMethod(void)
+		{
+		Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
+		Threads::Thread::setCancelType(Threads::Thread::CANCEL_DEFERRED);
+		
+		char buffer[Cluster::Packet::maxRawPacketSize];
+		while(true)
+			{
+			ssize_t numBytesReceived=recv(socketFd,buffer,sizeof(buffer),0);
+			if(numBytesReceived<0)
+				continue;
+			for(std::vector<sockaddr_in>::iterator saIt=slaveAddresses.begin();saIt!=slaveAddresses.end();++saIt)
+				{
+				if(random()>=lossRate)
+					{
+					sendto(socketFd,buffer,numBytesReceived,0,(const sockaddr*)&*saIt,sizeof(sockaddr_in));
+					++numForwarded;
+					}
+				else
+					++numDropped;
+				}
+			}
+		
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	LossyRelay(int relayPort,int slaveBasePort,unsigned int numSlaves,double sLossRate)
+		:socketFd(socket(PF_INET,SOCK_DGRAM,0)),
+		 lossRate(sLossRate),randomState(12345U),
+		 numForwarded(0),numDropped(0)
+		{
+		if(socketFd<0)
+			throw std::runtime_error("LossyRelay: Unable to create socket");
+		
+		/* Bind the socket to the relay port on the loopback interface: */
+		sockaddr_in socketAddress;
+		memset(&socketAddress,0,sizeof(sockaddr_in));
+		socketAddress.sin_family=AF_INET;
+		socketAddress.sin_port=htons(relayPort);
+		socketAddress.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+		if(bind(socketFd,(struct sockaddr*)&socketAddress,sizeof(sockaddr_in))==-1)
+			{
+			close(socketFd);
+			throw std::runtime_error("LossyRelay: Unable to bind socket");
+			}
+		
+		/* Store the slaves' addresses: */
+		for(unsigned int i=0;i<numSlaves;++i)
+			{
+			socketAddress.sin_port=htons(slaveBasePort+i);
+			slaveAddresses.push_back(socketAddress);
+			}
+		
+		thread.start(this,&LossyRelay::threadMethod);
+		}
+	~LossyRelay(void)
+		{
+		thread.cancel();
+		thread.join();
+		close(socketFd);
+		}
+	
+	/* Methods: */
+	unsigned int getNumForwarded(void) const
+		{
+		return numForwarded;
+		}
+	unsigned int getNumDropped(void) const
+		{
+		return numDropped;
+		}
+	};
+
+/* Returns the stream data word at the given index: */
+inline Misc::UInt32 streamWord(size_t index)
+	{
+	return Misc::UInt32(index)*2654435761U+0x9e3779b9U;
+	}
+
+/* Benchmark parameters shared by the master and all slaves: */
+struct Parameters
+	{
+	/* Elements: */
+	public:
+	unsigned int numSlaves; // Number of slave processes
+	int masterPort; // Port of the master's communication socket
+	int relayPort; // Port of the lossy relay
+	int slaveBasePort; // Port of the first slave's communication socket
+	double lossRate; // Simulated packet loss probability
+	size_t numWords; // Number of 32-bit words to stream from the master to the slaves
+	size_t blockSize; // Number of words written or read in one call
+	unsigned int numBarriers; // Number of barriers to time
+	bool treeBarriers; // Flag whether to use tree barriers instead of central barriers
+	};
+
+/* Creates and configures a multiplexer for the given node with the same settings Vrui uses by default: */
+Cluster::Multiplexer* createMultiplexer(const Parameters& p,unsigned int nodeIndex)
+	{
+	int slavePort=nodeIndex==0?p.relayPort:p.slaveBasePort+int(nodeIndex)-1;
+	Cluster::Multiplexer* multiplexer=new Cluster::Multiplexer(p.numSlaves,nodeIndex,"127.0.0.1",p.masterPort,"127.0.0.1",slavePort);
+	multiplexer->setConnectionWaitTimeout(0.1);
+	multiplexer->setPingTimeout(10.0,3);
+	multiplexer->setReceiveWaitTimeout(0.01);
+	multiplexer->setBarrierWaitTimeout(0.01);
+	multiplexer->setNackTimeout(0.005);
+	if(p.treeBarriers)
+		multiplexer->setDefaultBarrierMode(Cluster::Multiplexer::TREE);
+	multiplexer->waitForConnection();
+	return multiplexer;
+	}
+
+/* Runs a slave node; returns true if the slave received the exact stream data: */
+bool runSlave(const Parameters& p,unsigned int nodeIndex)
+	{
+	Cluster::Multiplexer* multiplexer=createMultiplexer(p,nodeIndex);
+	bool ok=true;
+	{
+	Cluster::MulticastPipe pipe(multiplexer);
+	pipe.barrier();
+	
+	/* Receive and check the stream data: */
+	std::vector<Misc::UInt32> block(p.blockSize);
+	for(size_t base=0;base<p.numWords;base+=p.blockSize)
+		{
+		size_t numWords=p.numWords-base<p.blockSize?p.numWords-base:p.blockSize;
+		pipe.readRaw(&block[0],numWords*sizeof(Misc::UInt32));
+		for(size_t i=0;i<numWords;++i)
+			if(block[i]!=streamWord(base+i))
+				ok=false;
+		}
+	pipe.barrier();
+	
+	/* Participate in the timed barriers: */
+	for(unsigned int i=0;i<p.numBarriers;++i)
+		pipe.barrier();
+	}
+	delete multiplexer;
+	
+	return ok;
+	}
+
+/* Runs the master node and all slaves at the given loss rate and prints results; returns true if all slaves received the exact stream data: */
+bool runSession(const Parameters& p)
+	{
+	/* Fork the slave processes: */
+	std::vector<pid_t> slaves;
+	for(unsigned int nodeIndex=1;nodeIndex<=p.numSlaves;++nodeIndex)
+		{
+		pid_t pid=fork();
+		if(pid==0)
+			{
+			bool ok=false;
+			try
+				{
+				ok=runSlave(p,nodeIndex);
+				if(!ok)
+					fprintf(stderr,"Slave %u: Received corrupted stream data\n",nodeIndex);
+				}
+			catch(const std::runtime_error& err)
+				{
+				fprintf(stderr,"Slave %u: Terminated due to exception %s\n",nodeIndex,err.what());
+				}
+			_exit(ok?0:1);
+			}
+		else if(pid>0)
+			slaves.push_back(pid);
+		else
+			throw std::runtime_error("Unable to fork slave process");
+		}
+	
+	bool ok=true;
+	{
+	/* Create the relay and the master's multiplexer and pipe: */
+	LossyRelay relay(p.relayPort,p.slaveBasePort,p.numSlaves,p.lossRate);
+	Cluster::Multiplexer* multiplexer=createMultiplexer(p,0);
+	{
+	Cluster::MulticastPipe pipe(multiplexer);
+	pipe.barrier();
+	
+	/* Stream the data and wait until all slaves received it: */
+	std::vector<Misc::UInt32> block(p.blockSize);
+	Realtime::TimePointMonotonic start;
+	for(size_t base=0;base<p.numWords;base+=p.blockSize)
+		{
+		size_t numWords=p.numWords-base<p.blockSize?p.numWords-base:p.blockSize;
+		for(size_t i=0;i<numWords;++i)
+			block[i]=streamWord(base+i);
+		pipe.writeRaw(&block[0],numWords*sizeof(Misc::UInt32));
+		}
+	pipe.barrier();
+	double streamTime(start.setAndDiff());
+	
+	/* Time a sequence of barriers: */
+	double minLatency=1.0e10,maxLatency=0.0,sumLatency=0.0;
+	for(unsigned int i=0;i<p.numBarriers;++i)
+		{
+		Realtime::TimePointMonotonic barrierStart;
+		pipe.barrier();
+		double latency(barrierStart.setAndDiff());
+		if(minLatency>latency)
+			minLatency=latency;
+		if(maxLatency<latency)
+			maxLatency=latency;
+		sumLatency+=latency;
+		}
+	
+	std::cout<<std::setw(6)<<p.lossRate*100.0<<'%';
+	std::cout<<std::setw(12)<<double(p.numWords*sizeof(Misc::UInt32))/(streamTime*1024.0*1024.0);
+	if(p.numBarriers>0)
+		{
+		std::cout<<std::setw(12)<<minLatency*1.0e6;
+		std::cout<<std::setw(12)<<sumLatency*1.0e6/double(p.numBarriers);
+		std::cout<<std::setw(12)<<maxLatency*1.0e6;
+		}
+	else
+		std::cout<<std::setw(12)<<'-'<<std::setw(12)<<'-'<<std::setw(12)<<'-';
+	std::cout<<std::setw(12)<<relay.getNumDropped()<<'/'<<relay.getNumForwarded()+relay.getNumDropped()<<std::endl;
+	}
+	
+	/* Collect the slaves' results before shutting down the master, which might still have to answer retransmitted barrier messages: */
+	for(std::vector<pid_t>::iterator sIt=slaves.begin();sIt!=slaves.end();++sIt)
+		{
+		int status;
+		if(waitpid(*sIt,&status,0)!=*sIt||!WIFEXITED(status)||WEXITSTATUS(status)!=0)
+			ok=false;
+		}
+	delete multiplexer;
+	}
+	
+	return ok;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Parameters p;
+	p.numSlaves=1;
+	p.masterPort=26100;
+	p.relayPort=26101;
+	p.slaveBasePort=26110;
+	p.lossRate=0.0;
+	size_t streamSize=256;
+	p.blockSize=Cluster::Packet::maxPacketSize*4/sizeof(Misc::UInt32);
+	p.numBarriers=1000;
+	p.treeBarriers=false;
+	std::vector<double> lossRates;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"slaves")==0&&i+1<argc)
+				p.numSlaves=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"loss")==0&&i+1<argc)
+				lossRates.push_back(atof(argv[++i])/100.0);
+			else if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				streamSize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"barriers")==0&&i+1<argc)
+				p.numBarriers=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"tree")==0)
+				p.treeBarriers=true;
+			else if(strcasecmp(argv[i]+1,"port")==0&&i+1<argc)
+				{
+				p.masterPort=atoi(argv[++i]);
+				p.relayPort=p.masterPort+1;
+				p.slaveBasePort=p.masterPort+10;
+				}
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(p.numSlaves<1)
+		p.numSlaves=1;
+	p.numWords=streamSize*1024*1024/sizeof(Misc::UInt32);
+	if(lossRates.empty())
+		{
+		/* Compare loss-free operation against moderate and heavy packet loss: */
+		lossRates.push_back(0.0);
+		lossRates.push_back(0.01);
+		lossRates.push_back(0.05);
+		}
+	
+	bool passed=true;
+	try
+		{
+		std::cout<<"Streaming "<<streamSize<<" MB to "<<p.numSlaves<<" slave(s) over loopback, then timing "<<p.numBarriers<<(p.treeBarriers?" tree":" central")<<" barriers"<<std::endl;
+		std::cout<<std::setw(7)<<"Loss"<<std::setw(12)<<"MB/s"<<std::setw(12)<<"Min us"<<std::setw(12)<<"Mean us"<<std::setw(12)<<"Max us"<<std::setw(12)<<"Dropped"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		for(std::vector<double>::iterator lrIt=lossRates.begin();lrIt!=lossRates.end();++lrIt)
+			{
+			p.lossRate=*lrIt;
+			if(!runSession(p))
+				passed=false;
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	if(passed)
+		std::cout<<"PASSED: All slaves received the exact stream data"<<std::endl;
+	else
+		std::cout<<"FAILED: At least one slave received corrupted data or terminated abnormally"<<std::endl;
+	return passed?0:1;
+	}
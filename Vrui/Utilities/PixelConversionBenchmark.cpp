@@ -0,0 +1,556 @@
+/***********************************************************************
+PixelConversionBenchmark - Utility to check the pixel format conversions
+and mipmap downsampling in Images::BaseImage against straightforward
+reference loops, and to compare their performance.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <GL/gl.h>
+#include <Images/BaseImage.h>
+
+namespace {
+
+/********************************************************************
+Reference conversion of color components to 8-bit unsigned integers:
+********************************************************************/
+
+inline GLubyte toUByte(GLbyte value)
+	{
+	if(value<GLbyte(0))
+		return GLubyte(0);
+	GLubyte v(value);
+	return (v<<1)|(v>>6);
+	}
+
+inline GLubyte toUByte(GLshort value)
+	{
+	return value<GLshort(0)?GLubyte(0):GLubyte(value>>7);
+	}
+
+inline GLubyte toUByte(GLushort value)
+	{
+	return GLubyte(value>>8);
+	}
+
+inline GLubyte toUByte(GLint value)
+	{
+	return value<GLint(0)?GLubyte(0):GLubyte(value>>23);
+	}
+
+inline GLubyte toUByte(GLuint value)
+	{
+	return GLubyte(value>>24);
+	}
+
+inline GLubyte toUByte(GLfloat value)
+	{
+	if(value<0.0f)
+		return GLubyte(0);
+	else if(value>=1.0f)
+		return GLubyte(255);
+	else
+		return GLubyte(value*256.0f);
+	}
+
+inline GLubyte toUByte(GLdouble value)
+	{
+	if(value<0.0)
+		return GLubyte(0);
+	else if(value>=1.0)
+		return GLubyte(255);
+	else
+		return GLubyte(value*256.0);
+	}
+
+/******************************************************************
+Accumulator types for integer luminance and downsampling averages:
+******************************************************************/
+
+template <class ScalarParam>
+struct Accumulator
+	{
+	};
+
+template <>
+struct Accumulator<GLubyte>
+	{
+	typedef unsigned short Type;
+	};
+
+template <>
+struct Accumulator<GLushort>
+	{
+	typedef unsigned int Type;
+	};
+
+/*******************************
+Reference operations on images:
+*******************************/
+
+enum Operation
+	{
+	TOUINT8,DROPALPHA,ADDALPHA,TOGREY,TORGB,SHRINK
+	};
+
+const char* operationNames[]={"toUInt8","dropAlpha","addAlpha","toGrey","toRgb","shrink"};
+
+template <class ScalarParam>
+void referenceToUInt8(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	GLubyte* dPtr=static_cast<GLubyte*>(dest.replacePixels());
+	size_t numSamples=size_t(source.getWidth())*size_t(source.getHeight())*source.getNumChannels();
+	for(size_t i=0;i<numSamples;++i)
+		dPtr[i]=toUByte(sPtr[i]);
+	}
+
+template <class ScalarParam>
+void referenceDropAlpha(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int numChannels=dest.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	for(size_t i=size_t(source.getWidth())*size_t(source.getHeight());i>0;--i,++sPtr)
+		for(unsigned int j=0;j<numChannels;++j)
+			*(dPtr++)=*(sPtr++);
+	}
+
+template <class ScalarParam>
+void referenceAddAlpha(const Images::BaseImage& source,Images::BaseImage& dest,ScalarParam alpha)
+	{
+	unsigned int numChannels=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	for(size_t i=size_t(source.getWidth())*size_t(source.getHeight());i>0;--i)
+		{
+		for(unsigned int j=0;j<numChannels;++j)
+			*(dPtr++)=*(sPtr++);
+		*(dPtr++)=alpha;
+		}
+	}
+
+template <class ScalarParam>
+void referenceToGreyInt(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	typedef typename Accumulator<ScalarParam>::Type Weight;
+	unsigned int numChannels=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	for(size_t i=size_t(source.getWidth())*size_t(source.getHeight());i>0;--i,sPtr+=numChannels)
+		{
+		*(dPtr++)=ScalarParam((Weight(sPtr[0])*Weight(77)+Weight(sPtr[1])*Weight(150)+Weight(sPtr[2])*Weight(29))>>Weight(8));
+		if(numChannels==4)
+			*(dPtr++)=sPtr[3];
+		}
+	}
+
+void referenceToGreyFloat(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int numChannels=source.getNumChannels();
+	const GLfloat* sPtr=static_cast<const GLfloat*>(source.getPixels());
+	GLfloat* dPtr=static_cast<GLfloat*>(dest.replacePixels());
+	for(size_t i=size_t(source.getWidth())*size_t(source.getHeight());i>0;--i,sPtr+=numChannels)
+		{
+		*(dPtr++)=sPtr[0]*GLfloat(0.299)+sPtr[1]*GLfloat(0.587)+sPtr[2]*GLfloat(0.114);
+		if(numChannels==4)
+			*(dPtr++)=sPtr[3];
+		}
+	}
+
+template <class ScalarParam>
+void referenceToRgb(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int numChannels=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	for(size_t i=size_t(source.getWidth())*size_t(source.getHeight());i>0;--i,sPtr+=numChannels)
+		{
+		*(dPtr++)=sPtr[0];
+		*(dPtr++)=sPtr[0];
+		*(dPtr++)=sPtr[0];
+		if(numChannels==2)
+			*(dPtr++)=sPtr[1];
+		}
+	}
+
+template <class ScalarParam>
+void referenceShrinkInt(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	typedef typename Accumulator<ScalarParam>::Type Accum;
+	unsigned int nc=source.getNumChannels();
+	ptrdiff_t stride=ptrdiff_t(source.getWidth())*nc;
+	const ScalarParam* sRowPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	for(unsigned int y=0;y<source.getHeight();y+=2,sRowPtr+=stride*2)
+		for(unsigned int x=0;x<source.getWidth();x+=2)
+			for(unsigned int i=0;i<nc;++i,++dPtr)
+				{
+				const ScalarParam* s0Ptr=sRowPtr+x*nc+i;
+				const ScalarParam* s1Ptr=s0Ptr+stride;
+				Accum sum0=Accum(s0Ptr[0])+Accum(s0Ptr[nc]);
+				Accum sum1=Accum(s1Ptr[0])+Accum(s1Ptr[nc]);
+				*dPtr=ScalarParam((sum0+sum1+2)>>2);
+				}
+	}
+
+void referenceShrinkFloat(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int nc=source.getNumChannels();
+	ptrdiff_t stride=ptrdiff_t(source.getWidth())*nc;
+	const GLfloat* sRowPtr=static_cast<const GLfloat*>(source.getPixels());
+	GLfloat* dPtr=static_cast<GLfloat*>(dest.replacePixels());
+	for(unsigned int y=0;y<source.getHeight();y+=2,sRowPtr+=stride*2)
+		for(unsigned int x=0;x<source.getWidth();x+=2)
+			for(unsigned int i=0;i<nc;++i,++dPtr)
+				{
+				const GLfloat* s0Ptr=sRowPtr+x*nc+i;
+				const GLfloat* s1Ptr=s0Ptr+stride;
+				*dPtr=(s0Ptr[0]+s0Ptr[nc]+s1Ptr[0]+s1Ptr[nc])*GLfloat(0.25);
+				}
+	}
+
+/* Returns the pixel format for the given number of channels: */
+GLenum getFormat(unsigned int numChannels)
+	{
+	static const GLenum formats[]={GL_LUMINANCE,GL_LUMINANCE_ALPHA,GL_RGB,GL_RGBA};
+	return formats[numChannels-1];
+	}
+
+/* Applies the given operation to the given image using the reference loops: */
+Images::BaseImage reference(const Images::BaseImage& source,Operation operation)
+	{
+	unsigned int nc=source.getNumChannels();
+	GLenum type=source.getScalarType();
+	unsigned int cs=source.getChannelSize();
+	Images::Size size=source.getSize();
+	switch(operation)
+		{
+		case TOUINT8:
+			{
+			Images::BaseImage result(size,nc,1,source.getFormat(),GL_UNSIGNED_BYTE);
+			switch(type)
+				{
+				case GL_BYTE:
+					referenceToUInt8<GLbyte>(source,result);
+					break;
+				
+				case GL_SHORT:
+					referenceToUInt8<GLshort>(source,result);
+					break;
+				
+				case GL_UNSIGNED_SHORT:
+					referenceToUInt8<GLushort>(source,result);
+					break;
+				
+				case GL_INT:
+					referenceToUInt8<GLint>(source,result);
+					break;
+				
+				case GL_UNSIGNED_INT:
+					referenceToUInt8<GLuint>(source,result);
+					break;
+				
+				case GL_FLOAT:
+					referenceToUInt8<GLfloat>(source,result);
+					break;
+				
+				case GL_DOUBLE:
+					referenceToUInt8<GLdouble>(source,result);
+					break;
+				}
+			return result;
+			}
+		
+		case DROPALPHA:
+			{
+			Images::BaseImage result(size,nc-1,cs,getFormat(nc-1),type);
+			if(type==GL_UNSIGNED_BYTE)
+				referenceDropAlpha<GLubyte>(source,result);
+			else if(type==GL_UNSIGNED_SHORT)
+				referenceDropAlpha<GLushort>(source,result);
+			else
+				referenceDropAlpha<GLfloat>(source,result);
+			return result;
+			}
+		
+		case ADDALPHA:
+			{
+			Images::BaseImage result(size,nc+1,cs,getFormat(nc+1),type);
+			if(type==GL_UNSIGNED_BYTE)
+				referenceAddAlpha<GLubyte>(source,result,GLubyte(128));
+			else if(type==GL_UNSIGNED_SHORT)
+				referenceAddAlpha<GLushort>(source,result,GLushort(32768));
+			else
+				referenceAddAlpha<GLfloat>(source,result,0.5f);
+			return result;
+			}
+		
+		case TOGREY:
+			{
+			Images::BaseImage result(size,nc-2,cs,getFormat(nc-2),type);
+			if(type==GL_UNSIGNED_BYTE)
+				referenceToGreyInt<GLubyte>(source,result);
+			else if(type==GL_UNSIGNED_SHORT)
+				referenceToGreyInt<GLushort>(source,result);
+			else
+				referenceToGreyFloat(source,result);
+			return result;
+			}
+		
+		case TORGB:
+			{
+			Images::BaseImage result(size,nc+2,cs,getFormat(nc+2),type);
+			if(type==GL_UNSIGNED_BYTE)
+				referenceToRgb<GLubyte>(source,result);
+			else if(type==GL_UNSIGNED_SHORT)
+				referenceToRgb<GLushort>(source,result);
+			else
+				referenceToRgb<GLfloat>(source,result);
+			return result;
+			}
+		
+		default:
+			{
+			Images::BaseImage result(Images::Size(size[0]/2,size[1]/2),nc,cs,source.getFormat(),type);
+			if(type==GL_UNSIGNED_BYTE)
+				referenceShrinkInt<GLubyte>(source,result);
+			else if(type==GL_UNSIGNED_SHORT)
+				referenceShrinkInt<GLushort>(source,result);
+			else
+				referenceShrinkFloat(source,result);
+			return result;
+			}
+		}
+	}
+
+/* Applies the given operation to the given image using Images::BaseImage: */
+Images::BaseImage library(const Images::BaseImage& source,Operation operation)
+	{
+	switch(operation)
+		{
+		case TOUINT8:
+			return source.toUInt8();
+		
+		case DROPALPHA:
+			return source.dropAlpha();
+		
+		case ADDALPHA:
+			return source.addAlpha(0.5);
+		
+		case TOGREY:
+			return source.toGrey();
+		
+		case TORGB:
+			return source.toRgb();
+		
+		default:
+			return source.shrink();
+		}
+	}
+
+/* Creates an image of the given size and format filled with random samples, including special values for floating-point images: */
+Images::BaseImage createImage(unsigned int width,unsigned int height,unsigned int numChannels,GLenum scalarType)
+	{
+	unsigned int channelSize;
+	switch(scalarType)
+		{
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+			channelSize=1;
+			break;
+		
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+			channelSize=2;
+			break;
+		
+		case GL_DOUBLE:
+			channelSize=8;
+			break;
+		
+		default:
+			channelSize=4;
+		}
+	Images::BaseImage result(Images::Size(width,height),numChannels,channelSize,getFormat(numChannels),scalarType);
+	size_t numSamples=size_t(width)*size_t(height)*numChannels;
+	if(scalarType==GL_FLOAT)
+		{
+		static const GLfloat specials[]={0.0f,-0.0f,1.0f,0.99999994f,0.5f,1.0e-40f,-1.0e-40f,float(HUGE_VAL),-float(HUGE_VAL),2.0f,-1.0f,0.00390625f};
+		GLfloat* pPtr=static_cast<GLfloat*>(result.replacePixels());
+		for(size_t i=0;i<numSamples;++i)
+			pPtr[i]=rand()%16==0?specials[rand()%12]:GLfloat(rand())/GLfloat(RAND_MAX)*1.5f-0.25f;
+		}
+	else if(scalarType==GL_DOUBLE)
+		{
+		GLdouble* pPtr=static_cast<GLdouble*>(result.replacePixels());
+		for(size_t i=0;i<numSamples;++i)
+			pPtr[i]=GLdouble(rand())/GLdouble(RAND_MAX)*1.5-0.25;
+		}
+	else
+		{
+		unsigned char* pPtr=static_cast<unsigned char*>(result.replacePixels());
+		for(size_t i=0;i<numSamples*channelSize;++i)
+			pPtr[i]=(unsigned char)(rand());
+		}
+	return result;
+	}
+
+/* Returns true if the two given images have the same layout and bit-identical samples: */
+bool equal(const Images::BaseImage& image1,const Images::BaseImage& image2)
+	{
+	if(image1.getWidth()!=image2.getWidth()||image1.getHeight()!=image2.getHeight()||image1.getNumChannels()!=image2.getNumChannels()||image1.getChannelSize()!=image2.getChannelSize()||image1.getScalarType()!=image2.getScalarType())
+		return false;
+	size_t size=size_t(image1.getWidth())*size_t(image1.getHeight())*image1.getNumChannels()*image1.getChannelSize();
+	return memcmp(image1.getPixels(),image2.getPixels(),size)==0;
+	}
+
+/*****************************************
+Description of a conversion to benchmark:
+*****************************************/
+
+struct Case
+	{
+	/* Elements: */
+	public:
+	Operation operation; // Operation to apply
+	GLenum scalarType; // Scalar type of the source image
+	const char* typeName; // Name of the source image's scalar type
+	unsigned int numChannels; // Number of channels of the source image
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int size=4096;
+	unsigned int numRuns=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				size=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"runs")==0&&i+1<argc)
+				numRuns=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	size&=~1U;
+	if(size<2)
+		size=2;
+	if(numRuns<1)
+		numRuns=1;
+	
+	static const Case cases[]=
+		{
+		{TOUINT8,GL_BYTE,"byte",3},{TOUINT8,GL_SHORT,"short",3},{TOUINT8,GL_UNSIGNED_SHORT,"ushort",3},{TOUINT8,GL_UNSIGNED_SHORT,"ushort",4},
+		{TOUINT8,GL_INT,"int",1},{TOUINT8,GL_UNSIGNED_INT,"uint",2},{TOUINT8,GL_FLOAT,"float",3},{TOUINT8,GL_FLOAT,"float",4},{TOUINT8,GL_DOUBLE,"double",3},
+		{DROPALPHA,GL_UNSIGNED_BYTE,"ubyte",4},{DROPALPHA,GL_UNSIGNED_BYTE,"ubyte",2},{DROPALPHA,GL_UNSIGNED_SHORT,"ushort",4},{DROPALPHA,GL_FLOAT,"float",4},
+		{ADDALPHA,GL_UNSIGNED_BYTE,"ubyte",3},{ADDALPHA,GL_UNSIGNED_BYTE,"ubyte",1},{ADDALPHA,GL_UNSIGNED_SHORT,"ushort",3},{ADDALPHA,GL_FLOAT,"float",3},
+		{TOGREY,GL_UNSIGNED_BYTE,"ubyte",3},{TOGREY,GL_UNSIGNED_BYTE,"ubyte",4},{TOGREY,GL_UNSIGNED_SHORT,"ushort",4},{TOGREY,GL_FLOAT,"float",3},{TOGREY,GL_FLOAT,"float",4},
+		{TORGB,GL_UNSIGNED_BYTE,"ubyte",1},{TORGB,GL_UNSIGNED_BYTE,"ubyte",2},{TORGB,GL_UNSIGNED_SHORT,"ushort",2},{TORGB,GL_FLOAT,"float",2},
+		{SHRINK,GL_UNSIGNED_BYTE,"ubyte",1},{SHRINK,GL_UNSIGNED_BYTE,"ubyte",2},{SHRINK,GL_UNSIGNED_BYTE,"ubyte",3},{SHRINK,GL_UNSIGNED_BYTE,"ubyte",4},
+		{SHRINK,GL_UNSIGNED_SHORT,"ushort",1},{SHRINK,GL_UNSIGNED_SHORT,"ushort",2},{SHRINK,GL_UNSIGNED_SHORT,"ushort",4},
+		{SHRINK,GL_FLOAT,"float",1},{SHRINK,GL_FLOAT,"float",2},{SHRINK,GL_FLOAT,"float",4}
+		};
+	const int numCases=sizeof(cases)/sizeof(Case);
+	
+	try
+		{
+		/* Check all conversions on small images of awkward sizes, and on images large enough to be processed in parallel: */
+		static const unsigned int checkSizes[][2]={{1,1},{2,2},{17,3},{30,18},{1022,514},{2048,130}};
+		unsigned int numFailures=0;
+		for(int c=0;c<numCases;++c)
+			for(int s=0;s<6;++s)
+				{
+				unsigned int width=checkSizes[s][0];
+				unsigned int height=checkSizes[s][1];
+				if(cases[c].operation!=SHRINK&&s%2==0)
+					++width;
+				if(cases[c].operation==SHRINK&&(width%2!=0||height%2!=0))
+					continue;
+				Images::BaseImage source=createImage(width,height,cases[c].numChannels,cases[c].scalarType);
+				if(!equal(library(source,cases[c].operation),reference(source,cases[c].operation)))
+					{
+					std::cout<<"  "<<operationNames[cases[c].operation]<<" on "<<width<<"x"<<height<<" "<<cases[c].typeName<<"x"<<cases[c].numChannels<<" differs from the reference"<<std::endl;
+					++numFailures;
+					}
+				}
+		std::cout<<"Checking conversions against reference loops: "<<(numFailures==0?"passed":"FAILED")<<std::endl;
+		
+		/* Time all conversions on large images: */
+		std::cout<<"Converting "<<size<<"x"<<size<<" images, best of "<<numRuns<<" runs:"<<std::endl;
+		std::cout<<std::setw(12)<<"Operation"<<std::setw(12)<<"Source"<<std::setw(16)<<"Reference ms"<<std::setw(16)<<"BaseImage ms"<<std::setw(10)<<"Speedup"<<std::endl;
+		std::cout<<std::fixed;
+		for(int c=0;c<numCases;++c)
+			{
+			Images::BaseImage source=createImage(size,size,cases[c].numChannels,cases[c].scalarType);
+			double bestTimes[2]={0.0,0.0};
+			bool match=true;
+			for(unsigned int run=0;run<numRuns;++run)
+				{
+				Realtime::TimePointMonotonic start;
+				Images::BaseImage referenceResult=reference(source,cases[c].operation);
+				double referenceTime(start.setAndDiff());
+				Images::BaseImage libraryResult=library(source,cases[c].operation);
+				double libraryTime(start.setAndDiff());
+				if(run==0||bestTimes[0]>referenceTime)
+					bestTimes[0]=referenceTime;
+				if(run==0||bestTimes[1]>libraryTime)
+					bestTimes[1]=libraryTime;
+				if(run==0)
+					match=equal(libraryResult,referenceResult);
+				}
+			char sourceName[32];
+			snprintf(sourceName,sizeof(sourceName),"%sx%u",cases[c].typeName,cases[c].numChannels);
+			std::cout<<std::setw(12)<<operationNames[cases[c].operation]<<std::setw(12)<<sourceName;
+			std::cout<<std::setprecision(2)<<std::setw(16)<<bestTimes[0]*1000.0<<std::setw(16)<<bestTimes[1]*1000.0<<std::setw(9)<<bestTimes[0]/bestTimes[1]<<"x";
+			if(!match)
+				{
+				std::cout<<" MISMATCH";
+				++numFailures;
+				}
+			std::cout<<std::endl;
+			}
+		
+		std::cout<<(numFailures==0?"PASSED":"FAILED")<<std::endl;
+		if(numFailures!=0)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
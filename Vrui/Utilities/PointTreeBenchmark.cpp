@@ -0,0 +1,225 @@
+/***********************************************************************
+PointTreeBenchmark - Utility to measure the time to build, incrementally
+edit, and query Geometry::PointKdTree and Geometry::PointOctree, and to
+check their closest-point queries against brute-force searches.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Geometry/Point.h>
+#include <Geometry/ValuedPoint.h>
+#include <Geometry/ClosePointSet.h>
+#include <Geometry/PointKdTree.h>
+#include <Geometry/PointOctree.h>
+
+namespace {
+
+typedef Geometry::Point<float,3> Point;
+typedef Geometry::ValuedPoint<Point,unsigned int> StoredPoint;
+typedef Geometry::PointKdTree<float,3,StoredPoint> KdTree;
+typedef Geometry::PointOctree<float,StoredPoint> Octree;
+
+/* Returns a random number in [0, 1]: */
+float randomUnit(void)
+	{
+	return float(rand())/float(RAND_MAX);
+	}
+
+/* Returns a random point in the unit cube: */
+Point randomPoint(void)
+	{
+	return Point(randomUnit(),randomUnit(),randomUnit());
+	}
+
+/* Returns the squared distances from the given query position to its given number of closest points by exhaustive search: */
+std::vector<float> bruteForceSqrDists(const std::vector<StoredPoint>& points,const Point& queryPosition,size_t numNeighbours)
+	{
+	std::vector<float> sqrDists;
+	sqrDists.reserve(points.size());
+	for(std::vector<StoredPoint>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+		sqrDists.push_back(Geometry::sqrDist(queryPosition,*pIt));
+	numNeighbours=std::min(numNeighbours,sqrDists.size());
+	std::partial_sort(sqrDists.begin(),sqrDists.begin()+numNeighbours,sqrDists.end());
+	sqrDists.resize(numNeighbours);
+	return sqrDists;
+	}
+
+/* Checks closest point and k-nearest queries on the given kd-tree against exhaustive searches over the given points; returns the number of mismatching queries: */
+unsigned int checkKdTree(const KdTree& tree,const std::vector<StoredPoint>& points,unsigned int numQueries,int numNeighbours)
+	{
+	unsigned int numMismatches=0;
+	KdTree::ClosePointSet closestPoints(numNeighbours);
+	for(unsigned int i=0;i<numQueries;++i)
+		{
+		Point query=randomPoint();
+		std::vector<float> sqrDists=bruteForceSqrDists(points,query,numNeighbours);
+		bool match=Geometry::sqrDist(query,tree.findClosestPoint(query))==sqrDists[0];
+		tree.findClosestPoints(query,closestPoints);
+		match=match&&closestPoints.getNumPoints()==int(sqrDists.size());
+		for(int j=0;match&&j<closestPoints.getNumPoints();++j)
+			match=closestPoints.getSqrDist(j)==sqrDists[j];
+		if(!match)
+			++numMismatches;
+		}
+	return numMismatches;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numPoints=1000000;
+	unsigned int numQueries=500;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"points")==0&&i+1<argc)
+				numPoints=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"queries")==0&&i+1<argc)
+				numQueries=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(numPoints<2)
+		numPoints=2;
+	
+	try
+		{
+		std::cout<<std::fixed<<std::setprecision(3);
+		bool passed=true;
+		srand(1);
+		
+		/* Create random points, and points sorted along x, which degenerate unbalanced insertion: */
+		std::vector<StoredPoint> points;
+		std::vector<StoredPoint> sortedPoints;
+		for(unsigned int i=0;i<numPoints;++i)
+			{
+			points.push_back(StoredPoint(randomPoint(),i));
+			sortedPoints.push_back(StoredPoint(Point(float(i)/float(numPoints),randomUnit(),randomUnit()),i));
+			}
+		
+		/* Build a kd-tree in bulk: */
+		{
+		std::vector<StoredPoint> buildPoints=points;
+		Realtime::TimePointMonotonic buildStart;
+		KdTree tree(int(numPoints),&buildPoints[0]);
+		double buildTime(buildStart.setAndDiff());
+		unsigned int numMismatches=checkKdTree(tree,points,numQueries,8);
+		std::cout<<"PointKdTree bulk build of "<<numPoints<<" points: "<<buildTime<<" s ("<<std::setprecision(2)<<double(numPoints)*1.0e-6/buildTime<<" Mpts/s), depth "<<tree.getTreeStatistics().depth<<", "<<numMismatches<<" mismatches"<<std::setprecision(3)<<std::endl;
+		if(tree.getNumPoints()!=int(numPoints)||numMismatches!=0)
+			passed=false;
+		}
+		
+		/* Build a kd-tree by inserting points sorted along x: */
+		{
+		KdTree tree;
+		Realtime::TimePointMonotonic insertStart;
+		for(std::vector<StoredPoint>::iterator spIt=sortedPoints.begin();spIt!=sortedPoints.end();++spIt)
+			tree.insertPoint(*spIt);
+		double insertTime(insertStart.setAndDiff());
+		unsigned int numMismatches=checkKdTree(tree,sortedPoints,numQueries,8);
+		std::cout<<"PointKdTree sorted insertion of "<<numPoints<<" points: "<<insertTime<<" s, depth "<<tree.getTreeStatistics().depth<<", "<<numMismatches<<" mismatches"<<std::endl;
+		if(tree.getNumPoints()!=int(numPoints)||numMismatches!=0)
+			passed=false;
+		
+		/* Remove every other point: */
+		std::vector<StoredPoint> remainingPoints;
+		unsigned int numRemoved=0;
+		Realtime::TimePointMonotonic removeStart;
+		for(unsigned int i=0;i<numPoints;++i)
+			{
+			if(i%2==0)
+				{
+				if(tree.removePoint(sortedPoints[i]))
+					++numRemoved;
+				}
+			else
+				remainingPoints.push_back(sortedPoints[i]);
+			}
+		double removeTime(removeStart.setAndDiff());
+		numMismatches=checkKdTree(tree,remainingPoints,numQueries,8);
+		std::cout<<"PointKdTree removal of "<<numRemoved<<" points: "<<removeTime<<" s, depth "<<tree.getTreeStatistics().depth<<", "<<numMismatches<<" mismatches"<<std::endl;
+		if(numRemoved!=(numPoints+1)/2||tree.getNumPoints()!=int(remainingPoints.size())||numMismatches!=0)
+			passed=false;
+		
+		/* Check that removing a point that is no longer in the tree fails: */
+		if(tree.removePoint(sortedPoints[0]))
+			{
+			std::cout<<"PointKdTree removed a point twice"<<std::endl;
+			passed=false;
+			}
+		
+		/* Empty the tree and insert a point into the empty tree: */
+		for(std::vector<StoredPoint>::iterator rpIt=remainingPoints.begin();rpIt!=remainingPoints.end();++rpIt)
+			if(!tree.removePoint(*rpIt))
+				passed=false;
+		unsigned int numEmptyPoints=tree.getNumPoints();
+		tree.insertPoint(sortedPoints[0]);
+		bool reinserted=tree.getNumPoints()==1&&tree.findClosestPoint(randomPoint()).value==sortedPoints[0].value;
+		std::cout<<"PointKdTree after removing all points: "<<numEmptyPoints<<" points, reinsertion "<<(reinserted?"succeeded":"failed")<<std::endl;
+		if(numEmptyPoints!=0||!reinserted)
+			passed=false;
+		}
+		
+		/* Build an octree and check its closest-point queries: */
+		{
+		StoredPoint* octreePoints=new StoredPoint[numPoints];
+		std::copy(points.begin(),points.end(),octreePoints);
+		Realtime::TimePointMonotonic buildStart;
+		Octree octree(Point(0.0f,0.0f,0.0f),Point(1.0f,1.0f,1.0f),int(numPoints),octreePoints,16,20);
+		double buildTime(buildStart.setAndDiff());
+		unsigned int numMismatches=0;
+		for(unsigned int i=0;i<numQueries;++i)
+			{
+			Point query=randomPoint();
+			if(Geometry::sqrDist(query,octree.findClosestPoint(query))!=bruteForceSqrDists(points,query,1)[0])
+				++numMismatches;
+			}
+		int numNodes,numLeaves,maxNumLeafPoints,depth;
+		octree.gatherStatistics(numNodes,numLeaves,maxNumLeafPoints,depth);
+		std::cout<<"PointOctree build of "<<numPoints<<" points: "<<buildTime<<" s ("<<std::setprecision(2)<<double(numPoints)*1.0e-6/buildTime<<" Mpts/s), "<<numLeaves<<" leaves, depth "<<depth<<", "<<numMismatches<<" mismatches"<<std::setprecision(3)<<std::endl;
+		if(numMismatches!=0)
+			passed=false;
+		}
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
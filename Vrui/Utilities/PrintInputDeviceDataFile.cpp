@@ -2,7 +2,7 @@
 PrintInputDeviceDataFile - Program to print the contents of a previously
 saved input device data file in the format used by Vrui's
 InputDeviceDataSaver and InputDeviceAdapterPlayback classes.
-Copyright (c) 2008-2023 Oliver Kreylos
+Copyright (c) 2008-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -23,18 +23,26 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 ***********************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include <string>
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/VarIntMarshaller.h>
 #include <Misc/StringMarshaller.h>
 #include <IO/File.h>
 #include <IO/SeekableFile.h>
 #include <IO/OpenFile.h>
 #include <Geometry/Vector.h>
+#include <Math/Constants.h>
 #include <Vrui/Types.h>
+#include <Vrui/EnvironmentDefinition.h>
 #include <Vrui/InputDevice.h>
 #include <Vrui/InputDeviceFeature.h>
+#include <Vrui/Internal/InputDeviceDataChunkReader.h>
 
 std::string getDefaultFeatureName(const Vrui::InputDeviceFeature& feature)
 	{
@@ -56,6 +64,26 @@ std::string getDefaultFeatureName(const Vrui::InputDeviceFeature& feature)
 	return std::string(featureName);
 	}
 
+void skipTextEvents(IO::File& file)
+	{
+	/* Skip all saved text events: */
+	unsigned int numTextEvents=(unsigned int)(Misc::readVarInt32(file));
+	for(unsigned int i=0;i<numTextEvents;++i)
+		{
+		Misc::readVarInt32(file);
+		unsigned int stringLen=(unsigned int)(Misc::readVarInt32(file));
+		file.skip<char>(stringLen);
+		}
+	
+	/* Skip all saved text control events: */
+	unsigned int numTextControlEvents=(unsigned int)(Misc::readVarInt32(file));
+	for(unsigned int i=0;i<numTextControlEvents;++i)
+		{
+		Misc::readVarInt32(file);
+		file.skip<Misc::UInt8>(2);
+		}
+	}
+
 /**************
 Helper classes:
 **************/
@@ -73,12 +101,54 @@ struct DeviceFileHeader // Structure to store device name and layout in device d
 
 int main(int argc,char* argv[])
 	{
+	/* Parse the command line: */
+	const char* fileName=0;
+	double startTime=-Math::Constants<double>::max;
+	double endTime=Math::Constants<double>::max;
+	bool printIndex=false;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"h")==0)
+				{
+				std::cout<<"Usage: "<<argv[0]<<" [-start <time>] [-end <time>] [-index] <input device data file name>"<<std::endl;
+				std::cout<<"\t-start <time> : Print data frames starting at the given time stamp; seeks directly to the given time stamp in indexed files"<<std::endl;
+				std::cout<<"\t-end <time>   : Stop printing data frames after the given time stamp"<<std::endl;
+				std::cout<<"\t-index        : Print the chunk index of indexed files"<<std::endl;
+				
+				return 0;
+				}
+			else if(strcasecmp(argv[i]+1,"start")==0&&i+1<argc)
+				{
+				++i;
+				startTime=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"end")==0&&i+1<argc)
+				{
+				++i;
+				endTime=atof(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"index")==0)
+				printIndex=true;
+			else
+				std::cerr<<"Ignoring unrecognized command line option "<<argv[i]<<std::endl;
+			}
+		else
+			fileName=argv[i];
+		}
+	if(fileName==0)
+		{
+		std::cerr<<"No input device data file name provided"<<std::endl;
+		return 1;
+		}
+	
 	/* Open the input file: */
-	IO::SeekableFilePtr inputDeviceDataFile(IO::openSeekableFile(argv[1]));
+	IO::SeekableFilePtr inputDeviceDataFile(IO::openSeekableFile(fileName));
 	inputDeviceDataFile->setEndianness(Misc::LittleEndian);
 	
 	/* Read the file header: */
-	static const char* fileHeader="Vrui Input Device Data File v3.0\n";
+	static const char* fileHeader="Vrui Input Device Data File v8.0\n";
 	char header[34];
 	inputDeviceDataFile->read(header,34);
 	header[33]='\0';
@@ -92,15 +162,10 @@ int main(int argc,char* argv[])
 		/* Old file format doesn't have the header text: */
 		inputDeviceDataFile->setReadPosAbs(0);
 		}
-	else if(strcmp(header+29,"2.0\n")==0)
-		{
-		/* File version without ray direction and velocities: */
-		fileVersion=2;
-		}
-	else if(strcmp(header+29,"3.0\n")==0)
+	else if(header[29]>='2'&&header[29]<='8'&&strcmp(header+30,".0\n")==0)
 		{
-		/* File version with ray direction and velocities: */
-		fileVersion=3;
+		/* Extract the file version: */
+		fileVersion=header[29]-'0';
 		}
 	else
 		{
@@ -112,6 +177,13 @@ int main(int argc,char* argv[])
 	/* Skip random seed value: */
 	inputDeviceDataFile->read<unsigned int>();
 	
+	if(fileVersion>=7)
+		{
+		/* Skip the environment definition: */
+		Vrui::EnvironmentDefinition environmentDefinition;
+		environmentDefinition.read(*inputDeviceDataFile);
+		}
+	
 	/* Read file header: */
 	int numInputDevices=inputDeviceDataFile->read<int>();
 	Vrui::InputDevice** inputDevices=new Vrui::InputDevice*[numInputDevices];
@@ -164,48 +236,98 @@ int main(int argc,char* argv[])
 			for(int j=0;j<newDevice->getNumFeatures();++j)
 				deviceFeatureNames.push_back(getDefaultFeatureName(Vrui::InputDeviceFeature(newDevice,j)));
 			}
+		
+		if(fileVersion>=6)
+			{
+			/* Skip the device's handle transformation: */
+			inputDeviceDataFile->skip<Vrui::Scalar>(3+4);
+			}
 		}
 	
+	/* Read the chunk index of indexed files: */
+	Vrui::InputDeviceDataChunkReader* chunkReader=0;
+	if(fileVersion>=8)
+		{
+		chunkReader=new Vrui::InputDeviceDataChunkReader(inputDeviceDataFile);
+		
+		if(printIndex)
+			{
+			/* Print the chunk index: */
+			std::cout<<"Chunk index ("<<(chunkReader->hasStoredIndex()?"stored":"reconstructed")<<"): "<<chunkReader->getNumChunks()<<" chunks, "<<chunkReader->getNumFrames()<<" frames"<<std::endl;
+			for(size_t i=0;i<chunkReader->getNumChunks();++i)
+				{
+				const Vrui::InputDeviceDataChunkReader::ChunkInfo& ci=chunkReader->getChunk(i);
+				std::cout<<"Chunk "<<std::setw(6)<<i<<": offset "<<std::setw(12)<<ci.offset<<", time stamp "<<std::fixed<<std::setw(8)<<std::setprecision(3)<<ci.firstTimeStamp<<", frames "<<ci.firstFrameIndex<<"-"<<ci.firstFrameIndex+ci.numFrames-1<<std::endl;
+				}
+			}
+		
+		/* Go directly to the chunk containing the start time: */
+		if(chunkReader->getNumChunks()>0)
+			chunkReader->loadChunk(chunkReader->findChunk(startTime));
+		}
+	else if(printIndex)
+		std::cerr<<"Input device data file version "<<fileVersion<<" does not have a chunk index"<<std::endl;
+	
 	/* Read all data frames from the input device data file: */
 	while(true)
 		{
 		/* Read the next time stamp: */
+		IO::File* frameFile=inputDeviceDataFile.getPointer();
 		double timeStamp;
-		try
+		if(chunkReader!=0)
 			{
-			timeStamp=inputDeviceDataFile->read<double>();
+			/* Go to the next frame in the chunk stream: */
+			if(!chunkReader->nextFrame())
+				break;
+			frameFile=&chunkReader->getFrameFile();
+			timeStamp=frameFile->read<double>();
 			}
-		catch(const IO::File::ReadError&)
+		else
 			{
-			/* At end of file */
-			break;
+			try
+				{
+				timeStamp=inputDeviceDataFile->read<double>();
+				}
+			catch(const IO::File::ReadError&)
+				{
+				/* At end of file */
+				break;
+				}
 			}
+		if(timeStamp>endTime)
+			break;
+		bool printFrame=timeStamp>=startTime;
 		
-		std::cout<<"Time stamp: "<<std::fixed<<std::setw(8)<<std::setprecision(3)<<timeStamp;
+		if(printFrame)
+			std::cout<<"Time stamp: "<<std::fixed<<std::setw(8)<<std::setprecision(3)<<timeStamp;
 		
 		/* Read data for all input devices: */
 		for(int device=0;device<numInputDevices;++device)
 			{
+			/* Data file version 5 and later contain per-device valid flags: */
+			if(fileVersion>=5&&frameFile->read<unsigned char>()==0U)
+				continue;
+			
 			/* Update tracker state: */
 			if(inputDevices[device]->getTrackType()!=Vrui::InputDevice::TRACK_NONE)
 				{
 				if(fileVersion>=3)
 					{
 					Vrui::Vector deviceRayDir;
-					inputDeviceDataFile->read(deviceRayDir.getComponents(),3);
-					Vrui::Scalar deviceRayStart=inputDeviceDataFile->read<Vrui::Scalar>();
+					frameFile->read(deviceRayDir.getComponents(),3);
+					Vrui::Scalar deviceRayStart=frameFile->read<Vrui::Scalar>();
 					inputDevices[device]->setDeviceRay(deviceRayDir,deviceRayStart);
 					}
 				Vrui::TrackerState::Vector translation;
-				inputDeviceDataFile->read(translation.getComponents(),3);
+				frameFile->read(translation.getComponents(),3);
 				Vrui::Scalar quat[4];
-				inputDeviceDataFile->read(quat,4);
+				frameFile->read(quat,4);
 				inputDevices[device]->setTransformation(Vrui::TrackerState(translation,Vrui::TrackerState::Rotation(quat)));
 				if(fileVersion>=3)
 					{
 					Vrui::Vector linearVelocity,angularVelocity;
-					inputDeviceDataFile->read(linearVelocity.getComponents(),3);
-					inputDeviceDataFile->read(angularVelocity.getComponents(),3);
+					frameFile->read(linearVelocity.getComponents(),3);
+					frameFile->read(angularVelocity.getComponents(),3);
 					inputDevices[device]->setLinearVelocity(linearVelocity);
 					inputDevices[device]->setAngularVelocity(angularVelocity);
 					}
@@ -220,7 +342,7 @@ int main(int argc,char* argv[])
 					{
 					if(numBits==0)
 						{
-						buttonBits=inputDeviceDataFile->read<unsigned char>();
+						buttonBits=frameFile->read<unsigned char>();
 						numBits=8;
 						}
 					inputDevices[device]->setButtonState(i,(buttonBits&0x80U)!=0x00U);
@@ -232,7 +354,7 @@ int main(int argc,char* argv[])
 				{
 				for(int i=0;i<inputDevices[device]->getNumButtons();++i)
 					{
-					int buttonState=inputDeviceDataFile->read<int>();
+					int buttonState=frameFile->read<int>();
 					inputDevices[device]->setButtonState(i,buttonState);
 					}
 				}
@@ -240,13 +362,20 @@ int main(int argc,char* argv[])
 			/* Update valuator states: */
 			for(int i=0;i<inputDevices[device]->getNumValuators();++i)
 				{
-				double valuatorState=inputDeviceDataFile->read<double>();
+				double valuatorState=frameFile->read<double>();
 				inputDevices[device]->setValuator(i,valuatorState);
 				}
 			}
 		
-		std::cout<<std::endl;
+		/* Data file version 4 and later contain text event data: */
+		if(fileVersion>=4)
+			skipTextEvents(*frameFile);
+		
+		if(printFrame)
+			std::cout<<std::endl;
 		}
 	
+	delete chunkReader;
+	
 	return 0;
 	}
@@ -0,0 +1,260 @@
+/***********************************************************************
+ProfilerBenchmark - Utility to measure the cost of recording zones with
+Threads::Profiler while it is disabled and enabled, and to check that
+zones recorded by several threads while being collected concurrently
+are either collected intact or counted as lost.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Threads/Thread.h>
+#include <Threads/Profiler.h>
+
+namespace {
+
+/*****************
+Helper variables:
+*****************/
+
+const char* outerZoneName="Outer"; // Name of the outer zones recorded by stress test threads
+const char* innerZoneName="Inner"; // Name of the inner zones recorded by stress test threads
+volatile unsigned int sink; // Variable written inside zones to keep the compiler from removing empty loops
+
+/* Returns the average time in nanoseconds to enter and leave a zone: */
+double measureZoneCost(unsigned int numZones)
+	{
+	Threads::Profiler::Time start=Threads::Profiler::now();
+	for(unsigned int i=0;i<numZones;++i)
+		{
+		Threads::Profiler::Zone zone("Benchmark");
+		sink=i;
+		}
+	return double(Threads::Profiler::now()-start)/double(numZones);
+	}
+
+/*************************************************************
+Class for a thread recording nested zones in the stress test:
+*************************************************************/
+
+class StressThread
+	{
+	/* Elements: */
+	private:
+	std::string name; // Name of the thread in the profiler
+	unsigned int numIterations; // Number of outer zones to record
+	Threads::Thread thread; // The recording thread
+	
+	/* Private methods: */
+	void* threadMethod(void)
+		{
+		Threads::Profiler::setThreadName(name.c_str());
+		for(unsigned int i=0;i<numIterations;++i)
+			{
+			Threads::Profiler::Zone outer(outerZoneName);
+			{
+			Threads::Profiler::Zone inner(innerZoneName);
+			sink=i;
+			}
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	StressThread(const std::string& sName,unsigned int sNumIterations)
+		:name(sName),numIterations(sNumIterations)
+		{
+		}
+	
+	/* Methods: */
+	const std::string& getName(void) const
+		{
+		return name;
+		}
+	void start(void)
+		{
+		thread.start(this,&StressThread::threadMethod);
+		}
+	void join(void)
+		{
+		thread.join();
+		}
+	};
+
+/* Checks the zones collected from one stress test thread; returns the number of inconsistent zones: */
+size_t checkZones(const std::vector<Threads::Profiler::Event>& events)
+	{
+	size_t numBadZones=0;
+	std::vector<Threads::Profiler::Time> outerBegins,innerBegins;
+	for(std::vector<Threads::Profiler::Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt)
+		{
+		/* Check that the zone is not torn: */
+		if(eIt->name==outerZoneName&&eIt->depth==0&&eIt->begin<=eIt->end)
+			outerBegins.push_back(eIt->begin);
+		else if(eIt->name==innerZoneName&&eIt->depth==1&&eIt->begin<=eIt->end)
+			innerBegins.push_back(eIt->begin);
+		else
+			++numBadZones;
+		}
+	
+	/* Check that no zone was collected twice: */
+	std::sort(outerBegins.begin(),outerBegins.end());
+	numBadZones+=outerBegins.end()-std::unique(outerBegins.begin(),outerBegins.end());
+	std::sort(innerBegins.begin(),innerBegins.end());
+	numBadZones+=innerBegins.end()-std::unique(innerBegins.begin(),innerBegins.end());
+	
+	return numBadZones;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numZones=10000000;
+	unsigned int numThreads=4;
+	unsigned int numIterations=200000;
+	size_t bufferSize=4096;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"zones")==0&&i+1<argc)
+				numZones=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				numThreads=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"iterations")==0&&i+1<argc)
+				numIterations=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"bufferSize")==0&&i+1<argc)
+				bufferSize=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(numZones<1)
+		numZones=1;
+	if(numThreads<1)
+		numThreads=1;
+	
+	try
+		{
+		std::cout<<std::fixed<<std::setprecision(2);
+		bool passed=true;
+		
+		/* Measure the cost of a zone while the profiler is disabled and enabled: */
+		Threads::Profiler::setThreadName("Main");
+		double disabledCost=measureZoneCost(numZones);
+		Threads::Profiler::setEnabled(true);
+		unsigned int numEnabledZones=numZones/10+1;
+		double enabledCost=measureZoneCost(numEnabledZones);
+		Threads::Profiler::Time clockStart=Threads::Profiler::now();
+		for(unsigned int i=0;i<numEnabledZones;++i)
+			sink=(unsigned int)(Threads::Profiler::now());
+		double clockCost=double(Threads::Profiler::now()-clockStart)/double(numEnabledZones);
+		std::cout<<"Zone cost: disabled "<<disabledCost<<" ns, enabled "<<enabledCost<<" ns, clock query "<<clockCost<<" ns"<<std::endl;
+		
+		/* Discard the main thread's zones: */
+		std::vector<Threads::Profiler::ThreadEvents> threads;
+		Threads::Profiler::collect(threads);
+		threads.clear();
+		
+		/* Record nested zones in several threads while collecting them continuously: */
+		Threads::Profiler::setBufferSize(bufferSize);
+		std::vector<StressThread*> stressThreads;
+		for(unsigned int i=0;i<numThreads;++i)
+			{
+			char threadName[32];
+			snprintf(threadName,sizeof(threadName),"Stress %u",i);
+			stressThreads.push_back(new StressThread(threadName,numIterations));
+			}
+		for(std::vector<StressThread*>::iterator stIt=stressThreads.begin();stIt!=stressThreads.end();++stIt)
+			(*stIt)->start();
+		unsigned int numCollections=0;
+		for(unsigned int i=0;i<100;++i,++numCollections)
+			{
+			Threads::Profiler::collect(threads);
+			usleep(1000);
+			}
+		for(std::vector<StressThread*>::iterator stIt=stressThreads.begin();stIt!=stressThreads.end();++stIt)
+			(*stIt)->join();
+		Threads::Profiler::collect(threads);
+		++numCollections;
+		
+		/* Account for every zone recorded by every thread: */
+		std::cout<<"Stress test: "<<numThreads<<" threads, "<<numIterations*2<<" zones each, "<<numCollections<<" concurrent collections, ring buffer size "<<bufferSize<<std::endl;
+		for(std::vector<StressThread*>::iterator stIt=stressThreads.begin();stIt!=stressThreads.end();++stIt)
+			{
+			std::vector<Threads::Profiler::Event> events;
+			size_t numLost=0;
+			for(std::vector<Threads::Profiler::ThreadEvents>::iterator tIt=threads.begin();tIt!=threads.end();++tIt)
+				if(tIt->threadName==(*stIt)->getName())
+					{
+					events.insert(events.end(),tIt->events.begin(),tIt->events.end());
+					numLost+=tIt->numLostEvents;
+					}
+			size_t numBadZones=checkZones(events);
+			std::cout<<"  "<<(*stIt)->getName()<<": "<<events.size()<<" collected, "<<numLost<<" lost, "<<numBadZones<<" inconsistent"<<std::endl;
+			if(events.size()+numLost!=size_t(numIterations)*2||numBadZones!=0)
+				passed=false;
+			}
+		
+		/* Write the collected zones as a Chrome trace: */
+		char traceFileName[]="/tmp/ProfilerBenchmarkXXXXXX";
+		int traceFd=mkstemp(traceFileName);
+		if(traceFd<0)
+			throw std::runtime_error("Unable to create temporary trace file");
+		close(traceFd);
+		Threads::Profiler::Time traceStart=Threads::Profiler::now();
+		Threads::Profiler::writeChromeTrace(threads,traceFileName,0,"ProfilerBenchmark");
+		double traceTime=double(Threads::Profiler::now()-traceStart)*1.0e-6;
+		struct stat traceStats;
+		if(stat(traceFileName,&traceStats)!=0||traceStats.st_size==0)
+			passed=false;
+		else
+			std::cout<<"Chrome trace: "<<traceStats.st_size/1024<<" KB written in "<<traceTime<<" ms"<<std::endl;
+		unlink(traceFileName);
+		
+		for(std::vector<StressThread*>::iterator stIt=stressThreads.begin();stIt!=stressThreads.end();++stIt)
+			delete *stIt;
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
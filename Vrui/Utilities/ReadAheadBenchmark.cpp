@@ -0,0 +1,276 @@
+/***********************************************************************
+ReadAheadBenchmark - Utility to compare sequential read throughput of
+a plain buffered file and an IO::ReadAheadFilter while processing the
+read data, and to check that read errors in the read-ahead thread are
+reported to the reader.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Realtime/Time.h>
+#include <IO/File.h>
+#include <IO/StandardFile.h>
+#include <IO/ReadAheadFilter.h>
+
+namespace {
+
+/***************************************************************
+Source file producing a byte pattern and failing after a while:
+***************************************************************/
+
+class FailingSource:public IO::File
+	{
+	/* Elements: */
+	private:
+	size_t failOffset; // Position in the stream at which reading fails
+	size_t offset; // Current position in the stream
+	
+	/* Protected methods from IO::File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize)
+		{
+		if(offset>=failOffset)
+			throw Error("FailingSource: Simulated read failure");
+		size_t readSize=bufferSize;
+		if(readSize>failOffset-offset)
+			readSize=failOffset-offset;
+		for(size_t i=0;i<readSize;++i)
+			buffer[i]=Byte(offset+i);
+		offset+=readSize;
+		return readSize;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	FailingSource(size_t sFailOffset)
+		:IO::File(ReadOnly),
+		 failOffset(sFailOffset),offset(0)
+		{
+		}
+	};
+
+/* Returns true if reading from a read-ahead filter over a failing source delivers all data up to the failure and then throws a read error: */
+bool checkErrorPropagation(size_t failOffset)
+	{
+	IO::ReadAheadFilter file(new FailingSource(failOffset),64*1024,4);
+	size_t numRead=0;
+	try
+		{
+		while(true)
+			{
+			void* buffer;
+			size_t readSize=file.readInBuffer(buffer);
+			if(readSize==0)
+				{
+				std::cout<<"  Read error was reported as end-of-file after "<<numRead<<" bytes"<<std::endl;
+				return false;
+				}
+			const Misc::UInt8* bPtr=static_cast<const Misc::UInt8*>(buffer);
+			for(size_t i=0;i<readSize;++i,++numRead)
+				if(bPtr[i]!=Misc::UInt8(numRead))
+					{
+					std::cout<<"  Corrupted data at offset "<<numRead<<std::endl;
+					return false;
+					}
+			}
+		}
+	catch(const IO::File::ReadError& err)
+		{
+		if(numRead!=failOffset)
+			{
+			std::cout<<"  Read error reported after "<<numRead<<" instead of "<<failOffset<<" bytes"<<std::endl;
+			return false;
+			}
+		}
+	
+	/* Subsequent reads must keep reporting the error: */
+	try
+		{
+		file.getChar();
+		std::cout<<"  Read after error did not report the error again"<<std::endl;
+		return false;
+		}
+	catch(const IO::File::ReadError& err)
+		{
+		}
+	
+	return true;
+	}
+
+/* Reads the given file completely and returns a checksum of its contents; simulates processing of the read data: */
+Misc::UInt32 processFile(IO::File& file,size_t& numBytes)
+	{
+	Misc::UInt32 hash=2166136261U;
+	numBytes=0;
+	while(true)
+		{
+		void* buffer;
+		size_t readSize=file.readInBuffer(buffer);
+		if(readSize==0)
+			break;
+		const Misc::UInt8* bPtr=static_cast<const Misc::UInt8*>(buffer);
+		for(size_t i=0;i<readSize;++i)
+			hash=(hash^bPtr[i])*16777619U;
+		numBytes+=readSize;
+		}
+	return hash;
+	}
+
+/* Drops the given file from the operating system's page cache if possible: */
+void dropFromCache(const char* fileName)
+	{
+	#ifdef POSIX_FADV_DONTNEED
+	IO::StandardFile file(fileName);
+	posix_fadvise(file.getFd(),0,0,POSIX_FADV_DONTNEED);
+	#endif
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::string fileName;
+	size_t fileSize=512;
+	size_t segmentSize=1024*1024;
+	unsigned int numSegments=4;
+	bool cold=false;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				fileSize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"segmentSize")==0&&i+1<argc)
+				segmentSize=size_t(atol(argv[++i]))*1024;
+			else if(strcasecmp(argv[i]+1,"segments")==0&&i+1<argc)
+				numSegments=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"cold")==0)
+				cold=true;
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			fileName=argv[i];
+		}
+	
+	try
+		{
+		/* Check that read errors are reported at the right position, including at segment boundaries: */
+		std::cout<<"Checking read error propagation:"<<std::endl;
+		bool passed=true;
+		static const size_t failOffsets[]={0,1000,64*1024,64*1024*4,1000000};
+		for(int i=0;i<5;++i)
+			passed=checkErrorPropagation(failOffsets[i])&&passed;
+		std::cout<<(passed?"  passed":"  FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		
+		/* Create a test file if none was given: */
+		bool temporary=fileName.empty();
+		if(temporary)
+			{
+			char tempName[]="/tmp/ReadAheadBenchmarkXXXXXX";
+			int fd=mkstemp(tempName);
+			if(fd<0)
+				throw std::runtime_error("Unable to create temporary file");
+			fileName=tempName;
+			IO::StandardFile file(fd,IO::File::WriteOnly);
+			std::vector<Misc::UInt8> block(1024*1024);
+			for(size_t i=0;i<fileSize;++i)
+				{
+				for(std::vector<Misc::UInt8>::iterator bIt=block.begin();bIt!=block.end();++bIt)
+					*bIt=Misc::UInt8(rand());
+				file.writeRaw(&block[0],block.size());
+				}
+			}
+		
+		/* Read the file with each method: */
+		std::cout<<"Reading "<<fileName<<(cold?" from disk":" from the page cache")<<" while hashing its contents:"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		Misc::UInt32 hashes[4];
+		for(int method=0;method<4;++method)
+			{
+			if(cold)
+				dropFromCache(fileName.c_str());
+			IO::FilePtr file;
+			const char* methodName;
+			switch(method)
+				{
+				case 0:
+					file=new IO::StandardFile(fileName.c_str());
+					methodName="Buffered file";
+					break;
+				
+				case 1:
+					file=new IO::ReadAheadFilter(new IO::StandardFile(fileName.c_str()),segmentSize,numSegments);
+					methodName="Read-ahead over buffered file";
+					break;
+				
+				case 2:
+					file=new IO::ReadAheadFilter(fileName.c_str(),false,segmentSize,numSegments);
+					methodName="Read-ahead from descriptor";
+					break;
+				
+				default:
+					file=new IO::ReadAheadFilter(fileName.c_str(),true,segmentSize,numSegments);
+					methodName=static_cast<IO::ReadAheadFilter*>(file.getPointer())->isDirectIO()?"Read-ahead, direct I/O":"Read-ahead, direct I/O unsupported";
+				}
+			Realtime::TimePointMonotonic start;
+			size_t numBytes;
+			hashes[method]=processFile(*file,numBytes);
+			double elapsed(start.setAndDiff());
+			std::cout<<"  "<<std::setw(36)<<std::left<<methodName<<std::right<<std::setw(10)<<double(numBytes)/(elapsed*1024.0*1024.0)<<" MB/s";
+			IO::ReadAheadFilter* raf=dynamic_cast<IO::ReadAheadFilter*>(file.getPointer());
+			if(raf!=0)
+				{
+				IO::ReadAheadFilter::Statistics stats=raf->getStatistics();
+				std::cout<<", "<<stats.numReaderStalls<<" reader stalls, "<<stats.numReadAheadStalls<<" read-ahead stalls";
+				}
+			std::cout<<std::endl;
+			if(hashes[method]!=hashes[0])
+				{
+				std::cout<<"  FAILED: File contents differ from buffered read"<<std::endl;
+				passed=false;
+				}
+			}
+		
+		if(temporary)
+			unlink(fileName.c_str());
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,230 @@
+/***********************************************************************
+SharedStateRingTest - Multi-process torture test verifying that readers
+of a Realtime::SharedStateRing never observe partially written states
+while a writer posts new states as fast as possible.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <Realtime/Time.h>
+#include <Realtime/SharedStateRing.h>
+
+namespace {
+
+/* Returns the expected value of the given word of the state of the given index: */
+inline unsigned int stateWord(unsigned int stateIndex,size_t wordIndex)
+	{
+	return (stateIndex*2654435761U)^(unsigned int)(wordIndex*40503U);
+	}
+
+/* Fills the given state record as the state of the given index posted at the given time: */
+void fillState(unsigned int* state,size_t numWords,unsigned int stateIndex,const Realtime::TimePointMonotonic& postTime)
+	{
+	state[0]=stateIndex;
+	state[1]=(unsigned int)(postTime.tv_sec);
+	state[2]=(unsigned int)(postTime.tv_nsec);
+	for(size_t i=3;i<numWords;++i)
+		state[i]=stateWord(stateIndex,i);
+	}
+
+/* Returns true if the given state record is consistent in itself and with the given posting time: */
+bool checkState(const unsigned int* state,size_t numWords,const Realtime::TimePointMonotonic& postTime)
+	{
+	if(state[1]!=(unsigned int)(postTime.tv_sec)||state[2]!=(unsigned int)(postTime.tv_nsec))
+		return false;
+	for(size_t i=3;i<numWords;++i)
+		if(state[i]!=stateWord(state[0],i))
+			return false;
+	return true;
+	}
+
+/* Reads states from the ring until the given time has elapsed; returns the number of torn states observed: */
+unsigned int runReader(unsigned int readerIndex,int ringFd,double runTime)
+	{
+	Realtime::SharedStateRing ring(ringFd);
+	size_t numWords=ring.getStateSize()/sizeof(unsigned int);
+	std::vector<unsigned int> state(numWords);
+	
+	/* Alternate between reading the most recent state and a random state from the ring's history: */
+	unsigned int numReads=0;
+	unsigned int numMisses=0;
+	unsigned int numTorn=0;
+	unsigned int lastIndex=0;
+	Realtime::TimePointMonotonic start;
+	Realtime::TimePointMonotonic now;
+	while(double(now-start)<runTime)
+		{
+		for(int i=0;i<256;++i)
+			{
+			Realtime::TimePointMonotonic postTime;
+			bool haveState;
+			if(i%2==0)
+				{
+				haveState=ring.readLatest(&state[0],&postTime);
+				
+				/* Check that the most recent state never goes backwards: */
+				if(haveState)
+					{
+					if(state[0]<lastIndex)
+						++numTorn;
+					lastIndex=state[0];
+					}
+				}
+			else
+				{
+				unsigned int numStates=ring.getNumStates();
+				unsigned int stateIndex=numStates-1U-(unsigned int)(rand()%ring.getNumSlots());
+				haveState=numStates>0&&ring.read(stateIndex,&state[0],&postTime);
+				if(haveState&&state[0]!=stateIndex)
+					++numTorn;
+				}
+			
+			if(haveState)
+				{
+				++numReads;
+				if(!checkState(&state[0],numWords,postTime))
+					++numTorn;
+				}
+			else
+				++numMisses;
+			}
+		now.set();
+		}
+	
+	printf("Reader %u: %u consistent reads (%.0f/s), %u overwritten or unpublished, %u torn\n",readerIndex,numReads-numTorn,double(numReads)/runTime,numMisses,numTorn);
+	fflush(stdout);
+	return numTorn;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numReaders=4;
+	unsigned int numSlots=16;
+	size_t stateSize=4096;
+	double runTime=5.0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"readers")==0&&i+1<argc)
+				numReaders=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"slots")==0&&i+1<argc)
+				numSlots=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"stateSize")==0&&i+1<argc)
+				stateSize=size_t(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"time")==0&&i+1<argc)
+				runTime=atof(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	size_t numWords=stateSize/sizeof(unsigned int);
+	if(numWords<4)
+		numWords=4;
+	
+	try
+		{
+		/* Create the shared state ring: */
+		char ringName[64];
+		snprintf(ringName,sizeof(ringName),"/SharedStateRingTest-%d.shmem",int(getpid()));
+		Realtime::SharedStateRing ring(ringName,numSlots,numWords*sizeof(unsigned int));
+		
+		/* Fork the reader processes, each opening the ring through its own file descriptor: */
+		std::vector<pid_t> readers;
+		for(unsigned int readerIndex=0;readerIndex<numReaders;++readerIndex)
+			{
+			pid_t pid=fork();
+			if(pid==0)
+				{
+				unsigned int numTorn=0;
+				try
+					{
+					srand(readerIndex+1);
+					numTorn=runReader(readerIndex,dup(ring.getFd()),runTime);
+					}
+				catch(const std::runtime_error& err)
+					{
+					fprintf(stderr,"Reader %u: Terminated due to exception %s\n",readerIndex,err.what());
+					_exit(2);
+					}
+				_exit(numTorn!=0?1:0);
+				}
+			else if(pid>0)
+				readers.push_back(pid);
+			else
+				std::cerr<<"Unable to fork reader process "<<readerIndex<<std::endl;
+			}
+		
+		/* Post states until all readers have finished: */
+		unsigned int numPosts=0;
+		Realtime::TimePointMonotonic start;
+		size_t numRunning=readers.size();
+		bool failed=false;
+		while(numRunning>0)
+			{
+			for(int i=0;i<1024;++i,++numPosts)
+				{
+				/* Write the next state directly into the ring to maximize the chance of readers catching it half-written: */
+				Realtime::TimePointMonotonic postTime;
+				fillState(static_cast<unsigned int*>(ring.beginWrite()),numWords,numPosts,postTime);
+				ring.finishWrite(postTime);
+				}
+			
+			/* Collect finished readers: */
+			int status;
+			pid_t pid;
+			while(numRunning>0&&(pid=waitpid(-1,&status,WNOHANG))>0)
+				{
+				--numRunning;
+				if(!WIFEXITED(status)||WEXITSTATUS(status)!=0)
+					failed=true;
+				}
+			}
+		double elapsed(start.setAndDiff());
+		
+		std::cout<<"Writer: "<<numPosts<<" states of "<<numWords*sizeof(unsigned int)<<" bytes posted into "<<numSlots<<" slots ("<<double(numPosts)/elapsed<<"/s)"<<std::endl;
+		if(failed)
+			{
+			std::cout<<"FAILED: At least one reader observed a torn state or terminated abnormally"<<std::endl;
+			return 1;
+			}
+		std::cout<<"PASSED: No reader observed a torn state"<<std::endl;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Test failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,225 @@
+/***********************************************************************
+TextureCacheBenchmark - Utility to measure how long Images::
+TextureManager takes to load a set of texture images as encoded data,
+and to decode and mipmap them with a cold and a warm decoded image
+cache, and to check that cached images match directly decoded ones.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Images/BaseImage.h>
+#include <Images/ReadImageFile.h>
+#include <Images/WriteImageFile.h>
+#include <Images/TextureManager.h>
+
+namespace {
+
+/* Writes a synthetic RGB test image with smooth gradients and noise to the given file: */
+void writeTestImage(const char* fileName,unsigned int size,unsigned int seed)
+	{
+	std::vector<unsigned char> pixels(size_t(size)*size_t(size)*3);
+	unsigned char* pPtr=&pixels[0];
+	double phase=double(seed)*0.7;
+	for(unsigned int y=0;y<size;++y)
+		for(unsigned int x=0;x<size;++x,pPtr+=3)
+			{
+			double u=double(x)/double(size);
+			double v=double(y)/double(size);
+			pPtr[0]=(unsigned char)(127.5+100.0*sin(u*12.0+phase)+double(rand()%27));
+			pPtr[1]=(unsigned char)(127.5+100.0*cos(v*9.0-phase)+double(rand()%27));
+			pPtr[2]=(unsigned char)(127.5+100.0*sin((u+v)*7.0)+double(rand()%27));
+			}
+	Images::writeImageFile(size,size,&pixels[0],fileName);
+	}
+
+/* Removes all files from the given directory: */
+void clearDirectory(const std::string& dirName)
+	{
+	DIR* dir=opendir(dirName.c_str());
+	if(dir==0)
+		return;
+	struct dirent* entry;
+	while((entry=readdir(dir))!=0)
+		if(entry->d_name[0]!='.')
+			unlink((dirName+"/"+entry->d_name).c_str());
+	closedir(dir);
+	}
+
+/* Returns true if the two given images have the same format and identical pixels: */
+bool equal(const Images::BaseImage& image1,const Images::BaseImage& image2)
+	{
+	if(image1.getWidth()!=image2.getWidth()||image1.getHeight()!=image2.getHeight()||image1.getNumChannels()!=image2.getNumChannels()||image1.getChannelSize()!=image2.getChannelSize()||image1.getFormat()!=image2.getFormat()||image1.getScalarType()!=image2.getScalarType())
+		return false;
+	size_t rowSize=size_t(image1.getWidth())*image1.getNumChannels()*image1.getChannelSize();
+	for(unsigned int y=0;y<image1.getHeight();++y)
+		if(memcmp(image1.getPixelRow(y),image2.getPixelRow(y),rowSize)!=0)
+			return false;
+	return true;
+	}
+
+/* Loads all given images with the given texture manager and returns the time it took; stores the decoded mipmap levels of all images if they were decoded: */
+double loadAll(Images::TextureManager& textureManager,const std::vector<std::string>& fileNames,std::vector<std::vector<Images::BaseImage> >& levels,size_t& numEncodedBytes)
+	{
+	Realtime::TimePointMonotonic start;
+	std::vector<Images::TextureManager::Handle> handles;
+	for(std::vector<std::string>::const_iterator fnIt=fileNames.begin();fnIt!=fileNames.end();++fnIt)
+		handles.push_back(textureManager.loadTexture(fnIt->c_str(),GL_TEXTURE_2D,GL_RGB8));
+	textureManager.waitForImageData();
+	double result(start.setAndDiff());
+	
+	/* Retrieve the loaded image data: */
+	levels.clear();
+	numEncodedBytes=0;
+	for(std::vector<Images::TextureManager::Handle>::iterator hIt=handles.begin();hIt!=handles.end();++hIt)
+		{
+		const Images::TextureManager::Texture* texture=textureManager.getTexture(*hIt,false);
+		levels.push_back(std::vector<Images::BaseImage>());
+		for(unsigned int level=0;level<texture->getNumLevels();++level)
+			levels.back().push_back(texture->getLevel(level));
+		if(texture->getImageFile()!=0)
+			numEncodedBytes+=texture->getImageFile()->getDataSize();
+		}
+	
+	return result;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numImages=24;
+	unsigned int imageSize=1024;
+	unsigned int numLoaderThreads=2;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"images")==0&&i+1<argc)
+				numImages=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				imageSize=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				numLoaderThreads=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(numLoaderThreads<1)
+		numLoaderThreads=1;
+	
+	try
+		{
+		/* Create a temporary directory for the test images and the cache: */
+		char tempDirName[]="/tmp/TextureCacheBenchmarkXXXXXX";
+		if(mkdtemp(tempDirName)==0)
+			throw std::runtime_error("Unable to create temporary directory");
+		std::string tempDir=tempDirName;
+		std::string cacheDir=tempDir+"/Cache";
+		std::vector<std::string> fileNames;
+		for(unsigned int i=0;i<numImages;++i)
+			{
+			char fileName[64];
+			snprintf(fileName,sizeof(fileName),"/Image%03u.jpg",i);
+			fileNames.push_back(tempDir+fileName);
+			writeTestImage(fileNames.back().c_str(),imageSize,i);
+			}
+		
+		std::cout<<"Loading "<<numImages<<" "<<imageSize<<"x"<<imageSize<<" JPEG images with "<<numLoaderThreads<<" loader threads:"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		bool passed=true;
+		
+		/* Load the encoded images only: */
+		std::vector<std::vector<Images::BaseImage> > levels;
+		size_t numEncodedBytes;
+		{
+		Images::TextureManager textureManager(numLoaderThreads);
+		double time=loadAll(textureManager,fileNames,levels,numEncodedBytes);
+		std::cout<<"  "<<std::setw(30)<<std::left<<"Encoded data only"<<std::right<<std::setw(10)<<time*1000.0<<" ms, "<<numEncodedBytes<<" encoded bytes"<<std::endl;
+		}
+		
+		/* Decode and mipmap the images with an empty cache: */
+		std::vector<std::vector<Images::BaseImage> > coldLevels;
+		{
+		Images::TextureManager textureManager(numLoaderThreads,cacheDir.c_str());
+		clearDirectory(cacheDir);
+		double time=loadAll(textureManager,fileNames,coldLevels,numEncodedBytes);
+		std::cout<<"  "<<std::setw(30)<<std::left<<"Decode and mipmap, cold cache"<<std::right<<std::setw(10)<<time*1000.0<<" ms"<<std::endl;
+		}
+		
+		/* Decode and mipmap the images again from the now populated cache: */
+		std::vector<std::vector<Images::BaseImage> > warmLevels;
+		{
+		Images::TextureManager textureManager(numLoaderThreads,cacheDir.c_str());
+		double time=loadAll(textureManager,fileNames,warmLevels,numEncodedBytes);
+		std::cout<<"  "<<std::setw(30)<<std::left<<"Decode and mipmap, warm cache"<<std::right<<std::setw(10)<<time*1000.0<<" ms"<<std::endl;
+		}
+		
+		/* Compare cold and warm results against images decoded and mipmapped directly: */
+		unsigned int numMismatches=0;
+		for(unsigned int i=0;i<numImages;++i)
+			{
+			std::vector<Images::BaseImage> reference;
+			reference.push_back(Images::readGenericImageFile(fileNames[i].c_str()));
+			while(reference.back().getWidth()%2==0&&reference.back().getHeight()%2==0)
+				{
+				Images::BaseImage level=reference.back().shrink();
+				reference.push_back(level);
+				}
+			bool match=coldLevels[i].size()==reference.size()&&warmLevels[i].size()==reference.size();
+			for(size_t level=0;match&&level<reference.size();++level)
+				match=equal(coldLevels[i][level],reference[level])&&equal(warmLevels[i][level],reference[level]);
+			if(!match)
+				++numMismatches;
+			}
+		std::cout<<"  "<<numMismatches<<" of "<<numImages<<" images differ from directly decoded images"<<std::endl;
+		passed=numMismatches==0;
+		
+		/* Clean up: */
+		clearDirectory(cacheDir);
+		rmdir(cacheDir.c_str());
+		clearDirectory(tempDir);
+		rmdir(tempDir.c_str());
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,271 @@
+/***********************************************************************
+VRDeviceManagerStressTest - Utility to measure the cost of delivering
+device state update notifications from a VR device manager driving a
+large number of dummy trackers at a high update rate, and to check that
+complete device state updates keep arriving while trackers report at
+different rates.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/CompoundValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
+#include <Threads/EventDispatcher.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+#include <VRDeviceDaemon/Config.h>
+#include <VRDeviceDaemon/VRDeviceManager.h>
+
+namespace {
+
+/****************************************************************
+VR streamer collecting statistics about received update batches:
+****************************************************************/
+
+class StressStreamer:public VRDeviceManager::VRStreamer
+	{
+	/* Embedded classes: */
+	public:
+	typedef Vrui::VRDeviceState::TimeStamp TimeStamp;
+	
+	/* Elements: */
+	private:
+	std::vector<Vrui::VRDeviceState::TrackerState> trackerStates; // Copies of updated tracker states, as a server would serialize them
+	unsigned int numBatches; // Total number of received batches
+	unsigned int numCompleteBatches; // Number of received batches marking a complete device state update
+	unsigned int numTrackerBatches; // Number of received batches containing tracker updates
+	unsigned int numTrackerUpdates; // Total number of tracker updates in all received batches
+	unsigned int numButtonUpdates; // Total number of button updates in all received batches
+	unsigned int numValuatorUpdates; // Total number of valuator updates in all received batches
+	double latencySum; // Sum of time from the oldest tracker report in each batch to the batch's delivery, in microseconds
+	double maxLatency; // Maximum time from the oldest tracker report in a batch to the batch's delivery, in microseconds
+	bool haveCompleteBatch; // Flag whether a complete batch has been received
+	TimeStamp lastCompleteTime; // Time at which the most recent complete batch was received
+	double maxCompleteInterval; // Maximum time between two consecutive complete batches, in microseconds
+	
+	/* Constructors and destructors: */
+	public:
+	StressStreamer(VRDeviceManager* sDeviceManager)
+		:VRDeviceManager::VRStreamer(sDeviceManager),
+		 trackerStates(state.getNumTrackers()),
+		 numBatches(0),numCompleteBatches(0),numTrackerBatches(0),
+		 numTrackerUpdates(0),numButtonUpdates(0),numValuatorUpdates(0),
+		 latencySum(0.0),maxLatency(0.0),
+		 haveCompleteBatch(false),lastCompleteTime(0),maxCompleteInterval(0.0)
+		{
+		}
+	
+	/* Methods from class VRDeviceManager::VRStreamer: */
+	virtual void updateCompleted(const VRDeviceManager::UpdateBatch& batch)
+		{
+		TimeStamp now=VRDeviceManager::getTimeStamp();
+		
+		/* Copy the states of all updated trackers and find the oldest time stamp in the batch: */
+		TimeStamp maxAge=0;
+		const VRDeviceManager::IndexRangeList& ranges=batch.trackers.getRanges();
+		for(VRDeviceManager::IndexRangeList::const_iterator rIt=ranges.begin();rIt!=ranges.end();++rIt)
+			for(int trackerIndex=rIt->first;trackerIndex<rIt->last;++trackerIndex)
+				{
+				trackerStates[trackerIndex]=state.getTrackerState(trackerIndex);
+				TimeStamp age=now-state.getTrackerTimeStamp(trackerIndex);
+				if(maxAge<age)
+					maxAge=age;
+				}
+		
+		/* Update the statistics: */
+		++numBatches;
+		if(batch.complete)
+			{
+			++numCompleteBatches;
+			if(haveCompleteBatch&&maxCompleteInterval<double(now-lastCompleteTime))
+				maxCompleteInterval=double(now-lastCompleteTime);
+			haveCompleteBatch=true;
+			lastCompleteTime=now;
+			}
+		numTrackerUpdates+=batch.trackers.getNumIndices();
+		numButtonUpdates+=batch.buttons.getNumIndices();
+		numValuatorUpdates+=batch.valuators.getNumIndices();
+		if(!batch.trackers.empty())
+			{
+			++numTrackerBatches;
+			latencySum+=double(maxAge);
+			if(maxLatency<double(maxAge))
+				maxLatency=double(maxAge);
+			}
+		}
+	virtual void batteryStateUpdated(unsigned int deviceIndex)
+		{
+		}
+	virtual void hmdConfigurationUpdated(const Vrui::HMDConfiguration* hmdConfiguration)
+		{
+		}
+	
+	/* New methods: */
+	unsigned int getNumCompleteBatches(void) const // Returns the number of received complete batches
+		{
+		return numCompleteBatches;
+		}
+	double getMaxCompleteInterval(void) const // Returns the maximum time between two consecutive complete batches in microseconds
+		{
+		return maxCompleteInterval;
+		}
+	void printStatistics(double elapsed,double cpuTime) const // Prints statistics for the given elapsed wall-clock and process CPU times in seconds
+		{
+		std::cout<<std::fixed<<std::setprecision(2);
+		std::cout<<"Received "<<numBatches<<" batches ("<<double(numBatches)/elapsed<<"/s), "<<numCompleteBatches<<" complete ("<<double(numCompleteBatches)/elapsed<<"/s), maximum interval between complete batches "<<maxCompleteInterval<<" us"<<std::endl;
+		std::cout<<"Tracker updates: "<<numTrackerUpdates<<" ("<<double(numTrackerUpdates)/elapsed<<"/s)"<<std::endl;
+		std::cout<<"Button updates: "<<numButtonUpdates<<", valuator updates: "<<numValuatorUpdates<<std::endl;
+		if(numTrackerBatches>0)
+			std::cout<<"Tracker batch latency: mean "<<latencySum/double(numTrackerBatches)<<" us, max "<<maxLatency<<" us"<<std::endl;
+		unsigned int numUpdates=numTrackerUpdates+numButtonUpdates+numValuatorUpdates;
+		if(numUpdates>0)
+			std::cout<<"Process CPU time: "<<cpuTime*100.0/elapsed<<"% of one core, "<<cpuTime*1.0e9/double(numUpdates)<<" ns per device state update"<<std::endl;
+		}
+	};
+
+double getCpuTime(void) // Returns the user and system CPU time consumed by the process so far in seconds
+	{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return double(usage.ru_utime.tv_sec+usage.ru_stime.tv_sec)+double(usage.ru_utime.tv_usec+usage.ru_stime.tv_usec)*1.0e-6;
+	}
+
+/* Adds a dummy device with the given layout and update rate to the device manager configuration in the given file's current section: */
+void addDummyDevice(Misc::ConfigurationFile& configFile,std::vector<std::string>& deviceNames,const char* deviceName,int numTrackers,int numButtons,int numValuators,int updateRate)
+	{
+	deviceNames.push_back(deviceName);
+	configFile.storeValue("./deviceNames",deviceNames);
+	configFile.setCurrentSection(deviceName);
+	configFile.storeString("./deviceType","DummyDevice");
+	configFile.storeValue("./numTrackers",numTrackers);
+	configFile.storeValue("./numButtons",numButtons);
+	configFile.storeValue("./numValuators",numValuators);
+	configFile.storeValue("./sleepTime",1000000/updateRate);
+	configFile.setCurrentSection("..");
+	}
+
+/* Runs a device manager configured by the given configuration file for the given time and prints update statistics; returns false if complete updates arrived less often than the given minimum rate: */
+bool runDeviceManager(Misc::ConfigurationFile& configFile,double runTime,double minCompleteRate)
+	{
+	/* Create the device manager and attach the statistics-gathering streamer: */
+	Threads::EventDispatcher dispatcher;
+	VRDeviceManager deviceManager(dispatcher,configFile);
+	StressStreamer streamer(&deviceManager);
+	deviceManager.setStreamer(&streamer);
+	
+	/* Let the dummy devices run for the requested time: */
+	double cpuStart=getCpuTime();
+	Realtime::TimePointMonotonic start;
+	deviceManager.start();
+	usleep((unsigned int)(runTime*1.0e6+0.5));
+	deviceManager.stop();
+	double elapsed(start.setAndDiff());
+	double cpuTime=getCpuTime()-cpuStart;
+	deviceManager.setStreamer(0);
+	
+	streamer.printStatistics(elapsed,cpuTime);
+	return double(streamer.getNumCompleteBatches())>=minCompleteRate*elapsed;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numTrackers=256;
+	int numButtons=0;
+	int numValuators=0;
+	int updateRate=1000;
+	double runTime=10.0;
+	std::string deviceDirectory=VRDEVICEDAEMON_CONFIG_VRDEVICESDIR;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"trackers")==0&&i+1<argc)
+				numTrackers=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"buttons")==0&&i+1<argc)
+				numButtons=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"valuators")==0&&i+1<argc)
+				numValuators=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"rate")==0&&i+1<argc)
+				updateRate=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"time")==0&&i+1<argc)
+				runTime=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"deviceDirectory")==0&&i+1<argc)
+				deviceDirectory=argv[++i];
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(updateRate<1)
+		updateRate=1;
+	
+	/* Create a device manager configuration with a single dummy device: */
+	Misc::ConfigurationFile configFile;
+	configFile.setCurrentSection("/DeviceManager");
+	configFile.storeString("./deviceDirectory",deviceDirectory);
+	std::vector<std::string> deviceNames;
+	addDummyDevice(configFile,deviceNames,"StressDevice",numTrackers,numButtons,numValuators,updateRate);
+	
+	/* Create a device manager configuration with three single-tracker dummy devices reporting at different rates: */
+	Misc::ConfigurationFile mixedConfigFile;
+	mixedConfigFile.setCurrentSection("/DeviceManager");
+	mixedConfigFile.storeString("./deviceDirectory",deviceDirectory);
+	std::vector<std::string> mixedDeviceNames;
+	addDummyDevice(mixedConfigFile,mixedDeviceNames,"FastDevice",1,0,0,1000);
+	addDummyDevice(mixedConfigFile,mixedDeviceNames,"MediumDevice",1,0,0,90);
+	addDummyDevice(mixedConfigFile,mixedDeviceNames,"SlowDevice",1,0,0,60);
+	
+	try
+		{
+		/* Drive the requested number of trackers from a single device: */
+		std::cout<<"Driving "<<numTrackers<<" trackers, "<<numButtons<<" buttons, and "<<numValuators<<" valuators at up to "<<updateRate<<" Hz for "<<runTime<<" s"<<std::endl;
+		runDeviceManager(configFile,runTime,0.0);
+		
+		/* Drive three trackers at different rates, and expect complete updates at no less than half the slowest tracker's rate: */
+		std::cout<<std::endl<<"Driving three trackers at 1000 Hz, 90 Hz, and 60 Hz for "<<runTime<<" s"<<std::endl;
+		bool passed=runDeviceManager(mixedConfigFile,runTime,30.0);
+		
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Stress test failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,305 @@
+/***********************************************************************
+VRDeviceProtocolBenchmark - Utility to compare the bandwidth, encoding
+and decoding cost, and reconstruction error of full-precision per-device
+state update messages and quantized, delta-encoded frame updates in the
+VR device protocol at typical tracking rates.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <IO/VariableMemoryFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Realtime/Time.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <Vrui/Internal/VRDeviceProtocol.h>
+
+namespace {
+
+typedef Vrui::VRDeviceState::TrackerState TrackerState;
+typedef TrackerState::PositionOrientation PositionOrientation;
+typedef PositionOrientation::Vector Vector;
+typedef PositionOrientation::Rotation Rotation;
+
+/***************************************************************
+Protocol class granting access to the protocol's message types:
+***************************************************************/
+
+class Protocol:public Vrui::VRDeviceProtocol
+	{
+	/* Methods: */
+	public:
+	static void writeUpdates(const Vrui::VRDeviceState& state,const std::vector<int>& trackers,const std::vector<int>& buttons,const std::vector<int>& valuators,IO::File& sink) // Writes per-device update messages exactly as a device server does for clients not using frame updates
+		{
+		for(std::vector<int>::const_iterator tIt=trackers.begin();tIt!=trackers.end();++tIt)
+			{
+			sink.write(MessageIdType(TRACKER_UPDATE));
+			sink.write(Misc::UInt16(*tIt));
+			Misc::Marshaller<TrackerState>::write(state.getTrackerState(*tIt),sink);
+			sink.write(state.getTrackerTimeStamp(*tIt));
+			sink.write(Misc::UInt8(state.getTrackerValid(*tIt)?1U:0U));
+			}
+		for(std::vector<int>::const_iterator bIt=buttons.begin();bIt!=buttons.end();++bIt)
+			{
+			sink.write(MessageIdType(BUTTON_UPDATE));
+			sink.write(Misc::UInt16(*bIt));
+			sink.write(Misc::UInt8(state.getButtonState(*bIt)?1U:0U));
+			}
+		for(std::vector<int>::const_iterator vIt=valuators.begin();vIt!=valuators.end();++vIt)
+			{
+			sink.write(MessageIdType(VALUATOR_UPDATE));
+			sink.write(Misc::UInt16(*vIt));
+			sink.write(state.getValuatorState(*vIt));
+			}
+		}
+	static void readUpdates(IO::File& source,Vrui::VRDeviceState& state) // Reads per-device update messages until the end of the source exactly as a device client does
+		{
+		while(!source.eof())
+			{
+			MessageIdType message=source.read<MessageIdType>();
+			int index=source.read<Misc::UInt16>();
+			if(message==TRACKER_UPDATE)
+				{
+				state.setTrackerState(index,Misc::Marshaller<TrackerState>::read(source));
+				state.setTrackerTimeStamp(index,source.read<Vrui::VRDeviceState::TimeStamp>());
+				state.setTrackerValid(index,source.read<Misc::UInt8>()!=0U);
+				}
+			else if(message==BUTTON_UPDATE)
+				state.setButtonState(index,source.read<Misc::UInt8>()!=0U);
+			else if(message==VALUATOR_UPDATE)
+				state.setValuatorState(index,source.read<Vrui::VRDeviceState::ValuatorState>());
+			else
+				throw std::runtime_error("Unexpected message in update stream");
+			}
+		}
+	};
+
+/*************************************************
+Simulated set of smoothly moving tracked devices:
+*************************************************/
+
+class DeviceSimulator
+	{
+	/* Elements: */
+	private:
+	Vrui::VRDeviceState& state; // Device state to animate
+	float range; // Radius of the region in which trackers move
+	std::vector<Vector> centers; // Center points of the trackers' circular paths
+	std::vector<Vector> axes; // Rotation axes of the trackers
+	std::vector<float> speeds; // Angular speeds of the trackers in radians/s
+	
+	/* Private methods: */
+	static float randUniform(float min,float max)
+		{
+		return min+(max-min)*float(rand())/float(RAND_MAX);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	DeviceSimulator(Vrui::VRDeviceState& sState,float sRange,float offset)
+		:state(sState),range(sRange)
+		{
+		for(int i=0;i<state.getNumTrackers();++i)
+			{
+			Vector center;
+			for(int j=0;j<3;++j)
+				center[j]=offset+randUniform(-range,range);
+			centers.push_back(center);
+			Vector axis(randUniform(-1.0f,1.0f),randUniform(-1.0f,1.0f),1.0f);
+			axis.normalize();
+			axes.push_back(axis);
+			speeds.push_back(randUniform(0.5f,3.0f));
+			}
+		}
+	
+	/* Methods: */
+	void update(double time,std::vector<int>& trackers,std::vector<int>& buttons,std::vector<int>& valuators) // Advances the simulation to the given time and returns the indices of changed devices
+		{
+		trackers.clear();
+		buttons.clear();
+		valuators.clear();
+		
+		/* Move all trackers along circular paths while spinning them: */
+		Vrui::VRDeviceState::TimeStamp timeStamp=Vrui::VRDeviceState::TimeStamp(time*1.0e6);
+		for(int i=0;i<state.getNumTrackers();++i)
+			{
+			float angle=float(time)*speeds[i];
+			float radius=range*0.25f;
+			Vector offset(Math::cos(angle)*radius,Math::sin(angle)*radius,0.0f);
+			TrackerState ts;
+			ts.positionOrientation=PositionOrientation(centers[i]+offset,Rotation::rotateAxis(axes[i],angle));
+			ts.linearVelocity=Vector(-Math::sin(angle)*radius*speeds[i],Math::cos(angle)*radius*speeds[i],0.0f);
+			ts.angularVelocity=axes[i]*speeds[i];
+			state.setTrackerState(i,ts);
+			state.setTrackerTimeStamp(i,timeStamp);
+			state.setTrackerValid(i,true);
+			trackers.push_back(i);
+			}
+		
+		/* Occasionally toggle a button and move a valuator: */
+		if(state.getNumButtons()>0&&rand()%16==0)
+			{
+			int index=rand()%state.getNumButtons();
+			state.setButtonState(index,!state.getButtonState(index));
+			buttons.push_back(index);
+			}
+		for(int i=0;i<state.getNumValuators();++i)
+			if(rand()%4==0)
+				{
+				state.setValuatorState(i,Math::sin(float(time)*float(i+1)));
+				valuators.push_back(i);
+				}
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numTrackers=3;
+	int numButtons=16;
+	int numValuators=4;
+	double simTime=10.0;
+	float range=2.0f;
+	float offset=0.0f;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"trackers")==0&&i+1<argc)
+				numTrackers=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"buttons")==0&&i+1<argc)
+				numButtons=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"valuators")==0&&i+1<argc)
+				numValuators=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"time")==0&&i+1<argc)
+				simTime=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"range")==0&&i+1<argc)
+				range=float(atof(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"offset")==0&&i+1<argc)
+				offset=float(atof(argv[++i]));
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	
+	try
+		{
+		std::cout<<numTrackers<<" trackers, "<<numButtons<<" buttons, "<<numValuators<<" valuators, "<<simTime<<" s of simulated motion"<<std::endl;
+		std::cout<<"Frame updates clamp positions to +-"<<1.0e9/double(Vrui::VRDeviceProtocol::FrameCoder::positionScale)<<" units"<<std::endl;
+		std::cout<<std::fixed;
+		
+		static const int rates[]={90,120,1000};
+		for(int rateIndex=0;rateIndex<3;++rateIndex)
+			{
+			int rate=rates[rateIndex];
+			int numFrames=int(simTime*double(rate)+0.5);
+			
+			/* Create the server and client states and the frame coders on both sides: */
+			Vrui::VRDeviceState serverState,messageClientState,frameClientState;
+			serverState.setLayout(numTrackers,numButtons,numValuators);
+			messageClientState.setLayout(numTrackers,numButtons,numValuators);
+			frameClientState.setLayout(numTrackers,numButtons,numValuators);
+			Vrui::VRDeviceProtocol::FrameCoder serverCoder(serverState);
+			Vrui::VRDeviceProtocol::FrameCoder clientCoder(frameClientState);
+			serverCoder.reset();
+			clientCoder.reset();
+			std::vector<Misc::UInt8> frame(serverCoder.getMaxFrameSize());
+			
+			srand(rate);
+			DeviceSimulator simulator(serverState,range,offset);
+			std::vector<int> trackers,buttons,valuators;
+			IO::VariableMemoryFile messageFile;
+			
+			size_t messageBytes=0,frameBytes=0;
+			double messageEncodeTime=0.0,messageDecodeTime=0.0,frameEncodeTime=0.0,frameDecodeTime=0.0;
+			float maxPosError=0.0f,maxAngleError=0.0f;
+			for(int frameIndex=0;frameIndex<numFrames;++frameIndex)
+				{
+				simulator.update(double(frameIndex)/double(rate),trackers,buttons,valuators);
+				
+				/* Send the updates as individual full-precision messages: */
+				messageFile.clear();
+				Realtime::TimePointMonotonic t0;
+				Protocol::writeUpdates(serverState,trackers,buttons,valuators,messageFile);
+				messageFile.flush();
+				messageEncodeTime+=double(t0.setAndDiff());
+				size_t messageSize=messageFile.getDataSize();
+				messageBytes+=messageSize;
+				IO::FilePtr reader=messageFile.getReader();
+				t0.set();
+				Protocol::readUpdates(*reader,messageClientState);
+				messageDecodeTime+=double(t0.setAndDiff());
+				
+				/* Send the updates as a single frame: */
+				t0.set();
+				size_t frameSize=serverCoder.encodeFrame(serverState,trackers,buttons,valuators,&frame[0]);
+				frameEncodeTime+=double(t0.setAndDiff());
+				frameBytes+=sizeof(Vrui::VRDeviceProtocol::MessageIdType)+sizeof(Misc::UInt32)+frameSize;
+				t0.set();
+				clientCoder.decodeFrame(&frame[0],frameSize,frameClientState,0);
+				frameDecodeTime+=double(t0.setAndDiff());
+				
+				/* Measure the frame coder's reconstruction error: */
+				for(int i=0;i<numTrackers;++i)
+					{
+					const PositionOrientation& s=serverState.getTrackerState(i).positionOrientation;
+					const PositionOrientation& c=frameClientState.getTrackerState(i).positionOrientation;
+					float posError=Geometry::dist(s.getOrigin(),c.getOrigin());
+					if(maxPosError<posError)
+						maxPosError=posError;
+					Rotation delta=s.getRotation()*Geometry::invert(c.getRotation());
+					const float* dq=delta.getQuaternion();
+					float angleError=2.0f*Math::asin(Math::min(Math::sqrt(dq[0]*dq[0]+dq[1]*dq[1]+dq[2]*dq[2]),1.0f)); // More precise than getAngle() for small angles
+					if(maxAngleError<angleError)
+						maxAngleError=angleError;
+					}
+				
+				/* Check that the full-precision messages arrived intact: */
+				if(memcmp(serverState.getTrackerStates(),messageClientState.getTrackerStates(),size_t(numTrackers)*sizeof(TrackerState))!=0)
+					throw std::runtime_error("Full-precision update messages corrupted tracker states");
+				}
+			
+			double perFrame=1.0e9/double(numFrames);
+			std::cout<<std::setw(5)<<rate<<" Hz:"<<std::endl;
+			std::cout<<std::setprecision(1);
+			std::cout<<"  Messages: "<<std::setw(10)<<double(messageBytes)*double(rate)/double(numFrames)<<" bytes/s, encode "<<messageEncodeTime*perFrame<<" ns/frame, decode "<<messageDecodeTime*perFrame<<" ns/frame"<<std::endl;
+			std::cout<<"  Frames:   "<<std::setw(10)<<double(frameBytes)*double(rate)/double(numFrames)<<" bytes/s, encode "<<frameEncodeTime*perFrame<<" ns/frame, decode "<<frameDecodeTime*perFrame<<" ns/frame"<<std::endl;
+			std::cout<<std::setprecision(6);
+			std::cout<<"  Frame reconstruction error: position "<<maxPosError<<" units, orientation "<<Math::deg(maxAngleError)<<" degrees"<<std::endl;
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,475 @@
+/***********************************************************************
+VideoExtractorBenchmark - Utility to check the video frame extractors
+for YUYV, UYVY, YV12, Y10B, and BA81 frames against straightforward
+per-pixel reference conversions, and to measure their throughput in
+frames per second.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Realtime/Time.h>
+#include <Threads/WorkerPool.h>
+#include <Video/Types.h>
+#include <Video/FrameBuffer.h>
+#include <Video/Colorspaces.h>
+#include <Video/ImageExtractor.h>
+#include <Video/Internal/ImageExtractorYUYV.h>
+#include <Video/Internal/ImageExtractorUYVY.h>
+#include <Video/Internal/ImageExtractorYV12.h>
+#include <Video/Internal/ImageExtractorY10B.h>
+#include <Video/Internal/ImageExtractorBA81.h>
+
+namespace {
+
+/****************************
+Supported raw frame formats:
+****************************/
+
+enum Format
+	{
+	YUYV,UYVY,YV12,Y10B,BA81_RGGB,BA81_BGGR,NUM_FORMATS
+	};
+
+const char* formatNames[NUM_FORMATS]={"YUYV","UYVY","YV12","Y10B","BA81 RGGB","BA81 BGGR"};
+
+/**************************************************
+Set of images extracted from a single video frame:
+**************************************************/
+
+struct Extraction
+	{
+	/* Elements: */
+	public:
+	std::vector<unsigned char> grey; // Greyscale image, bottom row first
+	std::vector<unsigned char> rgb; // RGB image, bottom row first
+	std::vector<unsigned char> ypcbcr; // Y'CbCr image, bottom row first
+	std::vector<unsigned char> yp,cb,cr; // Y'CbCr 4:2:0 planes, top row first
+	
+	/* Constructors and destructors: */
+	Extraction(const Video::Size& size)
+		:grey(size.volume(),0),rgb(size.volume()*3,0),ypcbcr(size.volume()*3,0),
+		 yp(size.volume(),0),cb((size[0]/2)*(size[1]/2),0),cr((size[0]/2)*(size[1]/2),0)
+		{
+		}
+	
+	/* Methods: */
+	bool operator==(const Extraction& other) const
+		{
+		return grey==other.grey&&rgb==other.rgb&&ypcbcr==other.ypcbcr&&yp==other.yp&&cb==other.cb&&cr==other.cr;
+		}
+	};
+
+/* Returns the size of a raw frame of the given format and size in bytes: */
+size_t getFrameSize(Format format,const Video::Size& size)
+	{
+	switch(format)
+		{
+		case YUYV:
+		case UYVY:
+			return size.volume()*2;
+		
+		case YV12:
+			return size.volume()+(size[0]/2)*(size[1]/2)*2;
+		
+		case Y10B:
+			return ((size[0]*5)/4)*size[1];
+		
+		default:
+			return size.volume();
+		}
+	}
+
+/* Creates an image extractor for the given format and frame size: */
+Video::ImageExtractor* createExtractor(Format format,const Video::Size& size)
+	{
+	switch(format)
+		{
+		case YUYV:
+			return new Video::ImageExtractorYUYV(size);
+		
+		case UYVY:
+			return new Video::ImageExtractorUYVY(size);
+		
+		case YV12:
+			{
+			ptrdiff_t ySize=ptrdiff_t(size[0])*ptrdiff_t(size[1]);
+			ptrdiff_t cbcrStride=ptrdiff_t(size[0]/2);
+			ptrdiff_t cbcrSize=cbcrStride*ptrdiff_t(size[1]/2);
+			return new Video::ImageExtractorYV12(size,0,size[0],ySize,cbcrStride,ySize+cbcrSize,cbcrStride);
+			}
+		
+		case Y10B:
+			return new Video::ImageExtractorY10B(size);
+		
+		case BA81_RGGB:
+			return new Video::ImageExtractorBA81(size,Video::BAYER_RGGB);
+		
+		default:
+			return new Video::ImageExtractorBA81(size,Video::BAYER_BGGR);
+		}
+	}
+
+/*****************************************
+Per-pixel reference conversion functions:
+*****************************************/
+
+inline unsigned char ypToY(unsigned char yp)
+	{
+	if(yp<=16)
+		return 0;
+	else if(yp>=236)
+		return 255;
+	else
+		return (unsigned char)(((int(yp)-16)*256)/220);
+	}
+
+/* Returns the 10-bit Y' value of the given pixel of a Y10B frame: */
+unsigned int getY10B(const unsigned char* frame,const Video::Size& size,unsigned int x,unsigned int y)
+	{
+	const unsigned char* rPtr=frame+size_t(y)*((size[0]*5)/4)+(x/4)*5;
+	switch(x%4)
+		{
+		case 0:
+			return ((unsigned int)rPtr[0]<<2)|((unsigned int)rPtr[1]>>6);
+		
+		case 1:
+			return (((unsigned int)rPtr[1]&0x3fU)<<4)|((unsigned int)rPtr[2]>>4);
+		
+		case 2:
+			return (((unsigned int)rPtr[2]&0x0fU)<<6)|((unsigned int)rPtr[3]>>2);
+		
+		default:
+			return (((unsigned int)rPtr[3]&0x03U)<<8)|(unsigned int)rPtr[4];
+		}
+	}
+
+/* Returns the Y'CbCr components of the given pixel of a YUYV, UYVY, or YV12 frame: */
+void getYpCbCr(Format format,const unsigned char* frame,const Video::Size& size,unsigned int x,unsigned int y,unsigned char ypcbcr[3])
+	{
+	if(format==YV12)
+		{
+		size_t ySize=size.volume();
+		size_t cbcrIndex=size_t(y/2)*(size[0]/2)+x/2;
+		ypcbcr[0]=frame[size_t(y)*size[0]+x];
+		ypcbcr[1]=frame[ySize+cbcrIndex];
+		ypcbcr[2]=frame[ySize+(size[0]/2)*(size[1]/2)+cbcrIndex];
+		}
+	else
+		{
+		const unsigned char* pairPtr=frame+(size_t(y)*size[0]+(x&~1U))*2;
+		if(format==YUYV)
+			{
+			ypcbcr[0]=pairPtr[(x&1U)*2];
+			ypcbcr[1]=pairPtr[1];
+			ypcbcr[2]=pairPtr[3];
+			}
+		else
+			{
+			ypcbcr[0]=pairPtr[(x&1U)*2+1];
+			ypcbcr[1]=pairPtr[0];
+			ypcbcr[2]=pairPtr[2];
+			}
+		}
+	}
+
+/* Returns the color channel (0: red, 1: green, 2: blue) sensed by the given pixel of a Bayer-filtered frame: */
+inline int getBayerChannel(Format format,unsigned int x,unsigned int y)
+	{
+	int channel=(x+y)%2==1?1:(y%2==0?0:2);
+	if(format==BA81_BGGR&&channel!=1)
+		channel=2-channel;
+	return channel;
+	}
+
+/* Reconstructs the RGB color of the given pixel of a Bayer-filtered frame by averaging neighboring samples of the missing channels: */
+void demosaic(Format format,const unsigned char* frame,const Video::Size& size,unsigned int x,unsigned int y,unsigned char rgb[3])
+	{
+	unsigned int sums[3]={0,0,0};
+	unsigned int counts[3]={0,0,0};
+	int ownChannel=getBayerChannel(format,x,y);
+	for(int dy=-1;dy<=1;++dy)
+		for(int dx=-1;dx<=1;++dx)
+			{
+			int nx=int(x)+dx;
+			int ny=int(y)+dy;
+			if(nx>=0&&nx<int(size[0])&&ny>=0&&ny<int(size[1]))
+				{
+				int channel=getBayerChannel(format,nx,ny);
+				if(channel!=ownChannel||(dx==0&&dy==0))
+					{
+					sums[channel]+=frame[size_t(ny)*size[0]+nx];
+					++counts[channel];
+					}
+				}
+			}
+	for(int i=0;i<3;++i)
+		rgb[i]=(unsigned char)((sums[i]+counts[i]/2)/counts[i]);
+	}
+
+/* Extracts all images from the given raw frame using the reference conversions: */
+void extractReference(Format format,const unsigned char* frame,const Video::Size& size,Extraction& result)
+	{
+	unsigned int width=size[0];
+	unsigned int height=size[1];
+	for(unsigned int y=0;y<height;++y)
+		for(unsigned int x=0;x<width;++x)
+			{
+			/* Extracted images are flipped vertically: */
+			size_t imageIndex=size_t(height-1-y)*width+x;
+			unsigned char* rgb=&result.rgb[imageIndex*3];
+			unsigned char* ypcbcr=&result.ypcbcr[imageIndex*3];
+			switch(format)
+				{
+				case YUYV:
+				case UYVY:
+				case YV12:
+					getYpCbCr(format,frame,size,x,y,ypcbcr);
+					result.grey[imageIndex]=ypToY(ypcbcr[0]);
+					Video::ypcbcrToRgb(ypcbcr,rgb);
+					result.yp[size_t(y)*width+x]=ypcbcr[0];
+					break;
+				
+				case Y10B:
+					{
+					unsigned int yp=getY10B(frame,size,x,y);
+					if(yp<=64U)
+						result.grey[imageIndex]=0U;
+					else if(yp>=944U)
+						result.grey[imageIndex]=255U;
+					else
+						result.grey[imageIndex]=(unsigned char)(((yp-64U)*256U)/880U);
+					
+					/* RGB extraction has always used a slightly different offset than greyscale extraction: */
+					unsigned char grey;
+					if(yp<=64U)
+						grey=0U;
+					else if(yp>=944U)
+						grey=255U;
+					else
+						grey=(unsigned char)(((yp-62U)*256U)/880U);
+					rgb[0]=rgb[1]=rgb[2]=grey;
+					
+					ypcbcr[0]=(unsigned char)yp;
+					ypcbcr[1]=ypcbcr[2]=0U;
+					result.yp[size_t(y)*width+x]=(unsigned char)((yp+2U)>>2);
+					break;
+					}
+				
+				default:
+					demosaic(format,frame,size,x,y,rgb);
+					result.grey[imageIndex]=(unsigned char)(((unsigned int)rgb[0]*306U+(unsigned int)rgb[1]*601U+(unsigned int)rgb[2]*117U+512U)>>10);
+					Video::rgbToYpcbcr(rgb,ypcbcr);
+					result.yp[size_t(y)*width+x]=ypcbcr[0];
+				}
+			}
+	
+	/* Create the 4:2:0 chroma planes: */
+	for(unsigned int y=0;y<height;y+=2)
+		for(unsigned int x=0;x<width;x+=2)
+			{
+			size_t cbcrIndex=size_t(y/2)*(width/2)+x/2;
+			switch(format)
+				{
+				case YUYV:
+				case UYVY:
+					{
+					/* 4:2:2 frames take Cb from even rows and Cr from odd rows: */
+					unsigned char ypcbcr[3];
+					getYpCbCr(format,frame,size,x,y,ypcbcr);
+					result.cb[cbcrIndex]=ypcbcr[1];
+					getYpCbCr(format,frame,size,x,y+1,ypcbcr);
+					result.cr[cbcrIndex]=ypcbcr[2];
+					break;
+					}
+				
+				case YV12:
+					{
+					unsigned char ypcbcr[3];
+					getYpCbCr(format,frame,size,x,y,ypcbcr);
+					result.cb[cbcrIndex]=ypcbcr[1];
+					result.cr[cbcrIndex]=ypcbcr[2];
+					break;
+					}
+				
+				case Y10B:
+					result.cb[cbcrIndex]=result.cr[cbcrIndex]=0U;
+					break;
+				
+				default:
+					{
+					/* Average the chroma components of the 2x2 pixel block: */
+					int cb=2,cr=2;
+					for(unsigned int by=y;by<y+2;++by)
+						for(unsigned int bx=x;bx<x+2;++bx)
+							{
+							const unsigned char* ypcbcr=&result.ypcbcr[(size_t(height-1-by)*width+bx)*3];
+							cb+=ypcbcr[1];
+							cr+=ypcbcr[2];
+							}
+					result.cb[cbcrIndex]=(unsigned char)(cb>>2);
+					result.cr[cbcrIndex]=(unsigned char)(cr>>2);
+					}
+				}
+			}
+	}
+
+/* Extracts all images from the given raw frame using the given image extractor: */
+void extract(Video::ImageExtractor& extractor,const Video::FrameBuffer& frame,Extraction& result)
+	{
+	const Video::Size& size=extractor.getSize();
+	extractor.extractGrey(&frame,&result.grey[0]);
+	extractor.extractRGB(&frame,&result.rgb[0]);
+	extractor.extractYpCbCr(&frame,&result.ypcbcr[0]);
+	extractor.extractYpCbCr420(&frame,&result.yp[0],size[0],&result.cb[0],size[0]/2,&result.cr[0],size[0]/2);
+	}
+
+/* Fills the given frame buffer with random raw frame data: */
+void createFrame(std::vector<unsigned char>& data,Video::FrameBuffer& frame)
+	{
+	for(std::vector<unsigned char>::iterator dIt=data.begin();dIt!=data.end();++dIt)
+		*dIt=(unsigned char)(rand());
+	frame.start=&data[0];
+	frame.size=frame.used=data.size();
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	Video::Size size(1920,1080);
+	unsigned int numFrames=100;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+2<argc)
+				{
+				size[0]=atoi(argv[i+1]);
+				size[1]=atoi(argv[i+2]);
+				i+=2;
+				}
+			else if(strcasecmp(argv[i]+1,"frames")==0&&i+1<argc)
+				numFrames=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Round the frame size to a multiple of four pixels horizontally and two pixels vertically to support all formats: */
+	size[0]=size[0]<4?4:size[0]&~3U;
+	size[1]=size[1]<2?2:size[1]&~1U;
+	if(numFrames<1)
+		numFrames=1;
+	
+	try
+		{
+		/* Check all formats on small frames of awkward sizes, and on frames large enough to be extracted in parallel: */
+		static const unsigned int checkSizes[][2]={{4,2},{8,4},{12,6},{36,18},{644,482},{1920,1080}};
+		unsigned int numFailures=0;
+		for(int format=0;format<NUM_FORMATS;++format)
+			for(int s=0;s<6;++s)
+				{
+				Video::Size checkSize(checkSizes[s][0],checkSizes[s][1]);
+				std::vector<unsigned char> data(getFrameSize(Format(format),checkSize));
+				Video::FrameBuffer frame;
+				createFrame(data,frame);
+				Extraction reference(checkSize);
+				extractReference(Format(format),frame.start,checkSize,reference);
+				
+				/* Check the extractor in serial and parallel mode: */
+				Video::ImageExtractor* extractor=createExtractor(Format(format),checkSize);
+				for(int parallel=0;parallel<2;++parallel)
+					{
+					extractor->setParallel(parallel!=0);
+					Extraction result(checkSize);
+					extract(*extractor,frame,result);
+					if(!(result==reference))
+						{
+						std::cout<<"  "<<formatNames[format]<<" "<<checkSize[0]<<"x"<<checkSize[1]<<(parallel?" parallel":" serial")<<" differs from the reference"<<std::endl;
+						++numFailures;
+						}
+					}
+				delete extractor;
+				}
+		std::cout<<"Checking extractors against reference conversions: "<<(numFailures==0?"passed":"FAILED")<<std::endl;
+		
+		/* Measure extraction throughput: */
+		std::cout<<"Extracting "<<numFrames<<" "<<size[0]<<"x"<<size[1]<<" frames using up to "<<Threads::WorkerPool::getMaxNumWorkers()<<" worker threads, in frames per second:"<<std::endl;
+		std::cout<<std::setw(10)<<"Format"<<std::setw(10)<<"Grey"<<std::setw(10)<<"RGB"<<std::setw(10)<<"RGB par"<<std::setw(10)<<"Y'CbCr"<<std::setw(10)<<"4:2:0"<<std::setw(10)<<"4:2:0 par"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		for(int format=0;format<NUM_FORMATS;++format)
+			{
+			std::vector<unsigned char> data(getFrameSize(Format(format),size));
+			Video::FrameBuffer frame;
+			createFrame(data,frame);
+			Video::ImageExtractor* extractor=createExtractor(Format(format),size);
+			Extraction result(size);
+			
+			std::cout<<std::setw(10)<<formatNames[format];
+			for(int method=0;method<6;++method)
+				{
+				extractor->setParallel(method==2||method==5);
+				Realtime::TimePointMonotonic start;
+				for(unsigned int i=0;i<numFrames;++i)
+					switch(method)
+						{
+						case 0:
+							extractor->extractGrey(&frame,&result.grey[0]);
+							break;
+						
+						case 1:
+						case 2:
+							extractor->extractRGB(&frame,&result.rgb[0]);
+							break;
+						
+						case 3:
+							extractor->extractYpCbCr(&frame,&result.ypcbcr[0]);
+							break;
+						
+						default:
+							extractor->extractYpCbCr420(&frame,&result.yp[0],size[0],&result.cb[0],size[0]/2,&result.cr[0],size[0]/2);
+						}
+				double elapsed(start.setAndDiff());
+				std::cout<<std::setw(10)<<double(numFrames)/elapsed;
+				}
+			std::cout<<std::endl;
+			delete extractor;
+			}
+		
+		std::cout<<(numFailures==0?"PASSED":"FAILED")<<std::endl;
+		if(numFailures!=0)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
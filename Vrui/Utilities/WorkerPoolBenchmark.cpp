@@ -0,0 +1,332 @@
+/***********************************************************************
+WorkerPoolBenchmark - Utility to measure job submission throughput and
+parallel loop scaling of Threads::WorkerPool against a pool using a
+single mutex-protected submission queue.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Misc/Autopointer.h>
+#include <Misc/RingBuffer.h>
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Threads/Atomic.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <Threads/Barrier.h>
+#include <Threads/FunctionCalls.h>
+#include <Threads/WorkerPool.h>
+
+namespace {
+
+/***********************************************************
+Job function performing a configurable amount of busy work:
+***********************************************************/
+
+class BusyJob:public Threads::WorkerPool::JobFunction
+	{
+	/* Elements: */
+	private:
+	unsigned int numIterations; // Number of loop iterations to execute per call
+	
+	/* Constructors and destructors: */
+	public:
+	BusyJob(unsigned int sNumIterations)
+		:numIterations(sNumIterations)
+		{
+		}
+	
+	/* Methods from class Threads::FunctionCall<int>: */
+	virtual void operator()(int)
+		{
+		volatile unsigned int accumulator=0;
+		for(unsigned int i=0;i<numIterations;++i)
+			accumulator+=i;
+		}
+	};
+
+/*******************************************************************
+Reference pool sharing one mutex-protected queue among all workers:
+*******************************************************************/
+
+class SingleQueuePool
+	{
+	/* Elements: */
+	private:
+	Threads::MutexCond queueCond; // Condition variable protecting the job queue and signalling the arrival of new jobs
+	Misc::RingBuffer<Misc::Autopointer<Threads::WorkerPool::JobFunction> > queue; // Queue of pending jobs
+	size_t numIdleWorkers; // Number of worker threads waiting on the queue
+	bool keepRunning; // Flag to shut down the worker threads
+	size_t numWorkers; // Number of worker threads
+	Threads::Thread* workers; // Array of worker threads
+	Threads::MutexCond completionCond; // Condition variable signalling that all submitted jobs have finished
+	Threads::Atomic<size_t> numPendingJobs; // Number of submitted jobs that have not finished yet
+	
+	/* Private methods: */
+	void* workerThreadMethod(void)
+		{
+		while(true)
+			{
+			/* Wait for the next job: */
+			Misc::Autopointer<Threads::WorkerPool::JobFunction> job;
+			{
+			Threads::MutexCond::Lock queueLock(queueCond);
+			++numIdleWorkers;
+			while(keepRunning&&queue.empty())
+				queueCond.wait(queueLock);
+			--numIdleWorkers;
+			if(!keepRunning)
+				break;
+			job=queue.front();
+			queue.pop_front();
+			}
+			
+			/* Execute the job and signal completion of the last pending job: */
+			(*job)(0);
+			if(numPendingJobs.preSub(1)==0)
+				{
+				Threads::MutexCond::Lock completionLock(completionCond);
+				completionCond.broadcast();
+				}
+			}
+		
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	SingleQueuePool(size_t sNumWorkers)
+		:queue(1024),numIdleWorkers(0),keepRunning(true),
+		 numWorkers(sNumWorkers),workers(new Threads::Thread[numWorkers]),
+		 numPendingJobs(0)
+		{
+		for(size_t i=0;i<numWorkers;++i)
+			workers[i].start(this,&SingleQueuePool::workerThreadMethod);
+		}
+	~SingleQueuePool(void)
+		{
+		{
+		Threads::MutexCond::Lock queueLock(queueCond);
+		keepRunning=false;
+		queueCond.broadcast();
+		}
+		for(size_t i=0;i<numWorkers;++i)
+			workers[i].join();
+		delete[] workers;
+		}
+	
+	/* Methods: */
+	void submitJob(Threads::WorkerPool::JobFunction& job)
+		{
+		numPendingJobs.preAdd(1);
+		Threads::MutexCond::Lock queueLock(queueCond);
+		bool empty=queue.empty();
+		queue.push_back(&job);
+		if(empty&&numIdleWorkers!=0)
+			queueCond.signal();
+		}
+	void wait(void)
+		{
+		Threads::MutexCond::Lock completionLock(completionCond);
+		while(numPendingJobs.get()!=0)
+			completionCond.wait(completionLock);
+		}
+	};
+
+/****************************************************
+Driver submitting jobs from several threads at once:
+****************************************************/
+
+class SubmissionBenchmark
+	{
+	/* Elements: */
+	private:
+	SingleQueuePool* singleQueuePool; // Reference pool to which to submit, or null to submit to Threads::WorkerPool
+	Threads::WorkerPool::JobGroup* group; // Job group collecting all jobs submitted to Threads::WorkerPool
+	unsigned int numJobsPerThread; // Number of jobs to submit from each submitting thread
+	unsigned int jobSize; // Number of busy loop iterations per job
+	Threads::Barrier startBarrier; // Barrier to start all submitting threads at the same time
+	
+	/* Private methods: */
+	void* submitterThreadMethod(void)
+		{
+		/* Create one job object to be shared by all submissions from this thread: */
+		Misc::Autopointer<BusyJob> job(new BusyJob(jobSize));
+		
+		startBarrier.synchronize();
+		if(singleQueuePool!=0)
+			{
+			for(unsigned int i=0;i<numJobsPerThread;++i)
+				singleQueuePool->submitJob(*job);
+			}
+		else
+			{
+			for(unsigned int i=0;i<numJobsPerThread;++i)
+				Threads::WorkerPool::submitJob(*job,*group);
+			}
+		
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	SubmissionBenchmark(unsigned int sNumJobsPerThread,unsigned int sJobSize)
+		:singleQueuePool(0),group(0),
+		 numJobsPerThread(sNumJobsPerThread),jobSize(sJobSize)
+		{
+		}
+	
+	/* Methods: */
+	double run(SingleQueuePool* sSingleQueuePool,unsigned int numSubmitters) // Returns the number of jobs executed per second
+		{
+		singleQueuePool=sSingleQueuePool;
+		Threads::WorkerPool::JobGroup jobGroup;
+		group=&jobGroup;
+		startBarrier.setNumSynchronizingThreads(numSubmitters+1);
+		
+		/* Start the submitting threads and release them all at once: */
+		Threads::Thread* submitters=new Threads::Thread[numSubmitters];
+		for(unsigned int i=0;i<numSubmitters;++i)
+			submitters[i].start(this,&SubmissionBenchmark::submitterThreadMethod);
+		startBarrier.synchronize();
+		Realtime::TimePointMonotonic start;
+		
+		/* Wait until all submitted jobs have finished: */
+		for(unsigned int i=0;i<numSubmitters;++i)
+			submitters[i].join();
+		delete[] submitters;
+		if(singleQueuePool!=0)
+			singleQueuePool->wait();
+		else
+			jobGroup.wait();
+		double elapsed(start.setAndDiff());
+		
+		group=0;
+		return double(numJobsPerThread)*double(numSubmitters)/elapsed;
+		}
+	};
+
+/*************************************************
+Functors for the parallel loop scaling benchmark:
+*************************************************/
+
+class SqrtSumReducer
+	{
+	/* Elements: */
+	private:
+	const std::vector<double>& values; // Array to be reduced
+	
+	/* Constructors and destructors: */
+	public:
+	SqrtSumReducer(const std::vector<double>& sValues)
+		:values(sValues)
+		{
+		}
+	
+	/* Methods: */
+	double operator()(size_t rangeBegin,size_t rangeEnd,double partial)
+		{
+		for(size_t i=rangeBegin;i<rangeEnd;++i)
+			partial+=Math::sqrt(values[i]);
+		return partial;
+		}
+	};
+
+class SumCombiner
+	{
+	/* Methods: */
+	public:
+	double operator()(double v1,double v2)
+		{
+		return v1+v2;
+		}
+	};
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numJobs=200000;
+	unsigned int jobSize=100;
+	unsigned int maxNumSubmitters=Threads::WorkerPool::getMaxNumWorkers();
+	size_t rangeSize=1U<<24;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"jobs")==0&&i+1<argc)
+				numJobs=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"jobSize")==0&&i+1<argc)
+				jobSize=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"submitters")==0&&i+1<argc)
+				maxNumSubmitters=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"range")==0&&i+1<argc)
+				rangeSize=size_t(atol(argv[++i]));
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(maxNumSubmitters<1)
+		maxNumSubmitters=1;
+	
+	/* Measure job submission throughput with increasing numbers of submitting threads: */
+	std::cout<<"Submitting "<<numJobs<<" jobs of "<<jobSize<<" iterations to "<<Threads::WorkerPool::getMaxNumWorkers()<<" worker threads"<<std::endl;
+	std::cout<<std::setw(10)<<"Submitters"<<std::setw(20)<<"Single queue (jobs/s)"<<std::setw(20)<<"WorkerPool (jobs/s)"<<std::setw(10)<<"Speedup"<<std::endl;
+	{
+	SingleQueuePool singleQueuePool(Threads::WorkerPool::getMaxNumWorkers());
+	for(unsigned int numSubmitters=1;numSubmitters<=maxNumSubmitters;numSubmitters=numSubmitters<maxNumSubmitters&&numSubmitters*2>maxNumSubmitters?maxNumSubmitters:numSubmitters*2)
+		{
+		SubmissionBenchmark benchmark(numJobs/numSubmitters,jobSize);
+		double singleQueueRate=benchmark.run(&singleQueuePool,numSubmitters);
+		double workerPoolRate=benchmark.run(0,numSubmitters);
+		std::cout<<std::setw(10)<<numSubmitters<<std::setw(20)<<std::fixed<<std::setprecision(0)<<singleQueueRate<<std::setw(20)<<workerPoolRate<<std::setw(10)<<std::setprecision(2)<<workerPoolRate/singleQueueRate<<std::endl;
+		if(numSubmitters==maxNumSubmitters)
+			break;
+		}
+	}
+	
+	/* Measure parallel reduction scaling with decreasing grain sizes: */
+	std::vector<double> values(rangeSize);
+	for(size_t i=0;i<rangeSize;++i)
+		values[i]=double(i);
+	SqrtSumReducer reducer(values);
+	SumCombiner combiner;
+	Realtime::TimePointMonotonic serialStart;
+	double serialSum=reducer(0,rangeSize,0.0);
+	double serialTime(serialStart.setAndDiff());
+	std::cout<<std::endl<<"Reducing "<<rangeSize<<" values; serial time "<<std::setprecision(3)<<serialTime*1000.0<<" ms"<<std::endl;
+	std::cout<<std::setw(10)<<"Grain size"<<std::setw(20)<<"parallelReduce (ms)"<<std::setw(10)<<"Speedup"<<std::setw(20)<<"Relative error"<<std::endl;
+	for(size_t grainSize=rangeSize/4;grainSize>=1024;grainSize/=8)
+		{
+		Realtime::TimePointMonotonic parallelStart;
+		double parallelSum=Threads::WorkerPool::parallelReduce(0,rangeSize,grainSize,0.0,reducer,combiner);
+		double parallelTime(parallelStart.setAndDiff());
+		std::cout<<std::setw(10)<<grainSize<<std::setw(20)<<std::setprecision(3)<<parallelTime*1000.0<<std::setw(10)<<std::setprecision(2)<<serialTime/parallelTime<<std::setw(20)<<std::scientific<<std::setprecision(3)<<(parallelSum-serialSum)/serialSum<<std::fixed<<std::endl;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,343 @@
+/***********************************************************************
+XMLBenchmark - Utility to compare the parsing throughput of the UTF-8
+scanner in IO::XMLSource against its character-decoding path, using
+processors receiving strings or string views, and to check that all
+paths report identical events.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/UTF8.h>
+#include <Realtime/Time.h>
+#include <IO/File.h>
+#include <IO/StandardFile.h>
+#include <IO/XMLSource.h>
+
+namespace {
+
+/*******************************************************************
+Processor hashing all events it receives through std::string calls:
+*******************************************************************/
+
+class StringHasher:public IO::XMLSource::Processor
+	{
+	/* Elements: */
+	protected:
+	Misc::UInt32 hash; // Running hash of all received events
+	size_t numEvents; // Number of received events
+	std::string* log; // Optional textual log of all received events
+	
+	/* Protected methods: */
+	void addEvent(char type,const char* begin,size_t length)
+		{
+		hash=(hash^Misc::UInt8(type))*16777619U;
+		for(size_t i=0;i<length;++i)
+			hash=(hash^Misc::UInt8(begin[i]))*16777619U;
+		hash=(hash^0xffU)*16777619U;
+		++numEvents;
+		if(log!=0)
+			{
+			log->push_back(type);
+			log->append(begin,length);
+			log->push_back('|');
+			}
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	StringHasher(const IO::XMLSource& sSource,std::string* sLog =0)
+		:IO::XMLSource::Processor(sSource),
+		 hash(2166136261U),numEvents(0),log(sLog)
+		{
+		}
+	
+	/* Methods from class IO::XMLSource::Processor: */
+	virtual void characterData(const std::string& characterData)
+		{
+		addEvent('T',characterData.data(),characterData.size());
+		}
+	virtual void comment(const std::string& comment)
+		{
+		addEvent('C',comment.data(),comment.size());
+		}
+	virtual void processingInstruction(const std::string& target,const std::string& instruction)
+		{
+		addEvent('P',target.data(),target.size());
+		addEvent('I',instruction.data(),instruction.size());
+		}
+	virtual bool startElement(const std::string& name)
+		{
+		addEvent('S',name.data(),name.size());
+		return true;
+		}
+	virtual void attribute(const std::string& name,const std::string& value)
+		{
+		addEvent('A',name.data(),name.size());
+		addEvent('V',value.data(),value.size());
+		}
+	virtual void enterElement(void)
+		{
+		addEvent('N',0,0);
+		}
+	virtual void endElement(bool selfClosing)
+		{
+		addEvent(selfClosing?'/':'E',0,0);
+		}
+	
+	/* New methods: */
+	Misc::UInt32 getHash(void) const
+		{
+		return hash;
+		}
+	size_t getNumEvents(void) const
+		{
+		return numEvents;
+		}
+	};
+
+/**************************************************************
+Processor hashing all events it receives through string views:
+**************************************************************/
+
+class ViewHasher:public StringHasher
+	{
+	/* Constructors and destructors: */
+	public:
+	ViewHasher(const IO::XMLSource& sSource,std::string* sLog =0)
+		:StringHasher(sSource,sLog)
+		{
+		}
+	
+	/* Methods from class IO::XMLSource::Processor: */
+	using StringHasher::characterData;
+	using StringHasher::comment;
+	using StringHasher::processingInstruction;
+	using StringHasher::startElement;
+	using StringHasher::attribute;
+	virtual void characterData(const IO::XMLSource::StringView& characterData)
+		{
+		addEvent('T',characterData.begin(),characterData.size());
+		}
+	virtual void comment(const IO::XMLSource::StringView& comment)
+		{
+		addEvent('C',comment.begin(),comment.size());
+		}
+	virtual void processingInstruction(const IO::XMLSource::StringView& target,const IO::XMLSource::StringView& instruction)
+		{
+		addEvent('P',target.begin(),target.size());
+		addEvent('I',instruction.begin(),instruction.size());
+		}
+	virtual bool startElement(const IO::XMLSource::StringView& name)
+		{
+		addEvent('S',name.begin(),name.size());
+		return true;
+		}
+	virtual void attribute(const IO::XMLSource::StringView& name,const IO::XMLSource::StringView& value)
+		{
+		addEvent('A',name.begin(),name.size());
+		addEvent('V',value.begin(),value.size());
+		}
+	};
+
+/* Appends a random record element exercising references, processing instructions, comments, CDATA sections, and self-closing tags: */
+void appendRecord(std::string& xml,unsigned int index)
+	{
+	char buffer[256];
+	snprintf(buffer,sizeof(buffer),"<record id=\"%u\" name=\"item &amp; %d\" weight='%.6g'>\n",index,rand()%1000,double(rand())/double(RAND_MAX)*100.0);
+	xml.append(buffer);
+	snprintf(buffer,sizeof(buffer),"\t<position x=\"%.8e\" y=\"%.8e\" z=\"%.8e\"/>\n",double(rand())/double(RAND_MAX)-0.5,double(rand())/double(RAND_MAX)-0.5,double(rand())/double(RAND_MAX)-0.5);
+	xml.append(buffer);
+	xml.append("\t<flag/>\n");
+	switch(rand()%4)
+		{
+		case 0:
+			xml.append("\t<note>Values &lt; 10 &amp;&amp; &gt; 0 are \xc3\xbc" "berpr\xc3\xbc" "ft &#x263a;</note>\n");
+			break;
+		
+		case 1:
+			xml.append("\t<?render?><!-- no instruction -->\n");
+			break;
+		
+		case 2:
+			xml.append("\t<data><![CDATA[raw <data> & more]]></data>\n");
+			break;
+		
+		default:
+			xml.append("\t<?render mode=\"fast\"?>\n");
+		}
+	xml.append("\t<text>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore.</text>\n");
+	xml.append("</record>\n");
+	}
+
+/* Converts the given UTF-8 encoded document to UTF-16 little endian with a byte order mark: */
+std::string toUTF16LE(const std::string& utf8)
+	{
+	std::string result("\xff\xfe",2);
+	std::string::const_iterator sIt=utf8.begin();
+	while(sIt!=utf8.end())
+		{
+		unsigned int c=Misc::UTF8::decode(sIt,utf8.end());
+		result.push_back(char(c&0xffU));
+		result.push_back(char((c>>8)&0xffU));
+		}
+	return result;
+	}
+
+/* Writes the given text to a new temporary file and returns the file's name: */
+std::string writeTempFile(const std::string& text)
+	{
+	char tempName[]="/tmp/XMLBenchmarkXXXXXX";
+	int fd=mkstemp(tempName);
+	if(fd<0)
+		throw std::runtime_error("Unable to create temporary file");
+	IO::StandardFile file(fd,IO::File::WriteOnly);
+	file.writeRaw(text.data(),text.size());
+	return tempName;
+	}
+
+/* Parses the given XML file with a processor of the given type and returns the hash and number of events: */
+template <class HasherParam>
+Misc::UInt32 parse(const std::string& fileName,size_t& numEvents,std::string* log =0)
+	{
+	IO::XMLSource source(new IO::StandardFile(fileName.c_str()));
+	HasherParam hasher(source,log);
+	source.process(hasher);
+	numEvents=hasher.getNumEvents();
+	return hasher.getHash();
+	}
+
+/* Returns true if all parsing paths report the expected events for a small document containing known corner cases: */
+bool checkEvents(void)
+	{
+	static const char* document="<?xml version=\"1.0\"?>\n<root a=\"x &amp; y\"><e/><?pi?><f>&lt;&gt;&apos;&quot;</f><?tgt data?></root>";
+	static const char* expected="T\n|Sroot|Aa|Vx & y|N|Se|/|Ppi|I|Sf|N|T<>'\"|E|Ptgt|Idata|E|";
+	std::string utf8(document);
+	bool result=true;
+	for(int encoding=0;encoding<2;++encoding)
+		{
+		std::string fileName=writeTempFile(encoding==0?utf8:toUTF16LE(utf8));
+		for(int method=0;method<2;++method)
+			{
+			std::string log;
+			size_t numEvents;
+			if(method==0)
+				parse<StringHasher>(fileName,numEvents,&log);
+			else
+				parse<ViewHasher>(fileName,numEvents,&log);
+			if(log!=expected)
+				{
+				std::cout<<"  "<<(encoding==0?"UTF-8":"UTF-16")<<(method==0?" string":" view")<<" events "<<log<<" differ from expected events "<<expected<<std::endl;
+				result=false;
+				}
+			}
+		unlink(fileName.c_str());
+		}
+	return result;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t documentSize=64;
+	unsigned int numRuns=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				documentSize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"runs")==0&&i+1<argc)
+				numRuns=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(numRuns<1)
+		numRuns=1;
+	
+	try
+		{
+		bool passed=checkEvents();
+		std::cout<<"Checking events for corner cases: "<<(passed?"passed":"FAILED")<<std::endl;
+		
+		/* Generate a record-style document and its UTF-16 encoding: */
+		std::string xml="<?xml version=\"1.0\"?>\n<!-- Generated by XMLBenchmark -->\n<records>\n";
+		for(unsigned int index=0;xml.size()<documentSize*1024*1024;++index)
+			appendRecord(xml,index);
+		xml.append("</records>\n<!-- End of records -->\n");
+		std::string fileNames[2];
+		fileNames[0]=writeTempFile(xml);
+		fileNames[1]=writeTempFile(toUTF16LE(xml));
+		std::cout<<"Parsing a "<<xml.size()<<"-byte document "<<numRuns<<" times per method; rates relative to the UTF-8 size:"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		
+		/* Parse the document with each method and keep the best time: */
+		static const char* methodNames[]={"UTF-8 scanner, string callbacks","UTF-8 scanner, view callbacks","UTF-16 decoding, string callbacks","UTF-16 decoding, view callbacks"};
+		Misc::UInt32 hashes[4];
+		size_t numEvents[4];
+		for(int method=0;method<4;++method)
+			{
+			double bestTime=0.0;
+			for(unsigned int run=0;run<numRuns;++run)
+				{
+				Realtime::TimePointMonotonic start;
+				if(method%2==0)
+					hashes[method]=parse<StringHasher>(fileNames[method/2],numEvents[method]);
+				else
+					hashes[method]=parse<ViewHasher>(fileNames[method/2],numEvents[method]);
+				double elapsed(start.setAndDiff());
+				if(run==0||bestTime>elapsed)
+					bestTime=elapsed;
+				}
+			std::cout<<"  "<<std::setw(36)<<std::left<<methodNames[method]<<std::right<<std::setw(10)<<double(xml.size())/(bestTime*1024.0*1024.0)<<" MB/s"<<std::endl;
+			if(hashes[method]!=hashes[0]||numEvents[method]!=numEvents[0])
+				{
+				std::cout<<"  FAILED: "<<methodNames[method]<<" reported different events"<<std::endl;
+				passed=false;
+				}
+			}
+		std::cout<<"  "<<numEvents[0]<<" events"<<std::endl;
+		
+		for(int i=0;i<2;++i)
+			unlink(fileNames[i].c_str());
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
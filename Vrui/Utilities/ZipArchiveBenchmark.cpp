@@ -0,0 +1,445 @@
+/***********************************************************************
+ZipArchiveBenchmark - Utility to check and time extracting all entries
+of a large ZIP archive using IO::ZipArchive's file-backed, memory-
+mapped, concurrent, and parallel batch extraction paths.
+Copyright (c) 2026 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Threads/Thread.h>
+#include <Realtime/Time.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/StandardFile.h>
+#include <IO/ZipArchive.h>
+
+namespace {
+
+/***************************************
+Description of an entry in the archive:
+***************************************/
+
+struct Entry
+	{
+	/* Elements: */
+	public:
+	std::string name; // Entry's file name
+	Misc::UInt32 crc; // CRC-32 of the entry's uncompressed contents
+	size_t size; // Entry's uncompressed size
+	};
+
+/* Appends a little-endian integer of the given number of bytes to the given buffer: */
+void put(std::vector<unsigned char>& buffer,unsigned int value,int numBytes)
+	{
+	for(int i=0;i<numBytes;++i,value>>=8)
+		buffer.push_back((unsigned char)(value&0xffU));
+	}
+
+/* Writes a ZIP archive with the given number of entries, alternating stored and deflated entries, and returns the entries' descriptions; stored entries are tagged with the given compression method: */
+void writeArchive(const char* fileName,unsigned int numEntries,size_t maxEntrySize,std::vector<Entry>& entries,unsigned int storedMethod =0)
+	{
+	static const char* words[]={"vertex ","normal ","texture ","0.5 ","-1.25 ","face ","3.14159 ","mesh\n","# comment\n","42 "};
+	std::vector<unsigned char> archive;
+	std::vector<unsigned char> directory;
+	std::vector<unsigned char> compressed;
+	for(unsigned int index=0;index<numEntries;++index)
+		{
+		/* Create the entry's contents; mostly compressible text with random bytes mixed in: */
+		Entry entry;
+		char name[64];
+		snprintf(name,sizeof(name),"Dir%02u/File%05u.dat",index%37,index);
+		entry.name=name;
+		std::string data;
+		size_t size=size_t(rand())%(maxEntrySize+1);
+		while(data.size()<size)
+			{
+			if(rand()%8==0)
+				data.push_back(char(rand()));
+			else
+				data.append(words[rand()%10]);
+			}
+		data.resize(size);
+		entry.size=size;
+		entry.crc=Misc::UInt32(crc32(crc32(0L,Z_NULL,0),reinterpret_cast<const Bytef*>(data.data()),uInt(size)));
+		
+		/* Deflate every other entry: */
+		unsigned int method=index%2==0?storedMethod:8;
+		const unsigned char* entryData=reinterpret_cast<const unsigned char*>(data.data());
+		size_t entryDataSize=size;
+		if(method==8)
+			{
+			z_stream stream;
+			memset(&stream,0,sizeof(z_stream));
+			if(deflateInit2(&stream,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY)!=Z_OK)
+				throw std::runtime_error("Unable to initialize deflate stream");
+			compressed.resize(deflateBound(&stream,uLong(size)));
+			stream.next_in=const_cast<Bytef*>(entryData);
+			stream.avail_in=uInt(size);
+			stream.next_out=&compressed[0];
+			stream.avail_out=uInt(compressed.size());
+			int result=deflate(&stream,Z_FINISH);
+			deflateEnd(&stream);
+			if(result!=Z_STREAM_END)
+				throw std::runtime_error("Unable to deflate archive entry");
+			entryData=&compressed[0];
+			entryDataSize=stream.total_out;
+			}
+		
+		/* Write the entry's local file header and data: */
+		size_t headerPos=archive.size();
+		put(archive,0x04034b50U,4); // Signature
+		put(archive,20,2); // Version needed to extract
+		put(archive,0,2); // Flags
+		put(archive,method,2);
+		put(archive,0,2); // Modification time
+		put(archive,0x21,2); // Modification date
+		put(archive,entry.crc,4);
+		put(archive,(unsigned int)(entryDataSize),4);
+		put(archive,(unsigned int)(size),4);
+		put(archive,(unsigned int)(entry.name.size()),2);
+		put(archive,0,2); // Extra field length
+		archive.insert(archive.end(),entry.name.begin(),entry.name.end());
+		archive.insert(archive.end(),entryData,entryData+entryDataSize);
+		
+		/* Write the entry's central directory record: */
+		put(directory,0x02014b50U,4); // Signature
+		put(directory,20,2); // Version made by
+		put(directory,20,2); // Version needed to extract
+		put(directory,0,2); // Flags
+		put(directory,method,2);
+		put(directory,0,2); // Modification time
+		put(directory,0x21,2); // Modification date
+		put(directory,entry.crc,4);
+		put(directory,(unsigned int)(entryDataSize),4);
+		put(directory,(unsigned int)(size),4);
+		put(directory,(unsigned int)(entry.name.size()),2);
+		put(directory,0,2); // Extra field length
+		put(directory,0,2); // File comment length
+		put(directory,0,2); // Disk number
+		put(directory,0,2); // Internal attributes
+		put(directory,0,4); // External attributes
+		put(directory,(unsigned int)(headerPos),4);
+		directory.insert(directory.end(),entry.name.begin(),entry.name.end());
+		
+		entries.push_back(entry);
+		}
+	
+	/* Append the central directory and its end record: */
+	size_t directoryPos=archive.size();
+	archive.insert(archive.end(),directory.begin(),directory.end());
+	put(archive,0x06054b50U,4); // Signature
+	put(archive,0,2); // Disk number
+	put(archive,0,2); // Disk containing the central directory
+	put(archive,numEntries,2);
+	put(archive,numEntries,2);
+	put(archive,(unsigned int)(directory.size()),4);
+	put(archive,(unsigned int)(directoryPos),4);
+	put(archive,0,2); // Comment length
+	
+	IO::StandardFile file(fileName,IO::File::WriteOnly);
+	file.writeRaw(&archive[0],archive.size());
+	}
+
+/* Reads the given file completely and returns the CRC-32 of its contents: */
+Misc::UInt32 readCrc(IO::File& file,size_t& size)
+	{
+	uLong crc=crc32(0L,Z_NULL,0);
+	size=0;
+	while(true)
+		{
+		void* buffer;
+		size_t readSize=file.readInBuffer(buffer);
+		if(readSize==0)
+			break;
+		crc=crc32(crc,static_cast<const Bytef*>(buffer),uInt(readSize));
+		size+=readSize;
+		}
+	return Misc::UInt32(crc);
+	}
+
+/* Returns the number of extracted files whose contents do not match their entries' descriptions: */
+unsigned int checkFiles(const std::vector<IO::SeekableFilePtr>& files,const std::vector<Entry>& entries)
+	{
+	unsigned int numMismatches=0;
+	for(size_t i=0;i<entries.size();++i)
+		{
+		size_t size;
+		if(readCrc(*files[i],size)!=entries[i].crc||size!=entries[i].size)
+			++numMismatches;
+		}
+	return numMismatches;
+	}
+
+/*****************************************************************
+Thread opening a share of the entries of a memory-mapped archive:
+*****************************************************************/
+
+class ExtractThread
+	{
+	/* Elements: */
+	private:
+	IO::ZipArchive& archive; // The shared archive
+	const std::vector<IO::ZipArchive::FileID>& fileIds; // IDs of all entries
+	const std::vector<Entry>& entries; // Descriptions of all entries
+	unsigned int threadIndex,numThreads; // This thread's index and the number of threads sharing the entries
+	unsigned int numMismatches; // Number of entries that did not match their descriptions
+	Threads::Thread thread; // The extraction thread
+	
+	/* Private methods: */
+	void* threadMethod(void)
+		{
+		for(size_t i=threadIndex;i<entries.size();i+=numThreads)
+			{
+			size_t size;
+			IO::FilePtr file=i%4<2?IO::FilePtr(archive.openFile(fileIds[i])):IO::FilePtr(archive.openSeekableFile(fileIds[i]));
+			if(readCrc(*file,size)!=entries[i].crc||size!=entries[i].size)
+				++numMismatches;
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	ExtractThread(IO::ZipArchive& sArchive,const std::vector<IO::ZipArchive::FileID>& sFileIds,const std::vector<Entry>& sEntries,unsigned int sThreadIndex,unsigned int sNumThreads)
+		:archive(sArchive),fileIds(sFileIds),entries(sEntries),
+		 threadIndex(sThreadIndex),numThreads(sNumThreads),
+		 numMismatches(0)
+		{
+		thread.start(this,&ExtractThread::threadMethod);
+		}
+	
+	/* Methods: */
+	unsigned int join(void) // Waits for the thread to finish and returns its number of mismatches
+		{
+		thread.join();
+		return numMismatches;
+		}
+	};
+
+/* Checks that entries tagged with an unsupported compression method are rejected by all access paths while deflated entries still open; returns the number of failed checks: */
+unsigned int checkUnsupportedMethod(const char* fileName)
+	{
+	/* Write a small archive whose stored entries are tagged as bzip2-compressed: */
+	std::vector<Entry> entries;
+	writeArchive(fileName,8,4096,entries,12);
+	
+	unsigned int numFailures=0;
+	for(int mapped=0;mapped<2;++mapped)
+		{
+		IO::ZipArchive archive(fileName,mapped!=0);
+		std::vector<IO::ZipArchive::FileID> fileIds;
+		for(std::vector<Entry>::iterator eIt=entries.begin();eIt!=entries.end();++eIt)
+			fileIds.push_back(archive.findFile(eIt->name.c_str()));
+		
+		/* Open each entry individually; only the deflated entries must succeed: */
+		for(size_t i=0;i<entries.size();++i)
+			{
+			bool supported=i%2!=0;
+			for(int seekable=0;seekable<2;++seekable)
+				{
+				try
+					{
+					size_t size;
+					IO::FilePtr file=seekable!=0?IO::FilePtr(archive.openSeekableFile(fileIds[i])):archive.openFile(fileIds[i]);
+					if(!supported||readCrc(*file,size)!=entries[i].crc||size!=entries[i].size)
+						++numFailures;
+					}
+				catch(const std::runtime_error&)
+					{
+					if(supported)
+						++numFailures;
+					}
+				}
+			}
+		
+		/* Open all entries as a batch, which must fail: */
+		try
+			{
+			std::vector<IO::SeekableFilePtr> files;
+			archive.openSeekableFiles(fileIds,files);
+			++numFailures;
+			}
+		catch(const std::runtime_error&)
+			{
+			}
+		}
+	
+	return numFailures;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numEntries=4000;
+	size_t maxEntrySize=65536;
+	unsigned int numThreads=4;
+	unsigned int numRuns=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"entries")==0&&i+1<argc)
+				numEntries=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"maxSize")==0&&i+1<argc)
+				maxEntrySize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				numThreads=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"runs")==0&&i+1<argc)
+				numRuns=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring argument "<<argv[i]<<std::endl;
+		}
+	if(numEntries>65535)
+		numEntries=65535;
+	if(numThreads<1)
+		numThreads=1;
+	if(numRuns<1)
+		numRuns=1;
+	
+	try
+		{
+		/* Create a temporary ZIP archive: */
+		char fileName[]="/tmp/ZipArchiveBenchmarkXXXXXX";
+		int fd=mkstemp(fileName);
+		if(fd<0)
+			throw std::runtime_error("Unable to create temporary file");
+		close(fd);
+		std::vector<Entry> entries;
+		writeArchive(fileName,numEntries,maxEntrySize,entries);
+		size_t totalSize=0;
+		for(std::vector<Entry>::iterator eIt=entries.begin();eIt!=entries.end();++eIt)
+			totalSize+=eIt->size;
+		std::cout<<"Extracting "<<numEntries<<" entries ("<<totalSize<<" bytes, half of them deflated), best of "<<numRuns<<" runs:"<<std::endl;
+		std::cout<<std::fixed<<std::setprecision(1);
+		
+		/* Extract all entries with each method: */
+		static const char* methodNames[]={"File-backed openFile","File-backed openSeekableFile","File-backed batch","Mapped openFile","Mapped openSeekableFile","Mapped batch","Mapped concurrent"};
+		bool passed=true;
+		for(int method=0;method<7;++method)
+			{
+			double bestTime=0.0;
+			unsigned int numMismatches=0;
+			for(unsigned int run=0;run<numRuns;++run)
+				{
+				Realtime::TimePointMonotonic start;
+				IO::ZipArchive archive(fileName,method>=3);
+				std::vector<IO::ZipArchive::FileID> fileIds;
+				fileIds.reserve(entries.size());
+				for(std::vector<Entry>::iterator eIt=entries.begin();eIt!=entries.end();++eIt)
+					fileIds.push_back(archive.findFile(eIt->name.c_str()));
+				numMismatches=0;
+				switch(method)
+					{
+					case 0:
+					case 3:
+						for(size_t i=0;i<entries.size();++i)
+							{
+							size_t size;
+							IO::FilePtr file=archive.openFile(fileIds[i]);
+							if(readCrc(*file,size)!=entries[i].crc||size!=entries[i].size)
+								++numMismatches;
+							}
+						break;
+					
+					case 1:
+					case 4:
+						for(size_t i=0;i<entries.size();++i)
+							{
+							size_t size;
+							IO::SeekableFilePtr file=archive.openSeekableFile(fileIds[i]);
+							if(readCrc(*file,size)!=entries[i].crc||size!=entries[i].size)
+								++numMismatches;
+							}
+						break;
+					
+					case 2:
+					case 5:
+						{
+						std::vector<IO::SeekableFilePtr> files;
+						archive.openSeekableFiles(fileIds,files);
+						numMismatches=checkFiles(files,entries);
+						break;
+						}
+					
+					default:
+						{
+						std::vector<ExtractThread*> threads;
+						for(unsigned int i=0;i<numThreads;++i)
+							threads.push_back(new ExtractThread(archive,fileIds,entries,i,numThreads));
+						for(std::vector<ExtractThread*>::iterator tIt=threads.begin();tIt!=threads.end();++tIt)
+							{
+							numMismatches+=(*tIt)->join();
+							delete *tIt;
+							}
+						}
+					}
+				double elapsed(start.setAndDiff());
+				if(run==0||bestTime>elapsed)
+					bestTime=elapsed;
+				}
+			std::cout<<"  "<<std::setw(30)<<std::left<<methodNames[method]<<std::right<<std::setw(10)<<bestTime*1000.0<<" ms"<<std::setw(10)<<double(totalSize)/(bestTime*1024.0*1024.0)<<" MB/s";
+			if(numMismatches!=0)
+				{
+				std::cout<<", "<<numMismatches<<" CRC mismatches";
+				passed=false;
+				}
+			std::cout<<std::endl;
+			}
+		
+		/* Check that entries with unsupported compression methods are rejected up front: */
+		unsigned int numUnsupportedFailures=checkUnsupportedMethod(fileName);
+		std::cout<<"  "<<std::setw(30)<<std::left<<"Unsupported compression method"<<std::right;
+		if(numUnsupportedFailures!=0)
+			{
+			std::cout<<" "<<numUnsupportedFailures<<" failed checks";
+			passed=false;
+			}
+		else
+			std::cout<<" rejected";
+		std::cout<<std::endl;
+		
+		unlink(fileName);
+		std::cout<<(passed?"PASSED":"FAILED")<<std::endl;
+		if(!passed)
+			return 1;
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -2,7 +2,7 @@
 VRWindow - Abstract base class for OpenGL windows that are used to map
 one or two eyes of a viewer onto a VR screen using a variety of mono or
 stereo rendering methods.
-Copyright (c) 2004-2024 Oliver Kreylos
+Copyright (c) 2004-2026 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -535,22 +535,8 @@ void VRWindow::renderComplete(void)
 	/* Check if the window is currently saving a movie: */
 	if(movieSaverRecording)
 		{
-		/* Get a fresh frame buffer: */
-		MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
-		
-		/* Update the frame buffer's size and prepare it for writing: */
-		frameBuffer.setFrameSize(getWindowSize());
-		frameBuffer.prepareWrite();
-		
-		/* Read the window contents into the movie saver's frame buffer: */
-		glPixelStorei(GL_PACK_ALIGNMENT,1);
-		glPixelStorei(GL_PACK_SKIP_PIXELS,0);
-		glPixelStorei(GL_PACK_ROW_LENGTH,0);
-		glPixelStorei(GL_PACK_SKIP_ROWS,0);
-		glReadPixels(getWindowSize(),GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
-		
-		/* Post the new frame: */
-		movieSaver->postNewFrame();
+		/* Read the window contents into a new movie frame, asynchronously if supported: */
+		movieSaver->captureFrame(getWindowSize());
 		}
 	
 	/* Check if the window is in burn mode: */
@@ -1171,6 +1157,9 @@ void VRWindow::init(const Misc::ConfigurationFileSection& configFileSection)
 
 void VRWindow::releaseGLState(void)
 	{
+	/* Release the movie saver's readback state: */
+	if(movieSaver!=0)
+		movieSaver->releaseGLState();
 	}
 
 bool VRWindow::processEvent(const XEvent& event)